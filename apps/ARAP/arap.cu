@@ -47,8 +47,9 @@ __global__ static void calc_edge_weights_mat(
         weight /= 2;
         weight = std::max(0.f, weight);
 
-        edge_weights(p_id, r_id) = weight;
-        edge_weights(r_id, p_id) = weight;
+        // the edge owns its two entries (see SparseMatrix::build_ev_slots)
+        edge_weights.ev_entry(edge_id, 0) = weight;
+        edge_weights.ev_entry(edge_id, 1) = weight;
     };
 
     auto                block = cooperative_groups::this_thread_block();
@@ -186,24 +187,29 @@ __global__ static void calculate_system_matrix(
     rxmesh::VertexAttribute<T> constraints)
 
 {
-    auto calc_mat = [&](VertexHandle v_id, VertexIterator& vv) {
+    auto calc_mat = [&](VertexHandle v_id, EdgeIterator& ve) {
+        // every thread owns the row of v_id so the row is assembled without
+        // atomics. The entries are found by the edge slots without a search
         if (constraints(v_id, 0) == 0) {
-            for (int i = 0; i < vv.size(); i++) {
-                laplace_mat(v_id, v_id) += weight_matrix(v_id, vv[i]);
-                laplace_mat(v_id, vv[i]) -= weight_matrix(v_id, vv[i]);
+            T diag = 0;
+            for (int i = 0; i < ve.size(); i++) {
+                const T w = weight_matrix.vv_entry(v_id, ve[i]);
+                diag += w;
+                laplace_mat.vv_entry(v_id, ve[i]) -= w;
             }
+            laplace_mat.diagonal(v_id) += diag;
         } else {
-            for (int i = 0; i < vv.size(); i++) {
-                laplace_mat(v_id, vv[i]) = 0;
+            for (int i = 0; i < ve.size(); i++) {
+                laplace_mat.vv_entry(v_id, ve[i]) = 0;
             }
-            laplace_mat(v_id, v_id) = 1;
+            laplace_mat.diagonal(v_id) = 1;
         }
     };
 
     auto                block = cooperative_groups::this_thread_block();
     Query<blockThreads> query(context);
     ShmemAllocator      shrd_alloc;
-    query.dispatch<Op::VV>(block, shrd_alloc, calc_mat);
+    query.dispatch<Op::VE>(block, shrd_alloc, calc_mat);
 }
 
 
@@ -247,10 +253,12 @@ int main(int argc, char** argv)
     auto weights = rx.add_edge_attribute<float>("edgeWeights", 1);
     SparseMatrix<float> weight_matrix(rx);
     weight_matrix.set_value(0.f);
+    weight_matrix.build_ev_slots(rx);
 
     // system matrix
     SparseMatrix<float> laplace_mat(rx);
     laplace_mat.set_value(0.f);
+    laplace_mat.build_ev_slots(rx);
 
     // rotation matrix as a very attribute where every vertex has 3x3 matrix
     auto rotations = *rx.add_vertex_attribute<float>("RotationMatrix", 9);
@@ -296,7 +304,7 @@ int main(int argc, char** argv)
 #endif
 
     // Calculate system matrix
-    rx.prepare_launch_box({rxmesh::Op::VV},
+    rx.prepare_launch_box({rxmesh::Op::VE},
                           lb,
                           (void*)calculate_system_matrix<float, CUDABlockSize>);
 
@@ -0,0 +1,280 @@
+// Synthetic CavityManager workloads: random splits, flips, and collapses at a
+// controlled density on a plane (from geometry_factory) or an input mesh. The
+// per-stage timing of CavityManager, the throughput (committed operations per
+// second), and the conflict and migration rates are written to the report as a
+// function of the patch size and capacity factor
+
+#include "gtest/gtest.h"
+
+#include "rxmesh/geometry_factory.h"
+#include "rxmesh/rxmesh_dynamic.h"
+#include "rxmesh/util/cuda_query.h"
+#include "rxmesh/util/instrumentation.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+#include "cavity_benchmark_kernels.cuh"
+
+struct arg
+{
+    std::string obj_file_name   = "";
+    std::string output_folder   = STRINGIFY(OUTPUT_DIR);
+    std::string op              = "mixed";
+    uint32_t    n               = 256;
+    uint32_t    patch_size      = 256;
+    float       capacity_factor = 1.8;
+    float       density         = 0.05;
+    uint32_t    num_run         = 5;
+    uint32_t    device_id       = 0;
+    char**      argv;
+    int         argc;
+} Arg;
+
+rxmesh::EdgeOp string_to_op(const std::string& op)
+{
+    using namespace rxmesh;
+    if (op == "split") {
+        return EdgeOp::Split;
+    }
+    if (op == "flip") {
+        return EdgeOp::Flip;
+    }
+    if (op == "collapse") {
+        return EdgeOp::Collapse;
+    }
+    if (op != "mixed") {
+        RXMESH_ERROR("string_to_op() unknown operation {}, using mixed", op);
+    }
+    return EdgeOp::None;
+}
+
+void cavity_benchmark_rxmesh(rxmesh::RXMeshDynamic& rx,
+                             const std::string&     mesh_name)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    const EdgeOp op = string_to_op(Arg.op);
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto e_op   = rx.add_edge_attribute<uint8_t>("e_op", 1);
+    auto v_bd   = rx.add_vertex_attribute<bool>("v_bd", 1);
+
+    Report report("CavityBenchmark_RXMesh");
+    report.command_line(Arg.argc, Arg.argv);
+    report.device();
+    report.system();
+    report.model_data(mesh_name, rx, "Input");
+    report.add_member("method", std::string("RXMesh"));
+    report.add_member("blockThreads", blockThreads);
+    report.add_member("op", Arg.op);
+    report.add_member("density", double(Arg.density));
+    report.add_member("patch_size", Arg.patch_size);
+    report.add_member("capacity_factor", double(Arg.capacity_factor));
+
+    LaunchBox<blockThreads> assign_lb;
+    rx.prepare_launch_box(
+        {Op::EV}, assign_lb, (void*)assign_random_ops<blockThreads>);
+
+    TestData td;
+    td.test_name = "CavityBatch";
+
+    uint32_t num_rounds = 0;
+
+    Instrumentation::get().reset();
+
+    for (uint32_t itr = 0; itr < Arg.num_run; ++itr) {
+        // the mesh changes with every batch and so are its boundary vertices
+        rx.get_boundary_vertices(*v_bd, false);
+
+        assign_random_ops<blockThreads>
+            <<<assign_lb.blocks,
+               assign_lb.num_threads,
+               assign_lb.smem_bytes_dyn>>>(
+                rx.get_context(), *v_bd, *e_op, op, Arg.density, itr);
+
+        rx.reset_scheduler();
+
+        GPUTimer timer;
+        timer.start();
+        while (!rx.is_queue_empty()) {
+            LaunchBox<blockThreads> launch_box;
+            rx.update_launch_box({Op::EVDiamond},
+                                 launch_box,
+                                 (void*)cavity_benchmark<blockThreads>,
+                                 true,
+                                 false,
+                                 false,
+                                 false,
+                                 edge_ops_shmem_bytes);
+
+            cavity_benchmark<blockThreads><<<launch_box.blocks,
+                                             launch_box.num_threads,
+                                             launch_box.smem_bytes_dyn>>>(
+                rx.get_context(), *coords, *e_op);
+
+            rx.cleanup();
+            rx.slice_patches(*coords, *e_op, *v_bd);
+            rx.cleanup();
+            num_rounds++;
+        }
+        timer.stop();
+        CUDA_ERROR(cudaDeviceSynchronize());
+        CUDA_ERROR(cudaGetLastError());
+
+        td.time_ms.push_back(timer.elapsed_millis());
+    }
+
+    rx.update_host();
+    coords->move(DEVICE, HOST);
+
+    const std::vector<uint32_t> counters =
+        Instrumentation::get().read_counters();
+    auto counter = [&](Counter c) { return double(counters[uint32_t(c)]); };
+
+    double total_ms = 0;
+    for (float t : td.time_ms) {
+        total_ms += t;
+    }
+
+    const double num_pop    = std::max(counter(Counter::SchedulerPop), 1.0);
+    const double committed  = counter(Counter::CavitySuccess);
+    const double ops_per_s  = total_ms > 0 ? committed / (total_ms / 1000) : 0;
+    const double lock_fails = counter(Counter::PatchLockFail) +
+                              counter(Counter::NeighborLockFail);
+
+    RXMESH_INFO(
+        "CavityBenchmark: {} ops committed in {} rounds, {:.3f} ms, {:.1f} "
+        "ops/s, conflict rate= {:.3f}, migrate fail rate= {:.3f}",
+        uint32_t(committed),
+        num_rounds,
+        total_ms,
+        ops_per_s,
+        lock_fails / num_pop,
+        counter(Counter::MigrateFail) / num_pop);
+
+    report.add_test(td);
+    report.add_member("num_rounds", num_rounds);
+    report.add_member("committed_ops", uint32_t(committed));
+    report.add_member("ops_per_second", ops_per_s);
+    report.add_member("conflict_rate", lock_fails / num_pop);
+    report.add_member("migrate_fail_rate",
+                      counter(Counter::MigrateFail) / num_pop);
+    report.model_data(mesh_name + "_after", rx, "Output");
+    report.add_member("valid", rx.validate());
+
+    // the instrumentation (including the per-stage timing) is added by write()
+    report.write(Arg.output_folder + "/rxmesh_cavity",
+                 "CavityBenchmark_RXMesh_" + extract_file_name(mesh_name) +
+                     "_" + Arg.op);
+}
+
+TEST(Apps, CavityBenchmark)
+{
+    using namespace rxmesh;
+
+    // Select device
+    cuda_query(Arg.device_id);
+
+    // the device counters and stage timers are picked by the mesh context at
+    // construction time
+    Instrumentation::get().enable();
+
+    if (Arg.obj_file_name.empty()) {
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+
+        const std::string name =
+            "plane" + std::to_string(Arg.n) + "x" + std::to_string(Arg.n);
+
+        create_plane(verts, fv, Arg.n, Arg.n, 1.f / float(Arg.n));
+
+        RXMeshDynamic rx(fv, "", Arg.patch_size, Arg.capacity_factor);
+        rx.add_vertex_coordinates(verts, name);
+
+        cavity_benchmark_rxmesh(rx, name);
+    } else {
+        RXMeshDynamic rx(
+            Arg.obj_file_name, "", Arg.patch_size, Arg.capacity_factor);
+        ASSERT_TRUE(rx.is_edge_manifold());
+
+        cavity_benchmark_rxmesh(rx, Arg.obj_file_name);
+    }
+
+    Instrumentation::get().release();
+}
+
+int main(int argc, char** argv)
+{
+    using namespace rxmesh;
+    Log::init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    Arg.argv = argv;
+    Arg.argc = argc;
+
+    if (argc > 1) {
+        if (cmd_option_exists(argv, argc + argv, "-h")) {
+            // clang-format off
+            RXMESH_INFO("\nUsage: CavityBenchmark.exe < -option X>\n"
+                        " -h:               Display this massage and exit\n"
+                        " -input:           Input OBJ file. If not given, a plane of n x n vertices is used\n"
+                        " -n:               Number of vertices along x (and z) of the plane. Default is {}\n"
+                        " -op:              split, flip, collapse, or mixed. Default is {}\n"
+                        " -density:         Fraction of edges that get an operation in every batch. Default is {}\n"
+                        " -patch_size:      Patch size. Default is {}\n"
+                        " -capacity_factor: Patch capacity factor. Default is {}\n"
+                        " -num_run:         Number of batches. Default is {}\n"
+                        " -o:               JSON file output folder. Default is {} \n"
+                        " -device_id:       GPU device ID. Default is {}",
+            Arg.n, Arg.op, Arg.density, Arg.patch_size, Arg.capacity_factor, Arg.num_run, Arg.output_folder, Arg.device_id);
+            // clang-format on
+            exit(EXIT_SUCCESS);
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-input")) {
+            Arg.obj_file_name =
+                std::string(get_cmd_option(argv, argv + argc, "-input"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-o")) {
+            Arg.output_folder =
+                std::string(get_cmd_option(argv, argv + argc, "-o"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-op")) {
+            Arg.op = std::string(get_cmd_option(argv, argv + argc, "-op"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-n")) {
+            Arg.n = atoi(get_cmd_option(argv, argv + argc, "-n"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-density")) {
+            Arg.density = atof(get_cmd_option(argv, argv + argc, "-density"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-patch_size")) {
+            Arg.patch_size =
+                atoi(get_cmd_option(argv, argv + argc, "-patch_size"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-capacity_factor")) {
+            Arg.capacity_factor =
+                atof(get_cmd_option(argv, argv + argc, "-capacity_factor"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-num_run")) {
+            Arg.num_run = atoi(get_cmd_option(argv, argv + argc, "-num_run"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-device_id")) {
+            Arg.device_id =
+                atoi(get_cmd_option(argv, argv + argc, "-device_id"));
+        }
+    }
+
+    RXMESH_TRACE("input= {}", Arg.obj_file_name);
+    RXMESH_TRACE("output_folder= {}", Arg.output_folder);
+    RXMESH_TRACE("op= {}", Arg.op);
+    RXMESH_TRACE("n= {}", Arg.n);
+    RXMESH_TRACE("density= {}", Arg.density);
+    RXMESH_TRACE("patch_size= {}", Arg.patch_size);
+    RXMESH_TRACE("capacity_factor= {}", Arg.capacity_factor);
+    RXMESH_TRACE("num_run= {}", Arg.num_run);
+    RXMESH_TRACE("device_id= {}", Arg.device_id);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/context.h"
+#include "rxmesh/query.cuh"
+
+/**
+ * @brief hash an edge and a seed to a float in [0, 1)
+ */
+__device__ __inline__ float edge_random(const uint64_t id, const uint32_t seed)
+{
+    // splitmix64 finalizer
+    uint64_t x = id + 0x9E3779B97F4A7C15ull * (uint64_t(seed) + 1);
+    x          = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x          = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x          = x ^ (x >> 31);
+    return float(x >> 40) / float(1ull << 24);
+}
+
+/**
+ * @brief assign an operation to every edge with probability density such that
+ * edges incident to a boundary vertex are left untouched. If op is
+ * EdgeOp::None, the operation is picked at random among split, flip, and
+ * collapse
+ */
+template <uint32_t blockThreads>
+__global__ static void assign_random_ops(
+    const rxmesh::Context          context,
+    rxmesh::VertexAttribute<bool>  boundary_v,
+    rxmesh::EdgeAttribute<uint8_t> e_op,
+    const rxmesh::EdgeOp           op,
+    const float                    density,
+    const uint32_t                 seed)
+{
+    using namespace rxmesh;
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(
+        block,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            EdgeOp e = EdgeOp::None;
+
+            const float r = edge_random(eh.unique_id(), seed);
+            if (r < density && !boundary_v(iter[0]) &&
+                !boundary_v(iter[1])) {
+                if (op != EdgeOp::None) {
+                    e = op;
+                } else {
+                    // reuse r to pick among the three operations
+                    const uint32_t k = uint32_t(3.f * r / density) % 3;
+                    e = (k == 0) ? EdgeOp::Split :
+                        (k == 1) ? EdgeOp::Flip :
+                                   EdgeOp::Collapse;
+                }
+            }
+            e_op(eh) = static_cast<uint8_t>(e);
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void cavity_benchmark(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
@@ -21,12 +21,14 @@ struct arg
     uint32_t    device_id     = 0;
     char**      argv;
     int         argc;
-    uint32_t    num_seeds = 1;
+    uint32_t    num_seeds   = 1;
+    uint32_t    num_sources = 16;
 
 } Arg;
 
 #include "geodesic_ptp_openmesh.h"
 #include "geodesic_ptp_rxmesh.h"
+#include "geodesic_solver_rxmesh.h"
 
 TEST(App, Geodesic)
 {
@@ -69,6 +71,10 @@ TEST(App, Geodesic)
 
     // RXMesh Impl
     geodesic_rxmesh<dataT>(rx, h_seeds, sorted_index, limits, toplesets);
+
+    // Library solvers that do not need the toplesets
+    geodesic_solver_rxmesh<dataT>(rx, h_seeds, GeodesicMethod::Heat);
+    geodesic_solver_rxmesh<dataT>(rx, h_seeds, GeodesicMethod::NarrowBand);
 }
 
 int main(int argc, char** argv)
@@ -91,8 +97,9 @@ int main(int argc, char** argv)
                         "              Hint: Only accept OBJ files\n"
                         " -o:          JSON file output folder. Default is {} \n"
                        // "-num_seeds:   Number of input seeds. Default is {}\n"
+                        " -num_sources: Number of distance fields computed in one batch by the library solvers. Default is {}\n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name, Arg.output_folder ,Arg.num_seeds, Arg.device_id);
+            Arg.obj_file_name, Arg.output_folder, Arg.num_sources, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -109,6 +116,10 @@ int main(int argc, char** argv)
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-num_sources")) {
+            Arg.num_sources =
+                atoi(get_cmd_option(argv, argv + argc, "-num_sources"));
+        }
         // if (cmd_option_exists(argv, argc + argv, "-num_seeds")) {
         //    Arg.num_seeds =
         //        atoi(get_cmd_option(argv, argv + argc, "-num_seeds"));
@@ -118,6 +129,7 @@ int main(int argc, char** argv)
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("num_seeds= {}", Arg.num_seeds);
+    RXMESH_TRACE("num_sources= {}", Arg.num_sources);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
 
     return RUN_ALL_TESTS();
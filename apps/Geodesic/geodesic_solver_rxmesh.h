@@ -0,0 +1,104 @@
+#pragma once
+#include "rxmesh/geodesic.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+template <typename T>
+inline void geodesic_solver_rxmesh(rxmesh::RXMeshStatic&        rx,
+                                   const std::vector<uint32_t>& h_seeds,
+                                   const rxmesh::GeodesicMethod method)
+{
+    using namespace rxmesh;
+
+    const std::string name = (method == GeodesicMethod::Heat) ?
+                                 "Geodesic_Heat" :
+                                 "Geodesic_NarrowBand";
+
+    Report report(name);
+    report.command_line(Arg.argc, Arg.argv);
+    report.device();
+    report.system();
+    report.model_data(Arg.obj_file_name, rx);
+    report.add_member("seeds", h_seeds);
+    report.add_member("method", name);
+    report.add_member("num_sources", Arg.num_sources);
+
+    std::vector<VertexHandle> seeds;
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        uint32_t v_id = rx.map_to_global(vh);
+        for (uint32_t s : h_seeds) {
+            if (s == v_id) {
+                seeds.push_back(vh);
+                break;
+            }
+        }
+    });
+    if (seeds.empty()) {
+        RXMESH_ERROR("geodesic_solver_rxmesh() none of the seeds is valid");
+        return;
+    }
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto dist   = rx.add_vertex_attribute<T>("geo_" + name, 1u);
+
+    // the setup (e.g., factorization) is done once for all sources
+    GPUTimer setup_timer;
+    setup_timer.start();
+    GeodesicSolver<T> solver(rx, *coords, method);
+    setup_timer.stop();
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    GPUTimer timer;
+    timer.start();
+    solver.compute(seeds, *dist);
+    timer.stop();
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    // many sources: one distance field per source
+    std::vector<VertexHandle> sources(Arg.num_sources);
+    for (uint32_t s = 0; s < sources.size(); ++s) {
+        sources[s] = seeds[s % seeds.size()];
+    }
+    DenseMatrix<T> fields(rx, rx.get_num_vertices(), sources.size(), DEVICE);
+
+    GPUTimer batch_timer;
+    batch_timer.start();
+    solver.compute_batch(sources, fields);
+    batch_timer.stop();
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    const float per_source = batch_timer.elapsed_millis() / sources.size();
+
+    RXMESH_INFO(
+        "{} setup took {} (ms), a single distance field took {} (ms), {} "
+        "sources took {} (ms) per source",
+        name,
+        setup_timer.elapsed_millis(),
+        timer.elapsed_millis(),
+        sources.size(),
+        per_source);
+
+    dist->move(DEVICE, HOST);
+
+#if USE_POLYSCOPE
+    auto ps_mesh = rx.get_polyscope_mesh();
+    ps_mesh->addVertexScalarQuantity(name, *dist);
+    polyscope::show();
+#endif
+
+    fields.release();
+
+    report.add_member("setup_time (ms)", double(setup_timer.elapsed_millis()));
+    report.add_member("per_source_time (ms)", double(per_source));
+    if (method == GeodesicMethod::NarrowBand) {
+        report.add_member("num_rounds", solver.get_num_rounds());
+    }
+    TestData td;
+    td.test_name = name;
+    td.time_ms.push_back(timer.elapsed_millis());
+    report.add_test(td);
+    report.write(Arg.output_folder + "/rxmesh",
+                 name + "_" + extract_file_name(Arg.obj_file_name));
+}
@@ -60,7 +60,7 @@ __global__ static void mcf_B_setup(const rxmesh::Context            context,
 }
 
 template <typename T, uint32_t blockThreads>
-__global__ static void mcf_A_setup(
+__global__ static void mcf_A_edges(
     const rxmesh::Context            context,
     const rxmesh::VertexAttribute<T> coords,
     rxmesh::SparseMatrix<T>          A_mat,
@@ -68,41 +68,67 @@ __global__ static void mcf_A_setup(
     const T                          time_step)
 {
     using namespace rxmesh;
-    auto init_lambda = [&](VertexHandle& p_id, const VertexIterator& iter) {
-        T sum_e_weight(0);
-        T v_weight(0);
 
-        VertexHandle q_id = iter.back();
-
-        // reference value calculation
-        auto     r_ids      = p_id.unpack();
-        uint32_t r_patch_id = r_ids.first;
-        uint16_t r_local_id = r_ids.second;
+    // every edge owns its two off-diagonal entries which are found through
+    // the slots cached by SparseMatrix::build_ev_slots() i.e., without a
+    // search or atomics
+    auto set_weight = [&](const EdgeHandle& e_id, T e_weight) {
+        e_weight *= time_step;
+        A_mat.ev_entry(e_id, 0) = -e_weight;
+        A_mat.ev_entry(e_id, 1) = -e_weight;
+    };
 
-        // set up matrix A
-        for (uint32_t v = 0; v < iter.size(); ++v) {
-            VertexHandle r_id = iter[v];
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
 
-            T e_weight = 0;
-            if (use_uniform_laplace) {
-                e_weight = 1;
-            } else {
-                VertexHandle s_id =
-                    (v == iter.size() - 1) ? iter[0] : iter[v + 1];
+    if (use_uniform_laplace) {
+        query.dispatch<Op::EV>(
+            block, shrd_alloc, [&](EdgeHandle& e_id, const VertexIterator&) {
+                set_weight(e_id, 1);
+            });
+    } else {
+        query.dispatch<Op::EVDiamond>(
+            block,
+            shrd_alloc,
+            [&](EdgeHandle& e_id, const VertexIterator& iter) {
+                // the edge goes from p-r while q and s are the opposite
+                // vertices
+                const VertexHandle p_id = iter[0];
+                const VertexHandle r_id = iter[2];
+                const VertexHandle q_id = iter[1];
+                const VertexHandle s_id = iter[3];
+
+                T e_weight = 0;
+                if (q_id.is_valid() && s_id.is_valid()) {
+                    e_weight =
+                        edge_cotan_weight(p_id, r_id, q_id, s_id, coords);
+                    e_weight = (static_cast<T>(e_weight >= 0.0)) * e_weight;
+                }
+                set_weight(e_id, e_weight);
+            });
+    }
+}
 
-                e_weight = edge_cotan_weight(p_id, r_id, q_id, s_id, coords);
-                e_weight = (static_cast<T>(e_weight >= 0.0)) * e_weight;
-            }
+template <typename T, uint32_t blockThreads>
+__global__ static void mcf_A_setup(
+    const rxmesh::Context            context,
+    const rxmesh::VertexAttribute<T> coords,
+    rxmesh::SparseMatrix<T>          A_mat,
+    const bool                       use_uniform_laplace)  // for non-uniform
+{
+    using namespace rxmesh;
+    auto init_lambda = [&](VertexHandle& p_id, const VertexIterator& iter) {
+        T v_weight(0);
 
-            e_weight *= time_step;
-            sum_e_weight += e_weight;
+        if (use_uniform_laplace) {
+            v_weight = iter.size();
+        } else {
+            VertexHandle q_id = iter.back();
 
-            A_mat(p_id, iter[v]) = -e_weight;
+            for (uint32_t v = 0; v < iter.size(); ++v) {
+                VertexHandle r_id = iter[v];
 
-            // compute vertex weight
-            if (use_uniform_laplace) {
-                ++v_weight;
-            } else {
                 T tri_area = partial_voronoi_area(p_id, q_id, r_id, coords);
                 v_weight += (tri_area > 0) ? tri_area : 0;
                 q_id = r_id;
@@ -119,7 +145,17 @@ __global__ static void mcf_A_setup(
         assert(!isnan(v_weight));
         assert(!isinf(v_weight));
 
-        A_mat(p_id, p_id) = (1.0 / v_weight) + sum_e_weight;
+        // the off-diagonal entries of the row are written by mcf_A_edges.
+        // The row is contiguous in the CSR (with the diagonal first) so they
+        // are summed without looking up the neighbors
+        const auto row          = A_mat.get_row_id(p_id);
+        T          sum_e_weight = 0;
+        for (auto k = A_mat.row_ptr()[row] + 1; k < A_mat.row_ptr()[row + 1];
+             ++k) {
+            sum_e_weight -= A_mat.get_val_at(k);
+        }
+
+        A_mat.diagonal(p_id) = (1.0 / v_weight) + sum_e_weight;
     };
 
     auto                block = cooperative_groups::this_thread_block();
@@ -166,7 +202,25 @@ void mcf_cusolver_chol(rxmesh::RXMeshStatic& rx,
         rx.get_context(), *coords, B_mat, Arg.use_uniform_laplace);
 
 
-    // A and X set up
+    // A and X set up. The off-diagonal entries are set per edge first and
+    // then every vertex sets its diagonal from its row
+    A_mat.build_ev_slots(rx);
+
+    LaunchBox<blockThreads> launch_box_A_edges;
+    rx.prepare_launch_box(
+        {Arg.use_uniform_laplace ? Op::EV : Op::EVDiamond},
+        launch_box_A_edges,
+        (void*)mcf_A_edges<float, blockThreads>);
+
+    mcf_A_edges<float, blockThreads>
+        <<<launch_box_A_edges.blocks,
+           launch_box_A_edges.num_threads,
+           launch_box_A_edges.smem_bytes_dyn>>>(rx.get_context(),
+                                                *coords,
+                                                A_mat,
+                                                Arg.use_uniform_laplace,
+                                                Arg.time_step);
+
     LaunchBox<blockThreads> launch_box_A_X;
     rx.prepare_launch_box({Op::VV},
                           launch_box_A_X,
@@ -176,11 +230,8 @@ void mcf_cusolver_chol(rxmesh::RXMeshStatic& rx,
     mcf_A_setup<float, blockThreads>
         <<<launch_box_A_X.blocks,
            launch_box_A_X.num_threads,
-           launch_box_A_X.smem_bytes_dyn>>>(rx.get_context(),
-                                            *coords,
-                                            A_mat,
-                                            Arg.use_uniform_laplace,
-                                            Arg.time_step);
+           launch_box_A_X.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, A_mat, Arg.use_uniform_laplace);
 
 
     // To Use LU, we have to move the data to the host
@@ -193,33 +244,9 @@ void mcf_cusolver_chol(rxmesh::RXMeshStatic& rx,
     // A_mat.solve(B_mat, *X_mat, Solver::QR, PermuteMethod::NSTDIS);
     // A_mat.solve(B_mat, *X_mat, Solver::CHOL, PermuteMethod::NSTDIS);
 
-    // Pre-Solves
-    uint32_t* h_reorder_array = nullptr;
-
-    if (permute_method != PermuteMethod::CUSTOM) {
-        A_mat.pre_solve(Solver::CHOL, permute_method);
-    } else {
-        // Compute CUDA_ND reorder
-
-        CUDA_ERROR(cudaMallocManaged(&h_reorder_array,
-                                     sizeof(uint32_t) * rx.get_num_vertices()));
-        CUDA_ERROR(cudaMemset(
-            h_reorder_array, 0, sizeof(uint32_t) * rx.get_num_vertices()));
-
-        cuda_nd_reorder(rx, h_reorder_array, Arg.nd_level);
-
-        int* h_reorder_array_int_cpy;
-        if (arr_check_uint32_to_int_cast(h_reorder_array,
-                                         rx.get_num_vertices())) {
-            h_reorder_array_int_cpy = reinterpret_cast<int*>(h_reorder_array);
-        } else {
-            RXMESH_ERROR(
-                "Error: Overflow in casting reorder array uint32_t to int");
-        }
-        // Solving using CHOL
-        A_mat.pre_solve(
-            Solver::CHOL, PermuteMethod::CUSTOM, h_reorder_array_int_cpy);
-    }
+    // Pre-Solves. With GPUND, the nested dissection ordering is computed on
+    // the GPU from the patches and passed to cuSolver as a custom permutation
+    A_mat.pre_solve(rx, Solver::CHOL, permute_method, Arg.nd_level);
 
     // Solve
     A_mat.solve(B_mat, *X_mat);
@@ -240,5 +267,4 @@ void mcf_cusolver_chol(rxmesh::RXMeshStatic& rx,
     B_mat.release();
     X_mat->release();
     A_mat.release();
-    GPU_FREE(h_reorder_array);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <cuda_profiler_api.h>
 
 #include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/derived_attributes.cuh"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
@@ -181,16 +182,20 @@ __global__ static void __launch_bounds__(blockThreads)
 
 template <typename T, uint32_t blockThreads>
 __global__ static void __launch_bounds__(blockThreads)
-    edge_flip_1(rxmesh::Context                        context,
-                const rxmesh::VertexAttribute<T>       coords,
-                const rxmesh::VertexAttribute<uint8_t> v_valence,
-                rxmesh::EdgeAttribute<EdgeStatus>      edge_status,
-                int*                                   d_buffer)
+    edge_flip_1(rxmesh::Context                   context,
+                const rxmesh::VertexAttribute<T>  coords,
+                rxmesh::DerivedAttributes<T>      derived,
+                rxmesh::EdgeAttribute<EdgeStatus> edge_status,
+                int*                              d_buffer)
 {
     using namespace rxmesh;
 
     auto block = cooperative_groups::this_thread_block();
 
+    // the valence is maintained by the cavity manager for the vertices
+    // touched by the flips (see DerivedAttributes)
+    const VertexAttribute<uint8_t>& v_valence = derived.valence;
+
     ShmemAllocator shrd_alloc;
 
     CavityManager<blockThreads, CavityOp::E> cavity(
@@ -332,7 +337,7 @@ __global__ static void __launch_bounds__(blockThreads)
 
     shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
 
-    if (cavity.prologue(block, shrd_alloc, coords, edge_status)) {
+    if (cavity.prologue(block, shrd_alloc, coords, edge_status, derived)) {
 
         is_updated.reset(block);
         block.sync();
@@ -359,7 +364,7 @@ __global__ static void __launch_bounds__(blockThreads)
         });
     }
 
-    cavity.epilogue(block);
+    cavity.epilogue(block, derived);
     block.sync();
 
     if (cavity.is_successful()) {
@@ -397,7 +402,10 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
     int num_outer_iter = 0;
     int num_inner_iter = 0;
 
+    // the valence is computed once and then only updated around the flipped
+    // edges
     timers.start("FlipTotal");
+    DerivedAttributes<T> derived(rx, *coords, DERIVED_VERTEX_VALENCE);
     while (true) {
         num_outer_iter++;
         rx.reset_scheduler();
@@ -407,18 +415,7 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
             num_inner_iter++;
             LaunchBox<blockThreads> launch_box;
 
-            rx.update_launch_box({},
-                                 launch_box,
-                                 (void*)compute_valence<blockThreads>,
-                                 false,
-                                 false,
-                                 true);
-
             timers.start("Flip");
-            compute_valence<blockThreads>
-                <<<launch_box.blocks,
-                   launch_box.num_threads,
-                   launch_box.smem_bytes_dyn>>>(rx.get_context(), *v_valence);
 
             // link_condition(rx, edge_link);
 
@@ -446,7 +443,7 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
                    launch_box.num_threads,
                    launch_box.smem_bytes_dyn>>>(rx.get_context(),
                                                 *coords,
-                                                *v_valence,
+                                                derived,
                                                 *edge_status,
                                                 //*edge_link,
                                                 d_buffer);
@@ -457,7 +454,7 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
             timers.stop("FlipCleanup");
 
             timers.start("FlipSlice");
-            rx.slice_patches(*coords, *edge_status /*,edge_link*/);
+            rx.slice_patches(*coords, *edge_status, derived /*,edge_link*/);
             timers.stop("FlipSlice");
 
             timers.start("FlipCleanup");
@@ -477,6 +474,9 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
     }
     timers.stop("FlipTotal");
 
+    v_valence->copy_from(derived.valence, DEVICE, DEVICE);
+    derived.release(rx);
+
     // RXMESH_INFO("total num_flips {}", num_flips);
     RXMESH_INFO("num_outer_iter {}", num_outer_iter);
     RXMESH_INFO("num_inner_iter {}", num_inner_iter);
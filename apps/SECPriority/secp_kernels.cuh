@@ -6,10 +6,8 @@
 #include <cuda_runtime.h>
 
 template <typename T, uint32_t blockThreads>
-__global__ static void secp(rxmesh::Context                   context,
-                            rxmesh::VertexAttribute<T>        coords,
-                            const int                         reduce_threshold,
-                            rxmesh::EdgeAttribute<bool>       e_pop_attr)
+__global__ static void secp(rxmesh::Context            context,
+                            rxmesh::VertexAttribute<T> coords)
 {
     using namespace rxmesh;
     auto           block = cooperative_groups::this_thread_block();
@@ -29,44 +27,83 @@ __global__ static void secp(rxmesh::Context                   context,
     Bitmask edge_mask(cavity.patch_info().edges_capacity[0], shrd_alloc);
     edge_mask.reset(block);
 
+    uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
     // we use this bitmask to mark the other end of to-be-collapse edge during
     // checking for the link condition
     Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
     Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
 
+    // the cost of the cheapest edge incident to each vertex. The cost is
+    // non-negative and so its bits can be compared as unsigned int
+    uint32_t* s_v_min_cost =
+        shrd_alloc.alloc<uint32_t>(cavity.patch_info().num_vertices[0]);
+    fill_n<blockThreads>(
+        s_v_min_cost, cavity.patch_info().num_vertices[0], uint32_t(INVALID32));
 
     // Precompute EV
     Query<blockThreads> ev_query(context, pid);
     ev_query.prologue<Op::EV>(block, shrd_alloc);
     block.sync();
 
-    // 1a) mark edge we want to collapse given e_pop_attr
+    auto edge_cost = [&](const uint16_t e) {
+        const VertexIterator iter =
+            ev_query.template get_iterator<VertexIterator>(e);
+
+        const VertexHandle v0 = iter[0];
+        const VertexHandle v1 = iter[1];
+
+        const Vec3<T> p0(coords(v0, 0), coords(v0, 1), coords(v0, 2));
+        const Vec3<T> p1(coords(v1, 0), coords(v1, 1), coords(v1, 2));
+
+        return float(glm::distance2(p0, p1));
+    };
+
+    // 1a) the cheapest edge around every vertex (including not-owned edges)
+    for_each_edge(
+        cavity.patch_info(),
+        [&](EdgeHandle eh) {
+            const VertexIterator iter =
+                ev_query.template get_iterator<VertexIterator>(eh.local_id());
+
+            const uint32_t key = __float_as_uint(edge_cost(eh.local_id()));
+            ::atomicMin(s_v_min_cost + iter.local(0), key);
+            ::atomicMin(s_v_min_cost + iter.local(1), key);
+        },
+        true);
+    block.sync();
+
+    // 1b) mark edges that are the cheapest around their two end vertices.
+    // Conflicts between the rest are resolved by the cavity priority
     for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
         assert(eh.local_id() < cavity.patch_info().num_edges[0]);
 
-        //edge_mask.set(eh.local_id(), e_pop_attr(eh));
-        if(true == e_pop_attr(eh))
-        {
-           edge_mask.set(eh.local_id(), true);
-        }
+        const VertexIterator iter =
+            ev_query.template get_iterator<VertexIterator>(eh.local_id());
 
+        const uint32_t key = __float_as_uint(edge_cost(eh.local_id()));
+        if (s_v_min_cost[iter.local(0)] == key &&
+            s_v_min_cost[iter.local(1)] == key) {
+            edge_mask.set(eh.local_id(), true);
+        }
     });
     block.sync();
 
     // 2a) check edge link condition.
-    link_condition(block, cavity.patch_info(), ev_query, 
+    link_condition(block, cavity.patch_info(), ev_query,
                    edge_mask, v0_mask, v1_mask, 0, 1);
     block.sync();
 
+    // 2b) create the cavities where cheaper collapses win the conflicts
     for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
         assert(eh.local_id() < cavity.patch_info().num_edges[0]);
         if (edge_mask(eh.local_id())) {
-            cavity.create(eh);
-        } 
+            cavity.create(eh, edge_cost(eh.local_id()));
+        }
     });
     block.sync();
 
-    ev_query.epilogue(block, shrd_alloc);
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
 
     // create the cavity
     if (cavity.prologue(block, shrd_alloc, coords)) {
@@ -135,91 +172,3 @@ __global__ static void secp(rxmesh::Context                   context,
     cavity.epilogue(block);
     block.sync();
 }
-
-//template <typename View, typename InputIt>
-template <typename T, uint32_t blockThreads>
-__global__ static void  compute_edge_priorities(
-    rxmesh::Context                  context,
-    const rxmesh::VertexAttribute<T> coords,
-    PQView_t                         pq_view,
-    size_t                           pq_num_bytes)
-{
-    using namespace rxmesh;
-    namespace cg = cooperative_groups;
-    cg::thread_block g = cg::this_thread_block();
-    ShmemAllocator      shrd_alloc;
-
-    Query<blockThreads> query(context);
-    auto intermediatePairs = shrd_alloc.alloc<PriorityPair_t>(query.get_patch_info().num_edges[0]);
-    __shared__ int pair_counter;
-    pair_counter = 0;
-
-    auto edge_len = [&](const EdgeHandle& eh, const VertexIterator& iter) {
-        const VertexHandle v0 = iter[0];
-        const VertexHandle v1 = iter[1];
-
-        const Vec3<T> p0(coords(v0, 0), coords(v0, 1), coords(v0, 2));
-        const Vec3<T> p1(coords(v1, 0), coords(v1, 1), coords(v1, 2));
-
-        T len2 = glm::distance2(p0, p1);
-
-        auto p_e = rxmesh::detail::unpack(eh.unique_id());
-        //printf("p_id:%u\te_id:%hu\n", p_e.first, p_e.second);
-        //printf("e_id:%llu\t, len:%f\n", eh.unique_id(), len2);
-
-        // repack the EdgeHandle into smaller 32 bits for
-        // use with priority queue. Need to check elsewhere
-        // that there are less than 2^16 patches.
-        auto id32 = unique_id32(p_e.second, (uint16_t)p_e.first);
-        //auto p_e_32 = unpack32(id32);
-        //printf("32bit p_id:%hu\te_id:%hu\n", p_e_32.first, p_e_32.second);
-
-        PriorityPair_t p{len2, id32};
-        //PriorityPair_t p{len2, eh};
-
-        auto val_counter = atomicAdd(&pair_counter, 1);
-        intermediatePairs[val_counter] = p;
-    };
-
-    auto block = cooperative_groups::this_thread_block();
-    query.dispatch<Op::EV>(block, shrd_alloc, edge_len);
-    block.sync();
-
-    char * pq_shrd_mem = shrd_alloc.alloc(pq_num_bytes);
-    pq_view.push(block, intermediatePairs, intermediatePairs + pair_counter, pq_shrd_mem);
-}
-
-template <uint32_t blockThreads>
-__global__ static void pop_and_mark_edges_to_collapse(
-    PQView_t pq_view,
-    rxmesh::EdgeAttribute<bool> marked_edges,
-    uint32_t pop_num_edges)
-{
-    // setup shared memory array to store the popped pairs
-    // 
-    // device api pop pairs
-    namespace cg = cooperative_groups;
-    using namespace rxmesh;
-    ShmemAllocator      shrd_alloc;
-
-    auto intermediatePairs = shrd_alloc.alloc<PriorityPair_t>(blockThreads);
-    char * pq_shrd_mem = shrd_alloc.alloc(pq_view.get_shmem_size(blockThreads));
-    cg::thread_block g = cg::this_thread_block();
-    pq_view.pop(g, intermediatePairs, intermediatePairs + blockThreads, pq_shrd_mem);
-
-    int tid = blockIdx.x * blockDim.x + threadIdx.x;
-    int local_tid = threadIdx.x;
-
-    // Make sure the index is within bounds
-    if(tid < pop_num_edges)
-    {
-        //printf("tid: %d\n", tid);
-        //unpack the uid to get the patch and edge ids
-        auto p_e = unpack32(intermediatePairs[local_tid].second);
-        //printf("32bit p_id:%hu\te_id:%hu\n", p_e.first, p_e.second);
-        rxmesh::EdgeHandle eh(p_e.first, rxmesh::LocalEdgeT(p_e.second));
-
-        //use the eh to index into a passed in edge attribute
-        marked_edges(eh) = true;
-    }
-}
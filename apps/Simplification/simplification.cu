@@ -32,7 +32,11 @@ TEST(Apps, Simplification)
 
     ASSERT_TRUE(rx.is_edge_manifold());
 
-    simplification_rxmesh(rx, Arg.target);
+    // default to 10% of the input faces
+    const uint32_t target =
+        (Arg.target == 0) ? rx.get_num_faces() / 10 : Arg.target;
+
+    simplification_rxmesh(rx, target);
 }
 
 
@@ -54,7 +58,7 @@ int main(int argc, char** argv)
                         " -input:      Input file. Input file should be under the input/ subdirectory\n"
                         "              Default is {} \n"
                         "              Hint: Only accept OBJ files\n"
-                        " -target:     The final/target number of faces in the output mesh\n"
+                        " -target:     The final/target number of faces in the output mesh. Default is 10% of the input\n"
                         " -o:          JSON file output folder. Default is {} \n"
                         " -device_id:  GPU device ID. Default is {}",
             Arg.obj_file_name, Arg.output_folder, Arg.device_id);
@@ -75,7 +79,7 @@ int main(int argc, char** argv)
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
         }
         if (cmd_option_exists(argv, argc + argv, "-target")) {
-            Arg.target = false;
+            Arg.target = atoi(get_cmd_option(argv, argv + argc, "-target"));
         }
     }
 
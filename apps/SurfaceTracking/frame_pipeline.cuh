@@ -0,0 +1,228 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "rxmesh/mesh_writer.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+/**
+ * @brief overlap exporting the frames with simulating the next ones. The
+ * simulation runs on the default stream. Once a frame is done, it is compacted
+ * on a separate (non-blocking) stream and the default stream only waits for
+ * this compaction (which reads the topology and the coordinates) before
+ * changing the mesh again. The transfer to the host and writing the file
+ * overlap with the next frames. At most frames_in_flight frames are exported
+ * at any time. Once they are all in flight, a new frame waits for the oldest
+ * one. With an empty output folder, the frames are not exported and only the
+ * frame rate is tracked.
+ */
+template <typename T>
+struct FramePipeline
+{
+    FramePipeline(const uint32_t     frames_in_flight,
+                  const std::string& output_folder,
+                  const std::string& name)
+        : m_writer(frames_in_flight),
+          m_output_folder(output_folder),
+          m_name(name),
+          m_stream(NULL),
+          m_frame_done(nullptr),
+          m_compacted(nullptr),
+          m_num_frames(0),
+          m_export_ms(0),
+          m_export_host_ms(0),
+          m_total_ms(0),
+          m_ok(true)
+    {
+        const uint32_t num_slots = m_writer.get_num_slots();
+        m_start.resize(num_slots, nullptr);
+        m_stop.resize(num_slots, nullptr);
+        m_pending.resize(num_slots, false);
+
+        if (is_exporting()) {
+            std::filesystem::create_directories(m_output_folder);
+
+            CUDA_ERROR(
+                cudaStreamCreateWithFlags(&m_stream, cudaStreamNonBlocking));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_frame_done,
+                                                cudaEventDisableTiming));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_compacted,
+                                                cudaEventDisableTiming));
+            for (uint32_t s = 0; s < num_slots; ++s) {
+                CUDA_ERROR(cudaEventCreate(&m_start[s]));
+                CUDA_ERROR(cudaEventCreate(&m_stop[s]));
+            }
+        }
+
+        m_timer.start();
+    }
+
+    FramePipeline(const FramePipeline&)            = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    ~FramePipeline()
+    {
+        release();
+    }
+
+    /**
+     * @brief whether the frames are written to files
+     */
+    bool is_exporting() const
+    {
+        return !m_output_folder.empty();
+    }
+
+    /**
+     * @brief hand the frame that has just been simulated to the export stage.
+     * This should be called after the last topology change of the frame
+     * (and its cleanup())
+     */
+    void end_frame(rxmesh::RXMeshDynamic&            rx,
+                   const rxmesh::VertexAttribute<T>& position)
+    {
+        using namespace rxmesh;
+
+        const uint32_t s = m_num_frames % m_writer.get_num_slots();
+        m_num_frames++;
+
+        if (!is_exporting()) {
+            return;
+        }
+
+        CPUTimer host_timer;
+        host_timer.start();
+
+        // the previous frame that used this slot is done once its file is
+        // written, which is what write() waits for anyway
+        collect(s);
+
+        CUDA_ERROR(cudaEventRecord(m_frame_done, NULL));
+        CUDA_ERROR(cudaStreamWaitEvent(m_stream, m_frame_done, 0));
+
+        CUDA_ERROR(cudaEventRecord(m_start[s], m_stream));
+        m_ok = m_writer.write(rx,
+                              position,
+                              m_output_folder + "/" + m_name + "_" +
+                                  std::to_string(m_num_frames - 1) + ".ply",
+                              m_stream,
+                              m_compacted) &&
+               m_ok;
+        CUDA_ERROR(cudaEventRecord(m_stop[s], m_stream));
+        m_pending[s] = true;
+
+        // the next frame changes the mesh and so it should wait for the
+        // compaction but not for the transfer
+        CUDA_ERROR(cudaStreamWaitEvent(NULL, m_compacted, 0));
+
+        host_timer.stop();
+        m_export_host_ms += host_timer.elapsed_millis();
+    }
+
+    /**
+     * @brief wait for all the frames in flight to be written
+     * @return false if writing any of the frames failed
+     */
+    bool finish()
+    {
+        if (is_exporting()) {
+            m_ok = m_writer.wait() && m_ok;
+            for (uint32_t s = 0; s < m_writer.get_num_slots(); ++s) {
+                collect(s);
+            }
+        }
+        m_timer.stop();
+        m_total_ms = m_timer.elapsed_millis();
+        return m_ok;
+    }
+
+    /**
+     * @brief add the timing of the export stage and the sustained frame rate
+     * to the report. Should be called after finish()
+     */
+    void report(rxmesh::Report& report) const
+    {
+        report.add_member("frames_in_flight", m_writer.get_num_slots());
+        report.add_member("export_frames", is_exporting());
+        report.add_member("num_frames", m_num_frames);
+        report.add_member("export_time", m_export_ms);
+        report.add_member("export_host_time", m_export_host_ms);
+        report.add_member("pipeline_time", m_total_ms);
+        report.add_member(
+            "frames_per_second",
+            m_total_ms > 0 ? 1000.0 * double(m_num_frames) / m_total_ms : 0.0);
+    }
+
+    uint32_t get_num_frames() const
+    {
+        return m_num_frames;
+    }
+
+    /**
+     * @brief wait for the frames in flight and free all the resources
+     */
+    void release()
+    {
+        using namespace rxmesh;
+
+        m_writer.release();
+        for (uint32_t s = 0; s < m_start.size(); ++s) {
+            if (m_start[s] != nullptr) {
+                CUDA_ERROR(cudaEventDestroy(m_start[s]));
+                m_start[s] = nullptr;
+            }
+            if (m_stop[s] != nullptr) {
+                CUDA_ERROR(cudaEventDestroy(m_stop[s]));
+                m_stop[s] = nullptr;
+            }
+            m_pending[s] = false;
+        }
+        if (m_frame_done != nullptr) {
+            CUDA_ERROR(cudaEventDestroy(m_frame_done));
+            m_frame_done = nullptr;
+        }
+        if (m_compacted != nullptr) {
+            CUDA_ERROR(cudaEventDestroy(m_compacted));
+            m_compacted = nullptr;
+        }
+        if (m_stream != NULL) {
+            CUDA_ERROR(cudaStreamDestroy(m_stream));
+            m_stream = NULL;
+        }
+    }
+
+   private:
+    /**
+     * @brief accumulate the time the export stream spent on the frame that
+     * used slot s (compaction and transfer)
+     */
+    void collect(const uint32_t s)
+    {
+        using namespace rxmesh;
+
+        if (!m_pending[s]) {
+            return;
+        }
+        CUDA_ERROR(cudaEventSynchronize(m_stop[s]));
+        float elapsed = 0;
+        CUDA_ERROR(cudaEventElapsedTime(&elapsed, m_start[s], m_stop[s]));
+        m_export_ms += elapsed;
+        m_pending[s] = false;
+    }
+
+    rxmesh::MeshWriter<T>    m_writer;
+    std::string              m_output_folder;
+    std::string              m_name;
+    cudaStream_t             m_stream;
+    cudaEvent_t              m_frame_done, m_compacted;
+    std::vector<cudaEvent_t> m_start, m_stop;
+    std::vector<bool>        m_pending;
+    uint32_t                 m_num_frames;
+    float                    m_export_ms, m_export_host_ms, m_total_ms;
+    bool                     m_ok;
+    rxmesh::CPUTimer         m_timer;
+};
@@ -29,6 +29,8 @@ struct arg
     float       min_triangle_area           = 1e-7;
     float       min_triangle_angle          = deg2rad(0.f);
     float       max_triangle_angle          = deg2rad(180.f);
+    bool        export_frames               = false;
+    uint32_t    frames_in_flight            = 2;
     char**      argv;
     int         argc;
 } Arg;
@@ -84,8 +86,10 @@ int main(int argc, char** argv)
                         " -h:          Display this massage and exit\n"
                         " -n:          Number of point along x(or y) direction. Default is {} \n"
                         " -o:          JSON file output folder. Default is {} \n"
+                        " -export:     Write every frame to a PLY file in the output folder. Default is {} \n"
+                        " -frames_in_flight:  Number of frames exported while the next ones are simulated. Default is {} \n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.n, Arg.output_folder, Arg.device_id);
+            Arg.n, Arg.output_folder, (Arg.export_frames ? "true" : "false"), Arg.frames_in_flight, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -101,11 +105,20 @@ int main(int argc, char** argv)
         if (cmd_option_exists(argv, argc + argv, "-n")) {
             Arg.n = atoi(get_cmd_option(argv, argv + argc, "-n"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-export")) {
+            Arg.export_frames = true;
+        }
+        if (cmd_option_exists(argv, argc + argv, "-frames_in_flight")) {
+            Arg.frames_in_flight =
+                atoi(get_cmd_option(argv, argv + argc, "-frames_in_flight"));
+        }
     }
 
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
     RXMESH_TRACE("n= {}", Arg.n);
+    RXMESH_TRACE("export_frames= {}", Arg.export_frames);
+    RXMESH_TRACE("frames_in_flight= {}", Arg.frames_in_flight);
 
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #define G_EIGENVALUE_RANK_RATIO 0.03
 
+#include "frame_pipeline.cuh"
 #include "frame_stepper.h"
 #include "rxmesh/rxmesh_dynamic.h"
 #include "simulation.h"
@@ -76,8 +77,12 @@ int is_done(const rxmesh::RXMeshDynamic&             rx,
             }
         });
 
-    CUDA_ERROR(cudaDeviceSynchronize());
-    return d_buffer[0];
+    // only wait for the default stream so the frames that are being exported
+    // (on their own stream) are not waited for
+    int remaining = 0;
+    CUDA_ERROR(cudaMemcpy(
+        &remaining, d_buffer, sizeof(int), cudaMemcpyDeviceToHost));
+    return remaining;
 }
 
 
@@ -539,6 +544,7 @@ template <typename T>
 void advance_frame(Simulation<T>&                     sim,
                    FrameStepper<T>&                   frame_stepper,
                    FlowNoise3<T>&                     noise,
+                   FramePipeline<T>&                  pipeline,
                    rxmesh::RXMeshDynamic&             rx,
                    rxmesh::VertexAttribute<T>*&       current_position,
                    rxmesh::VertexAttribute<T>*&       new_position,
@@ -571,6 +577,9 @@ void advance_frame(Simulation<T>&                     sim,
         // update frame stepper
         frame_stepper.next_frame();
 
+        // export the frame while the next one is simulated
+        pipeline.end_frame(rx, *current_position);
+
         sim.m_currently_advancing_simulation = false;
     }
 }
@@ -579,6 +588,7 @@ template <typename T>
 void run_simulation(Simulation<T>&                     sim,
                     FrameStepper<T>&                   frame_stepper,
                     FlowNoise3<T>&                     noise,
+                    FramePipeline<T>&                  pipeline,
                     rxmesh::RXMeshDynamic&             rx,
                     rxmesh::VertexAttribute<T>*        current_position,
                     rxmesh::VertexAttribute<T>*        new_position,
@@ -592,6 +602,7 @@ void run_simulation(Simulation<T>&                     sim,
         advance_frame(sim,
                       frame_stepper,
                       noise,
+                      pipeline,
                       rx,
                       current_position,
                       new_position,
@@ -683,6 +694,11 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     advect_time_ms    = 0;
     total_num_iter    = 0;
 
+    FramePipeline<float> pipeline(
+        Arg.frames_in_flight,
+        Arg.export_frames ? Arg.output_folder + "/rxmesh_tracking_frames" : "",
+        extract_file_name(Arg.plane_name));
+
     CUDA_ERROR(cudaProfilerStart());
     GPUTimer timer;
     timer.start();
@@ -690,6 +706,7 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     run_simulation(sim,
                    frame_stepper,
                    noise,
+                   pipeline,
                    rx,
                    current_position.get(),
                    new_position.get(),
@@ -698,6 +715,8 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
                    is_vertex_bd.get(),
                    is_edge_bd.get());
 
+    EXPECT_TRUE(pipeline.finish());
+
     timer.stop();
 
     CUDA_ERROR(cudaProfilerStop());
@@ -711,6 +730,12 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     report.add_member("total_num_iter", total_num_iter);
     report.add_member("time_per_iter",
                       float(timer.elapsed_millis()) / float(total_num_iter));
+    report.add_member("split_time", split_time_ms);
+    report.add_member("collapse_time", collapse_time_ms);
+    report.add_member("flip_time", flip_time_ms);
+    report.add_member("smoothing_time", smoothing_time_ms);
+    report.add_member("advect_time", advect_time_ms);
+    pipeline.report(report);
     report.model_data(Arg.plane_name + "_after", rx, "model_after");
 
     report.add_member(
@@ -724,5 +749,6 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     report.write(Arg.output_folder + "/rxmesh_tracking",
                  "Tracking_RXMesh_" + extract_file_name(Arg.plane_name));
 
+    pipeline.release();
     noise.free();
 }
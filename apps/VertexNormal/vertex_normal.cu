@@ -5,6 +5,7 @@
 #include <cuda_profiler_api.h>
 #include "gtest/gtest.h"
 #include "rxmesh/attribute.h"
+#include "rxmesh/launch_planner.h"
 #include "rxmesh/rxmesh_static.h"
 #include "rxmesh/util/import_obj.h"
 #include "rxmesh/util/report.h"
@@ -18,6 +19,7 @@ struct arg
     std::string output_folder = STRINGIFY(OUTPUT_DIR);
     uint32_t    num_run       = 1;
     uint32_t    device_id     = 0;
+    uint32_t    patch_size    = 512;
     char**      argv;
     int         argc;
 } Arg;
@@ -30,7 +32,6 @@ void vertex_normal_rxmesh(rxmesh::RXMeshStatic&              rx,
                           const std::vector<T>&              vertex_normal_gold)
 {
     using namespace rxmesh;
-    constexpr uint32_t blockThreads = 256;
 
     // Report
     Report report("VertexNormal_RXMesh");
@@ -39,7 +40,7 @@ void vertex_normal_rxmesh(rxmesh::RXMeshStatic&              rx,
     report.system();
     report.model_data(Arg.obj_file_name, rx);
     report.add_member("method", std::string("RXMesh"));
-    report.add_member("blockThreads", blockThreads);
+    report.add_member("patch_size", Arg.patch_size);
 
     auto coords = rx.add_vertex_attribute<T>(Verts, "coordinates");
 
@@ -48,20 +49,33 @@ void vertex_normal_rxmesh(rxmesh::RXMeshStatic&              rx,
     auto v_normals =
         rx.add_vertex_attribute<T>("v_normals", 3, rxmesh::LOCATION_ALL);
 
-    // launch box
-    LaunchBox<blockThreads> launch_box;
-    rx.prepare_launch_box({rxmesh::Op::FV},
-                          launch_box,
-                          (void*)compute_vertex_normal<T, blockThreads>);
-
+    // the block size is selected (and cached) for the current GPU and mesh
+    LaunchPlanner planner;
+    LaunchPlan    plan = planner.plan<128, 256, 512, 768, 1024>(
+        rx, "compute_vertex_normal", [&](auto& launch_box) {
+            constexpr uint32_t blockThreads =
+                std::decay_t<decltype(launch_box)>::block_threads;
+            rx.prepare_launch_box(
+                {rxmesh::Op::FV},
+                launch_box,
+                (void*)compute_vertex_normal<T, blockThreads>);
+            return [&, launch_box]() {
+                compute_vertex_normal<T, blockThreads>
+                    <<<launch_box.blocks,
+                       launch_box.num_threads,
+                       launch_box.smem_bytes_dyn>>>(
+                        rx.get_context(), *coords, *v_normals);
+            };
+        });
+    report.add_member("blockThreads", plan.block_threads);
 
     TestData td;
     td.test_name   = "VertexNormal";
-    td.num_threads = launch_box.num_threads;
-    td.num_blocks  = launch_box.blocks;
-    td.dyn_smem    = launch_box.smem_bytes_dyn;
-    td.static_smem = launch_box.smem_bytes_static;
-    td.num_reg     = launch_box.num_registers_per_thread;
+    td.num_threads = plan.block_threads;
+    td.num_blocks  = plan.blocks;
+    td.dyn_smem    = plan.smem_bytes_dyn;
+    td.static_smem = plan.smem_bytes_static;
+    td.num_reg     = plan.num_registers_per_thread;
 
     float vn_time = 0;
     for (uint32_t itr = 0; itr < Arg.num_run; ++itr) {
@@ -69,10 +83,7 @@ void vertex_normal_rxmesh(rxmesh::RXMeshStatic&              rx,
         GPUTimer timer;
         timer.start();
 
-        compute_vertex_normal<T, blockThreads><<<launch_box.blocks,
-                                                 launch_box.num_threads,
-                                                 launch_box.smem_bytes_dyn>>>(
-            rx.get_context(), *coords, *v_normals);
+        plan();
 
         timer.stop();
         CUDA_ERROR(cudaDeviceSynchronize());
@@ -119,7 +130,7 @@ TEST(Apps, VertexNormal)
     ASSERT_TRUE(import_obj(Arg.obj_file_name, Verts, Faces));
 
 
-    RXMeshStatic rx(Faces);
+    RXMeshStatic rx(Faces, "", Arg.patch_size);
 
     // Serial reference
     std::vector<dataT> vertex_normal_gold(3 * Verts.size());
@@ -151,8 +162,9 @@ int main(int argc, char** argv)
                         "              Hint: Only accept OBJ files\n"
                         " -o:          JSON file output folder. Default is {} \n"
                         " -num_run:    Number of iterations for performance testing. Default is {} \n"                        
-                        " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name, Arg.output_folder, Arg.num_run, Arg.device_id);
+                        " -device_id:  GPU device ID. Default is {}\n"
+                        " -patch_size: Patch size. Default is {}",
+            Arg.obj_file_name, Arg.output_folder, Arg.num_run, Arg.device_id, Arg.patch_size);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -173,12 +185,17 @@ int main(int argc, char** argv)
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-patch_size")) {
+            Arg.patch_size =
+                atoi(get_cmd_option(argv, argv + argc, "-patch_size"));
+        }
     }
 
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("num_run= {}", Arg.num_run);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
+    RXMESH_TRACE("patch_size= {}", Arg.patch_size);
 
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
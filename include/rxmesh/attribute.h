@@ -1,6 +1,8 @@
 #pragma once
 
 #include <assert.h>
+#include <memory>
+#include <new>
 #include <utility>
 
 #include "rxmesh/handle.h"
@@ -11,6 +13,7 @@
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/cuda_query.h"
+#include "rxmesh/util/instrumentation.h"
 #include "rxmesh/util/log.h"
 #include "rxmesh/util/util.h"
 
@@ -28,6 +31,85 @@ namespace rxmesh {
 
 class RXMeshStatic;
 
+namespace detail {
+/**
+ * @brief a std::shared_ptr that can also be copied in device code, e.g., as
+ * part of a lambda that captures an attribute by value. Copies made on the
+ * host share the ownership of the object. Copies made on the device are only
+ * a view of the pointer that does not touch the reference count and should
+ * not be dereferenced
+ */
+template <typename T>
+class HostSharedPtr
+{
+    using SharedT = std::shared_ptr<T>;
+
+   public:
+    explicit HostSharedPtr(T* ptr = nullptr)
+    {
+        new (&m_storage) SharedT(ptr);
+    }
+
+    __host__ __device__ HostSharedPtr(const HostSharedPtr& rhs)
+    {
+#ifdef __CUDA_ARCH__
+        m_storage = rhs.m_storage;
+#else
+        new (&m_storage) SharedT(rhs.shared());
+#endif
+    }
+
+    __host__ __device__ HostSharedPtr& operator=(const HostSharedPtr& rhs)
+    {
+#ifdef __CUDA_ARCH__
+        m_storage = rhs.m_storage;
+#else
+        shared() = rhs.shared();
+#endif
+        return *this;
+    }
+
+    __host__ __device__ ~HostSharedPtr()
+    {
+#ifndef __CUDA_ARCH__
+        shared().~SharedT();
+#endif
+    }
+
+    T* get() const
+    {
+        return shared().get();
+    }
+
+    T* operator->() const
+    {
+        return get();
+    }
+
+    void reset(T* ptr = nullptr)
+    {
+        shared().reset(ptr);
+    }
+
+   private:
+    SharedT& shared()
+    {
+        return *reinterpret_cast<SharedT*>(&m_storage);
+    }
+
+    const SharedT& shared() const
+    {
+        return *reinterpret_cast<const SharedT*>(&m_storage);
+    }
+
+    struct alignas(SharedT) Storage
+    {
+        unsigned char bytes[sizeof(SharedT)];
+    };
+    Storage m_storage;
+};
+}  // namespace detail
+
 /**
  * @brief Base untyped attributes used as an interface for attribute container
  */
@@ -43,6 +125,31 @@ class AttributeBase
 
     virtual void release(locationT location = LOCATION_ALL) = 0;
 
+    /**
+     * @brief prefetch the device memory of a single patch to device (or to
+     * the host if device is cudaCpuDeviceId). Only used in streaming mode
+     */
+    virtual void prefetch(const uint32_t patch_id,
+                          const int      device,
+                          cudaStream_t   stream) const = 0;
+
+    /**
+     * @brief reallocate the memory of a single patch after its capacity has
+     * grown (see RXMeshDynamic::grow_patch). The new capacity is read from the
+     * patch info while the old capacities are passed
+     */
+    virtual void grow_patch(const uint32_t patch_id,
+                            const uint16_t old_vertices_capacity,
+                            const uint16_t old_edges_capacity,
+                            const uint16_t old_faces_capacity) = 0;
+
+    /**
+     * @brief allocate the memory of the patches added to the spare pool after
+     * the maximum number of patches has grown (see
+     * RXMeshDynamic::grow_spare_patches)
+     */
+    virtual void grow_num_patches(const uint32_t max_num_patches) = 0;
+
     virtual ~AttributeBase() = default;
 };
 
@@ -83,7 +190,12 @@ class Attribute : public AttributeBase
           m_h_ptr_on_device(nullptr),
           m_d_attr(nullptr),
           m_max_num_patches(0),
+          m_num_patch_slots(0),
+          m_d_slab(nullptr),
+          m_d_slab_bytes(0),
           m_layout(AoS),
+          m_stride(0),
+          m_h_state(new HostState()),
           m_memory_mega_bytes(0)
     {
 
@@ -116,7 +228,12 @@ class Attribute : public AttributeBase
           m_h_ptr_on_device(nullptr),
           m_d_attr(nullptr),
           m_max_num_patches(rxmesh->get_max_num_patches()),
+          m_num_patch_slots(rxmesh->get_num_patch_slots()),
+          m_d_slab(nullptr),
+          m_d_slab_bytes(0),
           m_layout(layout),
+          m_stride(element_stride(num_attributes, layout)),
+          m_h_state(new HostState()),
           m_memory_mega_bytes(0)
     {
         if (name != nullptr) {
@@ -315,13 +432,31 @@ class Attribute : public AttributeBase
     __host__ __device__ __forceinline__ uint32_t pitch_x() const
     {
 
-        return (m_layout == AoS) ? m_num_attributes : 1;
+        return (m_layout == SoA) ? 1 : m_stride;
     }
 
     __host__ __device__ __forceinline__ uint32_t pitch_y(const uint32_t p) const
     {
 
-        return (m_layout == AoS) ? 1 : capacity(p);
+        return (m_layout == SoA) ? capacity(p) : 1;
+    }
+
+    /**
+     * @brief number of T's reserved for the attributes of one mesh element.
+     * With AoSPadded, the number of attributes is rounded up to 2, 4, or the
+     * next multiple of 4
+     */
+    __host__ __device__ static constexpr uint32_t element_stride(
+        const uint32_t num_attributes,
+        const layoutT  layout)
+    {
+        if (layout != AoSPadded || num_attributes <= 1) {
+            return num_attributes;
+        }
+        if (num_attributes == 2) {
+            return 2;
+        }
+        return ((num_attributes + 3) / 4) * 4;
     }
 
     Attribute(const Attribute& rhs) = default;
@@ -352,6 +487,57 @@ class Attribute : public AttributeBase
         return this->m_num_attributes;
     }
 
+    /**
+     * @brief get the memory layout of the attribute
+     */
+    __host__ __device__ __forceinline__ layoutT get_layout() const
+    {
+        return this->m_layout;
+    }
+
+    /**
+     * @brief check if the host memory is page-locked (see pin_host_memory)
+     */
+    bool is_host_pinned() const
+    {
+        return m_h_state.get() != nullptr && m_h_state->pinned;
+    }
+
+    /**
+     * @brief allocate the host memory of the attribute as page-locked
+     * (pinned) memory (or back to pageable memory if pinned is false). With
+     * pinned host memory, move() and copy_from() between host and device are
+     * truly asynchronous w.r.t. the host and can overlap with kernels running
+     * on other streams. If the attribute is already allocated on the host,
+     * its values are kept. Patches that are reallocated later (see
+     * grow_patch) use pageable memory. The host memory is shared by all
+     * copies of the attribute and so pinning through any of them is seen by
+     * all of them
+     */
+    void pin_host_memory(const bool pinned = true)
+    {
+        HostState& state = host_state();
+        if (pinned == state.pinned) {
+            return;
+        }
+        state.pinned = pinned;
+
+        if (!is_host_allocated() || state.slab == nullptr) {
+            return;
+        }
+
+        char* slab = host_slab_alloc(state.slab_bytes, state.pinned);
+        std::memcpy(slab, state.slab, state.slab_bytes);
+        for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+            if (in_slab(m_h_attr[p], state.slab, state.slab_bytes)) {
+                m_h_attr[p] = reinterpret_cast<T*>(
+                    slab + (reinterpret_cast<char*>(m_h_attr[p]) - state.slab));
+            }
+        }
+        host_slab_free(state.slab, !state.pinned);
+        state.slab = slab;
+    }
+
     /**
      * @brief Flag that indicates where the memory is allocated
      */
@@ -402,7 +588,7 @@ class Attribute : public AttributeBase
 #pragma omp parallel for
             for (int p = 0; p < static_cast<int>(m_rxmesh->get_num_patches());
                  ++p) {
-                for (int e = 0; e < capacity(p); ++e) {
+                for (int e = 0; e < capacity(p) * m_stride; ++e) {
                     m_h_attr[p][e] = value;
                 }
             }
@@ -441,9 +627,13 @@ class Attribute : public AttributeBase
 
         if (((target & HOST) == HOST || (target & DEVICE) == DEVICE) &&
             ((target & m_allocated) != target)) {
-            RXMESH_WARN(
-                "Attribute::move() allocating target before moving to {}",
-                location_to_string(target));
+            // the host mirror of a device-only attribute is allocated
+            // lazily on its first move to the host
+            if (target != HOST) {
+                RXMESH_WARN(
+                    "Attribute::move() allocating target before moving to {}",
+                    location_to_string(target));
+            }
             allocate(target);
         }
 
@@ -451,49 +641,304 @@ class Attribute : public AttributeBase
             return;
         }
 
+        // if all patches live in the slabs at the same offsets, we copy the
+        // slab at once instead of one copy per patch
+        if (is_slab_mirrored()) {
+            if (source == HOST && target == DEVICE) {
+                Instrumentation::get().add_bytes("Attribute::move H2D",
+                                                 m_d_slab_bytes);
+                CUDA_ERROR(cudaMemcpyAsync(m_d_slab,
+                                           m_h_state->slab,
+                                           m_d_slab_bytes,
+                                           cudaMemcpyHostToDevice,
+                                           stream));
+                return;
+            }
+            if (source == DEVICE && target == HOST) {
+                Instrumentation::get().add_bytes("Attribute::move D2H",
+                                                 m_h_state->slab_bytes);
+                CUDA_ERROR(cudaMemcpyAsync(m_h_state->slab,
+                                           m_d_slab,
+                                           m_h_state->slab_bytes,
+                                           cudaMemcpyDeviceToHost,
+                                           stream));
+                return;
+            }
+        }
+
+        size_t num_bytes = 0;
         if (source == HOST && target == DEVICE) {
             for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                num_bytes += sizeof(T) * capacity(p) * m_stride;
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_ptr_on_device[p],
                                     m_h_attr[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    sizeof(T) * capacity(p) * m_stride,
                                     cudaMemcpyHostToDevice,
                                     stream));
             }
+            Instrumentation::get().add_bytes("Attribute::move H2D", num_bytes);
         } else if (source == DEVICE && target == HOST) {
             for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                num_bytes += sizeof(T) * capacity(p) * m_stride;
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_attr[p],
                                     m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    sizeof(T) * capacity(p) * m_stride,
                                     cudaMemcpyDeviceToHost,
                                     stream));
             }
+            Instrumentation::get().add_bytes("Attribute::move D2H", num_bytes);
+        }
+    }
+
+    /**
+     * @brief same as move() but also records an event on the stream after
+     * the transfer so the host (or another stream) can wait for this
+     * transfer only instead of the whole stream/device. The transfer is
+     * asynchronous w.r.t. the host only if the host memory is pinned (see
+     * pin_host_memory)
+     * @return the event that completes when the transfer is done. The event
+     * is owned by the attribute (shared by all its copies), is re-recorded by
+     * the next move_async(), and is destroyed by release()
+     */
+    cudaEvent_t move_async(locationT    source,
+                           locationT    target,
+                           cudaStream_t stream = NULL)
+    {
+        move(source, target, stream);
+        HostState& state = host_state();
+        if (state.transfer_done == NULL) {
+            CUDA_ERROR(cudaEventCreateWithFlags(&state.transfer_done,
+                                                cudaEventDisableTiming));
+        }
+        CUDA_ERROR(cudaEventRecord(state.transfer_done, stream));
+        return state.transfer_done;
+    }
+
+    /**
+     * @brief check (without blocking) if the last move_async() is done
+     */
+    bool is_transfer_done() const
+    {
+        if (m_h_state.get() == nullptr || m_h_state->transfer_done == NULL) {
+            return true;
+        }
+        cudaError_t status = cudaEventQuery(m_h_state->transfer_done);
+        if (status == cudaErrorNotReady) {
+            return false;
+        }
+        CUDA_ERROR(status);
+        return true;
+    }
+
+    /**
+     * @brief block the host until the last move_async() is done
+     */
+    void wait_transfer() const
+    {
+        if (m_h_state.get() != nullptr && m_h_state->transfer_done != NULL) {
+            CUDA_ERROR(cudaEventSynchronize(m_h_state->transfer_done));
+        }
+    }
+
+    /**
+     * @brief prefetch the device memory of a single patch to device (or to
+     * the host if device is cudaCpuDeviceId). This is a no-op unless the mesh
+     * is streamed in which case the device memory is managed
+     * @param patch_id the patch to prefetch
+     * @param device the destination device
+     * @param stream the stream used to prefetch
+     */
+    void prefetch(const uint32_t patch_id,
+                  const int      device,
+                  cudaStream_t   stream) const
+    {
+        if (m_rxmesh->is_device_memory_managed() && is_device_allocated() &&
+            patch_id < m_max_num_patches) {
+            CUDA_ERROR(cudaMemPrefetchAsync(
+                m_h_ptr_on_device[patch_id],
+                sizeof(T) * capacity(patch_id) * m_stride,
+                device,
+                stream));
+        }
+    }
+
+    /**
+     * @brief reallocate the memory of a single patch after its capacity has
+     * grown. The content is copied to the new memory i.e., the value of every
+     * element and every attribute is preserved
+     * @param patch_id the patch whose capacity has grown
+     * @param old_vertices_capacity the vertex capacity before growing
+     * @param old_edges_capacity the edge capacity before growing
+     * @param old_faces_capacity the face capacity before growing
+     */
+    void grow_patch(const uint32_t patch_id,
+                    const uint16_t old_vertices_capacity,
+                    const uint16_t old_edges_capacity,
+                    const uint16_t old_faces_capacity) override
+    {
+        if (patch_id >= m_max_num_patches) {
+            return;
+        }
+
+        uint16_t old_cap = old_faces_capacity;
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            old_cap = old_vertices_capacity;
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            old_cap = old_edges_capacity;
+        }
+
+        const uint16_t new_cap = capacity(patch_id);
+        if (new_cap <= old_cap) {
+            return;
+        }
+
+        const size_t old_bytes = sizeof(T) * old_cap * m_stride;
+        const size_t new_bytes = sizeof(T) * new_cap * m_stride;
+
+        // with AoS (padded or not), the old content is a prefix of the new
+        // one. With SoA,
+        // every attribute is a row whose pitch is the capacity
+        const bool   aos       = (m_layout != SoA);
+        const size_t width     = aos ? old_bytes : sizeof(T) * old_cap;
+        const size_t height    = aos ? 1 : m_num_attributes;
+        const size_t src_pitch = aos ? old_bytes : sizeof(T) * old_cap;
+        const size_t dst_pitch = aos ? new_bytes : sizeof(T) * new_cap;
+
+        if (is_host_allocated()) {
+            T* ptr = static_cast<T*>(malloc(new_bytes));
+            CUDA_ERROR(cudaMemcpy2D(ptr,
+                                    dst_pitch,
+                                    m_h_attr[patch_id],
+                                    src_pitch,
+                                    width,
+                                    height,
+                                    cudaMemcpyHostToHost));
+            if (!in_slab(m_h_attr[patch_id],
+                         m_h_state->slab,
+                         m_h_state->slab_bytes)) {
+                free(m_h_attr[patch_id]);
+            }
+            m_h_attr[patch_id] = ptr;
+        }
+
+        if (is_device_allocated()) {
+            T* ptr = nullptr;
+            CUDA_ERROR(device_malloc((void**)&ptr,
+                                     new_bytes,
+                                     m_rxmesh->is_device_memory_managed()));
+            CUDA_ERROR(cudaMemcpy2D(ptr,
+                                    dst_pitch,
+                                    m_h_ptr_on_device[patch_id],
+                                    src_pitch,
+                                    width,
+                                    height,
+                                    cudaMemcpyDeviceToDevice));
+            if (!in_slab(
+                    m_h_ptr_on_device[patch_id], m_d_slab, m_d_slab_bytes)) {
+                GPU_FREE(m_h_ptr_on_device[patch_id]);
+            }
+            m_h_ptr_on_device[patch_id] = ptr;
+            CUDA_ERROR(cudaMemcpy(m_d_attr + patch_id,
+                                  &ptr,
+                                  sizeof(T*),
+                                  cudaMemcpyHostToDevice));
+            m_memory_mega_bytes += BYTES_TO_MEGABYTES(new_bytes - old_bytes);
         }
     }
 
     /**
-     * @brief Release allocated memory in certain location
+     * @brief allocate the memory of the patches added to the spare pool i.e.,
+     * patches from the old maximum number of patches to max_num_patches
+     * @param max_num_patches the new maximum number of patches
+     */
+    void grow_num_patches(const uint32_t max_num_patches) override
+    {
+        if (max_num_patches <= m_max_num_patches || is_empty()) {
+            return;
+        }
+        assert(max_num_patches <= m_rxmesh->get_num_patch_slots());
+
+        const uint32_t begin = m_max_num_patches;
+        m_max_num_patches    = max_num_patches;
+
+        for (uint32_t p = begin; p < m_max_num_patches; ++p) {
+            const size_t num_bytes = sizeof(T) * capacity(p) * m_stride;
+            if (is_host_allocated()) {
+                m_h_attr[p] = static_cast<T*>(malloc(num_bytes));
+            }
+            if (is_device_allocated()) {
+                CUDA_ERROR(device_malloc((void**)&(m_h_ptr_on_device[p]),
+                                         num_bytes,
+                                         m_rxmesh->is_device_memory_managed()));
+                m_memory_mega_bytes += BYTES_TO_MEGABYTES(num_bytes);
+            }
+        }
+
+        if (is_device_allocated()) {
+            CUDA_ERROR(cudaMemcpy(m_d_attr + begin,
+                                  m_h_ptr_on_device + begin,
+                                  sizeof(T*) * (m_max_num_patches - begin),
+                                  cudaMemcpyHostToDevice));
+        }
+    }
+
+    /**
+     * @brief Release allocated memory in certain location. Releasing all
+     * locations also resets the state shared by all copies of the attribute
+     * (i.e., the transfer event and the pinned flag). The state itself is
+     * freed with the last host copy of the attribute
      * @param location where memory will be released
      */
     void release(locationT location = LOCATION_ALL)
     {
         if (((location & HOST) == HOST) && is_host_allocated()) {
-            for (uint32_t p = 0; p < m_rxmesh->get_max_num_patches(); ++p) {
-                free(m_h_attr[p]);
+            HostState& state = host_state();
+            for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                if (!in_slab(m_h_attr[p], state.slab, state.slab_bytes)) {
+                    free(m_h_attr[p]);
+                }
             }
+            host_slab_free(state.slab, state.pinned);
+            state.slab       = nullptr;
+            state.slab_bytes = 0;
             free(m_h_attr);
             m_h_attr    = nullptr;
             m_allocated = m_allocated & (~HOST);
         }
 
         if (((location & DEVICE) == DEVICE) && is_device_allocated()) {
-            for (uint32_t p = 0; p < m_rxmesh->get_max_num_patches(); ++p) {
-                GPU_FREE(m_h_ptr_on_device[p]);
+            for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                if (!in_slab(m_h_ptr_on_device[p], m_d_slab, m_d_slab_bytes)) {
+                    GPU_FREE(m_h_ptr_on_device[p]);
+                }
+            }
+            if (m_d_slab != nullptr) {
+                // the slab and the pointer table go back to the pool
+                AttributePool& pool = m_rxmesh->get_attribute_pool();
+                pool.recycle(m_d_slab, m_d_slab_bytes);
+                pool.recycle(m_d_attr, sizeof(T*) * m_num_patch_slots);
+                m_d_slab       = nullptr;
+                m_d_slab_bytes = 0;
+                m_d_attr       = nullptr;
+            } else {
+                GPU_FREE(m_d_attr);
             }
-            GPU_FREE(m_d_attr);
             m_allocated = m_allocated & (~DEVICE);
         }
+
+        if (m_h_state.get() != nullptr && m_allocated == LOCATION_NONE &&
+            m_h_state->transfer_done != NULL) {
+            CUDA_ERROR(cudaEventDestroy(m_h_state->transfer_done));
+            m_h_state->transfer_done = NULL;
+        }
+
+        if (location == LOCATION_ALL && m_allocated == LOCATION_NONE &&
+            m_h_state.get() != nullptr) {
+            *m_h_state.get() = HostState();
+        }
     }
 
     /**
@@ -554,10 +999,21 @@ class Attribute : public AttributeBase
                 return;
             }
 
-            for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
-                std::memcpy(m_h_attr[p],
-                            source.m_h_attr[p],
-                            sizeof(T) * capacity(p) * m_num_attributes);
+            if (same_slab_layout(m_h_attr,
+                                 m_h_state->slab,
+                                 m_h_state->slab_bytes,
+                                 source.m_h_attr,
+                                 source.m_h_state->slab,
+                                 source.m_h_state->slab_bytes)) {
+                std::memcpy(m_h_state->slab,
+                            source.m_h_state->slab,
+                            m_h_state->slab_bytes);
+            } else {
+                for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                    std::memcpy(m_h_attr[p],
+                                source.m_h_attr[p],
+                                sizeof(T) * capacity(p) * m_stride);
+                }
             }
         }
 
@@ -577,13 +1033,26 @@ class Attribute : public AttributeBase
                 return;
             }
 
-            for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
-                CUDA_ERROR(
-                    cudaMemcpyAsync(m_h_ptr_on_device[p],
-                                    source.m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
-                                    cudaMemcpyDeviceToDevice,
-                                    stream));
+            if (same_slab_layout(m_h_ptr_on_device,
+                                 m_d_slab,
+                                 m_d_slab_bytes,
+                                 source.m_h_ptr_on_device,
+                                 source.m_d_slab,
+                                 source.m_d_slab_bytes)) {
+                CUDA_ERROR(cudaMemcpyAsync(m_d_slab,
+                                           source.m_d_slab,
+                                           m_d_slab_bytes,
+                                           cudaMemcpyDeviceToDevice,
+                                           stream));
+            } else {
+                for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                    CUDA_ERROR(
+                        cudaMemcpyAsync(m_h_ptr_on_device[p],
+                                        source.m_h_ptr_on_device[p],
+                                        sizeof(T) * capacity(p) * m_stride,
+                                        cudaMemcpyDeviceToDevice,
+                                        stream));
+                }
             }
         }
 
@@ -604,13 +1073,26 @@ class Attribute : public AttributeBase
             }
 
 
-            for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
-                CUDA_ERROR(
-                    cudaMemcpyAsync(m_h_attr[p],
-                                    source.m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
-                                    cudaMemcpyDeviceToHost,
-                                    stream));
+            if (same_slab_layout(m_h_attr,
+                                 m_h_state->slab,
+                                 m_h_state->slab_bytes,
+                                 source.m_h_ptr_on_device,
+                                 source.m_d_slab,
+                                 source.m_d_slab_bytes)) {
+                CUDA_ERROR(cudaMemcpyAsync(m_h_state->slab,
+                                           source.m_d_slab,
+                                           m_h_state->slab_bytes,
+                                           cudaMemcpyDeviceToHost,
+                                           stream));
+            } else {
+                for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                    CUDA_ERROR(
+                        cudaMemcpyAsync(m_h_attr[p],
+                                        source.m_h_ptr_on_device[p],
+                                        sizeof(T) * capacity(p) * m_stride,
+                                        cudaMemcpyDeviceToHost,
+                                        stream));
+                }
             }
         }
 
@@ -631,13 +1113,26 @@ class Attribute : public AttributeBase
             }
 
 
-            for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
-                CUDA_ERROR(
-                    cudaMemcpyAsync(m_h_ptr_on_device[p],
-                                    source.m_h_attr[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
-                                    cudaMemcpyHostToDevice,
-                                    stream));
+            if (same_slab_layout(m_h_ptr_on_device,
+                                 m_d_slab,
+                                 m_d_slab_bytes,
+                                 source.m_h_attr,
+                                 source.m_h_state->slab,
+                                 source.m_h_state->slab_bytes)) {
+                CUDA_ERROR(cudaMemcpyAsync(m_d_slab,
+                                           source.m_h_state->slab,
+                                           m_d_slab_bytes,
+                                           cudaMemcpyHostToDevice,
+                                           stream));
+            } else {
+                for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+                    CUDA_ERROR(
+                        cudaMemcpyAsync(m_h_ptr_on_device[p],
+                                        source.m_h_attr[p],
+                                        sizeof(T) * capacity(p) * m_stride,
+                                        cudaMemcpyHostToDevice,
+                                        stream));
+                }
             }
         }
     }
@@ -670,6 +1165,101 @@ class Attribute : public AttributeBase
         return this->operator()(pl.first, pl.second, attr);
     }
 
+    /**
+     * @brief read the first N attributes of a mesh element as a vector. With
+     * AoSPadded layout and float/double/int attributes, this is done on the
+     * device using one (or two for double) vector load instead of N scalar
+     * loads. Other layouts and types fall back to scalar loads. Can be used
+     * inside for_each and query lambdas
+     * @param handle input handle
+     */
+    template <int N>
+    __host__ __device__ __forceinline__ glm::vec<N, T, glm::defaultp> load_vec(
+        const HandleT handle) const
+    {
+        static_assert(N >= 1 && N <= 4, "load_vec() N should be in [1, 4]");
+        assert(uint32_t(N) <= m_num_attributes);
+
+        glm::vec<N, T, glm::defaultp> ret;
+#ifdef __CUDA_ARCH__
+        if (m_layout == AoSPadded && N > 1) {
+            const T* ptr = &this->operator()(handle, 0);
+            if constexpr (sizeof(T) == 4 && N == 2) {
+                const float2 v = *reinterpret_cast<const float2*>(ptr);
+                memcpy(&ret[0], &v, sizeof(T) * N);
+                return ret;
+            }
+            if constexpr (sizeof(T) == 4 && N > 2) {
+                const float4 v = *reinterpret_cast<const float4*>(ptr);
+                memcpy(&ret[0], &v, sizeof(T) * N);
+                return ret;
+            }
+            if constexpr (sizeof(T) == 8) {
+                const double2 v0 = *reinterpret_cast<const double2*>(ptr);
+                memcpy(&ret[0], &v0, sizeof(T) * 2);
+                if constexpr (N > 2) {
+                    const double2 v1 =
+                        *reinterpret_cast<const double2*>(ptr + 2);
+                    memcpy(&ret[2], &v1, sizeof(T) * (N - 2));
+                }
+                return ret;
+            }
+        }
+#endif
+        for (int i = 0; i < N; ++i) {
+            ret[i] = this->operator()(handle, i);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief write a vector into the first N attributes of a mesh element.
+     * See load_vec(). Attributes after the N-th one are left unchanged
+     * @param handle input handle
+     * @param val the value to be written
+     */
+    template <int N>
+    __host__ __device__ __forceinline__ void store_vec(
+        const HandleT                        handle,
+        const glm::vec<N, T, glm::defaultp>& val) const
+    {
+        static_assert(N >= 1 && N <= 4, "store_vec() N should be in [1, 4]");
+        assert(uint32_t(N) <= m_num_attributes);
+
+#ifdef __CUDA_ARCH__
+        if (m_layout == AoSPadded && N > 1) {
+            T* ptr = &this->operator()(handle, 0);
+            if constexpr (sizeof(T) == 4 && N == 2) {
+                float2 v;
+                memcpy(&v, &val[0], sizeof(T) * N);
+                *reinterpret_cast<float2*>(ptr) = v;
+                return;
+            }
+            if constexpr (sizeof(T) == 4 && N > 2) {
+                // keep the attributes after the N-th one (if any) intact
+                float4 v = *reinterpret_cast<const float4*>(ptr);
+                memcpy(&v, &val[0], sizeof(T) * N);
+                *reinterpret_cast<float4*>(ptr) = v;
+                return;
+            }
+            if constexpr (sizeof(T) == 8) {
+                double2 v0;
+                memcpy(&v0, &val[0], sizeof(T) * 2);
+                *reinterpret_cast<double2*>(ptr) = v0;
+                if constexpr (N > 2) {
+                    double2 v1 = *reinterpret_cast<const double2*>(ptr + 2);
+                    memcpy(&v1, &val[2], sizeof(T) * (N - 2));
+                    *reinterpret_cast<double2*>(ptr + 2) = v1;
+                }
+                return;
+            }
+        }
+#endif
+        for (int i = 0; i < N; ++i) {
+            this->operator()(handle, i) = val[i];
+        }
+    }
+
     /**
      * @brief Access the attribute value using patch and local index in the
      * patch. This is meant to be used by XXAttribute not directly by the user
@@ -682,7 +1272,7 @@ class Attribute : public AttributeBase
                                                       const uint16_t local_id,
                                                       const uint32_t attr) const
     {
-        assert(p_id < m_max_num_patches);
+        assert(p_id < m_num_patch_slots);
         assert(attr < m_num_attributes);
 
 #ifdef __CUDA_ARCH__
@@ -706,7 +1296,7 @@ class Attribute : public AttributeBase
                                                       const uint16_t local_id,
                                                       const uint32_t attr)
     {
-        assert(p_id < m_max_num_patches);
+        assert(p_id < m_num_patch_slots);
         assert(attr < m_num_attributes);
 
 #ifdef __CUDA_ARCH__
@@ -738,12 +1328,19 @@ class Attribute : public AttributeBase
             if ((location & HOST) == HOST) {
                 release(HOST);
 
-                m_h_attr =
-                    static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
+                // the table has an entry for every patch slot so the spare
+                // pool can grow without reallocating it
+                m_h_attr = static_cast<T**>(
+                    malloc(sizeof(T*) * m_rxmesh->get_num_patch_slots()));
 
+                HostState& state = host_state();
+                state.slab_bytes = slab_num_bytes();
+                state.slab = host_slab_alloc(state.slab_bytes, state.pinned);
+
+                size_t offset = 0;
                 for (uint32_t p = 0; p < m_max_num_patches; ++p) {
-                    m_h_attr[p] = static_cast<T*>(
-                        malloc(sizeof(T) * capacity(p) * m_num_attributes));
+                    m_h_attr[p] = reinterpret_cast<T*>(state.slab + offset);
+                    offset += slab_patch_num_bytes(p);
                 }
 
                 m_allocated = m_allocated | HOST;
@@ -753,31 +1350,198 @@ class Attribute : public AttributeBase
                 release(DEVICE);
 
 
-                CUDA_ERROR(cudaMalloc((void**)&(m_d_attr),
-                                      sizeof(T*) * m_max_num_patches));
+                const uint32_t num_slots = m_rxmesh->get_num_patch_slots();
+
+                // in streaming and multi-GPU modes, the per-patch memory is
+                // managed so that it can be evicted to the host (see
+                // PatchResidency) or placed on its owner GPU (see
+                // PatchPartition). So every patch is allocated on its own.
+                // Otherwise, the patches are allocated as one slab taken from
+                // the attribute pool along with the pointer table
+                const bool managed = m_rxmesh->is_device_memory_managed();
+
+                if (managed) {
+                    CUDA_ERROR(device_malloc((void**)&(m_d_attr),
+                                             sizeof(T*) * num_slots,
+                                             m_rxmesh->is_multi_gpu()));
+                } else {
+                    m_d_attr =
+                        static_cast<T**>(m_rxmesh->get_attribute_pool().acquire(
+                            sizeof(T*) * num_slots));
+                }
                 m_memory_mega_bytes +=
-                    BYTES_TO_MEGABYTES(sizeof(T*) * m_max_num_patches);
+                    BYTES_TO_MEGABYTES(sizeof(T*) * num_slots);
 
                 m_h_ptr_on_device =
-                    static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
-
-                for (uint32_t p = 0; p < m_max_num_patches; ++p) {
-                    CUDA_ERROR(
-                        cudaMalloc((void**)&(m_h_ptr_on_device[p]),
-                                   sizeof(T) * capacity(p) * m_num_attributes));
-
-                    m_memory_mega_bytes += BYTES_TO_MEGABYTES(
-                        sizeof(T) * capacity(p) * m_num_attributes);
+                    static_cast<T**>(malloc(sizeof(T*) * num_slots));
+
+                if (managed) {
+                    for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                        CUDA_ERROR(device_malloc(
+                            (void**)&(m_h_ptr_on_device[p]),
+                            sizeof(T) * capacity(p) * m_stride,
+                            true));
+                        m_rxmesh->get_partition().place_patch_memory(
+                            p,
+                            m_h_ptr_on_device[p],
+                            sizeof(T) * capacity(p) * m_stride,
+                            false);
+
+                        m_memory_mega_bytes += BYTES_TO_MEGABYTES(
+                            sizeof(T) * capacity(p) * m_stride);
+                    }
+                } else {
+                    m_d_slab_bytes = slab_num_bytes();
+                    m_d_slab       = static_cast<char*>(
+                        m_rxmesh->get_attribute_pool().acquire(m_d_slab_bytes));
+                    m_memory_mega_bytes += BYTES_TO_MEGABYTES(m_d_slab_bytes);
+
+                    size_t offset = 0;
+                    for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                        m_h_ptr_on_device[p] =
+                            reinterpret_cast<T*>(m_d_slab + offset);
+                        offset += slab_patch_num_bytes(p);
+                    }
                 }
                 CUDA_ERROR(cudaMemcpy(m_d_attr,
                                       m_h_ptr_on_device,
                                       sizeof(T*) * m_max_num_patches,
                                       cudaMemcpyHostToDevice));
+                m_rxmesh->get_partition().place_shared_memory(
+                    m_d_attr, sizeof(T*) * num_slots);
                 m_allocated = m_allocated | DEVICE;
             }
         }
     }
 
+    /**
+     * @brief the number of bytes a patch takes in a slab. Every patch starts
+     * at an offset aligned to slab_alignment
+     */
+    size_t slab_patch_num_bytes(const uint32_t p) const
+    {
+        return ROUND_UP_TO_NEXT_MULTIPLE(
+            sizeof(T) * capacity(p) * m_stride, slab_alignment);
+    }
+
+    /**
+     * @brief the size of the slab that holds all patches
+     */
+    size_t slab_num_bytes() const
+    {
+        size_t num_bytes = 0;
+        for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+            num_bytes += slab_patch_num_bytes(p);
+        }
+        return num_bytes;
+    }
+
+    /**
+     * @brief check if a patch pointer points into a slab
+     */
+    static bool in_slab(const T* ptr, const char* slab, const size_t num_bytes)
+    {
+        const char* c = reinterpret_cast<const char*>(ptr);
+        return slab != nullptr && c >= slab && c < slab + num_bytes;
+    }
+
+    /**
+     * @brief check if the host and device slabs hold every patch at the same
+     * offset so that they can be copied with a single memcpy
+     */
+    bool is_slab_mirrored() const
+    {
+        return same_slab_layout(m_h_attr,
+                                m_h_state->slab,
+                                m_h_state->slab_bytes,
+                                m_h_ptr_on_device,
+                                m_d_slab,
+                                m_d_slab_bytes);
+    }
+
+    /**
+     * @brief check if two slabs (of this or another attribute, on the host or
+     * device) hold every patch at the same offset
+     */
+    bool same_slab_layout(T* const*    a,
+                          const char*  a_slab,
+                          const size_t a_bytes,
+                          T* const*    b,
+                          const char*  b_slab,
+                          const size_t b_bytes) const
+    {
+        if (a_slab == nullptr || b_slab == nullptr || a_bytes != b_bytes) {
+            return false;
+        }
+        for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+            const char* pa = reinterpret_cast<const char*>(a[p]);
+            const char* pb = reinterpret_cast<const char*>(b[p]);
+            if (!in_slab(a[p], a_slab, a_bytes) ||
+                !in_slab(b[p], b_slab, b_bytes) || pa - a_slab != pb - b_slab) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief the host slab (see m_h_attr), whether it is page-locked (see
+     * pin_host_memory), and the event recorded by move_async(). Like the
+     * pointer tables, this is shared by all copies of the attribute such that
+     * pinning through a copy is seen by the others and by release()
+     */
+    struct HostState
+    {
+        char*       slab          = nullptr;
+        size_t      slab_bytes    = 0;
+        bool        pinned        = false;
+        cudaEvent_t transfer_done = NULL;
+    };
+
+    using HostStatePtr = detail::HostSharedPtr<HostState>;
+
+    /**
+     * @brief the shared host state which is created on first use if the
+     * attribute does not have one yet
+     */
+    HostState& host_state()
+    {
+        if (m_h_state.get() == nullptr) {
+            m_h_state.reset(new HostState());
+        }
+        return *m_h_state.get();
+    }
+
+    /**
+     * @brief allocate a host slab as pageable or page-locked memory
+     */
+    static char* host_slab_alloc(const size_t num_bytes, const bool pinned)
+    {
+        char* ptr = nullptr;
+        if (pinned) {
+            CUDA_ERROR(cudaMallocHost((void**)&ptr,
+                                      std::max(num_bytes, size_t(1))));
+        } else {
+            ptr = static_cast<char*>(malloc(std::max(num_bytes, size_t(1))));
+        }
+        return ptr;
+    }
+
+    /**
+     * @brief free a host slab allocated by host_slab_alloc
+     */
+    static void host_slab_free(char* ptr, const bool pinned)
+    {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (pinned) {
+            CUDA_ERROR(cudaFreeHost(ptr));
+        } else {
+            free(ptr);
+        }
+    }
+
     const RXMeshStatic* m_rxmesh;
     const PatchInfo*    m_h_patches_info;
     const PatchInfo*    m_d_patches_info;
@@ -788,10 +1552,29 @@ class Attribute : public AttributeBase
     T**                 m_h_ptr_on_device;
     T**                 m_d_attr;
     uint32_t            m_max_num_patches;
+    // the pointer tables are allocated for all patch slots so copies of the
+    // attribute taken before the spare pool grows are still valid
+    uint32_t            m_num_patch_slots;
+    // the values of all patches are allocated as one slab per location where
+    // every patch starts at an aligned offset. A patch reallocated later (see
+    // grow_patch and grow_num_patches) gets its own allocation outside the
+    // slab
+    char*               m_d_slab;
+    size_t              m_d_slab_bytes;
     layoutT             m_layout;
+    // number of T's between the attributes of two consecutive elements with
+    // AoS. With AoSPadded, this is num_attributes rounded up to 2 or 4 (or a
+    // multiple of 4) so every element starts at a vector-aligned address
+    uint32_t            m_stride;
+    // the host slab, whether it is pinned, and the transfer event. Shared by
+    // all (host) copies of the attribute and freed with the last of them
+    // (see HostState)
+    HostStatePtr        m_h_state;
     double              m_memory_mega_bytes;
 
     constexpr static uint32_t m_block_size = 256;
+
+    constexpr static size_t slab_alignment = 256;
 };
 
 template <class T>
@@ -893,6 +1676,47 @@ class AttributeContainer
         return false;
     }
 
+    /**
+     * @brief prefetch the memory of a single patch of all attributes (see
+     * Attribute::prefetch)
+     */
+    void prefetch(const uint32_t patch_id,
+                  const int      device,
+                  cudaStream_t   stream) const
+    {
+        for (size_t i = 0; i < m_attr_container.size(); ++i) {
+            m_attr_container[i]->prefetch(patch_id, device, stream);
+        }
+    }
+
+    /**
+     * @brief reallocate the memory of a single patch of all attributes after
+     * its capacity has grown (see Attribute::grow_patch)
+     */
+    void grow_patch(const uint32_t patch_id,
+                    const uint16_t old_vertices_capacity,
+                    const uint16_t old_edges_capacity,
+                    const uint16_t old_faces_capacity)
+    {
+        for (size_t i = 0; i < m_attr_container.size(); ++i) {
+            m_attr_container[i]->grow_patch(patch_id,
+                                            old_vertices_capacity,
+                                            old_edges_capacity,
+                                            old_faces_capacity);
+        }
+    }
+
+    /**
+     * @brief allocate the memory of new spare patches of all attributes (see
+     * Attribute::grow_num_patches)
+     */
+    void grow_num_patches(const uint32_t max_num_patches)
+    {
+        for (size_t i = 0; i < m_attr_container.size(); ++i) {
+            m_attr_container[i]->grow_num_patches(max_num_patches);
+        }
+    }
+
     /**
      * @brief remove an attribute and release its memory
      * @param name of the attribute
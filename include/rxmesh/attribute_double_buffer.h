@@ -0,0 +1,180 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <cuda_runtime.h>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Double-buffered copy-out of a device attribute i.e., "export while
+ * computing". Every call to snapshot() takes a device-to-device copy of the
+ * attribute on the compute stream (which is cheap) and then copies this
+ * snapshot to the host on a separate copy stream into page-locked memory. So
+ * the compute stream moves on to the next frame immediately while the
+ * previous frame is copied out. front() returns the host copy of the most
+ * recent snapshot after waiting for its transfer only. Two staging buffers
+ * are used so the host could read (e.g., write to disk) the last snapshot
+ * while the next one is being copied. The host values returned by front()
+ * are valid until the second-next call to snapshot().
+ *
+ * Typical use in a frame loop:
+ *
+ *   AttributeDoubleBuffer<float, VertexHandle> out(rx, *coords, "out");
+ *   for (int frame = 0; ...; ++frame) {
+ *       compute(frame, stream);
+ *       out.snapshot(*coords, stream);
+ *       if (frame > 0) {
+ *           write_to_disk(out.back());  // previous frame
+ *       }
+ *   }
+ *   write_to_disk(out.front());         // last frame
+ */
+template <typename T, typename HandleT>
+class AttributeDoubleBuffer
+{
+   public:
+    using AttributeT = Attribute<T, HandleT>;
+
+    /**
+     * @brief create the two staging buffers with the same number of
+     * attributes and layout as attr. The buffers are attributes owned by rx
+     * and are allocated on the host (pinned) and device
+     * @param rx the mesh
+     * @param attr the attribute to be exported
+     * @param name prefix of the staging attributes names
+     */
+    AttributeDoubleBuffer(RXMeshStatic&      rx,
+                          const AttributeT&  attr,
+                          const std::string& name)
+        : m_rx(rx), m_name(name), m_current(1), m_num_snapshots(0)
+    {
+        for (int i = 0; i < 2; ++i) {
+            m_buffer[i] =
+                rx.add_attribute<T, HandleT>(name + "_" + std::to_string(i),
+                                             attr.get_num_attributes(),
+                                             LOCATION_ALL,
+                                             attr.get_layout());
+            m_buffer[i]->pin_host_memory();
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_taken[i],
+                                                cudaEventDisableTiming));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_copied[i],
+                                                cudaEventDisableTiming));
+        }
+        CUDA_ERROR(
+            cudaStreamCreateWithFlags(&m_copy_stream, cudaStreamNonBlocking));
+    }
+
+    AttributeDoubleBuffer(const AttributeDoubleBuffer&)            = delete;
+    AttributeDoubleBuffer& operator=(const AttributeDoubleBuffer&) = delete;
+
+    ~AttributeDoubleBuffer()
+    {
+        CUDA_ERROR(cudaStreamSynchronize(m_copy_stream));
+        for (int i = 0; i < 2; ++i) {
+            CUDA_ERROR(cudaEventDestroy(m_taken[i]));
+            CUDA_ERROR(cudaEventDestroy(m_copied[i]));
+            m_rx.remove_attribute(m_name + "_" + std::to_string(i));
+        }
+        CUDA_ERROR(cudaStreamDestroy(m_copy_stream));
+    }
+
+    /**
+     * @brief take a snapshot of the device values of attr after the work
+     * already enqueued on stream and start copying it to the host. This call
+     * does not block the host and the work enqueued later on stream is not
+     * ordered after the copy to the host
+     * @param attr the attribute to take a snapshot of (allocated on the
+     * device)
+     * @param stream the stream on which attr is computed
+     */
+    void snapshot(AttributeT& attr, cudaStream_t stream = NULL)
+    {
+        const int b = 1 - m_current;
+
+        // the device buffer could still be read by the copy-out of the
+        // snapshot taken two calls ago
+        CUDA_ERROR(cudaStreamWaitEvent(stream, m_copied[b], 0));
+        m_buffer[b]->copy_from(attr, DEVICE, DEVICE, stream);
+        CUDA_ERROR(cudaEventRecord(m_taken[b], stream));
+
+        CUDA_ERROR(cudaStreamWaitEvent(m_copy_stream, m_taken[b], 0));
+        m_buffer[b]->move(DEVICE, HOST, m_copy_stream);
+        CUDA_ERROR(cudaEventRecord(m_copied[b], m_copy_stream));
+
+        m_current = b;
+        m_num_snapshots++;
+    }
+
+    /**
+     * @brief check (without blocking) if the most recent snapshot is on the
+     * host
+     */
+    bool is_ready() const
+    {
+        cudaError_t status = cudaEventQuery(m_copied[m_current]);
+        if (status == cudaErrorNotReady) {
+            return false;
+        }
+        CUDA_ERROR(status);
+        return true;
+    }
+
+    /**
+     * @brief the host values of the most recent snapshot. Blocks until its
+     * copy to the host is done
+     */
+    const AttributeT& front() const
+    {
+        CUDA_ERROR(cudaEventSynchronize(m_copied[m_current]));
+        return *m_buffer[m_current];
+    }
+
+    /**
+     * @brief the host values of the snapshot before the most recent one.
+     * This is what should be exported while the most recent snapshot is
+     * still being copied
+     */
+    const AttributeT& back() const
+    {
+        if (m_num_snapshots < 2) {
+            RXMESH_ERROR(
+                "AttributeDoubleBuffer::back() less than two snapshots were "
+                "taken");
+        }
+        CUDA_ERROR(cudaEventSynchronize(m_copied[1 - m_current]));
+        return *m_buffer[1 - m_current];
+    }
+
+    /**
+     * @brief number of snapshots taken so far
+     */
+    uint32_t get_num_snapshots() const
+    {
+        return m_num_snapshots;
+    }
+
+    /**
+     * @brief the stream used to copy the snapshots to the host
+     */
+    cudaStream_t get_copy_stream() const
+    {
+        return m_copy_stream;
+    }
+
+   private:
+    RXMeshStatic&               m_rx;
+    std::string                 m_name;
+    std::shared_ptr<AttributeT> m_buffer[2];
+    cudaEvent_t                 m_taken[2];
+    cudaEvent_t                 m_copied[2];
+    cudaStream_t                m_copy_stream;
+    int                         m_current;
+    uint32_t                    m_num_snapshots;
+};
+}  // namespace rxmesh
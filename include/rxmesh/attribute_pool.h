@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+
+#include <cuda_runtime.h>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Pool of device allocations used by the attributes of a mesh. Every
+ * attribute allocates its device memory (the values of all patches and the
+ * per-patch pointer table) as a few slabs. When an attribute is released, its
+ * slabs are kept in the pool and handed to the next attribute that needs a
+ * slab of the same size i.e., an attribute of the same type, number of
+ * attributes, and mesh element. This removes the cudaMalloc/cudaFree of
+ * temporary attributes that are created and released repeatedly (e.g., inside
+ * a solver or remeshing loop). The cached slabs are freed by clear() or when
+ * the mesh is destroyed
+ */
+class AttributePool
+{
+   public:
+    AttributePool() : m_cached_bytes(0), m_num_allocations(0)
+    {
+    }
+
+    AttributePool(const AttributePool&)            = delete;
+    AttributePool& operator=(const AttributePool&) = delete;
+
+    ~AttributePool()
+    {
+        clear();
+    }
+
+    /**
+     * @brief get a device allocation of num_bytes. A cached allocation of the
+     * same size is reused if there is one. Otherwise, new memory is allocated
+     */
+    void* acquire(const size_t num_bytes)
+    {
+        auto it = m_free.find(num_bytes);
+        if (it != m_free.end()) {
+            void* ptr = it->second;
+            m_free.erase(it);
+            m_cached_bytes -= num_bytes;
+            return ptr;
+        }
+
+        void* ptr = nullptr;
+        CUDA_ERROR(cudaMalloc(&ptr, std::max(num_bytes, size_t(1))));
+        m_num_allocations++;
+        return ptr;
+    }
+
+    /**
+     * @brief return an allocation (obtained by acquire()) to the pool so it
+     * could be reused
+     */
+    void recycle(void* ptr, const size_t num_bytes)
+    {
+        if (ptr == nullptr) {
+            return;
+        }
+        m_free.emplace(num_bytes, ptr);
+        m_cached_bytes += num_bytes;
+    }
+
+    /**
+     * @brief free all cached allocations
+     */
+    void clear()
+    {
+        for (auto& it : m_free) {
+            GPU_FREE(it.second);
+        }
+        m_free.clear();
+        m_cached_bytes = 0;
+    }
+
+    /**
+     * @brief the total size of the cached (free) allocations in bytes
+     */
+    size_t get_cached_bytes() const
+    {
+        return m_cached_bytes;
+    }
+
+    /**
+     * @brief number of cached (free) allocations
+     */
+    size_t get_num_cached() const
+    {
+        return m_free.size();
+    }
+
+    /**
+     * @brief number of device allocations done by the pool so far i.e.,
+     * acquire() calls that could not be served from the cache
+     */
+    uint32_t get_num_allocations() const
+    {
+        return m_num_allocations;
+    }
+
+   private:
+    std::multimap<size_t, void*> m_free;
+    size_t                       m_cached_bytes;
+    uint32_t                     m_num_allocations;
+};
+}  // namespace rxmesh
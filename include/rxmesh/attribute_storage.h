@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+
+#include <limits>
+#include <type_traits>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/types.h"
+
+namespace rxmesh {
+
+/*
+ * Reduced-precision storage for attributes. Attribute<T> stores any T
+ * so attributes could be stored as __half or __nv_bfloat16 (half the bytes of
+ * float) while the arithmetic is done in float after reading into registers.
+ * The helpers here convert between storage and compute types, read/write vec3
+ * of any storage type, convert between attributes of different types, and
+ * between attributes and DenseMatrix. QuantizedCoordinates stores vertex
+ * coordinates as 16-bit fixed point relative to the mesh bounding box
+ */
+
+/**
+ * @brief convert between storage types. Arithmetic types are converted
+ * directly while __half and __nv_bfloat16 are converted through float
+ */
+template <typename ToT, typename FromT>
+__host__ __device__ __inline__ ToT storage_cast(const FromT v)
+{
+    if constexpr (std::is_same_v<ToT, FromT>) {
+        return v;
+    } else if constexpr (std::is_same_v<FromT, __half>) {
+        return storage_cast<ToT>(__half2float(v));
+    } else if constexpr (std::is_same_v<FromT, __nv_bfloat16>) {
+        return storage_cast<ToT>(__bfloat162float(v));
+    } else if constexpr (std::is_same_v<ToT, __half>) {
+        return __float2half(static_cast<float>(v));
+    } else if constexpr (std::is_same_v<ToT, __nv_bfloat16>) {
+        return __float2bfloat16(static_cast<float>(v));
+    } else {
+        return static_cast<ToT>(v);
+    }
+}
+
+/**
+ * @brief read three consecutive attributes of a mesh element as a vec3 of the
+ * compute type (float by default) regardless of the storage type
+ */
+template <typename ComputeT = float, typename T, typename HandleT>
+__host__ __device__ __inline__ vec3<ComputeT> load_vec3(
+    const Attribute<T, HandleT>& attr,
+    const HandleT&               h)
+{
+    if constexpr (std::is_same_v<ComputeT, T>) {
+        return attr.template load_vec<3>(h);
+    }
+    return vec3<ComputeT>(storage_cast<ComputeT>(attr(h, 0)),
+                          storage_cast<ComputeT>(attr(h, 1)),
+                          storage_cast<ComputeT>(attr(h, 2)));
+}
+
+/**
+ * @brief write a vec3 of the compute type into three consecutive attributes of
+ * a mesh element converting it to the storage type
+ */
+template <typename ComputeT, typename T, typename HandleT>
+__host__ __device__ __inline__ void store_vec3(
+    const Attribute<T, HandleT>& attr,
+    const HandleT&               h,
+    const vec3<ComputeT>&        v)
+{
+    if constexpr (std::is_same_v<ComputeT, T>) {
+        attr.template store_vec<3>(h, v);
+        return;
+    }
+    attr(h, 0) = storage_cast<T>(v[0]);
+    attr(h, 1) = storage_cast<T>(v[1]);
+    attr(h, 2) = storage_cast<T>(v[2]);
+}
+
+namespace detail {
+template <typename ToT, typename FromT, typename HandleT, uint32_t blockSize>
+__launch_bounds__(blockSize) __global__
+    void convert_attribute_kernel(const Attribute<FromT, HandleT> src,
+                                  Attribute<ToT, HandleT>         dst,
+                                  const uint32_t                  num_patches,
+                                  const uint32_t num_attributes)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id < num_patches) {
+        const uint16_t element_per_patch = src.size(p_id);
+        for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
+            for (uint32_t j = 0; j < num_attributes; ++j) {
+                dst(p_id, i, j) = storage_cast<ToT>(src(p_id, i, j));
+            }
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief convert the values of an attribute into another attribute of a
+ * different storage type (e.g., float coordinates to __half coordinates) on
+ * the host, device, or both
+ * @param src the source attribute
+ * @param dst the destination attribute with the same number of attributes
+ * @param location where the conversion happens. Both src and dst should be
+ * allocated there
+ * @param stream the stream used to launch the conversion kernel on the device
+ */
+template <typename ToT, typename FromT, typename HandleT>
+void convert_attribute(const RXMeshStatic&              rx,
+                       const Attribute<FromT, HandleT>& src,
+                       Attribute<ToT, HandleT>&         dst,
+                       locationT                        location,
+                       cudaStream_t                     stream = NULL)
+{
+    if (src.get_num_attributes() != dst.get_num_attributes()) {
+        RXMESH_ERROR(
+            "convert_attribute() the number of attributes is different ({} "
+            "vs. {})",
+            src.get_num_attributes(),
+            dst.get_num_attributes());
+        return;
+    }
+
+    const uint32_t num_attributes = src.get_num_attributes();
+
+    if ((location & DEVICE) == DEVICE) {
+        if (!src.is_device_allocated() || !dst.is_device_allocated()) {
+            RXMESH_ERROR(
+                "convert_attribute() the attributes are not allocated on the "
+                "device");
+        } else {
+            constexpr uint32_t blockSize = 256;
+            detail::convert_attribute_kernel<ToT, FromT, HandleT, blockSize>
+                <<<rx.get_num_patches(), blockSize, 0, stream>>>(
+                    src, dst, rx.get_num_patches(), num_attributes);
+        }
+    }
+
+    if ((location & HOST) == HOST) {
+        if (!src.is_host_allocated() || !dst.is_host_allocated()) {
+            RXMESH_ERROR(
+                "convert_attribute() the attributes are not allocated on the "
+                "host");
+        } else {
+            rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+                for (uint32_t j = 0; j < num_attributes; ++j) {
+                    dst(h, j) = storage_cast<ToT>(src(h, j));
+                }
+            });
+        }
+    }
+}
+
+/**
+ * @brief convert the host values of an attribute of any storage type into a
+ * dense matrix of the compute type where rows are the mesh elements (in
+ * linear_id() order) and columns are the attributes. The matrix is moved to
+ * the device before returning
+ */
+template <typename ComputeT = float, typename T, typename HandleT>
+std::shared_ptr<DenseMatrix<ComputeT>> to_dense_matrix(
+    const RXMeshStatic&          rx,
+    const Attribute<T, HandleT>& attr)
+{
+    auto mat = std::make_shared<DenseMatrix<ComputeT>>(
+        rx, attr.rows(), attr.cols());
+
+    rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+        const uint32_t i = rx.linear_id(h);
+        for (uint32_t j = 0; j < attr.cols(); ++j) {
+            (*mat)(i, j) = storage_cast<ComputeT>(attr(h, j));
+        }
+    });
+
+    mat->move(HOST, DEVICE);
+    return mat;
+}
+
+/**
+ * @brief copy the host values of a dense matrix into an attribute of any
+ * storage type (on the host) converting every entry to the storage type
+ */
+template <typename ComputeT, typename T, typename HandleT>
+void from_dense_matrix(const RXMeshStatic&    rx,
+                       DenseMatrix<ComputeT>& mat,
+                       Attribute<T, HandleT>& attr)
+{
+    assert(mat.rows() == attr.rows());
+    assert(mat.cols() == attr.cols());
+
+    rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+        const uint32_t i = rx.linear_id(h);
+        for (uint32_t j = 0; j < attr.cols(); ++j) {
+            attr(h, j) = storage_cast<T>(mat(i, j));
+        }
+    });
+}
+
+/**
+ * @brief Vertex coordinates stored as 16-bit fixed point per component
+ * relative to an axis-aligned box (6 bytes per vertex instead of 12 for float
+ * or 24 for double). The maximum quantization error per component is half the
+ * step i.e., 0.5 * extent / 65535 where extent is the box size along this
+ * axis. Coordinates are decoded to float on read. The coordinates are stored
+ * in a VertexAttribute<uint16_t> with AoS layout that is owned (and released)
+ * by the RXMeshStatic that created it. This class can be passed by value to
+ * kernels
+ */
+class QuantizedCoordinates
+{
+   public:
+    QuantizedCoordinates() = default;
+
+    /**
+     * @brief quantize the host values of a coordinates attribute. The
+     * quantized coordinates are allocated on the host and device and moved to
+     * the device before returning
+     * @param rx the mesh
+     * @param coords the vertex coordinates (three attributes) on the host
+     * @param name of the quantized attribute
+     */
+    template <typename T>
+    explicit QuantizedCoordinates(RXMeshStatic&             rx,
+                                  const VertexAttribute<T>& coords,
+                                  const std::string&        name)
+    {
+        vec3<float> upper;
+        for (int i = 0; i < 3; ++i) {
+            m_lower[i] = std::numeric_limits<float>::max();
+            upper[i]   = std::numeric_limits<float>::lowest();
+        }
+
+        rx.for_each_vertex(
+            HOST,
+            [&](const VertexHandle vh) {
+                const vec3<float> v = load_vec3<float>(coords, vh);
+                for (int i = 0; i < 3; ++i) {
+                    m_lower[i] = std::min(m_lower[i], v[i]);
+                    upper[i]   = std::max(upper[i], v[i]);
+                }
+            },
+            NULL,
+            false);
+
+        for (int i = 0; i < 3; ++i) {
+            const float extent = upper[i] - m_lower[i];
+            m_step[i] = (extent > 0) ? extent / float(max_quantized) : 1.f;
+        }
+
+        m_q = *rx.add_vertex_attribute<uint16_t>(name, 3, LOCATION_ALL, AoS);
+
+        rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            set(vh, load_vec3<float>(coords, vh));
+        });
+        m_q.move(HOST, DEVICE);
+    }
+
+    /**
+     * @brief decode the coordinates of a vertex
+     */
+    __host__ __device__ __inline__ vec3<float> operator()(
+        const VertexHandle& vh) const
+    {
+        return vec3<float>(m_lower[0] + m_step[0] * float(m_q(vh, 0)),
+                           m_lower[1] + m_step[1] * float(m_q(vh, 1)),
+                           m_lower[2] + m_step[2] * float(m_q(vh, 2)));
+    }
+
+    /**
+     * @brief encode new coordinates of a vertex. Coordinates outside the box
+     * are clamped to the box
+     */
+    __host__ __device__ __inline__ void set(const VertexHandle& vh,
+                                            const vec3<float>&  v) const
+    {
+        for (int i = 0; i < 3; ++i) {
+            float q    = (v[i] - m_lower[i]) / m_step[i];
+            q          = fminf(fmaxf(q, 0.f), float(max_quantized));
+            m_q(vh, i) = static_cast<uint16_t>(q + 0.5f);
+        }
+    }
+
+    /**
+     * @brief the maximum error of a decoded coordinate along an axis
+     */
+    __host__ __device__ __inline__ float max_error(const int axis) const
+    {
+        return 0.5f * m_step[axis];
+    }
+
+    /**
+     * @brief the underlying quantized attribute e.g., to move it between
+     * host and device
+     */
+    VertexAttribute<uint16_t>& get_attribute()
+    {
+        return m_q;
+    }
+
+   private:
+    static constexpr uint32_t max_quantized = 65535;
+
+    VertexAttribute<uint16_t> m_q;
+    vec3<float>               m_lower;
+    vec3<float>               m_step;
+};
+}  // namespace rxmesh
@@ -0,0 +1,735 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <cub/block/block_reduce.cuh>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/handle.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief axis-aligned bounding box
+ */
+template <typename T>
+struct AABB
+{
+    vec3<T> lo, hi;
+
+    __host__ __device__ AABB()
+        : lo(std::numeric_limits<T>::max()),
+          hi(std::numeric_limits<T>::lowest())
+    {
+    }
+
+    __host__ __device__ AABB(const vec3<T>& l, const vec3<T>& h) : lo(l), hi(h)
+    {
+    }
+
+    /**
+     * @brief true if no point was added to the box
+     */
+    __host__ __device__ __inline__ bool is_empty() const
+    {
+        return lo[0] > hi[0];
+    }
+
+    __host__ __device__ __inline__ void expand(const vec3<T>& p)
+    {
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+
+    __host__ __device__ __inline__ void merge(const AABB& other)
+    {
+        lo = glm::min(lo, other.lo);
+        hi = glm::max(hi, other.hi);
+    }
+
+    __host__ __device__ __inline__ vec3<T> center() const
+    {
+        return T(0.5) * (lo + hi);
+    }
+
+    __host__ __device__ __inline__ bool overlap(const AABB& other) const
+    {
+        return !is_empty() && !other.is_empty() && lo[0] <= other.hi[0] &&
+               other.lo[0] <= hi[0] && lo[1] <= other.hi[1] &&
+               other.lo[1] <= hi[1] && lo[2] <= other.hi[2] &&
+               other.lo[2] <= hi[2];
+    }
+
+    /**
+     * @brief squared distance from p to the box (zero if p is inside) or
+     * max() if the box is empty
+     */
+    __host__ __device__ __inline__ T distance2(const vec3<T>& p) const
+    {
+        if (is_empty()) {
+            return std::numeric_limits<T>::max();
+        }
+        const vec3<T> d =
+            glm::max(glm::max(lo - p, p - hi), vec3<T>(T(0), T(0), T(0)));
+        return glm::dot(d, d);
+    }
+
+    /**
+     * @brief slab test of the ray origin + t * dir (given 1/dir) against the
+     * box for t in [t_min, t_max]. Return the entry parameter in t_enter
+     */
+    __host__ __device__ __inline__ bool ray_overlap(const vec3<T>& origin,
+                                                    const vec3<T>& inv_dir,
+                                                    const T        t_min,
+                                                    const T        t_max,
+                                                    T& t_enter) const
+    {
+        if (is_empty()) {
+            return false;
+        }
+        T t0 = t_min, t1 = t_max;
+        for (int i = 0; i < 3; ++i) {
+            T tn = (lo[i] - origin[i]) * inv_dir[i];
+            T tf = (hi[i] - origin[i]) * inv_dir[i];
+            if (tn > tf) {
+                const T tmp = tn;
+                tn          = tf;
+                tf          = tmp;
+            }
+            t0 = tn > t0 ? tn : t0;
+            t1 = tf < t1 ? tf : t1;
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        t_enter = t0;
+        return true;
+    }
+};
+
+/**
+ * @brief the result of a BVH query. For closest_point(), dist is the distance
+ * to point and for ray_intersect() it is the ray parameter of the hit point
+ */
+template <typename T>
+struct BVHHit
+{
+    FaceHandle face;
+    T          dist;
+    vec3<T>    point;
+
+    __host__ __device__ BVHHit()
+        : face(), dist(std::numeric_limits<T>::max()), point(T(0), T(0), T(0))
+    {
+    }
+
+    __host__ __device__ __inline__ bool is_valid() const
+    {
+        return face.is_valid();
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief compute the triangle and bounding box of every owned face and the
+ * bounding box of every patch. Slots of deleted or not-owned faces get an
+ * empty box such that the queries skip them
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void bvh_refit_faces(const Context            context,
+                                       const VertexAttribute<T> coords,
+                                       const uint32_t           face_capacity,
+                                       vec3<T>*                 d_tri,
+                                       AABB<T>*                 d_face_box,
+                                       uint32_t*                d_num_faces,
+                                       AABB<T>*                 d_patch_box)
+{
+    using BlockReduce = cub::BlockReduce<T, blockThreads>;
+    __shared__ typename BlockReduce::TempStorage s_temp;
+
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.prologue<Op::FV>(block, shrd_alloc, false, false);
+
+    const PatchInfo& pi    = query.get_patch_info();
+    const uint32_t   pid   = pi.patch_id;
+    const uint16_t   num_f = pi.num_faces[0];
+    const uint32_t   base  = pid * face_capacity;
+
+    for (uint16_t f = threadIdx.x; f < num_f; f += blockThreads) {
+        d_face_box[base + f] = AABB<T>();
+    }
+    block.sync();
+
+    AABB<T> box;
+    query.run_compute(
+        block, [&](const FaceHandle& fh, const VertexIterator& iter) {
+            const uint32_t slot = base + fh.local_id();
+            AABB<T>        fb;
+            for (int i = 0; i < 3; ++i) {
+                const VertexHandle vh = iter[i];
+
+                const vec3<T> p(coords(vh, 0), coords(vh, 1), coords(vh, 2));
+                d_tri[3 * slot + i] = p;
+                fb.expand(p);
+            }
+            d_face_box[slot] = fb;
+            box.merge(fb);
+        });
+
+    AABB<T> patch_box;
+    for (int i = 0; i < 3; ++i) {
+        T v = BlockReduce(s_temp).Reduce(box.lo[i], cub::Min());
+        block.sync();
+        if (threadIdx.x == 0) {
+            patch_box.lo[i] = v;
+        }
+        v = BlockReduce(s_temp).Reduce(box.hi[i], cub::Max());
+        block.sync();
+        if (threadIdx.x == 0) {
+            patch_box.hi[i] = v;
+        }
+    }
+
+    if (threadIdx.x == 0) {
+        d_patch_box[pid] = patch_box;
+        d_num_faces[pid] = num_f;
+    }
+
+    query.epilogue(block, shrd_alloc);
+}
+
+/**
+ * @brief bottom-up update of the top level: a complete binary tree whose
+ * leaves are the patches (node i has children 2i + 1 and 2i + 2). Launched
+ * with a single block
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void bvh_refit_tree(const uint32_t  num_leaves,
+                                      const uint32_t* d_leaf_patch,
+                                      const AABB<T>*  d_patch_box,
+                                      AABB<T>*        d_nodes)
+{
+    for (uint32_t k = threadIdx.x; k < num_leaves; k += blockThreads) {
+        const uint32_t p = d_leaf_patch[k];
+        d_nodes[num_leaves - 1 + k] =
+            (p == INVALID32) ? AABB<T>() : d_patch_box[p];
+    }
+    __syncthreads();
+
+    for (uint32_t width = num_leaves / 2; width > 0; width /= 2) {
+        for (uint32_t k = threadIdx.x; k < width; k += blockThreads) {
+            const uint32_t n = width - 1 + k;
+            AABB<T>        b = d_nodes[2 * n + 1];
+            b.merge(d_nodes[2 * n + 2]);
+            d_nodes[n] = b;
+        }
+        __syncthreads();
+    }
+}
+
+/**
+ * @brief spread the lower 10 bits of v such that there are two zero bits
+ * between consecutive bits
+ */
+inline uint32_t bvh_expand_bits(uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+}  // namespace detail
+
+/**
+ * @brief a two-level bounding volume hierarchy over the faces of the mesh.
+ * The top level is a binary tree over the patches bounding boxes (sorted
+ * along a Morton curve) and the leaf level is the list of faces of every
+ * patch, each with its own bounding box. Since the patch size is bounded, the
+ * leaf level is scanned linearly which is what a single block of the query
+ * kernels does anyway.
+ *
+ * Like attributes, BVH is a light handle that is passed by value to kernels
+ * and captured in for_each lambdas to call closest_point(), ray_intersect(),
+ * triangle_intersect(), and for_each_overlap() on the device. The memory is
+ * freed explicitly by calling release() from the host.
+ *
+ * After the vertices move or the faces of the patches changed (e.g., by
+ * RXMeshDynamic), refit() recomputes the faces and patches boxes without
+ * reordering the tree. refit() falls back to build() if the number of patches
+ * grew. build() should be called again after large deformations to restore
+ * the quality of the tree
+ *
+ * Example
+ * \code{.cpp}
+ * BVH<float> bvh(rx, *coords);
+ * rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+ *     BVHHit<float> hit = bvh.closest_point(query_point);
+ *     ...
+ * });
+ * bvh.release();
+ * \endcode
+ */
+template <typename T>
+class BVH
+{
+    static_assert(std::is_floating_point_v<T>,
+                  "BVH only works with float or double");
+
+   public:
+    static constexpr uint32_t blockThreads = 256;
+
+    /**
+     * @brief maximum depth of the top level tree that the traversal stack
+     * can hold (i.e., up to 2^31 patches)
+     */
+    static constexpr uint32_t max_depth = 32;
+
+    __host__ __device__ BVH()
+        : m_num_patches(0),
+          m_num_leaves(0),
+          m_max_patches(0),
+          m_face_capacity(0),
+          m_d_nodes(nullptr),
+          m_d_leaf_patch(nullptr),
+          m_d_patch_box(nullptr),
+          m_d_num_faces(nullptr),
+          m_d_face_box(nullptr),
+          m_d_tri(nullptr)
+    {
+    }
+
+    /**
+     * @brief build the BVH over the faces of rx using the vertex coordinates
+     * coords
+     */
+    BVH(RXMeshStatic&             rx,
+        const VertexAttribute<T>& coords,
+        cudaStream_t              stream = NULL)
+        : BVH()
+    {
+        build(rx, coords, stream);
+    }
+
+    BVH(const BVH&)            = default;
+    BVH& operator=(const BVH&) = default;
+
+    /**
+     * @brief (re)build the BVH from scratch. This allocates the memory (if
+     * needed) and sorts the patches along a Morton curve
+     */
+    void build(RXMeshStatic&             rx,
+               const VertexAttribute<T>& coords,
+               cudaStream_t              stream = NULL)
+    {
+        const uint32_t num_patches = rx.get_num_patches();
+        if (num_patches > m_max_patches ||
+            rx.get_per_patch_max_face_capacity() > m_face_capacity) {
+            release();
+            allocate(rx);
+        }
+
+        m_num_patches = num_patches;
+        m_num_leaves  = 1;
+        while (m_num_leaves < m_num_patches) {
+            m_num_leaves *= 2;
+        }
+        if (m_num_leaves > (1u << (max_depth - 1))) {
+            RXMESH_ERROR("BVH::build() too many patches {}", m_num_patches);
+        }
+
+        refit_faces(rx, coords, stream);
+
+        // sort the patches by the Morton code of their box center
+        std::vector<AABB<T>> h_box(m_num_patches);
+        CUDA_ERROR(cudaMemcpyAsync(h_box.data(),
+                                   m_d_patch_box,
+                                   m_num_patches * sizeof(AABB<T>),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        AABB<T> mesh_box;
+        for (const auto& b : h_box) {
+            mesh_box.merge(b);
+        }
+        const vec3<T> extent =
+            glm::max(mesh_box.hi - mesh_box.lo,
+                     vec3<T>(std::numeric_limits<T>::min()));
+
+        std::vector<uint32_t> code(m_num_patches, 0);
+        for (uint32_t p = 0; p < m_num_patches; ++p) {
+            if (h_box[p].is_empty()) {
+                continue;
+            }
+            const vec3<T> c = (h_box[p].center() - mesh_box.lo) / extent;
+            uint32_t      m = 0;
+            for (int i = 0; i < 3; ++i) {
+                const uint32_t q = static_cast<uint32_t>(
+                    std::min(std::max(c[i] * T(1024), T(0)), T(1023)));
+                m |= detail::bvh_expand_bits(q) << (2 - i);
+            }
+            code[p] = m;
+        }
+
+        std::vector<uint32_t> h_leaf_patch(m_num_leaves, INVALID32);
+        auto leaf_end = h_leaf_patch.begin() + m_num_patches;
+        std::iota(h_leaf_patch.begin(), leaf_end, 0);
+        std::stable_sort(h_leaf_patch.begin(),
+                         leaf_end,
+                         [&](uint32_t a, uint32_t b) {
+                             return code[a] < code[b];
+                         });
+
+        CUDA_ERROR(cudaMemcpyAsync(m_d_leaf_patch,
+                                   h_leaf_patch.data(),
+                                   m_num_leaves * sizeof(uint32_t),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        refit_tree(stream);
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    /**
+     * @brief update the boxes after the vertices moved or the topology
+     * inside the patches changed. The order of the patches in the tree is
+     * kept. If the mesh has more patches than when the BVH was built, the BVH
+     * is rebuilt
+     */
+    void refit(RXMeshStatic&             rx,
+               const VertexAttribute<T>& coords,
+               cudaStream_t              stream = NULL)
+    {
+        if (m_d_nodes == nullptr || rx.get_num_patches() > m_num_leaves ||
+            rx.get_num_patches() > m_max_patches ||
+            rx.get_per_patch_max_face_capacity() > m_face_capacity) {
+            build(rx, coords, stream);
+            return;
+        }
+
+        if (rx.get_num_patches() != m_num_patches) {
+            // new patches fill the padding leaves (in order)
+            std::vector<uint32_t> h_leaf_patch(m_num_leaves);
+            CUDA_ERROR(cudaMemcpyAsync(h_leaf_patch.data(),
+                                       m_d_leaf_patch,
+                                       m_num_leaves * sizeof(uint32_t),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+            uint32_t p = m_num_patches;
+            for (auto& l : h_leaf_patch) {
+                if (l == INVALID32 && p < rx.get_num_patches()) {
+                    l = p++;
+                }
+            }
+            m_num_patches = rx.get_num_patches();
+            CUDA_ERROR(cudaMemcpyAsync(m_d_leaf_patch,
+                                       h_leaf_patch.data(),
+                                       m_num_leaves * sizeof(uint32_t),
+                                       cudaMemcpyHostToDevice,
+                                       stream));
+        }
+
+        refit_faces(rx, coords, stream);
+        refit_tree(stream);
+    }
+
+    /**
+     * @brief the bounding box of the whole mesh (i.e., the root of the tree)
+     */
+    AABB<T> get_bounding_box(cudaStream_t stream = NULL) const
+    {
+        AABB<T> root;
+        if (m_d_nodes != nullptr) {
+            CUDA_ERROR(cudaMemcpyAsync(&root,
+                                       m_d_nodes,
+                                       sizeof(AABB<T>),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+        }
+        return root;
+    }
+
+    /**
+     * @brief the number of patches in the top level
+     */
+    __host__ __device__ uint32_t get_num_patches() const
+    {
+        return m_num_patches;
+    }
+
+    /**
+     * @brief the closest point on the mesh to p within max_dist. The returned
+     * hit is invalid if no face is closer than max_dist
+     */
+    __device__ __inline__ BVHHit<T> closest_point(
+        const vec3<T>& p,
+        const T        max_dist = std::numeric_limits<T>::max()) const
+    {
+        BVHHit<T> hit;
+        T         best = (max_dist < std::numeric_limits<T>::max()) ?
+                             max_dist * max_dist :
+                             std::numeric_limits<T>::max();
+
+        traverse(
+            [&](const AABB<T>& b) { return b.distance2(p) < best; },
+            [&](const FaceHandle& fh, const vec3<T>* tri) {
+                const vec3<T> q =
+                    closest_point_on_triangle(p, tri[0], tri[1], tri[2]);
+                const T d2 = glm::dot(q - p, q - p);
+                if (d2 < best) {
+                    best      = d2;
+                    hit.face  = fh;
+                    hit.point = q;
+                }
+                return true;
+            });
+        if (hit.is_valid()) {
+            hit.dist = sqrt(best);
+        }
+        return hit;
+    }
+
+    /**
+     * @brief the first face hit by the ray origin + t * dir with
+     * t_min <= t <= t_max. The returned hit is invalid if the ray misses
+     */
+    __device__ __inline__ BVHHit<T> ray_intersect(
+        const vec3<T>& origin,
+        const vec3<T>& dir,
+        const T        t_min = T(0),
+        const T        t_max = std::numeric_limits<T>::max()) const
+    {
+        const vec3<T> inv_dir(T(1) / dir[0], T(1) / dir[1], T(1) / dir[2]);
+
+        BVHHit<T> hit;
+        T         t_best = t_max;
+
+        traverse(
+            [&](const AABB<T>& b) {
+                T t_enter;
+                return b.ray_overlap(origin, inv_dir, t_min, t_best, t_enter);
+            },
+            [&](const FaceHandle& fh, const vec3<T>* tri) {
+                T t;
+                if (ray_triangle_intersect(origin,
+                                           dir,
+                                           tri[0],
+                                           tri[1],
+                                           tri[2],
+                                           t_min,
+                                           t_best,
+                                           t)) {
+                    t_best   = t;
+                    hit.face = fh;
+                }
+                return true;
+            });
+        if (hit.is_valid()) {
+            hit.dist  = t_best;
+            hit.point = origin + t_best * dir;
+        }
+        return hit;
+    }
+
+    /**
+     * @brief find a face that intersects the triangle a, b, c for which
+     * filter(FaceHandle) returns true (e.g., to skip the faces adjacent to
+     * the query triangle in self-collision tests). Return an invalid handle
+     * if there is no such face
+     */
+    template <typename FilterT>
+    __device__ __inline__ FaceHandle triangle_intersect(const vec3<T>& a,
+                                                        const vec3<T>& b,
+                                                        const vec3<T>& c,
+                                                        FilterT filter) const
+    {
+        AABB<T> box;
+        box.expand(a);
+        box.expand(b);
+        box.expand(c);
+
+        FaceHandle found;
+        traverse([&](const AABB<T>& n) { return n.overlap(box); },
+                 [&](const FaceHandle& fh, const vec3<T>* tri) {
+                     if (filter(fh) &&
+                         triangle_triangle_intersect(
+                             a, b, c, tri[0], tri[1], tri[2])) {
+                         found = fh;
+                         return false;
+                     }
+                     return true;
+                 });
+        return found;
+    }
+
+    /**
+     * @brief find any face that intersects the triangle a, b, c
+     */
+    __device__ __inline__ FaceHandle triangle_intersect(const vec3<T>& a,
+                                                        const vec3<T>& b,
+                                                        const vec3<T>& c) const
+    {
+        return triangle_intersect(a, b, c, [](const FaceHandle&) {
+            return true;
+        });
+    }
+
+    /**
+     * @brief call func(FaceHandle, const vec3<T>* triangle) for every face
+     * whose bounding box overlaps box. The traversal stops if func returns
+     * false
+     */
+    template <typename FuncT>
+    __device__ __inline__ void for_each_overlap(const AABB<T>& box,
+                                                FuncT          func) const
+    {
+        traverse([&](const AABB<T>& n) { return n.overlap(box); },
+                 [&](const FaceHandle& fh, const vec3<T>* tri) {
+                     return func(fh, tri);
+                 });
+    }
+
+    /**
+     * @brief free the device memory
+     */
+    void release()
+    {
+        GPU_FREE(m_d_nodes);
+        GPU_FREE(m_d_leaf_patch);
+        GPU_FREE(m_d_patch_box);
+        GPU_FREE(m_d_num_faces);
+        GPU_FREE(m_d_face_box);
+        GPU_FREE(m_d_tri);
+        m_num_patches   = 0;
+        m_num_leaves    = 0;
+        m_max_patches   = 0;
+        m_face_capacity = 0;
+    }
+
+   private:
+    /**
+     * @brief depth-first traversal. node_test(AABB) decides if a node
+     * should be visited and face_func(FaceHandle, triangle) is called for
+     * every face in the visited patches whose box passes node_test. The
+     * traversal stops if face_func returns false
+     */
+    template <typename NodeTestT, typename FaceFuncT>
+    __device__ __inline__ void traverse(NodeTestT node_test,
+                                        FaceFuncT face_func) const
+    {
+        if (m_num_patches == 0) {
+            return;
+        }
+
+        uint32_t stack[max_depth];
+        int      top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const uint32_t n = stack[--top];
+            if (!node_test(m_d_nodes[n])) {
+                continue;
+            }
+
+            if (n < m_num_leaves - 1) {
+                stack[top++] = 2 * n + 2;
+                stack[top++] = 2 * n + 1;
+                continue;
+            }
+
+            const uint32_t p = m_d_leaf_patch[n - (m_num_leaves - 1)];
+            if (p == INVALID32) {
+                continue;
+            }
+            const uint32_t base  = p * m_face_capacity;
+            const uint32_t num_f = m_d_num_faces[p];
+            for (uint32_t f = 0; f < num_f; ++f) {
+                const uint32_t slot = base + f;
+                if (!node_test(m_d_face_box[slot])) {
+                    continue;
+                }
+                if (!face_func(FaceHandle(p, LocalFaceT(uint16_t(f))),
+                               m_d_tri + 3 * slot)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    void allocate(RXMeshStatic& rx)
+    {
+        m_max_patches   = rx.get_max_num_patches();
+        m_face_capacity = rx.get_per_patch_max_face_capacity();
+
+        uint32_t max_leaves = 1;
+        while (max_leaves < m_max_patches) {
+            max_leaves *= 2;
+        }
+        const size_t num_slots = size_t(m_max_patches) * m_face_capacity;
+
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_nodes, 2 * max_leaves * sizeof(AABB<T>)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_leaf_patch, max_leaves * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_patch_box,
+                              m_max_patches * sizeof(AABB<T>)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_num_faces,
+                              m_max_patches * sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_face_box, num_slots * sizeof(AABB<T>)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_tri, 3 * num_slots * sizeof(vec3<T>)));
+        CUDA_ERROR(
+            cudaMemset(m_d_num_faces, 0, m_max_patches * sizeof(uint32_t)));
+    }
+
+    void refit_faces(RXMeshStatic&             rx,
+                     const VertexAttribute<T>& coords,
+                     cudaStream_t              stream)
+    {
+        LaunchBox<blockThreads> lb;
+        rx.prepare_launch_box(
+            {Op::FV}, lb, (void*)detail::bvh_refit_faces<T, blockThreads>);
+
+        rx.run_query_kernel(lb,
+                            detail::bvh_refit_faces<T, blockThreads>,
+                            stream,
+                            coords,
+                            m_face_capacity,
+                            m_d_tri,
+                            m_d_face_box,
+                            m_d_num_faces,
+                            m_d_patch_box);
+    }
+
+    void refit_tree(cudaStream_t stream)
+    {
+        detail::bvh_refit_tree<T, blockThreads>
+            <<<1, blockThreads, 0, stream>>>(
+                m_num_leaves, m_d_leaf_patch, m_d_patch_box, m_d_nodes);
+    }
+
+    uint32_t  m_num_patches;
+    uint32_t  m_num_leaves;
+    uint32_t  m_max_patches;
+    uint32_t  m_face_capacity;
+    AABB<T>*  m_d_nodes;
+    uint32_t* m_d_leaf_patch;
+    AABB<T>*  m_d_patch_box;
+    uint32_t* m_d_num_faces;
+    AABB<T>*  m_d_face_box;
+    vec3<T>*  m_d_tri;
+};
+}  // namespace rxmesh
@@ -4,6 +4,7 @@
 
 #include "rxmesh/bitmask.cuh"
 #include "rxmesh/context.h"
+#include "rxmesh/geometry_util.cuh"
 #include "rxmesh/handle.h"
 #include "rxmesh/kernels/loader.cuh"
 #include "rxmesh/patch_info.h"
@@ -15,6 +16,9 @@
 
 namespace rxmesh {
 
+template <typename T>
+struct DerivedAttributes;
+
 template <uint32_t blockThreads, CavityOp cop>
 struct CavityManager
 {
@@ -23,6 +27,7 @@ struct CavityManager
      */
     __device__ __inline__ CavityManager()
         : m_write_to_gmem(true),
+          m_stage_clock(0),
           m_s_num_cavities(nullptr),
           m_s_cavity_size_prefix(nullptr),
           m_s_q_correspondence_e(nullptr),
@@ -41,7 +46,8 @@ struct CavityManager
           m_s_num_vertices(nullptr),
           m_s_num_edges(nullptr),
           m_s_num_faces(nullptr),
-          m_s_cavity_boundary_edges(nullptr)
+          m_s_cavity_boundary_edges(nullptr),
+          m_s_cavity_priority(nullptr)
     {
     }
 
@@ -75,6 +81,17 @@ struct CavityManager
     template <typename HandleT>
     __device__ __inline__ uint32_t create(HandleT seed);
 
+    /**
+     * @brief create new cavity from a seed element with a priority key. When
+     * two cavities overlap, the one with the smaller key is kept (e.g., the
+     * key could be the cost of collapsing the seed edge) and ties are broken
+     * by the cavity id. Cavities created without a key have the key zero
+     * @param seed
+     * @param key the cavity priority key
+     */
+    template <typename HandleT>
+    __device__ __inline__ uint32_t create(HandleT seed, float key);
+
 
     /**
      * @brief recover a cavity i.e., roll back. This can be used during fill-in
@@ -159,7 +176,9 @@ struct CavityManager
 
     /**
      * @brief apply a lambda function on each cavity to fill it in with edges
-     * and then faces
+     * and then faces. In the deterministic mode (see
+     * RXMeshDynamic::set_deterministic), the cavities are filled one at a time
+     * in ascending order of their creator
      */
     template <typename FillInT>
     __device__ __inline__ void for_each_cavity(
@@ -227,10 +246,16 @@ struct CavityManager
     /**
      * @brief cleanup and store updated patch to global memory
      * @param block
+     * @param attributes optionally, the attributes passed to prologue(). Those
+     * that are DerivedAttributes (see derived_attributes.cuh) get their
+     * quantities recomputed for the elements created or touched by the
+     * cavities of this patch if the cavities were written to global memory.
+     * Other attributes are ignored
      * @return
      */
-    __device__ __inline__ void epilogue(
-        cooperative_groups::thread_block& block);
+    template <typename... AttributesT>
+    __device__ __inline__ void epilogue(cooperative_groups::thread_block& block,
+                                        AttributesT&... attributes);
 
     /**
      * @brief should this patch be sliced. Populated after calling prologue()
@@ -277,6 +302,94 @@ struct CavityManager
         block.sync();
     }
 
+    /**
+     * @brief update the attributes of a DerivedAttributes registry after
+     * ownership change, same as any other attribute
+     */
+    template <typename T>
+    __device__ __inline__ void update_attribute(DerivedAttributes<T>& derived);
+
+    /**
+     * @brief take the edges and faces removed by the cavities out of the
+     * vertex valence and boundary flag of their vertices. Called by the
+     * prologue before the fill-in since the fill-in may reuse the removed
+     * elements' slots. The values of the not-owned vertices are reset and
+     * used to accumulate their change which update_derived() adds to the
+     * owner patch
+     */
+    template <typename T>
+    __device__ __inline__ void remove_derived(
+        cooperative_groups::thread_block& block,
+        DerivedAttributes<T>&             derived);
+
+    /**
+     * @brief attributes other than DerivedAttributes are not updated by the
+     * prologue
+     */
+    template <typename AttributeT>
+    __device__ __inline__ void remove_derived(
+        cooperative_groups::thread_block& block,
+        AttributeT&                       attribute)
+    {
+    }
+
+    /**
+     * @brief recompute the derived quantities of the fill-in edges and faces
+     * and add the edges and faces of the updated mesh (i.e., the fill-in and
+     * the restored ones) back to the vertex valence and boundary flag (see
+     * remove_derived()). The change of not-owned vertices is added to their
+     * owner patch
+     */
+    template <typename T>
+    __device__ __inline__ void update_derived(
+        cooperative_groups::thread_block& block,
+        DerivedAttributes<T>&             derived);
+
+    /**
+     * @brief add (or remove) the edges and faces to (or from) the vertex
+     * valence and boundary flag of their vertices. When adding, these are
+     * the active fill-in or in-cavity (i.e., restored) edges and faces.
+     * Otherwise, these are the in-cavity ones
+     */
+    template <typename T>
+    __device__ __inline__ void update_derived_degree(
+        DerivedAttributes<T>& derived,
+        const bool            add);
+
+    /**
+     * @brief attributes other than DerivedAttributes are not updated by the
+     * epilogue
+     */
+    template <typename AttributeT>
+    __device__ __inline__ void update_derived(
+        cooperative_groups::thread_block& block,
+        AttributeT&                       attribute)
+    {
+    }
+
+    /**
+     * @brief add the clock cycles since the end of the previous stage to the
+     * stage s if the instrumentation is enabled (see Stage). The block is
+     * synced first (only when the instrumentation is enabled) so the stage
+     * accounts for the slowest thread
+     */
+    __device__ __inline__ void end_stage(
+        cooperative_groups::thread_block& block,
+        const Stage                       s)
+    {
+#ifdef __CUDA_ARCH__
+        if (m_context.m_stage_cycles != nullptr) {
+            block.sync();
+            if (threadIdx.x == 0) {
+                const long long now = clock64();
+                detail::add_cycles(
+                    m_context.m_stage_cycles, s, now - m_stage_clock);
+                m_stage_clock = now;
+            }
+        }
+#endif
+    }
+
     /**
      * @brief allocate shared memory
      */
@@ -472,6 +585,35 @@ struct CavityManager
                                                bool           avoid_in_cavity,
                                                bool avoid_not_owned_in_cavity);
 
+    /**
+     * @brief run func on every thread. In the deterministic mode, the threads
+     * run it one at a time in ascending order of threadIdx.x so that adding
+     * elements (in add_element) and inserting in the patch stash give the
+     * same ids on every run. Should be called by all threads in the block
+     */
+    template <typename FuncT>
+    __device__ __inline__ void ordered(cooperative_groups::thread_block& block,
+                                       FuncT                             func);
+
+    /**
+     * @brief a key that orders the cavities by their creator and, for
+     * cavities with the same creator, by their id
+     */
+    __device__ __forceinline__ uint32_t creator_key(const uint16_t c) const
+    {
+        return (uint32_t(m_s_cavity_creator[c]) << 16) | c;
+    }
+
+    /**
+     * @brief the id used to acquire patch locks. In case of a conflict, the
+     * smaller id wins. The patch id is used in the deterministic mode so the
+     * winner does not depend on which block got the patch
+     */
+    __device__ __forceinline__ uint32_t lock_id(const uint32_t pid) const
+    {
+        return m_context.m_deterministic ? pid : blockIdx.x;
+    }
+
     /**
      * @brief enqueue patch in the patch scheduler so that it can be scheduled
      * latter
@@ -508,6 +650,59 @@ struct CavityManager
      */
     __device__ __inline__ void unlock_locked_patches();
 
+    /**
+     * @brief in the optimistic mode, start committing the changes to this
+     * patch and to the locked (read) patches by checking that none of them has
+     * changed since its version was read. The patches are not waited on i.e.,
+     * if one of them has changed, the commit is undone and false is returned.
+     * Always true if the optimistic mode is off
+     */
+    __device__ __inline__ bool commit(cooperative_groups::thread_block& block);
+
+    /**
+     * @brief in the optimistic mode, check that this patch has not changed
+     * since its version was read i.e., what has been loaded from it so far
+     * (including its hashtables) is not torn by a concurrent commit. Always
+     * true if the optimistic mode is off
+     */
+    __device__ __inline__ bool is_snapshot_valid(
+        cooperative_groups::thread_block& block);
+
+    /**
+     * @brief in the optimistic mode, the neighbor patches are read without a
+     * lock and so a concurrent commit can hand us a torn local index. Check
+     * that id (read from a neighbor patch) is less than bound. If not, the
+     * migration is flagged to fail (m_s_torn) before the index is used. Always
+     * true if the optimistic mode is off
+     */
+    __device__ __inline__ bool check_read(const uint16_t id,
+                                          const uint16_t bound);
+
+    /**
+     * @brief same as check_read() above but for a handle found in the
+     * hashtable of a patch read without a lock i.e., the handle should refer
+     * to an existing patch and to an element within its capacity
+     */
+    template <typename HandleT>
+    __device__ __inline__ bool check_read(const HandleT h);
+
+    /**
+     * @brief the bound on the local index of a HandleT element read from the
+     * neighbor patch q i.e., the capacity of q clamped to the shared memory
+     * buffers that are indexed by the local indices of q (e.g., the
+     * correspondence arrays)
+     */
+    template <typename HandleT>
+    __device__ __inline__ uint16_t read_bound(const PatchInfo& q) const;
+
+    /**
+     * @brief the number of HandleT elements of the neighbor patch q. In the
+     * optimistic mode, this is clamped to read_bound() (and flagged if it
+     * exceeds it) so the loops over the elements of q stay in bounds
+     */
+    template <typename HandleT>
+    __device__ __inline__ uint16_t num_read(const PatchInfo& q);
+
     /**
      * @brief set the dirty bit for locked patches
      */
@@ -762,6 +957,10 @@ struct CavityManager
     // epilogue
     bool m_write_to_gmem;
 
+    // the clock at the end of the previous stage (only used by thread 0 when
+    // the instrumentation is enabled)
+    long long m_stage_clock;
+
     // num_cavities could be uint16_t but we use int since we need atomicAdd
     int* m_s_num_cavities;
 
@@ -884,9 +1083,22 @@ struct CavityManager
     // indicate if we need to recover one of the created cavities
     bool* m_s_recover;
 
+    // in the optimistic mode, the version of the patches in the patch stash
+    // when they were locked (i.e., read) and the version of this patch in the
+    // last entry
+    uint32_t* m_s_versions;
+
+    // in the optimistic mode, indicate that a torn value has been read from a
+    // patch that is not locked and so the migration should fail
+    bool* m_s_torn;
+
     // what mesh element (depending on CavityOp) generated this cavity
     uint16_t* m_s_cavity_creator;
 
+    // the priority key of every cavity used to resolve conflicts between
+    // overlapping cavities (smaller key wins)
+    float* m_s_cavity_priority;
+
     // indicate that the cavity (deleted elements) should be preserved during
     // the cavity fill-in; mostly because the user needs to access the deleted
     // elements information (either topology or geometry) while filling-in the
@@ -922,6 +1134,61 @@ struct CavityManager
     Bitmask m_s_cavity_mis;
 };
 
+/**
+ * @brief persistent-threads loop over the patch scheduler. Instead of
+ * processing a single patch per block and relaunching the kernel until the
+ * queue is empty, the block keeps calling process() until there are no more
+ * patches in the queue (including the ones pushed back due to conflicts).
+ * The kernel should be launched with a launch box that went through
+ * RXMeshDynamic::make_persistent(). process() should construct the
+ * CavityManager (which pops the patch) using the input shared memory
+ * allocator and should return true if it got a patch and false otherwise
+ * (e.g., the patch could not be locked) in which case the block backs off
+ * for a short (exponentially increasing) time before trying again
+ * @param block cooperative group block
+ * @param context the context
+ * @param process process(shrd_alloc) processes one patch
+ */
+template <typename ProcessT>
+__device__ __inline__ void persistent_patch_loop(
+    cooperative_groups::thread_block& block,
+    Context&                          context,
+    ProcessT                          process)
+{
+    __shared__ bool s_done;
+    uint32_t        ns = 32;
+
+    while (true) {
+        // every iteration starts from an empty dynamic shared memory
+        ShmemAllocator shrd_alloc;
+
+        const bool got_patch = process(shrd_alloc);
+        block.sync();
+
+        // a patch is either in the queue or held by a block which will push
+        // it back (if needed) before checking here. So, an empty queue means
+        // that there is no more work
+        if (threadIdx.x == 0) {
+            s_done = context.m_patch_scheduler.is_empty();
+        }
+        block.sync();
+        if (s_done) {
+            break;
+        }
+
+        if (got_patch) {
+            ns = 32;
+        } else {
+#if __CUDA_ARCH__ >= 700
+            __nanosleep(ns);
+#endif
+            if (ns < 4096) {
+                ns *= 2;
+            }
+        }
+    }
+}
+
 }  // namespace rxmesh
 
 #include "rxmesh/cavity_manager_impl.cuh"
\ No newline at end of file
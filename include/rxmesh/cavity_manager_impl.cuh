@@ -9,12 +9,19 @@ __device__ __inline__ CavityManager<blockThreads, cop>::CavityManager(
     bool                              allow_touching_cavities,
     uint32_t                          current_p)
     : m_write_to_gmem(false),
+      m_stage_clock(0),
       m_context(context),
       m_preserve_cavity(preserve_cavity),
       m_allow_touching_cavities(allow_touching_cavities)
 {
     static_assert(cop == CavityOp::EV || cop == CavityOp::E);
 
+#ifdef __CUDA_ARCH__
+    if (m_context.m_stage_cycles != nullptr && threadIdx.x == 0) {
+        m_stage_clock = clock64();
+    }
+#endif
+
     __shared__ uint32_t s_patch_id;
 
 
@@ -38,9 +45,16 @@ __device__ __inline__ CavityManager<blockThreads, cop>::CavityManager(
     __shared__ bool recover[1];
     m_s_recover = recover;
 
+    __shared__ uint32_t versions[PatchStash::stash_size + 1];
+    m_s_versions = versions;
+
+    __shared__ bool torn[1];
+    m_s_torn = torn;
+
     if (threadIdx.x == 0) {
         m_s_readd_to_queue[0] = false;
         m_s_should_slice[0]   = false;
+        m_s_torn[0]           = false;
         m_s_remove_fill_in[0] = false;
         m_s_recover[0]        = false;
         m_s_num_cavities[0]   = 0;
@@ -60,13 +74,23 @@ __device__ __inline__ CavityManager<blockThreads, cop>::CavityManager(
             }
         }
 
-        // try to lock the patch
         if (s_patch_id != INVALID32) {
-            bool locked =
-                m_context.m_patches_info[s_patch_id].lock.acquire_lock(
-                    blockIdx.x);
+            detail::count(m_context.m_counters, Counter::SchedulerPop);
+        }
+
+        // try to lock the patch. In the optimistic mode, the patch is not
+        // locked but its version is checked when the changes are committed
+        if (s_patch_id != INVALID32) {
+            PatchLock& p_lock = m_context.m_patches_info[s_patch_id].lock;
+
+            const bool locked =
+                m_context.m_optimistic ?
+                    p_lock.read_version(m_s_versions[PatchStash::stash_size]) :
+                    p_lock.acquire_lock(lock_id(s_patch_id));
 
             if (!locked) {
+                detail::count(m_context.m_counters, Counter::PatchLockFail);
+
                 // if we can not, we add it again to the queue
                 push(s_patch_id);
 
@@ -87,6 +111,7 @@ __device__ __inline__ CavityManager<blockThreads, cop>::CavityManager(
     block.sync();
 
     if (s_patch_id == INVALID32) {
+        end_stage(block, Stage::Construct);
         return;
     }
 
@@ -118,11 +143,16 @@ __device__ __inline__ CavityManager<blockThreads, cop>::CavityManager(
     fill_n<blockThreads>(
         m_s_cavity_creator, assumed_num_cavities, uint16_t(INVALID16));
 
+    m_s_cavity_priority = shrd_alloc.alloc<float>(assumed_num_cavities);
+    assert(m_s_cavity_priority);
+    fill_n<blockThreads>(m_s_cavity_priority, assumed_num_cavities, 0.f);
+
     fill_n<blockThreads>(m_s_cavity_id_v, vert_cap, uint16_t(INVALID16));
     fill_n<blockThreads>(m_s_cavity_id_e, edge_cap, uint16_t(INVALID16));
     fill_n<blockThreads>(m_s_cavity_id_f, face_cap, uint16_t(INVALID16));
 
     block.sync();
+    end_stage(block, Stage::Construct);
 }
 
 
@@ -447,6 +477,20 @@ __device__ __inline__ uint32_t CavityManager<blockThreads, cop>::create(
 }
 
 
+template <uint32_t blockThreads, CavityOp cop>
+template <typename HandleT>
+__device__ __inline__ uint32_t CavityManager<blockThreads, cop>::create(
+    HandleT     seed,
+    const float key)
+{
+    const uint32_t id = create(seed);
+    if (id != INVALID32) {
+        m_s_cavity_priority[id] = key;
+    }
+    return id;
+}
+
+
 template <uint32_t blockThreads, CavityOp cop>
 template <typename HandleT>
 __device__ __inline__ void CavityManager<blockThreads, cop>::recover(
@@ -616,6 +660,8 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     ShmemAllocator&                   shrd_alloc,
     AttributesT&&... attributes)
 {
+    end_stage(block, Stage::Create);
+
     // allocate shared memory
     alloc_shared_memory(block, shrd_alloc);
 
@@ -626,6 +672,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     // construct cavity graph
     construct_cavity_graph(block);
     block.sync();
+    end_stage(block, Stage::CavityGraph);
 
     // calculate a maximal independent set of non-overlapping cavities
     calc_cavity_maximal_independent_set(block);
@@ -638,6 +685,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     // Repair for conflicting cavities
     deactivate_conflicting_cavities();
     block.sync();
+    end_stage(block, Stage::MIS);
 
     // Clear bitmask for elements in the (active) cavity to indicate that
     // they are deleted (but only in shared memory)
@@ -651,6 +699,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     // sort each cavity edge loop
     sort_cavities_edge_loop();
     block.sync();
+    end_stage(block, Stage::EdgeLoop);
 
     // deactivate a cavity it may leave an imprint on a neighbor patch
     // deactivate_boundary_cavities(block);
@@ -659,10 +708,39 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     // load hashtables
     load_hashtable(block);
     block.sync();
+    end_stage(block, Stage::Hashtable);
+
+    // in the optimistic mode, the migration indexes the shared memory with
+    // what has been loaded from this patch and so it should not be torn
+    if (!is_snapshot_valid(block)) {
+        if (threadIdx.x == 0) {
+            detail::count(m_context.m_counters, Counter::CommitFail);
+        }
+        m_write_to_gmem = false;
+        return false;
+    }
 
     // change patch layout to accommodate all cavities created in the patch
     if (!migrate(block)) {
+        if (threadIdx.x == 0) {
+            detail::count(m_context.m_counters,
+                          m_s_torn[0] ? Counter::CommitFail :
+                                        Counter::MigrateFail);
+        }
+        block.sync();
+        end_stage(block, Stage::Migrate);
+        m_write_to_gmem = false;
+        return false;
+    }
+
+    // in the optimistic mode, make sure that none of the patches we read from
+    // has changed since then
+    if (!commit(block)) {
+        if (threadIdx.x == 0) {
+            detail::count(m_context.m_counters, Counter::CommitFail);
+        }
         block.sync();
+        end_stage(block, Stage::Migrate);
         m_write_to_gmem = false;
         return false;
     }
@@ -672,15 +750,22 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     set_dirty_for_locked_patches();
 
     m_write_to_gmem = true;
+    end_stage(block, Stage::Migrate);
 
     // do ownership change
     change_ownership(block);
     block.sync();
+    end_stage(block, Stage::Ownership);
 
     // update attributes
     update_attributes(block, attributes...);
     block.sync();
 
+    // take the removed elements out of the derived vertex quantities before
+    // the fill-in reuses their slots
+    ([&] { remove_derived(block, attributes); }(), ...);
+    end_stage(block, Stage::UpdateAttributes);
+
 
     // reset the fill-in bitmask so we can use it during the cavity fill-in
     m_s_fill_in_v.reset(block);
@@ -698,6 +783,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::prologue(
     // overlap this memcpy with the user operations that mostly happens in
     // shared memory
     store_hashtable(block);
+    end_stage(block, Stage::Hashtable);
 
     return true;
 }
@@ -921,8 +1007,20 @@ CavityManager<blockThreads, cop>::calc_cavity_maximal_independent_set(
                         m_s_cavity_graph[MAX_OVERLAP_CAVITIES * c + i];
                     if (neighbour_c != INVALID16) {
 
+                        // the neighbour wins if it has a smaller key or,
+                        // for the same key, a larger id. The cavity id
+                        // depends on the order in which threads created the
+                        // cavities and so the deterministic mode compares the
+                        // creators instead
+                        const float c_key = m_s_cavity_priority[c];
+                        const float n_key = m_s_cavity_priority[neighbour_c];
+                        const bool     det   = m_context.m_deterministic;
+                        const uint32_t c_id  = det ? creator_key(c) : c;
+                        const uint32_t n_id =
+                            det ? creator_key(neighbour_c) : neighbour_c;
                         if (m_s_active_cavity_mis(neighbour_c) &&
-                            neighbour_c > c) {
+                            (n_key < c_key ||
+                             (n_key == c_key && n_id > c_id))) {
                             add_c = false;
                             break;
                         }
@@ -1739,6 +1837,35 @@ __device__ __inline__ void CavityManager<blockThreads, cop>::for_each_cavity(
     cooperative_groups::thread_block& block,
     FillInT                           FillInFunc)
 {
+    if (m_context.m_deterministic) {
+        // the cavity ids depend on the order in which the threads created
+        // them, so the cavities are filled one at a time in the order of
+        // their creator (see creator_key) by the thread that would fill them
+        // otherwise. Every thread finds the same next cavity
+        int64_t last = -1;
+        while (true) {
+            uint16_t next     = INVALID16;
+            uint32_t next_key = INVALID32;
+            for (uint16_t c = 0; c < m_s_num_cavities[0]; ++c) {
+                const uint32_t key = creator_key(c);
+                if (m_s_active_cavity_bitmask(c) && key > last &&
+                    key < next_key && get_cavity_size(c) > 0) {
+                    next     = c;
+                    next_key = key;
+                }
+            }
+            if (next == INVALID16) {
+                break;
+            }
+            if (next % blockThreads == threadIdx.x) {
+                FillInFunc(next, get_cavity_size(next));
+            }
+            block.sync();
+            last = next_key;
+        }
+        return;
+    }
+
     // TODO need to increase the parallelism in this part. It should be at
     // least one warp processing one cavity
     for (uint16_t c = threadIdx.x; c < m_s_num_cavities[0]; c += blockThreads) {
@@ -2064,6 +2191,26 @@ __device__ __inline__ void CavityManager<blockThreads, cop>::store_hashtable(
 }
 
 
+template <uint32_t blockThreads, CavityOp cop>
+template <typename FuncT>
+__device__ __inline__ void CavityManager<blockThreads, cop>::ordered(
+    cooperative_groups::thread_block& block,
+    FuncT                             func)
+{
+    if (!m_context.m_deterministic) {
+        func();
+        return;
+    }
+    // block-wide sync between turns rather than spinning on a shared turn
+    // counter since the latter needs independent thread scheduling
+    for (uint32_t t = 0; t < blockThreads; ++t) {
+        if (threadIdx.x == t) {
+            func();
+        }
+        block.sync();
+    }
+}
+
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __inline__ void CavityManager<blockThreads, cop>::push()
 {
@@ -2095,10 +2242,16 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::lock(
         assert(stash_id < m_s_locked_patches_mask.size());
         bool okay = m_s_locked_patches_mask(stash_id);
         if (!okay) {
-            okay = m_context.m_patches_info[q].lock.acquire_lock(blockIdx.x);
+            PatchLock& q_lock = m_context.m_patches_info[q].lock;
+
+            okay = m_context.m_optimistic ?
+                       q_lock.read_version(m_s_versions[stash_id]) :
+                       q_lock.acquire_lock(lock_id(m_patch_info.patch_id));
             if (okay) {
                 assert(stash_id < m_s_locked_patches_mask.size());
                 m_s_locked_patches_mask.set(stash_id);
+            } else {
+                detail::count(m_context.m_counters, Counter::NeighborLockFail);
             }
         }
         s_success = okay;
@@ -2112,7 +2265,11 @@ template <uint32_t blockThreads, CavityOp cop>
 __device__ __forceinline__ void CavityManager<blockThreads, cop>::unlock()
 {
     if (threadIdx.x == 0) {
-        m_patch_info.lock.release_lock();
+        if (!m_context.m_optimistic) {
+            m_patch_info.lock.release_lock();
+        } else if (m_write_to_gmem) {
+            m_patch_info.lock.end_commit();
+        }
     }
 }
 
@@ -2156,11 +2313,172 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::unlock(
     if (threadIdx.x == 0) {
         assert(stash_id < m_s_locked_patches_mask.size());
         assert(m_s_locked_patches_mask(stash_id));
-        m_context.m_patches_info[q].lock.release_lock();
+        // in the optimistic mode, a patch that is unlocked before the commit
+        // is only dropped from the patches validated on commit
+        if (!m_context.m_optimistic) {
+            m_context.m_patches_info[q].lock.release_lock();
+        } else if (m_write_to_gmem) {
+            m_context.m_patches_info[q].lock.end_commit();
+        }
         m_s_locked_patches_mask.reset(stash_id);
     }
 }
 
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __inline__ bool CavityManager<blockThreads, cop>::commit(
+    cooperative_groups::thread_block& block)
+{
+    if (!m_context.m_optimistic) {
+        return true;
+    }
+
+    __shared__ bool s_success;
+    block.sync();
+    if (threadIdx.x == 0) {
+        // the entry stash_size is this patch
+        auto patch_at = [&](const uint32_t st) {
+            return (st == PatchStash::stash_size) ?
+                       patch_id() :
+                       m_s_patch_stash.get_patch(st);
+        };
+        auto is_read = [&](const uint32_t st) {
+            return st == PatchStash::stash_size || m_s_locked_patches_mask(st);
+        };
+
+        // commit to the patches in ascending order of their id so that when
+        // two blocks read the same patches, the first one to commit to the
+        // patch with the smallest id wins instead of both of them failing
+        bool     okay = true;
+        uint32_t last = INVALID32;
+        while (okay) {
+            uint32_t next_st = INVALID32, next_p = INVALID32;
+            for (uint32_t st = 0; st <= PatchStash::stash_size; ++st) {
+                if (is_read(st)) {
+                    const uint32_t q = patch_at(st);
+                    if ((last == INVALID32 || q > last) && q < next_p) {
+                        next_p  = q;
+                        next_st = st;
+                    }
+                }
+            }
+            if (next_st == INVALID32) {
+                break;
+            }
+            okay = m_context.m_patches_info[next_p].lock.try_commit(
+                m_s_versions[next_st]);
+            last = next_p;
+        }
+
+        // undo the commits of the patches before the one that failed
+        if (!okay) {
+            for (uint32_t st = 0; st <= PatchStash::stash_size; ++st) {
+                if (is_read(st) && patch_at(st) < last) {
+                    m_context.m_patches_info[patch_at(st)].lock.abort_commit();
+                }
+            }
+        }
+        s_success = okay;
+    }
+    block.sync();
+    return s_success;
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __inline__ bool CavityManager<blockThreads, cop>::is_snapshot_valid(
+    cooperative_groups::thread_block& block)
+{
+    if (!m_context.m_optimistic) {
+        return true;
+    }
+
+    __shared__ bool s_valid;
+    block.sync();
+    if (threadIdx.x == 0) {
+        uint32_t v = 0;
+        s_valid    = m_patch_info.lock.read_version(v) &&
+                  v == m_s_versions[PatchStash::stash_size];
+    }
+    block.sync();
+    return s_valid;
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __inline__ bool CavityManager<blockThreads, cop>::check_read(
+    const uint16_t id,
+    const uint16_t bound)
+{
+    if (!m_context.m_optimistic || id < bound) {
+        return true;
+    }
+    m_s_torn[0] = true;
+    return false;
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename HandleT>
+__device__ __inline__ bool CavityManager<blockThreads, cop>::check_read(
+    const HandleT h)
+{
+    if (!m_context.m_optimistic) {
+        return true;
+    }
+    // the LP hashtable probes a fixed number of buckets and the stash (see
+    // LPHashTable::find) so a torn table can only give us a wrong handle
+    if (h.is_valid() && h.patch_id() < m_context.m_max_num_patches &&
+        h.local_id() < m_context.m_patches_info[h.patch_id()]
+                           .template get_capacity<HandleT>()[0]) {
+        return true;
+    }
+    m_s_torn[0] = true;
+    return false;
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename HandleT>
+__device__ __inline__ uint16_t CavityManager<blockThreads, cop>::read_bound(
+    const PatchInfo& q) const
+{
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        return std::min(std::min(q.vertices_capacity[0], m_s_src_mask_v.size()),
+                        std::min(m_s_src_connect_mask_v.size(),
+                                 m_correspondence_size_vf));
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        return std::min(std::min(q.edges_capacity[0], m_s_src_mask_e.size()),
+                        std::min(m_s_src_connect_mask_e.size(),
+                                 m_correspondence_size_e));
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        return std::min(q.faces_capacity[0], m_correspondence_size_vf);
+    }
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename HandleT>
+__device__ __inline__ uint16_t CavityManager<blockThreads, cop>::num_read(
+    const PatchInfo& q)
+{
+    uint16_t n = 0;
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        n = q.num_vertices[0];
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        n = q.num_edges[0];
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        n = q.num_faces[0];
+    }
+    if (!m_context.m_optimistic) {
+        return n;
+    }
+    const uint16_t bound = read_bound<HandleT>(q);
+    if (n > bound) {
+        m_s_torn[0] = true;
+        return bound;
+    }
+    return n;
+}
+
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __inline__ void CavityManager<blockThreads, cop>::pre_migrate(
     cooperative_groups::thread_block& block)
@@ -2552,8 +2870,10 @@ CavityManager<blockThreads, cop>::soft_migrate_from_patch(
 
         PatchInfo q_patch_info = m_context.m_patches_info[q];
 
-        const uint16_t q_num_vertices = q_patch_info.num_vertices[0];
-        const uint16_t q_num_edges    = q_patch_info.num_edges[0];
+        // q is not locked in the optimistic mode so everything read from it
+        // is checked before it is used as an index (see check_read())
+        const uint16_t q_num_vertices = num_read<VertexHandle>(q_patch_info);
+        const uint16_t q_num_edges    = num_read<EdgeHandle>(q_patch_info);
 
         // initialize connect_mask and src_e bitmask
         m_s_src_connect_mask_v.reset(block);
@@ -2567,19 +2887,26 @@ CavityManager<blockThreads, cop>::soft_migrate_from_patch(
                 const uint16_t v0q = q_patch_info.ev[2 * e + 0].id;
                 const uint16_t v1q = q_patch_info.ev[2 * e + 1].id;
 
+                if (!check_read(v0q, q_num_vertices) ||
+                    !check_read(v1q, q_num_vertices)) {
+                    continue;
+                }
+
                 assert(v0q < m_s_src_mask_v.size());
 
                 if (m_s_src_mask_v(v0q)) {
                     assert(v1q < m_s_src_connect_mask_v.size());
                     m_s_src_connect_mask_v.set(v1q, true);
-                    assert(!q_patch_info.is_deleted(LocalVertexT(v1q)));
+                    assert(m_context.m_optimistic ||
+                           !q_patch_info.is_deleted(LocalVertexT(v1q)));
                 }
 
                 assert(v1q < m_s_src_mask_v.size());
                 if (m_s_src_mask_v(v1q)) {
                     assert(v0q < m_s_src_connect_mask_v.size());
                     m_s_src_connect_mask_v.set(v0q, true);
-                    assert(!q_patch_info.is_deleted(LocalVertexT(v0q)));
+                    assert(m_context.m_optimistic ||
+                           !q_patch_info.is_deleted(LocalVertexT(v0q)));
                 }
             }
         }
@@ -2613,25 +2940,28 @@ CavityManager<blockThreads, cop>::soft_migrate_from_patch(
         // non-existing vertices
         for (uint16_t v = threadIdx.x; v < q_num_vertices_up;
              v += blockThreads) {
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
-            LPPair lp = migrate_vertex(
-                q,
-                q_stash_id,
-                q_num_vertices,
-                v,
-                q_patch_info,
-                [&](const uint16_t vertex) {
-                    assert(vertex < m_s_src_connect_mask_v.size());
-                    return m_s_src_connect_mask_v(vertex);
-                },
-                true);
+            LPPair lp;
+            ordered(block, [&]() {
+                lp = migrate_vertex(
+                    q,
+                    q_stash_id,
+                    q_num_vertices,
+                    v,
+                    q_patch_info,
+                    [&](const uint16_t vertex) {
+                        assert(vertex < m_s_src_connect_mask_v.size());
+                        return m_s_src_connect_mask_v(vertex);
+                    },
+                    true);
+            });
             // we need to make sure that no other
             // thread is querying the hashtable while we
             // insert in it
             block.sync();
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
             if (!lp.is_sentinel()) {
@@ -2652,7 +2982,7 @@ CavityManager<blockThreads, cop>::soft_migrate_from_patch(
             }
             block.sync();
         }
-        if (m_s_should_slice[0]) {
+        if (m_s_should_slice[0] || m_s_torn[0]) {
             return false;
         }
 
@@ -2737,9 +3067,11 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
 
         PatchInfo q_patch_info = m_context.m_patches_info[q];
 
-        const uint16_t q_num_vertices = q_patch_info.num_vertices[0];
-        const uint16_t q_num_edges    = q_patch_info.num_edges[0];
-        const uint16_t q_num_faces    = q_patch_info.num_faces[0];
+        // q is not locked in the optimistic mode so everything read from it
+        // is checked before it is used as an index (see check_read())
+        const uint16_t q_num_vertices = num_read<VertexHandle>(q_patch_info);
+        const uint16_t q_num_edges    = num_read<EdgeHandle>(q_patch_info);
+        const uint16_t q_num_faces    = num_read<FaceHandle>(q_patch_info);
 
         // initialize connect_mask and src_e bitmask
         m_s_src_connect_mask_v.reset(block);
@@ -2754,18 +3086,25 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
                 const uint16_t v0q = q_patch_info.ev[2 * e + 0].id;
                 const uint16_t v1q = q_patch_info.ev[2 * e + 1].id;
 
+                if (!check_read(v0q, q_num_vertices) ||
+                    !check_read(v1q, q_num_vertices)) {
+                    continue;
+                }
+
                 assert(v0q < m_s_src_mask_v.size());
                 if (m_s_src_mask_v(v0q)) {
                     assert(v1q < m_s_src_connect_mask_v.size());
                     m_s_src_connect_mask_v.set(v1q, true);
-                    assert(!q_patch_info.is_deleted(LocalVertexT(v1q)));
+                    assert(m_context.m_optimistic ||
+                           !q_patch_info.is_deleted(LocalVertexT(v1q)));
                 }
 
                 assert(v1q < m_s_src_mask_v.size());
                 if (m_s_src_mask_v(v1q)) {
                     assert(v0q < m_s_src_connect_mask_v.size());
                     m_s_src_connect_mask_v.set(v0q, true);
-                    assert(!q_patch_info.is_deleted(LocalVertexT(v0q)));
+                    assert(m_context.m_optimistic ||
+                           !q_patch_info.is_deleted(LocalVertexT(v0q)));
                 }
             }
         }
@@ -2799,24 +3138,27 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
         // non-existing vertices
         for (uint16_t v = threadIdx.x; v < q_num_vertices_up;
              v += blockThreads) {
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
-            LPPair lp = migrate_vertex(
-                q,
-                q_stash_id,
-                q_num_vertices,
-                v,
-                q_patch_info,
-                [&](const uint16_t vertex) {
-                    assert(vertex < m_s_src_connect_mask_v.size());
-                    return m_s_src_connect_mask_v(vertex);
-                });
+            LPPair lp;
+            ordered(block, [&]() {
+                lp = migrate_vertex(
+                    q,
+                    q_stash_id,
+                    q_num_vertices,
+                    v,
+                    q_patch_info,
+                    [&](const uint16_t vertex) {
+                        assert(vertex < m_s_src_connect_mask_v.size());
+                        return m_s_src_connect_mask_v(vertex);
+                    });
+            });
             // we need to make sure that no other
             // thread is querying the hashtable while we
             // insert in it
             block.sync();
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
             if (!lp.is_sentinel()) {
@@ -2837,7 +3179,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
             }
             block.sync();
         }
-        if (m_s_should_slice[0]) {
+        if (m_s_should_slice[0] || m_s_torn[0]) {
             return false;
         }
 
@@ -2865,35 +3207,38 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
 
         // 4. move edges since we now have a copy of the vertices in p
         for (uint16_t e = threadIdx.x; e < q_num_edges_up; e += blockThreads) {
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
-            LPPair lp = migrate_edge(
-                q,
-                q_stash_id,
-                q_num_edges,
-                e,
-                q_patch_info,
-                [&](const uint16_t edge,
-                    const uint16_t v0q,
-                    const uint16_t v1q) {
-                    // If any of these two vertices are participant in
-                    // the src bitmask
-                    assert(v0q < m_s_src_mask_v.size());
-                    assert(v1q < m_s_src_mask_v.size());
-                    if (m_s_src_mask_v(v0q) || m_s_src_mask_v(v1q)) {
-                        assert(!q_patch_info.is_deleted(LocalEdgeT(edge)));
-                        // set the bit for this edge in src_e mask so we
-                        // can use it for migrating faces
-                        assert(edge < m_s_src_mask_e.size());
-                        m_s_src_mask_e.set(edge, true);
-                        return true;
-                    }
-                    return false;
-                });
+            LPPair lp;
+            ordered(block, [&]() {
+                lp = migrate_edge(
+                    q,
+                    q_stash_id,
+                    q_num_edges,
+                    e,
+                    q_patch_info,
+                    [&](const uint16_t edge,
+                        const uint16_t v0q,
+                        const uint16_t v1q) {
+                        // If any of these two vertices are participant in
+                        // the src bitmask
+                        assert(v0q < m_s_src_mask_v.size());
+                        assert(v1q < m_s_src_mask_v.size());
+                        if (m_s_src_mask_v(v0q) || m_s_src_mask_v(v1q)) {
+                            assert(!q_patch_info.is_deleted(LocalEdgeT(edge)));
+                            // set the bit for this edge in src_e mask so we
+                            // can use it for migrating faces
+                            assert(edge < m_s_src_mask_e.size());
+                            m_s_src_mask_e.set(edge, true);
+                            return true;
+                        }
+                        return false;
+                    });
+            });
 
             block.sync();
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
             if (!lp.is_sentinel()) {
@@ -2914,7 +3259,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
             }
             block.sync();
         }
-        if (m_s_should_slice[0]) {
+        if (m_s_should_slice[0] || m_s_torn[0]) {
             return false;
         }
 
@@ -2937,9 +3282,18 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
                 const uint16_t e1 = q_patch_info.fe[3 * f + 1].id >> 1;
                 const uint16_t e2 = q_patch_info.fe[3 * f + 2].id >> 1;
 
-                assert(!q_patch_info.is_deleted(LocalEdgeT(e0)));
-                assert(!q_patch_info.is_deleted(LocalEdgeT(e1)));
-                assert(!q_patch_info.is_deleted(LocalEdgeT(e2)));
+                if (!check_read(e0, q_num_edges) ||
+                    !check_read(e1, q_num_edges) ||
+                    !check_read(e2, q_num_edges)) {
+                    continue;
+                }
+
+                assert(m_context.m_optimistic ||
+                       !q_patch_info.is_deleted(LocalEdgeT(e0)));
+                assert(m_context.m_optimistic ||
+                       !q_patch_info.is_deleted(LocalEdgeT(e1)));
+                assert(m_context.m_optimistic ||
+                       !q_patch_info.is_deleted(LocalEdgeT(e2)));
 
                 assert(e0 < m_s_src_mask_e.size());
                 assert(e1 < m_s_src_mask_e.size());
@@ -3026,23 +3380,26 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
         // make sure that there is a copy of edge in
         // m_s_src_connect_mask_e in q
         for (uint16_t e = threadIdx.x; e < q_num_edges_up; e += blockThreads) {
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
-            LPPair lp =
-                migrate_edge(q,
-                             q_stash_id,
-                             q_num_edges,
-                             e,
-                             q_patch_info,
-                             [&](const uint16_t edge,
-                                 const uint16_t v0q,
-                                 const uint16_t v1q) {
-                                 assert(edge < m_s_src_connect_mask_e.size());
-                                 return m_s_src_connect_mask_e(edge);
-                             });
+            LPPair lp;
+            ordered(block, [&]() {
+                lp = migrate_edge(
+                    q,
+                    q_stash_id,
+                    q_num_edges,
+                    e,
+                    q_patch_info,
+                    [&](const uint16_t edge,
+                        const uint16_t v0q,
+                        const uint16_t v1q) {
+                        assert(edge < m_s_src_connect_mask_e.size());
+                        return m_s_src_connect_mask_e(edge);
+                    });
+            });
             block.sync();
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
             if (!lp.is_sentinel()) {
@@ -3063,7 +3420,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
             }
             block.sync();
         }
-        if (m_s_should_slice[0]) {
+        if (m_s_should_slice[0] || m_s_torn[0]) {
             return false;
         }
 
@@ -3092,28 +3449,31 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
 
         // 6.  move face since we now have a copy of the edges in p
         for (uint16_t f = threadIdx.x; f < q_num_faces_up; f += blockThreads) {
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
-            LPPair lp = migrate_face(q,
-                                     q_stash_id,
-                                     q_num_faces,
-                                     f,
-                                     q_patch_info,
-                                     [&](const uint16_t face,
-                                         const uint16_t e0q,
-                                         const uint16_t e1q,
-                                         const uint16_t e2q) {
-                                         assert(e0q < m_s_src_mask_e.size());
-                                         assert(e1q < m_s_src_mask_e.size());
-                                         assert(e2q < m_s_src_mask_e.size());
-
-                                         return m_s_src_mask_e(e0q) ||
-                                                m_s_src_mask_e(e1q) ||
-                                                m_s_src_mask_e(e2q);
-                                     });
+            LPPair lp;
+            ordered(block, [&]() {
+                lp = migrate_face(
+                    q,
+                    q_stash_id,
+                    q_num_faces,
+                    f,
+                    q_patch_info,
+                    [&](const uint16_t face,
+                        const uint16_t e0q,
+                        const uint16_t e1q,
+                        const uint16_t e2q) {
+                        assert(e0q < m_s_src_mask_e.size());
+                        assert(e1q < m_s_src_mask_e.size());
+                        assert(e2q < m_s_src_mask_e.size());
+
+                        return m_s_src_mask_e(e0q) || m_s_src_mask_e(e1q) ||
+                               m_s_src_mask_e(e2q);
+                    });
+            });
             block.sync();
-            if (m_s_should_slice[0]) {
+            if (m_s_should_slice[0] || m_s_torn[0]) {
                 return false;
             }
             if (!lp.is_sentinel()) {
@@ -3134,7 +3494,7 @@ __device__ __inline__ bool CavityManager<blockThreads, cop>::migrate_from_patch(
             }
             block.sync();
         }
-        if (m_s_should_slice[0]) {
+        if (m_s_should_slice[0] || m_s_torn[0]) {
             return false;
         }
 
@@ -3167,6 +3527,9 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_vertex(
             uint8_t  o_stash = q_stash_id;
 
             uint16_t vp = find_copy_vertex(vq, o, o_stash);
+            if (m_s_torn[0]) {
+                return ret;
+            }
 
             // assert(!m_context.m_patches_info[o].is_deleted(LocalVertexT(vq)));
             // assert(m_context.m_patches_info[o].is_owned(LocalVertexT(vq)));
@@ -3243,6 +3606,11 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_edge(
         uint16_t v0q = q_patch_info.ev[2 * q_edge + 0].id;
         uint16_t v1q = q_patch_info.ev[2 * q_edge + 1].id;
 
+        const uint16_t bound_v = read_bound<VertexHandle>(q_patch_info);
+        if (!check_read(v0q, bound_v) || !check_read(v1q, bound_v)) {
+            return ret;
+        }
+
         if (should_migrate(q_edge, v0q, v1q)) {
 
             // check on if e already exist in p
@@ -3250,6 +3618,9 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_edge(
             uint32_t o       = q;
             uint8_t  o_stash = q_stash_id;
             uint16_t ep      = find_copy_edge(eq, o, o_stash);
+            if (m_s_torn[0]) {
+                return ret;
+            }
 
             // assert(!m_context.m_patches_info[o].is_deleted(LocalEdgeT(eq)));
             // assert(m_context.m_patches_info[o].is_owned(LocalEdgeT(eq)));
@@ -3278,6 +3649,9 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_edge(
                 uint8_t  o0_stash(q_stash_id), o1_stash(q_stash_id);
                 uint16_t v0p = find_copy_vertex(v0q, o0, o0_stash);
                 uint16_t v1p = find_copy_vertex(v1q, o1, o1_stash);
+                if (m_s_torn[0]) {
+                    return ret;
+                }
 
                 // since any vertex in m_s_src_mask_v has been
                 // added already to p, then we should find the
@@ -3382,6 +3756,12 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_face(
         Context::unpack_edge_dir(q_patch_info.fe[3 * q_face + 1].id, e1q, d1);
         Context::unpack_edge_dir(q_patch_info.fe[3 * q_face + 2].id, e2q, d2);
 
+        const uint16_t bound_e = read_bound<EdgeHandle>(q_patch_info);
+        if (!check_read(e0q, bound_e) || !check_read(e1q, bound_e) ||
+            !check_read(e2q, bound_e)) {
+            return ret;
+        }
+
         // If any of these three edges are participant in
         // the src bitmask
         if (should_migrate(q_face, e0q, e1q, e2q)) {
@@ -3391,6 +3771,9 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_face(
             uint32_t o       = q;
             uint8_t  o_stash = q_stash_id;
             uint16_t fp      = find_copy_face(fq, o, o_stash);
+            if (m_s_torn[0]) {
+                return ret;
+            }
 
 
             if (fp == INVALID16) {
@@ -3418,6 +3801,9 @@ __device__ __inline__ LPPair CavityManager<blockThreads, cop>::migrate_face(
                 const uint16_t e0p = find_copy_edge(e0q, o0, o0_stash);
                 const uint16_t e1p = find_copy_edge(e1q, o1, o1_stash);
                 const uint16_t e2p = find_copy_edge(e2q, o2, o2_stash);
+                if (m_s_torn[0]) {
+                    return ret;
+                }
 
 
                 // since any edge in m_s_src_mask_e has been
@@ -3538,8 +3924,9 @@ __device__ __inline__ uint16_t CavityManager<blockThreads, cop>::find_copy(
     const LPPair*  s_stash)
 {
 
-    assert(
-        !m_context.m_patches_info[src_patch].is_deleted(HandleT::LocalT(lid)));
+    assert(m_context.m_optimistic ||
+           !m_context.m_patches_info[src_patch].is_deleted(
+               HandleT::LocalT(lid)));
 
     uint16_t corres = q_correspondence[lid];
 
@@ -3557,6 +3944,12 @@ __device__ __inline__ uint16_t CavityManager<blockThreads, cop>::find_copy(
         owner = m_context.m_patches_info[src_patch].find<HandleT>(
             {lid} /*, m_s_table_q, m_s_table_stash_q */);
 
+        // src_patch may not be locked (in the optimistic mode) and so its
+        // hashtable may be torn
+        if (!check_read(owner)) {
+            return INVALID16;
+        }
+
         assert(owner.is_valid());
 
         // if the owner src_patch is the same as the patch associated with this
@@ -3857,6 +4250,222 @@ __device__ __inline__ void CavityManager<blockThreads, cop>::update_attribute(
 }
 
 
+template <uint32_t blockThreads, CavityOp cop>
+template <typename T>
+__device__ __inline__ void CavityManager<blockThreads, cop>::update_attribute(
+    DerivedAttributes<T>& derived)
+{
+    update_attribute(derived.coords);
+    if (derived.has(DERIVED_EDGE_LENGTH)) {
+        update_attribute(derived.edge_length);
+    }
+    if (derived.has(DERIVED_FACE_NORMAL)) {
+        update_attribute(derived.face_normal);
+    }
+    if (derived.has(DERIVED_FACE_AREA)) {
+        update_attribute(derived.face_area);
+    }
+    if (derived.has(DERIVED_VERTEX_VALENCE)) {
+        update_attribute(derived.valence);
+    }
+    if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+        update_attribute(derived.boundary);
+    }
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename T>
+__device__ __inline__ void CavityManager<blockThreads, cop>::update_derived(
+    cooperative_groups::thread_block& block,
+    DerivedAttributes<T>&             derived)
+{
+    const uint32_t p = patch_id();
+
+    auto face_vertex = [&](const uint16_t f, const int i) {
+        uint16_t edge;
+        flag_t   dir;
+        Context::unpack_edge_dir(m_s_fe[3 * f + i], edge, dir);
+        return m_s_ev[2 * edge + dir];
+    };
+
+    auto position = [&](const uint16_t v) {
+        return vec3<T>(derived.coords(p, v, 0),
+                       derived.coords(p, v, 1),
+                       derived.coords(p, v, 2));
+    };
+
+    if (derived.has(DERIVED_EDGE_LENGTH)) {
+        for (uint16_t e = threadIdx.x; e < m_s_num_edges[0];
+             e += blockThreads) {
+            if (m_s_fill_in_e(e) && m_s_active_mask_e(e)) {
+                derived.edge_length(p, e, 0) = glm::length(
+                    position(m_s_ev[2 * e + 1]) - position(m_s_ev[2 * e]));
+            }
+        }
+    }
+
+    if (derived.has(DERIVED_FACE_NORMAL) || derived.has(DERIVED_FACE_AREA)) {
+        for (uint16_t f = threadIdx.x; f < m_s_num_faces[0];
+             f += blockThreads) {
+            if (m_s_fill_in_f(f) && m_s_active_mask_f(f)) {
+                const vec3<T> p0 = position(face_vertex(f, 0));
+                const vec3<T> p1 = position(face_vertex(f, 1));
+                const vec3<T> p2 = position(face_vertex(f, 2));
+                if (derived.has(DERIVED_FACE_NORMAL)) {
+                    const vec3<T> n = tri_normal(p0, p1, p2);
+                    for (int i = 0; i < 3; ++i) {
+                        derived.face_normal(p, f, i) = n[i];
+                    }
+                }
+                if (derived.has(DERIVED_FACE_AREA)) {
+                    derived.face_area(p, f, 0) = tri_area(p0, p1, p2);
+                }
+            }
+        }
+    }
+
+    if (!derived.has(DERIVED_VERTEX_VALENCE) &&
+        !derived.has(DERIVED_VERTEX_BOUNDARY)) {
+        return;
+    }
+
+    // the new vertices start from zero
+    for (uint16_t v = threadIdx.x; v < m_s_num_vertices[0]; v += blockThreads) {
+        if (m_s_fill_in_v(v) && m_s_active_mask_v(v)) {
+            if (derived.has(DERIVED_VERTEX_VALENCE)) {
+                derived.valence(p, v, 0) = 0;
+            }
+            if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+                derived.boundary(p, v, 0) = 0;
+            }
+        }
+    }
+    block.sync();
+
+    update_derived_degree(derived, true);
+    block.sync();
+
+    // the not-owned vertices hold the change of the vertex since the
+    // prologue which goes to the owner patch
+    for (uint16_t v = threadIdx.x; v < m_s_num_vertices[0]; v += blockThreads) {
+        if (!m_s_active_mask_v(v) || m_s_owned_mask_v(v)) {
+            continue;
+        }
+        const VertexHandle owner =
+            m_context.get_owner_handle(VertexHandle(p, v));
+        if (derived.has(DERIVED_VERTEX_VALENCE)) {
+            const uint8_t delta = derived.valence(p, v, 0);
+            if (delta != 0) {
+                atomicAdd(&derived.valence(owner, 0), delta);
+                derived.valence(p, v, 0) = 0;
+            }
+        }
+        if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+            const uint8_t delta = derived.boundary(p, v, 0);
+            if (delta != 0) {
+                atomicAdd(&derived.boundary(owner, 0), delta);
+                derived.boundary(p, v, 0) = 0;
+            }
+        }
+    }
+    block.sync();
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename T>
+__device__ __inline__ void CavityManager<blockThreads, cop>::remove_derived(
+    cooperative_groups::thread_block& block,
+    DerivedAttributes<T>&             derived)
+{
+    if (!derived.has(DERIVED_VERTEX_VALENCE) &&
+        !derived.has(DERIVED_VERTEX_BOUNDARY)) {
+        return;
+    }
+
+    const uint32_t p = patch_id();
+
+    // the values of the not-owned vertices are not read through this patch
+    for (uint16_t v = threadIdx.x; v < m_s_num_vertices[0]; v += blockThreads) {
+        if (!m_s_owned_mask_v(v)) {
+            if (derived.has(DERIVED_VERTEX_VALENCE)) {
+                derived.valence(p, v, 0) = 0;
+            }
+            if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+                derived.boundary(p, v, 0) = 0;
+            }
+        }
+    }
+    block.sync();
+
+    update_derived_degree(derived, false);
+    block.sync();
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename T>
+__device__ __inline__ void
+CavityManager<blockThreads, cop>::update_derived_degree(
+    DerivedAttributes<T>& derived,
+    const bool            add)
+{
+    const uint32_t p = patch_id();
+
+    // a manifold vertex is on the boundary iff it has one more edge than
+    // faces. So the boundary flag is maintained as the number of edges minus
+    // the number of faces. The atomics wrap around in 8 bits so removing is
+    // adding 255
+    const uint8_t one = add ? 1 : 255;
+
+    auto add_to = [&](VertexAttribute<uint8_t>& attr,
+                      const uint16_t            v,
+                      const uint8_t             val) {
+        atomicAdd(&attr(p, v, 0), val);
+    };
+
+    for (uint16_t e = threadIdx.x; e < m_s_num_edges[0]; e += blockThreads) {
+        const bool updated =
+            add ? (m_s_active_mask_e(e) &&
+                   (m_s_fill_in_e(e) || m_s_in_cavity_e(e))) :
+                  m_s_in_cavity_e(e);
+        if (!updated) {
+            continue;
+        }
+        for (int i = 0; i < 2; ++i) {
+            const uint16_t v = m_s_ev[2 * e + i];
+            if (derived.has(DERIVED_VERTEX_VALENCE)) {
+                add_to(derived.valence, v, one);
+            }
+            if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+                add_to(derived.boundary, v, one);
+            }
+        }
+    }
+
+    if (!derived.has(DERIVED_VERTEX_BOUNDARY)) {
+        return;
+    }
+
+    for (uint16_t f = threadIdx.x; f < m_s_num_faces[0]; f += blockThreads) {
+        const bool updated =
+            add ? (m_s_active_mask_f(f) &&
+                   (m_s_fill_in_f(f) || m_s_in_cavity_f(f))) :
+                  m_s_in_cavity_f(f);
+        if (!updated) {
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            uint16_t edge;
+            flag_t   dir;
+            Context::unpack_edge_dir(m_s_fe[3 * f + i], edge, dir);
+            add_to(derived.boundary, m_s_ev[2 * edge + dir], uint8_t(-one));
+        }
+    }
+}
+
+
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __inline__ void CavityManager<blockThreads, cop>::recover_faces()
 {
@@ -3999,11 +4608,14 @@ CavityManager<blockThreads, cop>::recover_faces_through_edges()
 }
 
 template <uint32_t blockThreads, CavityOp cop>
+template <typename... AttributesT>
 __device__ __inline__ void CavityManager<blockThreads, cop>::epilogue(
-    cooperative_groups::thread_block& block)
+    cooperative_groups::thread_block& block,
+    AttributesT&... attributes)
 {
     // make sure all writes are done
     block.sync();
+    end_stage(block, Stage::FillIn);
     if (m_write_to_gmem) {
 
         // update number of elements again since add_vertex/edge/face could have
@@ -4181,6 +4793,11 @@ __device__ __inline__ void CavityManager<blockThreads, cop>::epilogue(
         detail::store<blockThreads>(m_s_active_mask_f.m_bitmask,
                                     DIVIDE_UP(m_s_num_faces[0], 32),
                                     m_patch_info.active_mask_f);
+
+        // also when the fill-in is removed to restore what the prologue has
+        // removed from the derived vertex quantities
+        block.sync();
+        ([&] { update_derived(block, attributes); }(), ...);
     }
 
     if (m_s_should_slice[0]) {
@@ -4196,10 +4813,19 @@ __device__ __inline__ void CavityManager<blockThreads, cop>::epilogue(
         push();
     }
 
+    if (threadIdx.x == 0 && get_num_cavities() > 0) {
+        detail::count(m_context.m_counters,
+                      m_write_to_gmem ? Counter::CavitySuccess :
+                                        Counter::CavityFail,
+                      get_num_cavities());
+    }
+
     // unlock any neighbor patch we have locked
     unlock_locked_patches();
 
     // unlock this patch
     unlock();
+
+    end_stage(block, Stage::Epilogue);
 }
 }  // namespace rxmesh
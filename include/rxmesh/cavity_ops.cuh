@@ -0,0 +1,459 @@
+#pragma once
+
+#include <cooperative_groups.h>
+
+#include "rxmesh/bitmask.cuh"
+#include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/kernels/collective.cuh"
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/query.cuh"
+
+namespace rxmesh {
+
+/**
+ * @brief The operations that apply_edge_ops() can apply on an edge. All
+ * operations are seeded by an edge (v0, v1) where v0 and v1 are the edge's two
+ * end vertices such that the face (v0, v1, a) is on one side of the edge and
+ * the face (v1, v0, b) is on the other side i.e., v0, a, v1, and b are
+ * iter[0], iter[1], iter[2], and iter[3] of the Op::EVDiamond iterator
+ */
+enum class EdgeOp : uint8_t
+{
+    None = 0,
+    // insert a new vertex in the middle of the edge
+    Split = 1,
+    // replace the edge (v0, v1) with (a, b)
+    Flip = 2,
+    // replace the edge with a new vertex in its middle
+    Collapse = 3,
+    // remove v0 and re-triangulate its one-ring by connecting it to v1 (i.e.,
+    // half-edge collapse v0 -> v1)
+    DeleteSrcVertex = 4,
+    // remove v1 and re-triangulate its one-ring by connecting it to v0
+    DeleteDstVertex = 5,
+    // remove the face (v0, v1, a) which leaves a hole in the mesh
+    DeleteFace = 6,
+};
+
+namespace detail {
+/**
+ * @brief check the link condition of every edge with an operation i.e., the
+ * two end vertices of the edge should share exactly two vertices in their
+ * one-ring. Additionally, a flip is rejected if the two opposite vertices are
+ * already connected. Rejected edges have their operation reset to EdgeOp::None.
+ * The one-ring of all vertices in the patch is first built in shared memory
+ * (in CSR format) and then every thread checks the edges assigned to it
+ * independently of the others
+ * @param s_vv_offset shared memory buffer of num_vertices + 2 entries
+ * @param s_vv shared memory buffer of 2 * num_edges entries
+ */
+template <uint32_t blockThreads>
+__device__ __inline__ void edge_ops_link_condition(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    Query<blockThreads>&              ev_query,
+    uint8_t*                          s_edge_op,
+    uint16_t*                         s_vv_offset,
+    uint16_t*                         s_vv)
+{
+    const uint16_t num_vertices = patch_info.num_vertices[0];
+
+    // 1. the valence of every vertex is counted in s_vv_offset[v + 1] such
+    // that the exclusive sum turns s_vv_offset[v + 1] into the start of v and
+    // the scatter (which increments it) turns it into the start of v + 1
+    fill_n<blockThreads>(s_vv_offset, num_vertices + 2, uint16_t(0));
+    block.sync();
+
+    for_each_edge(
+        patch_info,
+        [&](EdgeHandle eh) {
+            const VertexIterator iter =
+                ev_query.template get_iterator<VertexIterator>(eh.local_id());
+            atomicAdd(s_vv_offset + iter.local(0) + 1, uint16_t(1));
+            atomicAdd(s_vv_offset + iter.local(2) + 1, uint16_t(1));
+        },
+        true);
+    block.sync();
+
+    cub_block_exclusive_sum<uint16_t, blockThreads>(s_vv_offset,
+                                                    num_vertices + 1);
+    block.sync();
+
+    for_each_edge(
+        patch_info,
+        [&](EdgeHandle eh) {
+            const VertexIterator iter =
+                ev_query.template get_iterator<VertexIterator>(eh.local_id());
+            const uint16_t v0 = iter.local(0);
+            const uint16_t v1 = iter.local(2);
+            s_vv[atomicAdd(s_vv_offset + v0 + 1, uint16_t(1))] = v1;
+            s_vv[atomicAdd(s_vv_offset + v1 + 1, uint16_t(1))] = v0;
+        },
+        true);
+    block.sync();
+
+    // 2. every edge with an operation intersects the one-ring of its two end
+    // vertices
+    for_each_edge(patch_info, [&](EdgeHandle eh) {
+        const uint16_t e  = eh.local_id();
+        const EdgeOp   op = static_cast<EdgeOp>(s_edge_op[e]);
+        if (op == EdgeOp::None) {
+            return;
+        }
+
+        const VertexIterator iter =
+            ev_query.template get_iterator<VertexIterator>(e);
+
+        const uint16_t v0 = iter.local(0);
+        const uint16_t v1 = iter.local(2);
+        const uint16_t a  = iter.local(1);
+        const uint16_t b  = iter.local(3);
+
+        int num_shared_one_ring = 0;
+        for (uint16_t i = s_vv_offset[v0]; i < s_vv_offset[v0 + 1]; ++i) {
+            const uint16_t n = s_vv[i];
+            for (uint16_t j = s_vv_offset[v1]; j < s_vv_offset[v1 + 1]; ++j) {
+                if (s_vv[j] == n) {
+                    num_shared_one_ring++;
+                    break;
+                }
+            }
+        }
+
+        bool opposite_connected = false;
+        if (op == EdgeOp::Flip) {
+            for (uint16_t i = s_vv_offset[a]; i < s_vv_offset[a + 1]; ++i) {
+                if (s_vv[i] == b) {
+                    opposite_connected = true;
+                    break;
+                }
+            }
+        }
+
+        if (num_shared_one_ring > 2 || opposite_connected) {
+            s_edge_op[e] = static_cast<uint8_t>(EdgeOp::None);
+        }
+    });
+    block.sync();
+}
+}  // namespace detail
+
+/**
+ * @brief the extra (user) shared memory needed by apply_edge_ops(). This
+ * should be passed as the user_shmem of RXMeshDynamic::prepare_launch_box()
+ * along with Op::EVDiamond as the query operation e.g.,
+ * rx.prepare_launch_box({Op::EVDiamond}, lb, kernel, true, false, false,
+ * false, edge_ops_shmem_bytes);
+ */
+inline size_t edge_ops_shmem_bytes(uint32_t v, uint32_t e, uint32_t f)
+{
+    const uint32_t half_f = DIVIDE_UP(f, 2);
+
+    // new edges mask + per-cavity op and opposite vertices
+    size_t persistent = detail::mask_num_bytes(e) + half_f * sizeof(uint8_t) +
+                        2 * half_f * sizeof(uint16_t) +
+                        3 * ShmemAllocator::default_alignment;
+
+    // one-ring of the vertices for the link condition + per-edge op
+    size_t temp = (v + 2) * sizeof(uint16_t) + 2 * e * sizeof(uint16_t) +
+                  e * sizeof(uint8_t) + 3 * ShmemAllocator::default_alignment;
+
+    return persistent + temp;
+}
+
+/**
+ * @brief Apply a batch of (possibly different) edge operations on the patch
+ * assigned to this block. All operations are processed by a single
+ * CavityManager and so conflicting operations are resolved by one maximal
+ * independent set computation. Every operation uses the same cavity (all the
+ * faces incident to the edge two end vertices) and the cavity is filled in
+ * according to the operation. For operations that keep the edge end vertices
+ * (split, flip, and delete face), the end vertices are re-created as new
+ * vertices and their attributes should be copied by the interpolate function.
+ * Thus, a flip here touches more elements than a flip that only removes the
+ * edge's two faces which makes flips conflict more often but lets any mix of
+ * operations be applied in one pass. This function should be called by all
+ * threads in the block and assumes the mesh has no boundaries around the
+ * edges with an operation (boundary edges are skipped).
+ * @param block the thread block
+ * @param context the RXMesh context
+ * @param shrd_alloc shared memory allocator (see edge_ops_shmem_bytes())
+ * @param edge_op edge_op(EdgeHandle, VertexIterator) returns the EdgeOp to
+ * apply on an owned edge where the iterator is the Op::EVDiamond iterator
+ * @param interpolate interpolate(new_v, v0, v1, t) should set the attributes
+ * of the new vertex new_v to (1 - t) * v0 + t * v1. t is 0 or 1 when the
+ * new vertex is a copy of v0 or v1, and 0.5 for split and collapse
+ * @param on_new_edge on_new_edge(EdgeHandle) is called for every new edge if
+ * the patch update was successful
+ * @param attributes the attributes that should be migrated along with the
+ * mesh elements (e.g., the coordinates and any attribute used by edge_op).
+ * DerivedAttributes passed here are updated around the new elements
+ * @return true if the updates on this patch are written to global memory
+ */
+template <uint32_t blockThreads,
+          typename EdgeOpFuncT,
+          typename InterpolateFuncT,
+          typename NewEdgeFuncT,
+          typename... AttributesT>
+__device__ __inline__ bool apply_edge_ops(
+    cooperative_groups::thread_block& block,
+    Context&                          context,
+    ShmemAllocator&                   shrd_alloc,
+    EdgeOpFuncT                       edge_op,
+    InterpolateFuncT                  interpolate,
+    NewEdgeFuncT                      on_new_edge,
+    AttributesT... attributes)
+{
+    CavityManager<blockThreads, CavityOp::EV> cavity(
+        block, context, shrd_alloc, true);
+
+    const uint32_t pid = cavity.patch_id();
+
+    if (pid == INVALID32) {
+        return false;
+    }
+
+    const PatchInfo& patch_info = cavity.patch_info();
+
+    // indexed by the cavity id and live through the fill-in
+    const uint16_t half_f = DIVIDE_UP(patch_info.num_faces[0], 2);
+
+    Bitmask   new_edges(patch_info.edges_capacity[0], shrd_alloc);
+    uint8_t*  s_cavity_op  = shrd_alloc.alloc<uint8_t>(half_f);
+    uint16_t* s_cavity_opp = shrd_alloc.alloc<uint16_t>(2 * half_f);
+    new_edges.reset(block);
+
+    uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    uint8_t* s_edge_op = shrd_alloc.alloc<uint8_t>(patch_info.num_edges[0]);
+    fill_n<blockThreads>(s_edge_op,
+                         patch_info.num_edges[0],
+                         static_cast<uint8_t>(EdgeOp::None));
+
+    uint16_t* s_vv_offset =
+        shrd_alloc.alloc<uint16_t>(patch_info.num_vertices[0] + 2);
+    uint16_t* s_vv = shrd_alloc.alloc<uint16_t>(2 * patch_info.num_edges[0]);
+
+    Query<blockThreads> query(context, pid);
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    // 1. collect the operations
+    for_each_edge(patch_info, [&](EdgeHandle eh) {
+        const VertexIterator iter =
+            query.template get_iterator<VertexIterator>(eh.local_id());
+
+        // skip boundary edges and degenerate cases
+        if (!iter[1].is_valid() || !iter[3].is_valid() || iter[0] == iter[1] ||
+            iter[0] == iter[2] || iter[0] == iter[3] || iter[1] == iter[2] ||
+            iter[1] == iter[3] || iter[2] == iter[3]) {
+            return;
+        }
+
+        s_edge_op[eh.local_id()] = static_cast<uint8_t>(edge_op(eh, iter));
+    });
+    block.sync();
+
+    // 2. link condition
+    detail::edge_ops_link_condition(
+        block, patch_info, query, s_edge_op, s_vv_offset, s_vv);
+
+    // 3. create the cavities
+    for_each_edge(patch_info, [&](EdgeHandle eh) {
+        const uint8_t op = s_edge_op[eh.local_id()];
+        if (op != static_cast<uint8_t>(EdgeOp::None)) {
+            const uint32_t c = cavity.create(eh);
+            if (c != INVALID32) {
+                const VertexIterator iter =
+                    query.template get_iterator<VertexIterator>(eh.local_id());
+                s_cavity_op[c]          = op;
+                s_cavity_opp[2 * c + 0] = iter.local(1);
+                s_cavity_opp[2 * c + 1] = iter.local(3);
+            }
+        }
+    });
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+
+    if (cavity.prologue(block, shrd_alloc, attributes...)) {
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            const EdgeHandle src = cavity.template get_creator<EdgeHandle>(c);
+
+            VertexHandle v0, v1;
+            cavity.get_vertices(src, v0, v1);
+
+            const EdgeOp op = static_cast<EdgeOp>(s_cavity_op[c]);
+
+            // the cavity boundary is the one-ring of v0 and v1 ordered such
+            // that the edges from a to b were in v0's faces and the edges
+            // from b to a were in v1's faces
+            uint16_t ia = INVALID16, ib = INVALID16;
+            for (uint16_t i = 0; i < size; ++i) {
+                const uint16_t v = cavity.get_cavity_vertex(c, i).local_id();
+                if (v == s_cavity_opp[2 * c + 0]) {
+                    ia = i;
+                }
+                if (v == s_cavity_opp[2 * c + 1]) {
+                    ib = i;
+                }
+            }
+            if (ia == INVALID16 || ib == INVALID16) {
+                cavity.recover(src);
+                return;
+            }
+
+            auto new_edge = [&](const VertexHandle s, const VertexHandle d) {
+                const DEdgeHandle de = cavity.add_edge(s, d);
+                if (de.is_valid()) {
+                    new_edges.set(de.local_id(), true);
+                }
+                return de;
+            };
+
+            // fan new_v over the boundary edges [start, start + count).
+            // first is new_v -> start vertex. If last is valid, it is new_v ->
+            // the end vertex. Return new_v -> end vertex
+            auto fan = [&](const VertexHandle new_v,
+                           const uint16_t     start,
+                           const uint16_t     count,
+                           const DEdgeHandle  first,
+                           const DEdgeHandle  last) {
+                DEdgeHandle e0 = first;
+                for (uint16_t k = 0; k < count; ++k) {
+                    const uint16_t i = (start + k) % size;
+
+                    const DEdgeHandle e1 =
+                        (k == count - 1 && last.is_valid()) ?
+                            last.get_flip_dedge() :
+                            new_edge(
+                                cavity.get_cavity_vertex(c, (i + 1) % size),
+                                new_v);
+                    if (!e1.is_valid()) {
+                        return DEdgeHandle();
+                    }
+                    if (!cavity.add_face(e0, cavity.get_cavity_edge(c, i), e1)
+                             .is_valid()) {
+                        return DEdgeHandle();
+                    }
+                    e0 = e1.get_flip_dedge();
+                }
+                return e0;
+            };
+
+            auto add_vertex = [&](const float t) {
+                const VertexHandle vh = cavity.add_vertex();
+                if (vh.is_valid()) {
+                    interpolate(vh, v0, v1, t);
+                }
+                return vh;
+            };
+
+            if (op == EdgeOp::Collapse || op == EdgeOp::DeleteSrcVertex ||
+                op == EdgeOp::DeleteDstVertex) {
+                const float t = (op == EdgeOp::Collapse)        ? 0.5f :
+                                (op == EdgeOp::DeleteSrcVertex) ? 1.f :
+                                                                  0.f;
+
+                const VertexHandle vn = add_vertex(t);
+                if (!vn.is_valid()) {
+                    return;
+                }
+                const DEdgeHandle s =
+                    new_edge(vn, cavity.get_cavity_vertex(c, 0));
+                if (s.is_valid()) {
+                    fan(vn, 0, size, s, s);
+                }
+                return;
+            }
+
+            // re-create v0 and v1 with their fans
+            const uint16_t cnt0 = (ib + size - ia) % size;
+            const uint16_t cnt1 = size - cnt0;
+
+            const VertexHandle a = cavity.get_cavity_vertex(c, ia);
+            const VertexHandle b = cavity.get_cavity_vertex(c, ib);
+
+            const VertexHandle n0 = add_vertex(0.f);
+            const VertexHandle n1 = add_vertex(1.f);
+            if (!n0.is_valid() || !n1.is_valid()) {
+                return;
+            }
+
+            const DEdgeHandle s0a = new_edge(n0, a);
+            if (!s0a.is_valid()) {
+                return;
+            }
+            const DEdgeHandle s0b = fan(n0, ia, cnt0, s0a, DEdgeHandle());
+            if (!s0b.is_valid()) {
+                return;
+            }
+
+            const DEdgeHandle s1b = new_edge(n1, b);
+            if (!s1b.is_valid()) {
+                return;
+            }
+            const DEdgeHandle s1a = fan(n1, ib, cnt1, s1b, DEdgeHandle());
+            if (!s1a.is_valid()) {
+                return;
+            }
+
+            if (op == EdgeOp::Flip) {
+                // (n0, b, a) and (n1, a, b)
+                const DEdgeHandle ba = new_edge(b, a);
+                if (!ba.is_valid()) {
+                    return;
+                }
+                cavity.add_face(s0b, ba, s0a.get_flip_dedge());
+                cavity.add_face(s1a, ba.get_flip_dedge(), s1b.get_flip_dedge());
+            } else if (op == EdgeOp::Split) {
+                // (n0, m, a), (m, n1, a), (n1, m, b), and (m, n0, b)
+                const VertexHandle m = add_vertex(0.5f);
+                if (!m.is_valid()) {
+                    return;
+                }
+                const DEdgeHandle ma = new_edge(m, a);
+                const DEdgeHandle mb = new_edge(m, b);
+                const DEdgeHandle m0 = new_edge(m, n0);
+                const DEdgeHandle m1 = new_edge(m, n1);
+                if (!ma.is_valid() || !mb.is_valid() || !m0.is_valid() ||
+                    !m1.is_valid()) {
+                    return;
+                }
+                cavity.add_face(m0.get_flip_dedge(), ma, s0a.get_flip_dedge());
+                cavity.add_face(m1, s1a, ma.get_flip_dedge());
+                cavity.add_face(m1.get_flip_dedge(), mb, s1b.get_flip_dedge());
+                cavity.add_face(m0, s0b, mb.get_flip_dedge());
+            } else if (op == EdgeOp::DeleteFace) {
+                // keep (n1, n0, b) and leave (n0, n1, a) as a hole
+                const DEdgeHandle e01 = new_edge(n0, n1);
+                if (!e01.is_valid()) {
+                    return;
+                }
+                cavity.add_face(
+                    e01.get_flip_dedge(), s0b, s1b.get_flip_dedge());
+            }
+        });
+    }
+    block.sync();
+
+    cavity.epilogue(block, attributes...);
+    block.sync();
+
+    if (cavity.is_successful()) {
+        for_each_edge(patch_info, [&](EdgeHandle eh) {
+            if (new_edges(eh.local_id())) {
+                on_new_edge(eh);
+            }
+        });
+        return true;
+    }
+    return false;
+}
+
+}  // namespace rxmesh
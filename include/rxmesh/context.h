@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include "rxmesh/patch_info.h"
 #include "rxmesh/patch_scheduler.cuh"
+#include "rxmesh/query_cache.h"
+#include "rxmesh/util/instrumentation.h"
 #include "rxmesh/util/macros.h"
 
 namespace rxmesh {
@@ -36,7 +38,14 @@ class Context
           m_patches_info(nullptr),
           m_max_lp_capacity_v(0),
           m_max_lp_capacity_e(0),
-          m_max_lp_capacity_f(0)
+          m_max_lp_capacity_f(0),
+          m_patch_offset(0),
+          m_patch_list(nullptr),
+          m_query_cache(nullptr),
+          m_deterministic(false),
+          m_optimistic(false),
+          m_counters(nullptr),
+          m_stage_cycles(nullptr)
     {
     }
 
@@ -69,6 +78,38 @@ class Context
         return m_num_vertices;
     }
 
+    /**
+     * @brief the patch processed by the calling block. Usually, kernels are
+     * launched with one block per patch. In streaming mode, kernels are
+     * launched in waves (see PatchResidency) where the grid only covers the
+     * patches of the current wave starting at m_patch_offset. Kernels
+     * launched over a Frontier (see RXMeshStatic::run_query_kernel_frontier)
+     * only cover the patches in m_patch_list
+     */
+    __device__ __forceinline__ uint32_t get_block_patch_id() const
+    {
+        if (m_patch_list != nullptr) {
+            return m_patch_list[blockIdx.x];
+        }
+        return m_patch_offset + blockIdx.x;
+    }
+
+    /**
+     * @brief the cached output of the query op in global memory (see
+     * RXMeshStatic::cache_query) or nullptr if this query is not cached
+     */
+    __device__ __forceinline__ const detail::QueryCacheEntry* get_query_cache(
+        const Op   op,
+        const bool oriented) const
+    {
+        if (m_query_cache == nullptr) {
+            return nullptr;
+        }
+        const detail::QueryCacheEntry* entry =
+            m_query_cache + detail::query_cache_slot(op, oriented);
+        return entry->is_valid() ? entry : nullptr;
+    }
+
     /**
      * @brief Unpack an edge to its edge ID and direction
      * @param edge_dir The input packed edge as stored in PatchInfo and
@@ -293,6 +334,20 @@ class Context
         m_patches_info = d_patches;
 
         m_patch_scheduler = scheduler;
+
+        m_patch_offset = 0;
+
+        m_patch_list = nullptr;
+
+        m_query_cache = nullptr;
+
+        m_deterministic = false;
+
+        m_optimistic = false;
+
+        m_counters = Instrumentation::get().get_counters();
+
+        m_stage_cycles = Instrumentation::get().get_stage_cycles();
     }
 
     void release()
@@ -311,5 +366,25 @@ class Context
     float      m_capacity_factor;
     uint32_t   m_max_num_patches;
     PatchScheduler m_patch_scheduler;
+    // the first patch of the current wave in streaming mode
+    uint32_t m_patch_offset;
+    // if not nullptr, the device list of patches covered by the grid where
+    // block b processes m_patch_list[b] (see Frontier)
+    const uint32_t* m_patch_list;
+    // device array of detail::num_query_cache_slots entries (see
+    // RXMeshStatic::cache_query)
+    const detail::QueryCacheEntry* m_query_cache;
+    // if dynamic updates should produce the same result on every run (see
+    // RXMeshDynamic::set_deterministic)
+    bool m_deterministic;
+    // if dynamic updates read neighbor patches without locking them and
+    // validate their versions on commit (see RXMeshDynamic::set_optimistic)
+    bool m_optimistic;
+    // device counters of the instrumentation or nullptr if it is disabled
+    // (see Instrumentation)
+    uint32_t* m_counters;
+    // clock cycles of the CavityManager stages or nullptr if the
+    // instrumentation is disabled (see Stage)
+    unsigned long long* m_stage_cycles;
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+namespace detail {
+template <typename LambdaT>
+__global__ static void single_thread_kernel(LambdaT apply)
+{
+    apply();
+}
+}  // namespace detail
+
+/**
+ * @brief run a lambda function on a single device thread. This is useful to
+ * update scalars that live on the device (e.g., CG's alpha and beta) inside a
+ * captured graph without a host round trip
+ * @param stream the stream used to launch the kernel
+ * @param apply device lambda function that takes no parameters
+ */
+template <typename LambdaT>
+inline void launch_scalar(cudaStream_t stream, LambdaT apply)
+{
+    detail::single_thread_kernel<<<1, 1, 0, stream>>>(apply);
+}
+
+/**
+ * @brief A sequence of kernels recorded (captured) once into a CUDA graph and
+ * replayed many times with a single launch each. Iterative loops (solvers,
+ * remeshing) that launch many small kernels per iteration are dominated by
+ * the launch overhead on mid-sized meshes and so capturing one iteration and
+ * replaying it removes most of this overhead.
+ *
+ * Only asynchronous work on the capture stream can be captured i.e., kernels
+ * (for_each, run_query_kernel, ReduceHandle::*_on_device, launch_scalar) and
+ * async memcpy/memset between device buffers. Anything that synchronizes
+ * with the host (e.g., ReduceHandle::dot that returns the output on the host,
+ * Attribute::move, or cudaDeviceSynchronize) is not allowed during the
+ * capture. Convergence checks should be done on the device by writing a flag
+ * that is checked with launch_while()
+ */
+class CUDAGraph
+{
+   public:
+    CUDAGraph()
+        : m_graph(NULL),
+          m_exec(NULL),
+          m_capture_stream(NULL),
+          m_h_flag(nullptr),
+          m_num_nodes(0)
+    {
+    }
+
+    CUDAGraph(const CUDAGraph&)            = delete;
+    CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+    ~CUDAGraph()
+    {
+        release();
+        if (m_capture_stream != NULL) {
+            CUDA_ERROR(cudaStreamDestroy(m_capture_stream));
+        }
+        if (m_h_flag != nullptr) {
+            CUDA_ERROR(cudaFreeHost(m_h_flag));
+        }
+    }
+
+    /**
+     * @brief record the work submitted by fn(stream) into the graph. If a
+     * graph was captured before, the executable graph is updated in place if
+     * the new graph has the same topology (e.g., only kernel parameters
+     * changed) which is cheaper than instantiating a new one
+     * @param fn fn(stream) submits the work to be captured on stream
+     * @param stream the stream to capture on. Capturing on the default (NULL)
+     * stream is not allowed by CUDA and so an internal stream is used instead
+     */
+    template <typename FuncT>
+    void capture(FuncT fn, cudaStream_t stream = NULL)
+    {
+        if (stream == NULL) {
+            if (m_capture_stream == NULL) {
+                CUDA_ERROR(cudaStreamCreateWithFlags(&m_capture_stream,
+                                                     cudaStreamNonBlocking));
+            }
+            stream = m_capture_stream;
+        }
+
+        CUDA_ERROR(
+            cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+        fn(stream);
+        cudaGraph_t graph = NULL;
+        CUDA_ERROR(cudaStreamEndCapture(stream, &graph));
+
+        if (m_exec != NULL) {
+#if CUDART_VERSION >= 12000
+            cudaGraphExecUpdateResultInfo info;
+            if (cudaGraphExecUpdate(m_exec, graph, &info) == cudaSuccess) {
+#else
+            cudaGraphNode_t           error_node;
+            cudaGraphExecUpdateResult result;
+            if (cudaGraphExecUpdate(m_exec, graph, &error_node, &result) ==
+                cudaSuccess) {
+#endif
+                CUDA_ERROR(cudaGraphDestroy(m_graph));
+                m_graph = graph;
+                CUDA_ERROR(cudaGraphGetNodes(m_graph, nullptr, &m_num_nodes));
+                return;
+            }
+            // clear the error of the failed update and instantiate a new
+            // executable graph
+            cudaGetLastError();
+            release();
+        }
+
+        m_graph = graph;
+        CUDA_ERROR(cudaGraphInstantiateWithFlags(&m_exec, m_graph, 0));
+        CUDA_ERROR(cudaGraphGetNodes(m_graph, nullptr, &m_num_nodes));
+
+        RXMESH_TRACE("CUDAGraph::capture() captured {} nodes", m_num_nodes);
+    }
+
+    /**
+     * @brief replay the graph once
+     */
+    void launch(cudaStream_t stream = NULL) const
+    {
+        if (m_exec == NULL) {
+            RXMESH_ERROR("CUDAGraph::launch() the graph is not captured");
+            return;
+        }
+        CUDA_ERROR(cudaGraphLaunch(m_exec, stream));
+    }
+
+    /**
+     * @brief replay the graph as long as a device flag is not zero. The flag
+     * is read (with a single async copy to pinned memory) only every
+     * check_interval replays so the host does not wait on the device after
+     * every replay. Thus, the graph may be replayed up to check_interval - 1
+     * times after the flag is cleared and the captured work should be a no-op
+     * (or harmless) in this case. For example, the flag could be the count of
+     * the patch scheduler (see RXMeshDynamic::launch_until_queue_empty) or a
+     * flag written by a convergence check kernel
+     * @param d_flag device pointer of the flag
+     * @param max_replays maximum number of replays
+     * @param check_interval number of replays between two checks of the flag
+     * @param stream stream used to launch the graph
+     * @return the number of replays
+     */
+    uint32_t launch_while(const int*     d_flag,
+                          const uint32_t max_replays,
+                          const uint32_t check_interval = 1,
+                          cudaStream_t   stream         = NULL)
+    {
+        return launch_while([d_flag](cudaStream_t) { return d_flag; },
+                            max_replays,
+                            check_interval,
+                            stream);
+    }
+
+    /**
+     * @brief same as above but the flag is produced by flag(stream) before
+     * every check e.g., by launching a kernel that reduces different counters
+     * into one flag
+     * @param flag flag(stream) enqueues the work to compute the flag on the
+     * stream and returns the device pointer of the flag
+     * @param max_replays maximum number of replays
+     * @param check_interval number of replays between two checks of the flag
+     * @param stream stream used to launch the graph
+     * @return the number of replays
+     */
+    uint32_t launch_while(std::function<const int*(cudaStream_t)> flag,
+                          const uint32_t                          max_replays,
+                          const uint32_t check_interval = 1,
+                          cudaStream_t   stream         = NULL)
+    {
+        if (m_h_flag == nullptr) {
+            CUDA_ERROR(cudaMallocHost((void**)&m_h_flag, sizeof(int)));
+        }
+
+        const uint32_t interval = std::max(check_interval, 1u);
+
+        uint32_t num_replays = 0;
+        while (num_replays < max_replays) {
+            const int* d_flag = flag(stream);
+            CUDA_ERROR(cudaMemcpyAsync(m_h_flag,
+                                       d_flag,
+                                       sizeof(int),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+            if (m_h_flag[0] == 0) {
+                break;
+            }
+            for (uint32_t i = 0; i < interval && num_replays < max_replays;
+                 ++i) {
+                launch(stream);
+                ++num_replays;
+            }
+        }
+        return num_replays;
+    }
+
+    /**
+     * @brief check if a graph is captured and can be launched
+     */
+    bool is_captured() const
+    {
+        return m_exec != NULL;
+    }
+
+    /**
+     * @brief number of nodes (kernels, memcpy, etc) in the captured graph
+     */
+    size_t get_num_nodes() const
+    {
+        return m_num_nodes;
+    }
+
+    /**
+     * @brief release the captured graph
+     */
+    void release()
+    {
+        if (m_exec != NULL) {
+            CUDA_ERROR(cudaGraphExecDestroy(m_exec));
+            m_exec = NULL;
+        }
+        if (m_graph != NULL) {
+            CUDA_ERROR(cudaGraphDestroy(m_graph));
+            m_graph = NULL;
+        }
+        m_num_nodes = 0;
+    }
+
+   private:
+    cudaGraph_t     m_graph;
+    cudaGraphExec_t m_exec;
+    cudaStream_t    m_capture_stream;
+    int*            m_h_flag;
+    size_t          m_num_nodes;
+};
+}  // namespace rxmesh
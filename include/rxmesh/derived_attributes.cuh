@@ -0,0 +1,275 @@
+#pragma once
+
+#include <string>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+namespace detail {
+template <typename T, uint32_t blockThreads>
+__global__ static void derived_edge_length(const Context            context,
+                                           const VertexAttribute<T> coords,
+                                           EdgeAttribute<T>         length)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(
+        block,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            const vec3<T> p0(
+                coords(iter[0], 0), coords(iter[0], 1), coords(iter[0], 2));
+            const vec3<T> p1(
+                coords(iter[1], 0), coords(iter[1], 1), coords(iter[1], 2));
+            length(eh) = glm::length(p1 - p0);
+        });
+}
+
+template <typename T, uint32_t blockThreads>
+__global__ static void derived_face(const Context            context,
+                                    const VertexAttribute<T> coords,
+                                    FaceAttribute<T>         normal,
+                                    FaceAttribute<T>         area,
+                                    const derivedT           flags)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            vec3<T> p[3];
+            for (int i = 0; i < 3; ++i) {
+                p[i] = vec3<T>(coords(iter[i], 0),
+                               coords(iter[i], 1),
+                               coords(iter[i], 2));
+            }
+            if (flags & DERIVED_FACE_NORMAL) {
+                const vec3<T> n = tri_normal(p[0], p[1], p[2]);
+                for (int i = 0; i < 3; ++i) {
+                    normal(fh, i) = n[i];
+                }
+            }
+            if (flags & DERIVED_FACE_AREA) {
+                area(fh) = tri_area(p[0], p[1], p[2]);
+            }
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void derived_vertex(const Context            context,
+                                      VertexAttribute<uint8_t> valence,
+                                      VertexAttribute<uint8_t> boundary,
+                                      const derivedT           flags)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+
+    // a manifold vertex is on the boundary iff it has more edges than faces
+    query.dispatch<Op::VE>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const EdgeIterator& iter) {
+            if (flags & DERIVED_VERTEX_VALENCE) {
+                valence(vh) = static_cast<uint8_t>(iter.size());
+            }
+            if (flags & DERIVED_VERTEX_BOUNDARY) {
+                boundary(vh) = static_cast<uint8_t>(iter.size());
+            }
+        });
+    block.sync();
+
+    if (flags & DERIVED_VERTEX_BOUNDARY) {
+        query.dispatch<Op::VF>(
+            block,
+            shrd_alloc,
+            [&](const VertexHandle& vh, const FaceIterator& iter) {
+                boundary(vh) = (boundary(vh) != iter.size());
+            });
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief a registry of quantities derived from the geometry and connectivity
+ * (edge length, face normal and area, vertex valence and boundary flag). The
+ * registry computes all of them once (compute()) and then, when passed to
+ * CavityManager::prologue() and CavityManager::epilogue(), only the elements
+ * created by the cavities are recomputed while the vertex valence and
+ * boundary flag are updated by the edges and faces the cavities remove and
+ * add (including on the vertices owned by other patches). The vertex
+ * boundary flag is kept as the number of edges minus the number of faces
+ * which is 0 or 1 for manifold meshes. The registry should also be passed to
+ * RXMeshDynamic::slice_patches() along with the other attributes. Thus,
+ * remeshing iterations do not need to recompute these quantities over the
+ * whole mesh. compute() should be called again when the vertices move (e.g.,
+ * after smoothing).
+ *
+ * Like attributes, DerivedAttributes is passed by value to kernels and its
+ * memory is freed with release()
+ *
+ * Example
+ * \code{.cpp}
+ * DerivedAttributes<float> derived(rx, *coords, DERIVED_VERTEX_VALENCE);
+ * // in the kernel
+ * if (cavity.prologue(block, shrd_alloc, coords, derived)) {...}
+ * cavity.epilogue(block, derived);
+ * \endcode
+ */
+template <typename T>
+struct DerivedAttributes
+{
+    static constexpr uint32_t blockThreads = 256;
+
+    DerivedAttributes() : m_flags(DERIVED_NONE)
+    {
+    }
+
+    /**
+     * @brief create the attributes for the quantities in flags and compute
+     * them
+     * @param rx the mesh
+     * @param vertex_coords the vertex coordinates from which the geometric
+     * quantities are derived
+     * @param flags which quantities to maintain (see derivedT)
+     */
+    DerivedAttributes(RXMeshStatic&             rx,
+                      const VertexAttribute<T>& vertex_coords,
+                      const derivedT            flags  = DERIVED_ALL,
+                      cudaStream_t              stream = NULL)
+        : coords(vertex_coords), m_flags(flags)
+    {
+        const std::string prefix =
+            "rx:derived" + std::to_string(next_id()) + "_";
+
+        if (has(DERIVED_EDGE_LENGTH)) {
+            edge_length = *rx.add_edge_attribute<T>(prefix + "edge_length", 1);
+        }
+        if (has(DERIVED_FACE_NORMAL)) {
+            face_normal = *rx.add_face_attribute<T>(prefix + "face_normal", 3);
+        }
+        if (has(DERIVED_FACE_AREA)) {
+            face_area = *rx.add_face_attribute<T>(prefix + "face_area", 1);
+        }
+        if (has(DERIVED_VERTEX_VALENCE)) {
+            valence = *rx.add_vertex_attribute<uint8_t>(prefix + "valence", 1);
+        }
+        if (has(DERIVED_VERTEX_BOUNDARY)) {
+            boundary =
+                *rx.add_vertex_attribute<uint8_t>(prefix + "boundary", 1);
+        }
+
+        compute(rx, stream);
+    }
+
+    /**
+     * @brief return true if the quantity f is maintained by this registry
+     */
+    __host__ __device__ __inline__ bool has(const derivedT f) const
+    {
+        return (m_flags & f) == f;
+    }
+
+    /**
+     * @brief the quantities maintained by this registry (see derivedT)
+     */
+    __host__ __device__ __inline__ derivedT get_flags() const
+    {
+        return m_flags;
+    }
+
+    /**
+     * @brief recompute all quantities over the whole mesh (on the device)
+     */
+    void compute(RXMeshStatic& rx, cudaStream_t stream = NULL)
+    {
+        if (has(DERIVED_EDGE_LENGTH)) {
+            LaunchBox<blockThreads> lb;
+            rx.prepare_launch_box(
+                {Op::EV},
+                lb,
+                (void*)detail::derived_edge_length<T, blockThreads>);
+            rx.run_query_kernel(lb,
+                                detail::derived_edge_length<T, blockThreads>,
+                                stream,
+                                coords,
+                                edge_length);
+        }
+
+        if (m_flags & (DERIVED_FACE_NORMAL | DERIVED_FACE_AREA)) {
+            LaunchBox<blockThreads> lb;
+            rx.prepare_launch_box(
+                {Op::FV}, lb, (void*)detail::derived_face<T, blockThreads>);
+            rx.run_query_kernel(lb,
+                                detail::derived_face<T, blockThreads>,
+                                stream,
+                                coords,
+                                face_normal,
+                                face_area,
+                                m_flags);
+        }
+
+        if (m_flags & (DERIVED_VERTEX_VALENCE | DERIVED_VERTEX_BOUNDARY)) {
+            LaunchBox<blockThreads> lb;
+            rx.prepare_launch_box({Op::VE, Op::VF},
+                                  lb,
+                                  (void*)detail::derived_vertex<blockThreads>);
+            rx.run_query_kernel(lb,
+                                detail::derived_vertex<blockThreads>,
+                                stream,
+                                valence,
+                                boundary,
+                                m_flags);
+        }
+    }
+
+    /**
+     * @brief remove the attributes of this registry from rx
+     */
+    void release(RXMeshStatic& rx)
+    {
+        if (has(DERIVED_EDGE_LENGTH)) {
+            rx.remove_attribute(edge_length.get_name());
+        }
+        if (has(DERIVED_FACE_NORMAL)) {
+            rx.remove_attribute(face_normal.get_name());
+        }
+        if (has(DERIVED_FACE_AREA)) {
+            rx.remove_attribute(face_area.get_name());
+        }
+        if (has(DERIVED_VERTEX_VALENCE)) {
+            rx.remove_attribute(valence.get_name());
+        }
+        if (has(DERIVED_VERTEX_BOUNDARY)) {
+            rx.remove_attribute(boundary.get_name());
+        }
+        m_flags = DERIVED_NONE;
+    }
+
+    VertexAttribute<T>       coords;
+    EdgeAttribute<T>         edge_length;
+    FaceAttribute<T>         face_normal;
+    FaceAttribute<T>         face_area;
+    VertexAttribute<uint8_t> valence;
+    VertexAttribute<uint8_t> boundary;
+
+   private:
+    static uint32_t next_id()
+    {
+        static uint32_t id = 0;
+        return id++;
+    }
+
+    derivedT m_flags;
+};
+}  // namespace rxmesh
@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/util/bitmask_util.h"
+
+namespace rxmesh {
+
+/**
+ * @brief iterator over the output of a query whose size is bounded at compile
+ * time by maxSize (see Query::dispatch_bounded). Unlike Iterator, the local
+ * indices of the output are held by the iterator itself (i.e., in registers)
+ * instead of being read from the output of the query in shared memory through
+ * an offset array
+ */
+template <typename HandleT, uint32_t maxSize>
+struct FixedIterator
+{
+    using LocalT = typename HandleT::LocalT;
+
+    static_assert(maxSize > 0 && maxSize < 256,
+                  "FixedIterator size should be in [1, 255]");
+
+    static constexpr uint32_t max_size = maxSize;
+
+    __device__ FixedIterator(const Context&  context,
+                             const uint32_t  patch_id,
+                             const uint32_t* output_owned_bitmask,
+                             const LPPair*   s_table)
+        : m_context(context),
+          m_patch_id(patch_id),
+          m_output_owned_bitmask(output_owned_bitmask),
+          m_s_table(s_table),
+          m_size(0),
+          m_current(0)
+    {
+    }
+
+    FixedIterator(const FixedIterator& orig) = default;
+
+    __device__ uint16_t size() const
+    {
+        return m_size;
+    }
+
+    __device__ HandleT operator[](const uint16_t i) const
+    {
+        if (i >= m_size) {
+            return HandleT();
+        }
+        HandleT ret(m_patch_id, m_local[i]);
+
+        if (detail::is_owned(m_local[i], m_output_owned_bitmask)) {
+            return ret;
+        } else {
+            return m_context.get_owner_handle(ret, nullptr, m_s_table);
+        }
+    }
+
+    __device__ uint16_t local(const uint16_t i) const
+    {
+        if (i >= m_size) {
+            return INVALID16;
+        }
+        return m_local[i];
+    }
+
+    __device__ HandleT operator*() const
+    {
+        return ((*this)[m_current]);
+    }
+
+    __device__ HandleT back() const
+    {
+        return ((*this)[size() - 1]);
+    }
+
+    __device__ HandleT front() const
+    {
+        return ((*this)[0]);
+    }
+
+    __device__ FixedIterator& operator++()
+    {
+        // pre
+        m_current = (m_current + 1) % size();
+        return *this;
+    }
+    __device__ FixedIterator operator++(int)
+    {
+        // post
+        FixedIterator pre(*this);
+        m_current = (m_current + 1) % size();
+        return pre;
+    }
+
+    __device__ FixedIterator& operator--()
+    {
+        // pre
+        m_current = (m_current == 0) ? size() - 1 : m_current - 1;
+        return *this;
+    }
+
+    __device__ FixedIterator operator--(int)
+    {
+        // post
+        FixedIterator pre(*this);
+        m_current = (m_current == 0) ? size() - 1 : m_current - 1;
+        return pre;
+    }
+
+    /**
+     * @brief append the local index of an output element. Used by the query
+     * that fills the iterator
+     */
+    __device__ void push_back(const uint16_t local_id)
+    {
+        assert(m_size < maxSize);
+        if (m_size < maxSize) {
+            m_local[m_size++] = local_id;
+        }
+    }
+
+   private:
+    const Context&  m_context;
+    const uint32_t  m_patch_id;
+    const uint32_t* m_output_owned_bitmask;
+    const LPPair*   m_s_table;
+    uint16_t        m_local[maxSize];
+    uint16_t        m_size;
+    uint16_t        m_current;
+};
+
+template <uint32_t maxSize>
+using FixedVertexIterator = FixedIterator<VertexHandle, maxSize>;
+template <uint32_t maxSize>
+using FixedEdgeIterator = FixedIterator<EdgeHandle, maxSize>;
+
+}  // namespace rxmesh
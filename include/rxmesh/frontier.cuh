@@ -0,0 +1,279 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+
+#include <cuda_runtime.h>
+
+#include "rxmesh/handle.h"
+#include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the set of active mesh elements (vertices, edges, or faces) of
+ * sparse iterative workloads (e.g., front propagation) along with the list of
+ * patches that contain at least one active element. Kernels launched over the
+ * frontier (see RXMeshStatic::for_each_frontier and
+ * RXMeshStatic::run_query_kernel_frontier) use a grid with one block per
+ * active patch and so their cost scales with the size of the frontier rather
+ * than the size of the mesh.
+ *
+ * The frontier is double-buffered: kernels read the current frontier (see
+ * is_active) and add elements to the next one (see add) which becomes the
+ * current frontier after calling advance() on the host. Every patch is
+ * (atomically) appended once to the list of the next frontier by the first
+ * element added to it. The device memory is owned by whoever created the
+ * frontier (see RXMeshStatic::create_frontier) and is freed by free(). The
+ * frontier is passed by value to kernels and lambdas since its device
+ * pointers never change i.e., a copy taken before advance() is still valid
+ * after it
+ */
+template <typename HandleT>
+struct Frontier
+{
+    __device__ __host__ Frontier()
+        : m_d_mask(nullptr),
+          m_d_next_mask(nullptr),
+          m_d_list(nullptr),
+          m_d_next_list(nullptr),
+          m_d_next_is_listed(nullptr),
+          m_d_next_size(nullptr),
+          m_mask_stride(0),
+          m_capacity(0),
+          m_size(0)
+    {
+    }
+    __device__ __host__ Frontier(const Frontier& other) = default;
+    __device__ __host__ Frontier(Frontier&&)            = default;
+    __device__ __host__ Frontier& operator=(const Frontier&) = default;
+    __device__ __host__ Frontier& operator=(Frontier&&) = default;
+    __device__                    __host__ ~Frontier()  = default;
+
+    /**
+     * @brief allocate the (empty) frontier
+     * @param num_patches the max number of patches
+     * @param max_elements_per_patch the max number of elements (vertices,
+     * edges, or faces) in a patch
+     */
+    __host__ void init(const uint32_t num_patches,
+                       const uint32_t max_elements_per_patch)
+    {
+        m_capacity    = num_patches;
+        m_mask_stride = DIVIDE_UP(max_elements_per_patch, 32);
+        m_size        = 0;
+
+        const size_t mask_bytes =
+            size_t(m_capacity) * m_mask_stride * sizeof(uint32_t);
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_mask, mask_bytes));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_next_mask, mask_bytes));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_list, m_capacity * sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_next_list, m_capacity * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_next_is_listed,
+                              m_capacity * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_next_size, sizeof(uint32_t)));
+
+        CUDA_ERROR(cudaMemset(m_d_mask, 0, mask_bytes));
+        CUDA_ERROR(cudaMemset(m_d_next_mask, 0, mask_bytes));
+        CUDA_ERROR(
+            cudaMemset(m_d_next_is_listed, 0, m_capacity * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemset(m_d_next_size, 0, sizeof(uint32_t)));
+    }
+
+    /**
+     * @brief free all the memories
+     */
+    __host__ void free()
+    {
+        GPU_FREE(m_d_mask);
+        GPU_FREE(m_d_next_mask);
+        GPU_FREE(m_d_list);
+        GPU_FREE(m_d_next_list);
+        GPU_FREE(m_d_next_is_listed);
+        GPU_FREE(m_d_next_size);
+        m_size = 0;
+    }
+
+    /**
+     * @brief check if the element is in the current frontier
+     */
+    __device__ __inline__ bool is_active(const HandleT& h) const
+    {
+        assert(h.patch_id() < m_capacity);
+        return detail::is_set_bit(
+            h.local_id(), m_d_mask + size_t(h.patch_id()) * m_mask_stride);
+    }
+
+    /**
+     * @brief add the element to the next frontier. Adding the same element
+     * more than once is allowed
+     */
+    __device__ __inline__ void add(const HandleT& h) const
+    {
+#ifdef __CUDA_ARCH__
+        const uint32_t p = h.patch_id();
+        assert(p < m_capacity);
+        detail::bitmask_set_bit(
+            h.local_id(), m_d_next_mask + size_t(p) * m_mask_stride, true);
+
+        // cheap check before going atomic
+        if (*((volatile uint32_t*)(m_d_next_is_listed + p)) == 0 &&
+            ::atomicCAS(m_d_next_is_listed + p, 0u, 1u) == 0) {
+            const uint32_t pos = ::atomicAdd(m_d_next_size, 1u);
+            assert(pos < m_capacity);
+            m_d_next_list[pos] = p;
+        }
+#endif
+    }
+
+    /**
+     * @brief the i-th patch in the current frontier where i < size()
+     */
+    __device__ __inline__ uint32_t get_patch(const uint32_t i) const
+    {
+        return m_d_list[i];
+    }
+
+    /**
+     * @brief the device list of the patches in the current frontier
+     */
+    __device__ __host__ __inline__ const uint32_t* get_patch_list() const
+    {
+        return m_d_list;
+    }
+
+    /**
+     * @brief number of patches in the current frontier (as of the last call
+     * to advance() on the host copy of the frontier)
+     */
+    __host__ __inline__ uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief check if the current frontier has no patches
+     */
+    __host__ __inline__ bool is_empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief make the next frontier the current one and clear the next
+     * frontier. This reads the size of the next frontier from the device and
+     * thus synchronizes the stream. The cost is proportional to the number of
+     * patches in the current and next frontiers
+     */
+    __host__ void advance(cudaStream_t stream = NULL);
+
+    /**
+     * @brief remove all elements from the current and next frontiers
+     */
+    __host__ void clear(cudaStream_t stream = NULL)
+    {
+        // the first advance drops the current frontier and the second drops
+        // the next one
+        advance(stream);
+        advance(stream);
+    }
+
+    // the current/next frontier bitmask of patch p starts at p * m_mask_stride
+    uint32_t* m_d_mask;
+    uint32_t* m_d_next_mask;
+    uint32_t* m_d_list;
+    uint32_t* m_d_next_list;
+    // 1 if the patch is already in m_d_next_list
+    uint32_t* m_d_next_is_listed;
+    uint32_t* m_d_next_size;
+    uint32_t  m_mask_stride;
+    uint32_t  m_capacity;
+    // host-side size of the current frontier
+    uint32_t m_size;
+};
+
+namespace detail {
+
+/**
+ * @brief clear the bitmask of every patch in the current frontier
+ */
+__global__ static void frontier_clear_current(const uint32_t  num_patches,
+                                              const uint32_t* list,
+                                              const uint32_t  mask_stride,
+                                              uint32_t*       mask)
+{
+    if (blockIdx.x < num_patches) {
+        uint32_t* m = mask + size_t(list[blockIdx.x]) * mask_stride;
+        for (uint32_t i = threadIdx.x; i < mask_stride; i += blockDim.x) {
+            m[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief move every patch of the next frontier (its bitmask and its entry in
+ * the patch list) to the current frontier and reset it in the next frontier
+ */
+__global__ static void frontier_move_next(const uint32_t  num_patches,
+                                          const uint32_t* next_list,
+                                          const uint32_t  mask_stride,
+                                          uint32_t*       next_mask,
+                                          uint32_t*       next_is_listed,
+                                          uint32_t*       list,
+                                          uint32_t*       mask)
+{
+    if (blockIdx.x < num_patches) {
+        const uint32_t p  = next_list[blockIdx.x];
+        uint32_t*      nm = next_mask + size_t(p) * mask_stride;
+        uint32_t*      m  = mask + size_t(p) * mask_stride;
+        for (uint32_t i = threadIdx.x; i < mask_stride; i += blockDim.x) {
+            m[i]  = nm[i];
+            nm[i] = 0;
+        }
+        if (threadIdx.x == 0) {
+            list[blockIdx.x]  = p;
+            next_is_listed[p] = 0;
+        }
+    }
+}
+}  // namespace detail
+
+template <typename HandleT>
+__host__ void Frontier<HandleT>::advance(cudaStream_t stream)
+{
+    uint32_t next_size = 0;
+    CUDA_ERROR(cudaMemcpyAsync(&next_size,
+                               m_d_next_size,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+
+    const uint32_t threads = std::min(256u, std::max(32u, m_mask_stride));
+
+    if (m_size > 0) {
+        detail::frontier_clear_current<<<m_size, threads, 0, stream>>>(
+            m_size, m_d_list, m_mask_stride, m_d_mask);
+    }
+
+    if (next_size > 0) {
+        detail::frontier_move_next<<<next_size, threads, 0, stream>>>(
+            next_size,
+            m_d_next_list,
+            m_mask_stride,
+            m_d_next_mask,
+            m_d_next_is_listed,
+            m_d_list,
+            m_d_mask);
+    }
+
+    CUDA_ERROR(cudaMemsetAsync(m_d_next_size, 0, sizeof(uint32_t), stream));
+
+    m_size = next_size;
+}
+}  // namespace rxmesh
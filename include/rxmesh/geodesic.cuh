@@ -0,0 +1,967 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/sparse_matrix.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the method used by GeodesicSolver
+ * Heat: the heat method (Crane et al. "Geodesics in Heat", 2013). Two sparse
+ * linear systems are factorized once and every source only costs two
+ * triangular solves and two face kernels. Multiple sources are solved together
+ * as columns of the same right-hand side
+ * NarrowBand: every block relaxes the distances of its patch in shared memory
+ * until they converge and only then writes the owned vertices back and
+ * activates the neighbor patches. Only patches reached by the front (or whose
+ * boundary values changed) are processed in every round
+ */
+enum class GeodesicMethod
+{
+    Heat       = 0,
+    NarrowBand = 1,
+};
+
+namespace detail {
+
+/**
+ * @brief cotangent of the angle at a in the triangle a, b, c
+ */
+template <typename T>
+__device__ __inline__ T geodesic_corner_cot(const vec3<T>& a,
+                                            const vec3<T>& b,
+                                            const vec3<T>& c)
+{
+    const vec3<T> u = b - a;
+    const vec3<T> v = c - a;
+    const T       s = glm::length(glm::cross(u, v));
+    T cot = (s > std::numeric_limits<T>::min()) ? glm::dot(u, v) / s : T(0);
+    clamp_cot(cot);
+    return cot;
+}
+
+/**
+ * @brief the distance at p computed from the triangle p, q, r given the
+ * distances at q and r (tq and tr). It is the planar unfolding update used by
+ * the parallel toggle propagation (Romero Calla et al. 2019) that falls back
+ * to the edges when the front does not come through the triangle
+ */
+template <typename T>
+__device__ __inline__ T geodesic_update_step(const vec3<T>& p,
+                                             const vec3<T>& q,
+                                             const vec3<T>& r,
+                                             const T        tq,
+                                             const T        tr,
+                                             const T        infinity_val)
+{
+    const vec3<T> x0 = q - p;
+    const vec3<T> x1 = r - p;
+
+    const T dp0 = tq + glm::length(x0);
+    const T dp1 = tr + glm::length(x1);
+    const T edge_dist = (dp1 < dp0) ? dp1 : dp0;
+
+    if (tq == infinity_val || tr == infinity_val) {
+        return edge_dist;
+    }
+
+    T q00 = glm::dot(x0, x0);
+    T q01 = glm::dot(x0, x1);
+    T q11 = glm::dot(x1, x1);
+
+    T det = q00 * q11 - q01 * q01;
+    if (det <= std::numeric_limits<T>::min()) {
+        return edge_dist;
+    }
+
+    T Q00 = q11 / det;
+    T Q01 = -q01 / det;
+    T Q11 = q00 / det;
+
+    T sum_q = Q00 + 2 * Q01 + Q11;
+    T delta = tq * (Q00 + Q01) + tr * (Q01 + Q11);
+    T dis   = delta * delta -
+            sum_q * (tq * tq * Q00 + 2 * tq * tr * Q01 + tr * tr * Q11 - 1);
+    if (dis < 0) {
+        return edge_dist;
+    }
+
+    T d = (delta + std::sqrt(dis)) / sum_q;
+
+    // the solution is valid only if the front comes from inside the triangle
+    const T       tp0 = tq - d;
+    const T       tp1 = tr - d;
+    const vec3<T> n =
+        (x0 * Q00 + x1 * Q01) * tp0 + (x0 * Q01 + x1 * Q11) * tp1;
+
+    const T cond0 = glm::dot(x0, n);
+    const T cond1 = glm::dot(x1, n);
+    const T c0    = cond0 * Q00 + cond1 * Q01;
+    const T c1    = cond0 * Q01 + cond1 * Q11;
+
+    if (c0 >= 0 || c1 >= 0) {
+        return edge_dist;
+    }
+    return (d < edge_dist) ? d : edge_dist;
+}
+
+template <typename T, uint32_t blockThreads>
+__global__ static void geodesic_edge_length(const Context            context,
+                                            const VertexAttribute<T> coords,
+                                            T*                       d_sum)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            T sum = 0;
+            for (int i = 0; i < 3; ++i) {
+                const VertexHandle a = iter[i];
+                const VertexHandle b = iter[(i + 1) % 3];
+                const vec3<T> pa(coords(a, 0), coords(a, 1), coords(a, 2));
+                const vec3<T> pb(coords(b, 0), coords(b, 1), coords(b, 2));
+                sum += glm::length(pb - pa);
+            }
+            ::atomicAdd(d_sum, sum);
+        });
+}
+
+/**
+ * @brief assemble heat = M + t * L and poisson = L + s * M where L is the
+ * (positive semi-definite) cotan Laplacian and M is the lumped mass matrix
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void geodesic_heat_setup(const Context            context,
+                                           const VertexAttribute<T> coords,
+                                           SparseMatrix<T>          heat,
+                                           SparseMatrix<T>          poisson,
+                                           const T                  t,
+                                           const T                  s)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            VertexHandle v[3];
+            vec3<T>      p[3];
+            for (int i = 0; i < 3; ++i) {
+                v[i] = iter[i];
+                p[i] = vec3<T>(
+                    coords(v[i], 0), coords(v[i], 1), coords(v[i], 2));
+            }
+
+            const T mass = tri_area(p[0], p[1], p[2]) / T(3);
+
+            for (int k = 0; k < 3; ++k) {
+                const int i = (k + 1) % 3;
+                const int j = (k + 2) % 3;
+
+                // the corner k is opposite to the edge i-j
+                const T w =
+                    T(0.5) * geodesic_corner_cot(p[k], p[i], p[j]);
+
+                ::atomicAdd(&heat(v[i], v[j]), -t * w);
+                ::atomicAdd(&heat(v[j], v[i]), -t * w);
+                ::atomicAdd(&heat(v[i], v[i]), t * w);
+                ::atomicAdd(&heat(v[j], v[j]), t * w);
+
+                ::atomicAdd(&poisson(v[i], v[j]), -w);
+                ::atomicAdd(&poisson(v[j], v[i]), -w);
+                ::atomicAdd(&poisson(v[i], v[i]), w);
+                ::atomicAdd(&poisson(v[j], v[j]), w);
+
+                ::atomicAdd(&heat(v[k], v[k]), mass);
+                ::atomicAdd(&poisson(v[k], v[k]), s * mass);
+            }
+        });
+}
+
+/**
+ * @brief set the initial heat of the sources. If single_column, all sources
+ * go to the first column. Otherwise, source s goes to column s
+ */
+template <typename T>
+__global__ static void geodesic_heat_sources(const VertexHandle* d_sources,
+                                             const uint32_t      num_sources,
+                                             const bool          single_column,
+                                             DenseMatrix<T>      rhs)
+{
+    const uint32_t s = blockIdx.x * blockDim.x + threadIdx.x;
+    if (s < num_sources) {
+        rhs(d_sources[s], single_column ? 0 : s) = T(1);
+    }
+}
+
+/**
+ * @brief compute the normalized (negative) gradient of the heat u in every
+ * face and accumulate its divergence (times -1) in every vertex for all
+ * columns
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void geodesic_heat_divergence(
+    const Context            context,
+    const VertexAttribute<T> coords,
+    const DenseMatrix<T>     u,
+    DenseMatrix<T>           rhs)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            VertexHandle v[3];
+            vec3<T>      p[3];
+            for (int i = 0; i < 3; ++i) {
+                v[i] = iter[i];
+                p[i] = vec3<T>(
+                    coords(v[i], 0), coords(v[i], 1), coords(v[i], 2));
+            }
+
+            const vec3<T> normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const T       area2  = glm::length(normal);
+            if (area2 <= std::numeric_limits<T>::min()) {
+                return;
+            }
+            const vec3<T> n = normal / area2;
+
+            // the gradient of the vertex i is n x (the opposite edge)
+            vec3<T> g[3];
+            T       cot[3];
+            for (int i = 0; i < 3; ++i) {
+                g[i]   = glm::cross(n, p[(i + 2) % 3] - p[(i + 1) % 3]) / area2;
+                cot[i] = geodesic_corner_cot(
+                    p[i], p[(i + 1) % 3], p[(i + 2) % 3]);
+            }
+
+            for (uint32_t c = 0; c < u.cols(); ++c) {
+                const vec3<T> grad =
+                    u(v[0], c) * g[0] + u(v[1], c) * g[1] + u(v[2], c) * g[2];
+                const T len = glm::length(grad);
+                if (len <= std::numeric_limits<T>::min()) {
+                    continue;
+                }
+                const vec3<T> x = -grad / len;
+
+                for (int i = 0; i < 3; ++i) {
+                    const int j = (i + 1) % 3;
+                    const int k = (i + 2) % 3;
+
+                    const T div = T(0.5) * (cot[k] * glm::dot(p[j] - p[i], x) +
+                                            cot[j] * glm::dot(p[k] - p[i], x));
+                    ::atomicAdd(&rhs(v[i], c), -div);
+                }
+            }
+        });
+}
+
+/**
+ * @brief shift the solution of the Poisson equation so the sources are at
+ * zero distance and write it to the columns of out starting at col_offset
+ */
+template <typename T>
+__global__ static void geodesic_heat_shift(const VertexHandle*  d_sources,
+                                           const uint32_t       num_sources,
+                                           const bool           single_column,
+                                           const DenseMatrix<T> phi,
+                                           DenseMatrix<T>       out,
+                                           const uint32_t       col_offset)
+{
+    const uint32_t num_rows = phi.rows();
+    const uint32_t n        = num_rows * phi.cols();
+
+    for (uint32_t id = blockIdx.x * blockDim.x + threadIdx.x; id < n;
+         id += blockDim.x * gridDim.x) {
+        const uint32_t r = id % num_rows;
+        const uint32_t c = id / num_rows;
+
+        T offset;
+        if (single_column) {
+            offset = phi(d_sources[0], 0);
+            for (uint32_t s = 1; s < num_sources; ++s) {
+                offset = std::min(offset, phi(d_sources[s], 0));
+            }
+        } else {
+            offset = phi(d_sources[c], c);
+        }
+        out(r, c + col_offset) = std::max(phi(r, c) - offset, T(0));
+    }
+}
+
+/**
+ * @brief set the distance of the sources to zero and activate their patches
+ * (and the neighbor patches)
+ */
+template <typename T>
+__global__ static void geodesic_nb_sources(const Context       context,
+                                           const VertexHandle* d_sources,
+                                           const uint32_t      num_sources,
+                                           VertexAttribute<T>  dist,
+                                           uint32_t*           d_active)
+{
+    const uint32_t s = blockIdx.x * blockDim.x + threadIdx.x;
+    if (s < num_sources) {
+        const VertexHandle vh = d_sources[s];
+        dist(vh)              = T(0);
+
+        const uint32_t pid = vh.patch_id();
+        d_active[pid]      = 1;
+
+        const PatchStash& stash = context.m_patches_info[pid].patch_stash;
+        for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t q = stash.get_patch(i);
+            if (q != INVALID32) {
+                d_active[q] = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief one round of the narrow band solver. Every active patch loads the
+ * distances (and coordinates) of its vertices, including the ribbon, in
+ * shared memory and relaxes its owned vertices until no distance decreases
+ * more than tol (relative) or max_local_iter is reached. Then the owned
+ * vertices that got closer are written back and the patch and its neighbors
+ * are activated for the next round since their ribbon values changed
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void geodesic_narrow_band(const Context            context,
+                                            const VertexAttribute<T> coords,
+                                            VertexAttribute<T>       dist,
+                                            const uint32_t*          d_active,
+                                            uint32_t*      d_next_active,
+                                            uint32_t*      d_num_changed,
+                                            const uint32_t max_local_iter,
+                                            const T        tol,
+                                            const T        infinity_val)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    const uint32_t pid = context.get_block_patch_id();
+    if (d_active[pid] == 0) {
+        return;
+    }
+
+    __shared__ int s_changed;
+    __shared__ int s_written;
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.prologue<Op::VV>(block, shrd_alloc, true);
+
+    const PatchInfo& pi    = query.get_patch_info();
+    const uint16_t   num_v = pi.num_vertices[0];
+
+    T* s_dist = shrd_alloc.alloc<T>(num_v);
+    T* s_xyz  = shrd_alloc.alloc<T>(3 * num_v);
+
+    for (uint16_t v = threadIdx.x; v < num_v; v += blockThreads) {
+        if (pi.is_deleted(LocalVertexT(v))) {
+            s_dist[v] = infinity_val;
+            continue;
+        }
+        const VertexHandle vh = context.get_owner_handle(VertexHandle(pid, v));
+
+        s_dist[v] = dist(vh);
+        for (int i = 0; i < 3; ++i) {
+            s_xyz[3 * v + i] = coords(vh, i);
+        }
+    }
+    if (threadIdx.x == 0) {
+        s_written = 0;
+    }
+    block.sync();
+
+    auto xyz = [&](uint16_t v) {
+        return vec3<T>(s_xyz[3 * v], s_xyz[3 * v + 1], s_xyz[3 * v + 2]);
+    };
+
+    for (uint32_t it = 0; it < max_local_iter; ++it) {
+        if (threadIdx.x == 0) {
+            s_changed = 0;
+        }
+        block.sync();
+
+        // distances only decrease so threads that read a neighbor value
+        // while it is being updated see a valid (larger) upper bound
+        query.run_compute(
+            block, [&](const VertexHandle& vh, const VertexIterator& iter) {
+                if (iter.size() == 0) {
+                    return;
+                }
+                const uint16_t p   = vh.local_id();
+                const T        cur = s_dist[p];
+                T              best = cur;
+
+                const vec3<T> xp = xyz(p);
+                uint16_t      q  = iter.local(iter.size() - 1);
+                for (uint16_t k = 0; k < iter.size(); ++k) {
+                    const uint16_t r = iter.local(k);
+
+                    const T d = geodesic_update_step(
+                        xp, xyz(q), xyz(r), s_dist[q], s_dist[r], infinity_val);
+                    best = (d < best) ? d : best;
+                    q    = r;
+                }
+
+                if (cur - best > tol * best) {
+                    s_dist[p] = best;
+                    s_changed = 1;
+                }
+            });
+        block.sync();
+
+        const int changed = s_changed;
+        block.sync();
+        if (changed == 0) {
+            break;
+        }
+    }
+
+    for (uint16_t v = threadIdx.x; v < num_v; v += blockThreads) {
+        if (pi.is_owned(LocalVertexT(v)) && !pi.is_deleted(LocalVertexT(v))) {
+            const VertexHandle vh(pid, v);
+            if (s_dist[v] < dist(vh)) {
+                dist(vh)  = s_dist[v];
+                s_written = 1;
+            }
+        }
+    }
+    block.sync();
+
+    if (threadIdx.x == 0 && s_written != 0) {
+        ::atomicAdd(d_num_changed, 1u);
+        d_next_active[pid] = 1;
+        for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t q = pi.patch_stash.get_patch(i);
+            if (q != INVALID32) {
+                d_next_active[q] = 1;
+            }
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief geodesic distance from a set of source vertices on a static mesh.
+ * All the setup (e.g., the factorization of the heat method) is done once in
+ * the constructor such that computing the distance from many sources only
+ * pays the per-source cost. compute() returns the distance to the closest
+ * source while compute_batch() returns one distance field per source. See
+ * GeodesicMethod for the two methods. The heat method is approximate (it
+ * converges to the exact distance with mesh refinement) while the narrow band
+ * method computes the same distance as the parallel toggle propagation
+ * (apps/Geodesic) on closed meshes without needing the toplesets on the host
+ *
+ * Example
+ * \code{.cpp}
+ * GeodesicSolver<float> geo(rx, *rx.get_input_vertex_coordinates());
+ * auto dist = *rx.add_vertex_attribute<float>("dist", 1);
+ * geo.compute({source}, dist);
+ * \endcode
+ */
+template <typename T>
+class GeodesicSolver
+{
+    static_assert(std::is_floating_point_v<T>,
+                  "GeodesicSolver only works with float or double");
+
+   public:
+    /**
+     * @brief constructor
+     * @param rx the mesh
+     * @param coords the vertex coordinates
+     * @param method see GeodesicMethod
+     * @param time_factor the time step of the heat method is time_factor
+     * times the squared mean edge length
+     * @param regularization the Poisson equation of the heat method is
+     * regularized with regularization / t times the mass matrix so it could be
+     * factorized with Cholesky. Smaller values are more accurate for large
+     * meshes as long as the factorization is stable (which is more forgiving
+     * in double precision)
+     */
+    GeodesicSolver(RXMeshStatic&             rx,
+                   const VertexAttribute<T>& coords,
+                   const GeodesicMethod      method = GeodesicMethod::Heat,
+                   const T                   time_factor    = T(1),
+                   const T                   regularization = default_reg())
+        : m_rx(rx),
+          m_coords(coords),
+          m_method(method),
+          m_time_step(0),
+          m_regularization(regularization),
+          m_d_sources(nullptr),
+          m_num_sources_capacity(0),
+          m_batch_cols(0),
+          m_d_active(nullptr),
+          m_d_num_changed(nullptr),
+          m_num_rounds(0),
+          m_max_local_iter(64),
+          m_tol(T(1e-5))
+    {
+        if (m_method == GeodesicMethod::Heat) {
+            setup_heat(time_factor);
+        } else {
+            setup_narrow_band();
+        }
+    }
+
+    GeodesicSolver(const GeodesicSolver&)            = delete;
+    GeodesicSolver& operator=(const GeodesicSolver&) = delete;
+
+    ~GeodesicSolver()
+    {
+        release();
+    }
+
+    /**
+     * @brief the default regularization of the heat method
+     */
+    static constexpr T default_reg()
+    {
+        return std::is_same_v<T, float> ? T(1e-5) : T(1e-8);
+    }
+
+    /**
+     * @brief compute the distance from every vertex to the closest source
+     * @param sources the source vertices
+     * @param dist the output distance (on the device)
+     * @param stream the stream used for all kernels and solves
+     */
+    void compute(const std::vector<VertexHandle>& sources,
+                 VertexAttribute<T>&              dist,
+                 cudaStream_t                     stream = NULL)
+    {
+        if (sources.empty()) {
+            RXMESH_ERROR("GeodesicSolver::compute() no sources are given");
+            return;
+        }
+        upload_sources(sources.data(), sources.size(), stream);
+
+        if (m_method == GeodesicMethod::NarrowBand) {
+            narrow_band(sources.size(), dist, stream);
+            return;
+        }
+
+        ensure_batch(1);
+        heat(sources.size(), true, *m_out, 0, stream);
+
+        const DenseMatrix<T> out = *m_out;
+        m_rx.for_each_vertex(
+            DEVICE,
+            [out, dist] __device__(const VertexHandle vh) mutable {
+                dist(vh) = out(vh, 0);
+            },
+            stream);
+    }
+
+    /**
+     * @brief compute one distance field per source i.e., the column s of dist
+     * is the distance to sources[s]. The heat method solves up to
+     * max_batch_cols sources at once with the same factorization
+     * @param sources the source vertices
+     * @param dist the output with get_num_vertices() rows and at least
+     * sources.size() columns (on the device)
+     * @param stream the stream used for all kernels and solves
+     * @param max_batch_cols maximum number of sources solved together
+     */
+    void compute_batch(const std::vector<VertexHandle>& sources,
+                       DenseMatrix<T>&                  dist,
+                       cudaStream_t                     stream         = NULL,
+                       const uint32_t                   max_batch_cols = 32)
+    {
+        if (uint32_t(dist.rows()) != m_rx.get_num_vertices() ||
+            uint32_t(dist.cols()) < sources.size()) {
+            RXMESH_ERROR(
+                "GeodesicSolver::compute_batch() the output should be {}x{} "
+                "instead of {}x{}",
+                m_rx.get_num_vertices(),
+                sources.size(),
+                dist.rows(),
+                dist.cols());
+            return;
+        }
+
+        if (m_method == GeodesicMethod::NarrowBand) {
+            if (!m_nb_dist) {
+                m_nb_dist = m_rx.add_vertex_attribute<T>(
+                    "rx:geodesic_nb_dist", 1, DEVICE);
+            }
+            VertexAttribute<T>& nb_dist = *m_nb_dist;
+            for (uint32_t s = 0; s < sources.size(); ++s) {
+                upload_sources(&sources[s], 1, stream);
+                narrow_band(1, nb_dist, stream);
+                m_rx.for_each_vertex(
+                    DEVICE,
+                    [dist, nb_dist, s] __device__(
+                        const VertexHandle vh) mutable {
+                        dist(vh, s) = nb_dist(vh);
+                    },
+                    stream);
+            }
+            return;
+        }
+
+        const uint32_t batch = std::max(max_batch_cols, 1u);
+        for (uint32_t start = 0; start < sources.size(); start += batch) {
+            const uint32_t num =
+                std::min(batch, uint32_t(sources.size()) - start);
+            upload_sources(&sources[start], num, stream);
+            ensure_batch(num);
+            heat(num, false, dist, start, stream);
+        }
+    }
+
+    /**
+     * @brief the method used by this solver
+     */
+    GeodesicMethod get_method() const
+    {
+        return m_method;
+    }
+
+    /**
+     * @brief the time step of the heat method
+     */
+    T get_time_step() const
+    {
+        return m_time_step;
+    }
+
+    /**
+     * @brief number of rounds (kernel launches) taken by the last narrow band
+     * compute
+     */
+    uint32_t get_num_rounds() const
+    {
+        return m_num_rounds;
+    }
+
+    /**
+     * @brief maximum number of relaxations of a patch in shared memory before
+     * its values are written back (narrow band method)
+     */
+    void set_max_local_iter(const uint32_t max_local_iter)
+    {
+        m_max_local_iter = std::max(max_local_iter, 1u);
+    }
+
+    /**
+     * @brief relative change below which a distance is considered converged
+     * (narrow band method)
+     */
+    void set_tolerance(const T tol)
+    {
+        m_tol = tol;
+    }
+
+    /**
+     * @brief release all the device memory
+     */
+    void release()
+    {
+        if (m_heat_mat) {
+            m_heat_mat->release();
+            m_poisson_mat->release();
+            m_heat_mat.reset();
+            m_poisson_mat.reset();
+        }
+        release_batch();
+        if (m_nb_dist) {
+            m_rx.remove_attribute(m_nb_dist->get_name());
+            m_nb_dist.reset();
+        }
+        GPU_FREE(m_d_sources);
+        GPU_FREE(m_d_active);
+        GPU_FREE(m_d_num_changed);
+        m_num_sources_capacity = 0;
+    }
+
+   private:
+    static constexpr uint32_t blockThreads = 256;
+
+    void setup_heat(const T time_factor)
+    {
+        const Context context = m_rx.get_context();
+
+        // mean edge length where interior edges are counted twice
+        T* d_sum = nullptr;
+        CUDA_ERROR(cudaMalloc((void**)&d_sum, sizeof(T)));
+        CUDA_ERROR(cudaMemset(d_sum, 0, sizeof(T)));
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box(
+            {Op::FV}, lb, (void*)detail::geodesic_edge_length<T, blockThreads>);
+        m_rx.run_query_kernel(lb,
+                              detail::geodesic_edge_length<T, blockThreads>,
+                              NULL,
+                              m_coords,
+                              d_sum);
+
+        T h_sum = 0;
+        CUDA_ERROR(
+            cudaMemcpy(&h_sum, d_sum, sizeof(T), cudaMemcpyDeviceToHost));
+        GPU_FREE(d_sum);
+
+        const T h   = h_sum / T(3 * m_rx.get_num_faces());
+        m_time_step = time_factor * h * h;
+
+        m_heat_mat    = std::make_unique<SparseMatrix<T>>(m_rx);
+        m_poisson_mat = std::make_unique<SparseMatrix<T>>(m_rx);
+
+        m_rx.prepare_launch_box(
+            {Op::FV}, lb, (void*)detail::geodesic_heat_setup<T, blockThreads>);
+        m_rx.run_query_kernel(lb,
+                              detail::geodesic_heat_setup<T, blockThreads>,
+                              NULL,
+                              m_coords,
+                              *m_heat_mat,
+                              *m_poisson_mat,
+                              m_time_step,
+                              m_regularization / m_time_step);
+
+        m_rx.prepare_launch_box(
+            {Op::FV},
+            m_div_lb,
+            (void*)detail::geodesic_heat_divergence<T, blockThreads>);
+
+        m_heat_mat->pre_solve(m_rx, Solver::CHOL);
+        m_poisson_mat->pre_solve(m_rx, Solver::CHOL);
+
+        RXMESH_TRACE("GeodesicSolver: heat method with time step {}",
+                     m_time_step);
+    }
+
+    void setup_narrow_band()
+    {
+        if (!m_rx.is_closed()) {
+            RXMESH_WARN(
+                "GeodesicSolver: the narrow band method expects a closed "
+                "mesh. Distances next to the boundary may be underestimated");
+        }
+
+        m_rx.prepare_launch_box(
+            {Op::VV},
+            m_nb_lb,
+            (void*)detail::geodesic_narrow_band<T, blockThreads>,
+            true,
+            false,
+            false,
+            [](uint32_t v, uint32_t e, uint32_t f) {
+                return 4 * v * sizeof(T) +
+                       2 * ShmemAllocator::default_alignment;
+            });
+
+        const uint32_t num_patches = m_rx.get_num_patches();
+        CUDA_ERROR(cudaMalloc((void**)&m_d_active,
+                              2 * num_patches * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_num_changed, sizeof(uint32_t)));
+    }
+
+    void upload_sources(const VertexHandle* sources,
+                        const uint32_t      num_sources,
+                        cudaStream_t        stream)
+    {
+        if (num_sources > m_num_sources_capacity) {
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+            GPU_FREE(m_d_sources);
+            CUDA_ERROR(cudaMalloc((void**)&m_d_sources,
+                                  num_sources * sizeof(VertexHandle)));
+            m_num_sources_capacity = num_sources;
+        }
+        CUDA_ERROR(cudaMemcpyAsync(m_d_sources,
+                                   sources,
+                                   num_sources * sizeof(VertexHandle),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+    }
+
+    void ensure_batch(const uint32_t num_cols)
+    {
+        if (m_batch_cols == num_cols) {
+            return;
+        }
+        release_batch();
+        const uint32_t n = m_rx.get_num_vertices();
+        m_rhs = std::make_unique<DenseMatrix<T>>(m_rx, n, num_cols, DEVICE);
+        m_u   = std::make_unique<DenseMatrix<T>>(m_rx, n, num_cols, DEVICE);
+        m_phi = std::make_unique<DenseMatrix<T>>(m_rx, n, num_cols, DEVICE);
+        m_out = std::make_unique<DenseMatrix<T>>(m_rx, n, 1, DEVICE);
+        m_batch_cols = num_cols;
+    }
+
+    void release_batch()
+    {
+        if (m_batch_cols > 0) {
+            m_rhs->release();
+            m_u->release();
+            m_phi->release();
+            m_out->release();
+            m_rhs.reset();
+            m_u.reset();
+            m_phi.reset();
+            m_out.reset();
+            m_batch_cols = 0;
+        }
+    }
+
+    /**
+     * @brief run the heat method for the uploaded sources and write the
+     * distance to out starting from col_offset
+     */
+    void heat(const uint32_t  num_sources,
+              const bool      single_column,
+              DenseMatrix<T>& out,
+              const uint32_t  col_offset,
+              cudaStream_t    stream)
+    {
+        const uint32_t threads = 256;
+
+        // 1) heat flow
+        CUDA_ERROR(cudaMemsetAsync(
+            m_rhs->data(DEVICE), 0, m_rhs->bytes(), stream));
+        detail::geodesic_heat_sources<T>
+            <<<DIVIDE_UP(num_sources, threads), threads, 0, stream>>>(
+                m_d_sources, num_sources, single_column, *m_rhs);
+        m_heat_mat->solve(*m_rhs, *m_u, stream);
+
+        // 2) the divergence of the normalized gradient
+        CUDA_ERROR(cudaMemsetAsync(
+            m_rhs->data(DEVICE), 0, m_rhs->bytes(), stream));
+        m_rx.run_query_kernel(m_div_lb,
+                              detail::geodesic_heat_divergence<T, blockThreads>,
+                              stream,
+                              m_coords,
+                              *m_u,
+                              *m_rhs);
+
+        // 3) Poisson equation
+        m_poisson_mat->solve(*m_rhs, *m_phi, stream);
+
+        const uint32_t n = m_phi->rows() * m_phi->cols();
+        detail::geodesic_heat_shift<T>
+            <<<std::min(DIVIDE_UP(n, threads), 65535u), threads, 0, stream>>>(
+                m_d_sources,
+                num_sources,
+                single_column,
+                *m_phi,
+                out,
+                col_offset);
+        CUDA_ERROR(cudaGetLastError());
+    }
+
+    void narrow_band(const uint32_t      num_sources,
+                     VertexAttribute<T>& dist,
+                     cudaStream_t        stream)
+    {
+        const uint32_t threads      = 256;
+        const uint32_t num_patches  = m_rx.get_num_patches();
+        const T        infinity_val = std::numeric_limits<T>::infinity();
+
+        uint32_t* d_active      = m_d_active;
+        uint32_t* d_next_active = m_d_active + num_patches;
+
+        dist.reset(infinity_val, DEVICE, stream);
+        CUDA_ERROR(cudaMemsetAsync(
+            d_active, 0, num_patches * sizeof(uint32_t), stream));
+
+        detail::geodesic_nb_sources<T>
+            <<<DIVIDE_UP(num_sources, threads), threads, 0, stream>>>(
+                m_rx.get_context(), m_d_sources, num_sources, dist, d_active);
+
+        // the front crosses at least one patch per round unless a patch runs
+        // out of local iterations in which case it is processed again in the
+        // next round
+        const uint32_t max_rounds = 4 * num_patches + 16;
+
+        m_num_rounds = 0;
+        bool converged = false;
+        while (!converged && m_num_rounds < max_rounds) {
+            CUDA_ERROR(cudaMemsetAsync(
+                d_next_active, 0, num_patches * sizeof(uint32_t), stream));
+            CUDA_ERROR(
+                cudaMemsetAsync(m_d_num_changed, 0, sizeof(uint32_t), stream));
+
+            m_rx.run_query_kernel(m_nb_lb,
+                                  detail::geodesic_narrow_band<T, blockThreads>,
+                                  stream,
+                                  m_coords,
+                                  dist,
+                                  d_active,
+                                  d_next_active,
+                                  m_d_num_changed,
+                                  m_max_local_iter,
+                                  m_tol,
+                                  infinity_val);
+            m_num_rounds++;
+
+            uint32_t h_num_changed = 0;
+            CUDA_ERROR(cudaMemcpyAsync(&h_num_changed,
+                                       m_d_num_changed,
+                                       sizeof(uint32_t),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+
+            std::swap(d_active, d_next_active);
+
+            converged = (h_num_changed == 0);
+        }
+
+        if (!converged) {
+            RXMESH_WARN(
+                "GeodesicSolver: the narrow band did not converge after {} "
+                "rounds",
+                m_num_rounds);
+        }
+
+        RXMESH_TRACE("GeodesicSolver: the narrow band took {} rounds",
+                     m_num_rounds);
+    }
+
+    RXMeshStatic&      m_rx;
+    VertexAttribute<T> m_coords;
+    GeodesicMethod     m_method;
+
+    // heat method
+    T                                m_time_step;
+    T                                m_regularization;
+    std::unique_ptr<SparseMatrix<T>> m_heat_mat, m_poisson_mat;
+    std::unique_ptr<DenseMatrix<T>>  m_rhs, m_u, m_phi, m_out;
+    LaunchBox<blockThreads>          m_div_lb;
+
+    VertexHandle* m_d_sources;
+    uint32_t      m_num_sources_capacity;
+    uint32_t      m_batch_cols;
+
+    // narrow band method
+    LaunchBox<blockThreads>             m_nb_lb;
+    uint32_t*                           m_d_active;
+    uint32_t*                           m_d_num_changed;
+    uint32_t                            m_num_rounds;
+    uint32_t                            m_max_local_iter;
+    T                                   m_tol;
+    std::shared_ptr<VertexAttribute<T>> m_nb_dist;
+};
+}  // namespace rxmesh
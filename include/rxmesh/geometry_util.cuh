@@ -204,4 +204,136 @@ __host__ __device__ __forceinline__ T edge_cotan_weight(const vec3<T>& p,
 
     return eweight;
 }
-}  // namespace rxmesh
\ No newline at end of file
+
+/**
+ * @brief the closest point to p on the triangle a, b, c (Ericson, "Real-Time
+ * Collision Detection", 2005, Section 5.1.5)
+ */
+template <typename T>
+__host__ __device__ __inline__ vec3<T> closest_point_on_triangle(
+    const vec3<T>& p,
+    const vec3<T>& a,
+    const vec3<T>& b,
+    const vec3<T>& c)
+{
+    const vec3<T> ab = b - a;
+    const vec3<T> ac = c - a;
+    const vec3<T> ap = p - a;
+
+    const T d1 = glm::dot(ab, ap);
+    const T d2 = glm::dot(ac, ap);
+    if (d1 <= T(0) && d2 <= T(0)) {
+        return a;
+    }
+
+    const vec3<T> bp = p - b;
+
+    const T d3 = glm::dot(ab, bp);
+    const T d4 = glm::dot(ac, bp);
+    if (d3 >= T(0) && d4 <= d3) {
+        return b;
+    }
+
+    const T vc = d1 * d4 - d3 * d2;
+    if (vc <= T(0) && d1 >= T(0) && d3 <= T(0)) {
+        return a + (d1 / (d1 - d3)) * ab;
+    }
+
+    const vec3<T> cp = p - c;
+
+    const T d5 = glm::dot(ab, cp);
+    const T d6 = glm::dot(ac, cp);
+    if (d6 >= T(0) && d5 <= d6) {
+        return c;
+    }
+
+    const T vb = d5 * d2 - d1 * d6;
+    if (vb <= T(0) && d2 >= T(0) && d6 <= T(0)) {
+        return a + (d2 / (d2 - d6)) * ac;
+    }
+
+    const T va = d3 * d6 - d5 * d4;
+    if (va <= T(0) && (d4 - d3) >= T(0) && (d5 - d6) >= T(0)) {
+        return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+    }
+
+    const T denom = T(1) / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * @brief intersect the ray origin + t * dir with the triangle a, b, c
+ * (Moller and Trumbore, 1997). Return true if the ray hits the triangle with
+ * t_min <= t <= t_max and set t to the hit parameter. Rays parallel to the
+ * triangle plane are considered a miss
+ */
+template <typename T>
+__host__ __device__ __inline__ bool ray_triangle_intersect(
+    const vec3<T>& origin,
+    const vec3<T>& dir,
+    const vec3<T>& a,
+    const vec3<T>& b,
+    const vec3<T>& c,
+    const T        t_min,
+    const T        t_max,
+    T&             t)
+{
+    const vec3<T> e1  = b - a;
+    const vec3<T> e2  = c - a;
+    const vec3<T> pv  = glm::cross(dir, e2);
+    const T       det = glm::dot(e1, pv);
+
+    if (det == T(0)) {
+        return false;
+    }
+    const T inv_det = T(1) / det;
+
+    const vec3<T> tv = origin - a;
+    const T       u  = glm::dot(tv, pv) * inv_det;
+    if (u < T(0) || u > T(1)) {
+        return false;
+    }
+
+    const vec3<T> qv = glm::cross(tv, e1);
+    const T       v  = glm::dot(dir, qv) * inv_det;
+    if (v < T(0) || u + v > T(1)) {
+        return false;
+    }
+
+    const T tt = glm::dot(e2, qv) * inv_det;
+    if (tt < t_min || tt > t_max) {
+        return false;
+    }
+    t = tt;
+    return true;
+}
+
+/**
+ * @brief test if the triangle a0, a1, a2 intersects the triangle b0, b1, b2.
+ * Two triangles that are not coplanar intersect iff an edge of one of them
+ * crosses the other so the test is done with six segment-triangle tests.
+ * Coplanar triangles are reported as not intersecting
+ */
+template <typename T>
+__host__ __device__ __inline__ bool triangle_triangle_intersect(
+    const vec3<T>& a0,
+    const vec3<T>& a1,
+    const vec3<T>& a2,
+    const vec3<T>& b0,
+    const vec3<T>& b1,
+    const vec3<T>& b2)
+{
+    auto segment = [](const vec3<T>& p,
+                      const vec3<T>& q,
+                      const vec3<T>& x,
+                      const vec3<T>& y,
+                      const vec3<T>& z) {
+        T t;
+        return ray_triangle_intersect(p, q - p, x, y, z, T(0), T(1), t);
+    };
+
+    return segment(a0, a1, b0, b1, b2) || segment(a1, a2, b0, b1, b2) ||
+           segment(a2, a0, b0, b1, b2) || segment(b0, b1, a0, a1, a2) ||
+           segment(b1, b2, a0, a1, a2) || segment(b2, b0, a0, a1, a2);
+}
+}  // namespace rxmesh
@@ -11,14 +11,15 @@ class Attribute;
 namespace detail {
 
 template <class T, uint32_t blockSize>
-__device__ __forceinline__ void cub_block_sum(const T thread_val,
-                                              T*      d_block_output)
+__device__ __forceinline__ void cub_block_sum(const T        thread_val,
+                                              T*             d_block_output,
+                                              const uint32_t block_id)
 {
     typedef cub::BlockReduce<T, blockSize>       BlockReduce;
     __shared__ typename BlockReduce::TempStorage temp_storage;
     T block_sum = BlockReduce(temp_storage).Sum(thread_val);
     if (threadIdx.x == 0) {
-        d_block_output[blockIdx.x] = block_sum;
+        d_block_output[block_id] = block_sum;
     }
 }
 
@@ -28,11 +29,12 @@ __launch_bounds__(blockSize) __global__
                       const uint32_t              num_patches,
                       const uint32_t              num_attributes,
                       T*                          d_block_output,
-                      uint32_t                    attribute_id)
+                      uint32_t                    attribute_id,
+                      const uint32_t              patch_offset = 0)
 {
     using LocalT = typename HandleT::LocalT;
 
-    uint32_t p_id = blockIdx.x;
+    uint32_t p_id = patch_offset + blockIdx.x;
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
         T              thread_val        = 0;
@@ -52,7 +54,7 @@ __launch_bounds__(blockSize) __global__
             }
         }
 
-        cub_block_sum<T, blockSize>(thread_val, d_block_output);
+        cub_block_sum<T, blockSize>(thread_val, d_block_output, p_id);
     }
 }
 
@@ -64,13 +66,14 @@ __launch_bounds__(blockSize) __global__
                     const uint32_t              num_patches,
                     const uint32_t              num_attributes,
                     T*                          d_block_output,
-                    uint32_t                    attribute_id)
+                    uint32_t                    attribute_id,
+                    const uint32_t              patch_offset = 0)
 {
     using LocalT = typename HandleT::LocalT;
 
     assert(X.get_num_attributes() == Y.get_num_attributes());
 
-    uint32_t p_id = blockIdx.x;
+    uint32_t p_id = patch_offset + blockIdx.x;
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
         T              thread_val        = 0;
@@ -90,7 +93,7 @@ __launch_bounds__(blockSize) __global__
             }
         }
 
-        cub_block_sum<T, blockSize>(thread_val, d_block_output);
+        cub_block_sum<T, blockSize>(thread_val, d_block_output, p_id);
     }
 }
 
@@ -103,11 +106,12 @@ __launch_bounds__(blockSize) __global__
                         T*                          d_block_output,
                         ReductionOp                 reduction_op,
                         T                           init,
-                        uint32_t                    attribute_id)
+                        uint32_t                    attribute_id,
+                        const uint32_t              patch_offset = 0)
 {
     using LocalT = typename HandleT::LocalT;
 
-    uint32_t p_id = blockIdx.x;
+    uint32_t p_id = patch_offset + blockIdx.x;
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
         T              thread_val        = init;
@@ -131,12 +135,77 @@ __launch_bounds__(blockSize) __global__
         T block_aggregate =
             BlockReduce(temp_storage).Reduce(thread_val, reduction_op);
         if (threadIdx.x == 0) {
-            d_block_output[blockIdx.x] = block_aggregate;
+            d_block_output[p_id] = block_aggregate;
         }
     }
 }
 
 
+/**
+ * @brief the operands of ReduceHandle::multi_dot() i.e., up to MaxOps pairs
+ * of attributes whose dot products are computed in a single pass
+ */
+template <class T, typename HandleT, uint32_t MaxOps>
+struct MultiDotOperands
+{
+    static constexpr uint32_t max_ops = MaxOps;
+
+    Attribute<T, HandleT> x[MaxOps];
+    Attribute<T, HandleT> y[MaxOps];
+    uint32_t              num_ops;
+};
+
+template <class T, uint32_t blockSize, typename HandleT, typename OpsT>
+__launch_bounds__(blockSize) __global__
+    void multi_dot_kernel(const OpsT     ops,
+                          const uint32_t num_patches,
+                          T*             d_block_output,
+                          const uint32_t patch_offset = 0)
+{
+    using LocalT = typename HandleT::LocalT;
+
+    constexpr uint32_t MaxOps = OpsT::max_ops;
+
+    uint32_t p_id = patch_offset + blockIdx.x;
+    if (p_id < num_patches) {
+        const uint16_t element_per_patch = ops.x[0].size(p_id);
+
+        T thread_val[MaxOps];
+        for (uint32_t o = 0; o < MaxOps; ++o) {
+            thread_val[o] = 0;
+        }
+
+        for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
+            if (ops.x[0].get_patch_info(p_id).is_owned(LocalT(i)) &&
+                !ops.x[0].get_patch_info(p_id).is_deleted(LocalT(i))) {
+                for (uint32_t o = 0; o < ops.num_ops; ++o) {
+                    const uint32_t num_attr = ops.x[o].get_num_attributes();
+                    for (uint32_t j = 0; j < num_attr; ++j) {
+                        thread_val[o] += ops.x[o](p_id, i, j) *
+                                         ops.y[o](p_id, i, j);
+                    }
+                }
+            }
+        }
+
+        typedef cub::BlockReduce<T, blockSize>       BlockReduce;
+        __shared__ typename BlockReduce::TempStorage temp_storage;
+        for (uint32_t o = 0; o < ops.num_ops; ++o) {
+            T block_sum = BlockReduce(temp_storage).Sum(thread_val[o]);
+            if (threadIdx.x == 0) {
+                d_block_output[o * num_patches + p_id] = block_sum;
+            }
+            __syncthreads();
+        }
+    }
+}
+
+template <typename T>
+__global__ void sqrt_in_place(T* d_value)
+{
+    d_value[0] = sqrt(d_value[0]);
+}
+
 template <typename T, typename HandleT>
 __global__ void memset_attribute(const Attribute<T, HandleT> attr,
                                  const T                     value,
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <assert.h>
+#include <cooperative_groups.h>
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/fixed_iterator.cuh"
+#include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/query_dispatcher.cuh"
+#include "rxmesh/kernels/rxmesh_queries.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/patch_info.h"
+#include "rxmesh/types.h"
+#include "rxmesh/util/bitmask_util.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief the edges incident to every vertex of the patch in a row of
+ * maxValence entries per vertex (s_row) along with their number (s_count).
+ * Since the rows have fixed size, there is no transpose and no offset array
+ * (as done by v_e()). If storeVertex, the row stores the other end vertex of
+ * the edges instead. Edges beyond maxValence are dropped and so the mesh
+ * should be checked first (see RXMeshStatic::is_valence_bounded)
+ */
+template <uint32_t blockThreads, uint32_t maxValence, bool storeVertex>
+__device__ __forceinline__ void bounded_v_e(const PatchInfo& patch_info,
+                                            uint16_t*        s_count,
+                                            uint16_t*        s_row)
+{
+    const uint16_t  num_vertices = patch_info.num_vertices[0];
+    const uint16_t  num_edges    = patch_info.num_edges[0];
+    const uint16_t* ev = reinterpret_cast<const uint16_t*>(patch_info.ev);
+
+    fill_n<blockThreads>(s_count, num_vertices, uint16_t(0));
+    __syncthreads();
+
+    for (uint16_t e = threadIdx.x; e < num_edges; e += blockThreads) {
+        if (is_deleted(e, patch_info.active_mask_e)) {
+            continue;
+        }
+        const uint16_t v0 = ev[2 * e + 0];
+        const uint16_t v1 = ev[2 * e + 1];
+
+        const uint16_t s0 = atomicAdd(s_count + v0, uint16_t(1));
+        const uint16_t s1 = atomicAdd(s_count + v1, uint16_t(1));
+        assert(s0 < maxValence);
+        assert(s1 < maxValence);
+
+        if (s0 < maxValence) {
+            s_row[v0 * maxValence + s0] = storeVertex ? v1 : e;
+        }
+        if (s1 < maxValence) {
+            s_row[v1 * maxValence + s1] = storeVertex ? v0 : e;
+        }
+    }
+    __syncthreads();
+}
+
+/**
+ * @brief order the n edges incident to a vertex such that every two
+ * consecutive edges share a face, starting from a boundary edge if there is
+ * one (similar to orient_edges_around_vertices() but in registers). s_fe and
+ * s_ef are FE and EF of the patch
+ */
+template <uint32_t maxValence>
+__device__ __forceinline__ void orient_bounded_edges(
+    const uint16_t  n,
+    uint16_t (&edges)[maxValence],
+    const uint16_t* s_fe,
+    const uint16_t* s_ef)
+{
+    auto swap = [&](const uint16_t i, const uint16_t j) {
+        const uint16_t temp = edges[i];
+        edges[i]            = edges[j];
+        edges[j]            = temp;
+    };
+
+    // if the vertex is on the boundary, start from a boundary edge
+    for (uint16_t i = 0; i < n; ++i) {
+        if (s_ef[2 * edges[i]] == INVALID16 ||
+            s_ef[2 * edges[i] + 1] == INVALID16) {
+            swap(0, i);
+            break;
+        }
+    }
+
+    for (uint16_t i = 0; i + 1 < n; ++i) {
+        const uint16_t e_0 = edges[i];
+
+        // candidate next edge in each of the two faces (only one of them will
+        // be incident to the vertex)
+        uint16_t e_candid[2] = {INVALID16, INVALID16};
+        for (int k = 0; k < 2; ++k) {
+            const uint16_t f = s_ef[2 * e_0 + k];
+            if (f == INVALID16) {
+                continue;
+            }
+            for (int j = 0; j < 3; ++j) {
+                if ((s_fe[3 * f + j] >> 1) == e_0) {
+                    e_candid[k] = s_fe[3 * f + ((j + 2) % 3)] >> 1;
+                }
+            }
+        }
+
+        for (uint16_t j = i + 1; j < n; ++j) {
+            if (edges[j] == e_candid[0] || edges[j] == e_candid[1]) {
+                swap(i + 1, j);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief VV or VE query where the valence of every vertex is at most
+ * maxValence. The incident edges of every vertex are computed in fixed-size
+ * rows (see bounded_v_e()) and every thread copies the row of its vertex into
+ * a FixedIterator (ordered if oriented) before calling compute_op on it.
+ * Should be called by the whole block. The shared memory is freed before
+ * returning
+ */
+template <Op       op,
+          uint32_t blockThreads,
+          uint32_t maxValence,
+          bool     oriented,
+          typename computeT,
+          typename activeSetT>
+__device__ __inline__ void query_block_bounded_dispatcher(
+    cooperative_groups::thread_block& block,
+    ShmemAllocator&                   shrd_alloc,
+    const Context&                    context,
+    const PatchInfo&                  patch_info,
+    computeT                          compute_op,
+    activeSetT                        compute_active_set,
+    uint32_t*                         s_cached_owned_bitmask = nullptr,
+    LPPair*                           s_cached_table         = nullptr)
+{
+    static_assert(op == Op::VV || op == Op::VE,
+                  "query_block_bounded_dispatcher() only supports Op::VV and "
+                  "Op::VE");
+
+    using OutputHandleT =
+        std::conditional_t<op == Op::VV, VertexHandle, EdgeHandle>;
+    using IteratorT = FixedIterator<OutputHandleT, maxValence>;
+
+    // the other end vertex is only stored directly when the edges are not
+    // needed to orient the output
+    constexpr bool store_vertex = (op == Op::VV) && !oriented;
+
+    const uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    uint32_t num_src_in_patch = 0;
+    uint32_t *input_active_mask, *input_owned_mask, *s_participant_bitmask;
+    query_source<Op::VV>(
+        patch_info, num_src_in_patch, input_active_mask, input_owned_mask);
+
+    alloc_participant_bitmask<blockThreads>(
+        shrd_alloc, num_src_in_patch, s_participant_bitmask);
+
+    // load the owned mask and LP hashtable of the output async
+    const uint32_t*    output_owned_mask = patch_info.owned_mask_v;
+    const LPHashTable& output_lp_hashtable =
+        (op == Op::VV) ? patch_info.lp_v : patch_info.lp_e;
+    uint32_t num_output = patch_info.num_vertices[0];
+    if constexpr (op == Op::VE) {
+        output_owned_mask = patch_info.owned_mask_e;
+        num_output        = patch_info.num_edges[0];
+    }
+
+    uint32_t* s_output_owned_bitmask = s_cached_owned_bitmask;
+    if (s_output_owned_bitmask == nullptr) {
+        const uint32_t mask_size = mask_num_bytes(num_output);
+        s_output_owned_bitmask =
+            reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+        load_async(reinterpret_cast<const char*>(output_owned_mask),
+                   mask_size,
+                   reinterpret_cast<char*>(s_output_owned_bitmask),
+                   false);
+    }
+
+    LPPair* s_table = s_cached_table;
+    if (s_table == nullptr) {
+        s_table =
+            shrd_alloc.alloc<LPPair>(output_lp_hashtable.get_capacity());
+        output_lp_hashtable.load_in_shared_memory(s_table, false);
+    }
+
+    const uint16_t num_edges = patch_info.num_edges[0];
+    const uint16_t num_faces = patch_info.num_faces[0];
+
+    uint16_t* s_fe = nullptr;
+    uint16_t* s_ef = nullptr;
+    if constexpr (oriented) {
+        s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+        s_ef = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+        fill_n<blockThreads>(s_ef, 2 * num_edges, uint16_t(INVALID16));
+        load_async(block,
+                   reinterpret_cast<const uint16_t*>(patch_info.fe),
+                   3 * num_faces,
+                   s_fe,
+                   false);
+    }
+
+    uint16_t* s_count = shrd_alloc.alloc<uint16_t>(num_src_in_patch);
+    uint16_t* s_row =
+        shrd_alloc.alloc<uint16_t>(num_src_in_patch * maxValence);
+
+    if (set_participant_bitmask<blockThreads>(patch_info,
+                                              compute_active_set,
+                                              num_src_in_patch,
+                                              input_active_mask,
+                                              input_owned_mask,
+                                              false,
+                                              s_participant_bitmask)) {
+
+        bounded_v_e<blockThreads, maxValence, store_vertex>(
+            patch_info, s_count, s_row);
+
+        cooperative_groups::wait(block);
+        block.sync();
+
+        if constexpr (oriented) {
+            e_f_manifold<blockThreads>(
+                num_edges, num_faces, s_fe, s_ef, patch_info.active_mask_f);
+            block.sync();
+        }
+
+        for (uint16_t v = threadIdx.x; v < num_src_in_patch;
+             v += blockThreads) {
+            if (!is_set_bit(v, s_participant_bitmask)) {
+                continue;
+            }
+
+            const uint16_t n =
+                std::min(s_count[v], static_cast<uint16_t>(maxValence));
+
+            IteratorT iter(context,
+                           patch_info.patch_id,
+                           s_output_owned_bitmask,
+                           s_table);
+
+            if constexpr (oriented) {
+                uint16_t edges[maxValence];
+                for (uint16_t i = 0; i < n; ++i) {
+                    edges[i] = s_row[v * maxValence + i];
+                }
+                orient_bounded_edges<maxValence>(n, edges, s_fe, s_ef);
+
+                const uint16_t* ev =
+                    reinterpret_cast<const uint16_t*>(patch_info.ev);
+                for (uint16_t i = 0; i < n; ++i) {
+                    if constexpr (op == Op::VV) {
+                        const uint16_t v0 = ev[2 * edges[i] + 0];
+                        const uint16_t v1 = ev[2 * edges[i] + 1];
+                        iter.push_back((v0 == v) ? v1 : v0);
+                    } else {
+                        iter.push_back(edges[i]);
+                    }
+                }
+            } else {
+                for (uint16_t i = 0; i < n; ++i) {
+                    iter.push_back(s_row[v * maxValence + i]);
+                }
+            }
+
+            compute_op(VertexHandle(patch_info.patch_id, v), iter);
+        }
+    } else {
+        // the loads should be done before the shared memory is reused
+        cooperative_groups::wait(block);
+    }
+
+    block.sync();
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -1,5 +1,6 @@
 #pragma once
 #include "rxmesh/context.h"
+#include "rxmesh/frontier.cuh"
 #include "rxmesh/handle.h"
 #include "rxmesh/patch_info.h"
 #include "rxmesh/types.h"
@@ -102,6 +103,46 @@ __global__ void for_each_face(const uint32_t   num_patches,
 }
 }  // namespace detail
 
+namespace detail {
+/**
+ * @brief apply a lambda function on the owned elements of the current
+ * frontier where block b processes the b-th patch of the frontier
+ */
+template <typename HandleT, typename LambdaT>
+__global__ void for_each_frontier(const PatchInfo*        patch_info,
+                                  const Frontier<HandleT> frontier,
+                                  LambdaT                 apply)
+{
+    const PatchInfo& pi = patch_info[frontier.get_patch(blockIdx.x)];
+
+    uint16_t        num_elements = 0;
+    const uint32_t* active_mask  = nullptr;
+    const uint32_t* owned_mask   = nullptr;
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        num_elements = pi.num_vertices[0];
+        active_mask  = pi.active_mask_v;
+        owned_mask   = pi.owned_mask_v;
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        num_elements = pi.num_edges[0];
+        active_mask  = pi.active_mask_e;
+        owned_mask   = pi.owned_mask_e;
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        num_elements = pi.num_faces[0];
+        active_mask  = pi.active_mask_f;
+        owned_mask   = pi.owned_mask_f;
+    }
+
+    for (uint16_t i = threadIdx.x; i < num_elements; i += blockDim.x) {
+        const HandleT h(pi.patch_id, i);
+        if (!is_deleted(i, active_mask) && is_owned(i, owned_mask) &&
+            frontier.is_active(h)) {
+            apply(h);
+        }
+    }
+}
+}  // namespace detail
 
 /**
  * @brief Apply a lambda function on all mesh elements. The type of the mesh
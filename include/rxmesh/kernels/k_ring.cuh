@@ -0,0 +1,180 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/query_cache.h"
+#include "rxmesh/util/bitmask_util.h"
+
+namespace rxmesh {
+
+/**
+ * @brief iterator over the k-ring of a vertex (see Query::dispatch_k_ring).
+ * The vertices are ordered ring by ring where the r-th ring (r = 1..k) starts
+ * at ring_begin(r) and ends at ring_end(r). Every vertex appears once and the
+ * source vertex is not part of its k-ring. All handles are owner handles
+ */
+struct KRingIterator
+{
+    __device__ KRingIterator(const VertexHandle* ring,
+                             const uint16_t*     ring_end,
+                             const uint32_t      stride,
+                             const uint16_t      num_rings,
+                             const bool          truncated)
+        : m_ring(ring),
+          m_ring_end(ring_end),
+          m_stride(stride),
+          m_num_rings(num_rings),
+          m_truncated(truncated)
+    {
+    }
+
+    /**
+     * @brief number of vertices in all rings
+     */
+    __device__ uint16_t size() const
+    {
+        return (m_num_rings == 0) ? 0 : ring_end(m_num_rings);
+    }
+
+    __device__ VertexHandle operator[](const uint16_t i) const
+    {
+        assert(i < size());
+        return m_ring[i * m_stride];
+    }
+
+    /**
+     * @brief number of rings i.e., k
+     */
+    __device__ uint16_t num_rings() const
+    {
+        return m_num_rings;
+    }
+
+    /**
+     * @brief index of the first vertex in the r-th ring (r starts from 1)
+     */
+    __device__ uint16_t ring_begin(const uint16_t r) const
+    {
+        assert(r >= 1 && r <= m_num_rings);
+        return (r == 1) ? 0 : ring_end(r - 1);
+    }
+
+    /**
+     * @brief index after the last vertex in the r-th ring (r starts from 1)
+     */
+    __device__ uint16_t ring_end(const uint16_t r) const
+    {
+        assert(r >= 1 && r <= m_num_rings);
+        return m_ring_end[(r - 1) * m_stride];
+    }
+
+    /**
+     * @brief true if the k-ring has more vertices than the capacity and thus
+     * the last ring is incomplete
+     */
+    __device__ bool is_truncated() const
+    {
+        return m_truncated;
+    }
+
+   private:
+    const VertexHandle* m_ring;
+    const uint16_t*     m_ring_end;
+    uint32_t            m_stride;
+    uint16_t            m_num_rings;
+    bool                m_truncated;
+};
+
+namespace detail {
+
+/**
+ * @brief call f(owner handle) on every vertex in the 1-ring of the vertex vh
+ * using the VV query cache in global memory. vh should be an owner handle
+ * since the 1-ring of owned vertices is complete in their patch (the ribbon)
+ * while neighbor vertices that are not owned by the patch are mapped to their
+ * owner patch using the patch LP hashtable and stash
+ */
+template <typename FuncT>
+__device__ __inline__ void for_each_cached_vv(const Context&         context,
+                                              const QueryCacheEntry& vv,
+                                              const VertexHandle     vh,
+                                              FuncT                  f)
+{
+    const uint32_t   p  = vh.patch_id();
+    const uint16_t   v  = vh.local_id();
+    const PatchInfo& pi = context.m_patches_info[p];
+
+    assert(is_owned(v, pi.owned_mask_v));
+
+    const uint16_t* offset = vv.d_offset + vv.d_offset_start[p];
+    const uint16_t* value  = vv.d_value + vv.d_value_start[p];
+
+    for (uint16_t i = offset[v]; i < offset[v + 1]; ++i) {
+        VertexHandle n(p, value[i]);
+        if (!is_owned(value[i], pi.owned_mask_v)) {
+            n = context.get_owner_handle(n);
+        }
+        f(n);
+    }
+}
+
+/**
+ * @brief compute the k-ring of the owned vertex vh by a breadth-first
+ * expansion over the VV query cache. The k-ring is written to ring and the
+ * end of every ring to ring_end where consecutive entries are stride apart
+ * (so the threads of a block can interleave their buffers in shared memory).
+ * Duplicates are removed using a linear search in the (bounded) output. Once
+ * capacity vertices are found, the remaining ones are dropped and the
+ * iterator is marked as truncated
+ */
+__device__ __inline__ KRingIterator k_ring(const Context&         context,
+                                           const QueryCacheEntry& vv,
+                                           const VertexHandle     vh,
+                                           const uint16_t         k,
+                                           const uint16_t         capacity,
+                                           const uint32_t         stride,
+                                           VertexHandle*          ring,
+                                           uint16_t*              ring_end)
+{
+    uint16_t count     = 0;
+    bool     truncated = false;
+
+    auto add = [&](const VertexHandle n) {
+        if (n == vh) {
+            return;
+        }
+        for (uint16_t i = 0; i < count; ++i) {
+            if (ring[i * stride] == n) {
+                return;
+            }
+        }
+        if (count < capacity) {
+            ring[count * stride] = n;
+            count++;
+        } else {
+            truncated = true;
+        }
+    };
+
+    // the begin and end of the previous ring
+    uint16_t begin = 0, end = 0;
+    for (uint16_t r = 0; r < k; ++r) {
+        if (r == 0) {
+            for_each_cached_vv(context, vv, vh, add);
+        } else {
+            for (uint16_t i = begin; i < end; ++i) {
+                for_each_cached_vv(context, vv, ring[i * stride], add);
+            }
+        }
+        ring_end[r * stride] = count;
+        begin                = end;
+        end                  = count;
+    }
+
+    return KRingIterator(ring, ring_end, stride, k, truncated);
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -45,6 +45,32 @@ __device__ __forceinline__ void load_async(const T*    in,
     }
 }
 
+/**
+ * @brief load the patch topology (EV or FE) into shared memory. If the input
+ * is already in shared memory (i.e., a copy cached by a query chain), it is
+ * copied by the block since memcpy_async only accelerates loads from global
+ * memory. Otherwise, it is the same as load_async()
+ */
+template <typename T, typename SizeT>
+__device__ __forceinline__ void load_topology(
+    cooperative_groups::thread_block& block,
+    const T*                          in,
+    const SizeT                       size,
+    T*                                out,
+    bool                              with_wait)
+{
+    if (__isShared(in)) {
+        for (uint32_t i = block.thread_rank(); i < size; i += block.size()) {
+            out[i] = in[i];
+        }
+        if (with_wait) {
+            block.sync();
+        }
+    } else {
+        load_async(block, in, size, out, with_wait);
+    }
+}
+
 /**
  * @brief store shared memory into global memory. Optimized for uint16_t but
  * also works okay for other types
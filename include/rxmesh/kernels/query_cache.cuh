@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cooperative_groups.h>
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/query_cache.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief number of offsets and output values of the query op in every patch
+ * such that they can be allocated in the query cache. All elements that are
+ * not deleted are counted i.e., including the not-owned ones
+ */
+template <uint32_t blockThreads, Op op>
+__global__ static void query_cache_count(const Context context,
+                                         const bool    oriented,
+                                         uint32_t*     d_num_offset,
+                                         uint32_t*     d_num_value)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.template prologue<op>(block, shrd_alloc, oriented, true);
+
+    if (threadIdx.x == 0) {
+        constexpr uint32_t fixed_offset = query_fixed_offset(op);
+
+        const uint32_t p       = query.get_patch_info().patch_id;
+        const uint32_t num_src = query.get_num_src_in_patch();
+
+        uint32_t num_offset = 0, num_value = 0;
+        if (num_src > 0) {
+            if constexpr (fixed_offset == 0) {
+                num_offset = num_src + 1;
+                num_value  = query.get_output_offset()[num_src];
+            } else {
+                num_value = fixed_offset * num_src;
+            }
+        }
+        d_num_offset[p] = num_offset;
+        d_num_value[p]  = num_value;
+    }
+
+    query.epilogue(block, shrd_alloc);
+}
+
+/**
+ * @brief copy the output of the query op in every patch from shared memory to
+ * the query cache entry whose per-patch start are computed from the output of
+ * query_cache_count()
+ */
+template <uint32_t blockThreads, Op op>
+__global__ static void query_cache_fill(const Context         context,
+                                        const bool            oriented,
+                                        const QueryCacheEntry entry)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.template prologue<op>(block, shrd_alloc, oriented, true);
+
+    const uint32_t num_src = query.get_num_src_in_patch();
+
+    if (num_src > 0) {
+        constexpr uint32_t fixed_offset = query_fixed_offset(op);
+
+        const uint32_t p = query.get_patch_info().patch_id;
+
+        const uint16_t* s_offset = query.get_output_offset();
+        const uint16_t* s_value  = query.get_output_value();
+
+        uint32_t num_value = fixed_offset * num_src;
+        if constexpr (fixed_offset == 0) {
+            num_value = s_offset[num_src];
+
+            uint16_t* offset = entry.d_offset + entry.d_offset_start[p];
+            for (uint32_t i = threadIdx.x; i <= num_src; i += blockThreads) {
+                offset[i] = s_offset[i];
+            }
+        }
+
+        uint16_t* value = entry.d_value + entry.d_value_start[p];
+        for (uint32_t i = threadIdx.x; i < num_value; i += blockThreads) {
+            value[i] = s_value[i];
+        }
+    }
+
+    query.epilogue(block, shrd_alloc);
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -22,28 +22,16 @@ namespace rxmesh {
 namespace detail {
 
 /**
- * query_block_dispatcher()
+ * @brief the number of source elements of the query op in the patch along
+ * with their active and owned masks
  */
-template <Op op, uint32_t blockThreads, typename activeSetT>
-__device__ __inline__ void query_block_dispatcher(
-    cooperative_groups::thread_block& block,
-    ShmemAllocator&                   shrd_alloc,
-    const PatchInfo&                  patch_info,
-    activeSetT                        compute_active_set,
-    const bool                        oriented,
-    uint32_t&                         num_src_in_patch,
-    uint16_t*&                        s_output_offset,
-    uint16_t*&                        s_output_value,
-    uint32_t*&                        s_participant_bitmask,
-    uint32_t*&                        s_output_owned_bitmask,
-    LPHashTable&                      output_lp_hashtable,
-    LPPair*&                          s_table,
-    bool                              allow_not_owned = false)
+template <Op op>
+__device__ __inline__ void query_source(const PatchInfo& patch_info,
+                                        uint32_t&        num_src_in_patch,
+                                        uint32_t*&       input_active_mask,
+                                        uint32_t*&       input_owned_mask)
 {
-    num_src_in_patch                = 0;
-    uint16_t    num_output_in_patch = 0;
-    uint32_t *  input_active_mask, *input_owned_mask;
-    LPHashTable hashtable;
+    num_src_in_patch = 0;
     if constexpr (op == Op::VV || op == Op::VE || op == Op::VF) {
         num_src_in_patch  = patch_info.num_vertices[0];
         input_active_mask = patch_info.active_mask_v;
@@ -60,8 +48,17 @@ __device__ __inline__ void query_block_dispatcher(
         input_active_mask = patch_info.active_mask_f;
         input_owned_mask  = patch_info.owned_mask_f;
     }
+}
 
-    // alloc participant bitmask
+/**
+ * @brief allocate the participant bitmask in shared memory and zero it
+ */
+template <uint32_t blockThreads>
+__device__ __inline__ void alloc_participant_bitmask(
+    ShmemAllocator& shrd_alloc,
+    const uint32_t  num_src_in_patch,
+    uint32_t*&      s_participant_bitmask)
+{
     s_participant_bitmask = reinterpret_cast<uint32_t*>(
         shrd_alloc.alloc(mask_num_bytes(num_src_in_patch)));
 
@@ -70,48 +67,142 @@ __device__ __inline__ void query_block_dispatcher(
         s_participant_bitmask[i] = 0;
     }
     __syncthreads();
+}
+
+/**
+ * @brief cache the result of (is_active && is_owned && is_compute_set) of
+ * every source element in the participant bitmask in shared memory. Returns
+ * false if no element in the patch participates in the query. Should be
+ * called by the whole block
+ */
+template <uint32_t blockThreads, typename activeSetT>
+__device__ __inline__ bool set_participant_bitmask(
+    const PatchInfo& patch_info,
+    activeSetT       compute_active_set,
+    const uint32_t   num_src_in_patch,
+    const uint32_t*  input_active_mask,
+    const uint32_t*  input_owned_mask,
+    const bool       allow_not_owned,
+    uint32_t*        s_participant_bitmask)
+{
+    bool is_participant = false;
+    block_loop<uint16_t,
+               blockThreads,
+               true>(num_src_in_patch, [&](const uint16_t local_id) {
+        bool is_par = false;
+        if (local_id < num_src_in_patch) {
+            bool is_del = is_deleted(local_id, input_active_mask);
+            bool is_own =
+                allow_not_owned || is_owned(local_id, input_owned_mask);
+            bool is_act = compute_active_set({patch_info.patch_id, local_id});
+            is_par      = !is_del && is_own && is_act;
+        }
+        is_participant     = is_participant || is_par;
+        uint32_t warp_mask = __ballot_sync(0xFFFFFFFF, is_par);
+        uint32_t lane_id   = threadIdx.x % 32;
+        if (lane_id == 0) {
+            uint32_t mask_id               = local_id / 32;
+            s_participant_bitmask[mask_id] = warp_mask;
+        }
+    });
+
+    return __syncthreads_or(is_participant) != 0;
+}
+
+/**
+ * query_block_dispatcher()
+ */
+template <Op op, uint32_t blockThreads, typename activeSetT>
+__device__ __inline__ void query_block_dispatcher(
+    cooperative_groups::thread_block& block,
+    ShmemAllocator&                   shrd_alloc,
+    const PatchInfo&                  patch_info,
+    activeSetT                        compute_active_set,
+    const bool                        oriented,
+    uint32_t&                         num_src_in_patch,
+    uint16_t*&                        s_output_offset,
+    uint16_t*&                        s_output_value,
+    uint32_t*&                        s_participant_bitmask,
+    uint32_t*&                        s_output_owned_bitmask,
+    LPHashTable&                      output_lp_hashtable,
+    LPPair*&                          s_table,
+    bool                              allow_not_owned        = false,
+    uint32_t*                         s_cached_owned_bitmask = nullptr,
+    LPPair*                           s_cached_table         = nullptr,
+    const QueryEngine                 engine = QueryEngine::Block,
+    const uint16_t*                   s_cached_ev            = nullptr,
+    const uint16_t*                   s_cached_fe            = nullptr)
+{
+    uint32_t *input_active_mask, *input_owned_mask;
+    query_source<op>(
+        patch_info, num_src_in_patch, input_active_mask, input_owned_mask);
+
+    alloc_participant_bitmask<blockThreads>(
+        shrd_alloc, num_src_in_patch, s_participant_bitmask);
 
     // alloc and load owned mask async
     // select lp hashtable
     if constexpr (op == Op::VV || op == Op::EV || op == Op::FV ||
                   op == Op::EVDiamond) {
-        const uint32_t mask_size = mask_num_bytes(patch_info.num_vertices[0]);
-        s_output_owned_bitmask =
-            reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
-        load_async(reinterpret_cast<char*>(patch_info.owned_mask_v),
-                   mask_size,
-                   reinterpret_cast<char*>(s_output_owned_bitmask),
-                   false);
+        if (s_cached_owned_bitmask != nullptr) {
+            s_output_owned_bitmask = s_cached_owned_bitmask;
+        } else {
+            const uint32_t mask_size =
+                mask_num_bytes(patch_info.num_vertices[0]);
+            s_output_owned_bitmask =
+                reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+            load_async(reinterpret_cast<char*>(patch_info.owned_mask_v),
+                       mask_size,
+                       reinterpret_cast<char*>(s_output_owned_bitmask),
+                       false);
+        }
         output_lp_hashtable = patch_info.lp_v;
     }
     if constexpr (op == Op::VE || op == Op::EE || op == Op::FE) {
-        const uint32_t mask_size = mask_num_bytes(patch_info.num_edges[0]);
-        s_output_owned_bitmask =
-            reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
-        load_async(reinterpret_cast<char*>(patch_info.owned_mask_e),
-                   mask_size,
-                   reinterpret_cast<char*>(s_output_owned_bitmask),
-                   false);
+        if (s_cached_owned_bitmask != nullptr) {
+            s_output_owned_bitmask = s_cached_owned_bitmask;
+        } else {
+            const uint32_t mask_size = mask_num_bytes(patch_info.num_edges[0]);
+            s_output_owned_bitmask =
+                reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+            load_async(reinterpret_cast<char*>(patch_info.owned_mask_e),
+                       mask_size,
+                       reinterpret_cast<char*>(s_output_owned_bitmask),
+                       false);
+        }
         output_lp_hashtable = patch_info.lp_e;
     }
     if constexpr (op == Op::VF || op == Op::EF || op == Op::FF) {
-        const uint32_t mask_size = mask_num_bytes(patch_info.num_faces[0]);
-        s_output_owned_bitmask =
-            reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
-        load_async(reinterpret_cast<char*>(patch_info.owned_mask_f),
-                   mask_size,
-                   reinterpret_cast<char*>(s_output_owned_bitmask),
-                   false);
+        if (s_cached_owned_bitmask != nullptr) {
+            s_output_owned_bitmask = s_cached_owned_bitmask;
+        } else {
+            const uint32_t mask_size = mask_num_bytes(patch_info.num_faces[0]);
+            s_output_owned_bitmask =
+                reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+            load_async(reinterpret_cast<char*>(patch_info.owned_mask_f),
+                       mask_size,
+                       reinterpret_cast<char*>(s_output_owned_bitmask),
+                       false);
+        }
         output_lp_hashtable = patch_info.lp_f;
     }
 
 
     // load table async
+    // if the table is already cached in shared memory (e.g., by a previous
+    // stage of a query chain), we just use it
     auto alloc_then_load_table = [&](bool with_wait) {
+        if (s_cached_table != nullptr) {
+            s_table = s_cached_table;
+            return;
+        }
         s_table = shrd_alloc.template alloc<LPPair>(
             output_lp_hashtable.get_capacity());
         output_lp_hashtable.load_in_shared_memory(s_table, with_wait);
     };
+    if (s_cached_table != nullptr) {
+        s_table = s_cached_table;
+    }
 
     if constexpr (op != Op::FV && op != Op::VV && op != Op::FF &&
                   op != Op::EVDiamond) {
@@ -121,31 +212,13 @@ __device__ __inline__ void query_block_dispatcher(
     }
 
 
-    // we  cache the result of (is_active && is_owned && is_compute_set) in
-    // shared memory to check on it later
-    bool is_participant = false;
-    block_loop<uint16_t,
-               blockThreads,
-               true>(num_src_in_patch, [&](const uint16_t local_id) {
-        bool is_par = false;
-        if (local_id < num_src_in_patch) {
-            bool is_del = is_deleted(local_id, input_active_mask);
-            bool is_own =
-                allow_not_owned || is_owned(local_id, input_owned_mask);
-            bool is_act = compute_active_set({patch_info.patch_id, local_id});
-            is_par      = !is_del && is_own && is_act;
-        }
-        is_participant     = is_participant || is_par;
-        uint32_t warp_mask = __ballot_sync(0xFFFFFFFF, is_par);
-        uint32_t lane_id   = threadIdx.x % 32;
-        if (lane_id == 0) {
-            uint32_t mask_id               = local_id / 32;
-            s_participant_bitmask[mask_id] = warp_mask;
-        }
-    });
-
-
-    if (__syncthreads_or(is_participant) == 0) {
+    if (!set_participant_bitmask<blockThreads>(patch_info,
+                                               compute_active_set,
+                                               num_src_in_patch,
+                                               input_active_mask,
+                                               input_owned_mask,
+                                               allow_not_owned,
+                                               s_participant_bitmask)) {
         // reset num_src_in_patch to zero to indicate that this block/patch has
         // no work to do
         num_src_in_patch = 0;
@@ -159,7 +232,10 @@ __device__ __inline__ void query_block_dispatcher(
                             shrd_alloc,
                             s_output_offset,
                             s_output_value,
-                            oriented);
+                            oriented,
+                            engine,
+                            s_cached_ev,
+                            s_cached_fe);
 
     if constexpr (op == Op::FV || op == Op::VV || op == Op::FF ||
                   op == Op::EVDiamond) {
@@ -174,6 +250,77 @@ __device__ __inline__ void query_block_dispatcher(
 }
 
 
+/**
+ * @brief same as query_block_dispatcher() but the output of the query is read
+ * from the query cache in global memory (see RXMeshStatic::cache_query)
+ * instead of being computed. Only the participant bitmask is computed in
+ * shared memory. The output owned bitmask and LP hashtable are read from
+ * global memory unless they are cached in shared memory (e.g., by a query
+ * chain)
+ */
+template <Op op, uint32_t blockThreads, typename activeSetT>
+__device__ __inline__ void query_block_cached_dispatcher(
+    cooperative_groups::thread_block& block,
+    ShmemAllocator&                   shrd_alloc,
+    const PatchInfo&                  patch_info,
+    const QueryCacheEntry&            cache,
+    activeSetT                        compute_active_set,
+    uint32_t&                         num_src_in_patch,
+    uint16_t*&                        s_output_offset,
+    uint16_t*&                        s_output_value,
+    uint32_t*&                        s_participant_bitmask,
+    uint32_t*&                        s_output_owned_bitmask,
+    LPHashTable&                      output_lp_hashtable,
+    LPPair*&                          s_table,
+    bool                              allow_not_owned        = false,
+    uint32_t*                         s_cached_owned_bitmask = nullptr,
+    LPPair*                           s_cached_table         = nullptr)
+{
+    uint32_t *input_active_mask, *input_owned_mask;
+    query_source<op>(
+        patch_info, num_src_in_patch, input_active_mask, input_owned_mask);
+
+    alloc_participant_bitmask<blockThreads>(
+        shrd_alloc, num_src_in_patch, s_participant_bitmask);
+
+    if constexpr (op == Op::VV || op == Op::EV || op == Op::FV ||
+                  op == Op::EVDiamond) {
+        s_output_owned_bitmask = patch_info.owned_mask_v;
+        output_lp_hashtable    = patch_info.lp_v;
+    }
+    if constexpr (op == Op::VE || op == Op::EE || op == Op::FE) {
+        s_output_owned_bitmask = patch_info.owned_mask_e;
+        output_lp_hashtable    = patch_info.lp_e;
+    }
+    if constexpr (op == Op::VF || op == Op::EF || op == Op::FF) {
+        s_output_owned_bitmask = patch_info.owned_mask_f;
+        output_lp_hashtable    = patch_info.lp_f;
+    }
+    if (s_cached_owned_bitmask != nullptr) {
+        s_output_owned_bitmask = s_cached_owned_bitmask;
+    }
+    // with no table in shared memory, the iterator uses the global one
+    s_table = s_cached_table;
+
+    if (!set_participant_bitmask<blockThreads>(patch_info,
+                                               compute_active_set,
+                                               num_src_in_patch,
+                                               input_active_mask,
+                                               input_owned_mask,
+                                               allow_not_owned,
+                                               s_participant_bitmask)) {
+        num_src_in_patch = 0;
+        return;
+    }
+
+    const uint32_t p = patch_info.patch_id;
+    s_output_value   = cache.d_value + cache.d_value_start[p];
+    s_output_offset  = (cache.d_offset == nullptr) ?
+                           nullptr :
+                           cache.d_offset + cache.d_offset_start[p];
+}
+
+
 /**
  * query_block_dispatcher()
  */
@@ -228,7 +375,11 @@ __device__ __inline__ void query_block_dispatcher(
                                              s_participant_bitmask,
                                              s_output_owned_bitmask,
                                              output_lp_hashtable,
-                                             s_table);
+                                             s_table,
+                                             false,
+                                             nullptr,
+                                             nullptr,
+                                             QueryEngine::Block);
 
     // Call compute on the output in shared memory by looping over all
     // source elements in this patch.
@@ -324,14 +475,15 @@ __device__ __inline__ void query_block_dispatcher(
     activeSetT                        compute_active_set,
     const bool                        oriented = false)
 {
-    if (blockIdx.x >= context.m_num_patches[0]) {
+    const uint32_t patch_id = context.get_block_patch_id();
+    if (patch_id >= context.m_num_patches[0]) {
         return;
     }
 
     detail::query_block_dispatcher<op, blockThreads>(block,
                                                      shrd_alloc,
                                                      context,
-                                                     blockIdx.x,
+                                                     patch_id,
                                                      compute_op,
                                                      compute_active_set,
                                                      oriented);
@@ -347,12 +499,13 @@ __device__ __inline__ void query_block_dispatcher(const Context& context,
                                                   activeSetT compute_active_set,
                                                   const bool oriented = false)
 {
-    if (blockIdx.x >= context.m_num_patches[0]) {
+    const uint32_t patch_id = context.get_block_patch_id();
+    if (patch_id >= context.m_num_patches[0]) {
         return;
     }
 
     detail::query_block_dispatcher<op, blockThreads>(
-        context, blockIdx.x, compute_op, compute_active_set, oriented);
+        context, patch_id, compute_op, compute_active_set, oriented);
 }
 
 
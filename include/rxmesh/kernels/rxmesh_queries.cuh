@@ -8,6 +8,7 @@
 #include "rxmesh/kernels/dynamic_util.cuh"
 #include "rxmesh/kernels/loader.cuh"
 #include "rxmesh/kernels/util.cuh"
+#include "rxmesh/kernels/warp_queries.cuh"
 #include "rxmesh/types.h"
 
 namespace rxmesh {
@@ -105,6 +106,8 @@ template <uint32_t blockThreads>
 __device__ __forceinline__ void e_v_diamond(
     cooperative_groups::thread_block& block,
     const PatchInfo&                  patch_info,
+    const uint16_t*                   ev,
+    const uint16_t*                   fe,
     ShmemAllocator&                   shrd_alloc,
     uint16_t*&                        s_output_value)
 {
@@ -120,15 +123,11 @@ __device__ __forceinline__ void e_v_diamond(
     }
     block.sync();
 
-    load_async(block,
-               reinterpret_cast<uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               s_fe,
-               true);
+    load_topology(block, fe, 3 * num_faces, s_fe, true);
 
     for (uint16_t e = threadIdx.x; e < num_edges; e += blockThreads) {
-        const uint16_t src = patch_info.ev[2 * e + 0].id;
-        const uint16_t dst = patch_info.ev[2 * e + 1].id;
+        const uint16_t src = ev[2 * e + 0];
+        const uint16_t dst = ev[2 * e + 1];
 
         s_output_value[4 * e + 0] = src;
         s_output_value[4 * e + 2] = dst;
@@ -171,6 +170,7 @@ template <uint32_t blockThreads>
 __device__ __forceinline__ void e_e_manifold(
     cooperative_groups::thread_block& block,
     const PatchInfo&                  patch_info,
+    const uint16_t*                   fe,
     ShmemAllocator&                   shrd_alloc,
     uint16_t*&                        s_output_value)
 {
@@ -194,7 +194,7 @@ __device__ __forceinline__ void e_e_manifold(
             uint16_t f_e[3];
             flag_t   f_dir[3];
             for (int i = 0; i < 3; ++i) {
-                f_e[i] = patch_info.fe[3 * f + i].id;
+                f_e[i] = fe[3 * f + i];
                 Context::unpack_edge_dir(f_e[i], f_e[i], f_dir[i]);
                 assert(f_e[i] < num_edges);
                 assert(!is_deleted(f_e[i], patch_info.active_mask_e));
@@ -273,6 +273,7 @@ __device__ __forceinline__ void e_f_manifold(const uint16_t  num_edges,
 template <uint32_t blockThreads>
 __device__ __forceinline__ void orient_edges_around_vertices(
     const PatchInfo& patch_info,
+    const uint16_t*  fe,
     ShmemAllocator&  shrd_alloc,
     uint16_t*&       s_output_offset,
     uint16_t*&       s_output_value)
@@ -290,10 +291,9 @@ __device__ __forceinline__ void orient_edges_around_vertices(
         s_ef[i] = INVALID16;
     }
 
-    load_async(reinterpret_cast<const uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               reinterpret_cast<uint16_t*>(s_fe),
-               true);
+    cooperative_groups::thread_block block =
+        cooperative_groups::this_thread_block();
+    load_topology(block, fe, 3 * num_faces, s_fe, true);
 
     // We could have used block_mat_transpose to transpose FE so we can look
     // up the "two" faces sharing an edge. But we can do better because we know
@@ -416,6 +416,8 @@ __device__ __forceinline__ void v_e(const uint16_t  num_vertices,
 template <uint32_t blockThreads>
 __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
                                     const PatchInfo& patch_info,
+                                    const uint16_t*  ev,
+                                    const uint16_t*  fe,
                                     ShmemAllocator&  shrd_alloc,
                                     uint16_t*        s_output_offset,
                                     uint16_t*        s_output_value,
@@ -455,18 +457,14 @@ __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
         block.sync();
 
         orient_edges_around_vertices<blockThreads>(
-            patch_info, shrd_alloc, s_output_offset, s_output_value);
+            patch_info, fe, shrd_alloc, s_output_offset, s_output_value);
 
         block.sync();
 
         s_ev_duplicate =
             shrd_alloc.alloc<uint16_t>(2 * patch_info.num_edges[0]);
 
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev_duplicate,
-                   true);
+        load_topology(block, ev, 2 * num_edges, s_ev_duplicate, true);
     }
 
     block.sync();
@@ -645,13 +643,38 @@ __device__ __forceinline__ void f_f(const uint16_t  num_edges,
 }
 
 template <uint32_t blockThreads, Op op>
-__device__ __forceinline__ void query(cooperative_groups::thread_block& block,
-                                      const PatchInfo& patch_info,
-                                      ShmemAllocator&  shrd_alloc,
-                                      uint16_t*&       s_output_offset,
-                                      uint16_t*&       s_output_value,
-                                      bool             oriented)
+__device__ __forceinline__ void query(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    ShmemAllocator&                   shrd_alloc,
+    uint16_t*&                        s_output_offset,
+    uint16_t*&                        s_output_value,
+    bool                              oriented,
+    const QueryEngine                 engine      = QueryEngine::Block,
+    const uint16_t*                   s_cached_ev = nullptr,
+    const uint16_t*                   s_cached_fe = nullptr)
 {
+    // EV and FE are read from the patch unless they are cached in shared
+    // memory (e.g., by a query chain). Either way, they are only read and
+    // every query transposes its own copy
+    const uint16_t* ev = (s_cached_ev != nullptr) ?
+                             s_cached_ev :
+                             reinterpret_cast<const uint16_t*>(patch_info.ev);
+    const uint16_t* fe = (s_cached_fe != nullptr) ?
+                             s_cached_fe :
+                             reinterpret_cast<const uint16_t*>(patch_info.fe);
+
+    if constexpr (op == Op::VV || op == Op::VE || op == Op::VF) {
+        if (engine == QueryEngine::Warp && !oriented) {
+            warp_query<blockThreads, op>(patch_info,
+                                         ev,
+                                         fe,
+                                         shrd_alloc,
+                                         s_output_offset,
+                                         s_output_value);
+            return;
+        }
+    }
 
     if constexpr (op == Op::VV) {
         // assert(patch_info.num_vertices[0] <= 2 * patch_info.num_edges[0]);
@@ -659,15 +682,13 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
             shrd_alloc.alloc<uint16_t>(std::max(patch_info.num_vertices[0] + 1,
                                                 2 * patch_info.num_edges[0]) +
                                        2 * patch_info.num_edges[0]);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * patch_info.num_edges[0],
-                   s_ev,
-                   true);
+        load_topology(block, ev, 2 * patch_info.num_edges[0], s_ev, true);
         s_output_offset = &s_ev[0];
         s_output_value  = &s_ev[patch_info.num_vertices[0] + 1];
         v_v<blockThreads>(block,
                           patch_info,
+                          ev,
+                          fe,
                           shrd_alloc,
                           s_output_offset,
                           s_output_value,
@@ -680,11 +701,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
             shrd_alloc.alloc<uint16_t>(std::max(patch_info.num_vertices[0] + 1,
                                                 2 * patch_info.num_edges[0]) +
                                        2 * patch_info.num_edges[0]);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * patch_info.num_edges[0],
-                   s_ev,
-                   true);
+        load_topology(block, ev, 2 * patch_info.num_edges[0], s_ev, true);
         s_output_offset = s_ev;
         s_output_value  = &s_ev[patch_info.num_vertices[0] + 1];
         v_e<blockThreads>(patch_info.num_vertices[0],
@@ -694,7 +711,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
                           patch_info.active_mask_e);
         if (oriented) {
             orient_edges_around_vertices<blockThreads>(
-                patch_info, shrd_alloc, s_output_offset, s_output_value);
+                patch_info, fe, shrd_alloc, s_output_offset, s_output_value);
         }
     }
 
@@ -704,16 +721,8 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
             3 * patch_info.num_faces[0], 1 + patch_info.num_vertices[0]));
         uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(
             std::max(2 * patch_info.num_edges[0], 3 * patch_info.num_faces[0]));
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * patch_info.num_faces[0],
-                   s_fe,
-                   false);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * patch_info.num_edges[0],
-                   s_ev,
-                   true);
+        load_topology(block, fe, 3 * patch_info.num_faces[0], s_fe, false);
+        load_topology(block, ev, 2 * patch_info.num_edges[0], s_ev, true);
         s_output_offset = &s_fe[0];
         s_output_value  = &s_ev[0];
         v_f<blockThreads>(patch_info.num_faces[0],
@@ -727,22 +736,18 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
     if constexpr (op == Op::EV) {
         s_output_value =
             shrd_alloc.alloc<uint16_t>(2 * patch_info.num_edges[0]);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * patch_info.num_edges[0],
-                   s_output_value,
-                   true);
+        load_topology(block,
+                      ev,
+                      2 * patch_info.num_edges[0],
+                      s_output_value,
+                      true);
     }
 
     if constexpr (op == Op::EF) {
         assert(patch_info.num_edges[0] <= 3 * patch_info.num_faces[0]);
         uint16_t* s_fe =
             shrd_alloc.alloc<uint16_t>(2 * 3 * patch_info.num_faces[0]);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * patch_info.num_faces[0],
-                   s_fe,
-                   true);
+        load_topology(block, fe, 3 * patch_info.num_faces[0], s_fe, true);
         s_output_offset = &s_fe[0];
         s_output_value  = &s_fe[patch_info.num_edges[0] + 1];
         e_f<blockThreads>(patch_info.num_edges[0],
@@ -761,17 +766,9 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         uint16_t* s_ev =
             shrd_alloc.alloc<uint16_t>(2 * patch_info.num_edges[0]);
         s_output_value = s_fe;
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * patch_info.num_edges[0],
-                   s_ev,
-                   false);
-
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * patch_info.num_faces[0],
-                   s_fe,
-                   true);
+        load_topology(block, ev, 2 * patch_info.num_edges[0], s_ev, false);
+
+        load_topology(block, fe, 3 * patch_info.num_faces[0], s_fe, true);
 
         f_v<blockThreads>(patch_info.num_edges[0],
                           s_ev,
@@ -785,11 +782,11 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
     if constexpr (op == Op::FE) {
         s_output_value =
             shrd_alloc.alloc<uint16_t>(3 * patch_info.num_faces[0]);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * patch_info.num_faces[0],
-                   s_output_value,
-                   true);
+        load_topology(block,
+                      fe,
+                      3 * patch_info.num_faces[0],
+                      s_output_value,
+                      true);
     }
 
     if constexpr (op == Op::FF) {
@@ -803,11 +800,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         uint16_t* s_ef =
             shrd_alloc.alloc<uint16_t>(2 * 3 * patch_info.num_faces[0]);
 
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * patch_info.num_faces[0],
-                   s_fe,
-                   true);
+        load_topology(block, fe, 3 * patch_info.num_faces[0], s_fe, true);
 
         f_f<blockThreads>(patch_info.num_edges[0],
                           patch_info.num_faces[0],
@@ -823,12 +816,12 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
 
     if constexpr (op == Op::EVDiamond) {
         e_v_diamond<blockThreads>(
-            block, patch_info, shrd_alloc, s_output_value);
+            block, patch_info, ev, fe, shrd_alloc, s_output_value);
     }
 
     if constexpr (op == Op::EE) {
         e_e_manifold<blockThreads>(
-            block, patch_info, shrd_alloc, s_output_value);
+            block, patch_info, fe, shrd_alloc, s_output_value);
     }
 }
 
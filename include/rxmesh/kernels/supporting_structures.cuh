@@ -0,0 +1,187 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief build the half-edges of all faces where every half-edge stores its
+ * edge key (see edge_key()) packed in 64-bit and its id (3 * face_id + local
+ * index)
+ */
+__global__ static void init_half_edges(const uint32_t  num_faces,
+                                       const uint32_t* d_fv,
+                                       uint64_t*       d_he_key,
+                                       uint32_t*       d_he_id)
+{
+    const uint32_t num_he = 3 * num_faces;
+    uint32_t       tid    = threadIdx.x + blockIdx.x * blockDim.x;
+    while (tid < num_he) {
+        const uint32_t f  = tid / 3;
+        const uint32_t v  = tid % 3;
+        const uint32_t v0 = d_fv[3 * f + v];
+        const uint32_t v1 = d_fv[3 * f + (v + 1) % 3];
+        const uint32_t i  = max(v0, v1);
+        const uint32_t j  = min(v0, v1);
+
+        d_he_key[tid] = (uint64_t(i) << 32) | uint64_t(j);
+        d_he_id[tid]  = tid;
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief given half-edges sorted by their keys, mark the head of every run of
+ * equal keys. The head is the first half-edge (in face order) of an edge since
+ * the sort is stable. d_is_first is indexed by the half-edge id while
+ * d_run_head is indexed by the sorted position and stores the position of the
+ * head (or zero if it is not a head)
+ */
+__global__ static void mark_edge_heads(const uint32_t  num_he,
+                                       const uint64_t* d_sorted_key,
+                                       const uint32_t* d_sorted_id,
+                                       uint32_t*       d_is_first,
+                                       uint32_t*       d_run_head)
+{
+    uint32_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+    while (tid < num_he) {
+        const bool is_head =
+            (tid == 0) || (d_sorted_key[tid] != d_sorted_key[tid - 1]);
+        d_run_head[tid]              = is_head ? tid : 0;
+        d_is_first[d_sorted_id[tid]] = is_head ? 1 : 0;
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief assign the edge id to every half-edges and compute the number of
+ * faces incident to every edge along with the edge's two vertices
+ */
+__global__ static void assign_edge_ids(const uint32_t  num_he,
+                                       const uint64_t* d_sorted_key,
+                                       const uint32_t* d_sorted_id,
+                                       const uint32_t* d_run_head,
+                                       const uint32_t* d_first_id,
+                                       uint32_t*       d_he_edge,
+                                       uint32_t*       d_ef_size,
+                                       uint32_t*       d_edges)
+{
+    uint32_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+    while (tid < num_he) {
+        const uint32_t head    = d_run_head[tid];
+        const uint32_t edge_id = d_first_id[d_sorted_id[head]];
+
+        d_he_edge[d_sorted_id[tid]] = edge_id;
+
+        if (head == tid) {
+            d_edges[2 * edge_id]     = uint32_t(d_sorted_key[tid] >> 32);
+            d_edges[2 * edge_id + 1] = uint32_t(d_sorted_key[tid]);
+        }
+
+        if (tid + 1 == num_he || d_run_head[tid + 1] != head) {
+            d_ef_size[edge_id] = tid - head + 1;
+        }
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief write the edge incident faces in compressed format. Faces of an edge
+ * are sorted since half-edges with equal key are sorted by their id
+ */
+__global__ static void populate_ef(const uint32_t  num_he,
+                                   const uint32_t* d_sorted_id,
+                                   const uint32_t* d_run_head,
+                                   const uint32_t* d_he_edge,
+                                   const uint32_t* d_ef_offset,
+                                   uint32_t*       d_ef_values)
+{
+    uint32_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+    while (tid < num_he) {
+        const uint32_t he      = d_sorted_id[tid];
+        const uint32_t edge_id = d_he_edge[he];
+        const uint32_t start   = (edge_id == 0) ? 0 : d_ef_offset[edge_id - 1];
+
+        d_ef_values[start + tid - d_run_head[tid]] = he / 3;
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief count the number of face adjacent faces
+ */
+__global__ static void count_ff(const uint32_t  num_faces,
+                                const uint32_t* d_he_edge,
+                                const uint32_t* d_ef_size,
+                                uint32_t*       d_ff_size)
+{
+    uint32_t f = threadIdx.x + blockIdx.x * blockDim.x;
+    while (f < num_faces) {
+        uint32_t count = 0;
+        for (uint32_t v = 0; v < 3; ++v) {
+            count += d_ef_size[d_he_edge[3 * f + v]] - 1;
+        }
+        d_ff_size[f] = count;
+        f += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief write the face adjacent faces in compressed format. For every face,
+ * its edges are processed in increasing id order and the adjacent faces of
+ * every edge are written in increasing order which produces the same ff as
+ * the host-side RXMesh::build_supporting_structures
+ */
+__global__ static void populate_ff(const uint32_t  num_faces,
+                                   const uint32_t* d_he_edge,
+                                   const uint32_t* d_ef_offset,
+                                   const uint32_t* d_ef_values,
+                                   const uint32_t* d_ff_offset,
+                                   uint32_t*       d_ff_values)
+{
+    uint32_t f = threadIdx.x + blockIdx.x * blockDim.x;
+    while (f < num_faces) {
+        uint32_t e[3] = {
+            d_he_edge[3 * f], d_he_edge[3 * f + 1], d_he_edge[3 * f + 2]};
+
+        // sort three items
+        if (e[0] > e[1]) {
+            uint32_t t = e[0];
+            e[0]       = e[1];
+            e[1]       = t;
+        }
+        if (e[1] > e[2]) {
+            uint32_t t = e[1];
+            e[1]       = e[2];
+            e[2]       = t;
+        }
+        if (e[0] > e[1]) {
+            uint32_t t = e[0];
+            e[0]       = e[1];
+            e[1]       = t;
+        }
+
+        uint32_t offset = (f == 0) ? 0 : d_ff_offset[f - 1];
+        for (uint32_t i = 0; i < 3; ++i) {
+            const uint32_t e_start = (e[i] == 0) ? 0 : d_ef_offset[e[i] - 1];
+            const uint32_t e_end   = d_ef_offset[e[i]];
+
+            bool skipped = false;
+            for (uint32_t k = e_start; k < e_end; ++k) {
+                const uint32_t n = d_ef_values[k];
+                if (n == f && !skipped) {
+                    skipped = true;
+                    continue;
+                }
+                d_ff_values[offset++] = n;
+            }
+        }
+        f += blockDim.x * gridDim.x;
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
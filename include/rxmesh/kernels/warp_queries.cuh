@@ -0,0 +1,195 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/kernels/collective.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/patch_info.h"
+#include "rxmesh/types.h"
+#include "rxmesh/util/bitmask_util.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief bitmask of the lanes of the calling warp that hold the same key.
+ * Should be called by the whole warp
+ */
+__device__ __forceinline__ uint32_t warp_match(const uint16_t key)
+{
+#if __CUDA_ARCH__ >= 700
+    return __match_any_sync(0xFFFFFFFF, uint32_t(key));
+#else
+    return 1u << (threadIdx.x % 32);
+#endif
+}
+
+/**
+ * @brief increment counter[key] once per lane that holds key where lanes of
+ * the warp with the same key are grouped such that only one atomic is issued
+ * per key. Returns the value of counter[key] before the increment plus the
+ * rank of the lane among the lanes with the same key. Lanes with key equal
+ * to INVALID16 do not increment anything. Should be called by the whole warp
+ */
+__device__ __forceinline__ uint16_t warp_aggregated_inc(uint16_t*      counter,
+                                                        const uint16_t key)
+{
+    const uint32_t lane_id = threadIdx.x % 32;
+    const uint32_t peers   = warp_match(key);
+    const uint32_t leader  = __ffs(peers) - 1;
+
+    uint32_t base = 0;
+    if (key != INVALID16 && lane_id == leader) {
+        base = atomicAdd(counter + key, uint16_t(__popc(peers)));
+    }
+    base = __shfl_sync(0xFFFFFFFF, base, leader);
+
+    return uint16_t(base + __popc(peers & ((1u << lane_id) - 1)));
+}
+
+/**
+ * @brief transpose a sparse matrix with a fixed number of non-zeros per row
+ * (rowOffset) that lives in global memory. col_of(id) returns the column of
+ * the id-th non-zero (or INVALID16). Instead of loading the matrix in shared
+ * memory and keeping itemPerThread non-zeros in registers (as
+ * block_mat_transpose does), every warp goes over tiles of 32 consecutive
+ * non-zeros and lanes that hit the same column are grouped with
+ * __match_any_sync such that a single atomic is done per column per tile.
+ * Only the output lives in shared memory: s_offset (num_cols + 2) holds the
+ * CSR offsets and s_value (num_rows * rowOffset) holds the row ids. The order
+ * of the rows within a column is not defined
+ */
+template <uint32_t rowOffset, uint32_t blockThreads, typename colT>
+__device__ __forceinline__ void warp_mat_transpose(
+    const uint32_t  num_rows,
+    const uint32_t  num_cols,
+    const uint32_t* row_active_mask,
+    colT            col_of,
+    uint16_t*       s_offset,
+    uint16_t*       s_value)
+{
+    static_assert(blockThreads % 32 == 0,
+                  "warp_mat_transpose() needs blockThreads to be a multiple "
+                  "of 32");
+
+    const uint32_t nnz     = num_rows * rowOffset;
+    const uint32_t lane_id = threadIdx.x % 32;
+    const uint32_t tile    = threadIdx.x - lane_id;
+
+    auto get_col = [&](const uint32_t id) -> uint16_t {
+        if (id >= nnz || is_deleted(id / rowOffset, row_active_mask)) {
+            return INVALID16;
+        }
+        return col_of(id);
+    };
+
+    // 1) count the non-zeros of column c in s_offset[c + 1] so the exclusive
+    // sum turns s_offset[c + 1] into the start of c and the scatter (which
+    // increment it) turns it into the start of c + 1
+    for (uint32_t i = threadIdx.x; i < num_cols + 2; i += blockThreads) {
+        s_offset[i] = 0;
+    }
+    __syncthreads();
+
+    for (uint32_t t = tile; t < nnz; t += blockThreads) {
+        warp_aggregated_inc(s_offset + 1, get_col(t + lane_id));
+    }
+    __syncthreads();
+
+    // 2) exclusive scan to compute the offset
+    cub_block_exclusive_sum<uint16_t, blockThreads>(s_offset, num_cols + 1);
+    __syncthreads();
+
+    // 3) scatter the row ids
+    for (uint32_t t = tile; t < nnz; t += blockThreads) {
+        const uint32_t id  = t + lane_id;
+        const uint16_t col = get_col(id);
+        const uint16_t pos = warp_aggregated_inc(s_offset + 1, col);
+        if (col != INVALID16) {
+            s_value[pos] = id / rowOffset;
+        }
+    }
+    __syncthreads();
+}
+
+/**
+ * @brief VV, VE, and VF using warp_mat_transpose where EV and FE (ev and fe)
+ * are read directly instead of being loaded first. They are either the patch
+ * topology in global memory or a copy of it in shared memory. The output is
+ * in the same format as the block engine (see query()). The output offset and
+ * value are allocated here. Used for non-oriented queries when the kernel is
+ * launched with QueryEngine::Warp
+ */
+template <uint32_t blockThreads, Op op>
+__device__ __forceinline__ void warp_query(const PatchInfo& patch_info,
+                                           const uint16_t*  ev,
+                                           const uint16_t*  fe,
+                                           ShmemAllocator&  shrd_alloc,
+                                           uint16_t*&       s_output_offset,
+                                           uint16_t*&       s_output_value)
+{
+    static_assert(op == Op::VV || op == Op::VE || op == Op::VF,
+                  "warp_query() only supports Op::VV, Op::VE, and Op::VF");
+
+    const uint16_t num_vertices = patch_info.num_vertices[0];
+    const uint16_t num_edges    = patch_info.num_edges[0];
+    const uint16_t num_faces    = patch_info.num_faces[0];
+
+    s_output_offset = shrd_alloc.alloc<uint16_t>(num_vertices + 2);
+
+    if constexpr (op == Op::VV || op == Op::VE) {
+        s_output_value = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+
+        warp_mat_transpose<2u, blockThreads>(
+            num_edges,
+            num_vertices,
+            patch_info.active_mask_e,
+            [&](const uint32_t id) { return ev[id]; },
+            s_output_offset,
+            s_output_value);
+    }
+
+    if constexpr (op == Op::VV) {
+        // replace every edge by its other end vertex
+        for (uint32_t v = threadIdx.x; v < num_vertices; v += blockThreads) {
+            const uint32_t start = s_output_offset[v];
+            const uint32_t end   = s_output_offset[v + 1];
+
+            for (uint32_t e = start; e < end; ++e) {
+                const uint16_t edge = s_output_value[e];
+                const uint16_t v0   = ev[2 * edge];
+                const uint16_t v1   = ev[2 * edge + 1];
+
+                assert(v0 == v || v1 == v);
+                s_output_value[e] = (v0 == v) * v1 + (v1 == v) * v0;
+            }
+        }
+        __syncthreads();
+    }
+
+    if constexpr (op == Op::VF) {
+        s_output_value = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+
+        // M_vf = M_fv^{T} where M_fv is computed on the fly from FE and EV
+        warp_mat_transpose<3u, blockThreads>(
+            num_faces,
+            num_vertices,
+            patch_info.active_mask_f,
+            [&](const uint32_t id) -> uint16_t {
+                uint16_t e = fe[id];
+                if (e == INVALID16) {
+                    return INVALID16;
+                }
+                flag_t e_dir(0);
+                Context::unpack_edge_dir(e, e, e_dir);
+                return ev[2 * e + e_dir];
+            },
+            s_output_offset,
+            s_output_value);
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
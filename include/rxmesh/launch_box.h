@@ -1,6 +1,8 @@
 #pragma once
 #include <stdint.h>
 
+#include "rxmesh/types.h"
+
 namespace rxmesh {
 
 /**
@@ -8,11 +10,26 @@ namespace rxmesh {
  * CUDA blocks and threads, dynamic shared memory. These parameters are meant to
  * be calculated by RXMeshStatic and then used by the user to launch kernels
  */
-template <uint32_t blockThreads>
+template <uint32_t blockThreads, QueryEngine queryEngine = QueryEngine::Block>
 struct LaunchBox
 {
+    static constexpr uint32_t block_threads = blockThreads;
+
+    // the engine of the transpose queries which the shared memory computed by
+    // RXMeshStatic::prepare_launch_box depends on. It should match the engine
+    // of the Query used by the kernel (see Query)
+    static constexpr QueryEngine query_engine = queryEngine;
+
     uint32_t       blocks, num_registers_per_thread;
     size_t         smem_bytes_dyn, smem_bytes_static;
     const uint32_t num_threads = blockThreads;
+    // the occupancy (number of blocks per SM) as calculated by
+    // RXMeshStatic::prepare_launch_box
+    uint32_t num_blocks_per_sm = 0;
+    // if false, RXMeshStatic::prepare_launch_box does not exit when the kernel
+    // can not be launched (i.e., it needs too much shared memory or registers)
+    // and instead sets num_blocks_per_sm to zero. Used by LaunchPlanner to
+    // skip such configurations
+    bool exit_on_failure = true;
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rxmesh/launch_box.h"
+#include "rxmesh/rxmesh.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+#include "rxmesh/util/timer.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a launch configuration selected by LaunchPlanner along with the
+ * function that launches the kernel with this configuration
+ */
+struct LaunchPlan
+{
+    uint32_t              block_threads            = 0;
+    uint32_t              blocks                   = 0;
+    size_t                smem_bytes_dyn           = 0;
+    size_t                smem_bytes_static        = 0;
+    uint32_t              num_registers_per_thread = 0;
+    uint32_t              num_blocks_per_sm        = 0;
+    float                 time_ms                  = 0;
+    bool                  from_cache               = false;
+    std::function<void()> launch;
+
+    /**
+     * @brief launch the kernel with the selected configuration
+     */
+    void operator()() const
+    {
+        launch();
+    }
+
+    bool is_valid() const
+    {
+        return block_threads != 0 && bool(launch);
+    }
+};
+
+/**
+ * @brief select the block size (i.e., blockThreads) of a kernel for the
+ * current GPU and mesh. Since blockThreads is a template parameter, every
+ * candidate block size is a separate instantiation of the kernel which is
+ * passed to plan() as a list of template arguments. For every candidate, a
+ * factory prepares the LaunchBox (e.g., by calling
+ * RXMeshStatic::prepare_launch_box) and returns a function that launches the
+ * kernel with it. Candidates that can not be launched (too much shared memory
+ * or registers) are skipped. The remaining candidates are timed for a few
+ * trials and the fastest one is selected. If the number of trials is zero,
+ * the candidate with the highest occupancy (resident threads per SM) is
+ * selected instead without launching the kernel. The selected block size is
+ * cached (in memory and on disk) per kernel name, GPU, and mesh so the tuning
+ * is only done the first time
+ *
+ * Example
+ * \code{.cpp}
+ * LaunchPlanner planner;
+ * LaunchPlan plan = planner.plan<128, 256, 512>(
+ *     rx, "my_kernel", [&](auto& lb) {
+ *         constexpr uint32_t B = std::decay_t<decltype(lb)>::block_threads;
+ *         rx.prepare_launch_box({Op::VV}, lb, (void*)my_kernel<B>);
+ *         return [&, lb]() {
+ *             my_kernel<B><<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+ *                 rx.get_context(), ...);
+ *         };
+ *     });
+ * plan();
+ * \endcode
+ * Note that the kernel is launched (num_warmup + num_trials) times for every
+ * candidate while tuning and so the kernel should either be idempotent or the
+ * output should be reset after plan()
+ */
+class LaunchPlanner
+{
+   public:
+    /**
+     * @brief constructor
+     * @param cache_file the file where the selected configurations are stored.
+     * If empty, the configurations are only cached in memory
+     * @param num_trials number of timed launches per candidate. If zero, the
+     * candidates are ranked by their occupancy
+     * @param num_warmup number of launches per candidate before timing
+     */
+    LaunchPlanner(const std::string& cache_file = default_cache_file(),
+                  const uint32_t     num_trials = 5,
+                  const uint32_t     num_warmup = 1)
+        : m_cache_file(cache_file),
+          m_num_trials(num_trials),
+          m_num_warmup(num_warmup)
+    {
+        load();
+    }
+
+    /**
+     * @brief the default cache file which is either the value of the
+     * environment variable RXMESH_LAUNCH_CACHE or launch_cache.txt in the
+     * output folder
+     */
+    static std::string default_cache_file()
+    {
+        const char* env = std::getenv("RXMESH_LAUNCH_CACHE");
+        if (env != nullptr) {
+            return std::string(env);
+        }
+        return std::string(STRINGIFY(OUTPUT_DIR)) + "launch_cache.txt";
+    }
+
+    /**
+     * @brief select the block size among blockThreads for a kernel
+     * @tparam blockThreads the candidate block sizes
+     * @param rx the mesh the kernel runs on
+     * @param name the kernel name which identifies it in the cache
+     * @param factory a (generic) lambda function that takes a
+     * LaunchBox<blockThreads>& for every candidate, prepares it, and returns a
+     * function that takes no arguments and launches the kernel
+     * @return the selected configuration. If none of the candidates can be
+     * launched, the function exits
+     */
+    template <uint32_t... blockThreads, typename FactoryT>
+    LaunchPlan plan(const RXMesh&      rx,
+                    const std::string& name,
+                    FactoryT           factory)
+    {
+        static_assert(sizeof...(blockThreads) > 0,
+                      "LaunchPlanner::plan() needs at least one candidate");
+
+        std::vector<LaunchPlan> candidates;
+        (add_candidate<blockThreads>(candidates, factory), ...);
+
+        if (candidates.empty()) {
+            RXMESH_ERROR(
+                "LaunchPlanner::plan() none of the candidate block sizes of {} "
+                "can be launched on the current device",
+                name);
+            exit(EXIT_FAILURE);
+        }
+
+        const std::string key = cache_key(rx, name);
+
+        auto cached = m_cache.find(key);
+        if (cached != m_cache.end()) {
+            for (auto& c : candidates) {
+                if (c.block_threads == cached->second.block_threads) {
+                    c.time_ms    = cached->second.time_ms;
+                    c.from_cache = true;
+                    RXMESH_TRACE(
+                        "LaunchPlanner::plan() {} uses the cached block size "
+                        "{}",
+                        name,
+                        c.block_threads);
+                    return c;
+                }
+            }
+        }
+
+        uint32_t best = 0;
+        if (candidates.size() > 1) {
+            if (m_num_trials == 0) {
+                best = most_occupant(candidates);
+            } else {
+                best = fastest(candidates, name);
+            }
+        }
+
+        RXMESH_INFO(
+            "LaunchPlanner::plan() selected block size {} for {} ({} blocks/SM"
+            ", {} ms)",
+            candidates[best].block_threads,
+            name,
+            candidates[best].num_blocks_per_sm,
+            candidates[best].time_ms);
+
+        m_cache[key] = {candidates[best].block_threads,
+                        candidates[best].time_ms};
+        save();
+
+        return candidates[best];
+    }
+
+    /**
+     * @brief remove all cached configurations (from memory and disk)
+     */
+    void clear()
+    {
+        m_cache.clear();
+        if (!m_cache_file.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(m_cache_file, ec);
+        }
+    }
+
+    const std::string& get_cache_file() const
+    {
+        return m_cache_file;
+    }
+
+   private:
+    struct Entry
+    {
+        uint32_t block_threads;
+        float    time_ms;
+    };
+
+    template <uint32_t blockThreads, typename FactoryT>
+    void add_candidate(std::vector<LaunchPlan>& candidates, FactoryT& factory)
+    {
+        LaunchBox<blockThreads> lb;
+        lb.exit_on_failure = false;
+
+        LaunchPlan c;
+        c.launch = factory(lb);
+
+        if (lb.num_blocks_per_sm == 0) {
+            RXMESH_TRACE(
+                "LaunchPlanner::add_candidate() skipping block size {} since "
+                "it can not be launched",
+                blockThreads);
+            return;
+        }
+
+        c.block_threads            = blockThreads;
+        c.blocks                   = lb.blocks;
+        c.smem_bytes_dyn           = lb.smem_bytes_dyn;
+        c.smem_bytes_static        = lb.smem_bytes_static;
+        c.num_registers_per_thread = lb.num_registers_per_thread;
+        c.num_blocks_per_sm        = lb.num_blocks_per_sm;
+        candidates.push_back(c);
+    }
+
+    uint32_t most_occupant(const std::vector<LaunchPlan>& candidates) const
+    {
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < candidates.size(); ++i) {
+            const uint32_t occ =
+                candidates[i].num_blocks_per_sm * candidates[i].block_threads;
+            const uint32_t best_occ = candidates[best].num_blocks_per_sm *
+                                      candidates[best].block_threads;
+            if (occ > best_occ) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    uint32_t fastest(std::vector<LaunchPlan>& candidates,
+                     const std::string&       name) const
+    {
+        uint32_t best = 0;
+        for (uint32_t i = 0; i < candidates.size(); ++i) {
+            for (uint32_t w = 0; w < m_num_warmup; ++w) {
+                candidates[i]();
+            }
+            CUDA_ERROR(cudaDeviceSynchronize());
+
+            // the min over the trials is the least noisy
+            float t = std::numeric_limits<float>::max();
+            for (uint32_t r = 0; r < m_num_trials; ++r) {
+                GPUTimer timer;
+                timer.start();
+                candidates[i]();
+                timer.stop();
+                t = std::min(t, timer.elapsed_millis());
+            }
+            CUDA_ERROR(cudaGetLastError());
+            candidates[i].time_ms = t;
+
+            RXMESH_TRACE("LaunchPlanner::fastest() {} with block size {} took "
+                         "{} (ms) with {} blocks/SM",
+                         name,
+                         candidates[i].block_threads,
+                         t,
+                         candidates[i].num_blocks_per_sm);
+
+            if (i == 0 || t < candidates[best].time_ms) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    std::string cache_key(const RXMesh& rx, const std::string& name) const
+    {
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp dev_prop;
+        CUDA_ERROR(cudaGetDeviceProperties(&dev_prop, device_id));
+
+        // the per-patch sizes determine the shared memory and the number of
+        // patches determine the grid size
+        std::stringstream ss;
+        ss << name << "|" << dev_prop.name << "|sm_" << dev_prop.major
+           << dev_prop.minor << "|" << rx.get_num_vertices() << "_"
+           << rx.get_num_edges() << "_" << rx.get_num_faces() << "_"
+           << rx.get_num_patches() << "_" << rx.get_per_patch_max_vertices()
+           << "_" << rx.get_per_patch_max_edges() << "_"
+           << rx.get_per_patch_max_faces();
+        return ss.str();
+    }
+
+    void load()
+    {
+        if (m_cache_file.empty()) {
+            return;
+        }
+        std::ifstream file(m_cache_file);
+        if (!file.is_open()) {
+            return;
+        }
+        // every line is key \t block_threads \t time_ms
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            std::string       key, bt, t;
+            if (std::getline(ss, key, '\t') && std::getline(ss, bt, '\t') &&
+                std::getline(ss, t, '\t')) {
+                try {
+                    m_cache[key] = {uint32_t(std::stoul(bt)), std::stof(t)};
+                } catch (const std::exception&) {
+                    RXMESH_WARN(
+                        "LaunchPlanner::load() skipping malformed line in {}",
+                        m_cache_file);
+                }
+            }
+        }
+    }
+
+    void save() const
+    {
+        if (m_cache_file.empty()) {
+            return;
+        }
+        const std::filesystem::path path(m_cache_file);
+        if (path.has_parent_path()) {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+        std::ofstream file(m_cache_file);
+        if (!file.is_open()) {
+            RXMESH_WARN("LaunchPlanner::save() can not write the cache file {}",
+                        m_cache_file);
+            return;
+        }
+        for (const auto& it : m_cache) {
+            file << it.first << "\t" << it.second.block_threads << "\t"
+                 << it.second.time_ms << "\n";
+        }
+    }
+
+    std::string                  m_cache_file;
+    uint32_t                     m_num_trials;
+    uint32_t                     m_num_warmup;
+    std::map<std::string, Entry> m_cache;
+};
+}  // namespace rxmesh
@@ -70,17 +70,21 @@ struct LPHashTable
 
     /**
      * @brief Constructor using the hash table capacity.This is used as
-     * allocation size
+     * allocation size. If is_managed is true, the device table is allocated as
+     * managed memory (see PatchResidency)
      */
-    explicit LPHashTable(const uint16_t capacity, bool is_on_device)
+    explicit LPHashTable(const uint16_t capacity,
+                         bool           is_on_device,
+                         bool           is_managed = false)
         : m_capacity(std::max(capacity, uint16_t(2))),
           m_is_on_device(is_on_device)
     {
         m_capacity = find_next_prime_number(m_capacity);
         if (m_is_on_device) {
-            CUDA_ERROR(cudaMalloc((void**)&m_table, num_bytes()));
             CUDA_ERROR(
-                cudaMalloc((void**)&m_stash, stash_size * sizeof(LPPair)));
+                device_malloc((void**)&m_table, num_bytes(), is_managed));
+            CUDA_ERROR(device_malloc(
+                (void**)&m_stash, stash_size * sizeof(LPPair), is_managed));
 
             std::vector<LPPair> temp(stash_size, LPPair::sentinel_pair());
             CUDA_ERROR(cudaMemcpy(m_stash,
@@ -0,0 +1,628 @@
+#pragma once
+#include <algorithm>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/context.h"
+#include "rxmesh/launch_box.h"
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/sparse_matrix_kernels.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/types.h"
+
+#include <cub/device/device_scan.cuh>
+
+namespace rxmesh {
+
+namespace detail {
+
+template <typename T, int B, uint32_t blockThreads, typename LambdaT>
+__global__ static void bsr_assemble(const Context context,
+                                    const int*    row_ptr,
+                                    const int*    col_idx,
+                                    T*            val,
+                                    LambdaT       block_func)
+{
+    // the first block of every row is the diagonal one followed by the VV
+    // neighbors sorted by their column (see sparse_mat_sort_rows). The order
+    // of the query is not defined so the block of every neighbor is found by
+    // searching the row
+    auto write = [&](const int k, const glm::mat<B, B, T>& m) {
+        for (int r = 0; r < B; ++r) {
+            for (int c = 0; c < B; ++c) {
+                val[k * B * B + r * B + c] = m[c][r];
+            }
+        }
+    };
+
+    auto assemble = [&](VertexHandle& v_id, const VertexIterator& iter) {
+        auto      ids = v_id.unpack();
+        const int row = context.vertex_prefix()[ids.first] + ids.second;
+        const int k   = row_ptr[row];
+
+        write(k, block_func(v_id, v_id));
+        for (uint32_t v = 0; v < iter.size(); ++v) {
+            auto      s_ids = iter[v].unpack();
+            const int col =
+                context.vertex_prefix()[s_ids.first] + s_ids.second;
+            write(sparse_mat_find_sorted_slot(row_ptr, col_idx, row, col),
+                  block_func(v_id, iter[v]));
+        }
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, assemble);
+}
+
+template <typename T, int B>
+__global__ static void bsr_multiply(const int            num_block_rows,
+                                    const int*           row_ptr,
+                                    const int*           col_idx,
+                                    const T*             val,
+                                    const int            num_vec,
+                                    const DenseMatrix<T> x,
+                                    DenseMatrix<T>       y)
+{
+    const int size = num_block_rows * num_vec;
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+        const int row = i % num_block_rows;
+        const int vec = i / num_block_rows;
+
+        T sum[B];
+        for (int r = 0; r < B; ++r) {
+            sum[r] = 0;
+        }
+
+        for (int k = row_ptr[row]; k < row_ptr[row + 1]; ++k) {
+            const int col = col_idx[k];
+            T         xc[B];
+            for (int c = 0; c < B; ++c) {
+                xc[c] = x(col, vec * B + c);
+            }
+            const T* blk = val + k * B * B;
+            for (int r = 0; r < B; ++r) {
+                for (int c = 0; c < B; ++c) {
+                    sum[r] += blk[r * B + c] * xc[c];
+                }
+            }
+        }
+
+        for (int r = 0; r < B; ++r) {
+            y(row, vec * B + r) = sum[r];
+        }
+    }
+}
+
+template <typename T, int B>
+__global__ static void bsr_invert_diagonal(const int  num_block_rows,
+                                           const int* row_ptr,
+                                           const T*   val,
+                                           T*         inv_diag)
+{
+    for (int row = blockIdx.x * blockDim.x + threadIdx.x;
+         row < num_block_rows;
+         row += blockDim.x * gridDim.x) {
+        // Gauss-Jordan elimination with partial pivoting in registers
+        T        a[B][B];
+        T        inv[B][B];
+        const T* blk = val + row_ptr[row] * B * B;
+        for (int r = 0; r < B; ++r) {
+            for (int c = 0; c < B; ++c) {
+                a[r][c]   = blk[r * B + c];
+                inv[r][c] = (r == c) ? T(1) : T(0);
+            }
+        }
+
+        for (int c = 0; c < B; ++c) {
+            int p = c;
+            for (int r = c + 1; r < B; ++r) {
+                if (fabs(a[r][c]) > fabs(a[p][c])) {
+                    p = r;
+                }
+            }
+            if (p != c) {
+                for (int j = 0; j < B; ++j) {
+                    T t       = a[c][j];
+                    a[c][j]   = a[p][j];
+                    a[p][j]   = t;
+                    t         = inv[c][j];
+                    inv[c][j] = inv[p][j];
+                    inv[p][j] = t;
+                }
+            }
+            const T d = (a[c][c] != T(0)) ? T(1) / a[c][c] : T(0);
+            for (int j = 0; j < B; ++j) {
+                a[c][j] *= d;
+                inv[c][j] *= d;
+            }
+            for (int r = 0; r < B; ++r) {
+                if (r != c) {
+                    const T f = a[r][c];
+                    for (int j = 0; j < B; ++j) {
+                        a[r][j] -= f * a[c][j];
+                        inv[r][j] -= f * inv[c][j];
+                    }
+                }
+            }
+        }
+
+        T* out = inv_diag + row * B * B;
+        for (int r = 0; r < B; ++r) {
+            for (int c = 0; c < B; ++c) {
+                out[r * B + c] = inv[r][c];
+            }
+        }
+    }
+}
+
+template <typename T, int B>
+__global__ static void bsr_apply_block_diagonal(
+    const int            num_block_rows,
+    const T*             inv_diag,
+    const int            num_vec,
+    const DenseMatrix<T> x,
+    DenseMatrix<T>       y)
+{
+    const int size = num_block_rows * num_vec;
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+        const int row = i % num_block_rows;
+        const int vec = i / num_block_rows;
+
+        T xc[B];
+        for (int c = 0; c < B; ++c) {
+            xc[c] = x(row, vec * B + c);
+        }
+        const T* blk = inv_diag + row * B * B;
+        for (int r = 0; r < B; ++r) {
+            T sum = 0;
+            for (int c = 0; c < B; ++c) {
+                sum += blk[r * B + c] * xc[c];
+            }
+            y(row, vec * B + r) = sum;
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief Block sparse matrix (BSR) that represents the VV connectivity where
+ * every non-zero entry is a dense BxB block e.g., the 3x3 blocks of a
+ * per-vertex vector system (ARAP, XPBD, etc). It has the same sparsity pattern
+ * as SparseMatrix but the row pointer and column index are stored once per
+ * block instead of once per scalar entry (B^2 less index metadata). The
+ * blocks are stored row-major and contiguously. The first block of every
+ * block row is the diagonal block. Vectors are DenseMatrix with one row per
+ * vertex and B columns per vector i.e., the columns [v*B, (v+1)*B) of X are
+ * the v-th vector. The matrix is accessible on both host and device and can
+ * be passed by value to kernels (call release() to free the memory)
+ */
+template <typename T, int B = 3>
+struct BlockSparseMatrix
+{
+    using IndexT = int;
+
+    static_assert(B > 0, "BlockSparseMatrix block size should be positive");
+
+    BlockSparseMatrix(const RXMeshStatic& rx)
+        : m_d_row_ptr(nullptr),
+          m_d_col_idx(nullptr),
+          m_d_val(nullptr),
+          m_h_row_ptr(nullptr),
+          m_h_col_idx(nullptr),
+          m_h_val(nullptr),
+          m_d_inv_diag(nullptr),
+          m_num_block_rows(0),
+          m_nnz_blocks(0),
+          m_context(rx.get_context()),
+          m_allocated(LOCATION_NONE)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        m_num_block_rows = rx.get_num_vertices();
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_row_ptr,
+                              (m_num_block_rows + 1) * sizeof(IndexT)));
+        CUDA_ERROR(cudaMemset(
+            m_d_row_ptr, 0, (m_num_block_rows + 1) * sizeof(IndexT)));
+
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box({Op::VV},
+                              launch_box,
+                              (void*)detail::sparse_mat_prescan<blockThreads>);
+
+        detail::sparse_mat_prescan<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(m_context, m_d_row_ptr);
+
+        void*  d_cub_temp_storage = nullptr;
+        size_t temp_storage_bytes = 0;
+        cub::DeviceScan::ExclusiveSum(d_cub_temp_storage,
+                                      temp_storage_bytes,
+                                      m_d_row_ptr,
+                                      m_d_row_ptr,
+                                      m_num_block_rows + 1);
+        CUDA_ERROR(cudaMalloc((void**)&d_cub_temp_storage, temp_storage_bytes));
+        cub::DeviceScan::ExclusiveSum(d_cub_temp_storage,
+                                      temp_storage_bytes,
+                                      m_d_row_ptr,
+                                      m_d_row_ptr,
+                                      m_num_block_rows + 1);
+        CUDA_ERROR(cudaFree(d_cub_temp_storage));
+
+        CUDA_ERROR(cudaMemcpy(&m_nnz_blocks,
+                              m_d_row_ptr + m_num_block_rows,
+                              sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_col_idx, m_nnz_blocks * sizeof(IndexT)));
+        rx.prepare_launch_box({Op::VV},
+                              launch_box,
+                              (void*)detail::sparse_mat_col_fill<blockThreads>);
+
+        detail::sparse_mat_col_fill<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(
+                m_context, m_d_row_ptr, m_d_col_idx);
+
+        // canonical order of the block columns (see bsr_assemble)
+        detail::sparse_mat_sort_rows<IndexT>
+            <<<DIVIDE_UP(m_num_block_rows, blockThreads), blockThreads>>>(
+                m_num_block_rows, m_d_row_ptr, m_d_col_idx);
+
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_val, m_nnz_blocks * B * B * sizeof(T)));
+        CUDA_ERROR(cudaMemset(m_d_val, 0, m_nnz_blocks * B * B * sizeof(T)));
+        m_allocated = m_allocated | DEVICE;
+
+        m_h_row_ptr = static_cast<IndexT*>(
+            malloc((m_num_block_rows + 1) * sizeof(IndexT)));
+        m_h_col_idx =
+            static_cast<IndexT*>(malloc(m_nnz_blocks * sizeof(IndexT)));
+        m_h_val = static_cast<T*>(malloc(m_nnz_blocks * B * B * sizeof(T)));
+
+        CUDA_ERROR(cudaMemcpy(m_h_row_ptr,
+                              m_d_row_ptr,
+                              (m_num_block_rows + 1) * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(m_h_col_idx,
+                              m_d_col_idx,
+                              m_nnz_blocks * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+        std::fill_n(m_h_val, m_nnz_blocks * B * B, T(0));
+        m_allocated = m_allocated | HOST;
+    }
+
+    /**
+     * @brief set all entries in the matrix to certain value on both host and
+     * device
+     */
+    __host__ void set_value(T val)
+    {
+        std::fill_n(m_h_val, m_nnz_blocks * B * B, val);
+        CUDA_ERROR(cudaMemcpy(m_d_val,
+                              m_h_val,
+                              m_nnz_blocks * B * B * sizeof(T),
+                              cudaMemcpyHostToDevice));
+    }
+
+    /**
+     * @brief number of scalar rows i.e., number of vertices times B
+     */
+    __device__ __host__ IndexT rows() const
+    {
+        return m_num_block_rows * B;
+    }
+
+    /**
+     * @brief number of scalar columns i.e., number of vertices times B
+     */
+    __device__ __host__ IndexT cols() const
+    {
+        return m_num_block_rows * B;
+    }
+
+    /**
+     * @brief number of block rows i.e., number of vertices
+     */
+    __device__ __host__ IndexT num_block_rows() const
+    {
+        return m_num_block_rows;
+    }
+
+    /**
+     * @brief number of non-zero blocks
+     */
+    __device__ __host__ IndexT non_zero_blocks() const
+    {
+        return m_nnz_blocks;
+    }
+
+    /**
+     * @brief the block size
+     */
+    __device__ __host__ static constexpr int block_size()
+    {
+        return B;
+    }
+
+    /**
+     * @brief return the block row pointer of the BSR matrix
+     */
+    __device__ __host__ const IndexT* row_ptr() const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_row_ptr;
+#else
+        return m_h_row_ptr;
+#endif
+    }
+
+    /**
+     * @brief return the block column index of the BSR matrix
+     */
+    __device__ __host__ const IndexT* col_idx() const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_col_idx;
+#else
+        return m_h_col_idx;
+#endif
+    }
+
+    /**
+     * @brief pointer to the (row-major) values of the k-th non-zero block
+     */
+    __device__ __host__ T* block_at(IndexT k) const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_val + k * B * B;
+#else
+        return m_h_val + k * B * B;
+#endif
+    }
+
+    /**
+     * @brief pointer to the (row-major) values of the block (x, y) using the
+     * block row and column index
+     */
+    __device__ __host__ T* block(const IndexT x, const IndexT y) const
+    {
+        const IndexT start = row_ptr()[x];
+        const IndexT end   = row_ptr()[x + 1];
+
+        for (IndexT i = start; i < end; ++i) {
+            if (col_idx()[i] == y) {
+                return block_at(i);
+            }
+        }
+        assert(1 != 1);
+        return nullptr;
+    }
+
+    /**
+     * @brief pointer to the (row-major) values of the block of two vertices
+     */
+    __device__ __host__ T* block(const VertexHandle& row_v,
+                                 const VertexHandle& col_v) const
+    {
+        return block(get_row_id(row_v), get_row_id(col_v));
+    }
+
+    /**
+     * @brief access the entry (r, c) inside the block of two vertices
+     */
+    __device__ __host__ T& operator()(const VertexHandle& row_v,
+                                      const VertexHandle& col_v,
+                                      const int           r,
+                                      const int           c) const
+    {
+        return block(row_v, col_v)[r * B + c];
+    }
+
+    /**
+     * @brief return the block row index corresponding to a vertex handle
+     */
+    __device__ __host__ const uint32_t
+    get_row_id(const VertexHandle& handle) const
+    {
+        auto id = handle.unpack();
+        return m_context.vertex_prefix()[id.first] + id.second;
+    }
+
+    /**
+     * @brief assemble all the blocks on the device from a lambda that returns
+     * the BxB block of two vertices as glm::mat<B, B, T> (column-major i.e.,
+     * m[c][r] is the entry (r, c) of the block). The lambda is called with
+     * (v, v) for the diagonal block and (v, u) for every VV neighbor u of v.
+     * It typically captures the attributes the blocks are computed from e.g.,
+     *
+     *   A.assemble(rx, [=] __device__(const VertexHandle& v,
+     *                                 const VertexHandle& u) {
+     *       return (v == u ? w(v, 0) : -w(v, 0)) * mat3x3<float>(1.f);
+     *   });
+     */
+    template <uint32_t blockThreads = 256, typename LambdaT>
+    __host__ void assemble(const RXMeshStatic& rx,
+                           LambdaT             block_func,
+                           cudaStream_t        stream = NULL)
+    {
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box(
+            {Op::VV},
+            launch_box,
+            (void*)detail::bsr_assemble<T, B, blockThreads, LambdaT>);
+
+        detail::bsr_assemble<T, B, blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn,
+               stream>>>(
+                m_context, m_d_row_ptr, m_d_col_idx, m_d_val, block_func);
+    }
+
+    /**
+     * @brief BSR matrix times dense matrix Y = A * X on the device where X and
+     * Y have num_block_rows() rows and B columns per vector. All vectors are
+     * multiplied in a single launch
+     */
+    __host__ void multiply(const DenseMatrix<T>& X_mat,
+                           DenseMatrix<T>&       Y_mat,
+                           cudaStream_t          stream = NULL) const
+    {
+        if (!check_vectors(X_mat, Y_mat, "multiply")) {
+            return;
+        }
+        const IndexT       num_vec      = X_mat.cols() / B;
+        constexpr uint32_t blockThreads = 256;
+        detail::bsr_multiply<T, B>
+            <<<num_blocks(num_vec), blockThreads, 0, stream>>>(
+                m_num_block_rows,
+                m_d_row_ptr,
+                m_d_col_idx,
+                m_d_val,
+                num_vec,
+                X_mat,
+                Y_mat);
+    }
+
+    /**
+     * @brief compute the inverse of the diagonal blocks on the device to be
+     * used by apply_block_jacobi(). Should be called again whenever the values
+     * change
+     */
+    __host__ void compute_block_jacobi(cudaStream_t stream = NULL)
+    {
+        if (m_d_inv_diag == nullptr) {
+            CUDA_ERROR(cudaMalloc((void**)&m_d_inv_diag,
+                                  m_num_block_rows * B * B * sizeof(T)));
+        }
+        constexpr uint32_t blockThreads = 256;
+        detail::bsr_invert_diagonal<T, B>
+            <<<num_blocks(1), blockThreads, 0, stream>>>(
+                m_num_block_rows, m_d_row_ptr, m_d_val, m_d_inv_diag);
+    }
+
+    /**
+     * @brief apply the block-Jacobi preconditioner Y = D^{-1} * X where D is
+     * the block diagonal of the matrix. compute_block_jacobi() should be
+     * called first
+     */
+    __host__ void apply_block_jacobi(const DenseMatrix<T>& X_mat,
+                                     DenseMatrix<T>&       Y_mat,
+                                     cudaStream_t          stream = NULL) const
+    {
+        if (m_d_inv_diag == nullptr) {
+            RXMESH_ERROR(
+                "BlockSparseMatrix::apply_block_jacobi() "
+                "compute_block_jacobi() should be called first");
+            return;
+        }
+        if (!check_vectors(X_mat, Y_mat, "apply_block_jacobi")) {
+            return;
+        }
+        const IndexT       num_vec      = X_mat.cols() / B;
+        constexpr uint32_t blockThreads = 256;
+        detail::bsr_apply_block_diagonal<T, B>
+            <<<num_blocks(num_vec), blockThreads, 0, stream>>>(
+                m_num_block_rows, m_d_inv_diag, num_vec, X_mat, Y_mat);
+    }
+
+    /**
+     * @brief move the values between host an device
+     */
+    __host__ void move(locationT    source,
+                       locationT    target,
+                       cudaStream_t stream = NULL)
+    {
+        if (source == target) {
+            RXMESH_WARN(
+                "BlockSparseMatrix::move() source ({}) and target ({}) "
+                "are the same.",
+                location_to_string(source),
+                location_to_string(target));
+            return;
+        }
+
+        if (source == HOST && target == DEVICE) {
+            CUDA_ERROR(cudaMemcpyAsync(m_d_val,
+                                       m_h_val,
+                                       m_nnz_blocks * B * B * sizeof(T),
+                                       cudaMemcpyHostToDevice,
+                                       stream));
+        } else if (source == DEVICE && target == HOST) {
+            CUDA_ERROR(cudaMemcpyAsync(m_h_val,
+                                       m_d_val,
+                                       m_nnz_blocks * B * B * sizeof(T),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+        }
+    }
+
+    /**
+     * @brief release all allocated memory
+     */
+    __host__ void release()
+    {
+        GPU_FREE(m_d_row_ptr);
+        GPU_FREE(m_d_col_idx);
+        GPU_FREE(m_d_val);
+        GPU_FREE(m_d_inv_diag);
+        free(m_h_row_ptr);
+        free(m_h_col_idx);
+        free(m_h_val);
+        m_h_row_ptr = nullptr;
+        m_h_col_idx = nullptr;
+        m_h_val     = nullptr;
+        m_allocated = LOCATION_NONE;
+    }
+
+   private:
+    __host__ uint32_t num_blocks(const IndexT num_vec) const
+    {
+        constexpr uint32_t blockThreads = 256;
+        return std::max(DIVIDE_UP(m_num_block_rows * num_vec, blockThreads),
+                        uint32_t(1));
+    }
+
+    __host__ bool check_vectors(const DenseMatrix<T>& X_mat,
+                                const DenseMatrix<T>& Y_mat,
+                                const char*           func) const
+    {
+        if (X_mat.rows() != m_num_block_rows ||
+            Y_mat.rows() != m_num_block_rows || X_mat.cols() % B != 0 ||
+            X_mat.cols() != Y_mat.cols()) {
+            RXMESH_ERROR(
+                "BlockSparseMatrix::{}() mismatch input dimensions. X is {}x{} "
+                "and Y is {}x{} while both should be {}x(k*{})",
+                func,
+                X_mat.rows(),
+                X_mat.cols(),
+                Y_mat.rows(),
+                Y_mat.cols(),
+                m_num_block_rows,
+                B);
+            return false;
+        }
+        return true;
+    }
+
+    IndexT*   m_d_row_ptr;
+    IndexT*   m_d_col_idx;
+    T*        m_d_val;
+    IndexT*   m_h_row_ptr;
+    IndexT*   m_h_col_idx;
+    T*        m_h_val;
+    T*        m_d_inv_diag;
+    IndexT    m_num_block_rows;
+    IndexT    m_nnz_blocks;
+    Context   m_context;
+    locationT m_allocated;
+};
+}  // namespace rxmesh
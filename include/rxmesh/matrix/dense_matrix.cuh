@@ -1,10 +1,12 @@
 #pragma once
+#include <algorithm>
 #include <vector>
 #include "cublas_v2.h"
 #include "cusparse.h"
 
 #include "rxmesh/attribute.h"
 #include "rxmesh/context.h"
+#include "rxmesh/matrix/dense_matrix_kernels.cuh"
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/types.h"
 
@@ -502,6 +504,141 @@ struct DenseMatrix
     }
 
 
+    /**
+     * @brief dot product with x where the result is written to d_result on
+     * the device i.e., there is no synchronization with the host. This is
+     * done with a single kernel launch (also for padded matrices) so it could
+     * be chained with other device-side operations (e.g., fused_cg_update())
+     * on the same stream. Only float and double are supported.
+     * @param x the other matrix with the same size
+     * @param d_result device pointer to a single value
+     * @param stream the stream on which the dot product is computed. All
+     * device-scalar operations on the same matrix should use the same stream
+     * since they share the same reduction workspace
+     */
+    __host__ void dot_on_device(const DenseMatrix<T, MemAlignSize>& x,
+                                T*                                  d_result,
+                                cudaStream_t stream = NULL)
+    {
+        if constexpr (!std::is_same_v<T, float> &&
+                      !std::is_same_v<T, double>) {
+            RXMESH_ERROR(
+                "DenseMatrix::dot_on_device() only float and double are "
+                "supported for this function!");
+            return;
+        }
+        check_same_size(x, "dot_on_device");
+
+        constexpr uint32_t blockSize = 256;
+        const uint32_t     blocks    = fused_num_blocks(blockSize);
+        allocate_reduce_workspace();
+
+        detail::dense_dot<T, blockSize>
+            <<<blocks, blockSize, 0, stream>>>(rows(),
+                                               rows() * cols(),
+                                               x.m_d_val,
+                                               x.m_num_rows + x.m_col_pad_idx,
+                                               m_d_val,
+                                               m_num_rows + m_col_pad_idx,
+                                               m_d_reduce_partial,
+                                               m_d_reduce_counter,
+                                               d_result);
+    }
+
+    /**
+     * @brief the fused update of conjugate gradient where this matrix is the
+     * solution X. The following is computed in a single kernel launch
+     *   a   = d_num[0] / d_den[0]
+     *   X  += a * P
+     *   R  -= a * AP
+     *   d_rr[0] = <R, R>
+     * The scalars are read and written on the device so a CG iteration does
+     * not need to synchronize with the host. Only float and double are
+     * supported
+     * @param P the search direction
+     * @param R the residual which is updated in place
+     * @param AP the product of the system matrix with P
+     * @param d_num device pointer to the numerator of a (e.g., <R, Z>)
+     * @param d_den device pointer to the denominator of a (e.g., <P, AP>)
+     * @param d_rr device pointer where the new <R, R> is written
+     * @param stream the stream on which the update is computed
+     */
+    __host__ void fused_cg_update(const DenseMatrix<T, MemAlignSize>& P,
+                                  DenseMatrix<T, MemAlignSize>&       R,
+                                  const DenseMatrix<T, MemAlignSize>& AP,
+                                  const T*                            d_num,
+                                  const T*                            d_den,
+                                  T*                                  d_rr,
+                                  cudaStream_t stream = NULL)
+    {
+        if constexpr (!std::is_same_v<T, float> &&
+                      !std::is_same_v<T, double>) {
+            RXMESH_ERROR(
+                "DenseMatrix::fused_cg_update() only float and double are "
+                "supported for this function!");
+            return;
+        }
+        check_same_size(P, "fused_cg_update");
+        check_same_size(R, "fused_cg_update");
+        check_same_size(AP, "fused_cg_update");
+
+        constexpr uint32_t blockSize = 256;
+        const uint32_t     blocks    = fused_num_blocks(blockSize);
+        allocate_reduce_workspace();
+
+        detail::dense_cg_update<T, blockSize>
+            <<<blocks, blockSize, 0, stream>>>(rows(),
+                                               rows() * cols(),
+                                               m_num_rows + m_col_pad_idx,
+                                               m_d_val,
+                                               P.m_d_val,
+                                               R.m_d_val,
+                                               AP.m_d_val,
+                                               d_num,
+                                               d_den,
+                                               m_d_reduce_partial,
+                                               m_d_reduce_counter,
+                                               d_rr);
+    }
+
+    /**
+     * @brief update the search direction of conjugate gradient where this
+     * matrix is the search direction P i.e., P = Z + (d_num[0] / d_den[0]) * P
+     * where the scalars are read on the device. Only float and double are
+     * supported
+     * @param Z the (preconditioned) residual
+     * @param d_num device pointer to the numerator (e.g., new <R, Z>)
+     * @param d_den device pointer to the denominator (e.g., old <R, Z>)
+     * @param stream the stream on which the update is computed
+     */
+    __host__ void fused_cg_direction(const DenseMatrix<T, MemAlignSize>& Z,
+                                     const T*                            d_num,
+                                     const T*                            d_den,
+                                     cudaStream_t stream = NULL)
+    {
+        if constexpr (!std::is_same_v<T, float> &&
+                      !std::is_same_v<T, double>) {
+            RXMESH_ERROR(
+                "DenseMatrix::fused_cg_direction() only float and double are "
+                "supported for this function!");
+            return;
+        }
+        check_same_size(Z, "fused_cg_direction");
+
+        constexpr uint32_t blockSize = 256;
+        const uint32_t     blocks    = fused_num_blocks(blockSize);
+
+        detail::dense_cg_direction<<<blocks, blockSize, 0, stream>>>(
+            rows(),
+            rows() * cols(),
+            m_num_rows + m_col_pad_idx,
+            m_d_val,
+            Z.m_d_val,
+            d_num,
+            d_den);
+    }
+
+
     /**
      * @brief multiply all entries in the dense matrix by a scalar (i.e.,
      * scaling). For complex number, the scalar could be either a complex or
@@ -847,6 +984,8 @@ struct DenseMatrix
         if (((location & DEVICE) == DEVICE) &&
             ((m_allocated & DEVICE) == DEVICE)) {
             GPU_FREE(m_d_val);
+            GPU_FREE(m_d_reduce_partial);
+            GPU_FREE(m_d_reduce_counter);
             m_allocated = m_allocated & (~DEVICE);
         }
         if ((location & LOCATION_ALL) == LOCATION_ALL) {
@@ -855,6 +994,50 @@ struct DenseMatrix
     }
 
    private:
+    /**
+     * @brief number of blocks used by the fused kernels
+     */
+    uint32_t fused_num_blocks(uint32_t block_size) const
+    {
+        return std::max(
+            1u,
+            std::min(DIVIDE_UP(uint32_t(rows() * cols()), block_size),
+                     detail::dense_fused_max_blocks));
+    }
+
+    /**
+     * @brief allocate (once) the per-block partial sums and the counter used
+     * by the single-launch reductions
+     */
+    void allocate_reduce_workspace()
+    {
+        if (m_d_reduce_partial == nullptr) {
+            CUDA_ERROR(cudaMalloc((void**)&m_d_reduce_partial,
+                                  detail::dense_fused_max_blocks * sizeof(T)));
+            CUDA_ERROR(
+                cudaMalloc((void**)&m_d_reduce_counter, sizeof(uint32_t)));
+            CUDA_ERROR(cudaMemset(m_d_reduce_counter, 0, sizeof(uint32_t)));
+        }
+    }
+
+    /**
+     * @brief check that other has the same number of rows and columns
+     */
+    void check_same_size(const DenseMatrix<T, MemAlignSize>& other,
+                         const char*                         op) const
+    {
+        if (other.rows() != rows() || other.cols() != cols()) {
+            RXMESH_ERROR(
+                "DenseMatrix::{}() mismatch in the matrices sizes ({}x{} vs. "
+                "{}x{})",
+                op,
+                rows(),
+                cols(),
+                other.rows(),
+                other.cols());
+        }
+    }
+
     /**
      * @brief allocate the data on host or device
      */
@@ -889,6 +1072,10 @@ struct DenseMatrix
 
     IndexT m_col_pad_bytes;
     IndexT m_col_pad_idx;
+
+    // workspace of dot_on_device() and fused_cg_update()
+    T*        m_d_reduce_partial = nullptr;
+    uint32_t* m_d_reduce_counter = nullptr;
 };
 
 }  // namespace rxmesh
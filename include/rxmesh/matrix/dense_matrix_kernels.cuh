@@ -0,0 +1,140 @@
+#pragma once
+#include <cub/block/block_reduce.cuh>
+
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief maximum number of blocks used by the fused dense kernels. The kernels
+ * use grid-stride loops so this bounds the size of the per-block partial sums
+ */
+static constexpr uint32_t dense_fused_max_blocks = 1024;
+
+/**
+ * @brief index of the i-th entry of a column-major matrix with padded columns
+ */
+template <typename IndexT>
+__device__ __forceinline__ IndexT dense_index(const IndexT i,
+                                              const IndexT num_rows,
+                                              const IndexT ld)
+{
+    return (i / num_rows) * ld + (i % num_rows);
+}
+
+/**
+ * @brief sum thread_val over the whole grid and write it to d_result in the
+ * same launch. Every block writes its partial sum and the last block to finish
+ * sums the partial sums in a fixed order (so the result is deterministic).
+ * d_counter should be zero before the first launch and it is reset by the last
+ * block
+ */
+template <typename T, uint32_t blockSize>
+__device__ __forceinline__ void grid_sum(const T   thread_val,
+                                         T*        d_partial,
+                                         uint32_t* d_counter,
+                                         T*        d_result)
+{
+    typedef cub::BlockReduce<T, blockSize>       BlockReduce;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+    __shared__ bool                              is_last;
+
+    const T block_sum = BlockReduce(temp_storage).Sum(thread_val);
+    if (threadIdx.x == 0) {
+        d_partial[blockIdx.x] = block_sum;
+        __threadfence();
+        is_last = (::atomicInc(d_counter, gridDim.x - 1) == gridDim.x - 1);
+    }
+    __syncthreads();
+
+    if (is_last) {
+        const volatile T* partial = d_partial;
+
+        T sum = 0;
+        for (uint32_t b = threadIdx.x; b < gridDim.x; b += blockSize) {
+            sum += partial[b];
+        }
+        __syncthreads();
+        const T total = BlockReduce(temp_storage).Sum(sum);
+        if (threadIdx.x == 0) {
+            d_result[0] = total;
+        }
+    }
+}
+
+template <typename T, uint32_t blockSize, typename IndexT>
+__launch_bounds__(blockSize) __global__
+    void dense_dot(const IndexT num_rows,
+                   const IndexT size,
+                   const T*     x,
+                   const IndexT x_ld,
+                   const T*     y,
+                   const IndexT y_ld,
+                   T*           d_partial,
+                   uint32_t*    d_counter,
+                   T*           d_result)
+{
+    T thread_val = 0;
+    for (IndexT i = blockIdx.x * blockSize + threadIdx.x; i < size;
+         i += blockSize * gridDim.x) {
+        thread_val += x[dense_index(i, num_rows, x_ld)] *
+                      y[dense_index(i, num_rows, y_ld)];
+    }
+    grid_sum<T, blockSize>(thread_val, d_partial, d_counter, d_result);
+}
+
+/**
+ * @brief x += a * p; r -= a * ap; rr = <r, r> with a = num[0] / den[0]
+ */
+template <typename T, uint32_t blockSize, typename IndexT>
+__launch_bounds__(blockSize) __global__
+    void dense_cg_update(const IndexT num_rows,
+                         const IndexT size,
+                         const IndexT ld,
+                         T*           x,
+                         const T*     p,
+                         T*           r,
+                         const T*     ap,
+                         const T*     d_num,
+                         const T*     d_den,
+                         T*           d_partial,
+                         uint32_t*    d_counter,
+                         T*           d_rr)
+{
+    const T alpha = d_num[0] / d_den[0];
+
+    T thread_val = 0;
+    for (IndexT i = blockIdx.x * blockSize + threadIdx.x; i < size;
+         i += blockSize * gridDim.x) {
+        const IndexT id = dense_index(i, num_rows, ld);
+        x[id] += alpha * p[id];
+        const T ri = r[id] - alpha * ap[id];
+        r[id]      = ri;
+        thread_val += ri * ri;
+    }
+    grid_sum<T, blockSize>(thread_val, d_partial, d_counter, d_rr);
+}
+
+/**
+ * @brief p = z + b * p with b = num[0] / den[0]
+ */
+template <typename T, typename IndexT>
+__global__ static void dense_cg_direction(const IndexT num_rows,
+                                          const IndexT size,
+                                          const IndexT ld,
+                                          T*           p,
+                                          const T*     z,
+                                          const T*     d_num,
+                                          const T*     d_den)
+{
+    const T beta = d_num[0] / d_den[0];
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+        const IndexT id = dense_index(i, num_rows, ld);
+        p[id]           = z[id] + beta * p[id];
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
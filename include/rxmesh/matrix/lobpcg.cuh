@@ -0,0 +1,690 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <cub/block/block_reduce.cuh>
+
+#include "cublas_v2.h"
+
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/sparse_matrix.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+#include <Eigen/Dense>
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief maximum number of blocks used for every column by the residual
+ * kernel. The per-block partial sums are reduced on the host in a fixed order
+ */
+static constexpr uint32_t lobpcg_max_blocks = 64;
+
+/**
+ * @brief R = AX - X * diag(lambda) and the per-block partial sums of the
+ * squared norm of every column of R. Column j is handled by blockIdx.y = j
+ */
+template <typename T, uint32_t blockSize>
+__global__ static void lobpcg_residual(const int num_rows,
+                                       const T*  X,
+                                       const T*  AX,
+                                       const T*  lambda,
+                                       T*        R,
+                                       T*        d_partial)
+{
+    const int j          = blockIdx.y;
+    const T   lam        = lambda[j];
+    const T*  x          = X + size_t(j) * num_rows;
+    const T*  ax         = AX + size_t(j) * num_rows;
+    T*        r          = R + size_t(j) * num_rows;
+    T         thread_val = 0;
+
+    for (int i = blockIdx.x * blockSize + threadIdx.x; i < num_rows;
+         i += blockSize * gridDim.x) {
+        const T val = ax[i] - lam * x[i];
+        r[i]        = val;
+        thread_val += val * val;
+    }
+
+    typedef cub::BlockReduce<T, blockSize>       BlockReduce;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+
+    const T block_sum = BlockReduce(temp_storage).Sum(thread_val);
+    if (threadIdx.x == 0) {
+        d_partial[j * gridDim.x + blockIdx.x] = block_sum;
+    }
+}
+
+/**
+ * @brief inv_diag[row] = 1 / (A(row, row) + shift) for every row of the CSR
+ * matrix A. Rows with a zero (shifted) diagonal get 1
+ */
+template <typename T>
+__global__ static void lobpcg_inv_diagonal(const SparseMatrix<T> A,
+                                           const T               shift,
+                                           T*                    inv_diag)
+{
+    for (int row = blockIdx.x * blockDim.x + threadIdx.x; row < A.rows();
+         row += blockDim.x * gridDim.x) {
+        T d = 0;
+        for (int k = A.row_ptr()[row]; k < A.row_ptr()[row + 1]; ++k) {
+            if (A.col_idx()[k] == row) {
+                d = A.get_val_at(k);
+                break;
+            }
+        }
+        d += shift;
+        inv_diag[row] = (d != T(0)) ? T(1) / d : T(1);
+    }
+}
+
+/**
+ * @brief y(row, col) = inv_diag[row] * x(row, col)
+ */
+template <typename T>
+__global__ static void lobpcg_scale_rows(const T*             inv_diag,
+                                         const DenseMatrix<T> x,
+                                         DenseMatrix<T>       y)
+{
+    const int size = x.rows() * x.cols();
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+         i += blockDim.x * gridDim.x) {
+        const int row = i % x.rows();
+        const int col = i / x.rows();
+        y(row, col)   = inv_diag[row] * x(row, col);
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief Jacobi (diagonal) preconditioner for LOBPCG i.e., W = (D + shift)^-1
+ * * R where D is the diagonal of the matrix. For a Laplacian (whose smallest
+ * eigenvalue is zero), the diagonal is positive and no shift is needed. The
+ * diagonal is read on construction from the device side of the matrix. Call
+ * release() to free the memory
+ */
+template <typename T>
+struct JacobiPreconditioner
+{
+    JacobiPreconditioner(const SparseMatrix<T>& A, const T shift = T(0))
+        : m_num_rows(A.rows()), m_d_inv_diag(nullptr)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_inv_diag, m_num_rows * sizeof(T)));
+
+        const uint32_t blocks = DIVIDE_UP(m_num_rows, blockThreads);
+        detail::lobpcg_inv_diagonal<T>
+            <<<blocks, blockThreads>>>(A, shift, m_d_inv_diag);
+    }
+
+    /**
+     * @brief W = D^-1 * R
+     */
+    __host__ void operator()(const DenseMatrix<T>& R,
+                             DenseMatrix<T>&       W,
+                             cudaStream_t          stream) const
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        const uint32_t blocks = std::min(
+            DIVIDE_UP(uint32_t(R.rows() * R.cols()), blockThreads), 1024u);
+        detail::lobpcg_scale_rows<T>
+            <<<blocks, blockThreads, 0, stream>>>(m_d_inv_diag, R, W);
+    }
+
+    /**
+     * @brief release the device memory
+     */
+    __host__ void release()
+    {
+        GPU_FREE(m_d_inv_diag);
+    }
+
+    int m_num_rows;
+    T*  m_d_inv_diag;
+};
+
+/**
+ * @brief Locally optimal block preconditioned conjugate gradient (LOBPCG)
+ * solver for the k smallest eigenpairs of a symmetric matrix A, e.g., the
+ * mesh Laplacian for spectral processing (manifold harmonics, spectral
+ * conformal parameterization, etc). The k eigenvectors are iterated together
+ * as a block of k columns of a DenseMatrix so every iteration applies A once
+ * to a block of k vectors (one SpMM when A is a SparseMatrix). The search
+ * space [X, W, P] (the current eigenvectors, the preconditioned residuals, and
+ * the previous directions) is kept in one n x 3k column-major matrix so its
+ * Gram matrices are computed by two GEMMs. The 3k x 3k Rayleigh-Ritz problem
+ * is solved on the host (with Eigen) after orthonormalizing the basis using
+ * its Gram matrix (SVQB) and dropping the directions that became linearly
+ * dependent. The preconditioner is a hook with the signature
+ *
+ *   void(const DenseMatrix<T>& R, DenseMatrix<T>& W, cudaStream_t stream)
+ *
+ * that computes W = M^-1 * R (e.g., JacobiPreconditioner). Without a
+ * preconditioner, W = R. A can be any (matrix-free) operator with the
+ * signature
+ *
+ *   void(const DenseMatrix<T>& in, DenseMatrix<T>& out, cudaStream_t stream)
+ *
+ * that computes out = A * in. Only float and double are supported.
+ * Converged eigenpairs are not locked i.e., they are iterated until all k
+ * converge
+ */
+template <typename T>
+class LOBPCG
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                  "LOBPCG only float and double are supported");
+
+   public:
+    /**
+     * @brief allocate the work space for computing num_eigen eigenpairs
+     * @param rx the mesh (the number of rows is the number of vertices)
+     * @param num_eigen the number of eigenpairs (k)
+     * @param max_num_iter maximum number of iterations
+     * @param tolerance an eigenpair converged when |A*x - lambda*x| <
+     * tolerance * max(|lambda|, 1) where x has a unit norm
+     */
+    LOBPCG(const RXMeshStatic& rx,
+           const uint32_t      num_eigen,
+           const uint32_t      max_num_iter = 500,
+           const T             tolerance    = T(1e-5))
+        : m_num_rows(rx.get_num_vertices()),
+          m_k(num_eigen),
+          m_max_num_iter(max_num_iter),
+          m_tolerance(tolerance),
+          m_num_iter(0),
+          m_num_blocks(std::min(DIVIDE_UP(rx.get_num_vertices(), 256u),
+                                detail::lobpcg_max_blocks)),
+          m_S(rx, rx.get_num_vertices(), 3 * num_eigen, DEVICE),
+          m_AS(rx, rx.get_num_vertices(), 3 * num_eigen, DEVICE),
+          m_W(rx, rx.get_num_vertices(), num_eigen, DEVICE),
+          m_AW(rx, rx.get_num_vertices(), num_eigen, DEVICE),
+          m_R(rx, rx.get_num_vertices(), num_eigen, DEVICE),
+          m_XP(rx, rx.get_num_vertices(), 2 * num_eigen, DEVICE),
+          m_d_gram(nullptr),
+          m_d_coef(nullptr),
+          m_d_lambda(nullptr),
+          m_d_partial(nullptr),
+          m_cublas_handle(nullptr)
+    {
+        if (m_k == 0 || 3 * m_k > uint32_t(m_num_rows)) {
+            RXMESH_ERROR(
+                "LOBPCG::LOBPCG() the number of eigenpairs ({}) should be "
+                "positive and at most a third of the number of rows ({})",
+                m_k,
+                m_num_rows);
+        }
+
+        const int k = m_k;
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_gram, 2 * 9 * k * k * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_coef, 3 * k * k * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_lambda, k * sizeof(T)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_partial, k * m_num_blocks * sizeof(T)));
+
+        CUBLAS_ERROR(cublasCreate(&m_cublas_handle));
+        CUBLAS_ERROR(
+            cublasSetPointerMode(m_cublas_handle, CUBLAS_POINTER_MODE_HOST));
+
+        m_h_gram.resize(2 * 9 * k * k);
+        m_h_coef.resize(3 * k * k);
+        m_h_partial.resize(k * m_num_blocks);
+        m_eigenvalues.resize(k, T(0));
+        m_residuals.resize(k, T(0));
+    }
+
+    /**
+     * @brief compute the k smallest eigenpairs of the sparse matrix A
+     * @param A the matrix (its device side is used)
+     * @param X it is used as the initial guess (on the device) and the
+     * eigenvectors are written to it (n x k). The initial guess should have
+     * linearly independent columns e.g., use X.fill_random()
+     * @param stream the stream to launch the kernels on
+     * @return the number of iterations taken
+     */
+    __host__ uint32_t solve(SparseMatrix<T>& A,
+                            DenseMatrix<T>&  X,
+                            cudaStream_t     stream = NULL)
+    {
+        return solve(A, X, no_preconditioner(), stream);
+    }
+
+    /**
+     * @brief same as solve() above but with a preconditioner (see the top of
+     * the class)
+     */
+    template <typename PrecondT>
+    __host__ uint32_t solve(SparseMatrix<T>& A,
+                            DenseMatrix<T>&  X,
+                            PrecondT         precond,
+                            cudaStream_t     stream = NULL)
+    {
+        auto spmm = [&A](const DenseMatrix<T>& in,
+                         DenseMatrix<T>&       out,
+                         cudaStream_t          s) {
+            A.multiply(const_cast<DenseMatrix<T>&>(in), out, s);
+        };
+        return solve_operator(spmm, X, precond, stream);
+    }
+
+    /**
+     * @brief compute the k smallest eigenpairs of the operator A (see the top
+     * of the class)
+     * @param A computes out = A * in
+     * @param X the initial guess and the output eigenvectors (n x k)
+     * @param precond computes W = M^-1 * R
+     * @param stream the stream to launch the kernels on
+     * @return the number of iterations taken
+     */
+    template <typename OpT, typename PrecondT>
+    __host__ uint32_t solve_operator(OpT             A,
+                                     DenseMatrix<T>& X,
+                                     PrecondT        precond,
+                                     cudaStream_t    stream = NULL)
+    {
+        const int n = m_num_rows;
+        const int k = m_k;
+
+        if (X.rows() != n || X.cols() != k) {
+            RXMESH_ERROR(
+                "LOBPCG::solve() X should be {}x{} instead of {}x{}",
+                n,
+                k,
+                X.rows(),
+                X.cols());
+            return 0;
+        }
+
+        CUBLAS_ERROR(cublasSetStream(m_cublas_handle, stream));
+
+        m_num_iter = 0;
+
+        // Rayleigh-Ritz on X only to start from an orthonormal X
+        copy_cols(X.data(DEVICE), m_S.data(DEVICE), 0, k, stream);
+        A(X, m_AW, stream);
+        copy_cols(m_AW.data(DEVICE), m_AS.data(DEVICE), 0, k, stream);
+        if (!rayleigh_ritz(k, stream)) {
+            RXMESH_ERROR(
+                "LOBPCG::solve() the columns of the initial guess are not "
+                "linearly independent");
+            return 0;
+        }
+        update(k, false, stream);
+
+        bool has_p = false;
+
+        while (true) {
+            // R = AX - X * Lambda
+            if (converged(stream) || m_num_iter == m_max_num_iter) {
+                break;
+            }
+
+            // W = M^-1 * R and AW = A * W
+            precond(m_R, m_W, stream);
+            A(m_W, m_AW, stream);
+            copy_cols(m_W.data(DEVICE), m_S.data(DEVICE), k, k, stream);
+            copy_cols(m_AW.data(DEVICE), m_AS.data(DEVICE), k, k, stream);
+
+            int m = has_p ? 3 * k : 2 * k;
+            if (!rayleigh_ritz(m, stream)) {
+                // P became (almost) linearly dependent on [X, W]. Restart
+                // without it
+                if (!has_p || !rayleigh_ritz(2 * k, stream)) {
+                    RXMESH_WARN(
+                        "LOBPCG::solve() the search space collapsed after {} "
+                        "iterations",
+                        m_num_iter);
+                    break;
+                }
+                m = 2 * k;
+            }
+            update(m, true, stream);
+            has_p = true;
+
+            ++m_num_iter;
+        }
+
+        copy_cols(m_S.data(DEVICE), X.data(DEVICE), 0, k, stream);
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return m_num_iter;
+    }
+
+    /**
+     * @brief the eigenvalues (in ascending order) computed by the last solve
+     */
+    const std::vector<T>& get_eigenvalues() const
+    {
+        return m_eigenvalues;
+    }
+
+    /**
+     * @brief the residual norms |A*x - lambda*x| of the eigenpairs at the last
+     * iteration of the last solve
+     */
+    const std::vector<T>& get_residuals() const
+    {
+        return m_residuals;
+    }
+
+    /**
+     * @brief the number of iterations taken by the last solve
+     */
+    uint32_t get_num_iterations() const
+    {
+        return m_num_iter;
+    }
+
+    /**
+     * @brief release all allocated memory
+     */
+    __host__ void release()
+    {
+        m_S.release();
+        m_AS.release();
+        m_W.release();
+        m_AW.release();
+        m_R.release();
+        m_XP.release();
+        GPU_FREE(m_d_gram);
+        GPU_FREE(m_d_coef);
+        GPU_FREE(m_d_lambda);
+        GPU_FREE(m_d_partial);
+        if (m_cublas_handle != nullptr) {
+            CUBLAS_ERROR(cublasDestroy(m_cublas_handle));
+            m_cublas_handle = nullptr;
+        }
+    }
+
+   private:
+    /**
+     * @brief the default preconditioner W = R
+     */
+    struct no_preconditioner
+    {
+        void operator()(const DenseMatrix<T>& R,
+                        DenseMatrix<T>&       W,
+                        cudaStream_t          stream) const
+        {
+            CUDA_ERROR(cudaMemcpyAsync(W.data(DEVICE),
+                                       R.data(DEVICE),
+                                       R.bytes(),
+                                       cudaMemcpyDeviceToDevice,
+                                       stream));
+        }
+    };
+
+    /**
+     * @brief copy num_cols columns from src to the columns starting at
+     * dst_col of dst where both have m_num_rows rows
+     */
+    void copy_cols(const T*     src,
+                   T*           dst,
+                   const int    dst_col,
+                   const int    num_cols,
+                   cudaStream_t stream)
+    {
+        CUDA_ERROR(cudaMemcpyAsync(dst + size_t(dst_col) * m_num_rows,
+                                   src,
+                                   size_t(num_cols) * m_num_rows * sizeof(T),
+                                   cudaMemcpyDeviceToDevice,
+                                   stream));
+    }
+
+    /**
+     * @brief C = op(A) * B where op(A) is A or A^T (column-major)
+     */
+    void gemm(const bool   trans_a,
+              const int    m,
+              const int    n,
+              const int    k,
+              const T*     A,
+              const int    lda,
+              const T*     B,
+              const int    ldb,
+              T*           C,
+              const int    ldc)
+    {
+        const T                 alpha = 1;
+        const T                 beta  = 0;
+        const cublasOperation_t op_a  = trans_a ? CUBLAS_OP_T : CUBLAS_OP_N;
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUBLAS_ERROR(cublasSgemm(m_cublas_handle,
+                                     op_a,
+                                     CUBLAS_OP_N,
+                                     m,
+                                     n,
+                                     k,
+                                     &alpha,
+                                     A,
+                                     lda,
+                                     B,
+                                     ldb,
+                                     &beta,
+                                     C,
+                                     ldc));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUBLAS_ERROR(cublasDgemm(m_cublas_handle,
+                                     op_a,
+                                     CUBLAS_OP_N,
+                                     m,
+                                     n,
+                                     k,
+                                     &alpha,
+                                     A,
+                                     lda,
+                                     B,
+                                     ldb,
+                                     &beta,
+                                     C,
+                                     ldc));
+        }
+    }
+
+    /**
+     * @brief compute the residual R of the current eigenpairs and their norms.
+     * Return true if all of them converged
+     */
+    bool converged(cudaStream_t stream)
+    {
+        const int k = m_k;
+
+        detail::lobpcg_residual<T, 256>
+            <<<dim3(m_num_blocks, k), 256, 0, stream>>>(m_num_rows,
+                                                        m_S.data(DEVICE),
+                                                        m_AS.data(DEVICE),
+                                                        m_d_lambda,
+                                                        m_R.data(DEVICE),
+                                                        m_d_partial);
+
+        CUDA_ERROR(cudaMemcpyAsync(m_h_partial.data(),
+                                   m_d_partial,
+                                   k * m_num_blocks * sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        bool done = true;
+        for (int j = 0; j < k; ++j) {
+            T sum = 0;
+            for (uint32_t b = 0; b < m_num_blocks; ++b) {
+                sum += m_h_partial[j * m_num_blocks + b];
+            }
+            m_residuals[j] = std::sqrt(sum);
+            if (m_residuals[j] >=
+                m_tolerance * std::max(std::abs(m_eigenvalues[j]), T(1))) {
+                done = false;
+            }
+        }
+        return done;
+    }
+
+    /**
+     * @brief Rayleigh-Ritz on the first m columns of S i.e., the k smallest
+     * eigenpairs of S^T A S y = lambda S^T S y. The basis is first
+     * orthonormalized using the eigen-decomposition of its (scaled) Gram
+     * matrix and the directions with tiny eigenvalues are dropped. On success,
+     * the m x k coefficients of the Ritz vectors are uploaded to m_d_coef and
+     * the Ritz values to m_d_lambda. Return false if the basis has less than k
+     * linearly independent directions
+     */
+    bool rayleigh_ritz(const int m, cudaStream_t stream)
+    {
+        using MatrixXd = Eigen::MatrixXd;
+
+        const int n = m_num_rows;
+        const int k = m_k;
+
+        T* d_G = m_d_gram;
+        T* d_H = m_d_gram + m * m;
+
+        // G = S^T S and H = S^T A S
+        gemm(true, m, m, n, m_S.data(DEVICE), n, m_S.data(DEVICE), n, d_G, m);
+        gemm(true, m, m, n, m_S.data(DEVICE), n, m_AS.data(DEVICE), n, d_H, m);
+
+        CUDA_ERROR(cudaMemcpyAsync(m_h_gram.data(),
+                                   m_d_gram,
+                                   2 * m * m * sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        MatrixXd G(m, m), H(m, m);
+        for (int c = 0; c < m; ++c) {
+            for (int r = 0; r < m; ++r) {
+                G(r, c) = m_h_gram[c * m + r];
+                H(r, c) = m_h_gram[m * m + c * m + r];
+            }
+        }
+        G = 0.5 * (G + G.transpose());
+        H = 0.5 * (H + H.transpose());
+
+        // scale the basis to unit columns
+        Eigen::VectorXd d(m);
+        for (int i = 0; i < m; ++i) {
+            d[i] = (G(i, i) > 0) ? 1.0 / std::sqrt(G(i, i)) : 0.0;
+        }
+        G = d.asDiagonal() * G * d.asDiagonal();
+        H = d.asDiagonal() * H * d.asDiagonal();
+
+        Eigen::SelfAdjointEigenSolver<MatrixXd> g_eig(G);
+        if (g_eig.info() != Eigen::Success) {
+            return false;
+        }
+
+        const double drop = std::sqrt(std::numeric_limits<T>::epsilon()) *
+                            std::max(g_eig.eigenvalues().maxCoeff(), 0.0);
+
+        // the orthonormal basis of the space spanned by S is S * D * Q
+        std::vector<int> kept;
+        for (int i = 0; i < m; ++i) {
+            if (g_eig.eigenvalues()[i] > drop) {
+                kept.push_back(i);
+            }
+        }
+        const int r = static_cast<int>(kept.size());
+        if (r < k) {
+            return false;
+        }
+        MatrixXd Q(m, r);
+        for (int i = 0; i < r; ++i) {
+            Q.col(i) = g_eig.eigenvectors().col(kept[i]) /
+                       std::sqrt(g_eig.eigenvalues()[kept[i]]);
+        }
+
+        MatrixXd Hr = Q.transpose() * H * Q;
+        Hr          = 0.5 * (Hr + Hr.transpose());
+
+        Eigen::SelfAdjointEigenSolver<MatrixXd> h_eig(Hr);
+        if (h_eig.info() != Eigen::Success) {
+            return false;
+        }
+
+        const MatrixXd C =
+            d.asDiagonal() * Q * h_eig.eigenvectors().leftCols(k);
+
+        for (int j = 0; j < k; ++j) {
+            m_eigenvalues[j] = static_cast<T>(h_eig.eigenvalues()[j]);
+            for (int i = 0; i < m; ++i) {
+                m_h_coef[j * m + i] = static_cast<T>(C(i, j));
+            }
+        }
+
+        CUDA_ERROR(cudaMemcpyAsync(m_d_coef,
+                                   m_h_coef.data(),
+                                   m * k * sizeof(T),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(m_d_lambda,
+                                   m_eigenvalues.data(),
+                                   k * sizeof(T),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        return true;
+    }
+
+    /**
+     * @brief X = S * C and P = S[:, k:m] * C[k:m, :] (and the same for AX and
+     * AP from AS) using the coefficients computed by rayleigh_ritz(m)
+     */
+    void update(const int m, const bool with_p, cudaStream_t stream)
+    {
+        const int n = m_num_rows;
+        const int k = m_k;
+
+        T* d_xp = m_XP.data(DEVICE);
+
+        for (int s = 0; s < 2; ++s) {
+            T* d_s = (s == 0) ? m_S.data(DEVICE) : m_AS.data(DEVICE);
+
+            gemm(false, n, k, m, d_s, n, m_d_coef, m, d_xp, n);
+            if (with_p) {
+                gemm(false,
+                     n,
+                     k,
+                     m - k,
+                     d_s + size_t(k) * n,
+                     n,
+                     m_d_coef + k,
+                     m,
+                     d_xp + size_t(k) * n,
+                     n);
+            }
+
+            copy_cols(d_xp, d_s, 0, k, stream);
+            if (with_p) {
+                copy_cols(d_xp + size_t(k) * n, d_s, 2 * k, k, stream);
+            }
+        }
+    }
+
+    int              m_num_rows;
+    uint32_t         m_k;
+    uint32_t         m_max_num_iter;
+    T                m_tolerance;
+    uint32_t         m_num_iter;
+    uint32_t         m_num_blocks;
+    DenseMatrix<T>   m_S, m_AS, m_W, m_AW, m_R, m_XP;
+    T*               m_d_gram;
+    T*               m_d_coef;
+    T*               m_d_lambda;
+    T*               m_d_partial;
+    cublasHandle_t   m_cublas_handle;
+    std::vector<T>   m_h_gram;
+    std::vector<T>   m_h_coef;
+    std::vector<T>   m_h_partial;
+    std::vector<T>   m_eigenvalues;
+    std::vector<T>   m_residuals;
+};
+}  // namespace rxmesh
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <cmath>
+
+#include <cub/device/device_reduce.cuh>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/context.h"
+#include "rxmesh/kernels/attribute.cuh"
+#include "rxmesh/launch_box.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/*
+ * Matrix-free linear operators on the vertices of the mesh. Instead of
+ * assembling a SparseMatrix (CSR), the operator is given as a __device__
+ * lambda that computes the row(s) of A*x for one vertex inside a VV query i.e.,
+ * using the one-ring of the vertex from the patch's shared-memory topology:
+ *
+ *   auto laplace = [=] __device__(const VertexHandle&        vh,
+ *                                 const VertexIterator&      iter,
+ *                                 const VertexAttribute<T>&  in,
+ *                                 VertexAttribute<T>&        out) {
+ *       for (uint32_t i = 0; i < in.get_num_attributes(); ++i) {
+ *           T sum = iter.size() * in(vh, i);
+ *           for (uint32_t v = 0; v < iter.size(); ++v) {
+ *               sum -= in(iter[v], i);
+ *           }
+ *           out(vh, i) = sum;
+ *       }
+ *   };
+ *
+ * Every attribute (column) of x is treated as an independent right-hand side
+ * that shares the operator (e.g., the three coordinates in MCF) with dot
+ * products taken over all attributes together.
+ */
+
+namespace detail {
+
+/**
+ * @brief out = A * in where A is applied per vertex by matvec inside a VV
+ * query. If d_partial is not null, the per-patch partial sums of <in, out>
+ * over the owned vertices are written to d_partial
+ */
+template <typename T, uint32_t blockThreads, typename MatVecT>
+__global__ static void matrix_free_matvec(const Context            context,
+                                          const VertexAttribute<T> in,
+                                          VertexAttribute<T>       out,
+                                          MatVecT                  matvec,
+                                          T*                       d_partial,
+                                          const bool               oriented)
+{
+    T thread_val = 0;
+
+    auto apply = [&](VertexHandle& vh, const VertexIterator& iter) {
+        matvec(vh, iter, in, out);
+        if (d_partial != nullptr) {
+            for (uint32_t i = 0; i < in.get_num_attributes(); ++i) {
+                thread_val += in(vh, i) * out(vh, i);
+            }
+        }
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, apply, oriented);
+
+    if (d_partial != nullptr) {
+        cub_block_sum<T, blockThreads>(
+            thread_val, d_partial, context.get_block_patch_id());
+    }
+}
+
+/**
+ * @brief the body of CG/PCG after s = A * p and <p, s> are computed:
+ * alpha = rz / <p, s>, x += alpha * p, r -= alpha * s, z = M^-1 * r (if a
+ * Jacobi preconditioner is given) and the per-patch partial sums of the new
+ * <r, z> are written to d_partial. The scalars are read from device memory so
+ * that there is no host synchronization within an iteration
+ */
+template <typename T, uint32_t blockThreads>
+__launch_bounds__(blockThreads) __global__
+    static void matrix_free_cg_update(const PatchInfo*         patches_info,
+                                      const uint32_t           patch_offset,
+                                      VertexAttribute<T>       x,
+                                      VertexAttribute<T>       r,
+                                      VertexAttribute<T>       z,
+                                      const VertexAttribute<T> p,
+                                      const VertexAttribute<T> s,
+                                      const VertexAttribute<T> inv_diag,
+                                      const bool               has_precond,
+                                      const T*                 d_rz,
+                                      const T*                 d_ps,
+                                      T*                       d_partial)
+{
+    const uint32_t p_id = patch_offset + blockIdx.x;
+
+    const T alpha = (d_ps == nullptr) ? T(0) : d_rz[0] / d_ps[0];
+
+    const PatchInfo& pi = patches_info[p_id];
+
+    T thread_val = 0;
+    for (uint16_t v = threadIdx.x; v < pi.num_vertices[0]; v += blockThreads) {
+        if (detail::is_owned(v, pi.owned_mask_v) &&
+            !detail::is_deleted(v, pi.active_mask_v)) {
+            const VertexHandle vh(p_id, v);
+            for (uint32_t i = 0; i < x.get_num_attributes(); ++i) {
+                x(vh, i) += alpha * p(vh, i);
+                const T ri = r(vh, i) - alpha * s(vh, i);
+                r(vh, i)   = ri;
+                const T zi = has_precond ? inv_diag(vh, i) * ri : ri;
+                if (has_precond) {
+                    z(vh, i) = zi;
+                }
+                thread_val += ri * zi;
+            }
+        }
+    }
+
+    cub_block_sum<T, blockThreads>(thread_val, d_partial, p_id);
+}
+
+/**
+ * @brief p = z + beta * p where beta = rz_new / rz_old. If d_rz_old is null,
+ * this is the first iteration and p = z
+ */
+template <typename T, uint32_t blockThreads>
+__launch_bounds__(blockThreads) __global__
+    static void matrix_free_cg_direction(const PatchInfo*         patches_info,
+                                         const uint32_t           patch_offset,
+                                         VertexAttribute<T>       p,
+                                         const VertexAttribute<T> z,
+                                         const T*                 d_rz_new,
+                                         const T*                 d_rz_old)
+{
+    const uint32_t p_id = patch_offset + blockIdx.x;
+
+    // p is not initialized on the first iteration and so it is not read
+    // (0 * NaN is NaN)
+    const bool first = (d_rz_old == nullptr);
+    const T    beta  = first ? T(0) : d_rz_new[0] / d_rz_old[0];
+
+    const PatchInfo& pi = patches_info[p_id];
+
+    for (uint16_t v = threadIdx.x; v < pi.num_vertices[0]; v += blockThreads) {
+        if (detail::is_owned(v, pi.owned_mask_v) &&
+            !detail::is_deleted(v, pi.active_mask_v)) {
+            const VertexHandle vh(p_id, v);
+            for (uint32_t i = 0; i < p.get_num_attributes(); ++i) {
+                p(vh, i) = first ? z(vh, i) : z(vh, i) + beta * p(vh, i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief r = b - s
+ */
+template <typename T, uint32_t blockThreads>
+__launch_bounds__(blockThreads) __global__
+    static void matrix_free_cg_residual(const PatchInfo*         patches_info,
+                                        const uint32_t           patch_offset,
+                                        VertexAttribute<T>       r,
+                                        const VertexAttribute<T> b,
+                                        const VertexAttribute<T> s)
+{
+    const uint32_t p_id = patch_offset + blockIdx.x;
+
+    const PatchInfo& pi = patches_info[p_id];
+
+    for (uint16_t v = threadIdx.x; v < pi.num_vertices[0]; v += blockThreads) {
+        if (detail::is_owned(v, pi.owned_mask_v) &&
+            !detail::is_deleted(v, pi.active_mask_v)) {
+            const VertexHandle vh(p_id, v);
+            for (uint32_t i = 0; i < r.get_num_attributes(); ++i) {
+                r(vh, i) = b(vh, i) - s(vh, i);
+            }
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief compute out = A * in without assembling A where A is given by matvec
+ * (see the top of this file)
+ * @param rx the mesh
+ * @param matvec __device__ lambda that computes the rows of one vertex
+ * @param in the input vector (allocated on the device)
+ * @param out the output vector (allocated on the device)
+ * @param oriented if the VV query should be oriented (e.g., for cotan
+ * weights)
+ * @param stream the stream to launch the kernel on
+ */
+template <typename T, uint32_t blockThreads = 256, typename MatVecT>
+void matrix_free_spmv(const RXMeshStatic&       rx,
+                      MatVecT                   matvec,
+                      const VertexAttribute<T>& in,
+                      VertexAttribute<T>&       out,
+                      const bool                oriented = false,
+                      cudaStream_t              stream   = NULL)
+{
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV},
+        lb,
+        (void*)detail::matrix_free_matvec<T, blockThreads, MatVecT>,
+        oriented);
+    rx.run_query_kernel(
+        lb,
+        detail::matrix_free_matvec<T, blockThreads, MatVecT>,
+        stream,
+        in,
+        out,
+        matvec,
+        static_cast<T*>(nullptr),
+        oriented);
+}
+
+/**
+ * @brief Matrix-free conjugate gradient (CG) solver for symmetric positive
+ * definite systems A * x = b where A is given by a matvec lambda (see the top
+ * of this file). Optionally, a Jacobi (diagonal) preconditioner is used
+ * (PCG). Every iteration runs three kernels (the SpMV fused with <p, A*p>,
+ * the x/r/z update fused with <r, z>, and the direction update) and two
+ * device-wide sums. All scalars stay on the device and the host only reads
+ * the residual every check_frequency iterations to test for convergence.
+ * The work vectors are attributes owned by rx. Multi-GPU meshes are not
+ * supported
+ */
+template <typename T, uint32_t blockThreads = 256>
+class MatrixFreeCG
+{
+   public:
+    /**
+     * @brief allocate the work vectors with num_attributes per vertex
+     * @param rx the mesh
+     * @param num_attributes number of right-hand sides (e.g., 3 for
+     * coordinates)
+     * @param max_num_iter maximum number of iterations
+     * @param tolerance stop when |r|_M < tolerance * |r_0|_M
+     * @param check_frequency the number of iterations between two
+     * convergence checks (i.e., host synchronizations)
+     */
+    MatrixFreeCG(RXMeshStatic&  rx,
+                 const uint32_t num_attributes,
+                 const uint32_t max_num_iter    = 1000,
+                 const T        tolerance       = T(1e-6),
+                 const uint32_t check_frequency = 1)
+        : m_rx(rx),
+          m_num_attributes(num_attributes),
+          m_max_num_iter(max_num_iter),
+          m_tolerance(tolerance),
+          m_check_frequency(std::max(check_frequency, uint32_t(1))),
+          m_num_iter(0),
+          m_residual(0),
+          m_d_partial(nullptr),
+          m_d_scalars(nullptr),
+          m_d_temp_storage(nullptr),
+          m_temp_storage_bytes(0)
+    {
+        if (rx.is_multi_gpu()) {
+            RXMESH_ERROR(
+                "MatrixFreeCG::MatrixFreeCG() multi-GPU meshes are not "
+                "supported");
+        }
+
+        m_r = rx.add_vertex_attribute<T>(
+            "rx:mfcg_r", num_attributes, DEVICE, AoSPadded);
+        m_z = rx.add_vertex_attribute<T>(
+            "rx:mfcg_z", num_attributes, DEVICE, AoSPadded);
+        m_p = rx.add_vertex_attribute<T>(
+            "rx:mfcg_p", num_attributes, DEVICE, AoSPadded);
+        m_s = rx.add_vertex_attribute<T>(
+            "rx:mfcg_s", num_attributes, DEVICE, AoSPadded);
+
+        const uint32_t num_patches = rx.get_num_patches();
+        CUDA_ERROR(cudaMalloc((void**)&m_d_partial, num_patches * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_scalars, 3 * sizeof(T)));
+
+        cub::DeviceReduce::Sum(m_d_temp_storage,
+                               m_temp_storage_bytes,
+                               m_d_partial,
+                               m_d_scalars,
+                               num_patches);
+        CUDA_ERROR(cudaMalloc(&m_d_temp_storage, m_temp_storage_bytes));
+    }
+
+    MatrixFreeCG(const MatrixFreeCG&)            = delete;
+    MatrixFreeCG& operator=(const MatrixFreeCG&) = delete;
+
+    ~MatrixFreeCG()
+    {
+        GPU_FREE(m_d_partial);
+        GPU_FREE(m_d_scalars);
+        GPU_FREE(m_d_temp_storage);
+        m_rx.remove_attribute("rx:mfcg_r");
+        m_rx.remove_attribute("rx:mfcg_z");
+        m_rx.remove_attribute("rx:mfcg_p");
+        m_rx.remove_attribute("rx:mfcg_s");
+    }
+
+    /**
+     * @brief solve A * x = b. x is used as the initial guess
+     * @param matvec __device__ lambda that computes A * in for one vertex
+     * @param x the initial guess and the output (on the device)
+     * @param b the right-hand side (on the device)
+     * @param inv_diag the inverse of the diagonal of A (same number of
+     * attributes as x) for Jacobi preconditioning. Pass nullptr for plain CG
+     * @param oriented if the VV query should be oriented
+     * @param stream the stream to launch the kernels on
+     * @return the number of iterations taken
+     */
+    template <typename MatVecT>
+    uint32_t solve(MatVecT                   matvec,
+                   VertexAttribute<T>&       x,
+                   const VertexAttribute<T>& b,
+                   const VertexAttribute<T>* inv_diag = nullptr,
+                   const bool                oriented = false,
+                   cudaStream_t              stream   = NULL)
+    {
+        if (x.get_num_attributes() != m_num_attributes ||
+            b.get_num_attributes() != m_num_attributes) {
+            RXMESH_ERROR(
+                "MatrixFreeCG::solve() the number of attributes of x and b "
+                "should be {}",
+                m_num_attributes);
+            return 0;
+        }
+
+        const bool         precond = (inv_diag != nullptr);
+        VertexAttribute<T> z       = precond ? *m_z : *m_r;
+        VertexAttribute<T> dinv    = precond ? *inv_diag : *m_r;
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box(
+            {Op::VV},
+            lb,
+            (void*)detail::matrix_free_matvec<T, blockThreads, MatVecT>,
+            oriented);
+
+        // s = A * x, r = b - s, z = M^-1 * r, rz = <r, z>, p = z
+        m_rx.run_query_kernel(
+            lb,
+            detail::matrix_free_matvec<T, blockThreads, MatVecT>,
+            stream,
+            x,
+            *m_s,
+            matvec,
+            static_cast<T*>(nullptr),
+            oriented);
+        over_patches(stream, [&](uint32_t begin, uint32_t count) {
+            detail::matrix_free_cg_residual<T, blockThreads>
+                <<<count, blockThreads, 0, stream>>>(
+                    m_rx.get_context().m_patches_info, begin, *m_r, b, *m_s);
+        });
+        over_patches(stream, [&](uint32_t begin, uint32_t count) {
+            detail::matrix_free_cg_update<T, blockThreads>
+                <<<count, blockThreads, 0, stream>>>(
+                    m_rx.get_context().m_patches_info,
+                    begin,
+                    x,
+                    *m_r,
+                    z,
+                    *m_p,
+                    *m_s,
+                    dinv,
+                    precond,
+                    m_d_scalars,
+                    nullptr,
+                    m_d_partial);
+        });
+        sum_partial(m_d_scalars + 0, stream);
+        over_patches(stream, [&](uint32_t begin, uint32_t count) {
+            detail::matrix_free_cg_direction<T, blockThreads>
+                <<<count, blockThreads, 0, stream>>>(
+                    m_rx.get_context().m_patches_info,
+                    begin,
+                    *m_p,
+                    z,
+                    m_d_scalars,
+                    nullptr);
+        });
+
+        const T rz_0 = read_scalar(0, stream);
+        m_residual   = std::sqrt(rz_0);
+        m_num_iter   = 0;
+        if (rz_0 == T(0)) {
+            return 0;
+        }
+
+        // the two <r, z> are double buffered in m_d_scalars[0, 1] while
+        // <p, s> is in m_d_scalars[2]
+        T* d_ps = m_d_scalars + 2;
+        int cur = 0;
+
+        while (m_num_iter < m_max_num_iter) {
+            T* d_rz     = m_d_scalars + cur;
+            T* d_rz_new = m_d_scalars + (1 - cur);
+
+            // s = A * p and <p, s>
+            m_rx.run_query_kernel(
+                lb,
+                detail::matrix_free_matvec<T, blockThreads, MatVecT>,
+                stream,
+                *m_p,
+                *m_s,
+                matvec,
+                m_d_partial,
+                oriented);
+            sum_partial(d_ps, stream);
+
+            // x, r, z and <r, z>
+            over_patches(stream, [&](uint32_t begin, uint32_t count) {
+                detail::matrix_free_cg_update<T, blockThreads>
+                    <<<count, blockThreads, 0, stream>>>(
+                        m_rx.get_context().m_patches_info,
+                        begin,
+                        x,
+                        *m_r,
+                        z,
+                        *m_p,
+                        *m_s,
+                        dinv,
+                        precond,
+                        d_rz,
+                        d_ps,
+                        m_d_partial);
+            });
+            sum_partial(d_rz_new, stream);
+
+            ++m_num_iter;
+
+            if (m_num_iter % m_check_frequency == 0 ||
+                m_num_iter == m_max_num_iter) {
+                const T rz_new = read_scalar(1 - cur, stream);
+                m_residual     = std::sqrt(std::abs(rz_new));
+                if (std::abs(rz_new) <
+                    m_tolerance * m_tolerance * std::abs(rz_0)) {
+                    break;
+                }
+            }
+
+            // p = z + beta * p
+            over_patches(stream, [&](uint32_t begin, uint32_t count) {
+                detail::matrix_free_cg_direction<T, blockThreads>
+                    <<<count, blockThreads, 0, stream>>>(
+                        m_rx.get_context().m_patches_info,
+                        begin,
+                        *m_p,
+                        z,
+                        d_rz_new,
+                        d_rz);
+            });
+
+            cur = 1 - cur;
+        }
+
+        return m_num_iter;
+    }
+
+    /**
+     * @brief the number of iterations taken by the last solve
+     */
+    uint32_t get_num_iterations() const
+    {
+        return m_num_iter;
+    }
+
+    /**
+     * @brief the (preconditioned) residual norm at the last convergence check
+     * i.e., sqrt(<r, M^-1 r>)
+     */
+    T get_residual() const
+    {
+        return m_residual;
+    }
+
+   private:
+    template <typename LaunchT>
+    void over_patches(cudaStream_t stream, LaunchT launch)
+    {
+        m_rx.run_over_patches(
+            stream, [&](uint32_t begin, uint32_t count, cudaStream_t) {
+                launch(begin, count);
+            });
+    }
+
+    void sum_partial(T* d_output, cudaStream_t stream)
+    {
+        cub::DeviceReduce::Sum(m_d_temp_storage,
+                               m_temp_storage_bytes,
+                               m_d_partial,
+                               d_output,
+                               m_rx.get_num_patches(),
+                               stream);
+    }
+
+    T read_scalar(const int id, cudaStream_t stream)
+    {
+        T h_val = 0;
+        CUDA_ERROR(cudaMemcpyAsync(&h_val,
+                                   m_d_scalars + id,
+                                   sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return h_val;
+    }
+
+    RXMeshStatic&                       m_rx;
+    uint32_t                            m_num_attributes;
+    uint32_t                            m_max_num_iter;
+    T                                   m_tolerance;
+    uint32_t                            m_check_frequency;
+    uint32_t                            m_num_iter;
+    T                                   m_residual;
+    std::shared_ptr<VertexAttribute<T>> m_r, m_z, m_p, m_s;
+    T*                                  m_d_partial;
+    T*                                  m_d_scalars;
+    void*                               m_d_temp_storage;
+    size_t                              m_temp_storage_bytes;
+};
+}  // namespace rxmesh
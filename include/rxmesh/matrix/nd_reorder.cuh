@@ -23,11 +23,15 @@
 
 namespace rxmesh {
 
+// the separator labels store the separator level in their last decimal digit
+// (see generate_total_num_v_prefix_sum) so the number of levels is < 10
+constexpr uint32_t ND_MAX_LEVEL = 9;
+
 /**
  * @brief Cast a uint32_t to an int, throwing an exception if the value is too
  * large to fit in an int.
  */
-bool arr_check_uint32_to_int_cast(const uint32_t* arr, size_t size)
+inline bool arr_check_uint32_to_int_cast(const uint32_t* arr, size_t size)
 {
     static_assert(sizeof(int) >= sizeof(uint32_t),
                   "int must be at least 32 bits wide");
@@ -86,7 +90,7 @@ __global__ static void nd_init_edge_weight(const rxmesh::Context context)
 // TODO use shared alloc for this instead of static shared memory
 // TODO: check correctness of compilation
 template <uint32_t blockThreads>
-__global__ void bipartition_init_random_seeds(
+__global__ static void bipartition_init_random_seeds(
     uint32_t* d_patch_partition_label,
     uint32_t* d_patch_seed_hop_dist,
     uint32_t* d_patch_seed_label_count,
@@ -1129,7 +1133,7 @@ __global__ static void nd_mark_vertex_separator(
     query.dispatch<Op::VV>(block, shrd_alloc, vv_extract_separartors);
 }
 
-__global__ void update_partition_label_kernel(
+__global__ static void update_partition_label_kernel(
     uint32_t* d_patch_partition_label,
     uint32_t* d_patch_local_partition_label,
     uint32_t* d_patch_seed_label_balanced_count,
@@ -1186,10 +1190,11 @@ __global__ static void nd_count_vertex_num(
 }
 
 template <uint32_t blockThreads>
-__global__ void tmp_copy_spv_index(uint32_t* d_spv_prefix_sum_mapping_arr,
-                                   uint32_t* d_patch_prefix_sum_mapping_arr,
-                                   uint32_t  num_patches,
-                                   uint32_t  num_patch_separator)
+__global__ static void tmp_copy_spv_index(
+    uint32_t* d_spv_prefix_sum_mapping_arr,
+    uint32_t* d_patch_prefix_sum_mapping_arr,
+    uint32_t  num_patches,
+    uint32_t  num_patch_separator)
 {
     uint32_t idx = blockIdx.x * blockDim.x + threadIdx.x;
     if (idx == 0) {
@@ -1201,7 +1206,7 @@ __global__ void tmp_copy_spv_index(uint32_t* d_spv_prefix_sum_mapping_arr,
 }
 
 template <uint32_t blockThreads>
-__global__ void copy_scaled_patch_label(
+__global__ static void copy_scaled_patch_label(
     uint32_t* d_patch_partition_label,
     uint32_t* d_scaled_patch_partition_label,
     uint32_t  num_patches)
@@ -1214,9 +1219,9 @@ __global__ void copy_scaled_patch_label(
 
 // TODO make this parallel
 template <uint32_t blockThreads>
-__global__ void copy_scaled_spv_label(uint32_t* d_tmp_total_label,
-                                      uint32_t  num_patches,
-                                      uint32_t  nd_level)
+__global__ static void copy_scaled_spv_label(uint32_t* d_tmp_total_label,
+                                             uint32_t  num_patches,
+                                             uint32_t  nd_level)
 {
     uint32_t idx = blockIdx.x * blockDim.x + threadIdx.x;
 
@@ -1262,8 +1267,8 @@ void generate_total_num_v_prefix_sum(uint32_t* d_patch_partition_label,
                           cudaMemcpyDeviceToDevice));
     CUDA_ERROR(cudaDeviceSynchronize());
 
-    // load the labels and multiply them by 10
-    // assume nd level < 10
+    // load the labels and multiply them by 10 so the separator level fits
+    // in the last decimal digit i.e., nd level < 10 (see ND_MAX_LEVEL)
     uint32_t* d_tmp_total_label;
     CUDA_ERROR(cudaMalloc(&d_tmp_total_label,
                           total_prefix_sum_size * sizeof(uint32_t)));
@@ -1335,6 +1340,10 @@ void generate_total_num_v_prefix_sum(uint32_t* d_patch_partition_label,
     // printf("d_total_num_v_prefix_sum: ");
     // check_d_arr<<<1, 1>>>(d_total_num_v_prefix_sum,
     // total_prefix_sum_size); CUDA_ERROR(cudaDeviceSynchronize());
+
+    GPU_FREE(d_tmp_total_label);
+    GPU_FREE(d_tmp_indices);
+    GPU_FREE(d_tmp_indices_copy);
 }
 
 template <uint32_t blockThreads>
@@ -1369,7 +1378,7 @@ __global__ static void nd_generate_numbering(
     query.dispatch<Op::VE>(block, shrd_alloc, ve_generate_numbering);
 }
 
-__global__ void nd_init_seed_label_balanced_count(
+__global__ static void nd_init_seed_label_balanced_count(
     uint32_t* d_patch_seed_label_balanced_count,
     uint32_t  num_patches)
 {
@@ -1381,13 +1390,37 @@ __global__ void nd_init_seed_label_balanced_count(
     }
 }
 
-void cuda_nd_reorder(RXMeshStatic& rx,
-                     uint32_t*     ordering_arr,
-                     uint32_t      nd_level,
-                     bool          is_global_id = false)
+/**
+ * @brief nested dissection ordering of the mesh vertices computed on the GPU
+ * using the patches as the coarse graph. Every level bi-partitions the patches
+ * (Lloyd on the patch graph) and the vertices on the boundary between two
+ * partitions form the separator. The separators are numbered after the two
+ * partitions they separate which gives an elimination order suitable for
+ * sparse Cholesky factorization
+ * @param rx the mesh
+ * @param ordering_arr host array of size num_vertices. ordering_arr[i] is the
+ * id of the vertex that is eliminated i-th (i.e., the new index i maps to the
+ * old index ordering_arr[i])
+ * @param nd_level the number of dissection levels. See nd_auto_level()
+ * @param is_global_id if true, ordering_arr stores the vertices global id.
+ * Otherwise, it stores their linear_id()
+ */
+inline void cuda_nd_reorder(RXMeshStatic& rx,
+                            uint32_t*     ordering_arr,
+                            uint32_t      nd_level,
+                            bool          is_global_id = false)
 {
     constexpr uint32_t blockThreads = 256;
 
+    if (nd_level > ND_MAX_LEVEL) {
+        RXMESH_ERROR(
+            "cuda_nd_reorder() nd_level ({}) is larger than the max supported "
+            "level ({})",
+            nd_level,
+            ND_MAX_LEVEL);
+        return;
+    }
+
     uint32_t blocks  = rx.get_num_patches();
     uint32_t threads = blockThreads;
 
@@ -1400,7 +1433,7 @@ void cuda_nd_reorder(RXMeshStatic& rx,
         rx.add_vertex_attribute<uint32_t>("v_attr_spv_label", 1);
     v_attr_spv_label->reset(INVALID32, rxmesh::DEVICE);
 
-    printf("starts reorder\n");
+    RXMESH_TRACE("cuda_nd_reorder() starts reorder");
 
     // variables for lloyd calculation
     uint32_t* d_patch_local_seeds;
@@ -1462,7 +1495,7 @@ void cuda_nd_reorder(RXMeshStatic& rx,
                           INVALID32,
                           rx.get_num_patches() * sizeof(uint32_t)));
 
-    printf("--------- start lloyd variable allocation ---------\n");
+    RXMESH_TRACE("cuda_nd_reorder() start lloyd variable allocation");
 
     // variables for prefixsum & ordering calculation
     uint32_t num_patch_separator = (1 << nd_level) - 1;
@@ -1510,7 +1543,7 @@ void cuda_nd_reorder(RXMeshStatic& rx,
                           INVALID32,
                           num_patch_separator * sizeof(uint32_t)));
 
-    printf("--------- finish variable allocation ---------\n");
+    RXMESH_TRACE("cuda_nd_reorder() finish variable allocation");
 
     // prepare launch box for GPU kernels
     LaunchBox<blockThreads> launch_box_nd_init_edge_weight;
@@ -1538,14 +1571,14 @@ void cuda_nd_reorder(RXMeshStatic& rx,
     //        launch_box_nd_init_edge_weight.smem_bytes_dyn>>>(rx.get_context());
     // CUDA_ERROR(cudaDeviceSynchronize());
 
-    printf("--------- starting partitioning with level: %u ---------\n",
-           nd_level);
+    RXMESH_TRACE("cuda_nd_reorder() starting partitioning with level: {}",
+                 nd_level);
     GPUTimer timer;
     timer.start();
 
     // big loop for each level
     for (uint32_t i = 0; i < nd_level; i++) {
-        printf("--------- level %d ---------\n", i);
+        RXMESH_TRACE("cuda_nd_reorder() level {}", i);
         // run partition lloyd
         run_partition_lloyd<blockThreads>(rx,
                                           i,
@@ -1581,7 +1614,7 @@ void cuda_nd_reorder(RXMeshStatic& rx,
             1 << (i + 1));
     }
 
-    printf("--------- starting ordering generation ---------\n");
+    RXMESH_TRACE("cuda_nd_reorder() starting ordering generation");
 
     // count the number of vertices in each patch and vertex separator
     nd_count_vertex_num<blockThreads>
@@ -1619,7 +1652,7 @@ void cuda_nd_reorder(RXMeshStatic& rx,
             d_spv_prefix_sum_mapping_arr,
             rx.get_num_patches());
 
-    printf("---------- Finish ----------\n");
+    RXMESH_TRACE("cuda_nd_reorder() finish");
 
     timer.stop();
     float total_time = timer.elapsed_millis();
@@ -1635,8 +1668,42 @@ void cuda_nd_reorder(RXMeshStatic& rx,
 
         ordering_arr[v_order_idx] = is_global_id ? v_global_id : v_linear_id;
     });
+
+    // release the temporary buffers and attributes so the ordering could be
+    // computed again on the same mesh (e.g., by every SparseMatrix::pre_solve)
+    GPU_FREE(d_patch_local_seeds);
+    GPU_FREE(d_patch_local_partition_role);
+    GPU_FREE(d_patch_local_partition_label);
+    GPU_FREE(d_tmp_patch_local_partition_label);
+    GPU_FREE(d_num_seeds);
+    GPU_FREE(d_labeled_patch_size);
+    GPU_FREE(d_patch_local_seed_label_count);
+    GPU_FREE(d_patch_seed_label_balanced_count);
+    GPU_FREE(d_patch_seed_hop_dist);
+    GPU_FREE(d_patch_partition_label);
+    GPU_FREE(d_patch_num_v);
+    GPU_FREE(d_spv_num_v_heap);
+    GPU_FREE(d_total_num_v_prefix_sum);
+    GPU_FREE(d_patch_prefix_sum_mapping_arr);
+    GPU_FREE(d_spv_prefix_sum_mapping_arr);
+
+    rx.remove_attribute("v_attr_ordering");
+    rx.remove_attribute("v_attr_spv_label");
 }
 
-// automatically num levels - no need to specify hyper parameters
+/**
+ * @brief the number of nested dissection levels for cuda_nd_reorder() such
+ * that the leaves of the dissection tree hold (at least) two patches each.
+ * Capped by ND_MAX_LEVEL
+ */
+inline uint32_t nd_auto_level(const RXMeshStatic& rx)
+{
+    uint32_t level = 0;
+    while ((uint32_t(4) << level) <= rx.get_num_patches() &&
+           level < ND_MAX_LEVEL) {
+        level++;
+    }
+    return std::max(level, uint32_t(1));
+}
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,741 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "thrust/device_ptr.h"
+#include "thrust/execution_policy.h"
+#include "thrust/inner_product.h"
+
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/sparse_matrix.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+template <typename T, typename IndexT>
+__global__ static void mg_residual(const IndexT  n,
+                                   const IndexT* row_ptr,
+                                   const IndexT* col_idx,
+                                   const T*      val,
+                                   const T*      x,
+                                   const T*      b,
+                                   T*            r)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        T sum = 0;
+        for (IndexT k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            sum += val[k] * x[col_idx[k]];
+        }
+        r[i] = (b == nullptr) ? sum : b[i] - sum;
+    }
+}
+
+template <typename T, typename IndexT>
+__global__ static void mg_jacobi(const IndexT n,
+                                 const T*     inv_diag,
+                                 const T*     r,
+                                 const T      omega,
+                                 T*           x)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        x[i] += omega * inv_diag[i] * r[i];
+    }
+}
+
+template <typename T, typename IndexT>
+__global__ static void mg_restrict(const IndexT  n,
+                                   const IndexT* aggregate,
+                                   const T*      r,
+                                   T*            coarse_b)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        ::atomicAdd(coarse_b + aggregate[i], r[i]);
+    }
+}
+
+template <typename T, typename IndexT>
+__global__ static void mg_prolong(const IndexT  n,
+                                  const IndexT* aggregate,
+                                  const T*      coarse_x,
+                                  T*            x)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        x[i] += coarse_x[aggregate[i]];
+    }
+}
+
+template <typename T, typename IndexT>
+__global__ static void mg_dense_matvec(const IndexT n,
+                                       const T*     mat,
+                                       const T*     b,
+                                       T*           x)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        T sum = 0;
+        for (IndexT j = 0; j < n; ++j) {
+            sum += mat[i * n + j] * b[j];
+        }
+        x[i] = sum;
+    }
+}
+
+template <typename T, typename IndexT>
+__global__ static void mg_axpby(const IndexT n,
+                                const T      alpha,
+                                const T*     x,
+                                const T      beta,
+                                T*           y)
+{
+    for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += blockDim.x * gridDim.x) {
+        y[i] = alpha * x[i] + beta * y[i];
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief Aggregation multigrid for a SparseMatrix built from the patches. The
+ * fine vertices are grouped into small aggregates (a vertex and its
+ * unaggregated one-ring) that never cross a patch boundary. These aggregates
+ * are aggregated again the same way until every patch is a single coarse node
+ * i.e., the patches are the aggregates of that level. From there on, the
+ * patch graph is coarsened recursively (without the patch constraint) until
+ * it has at most coarsest_size nodes which is solved directly. Every level
+ * uses the Galerkin operator P^T A P with piecewise-constant prolongation P
+ * and weighted Jacobi smoothing. The hierarchy is built on the host once (or
+ * when the matrix values change by calling setup() again) while the V-cycles
+ * and the conjugate gradient run on the device. The V-cycle is symmetric so
+ * it can be used as a preconditioner for CG on SPD matrices which is what
+ * solve() does
+ */
+template <typename T>
+class PatchMultigrid
+{
+   public:
+    using IndexT = int;
+
+    /**
+     * @brief build the multigrid hierarchy for A
+     * @param rx the mesh A is built on (a VV matrix)
+     * @param A the matrix whose values are on the device
+     * @param num_smooth number of Jacobi sweeps before and after the coarse
+     * correction on every level
+     * @param omega Jacobi damping factor
+     * @param coarsest_size stop coarsening once a level has at most this many
+     * nodes. The coarsest level is solved with a dense factorization
+     * @param max_num_levels maximum number of levels (including the finest)
+     */
+    PatchMultigrid(const RXMeshStatic& rx,
+                   SparseMatrix<T>&    A,
+                   const uint32_t      num_smooth     = 2,
+                   const T             omega          = T(2) / T(3),
+                   const IndexT        coarsest_size  = 256,
+                   const uint32_t      max_num_levels = 16)
+        : m_num_smooth(num_smooth),
+          m_omega(omega),
+          m_coarsest_size(std::max(coarsest_size, IndexT(1))),
+          m_max_num_levels(std::max(max_num_levels, uint32_t(2))),
+          m_d_coarsest_inv(nullptr),
+          m_d_pcg_r(nullptr),
+          m_d_pcg_z(nullptr),
+          m_d_pcg_p(nullptr),
+          m_d_pcg_s(nullptr),
+          m_num_iter(0),
+          m_residual(0)
+    {
+        m_group.resize(A.rows());
+        rx.for_each_vertex(
+            HOST,
+            [&](const VertexHandle vh) {
+                m_group[rx.linear_id(vh)] = vh.patch_id();
+            },
+            NULL,
+            false);
+        setup(A);
+    }
+
+    PatchMultigrid(const PatchMultigrid&)            = delete;
+    PatchMultigrid& operator=(const PatchMultigrid&) = delete;
+
+    ~PatchMultigrid()
+    {
+        release();
+    }
+
+    /**
+     * @brief (re)build the hierarchy from the current device values of A.
+     * A is moved to the host
+     */
+    __host__ void setup(SparseMatrix<T>& A)
+    {
+        release();
+
+        A.move(DEVICE, HOST);
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        HostLevel fine;
+        fine.n = A.rows();
+        fine.row_ptr.assign(A.row_ptr(), A.row_ptr() + fine.n + 1);
+        fine.col_idx.assign(A.col_idx(), A.col_idx() + A.non_zeros());
+        fine.val.resize(A.non_zeros());
+        for (IndexT k = 0; k < A.non_zeros(); ++k) {
+            fine.val[k] = A.get_val_at(k);
+        }
+
+        std::vector<HostLevel> host_levels;
+        host_levels.push_back(std::move(fine));
+
+        std::vector<uint32_t> group       = m_group;
+        bool                  constrained = true;
+
+        while (host_levels.back().n > m_coarsest_size &&
+               host_levels.size() < m_max_num_levels) {
+            HostLevel& level = host_levels.back();
+
+            IndexT num_agg =
+                aggregate(level, constrained ? &group : nullptr, level.agg);
+
+            // once the aggregation within the patches does not coarsen
+            // anymore (every patch is (almost) a single node), coarsen the
+            // patch graph itself
+            if (constrained && 10 * num_agg > 9 * level.n) {
+                constrained = false;
+                num_agg     = aggregate(level, nullptr, level.agg);
+            }
+
+            if (num_agg == level.n) {
+                level.agg.clear();
+                break;
+            }
+
+            HostLevel coarse = galerkin(level, num_agg);
+
+            if (constrained) {
+                std::vector<uint32_t> coarse_group(num_agg);
+                for (IndexT i = 0; i < level.n; ++i) {
+                    coarse_group[level.agg[i]] = group[i];
+                }
+                group = std::move(coarse_group);
+            }
+
+            host_levels.push_back(std::move(coarse));
+        }
+
+        for (auto& hl : host_levels) {
+            m_levels.push_back(upload(hl));
+        }
+
+        coarsest_factorize(host_levels.back());
+
+        const IndexT n = m_levels[0].n;
+        CUDA_ERROR(cudaMalloc((void**)&m_d_pcg_r, n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_pcg_z, n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_pcg_p, n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_pcg_s, n * sizeof(T)));
+
+        RXMESH_TRACE("PatchMultigrid::setup() {} levels, coarsest size = {}",
+                     m_levels.size(),
+                     m_levels.back().n);
+    }
+
+    /**
+     * @brief apply one V-cycle (starting from a zero initial guess) i.e.,
+     * d_x = M^{-1} * d_b where M is the multigrid preconditioner. Both are
+     * device arrays of size rows()
+     */
+    __host__ void vcycle(const T* d_b, T* d_x, cudaStream_t stream = NULL)
+    {
+        vcycle(0, d_b, d_x, stream);
+    }
+
+    /**
+     * @brief solve A*x = b using conjugate gradient preconditioned by one
+     * V-cycle per iteration. d_x is used as the initial guess
+     * @param d_b right-hand side on the device
+     * @param d_x solution on the device
+     * @param max_num_iter maximum number of iterations
+     * @param tolerance relative residual norm i.e., |b-Ax| / |b|
+     * @return the number of iterations
+     */
+    __host__ uint32_t solve(const T*     d_b,
+                            T*           d_x,
+                            uint32_t     max_num_iter = 1000,
+                            T            tolerance    = 1e-6,
+                            cudaStream_t stream       = NULL)
+    {
+        const Level& fine = m_levels[0];
+        const IndexT n    = fine.n;
+
+        m_num_iter = 0;
+
+        const T b_norm = std::sqrt(dot(d_b, d_b, stream));
+        if (b_norm == T(0)) {
+            CUDA_ERROR(cudaMemsetAsync(d_x, 0, n * sizeof(T), stream));
+            m_residual = 0;
+            return 0;
+        }
+
+        // r = b - A*x, z = M^{-1}*r, p = z
+        residual(fine, d_x, d_b, m_d_pcg_r, stream);
+        vcycle(0, m_d_pcg_r, m_d_pcg_z, stream);
+        CUDA_ERROR(cudaMemcpyAsync(m_d_pcg_p,
+                                   m_d_pcg_z,
+                                   n * sizeof(T),
+                                   cudaMemcpyDeviceToDevice,
+                                   stream));
+        T rz = dot(m_d_pcg_r, m_d_pcg_z, stream);
+
+        m_residual = std::sqrt(dot(m_d_pcg_r, m_d_pcg_r, stream)) / b_norm;
+
+        while (m_num_iter < max_num_iter && m_residual > tolerance) {
+            // s = A*p
+            residual(fine, m_d_pcg_p, nullptr, m_d_pcg_s, stream);
+
+            const T pAp   = dot(m_d_pcg_p, m_d_pcg_s, stream);
+            const T alpha = rz / pAp;
+
+            axpby(n, alpha, m_d_pcg_p, T(1), d_x, stream);
+            axpby(n, -alpha, m_d_pcg_s, T(1), m_d_pcg_r, stream);
+
+            m_num_iter++;
+
+            m_residual = std::sqrt(dot(m_d_pcg_r, m_d_pcg_r, stream)) / b_norm;
+            if (m_residual <= tolerance) {
+                break;
+            }
+
+            vcycle(0, m_d_pcg_r, m_d_pcg_z, stream);
+
+            const T rz_new = dot(m_d_pcg_r, m_d_pcg_z, stream);
+            const T beta   = rz_new / rz;
+            rz             = rz_new;
+
+            axpby(n, T(1), m_d_pcg_z, beta, m_d_pcg_p, stream);
+        }
+
+        return m_num_iter;
+    }
+
+    /**
+     * @brief solve for every column of B. X is used as the initial guess
+     */
+    __host__ void solve(DenseMatrix<T>& B_mat,
+                        DenseMatrix<T>& X_mat,
+                        uint32_t        max_num_iter = 1000,
+                        T               tolerance    = 1e-6,
+                        cudaStream_t    stream       = NULL)
+    {
+        for (uint32_t i = 0; i < B_mat.cols(); ++i) {
+            solve(B_mat.col_data(i),
+                  X_mat.col_data(i),
+                  max_num_iter,
+                  tolerance,
+                  stream);
+        }
+    }
+
+    /**
+     * @brief number of rows of the finest level
+     */
+    __host__ IndexT rows() const
+    {
+        return m_levels.empty() ? 0 : m_levels[0].n;
+    }
+
+    /**
+     * @brief number of levels including the finest and coarsest
+     */
+    __host__ uint32_t get_num_levels() const
+    {
+        return m_levels.size();
+    }
+
+    /**
+     * @brief number of nodes (rows) on a level
+     */
+    __host__ IndexT get_level_size(const uint32_t level) const
+    {
+        return m_levels[level].n;
+    }
+
+    /**
+     * @brief number of iterations of the last solve()
+     */
+    __host__ uint32_t get_num_iterations() const
+    {
+        return m_num_iter;
+    }
+
+    /**
+     * @brief relative residual norm of the last solve()
+     */
+    __host__ T get_residual() const
+    {
+        return m_residual;
+    }
+
+    /**
+     * @brief release all the device memory of the hierarchy
+     */
+    __host__ void release()
+    {
+        for (auto& l : m_levels) {
+            GPU_FREE(l.d_row_ptr);
+            GPU_FREE(l.d_col_idx);
+            GPU_FREE(l.d_val);
+            GPU_FREE(l.d_inv_diag);
+            GPU_FREE(l.d_agg);
+            GPU_FREE(l.d_x);
+            GPU_FREE(l.d_b);
+            GPU_FREE(l.d_r);
+        }
+        m_levels.clear();
+        GPU_FREE(m_d_coarsest_inv);
+        GPU_FREE(m_d_pcg_r);
+        GPU_FREE(m_d_pcg_z);
+        GPU_FREE(m_d_pcg_p);
+        GPU_FREE(m_d_pcg_s);
+    }
+
+   private:
+    static constexpr uint32_t blockThreads = 256;
+
+    struct HostLevel
+    {
+        IndexT              n = 0;
+        std::vector<IndexT> row_ptr;
+        std::vector<IndexT> col_idx;
+        std::vector<T>      val;
+        // the coarse node of every node (empty on the coarsest level)
+        std::vector<IndexT> agg;
+    };
+
+    struct Level
+    {
+        IndexT  n          = 0;
+        IndexT  nnz        = 0;
+        IndexT* d_row_ptr  = nullptr;
+        IndexT* d_col_idx  = nullptr;
+        T*      d_val      = nullptr;
+        T*      d_inv_diag = nullptr;
+        IndexT* d_agg      = nullptr;
+        T*      d_x        = nullptr;
+        T*      d_b        = nullptr;
+        T*      d_r        = nullptr;
+    };
+
+    /**
+     * @brief greedy aggregation: a node whose neighbors are all unaggregated
+     * forms an aggregate with them. The remaining nodes join the aggregate of
+     * one of their neighbors or become a singleton. If group is not null, two
+     * nodes are aggregated only if they are in the same group (patch)
+     */
+    IndexT aggregate(const HostLevel&             level,
+                     const std::vector<uint32_t>* group,
+                     std::vector<IndexT>&         agg) const
+    {
+        const IndexT n = level.n;
+        agg.assign(n, -1);
+
+        auto connected = [&](IndexT i, IndexT k) {
+            const IndexT j = level.col_idx[k];
+            return j != i && level.val[k] != T(0) &&
+                   (group == nullptr || (*group)[i] == (*group)[j]);
+        };
+
+        IndexT num_agg = 0;
+        for (IndexT i = 0; i < n; ++i) {
+            if (agg[i] != -1) {
+                continue;
+            }
+            bool free = true;
+            for (IndexT k = level.row_ptr[i]; k < level.row_ptr[i + 1]; ++k) {
+                if (connected(i, k) && agg[level.col_idx[k]] != -1) {
+                    free = false;
+                    break;
+                }
+            }
+            if (!free) {
+                continue;
+            }
+            agg[i] = num_agg;
+            for (IndexT k = level.row_ptr[i]; k < level.row_ptr[i + 1]; ++k) {
+                if (connected(i, k)) {
+                    agg[level.col_idx[k]] = num_agg;
+                }
+            }
+            num_agg++;
+        }
+
+        // the leftovers join the aggregate of a neighbor from the first pass
+        // (not of another leftover) to keep the aggregates compact
+        const std::vector<IndexT> first = agg;
+        for (IndexT i = 0; i < n; ++i) {
+            if (agg[i] != -1) {
+                continue;
+            }
+            for (IndexT k = level.row_ptr[i]; k < level.row_ptr[i + 1]; ++k) {
+                if (connected(i, k) && first[level.col_idx[k]] != -1) {
+                    agg[i] = first[level.col_idx[k]];
+                    break;
+                }
+            }
+            if (agg[i] == -1) {
+                agg[i] = num_agg++;
+            }
+        }
+        return num_agg;
+    }
+
+    /**
+     * @brief the coarse operator P^T * A * P where P is the piecewise-constant
+     * prolongation defined by level.agg
+     */
+    HostLevel galerkin(const HostLevel& level, const IndexT num_agg) const
+    {
+        // the fine nodes of every aggregate
+        std::vector<IndexT> agg_ptr(num_agg + 1, 0);
+        for (IndexT i = 0; i < level.n; ++i) {
+            agg_ptr[level.agg[i] + 1]++;
+        }
+        for (IndexT a = 0; a < num_agg; ++a) {
+            agg_ptr[a + 1] += agg_ptr[a];
+        }
+        std::vector<IndexT> offset(agg_ptr.begin(), agg_ptr.end() - 1);
+        std::vector<IndexT> members(level.n);
+        for (IndexT i = 0; i < level.n; ++i) {
+            members[offset[level.agg[i]]++] = i;
+        }
+
+        HostLevel coarse;
+        coarse.n = num_agg;
+        coarse.row_ptr.resize(num_agg + 1, 0);
+
+        std::vector<IndexT> marker(num_agg, -1);
+        std::vector<IndexT> pos(num_agg, 0);
+
+        for (IndexT a = 0; a < num_agg; ++a) {
+            for (IndexT m = agg_ptr[a]; m < agg_ptr[a + 1]; ++m) {
+                const IndexT i = members[m];
+                for (IndexT k = level.row_ptr[i]; k < level.row_ptr[i + 1];
+                     ++k) {
+                    const IndexT b = level.agg[level.col_idx[k]];
+                    if (marker[b] != a) {
+                        marker[b] = a;
+                        pos[b]    = coarse.col_idx.size();
+                        coarse.col_idx.push_back(b);
+                        coarse.val.push_back(T(0));
+                    }
+                    coarse.val[pos[b]] += level.val[k];
+                }
+            }
+            coarse.row_ptr[a + 1] = coarse.col_idx.size();
+        }
+        return coarse;
+    }
+
+    Level upload(const HostLevel& hl) const
+    {
+        Level l;
+        l.n   = hl.n;
+        l.nnz = hl.col_idx.size();
+
+        std::vector<T> inv_diag(hl.n, T(0));
+        for (IndexT i = 0; i < hl.n; ++i) {
+            for (IndexT k = hl.row_ptr[i]; k < hl.row_ptr[i + 1]; ++k) {
+                if (hl.col_idx[k] == i && hl.val[k] != T(0)) {
+                    inv_diag[i] = T(1) / hl.val[k];
+                }
+            }
+        }
+
+        CUDA_ERROR(
+            cudaMalloc((void**)&l.d_row_ptr, (l.n + 1) * sizeof(IndexT)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_col_idx, l.nnz * sizeof(IndexT)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_val, l.nnz * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_inv_diag, l.n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_x, l.n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_b, l.n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&l.d_r, l.n * sizeof(T)));
+
+        CUDA_ERROR(cudaMemcpy(l.d_row_ptr,
+                              hl.row_ptr.data(),
+                              (l.n + 1) * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(l.d_col_idx,
+                              hl.col_idx.data(),
+                              l.nnz * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(l.d_val,
+                              hl.val.data(),
+                              l.nnz * sizeof(T),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(l.d_inv_diag,
+                              inv_diag.data(),
+                              l.n * sizeof(T),
+                              cudaMemcpyHostToDevice));
+
+        if (!hl.agg.empty()) {
+            CUDA_ERROR(cudaMalloc((void**)&l.d_agg, l.n * sizeof(IndexT)));
+            CUDA_ERROR(cudaMemcpy(l.d_agg,
+                                  hl.agg.data(),
+                                  l.n * sizeof(IndexT),
+                                  cudaMemcpyHostToDevice));
+        }
+        return l;
+    }
+
+    /**
+     * @brief invert the (small) coarsest operator on the host. Singular
+     * operators (e.g., Laplacian without boundary conditions) use the
+     * pseudo-inverse
+     */
+    void coarsest_factorize(const HostLevel& hl)
+    {
+        using DenseT = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+
+        if (hl.n > 4 * m_coarsest_size) {
+            RXMESH_WARN(
+                "PatchMultigrid::coarsest_factorize() the coarsest level has "
+                "{} rows which is larger than coarsest_size ({}). Try to "
+                "increase max_num_levels",
+                hl.n,
+                m_coarsest_size);
+        }
+
+        DenseT dense = DenseT::Zero(hl.n, hl.n);
+        for (IndexT i = 0; i < hl.n; ++i) {
+            for (IndexT k = hl.row_ptr[i]; k < hl.row_ptr[i + 1]; ++k) {
+                dense(i, hl.col_idx[k]) += hl.val[k];
+            }
+        }
+
+        DenseT             inv;
+        Eigen::LLT<DenseT> llt(dense);
+        if (llt.info() == Eigen::Success) {
+            inv = llt.solve(DenseT::Identity(hl.n, hl.n));
+        } else {
+            inv = dense.completeOrthogonalDecomposition().pseudoInverse();
+        }
+
+        // row-major on the device
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+            inv_rm = inv;
+        CUDA_ERROR(cudaMalloc((void**)&m_d_coarsest_inv,
+                              hl.n * hl.n * sizeof(T)));
+        CUDA_ERROR(cudaMemcpy(m_d_coarsest_inv,
+                              inv_rm.data(),
+                              hl.n * hl.n * sizeof(T),
+                              cudaMemcpyHostToDevice));
+    }
+
+    uint32_t num_blocks(const IndexT n) const
+    {
+        return std::max(DIVIDE_UP(n, blockThreads), uint32_t(1));
+    }
+
+    void residual(const Level& l,
+                  const T*     d_x,
+                  const T*     d_b,
+                  T*           d_r,
+                  cudaStream_t stream)
+    {
+        detail::mg_residual<T, IndexT>
+            <<<num_blocks(l.n), blockThreads, 0, stream>>>(
+                l.n, l.d_row_ptr, l.d_col_idx, l.d_val, d_x, d_b, d_r);
+    }
+
+    void axpby(const IndexT n,
+               const T      alpha,
+               const T*     d_x,
+               const T      beta,
+               T*           d_y,
+               cudaStream_t stream)
+    {
+        detail::mg_axpby<T, IndexT>
+            <<<num_blocks(n), blockThreads, 0, stream>>>(
+                n, alpha, d_x, beta, d_y);
+    }
+
+    T dot(const T* d_a, const T* d_b, cudaStream_t stream)
+    {
+        const IndexT n = m_levels[0].n;
+        return thrust::inner_product(thrust::cuda::par.on(stream),
+                                     thrust::device_ptr<const T>(d_a),
+                                     thrust::device_ptr<const T>(d_a + n),
+                                     thrust::device_ptr<const T>(d_b),
+                                     T(0));
+    }
+
+    void smooth(const Level& l, const T* d_b, T* d_x, cudaStream_t stream)
+    {
+        for (uint32_t s = 0; s < m_num_smooth; ++s) {
+            residual(l, d_x, d_b, l.d_r, stream);
+            detail::mg_jacobi<T, IndexT>
+                <<<num_blocks(l.n), blockThreads, 0, stream>>>(
+                    l.n, l.d_inv_diag, l.d_r, m_omega, d_x);
+        }
+    }
+
+    void vcycle(const uint32_t level,
+                const T*       d_b,
+                T*             d_x,
+                cudaStream_t   stream)
+    {
+        const Level& l = m_levels[level];
+
+        if (level + 1 == m_levels.size()) {
+            detail::mg_dense_matvec<T, IndexT>
+                <<<num_blocks(l.n), blockThreads, 0, stream>>>(
+                    l.n, m_d_coarsest_inv, d_b, d_x);
+            return;
+        }
+
+        const Level& c = m_levels[level + 1];
+
+        CUDA_ERROR(cudaMemsetAsync(d_x, 0, l.n * sizeof(T), stream));
+        smooth(l, d_b, d_x, stream);
+
+        // restrict the residual to the coarse level
+        residual(l, d_x, d_b, l.d_r, stream);
+        CUDA_ERROR(cudaMemsetAsync(c.d_b, 0, c.n * sizeof(T), stream));
+        detail::mg_restrict<T, IndexT>
+            <<<num_blocks(l.n), blockThreads, 0, stream>>>(
+                l.n, l.d_agg, l.d_r, c.d_b);
+
+        vcycle(level + 1, c.d_b, c.d_x, stream);
+
+        // coarse-grid correction
+        detail::mg_prolong<T, IndexT>
+            <<<num_blocks(l.n), blockThreads, 0, stream>>>(
+                l.n, l.d_agg, c.d_x, d_x);
+
+        smooth(l, d_b, d_x, stream);
+    }
+
+    std::vector<uint32_t> m_group;
+    std::vector<Level>    m_levels;
+    uint32_t              m_num_smooth;
+    T                     m_omega;
+    IndexT                m_coarsest_size;
+    uint32_t              m_max_num_levels;
+    T*                    m_d_coarsest_inv;
+    T*                    m_d_pcg_r;
+    T*                    m_d_pcg_z;
+    T*                    m_d_pcg_p;
+    T*                    m_d_pcg_s;
+    uint32_t              m_num_iter;
+    T                     m_residual;
+};
+}  // namespace rxmesh
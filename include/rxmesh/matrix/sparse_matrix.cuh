@@ -13,6 +13,7 @@
 
 #include "cusolverSp_LOWLEVEL_PREVIEW.h"
 #include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/nd_reorder.cuh"
 
 #include "rxmesh/matrix/sparse_matrix_kernels.cuh"
 
@@ -40,7 +41,9 @@ enum class Solver
  * NONE for No Reordering Applied, SYMRCM for Symmetric Reverse Cuthill-McKee
  * permutation, SYMAMD for Symmetric Approximate Minimum Degree Algorithm based
  * on Quotient Graph, NSTDIS for Nested Dissection, CUSTOM is a user-defined
- * permutation
+ * permutation, GPUND is a shorthand for CUSTOM with RXMesh's nested dissection
+ * ordering computed on the GPU from the mesh patches (see cuda_nd_reorder()).
+ * GPUND only changes the permutation. The factorization is still cuSolver's
  */
 enum class PermuteMethod
 {
@@ -48,7 +51,8 @@ enum class PermuteMethod
     SYMRCM = 1,
     SYMAMD = 2,
     NSTDIS = 3,
-    CUSTOM = 4
+    CUSTOM = 4,
+    GPUND  = 5
 };
 
 /**
@@ -100,6 +104,10 @@ struct SparseMatrix
           m_solver_buffer(nullptr),
           m_d_solver_b(nullptr),
           m_d_solver_x(nullptr),
+          m_d_solver_B(nullptr),
+          m_d_solver_X(nullptr),
+          m_solver_batch_cols(0),
+          m_d_ev_slot(nullptr),
           m_allocated(LOCATION_NONE),
           m_current_solver(Solver::NONE)
     {
@@ -359,6 +367,79 @@ struct SparseMatrix
         return m_context.vertex_prefix()[id.first] + id.second;
     }
 
+    /**
+     * @brief the diagonal entry of a vertex row. No search is needed since the
+     * diagonal is the first entry of every row
+     */
+    __device__ __host__ T& diagonal(const VertexHandle& v) const
+    {
+        return get_val_at(row_ptr()[get_row_id(v)]);
+    }
+
+    /**
+     * @brief the off-diagonal entry (v, n) where n is the other vertex of the
+     * edge e incident to v (e.g., from a VE or EV query). The slot is read
+     * from the slots cached by build_ev_slots() (which should be called once
+     * first) and is keyed by the global id of the edge which, unlike the
+     * position of n in a VV iterator, does not depend on the launch. So the
+     * entry is found without a search. In a VE query, every thread owns the
+     * row of its vertex so the row (including its diagonal) could be assembled
+     * without atomics
+     */
+    __device__ T& vv_entry(const VertexHandle& v, const EdgeHandle& e) const
+    {
+        assert(m_d_ev_slot != nullptr);
+        auto         id  = e.unpack();
+        const IndexT eid = m_context.edge_prefix()[id.first] + id.second;
+
+        // the first slot is (v0, v1) i.e., its column is v1
+        const IndexT slot = m_d_ev_slot[2 * eid];
+        return (m_d_col_idx[slot] == get_row_id(v)) ?
+                   m_d_val[m_d_ev_slot[2 * eid + 1]] :
+                   m_d_val[slot];
+    }
+
+    /**
+     * @brief the entry (v0, v1) (i = 0) or (v1, v0) (i = 1) where v0 and v1
+     * are the two vertices of an edge as returned by an EV query.
+     * build_ev_slots() should be called once first. Every edge owns its two
+     * off-diagonal entries so they could be written without atomics
+     */
+    __device__ T& ev_entry(const EdgeHandle& e, const int i) const
+    {
+        assert(m_d_ev_slot != nullptr);
+        auto         id  = e.unpack();
+        const IndexT eid = m_context.edge_prefix()[id.first] + id.second;
+        return m_d_val[m_d_ev_slot[2 * eid + i]];
+    }
+
+    /**
+     * @brief precompute the CSR slots of the two off-diagonal entries of
+     * every edge to be used in ev_entry() and vv_entry(). The slots are found
+     * by a linear search in the rows but only once per matrix
+     */
+    __host__ void build_ev_slots(const RXMeshStatic& rx)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        if (m_d_ev_slot == nullptr) {
+            CUDA_ERROR(cudaMalloc((void**)&m_d_ev_slot,
+                                  2 * rx.get_num_edges() * sizeof(IndexT)));
+        }
+
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box(
+            {Op::EV},
+            launch_box,
+            (void*)detail::sparse_mat_ev_slots<blockThreads, IndexT>);
+
+        detail::sparse_mat_ev_slots<blockThreads, IndexT>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(
+                m_context, m_d_row_ptr, m_d_col_idx, m_d_ev_slot);
+    }
+
     /**
      * @brief release all allocated memory
      */
@@ -385,8 +466,12 @@ struct SparseMatrix
             free(m_h_permute_map);
         }
         GPU_FREE(m_solver_buffer);
+        GPU_FREE(m_d_solver_B);
+        GPU_FREE(m_d_solver_X);
+        m_solver_batch_cols = 0;
         GPU_FREE(m_d_cusparse_spmm_buffer);
         GPU_FREE(m_d_cusparse_spmv_buffer);
+        GPU_FREE(m_d_ev_slot);
     }
 
     /**
@@ -794,6 +879,12 @@ struct SparseMatrix
                        h_custom_reordering,
                        m_num_rows * sizeof(IndexT),
                        cudaMemcpyHostToHost);
+        } else if (reorder == PermuteMethod::GPUND) {
+            RXMESH_ERROR(
+                "SparseMatrix::permute() GPUND reordering requires the mesh. "
+                "Use pre_solve(rx, solver, PermuteMethod::GPUND) instead");
+            m_use_reorder = false;
+            return;
         } else {
             RXMESH_ERROR("SparseMatrix::permute() incompatible reorder method");
         }
@@ -980,7 +1071,6 @@ struct SparseMatrix
             }
         } else if (solver == Solver::QR) {
             if constexpr (std::is_same_v<T, float>) {
-                float mu = 0.f;
                 CUSOLVER_ERROR(
                     cusolverSpScsrqrBufferInfo(m_cusolver_sphandle,
                                                m_num_rows,
@@ -993,21 +1083,9 @@ struct SparseMatrix
                                                m_qr_info,
                                                &m_internalDataInBytes,
                                                &m_workspaceInBytes));
-
-                CUSOLVER_ERROR(cusolverSpScsrqrSetup(m_cusolver_sphandle,
-                                                     m_num_rows,
-                                                     m_num_cols,
-                                                     m_nnz,
-                                                     m_descr,
-                                                     m_d_solver_val,
-                                                     m_d_solver_row_ptr,
-                                                     m_d_solver_col_idx,
-                                                     mu,
-                                                     m_qr_info));
             }
 
             if constexpr (std::is_same_v<T, cuComplex>) {
-                cuComplex mu = make_cuComplex(0.f, 0.f);
                 CUSOLVER_ERROR(
                     cusolverSpCcsrqrBufferInfo(m_cusolver_sphandle,
                                                m_num_rows,
@@ -1020,21 +1098,9 @@ struct SparseMatrix
                                                m_qr_info,
                                                &m_internalDataInBytes,
                                                &m_workspaceInBytes));
-
-                CUSOLVER_ERROR(cusolverSpCcsrqrSetup(m_cusolver_sphandle,
-                                                     m_num_rows,
-                                                     m_num_cols,
-                                                     m_nnz,
-                                                     m_descr,
-                                                     m_d_solver_val,
-                                                     m_d_solver_row_ptr,
-                                                     m_d_solver_col_idx,
-                                                     mu,
-                                                     m_qr_info));
             }
 
             if constexpr (std::is_same_v<T, double>) {
-                double mu = 0.f;
                 CUSOLVER_ERROR(
                     cusolverSpDcsrqrBufferInfo(m_cusolver_sphandle,
                                                m_num_rows,
@@ -1047,21 +1113,9 @@ struct SparseMatrix
                                                m_qr_info,
                                                &m_internalDataInBytes,
                                                &m_workspaceInBytes));
-
-                CUSOLVER_ERROR(cusolverSpDcsrqrSetup(m_cusolver_sphandle,
-                                                     m_num_rows,
-                                                     m_num_cols,
-                                                     m_nnz,
-                                                     m_descr,
-                                                     m_d_solver_val,
-                                                     m_d_solver_row_ptr,
-                                                     m_d_solver_col_idx,
-                                                     mu,
-                                                     m_qr_info));
             }
 
             if constexpr (std::is_same_v<T, cuDoubleComplex>) {
-                cuDoubleComplex mu = make_cuDoubleComplex(0.0, 0.0);
                 CUSOLVER_ERROR(
                     cusolverSpZcsrqrBufferInfo(m_cusolver_sphandle,
                                                m_num_rows,
@@ -1074,18 +1128,9 @@ struct SparseMatrix
                                                m_qr_info,
                                                &m_internalDataInBytes,
                                                &m_workspaceInBytes));
-
-                CUSOLVER_ERROR(cusolverSpZcsrqrSetup(m_cusolver_sphandle,
-                                                     m_num_rows,
-                                                     m_num_cols,
-                                                     m_nnz,
-                                                     m_descr,
-                                                     m_d_solver_val,
-                                                     m_d_solver_row_ptr,
-                                                     m_d_solver_col_idx,
-                                                     mu,
-                                                     m_qr_info));
             }
+
+            qr_setup();
         } else {
             RXMESH_ERROR(
                 "SparseMatrix::post_analyze_alloc() incompatible solver with "
@@ -1095,6 +1140,51 @@ struct SparseMatrix
         CUDA_ERROR(cudaMalloc((void**)&m_solver_buffer, m_workspaceInBytes));
     }
 
+    /**
+     * @brief redo only the numeric factorization after the values of the
+     * matrix have changed while its sparsity pattern is the same (e.g., a
+     * time-varying system solved every frame). The permutation (see
+     * permute()), the symbolic analysis (see analyze_pattern()), and the
+     * factorization buffer (see post_analyze_alloc()) computed by pre_solve()
+     * are reused. The new values should be on the device. Only Cholesky and QR
+     * are supported since cuSolver's LU is a host-side high-level API
+     * @param stream the stream used for the refactorization
+     */
+    __host__ void refactorize(cudaStream_t stream = NULL)
+    {
+        if (m_current_solver != Solver::CHOL &&
+            m_current_solver != Solver::QR) {
+            RXMESH_ERROR(
+                "SparseMatrix::refactorize() pre_solve() should be called "
+                "first with Cholesky or QR solver");
+            return;
+        }
+        if (m_solver_buffer == nullptr) {
+            RXMESH_ERROR(
+                "SparseMatrix::refactorize() pre_solve() should be called "
+                "first");
+            return;
+        }
+
+        CUSOLVER_ERROR(cusolverSpSetStream(m_cusolver_sphandle, stream));
+
+        // the solver's values are a permuted copy of the matrix values
+        if (m_use_reorder) {
+            thrust::device_ptr<IndexT> t_p(m_d_permute_map);
+            thrust::device_ptr<T>      t_i(m_d_val);
+            thrust::device_ptr<T>      t_o(m_d_solver_val);
+            thrust::gather(
+                thrust::cuda::par.on(stream), t_p, t_p + m_nnz, t_i, t_o);
+        }
+
+        // QR's numeric phase reads the values during setup
+        if (m_current_solver == Solver::QR) {
+            qr_setup();
+        }
+
+        factorize(m_current_solver);
+    }
+
 
     /**
      * @brief The lower level api of matrix factorization and save the
@@ -1285,6 +1375,64 @@ struct SparseMatrix
         factorize(solver);
     }
 
+    /**
+     * @brief convenience overload of pre_solve() above for
+     * PermuteMethod::GPUND. It computes the nested dissection ordering with
+     * cuda_nd_reorder() and passes it to pre_solve() as a CUSTOM permutation,
+     * i.e., the same as calling cuda_nd_reorder() and pre_solve() with CUSTOM
+     * directly. The ordering is the only thing that changes. The symbolic and
+     * numeric factorization is still done by cuSolver and does not use the
+     * nested dissection tree. If the mesh has a single patch, it falls back to
+     * NSTDIS. Other permute methods are passed as is
+     * @param rx the mesh this matrix is built on
+     * @param nd_level number of nested dissection levels. If zero, it is
+     * chosen from the number of patches (see nd_auto_level())
+     */
+    __host__ void pre_solve(RXMeshStatic& rx,
+                            Solver        solver,
+                            PermuteMethod reorder  = PermuteMethod::GPUND,
+                            uint32_t      nd_level = 0)
+    {
+        if (reorder != PermuteMethod::GPUND) {
+            pre_solve(solver, reorder);
+            return;
+        }
+
+        if (rx.get_num_vertices() != uint32_t(m_num_rows)) {
+            RXMESH_ERROR(
+                "SparseMatrix::pre_solve() GPUND reordering requires a VV "
+                "matrix of the mesh ({} rows vs. {} vertices)",
+                m_num_rows,
+                rx.get_num_vertices());
+            return;
+        }
+
+        if (rx.get_num_patches() < 2) {
+            RXMESH_WARN(
+                "SparseMatrix::pre_solve() GPUND reordering needs at least "
+                "two patches. Using NSTDIS instead");
+            pre_solve(solver, PermuteMethod::NSTDIS);
+            return;
+        }
+
+        if (nd_level == 0) {
+            nd_level = nd_auto_level(rx);
+        }
+
+        std::vector<uint32_t> h_nd_ordering(m_num_rows);
+        cuda_nd_reorder(rx, h_nd_ordering.data(), nd_level);
+
+        if (!arr_check_uint32_to_int_cast(h_nd_ordering.data(),
+                                          h_nd_ordering.size())) {
+            RXMESH_ERROR("SparseMatrix::pre_solve() invalid GPUND ordering");
+            return;
+        }
+
+        pre_solve(solver,
+                  PermuteMethod::CUSTOM,
+                  reinterpret_cast<IndexT*>(h_nd_ordering.data()));
+    }
+
     /**
      * @brief The lower level api of solving the linear system after using
      * factorization. The format follows Ax=b to solve x, where A is this sparse
@@ -1298,9 +1446,56 @@ struct SparseMatrix
                         cudaStream_t    stream = NULL)
     {
         CUSOLVER_ERROR(cusolverSpSetStream(m_cusolver_sphandle, stream));
-        for (int i = 0; i < B_mat.cols(); ++i) {
-            solve(B_mat.col_data(i), X_mat.col_data(i));
+        if (!m_use_reorder) {
+            for (int i = 0; i < B_mat.cols(); ++i) {
+                solve_permuted(B_mat.col_data(i), X_mat.col_data(i));
+            }
+            return;
+        }
+
+        // with reordering, all right-hand sides are permuted with one launch
+        // before solving and all solutions are permuted back with one launch
+        const IndexT num_cols = B_mat.cols();
+        if (m_solver_batch_cols < num_cols) {
+            GPU_FREE(m_d_solver_B);
+            GPU_FREE(m_d_solver_X);
+            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_B,
+                                  m_num_rows * num_cols * sizeof(T)));
+            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_X,
+                                  m_num_cols * num_cols * sizeof(T)));
+            m_solver_batch_cols = num_cols;
+        }
+
+        const IndexT b_ld = B_mat.m_num_rows + B_mat.m_col_pad_idx;
+        const IndexT x_ld = X_mat.m_num_rows + X_mat.m_col_pad_idx;
+
+        constexpr uint32_t blockThreads = 256;
+        const uint32_t     blocks       = std::min(
+            DIVIDE_UP(uint32_t(m_num_rows * num_cols), blockThreads),
+            uint32_t(65535));
+
+        detail::permute_cols<T, IndexT, false>
+            <<<blocks, blockThreads, 0, stream>>>(m_d_permute,
+                                                  B_mat.col_data(0),
+                                                  m_d_solver_B,
+                                                  m_num_rows,
+                                                  num_cols,
+                                                  b_ld,
+                                                  m_num_rows);
+
+        for (IndexT i = 0; i < num_cols; ++i) {
+            solve_permuted(m_d_solver_B + i * m_num_rows,
+                           m_d_solver_X + i * m_num_cols);
         }
+
+        detail::permute_cols<T, IndexT, true>
+            <<<blocks, blockThreads, 0, stream>>>(m_d_permute,
+                                                  m_d_solver_X,
+                                                  X_mat.col_data(0),
+                                                  m_num_cols,
+                                                  num_cols,
+                                                  m_num_cols,
+                                                  x_ld);
     }
 
     /**
@@ -1327,6 +1522,19 @@ struct SparseMatrix
             d_solver_x = d_x;
         }
 
+        solve_permuted(d_solver_b, d_solver_x);
+
+        if (m_use_reorder) {
+            permute_scatter(m_d_permute, d_solver_x, d_x, m_num_rows);
+        }
+    }
+
+    /**
+     * @brief solve with the factorization for b and x that are already
+     * permuted (or not if there is no reordering)
+     */
+    __host__ void solve_permuted(T* d_solver_b, T* d_solver_x)
+    {
         if (m_current_solver == Solver::CHOL) {
 
             if constexpr (std::is_same_v<T, float>) {
@@ -1411,14 +1619,73 @@ struct SparseMatrix
                 "Cholesky and QR solvers");
             return;
         }
-
-        if (m_use_reorder) {
-            permute_scatter(m_d_permute, d_solver_x, d_x, m_num_rows);
-        }
     }
 
 
    private:
+    /**
+     * @brief pass the (permuted) values of the matrix to cuSolver's QR. This
+     * is the first step of the numeric phase of QR
+     */
+    __host__ void qr_setup()
+    {
+        if constexpr (std::is_same_v<T, float>) {
+            float mu = 0.f;
+            CUSOLVER_ERROR(cusolverSpScsrqrSetup(m_cusolver_sphandle,
+                                                 m_num_rows,
+                                                 m_num_cols,
+                                                 m_nnz,
+                                                 m_descr,
+                                                 m_d_solver_val,
+                                                 m_d_solver_row_ptr,
+                                                 m_d_solver_col_idx,
+                                                 mu,
+                                                 m_qr_info));
+        }
+
+        if constexpr (std::is_same_v<T, cuComplex>) {
+            cuComplex mu = make_cuComplex(0.f, 0.f);
+            CUSOLVER_ERROR(cusolverSpCcsrqrSetup(m_cusolver_sphandle,
+                                                 m_num_rows,
+                                                 m_num_cols,
+                                                 m_nnz,
+                                                 m_descr,
+                                                 m_d_solver_val,
+                                                 m_d_solver_row_ptr,
+                                                 m_d_solver_col_idx,
+                                                 mu,
+                                                 m_qr_info));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            double mu = 0.f;
+            CUSOLVER_ERROR(cusolverSpDcsrqrSetup(m_cusolver_sphandle,
+                                                 m_num_rows,
+                                                 m_num_cols,
+                                                 m_nnz,
+                                                 m_descr,
+                                                 m_d_solver_val,
+                                                 m_d_solver_row_ptr,
+                                                 m_d_solver_col_idx,
+                                                 mu,
+                                                 m_qr_info));
+        }
+
+        if constexpr (std::is_same_v<T, cuDoubleComplex>) {
+            cuDoubleComplex mu = make_cuDoubleComplex(0.0, 0.0);
+            CUSOLVER_ERROR(cusolverSpZcsrqrSetup(m_cusolver_sphandle,
+                                                 m_num_rows,
+                                                 m_num_cols,
+                                                 m_nnz,
+                                                 m_descr,
+                                                 m_d_solver_val,
+                                                 m_d_solver_row_ptr,
+                                                 m_d_solver_col_idx,
+                                                 mu,
+                                                 m_qr_info));
+        }
+    }
+
     __host__ void release(locationT location)
     {
         if (((location & HOST) == HOST) && ((m_allocated & HOST) == HOST)) {
@@ -1779,9 +2046,19 @@ struct SparseMatrix
     T* m_d_solver_b;
     T* m_d_solver_x;
 
+    // (permuted) multiple right-hand sides and solutions used by the batched
+    // solve. Grown to the largest number of columns seen so far
+    T*     m_d_solver_B;
+    T*     m_d_solver_X;
+    IndexT m_solver_batch_cols;
+
     void* m_d_cusparse_spmm_buffer;
     void* m_d_cusparse_spmv_buffer;
 
+    // CSR slots of the two off-diagonal entries of every edge (see
+    // ev_entry() and vv_entry(v, e))
+    IndexT* m_d_ev_slot;
+
     // flags
     bool      m_use_reorder;
     locationT m_allocated;
@@ -57,6 +57,138 @@ __global__ static void sparse_mat_col_fill(const rxmesh::Context context,
     query.dispatch<Op::VV>(block, shrd_alloc, col_fillin);
 }
 
+/**
+ * @brief find the CSR slot of (row, col) by a linear search in the row. Only
+ * used once to build the slot map of the edges below
+ */
+template <typename IndexT>
+__device__ __inline__ IndexT sparse_mat_find_slot(const IndexT* row_ptr,
+                                                  const IndexT* col_idx,
+                                                  const IndexT  row,
+                                                  const IndexT  col)
+{
+    for (IndexT i = row_ptr[row]; i < row_ptr[row + 1]; ++i) {
+        if (col_idx[i] == col) {
+            return i;
+        }
+    }
+    assert(1 != 1);
+    return -1;
+}
+
+/**
+ * @brief sort the off-diagonal columns of every row in ascending order. The
+ * diagonal stays the first entry of the row. The order in which a VV query
+ * visits the neighbors of a vertex is not defined (it depends on the
+ * scheduling of the atomics in the transpose and on the query engine) so
+ * sorting gives every row a canonical order that does not depend on the
+ * launch that filled it. The rows are short so every thread sorts one row
+ * with an insertion sort
+ */
+template <typename IndexT = int>
+__global__ static void sparse_mat_sort_rows(const IndexT  num_rows,
+                                            const IndexT* row_ptr,
+                                            IndexT*       col_idx)
+{
+    for (IndexT r = blockIdx.x * blockDim.x + threadIdx.x; r < num_rows;
+         r += blockDim.x * gridDim.x) {
+        const IndexT start = row_ptr[r] + 1;
+        const IndexT end   = row_ptr[r + 1];
+        for (IndexT i = start + 1; i < end; ++i) {
+            const IndexT col = col_idx[i];
+            IndexT       j   = i;
+            while (j > start && col_idx[j - 1] > col) {
+                col_idx[j] = col_idx[j - 1];
+                --j;
+            }
+            col_idx[j] = col;
+        }
+    }
+}
+
+/**
+ * @brief find the slot of the off-diagonal entry (row, col) by a binary
+ * search in a row sorted by sparse_mat_sort_rows()
+ */
+template <typename IndexT>
+__device__ __inline__ IndexT sparse_mat_find_sorted_slot(
+    const IndexT* row_ptr,
+    const IndexT* col_idx,
+    const IndexT  row,
+    const IndexT  col)
+{
+    IndexT lo = row_ptr[row] + 1;
+    IndexT hi = row_ptr[row + 1];
+    while (lo < hi) {
+        const IndexT mid = lo + (hi - lo) / 2;
+        if (col_idx[mid] < col) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    assert(lo < row_ptr[row + 1] && col_idx[lo] == col);
+    return lo;
+}
+
+/**
+ * @brief for every edge (v0, v1) as returned by an EV query, store the CSR
+ * slots of (v0, v1) and (v1, v0) at slot[2*e] and slot[2*e + 1]
+ */
+template <uint32_t blockThreads, typename IndexT = int>
+__global__ static void sparse_mat_ev_slots(const rxmesh::Context context,
+                                           const IndexT*         row_ptr,
+                                           const IndexT*         col_idx,
+                                           IndexT*               slot)
+{
+    using namespace rxmesh;
+
+    auto ev_slots = [&](EdgeHandle& e_id, const VertexIterator& iter) {
+        auto         e_ids = e_id.unpack();
+        const IndexT e     = context.edge_prefix()[e_ids.first] + e_ids.second;
+
+        auto         v0_ids = iter[0].unpack();
+        auto         v1_ids = iter[1].unpack();
+        const IndexT v0 = context.vertex_prefix()[v0_ids.first] + v0_ids.second;
+        const IndexT v1 = context.vertex_prefix()[v1_ids.first] + v1_ids.second;
+
+        slot[2 * e]     = sparse_mat_find_slot(row_ptr, col_idx, v0, v1);
+        slot[2 * e + 1] = sparse_mat_find_slot(row_ptr, col_idx, v1, v0);
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(block, shrd_alloc, ev_slots);
+}
+
+/**
+ * @brief permute the rows of all columns of a column-major dense matrix at
+ * once i.e., out[c][i] = in[c][p[i]] (gather) or out[c][p[i]] = in[c][i]
+ * (scatter). Used to permute multiple right-hand sides in a single launch
+ */
+template <typename T, typename IndexT, bool scatter>
+__global__ static void permute_cols(const IndexT* p,
+                                    const T*      in,
+                                    T*            out,
+                                    const IndexT  num_rows,
+                                    const IndexT  num_cols,
+                                    const IndexT  in_ld,
+                                    const IndexT  out_ld)
+{
+    const int64_t size = int64_t(num_rows) * int64_t(num_cols);
+    for (int64_t i = int64_t(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+         i += int64_t(blockDim.x) * gridDim.x) {
+        const IndexT r = i % num_rows;
+        const IndexT c = i / num_rows;
+        if constexpr (scatter) {
+            out[c * out_ld + p[r]] = in[c * in_ld + r];
+        } else {
+            out[c * out_ld + r] = in[c * in_ld + p[r]];
+        }
+    }
+}
+
 }  // namespace detail
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,666 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cub/device/device_scan.cuh>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/context.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/util.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the file formats written by MeshWriter
+ */
+enum class MeshFormat : uint8_t
+{
+    // unknown extension
+    Invalid = 0,
+    // wavefront obj (text)
+    OBJ = 1,
+    // binary little endian ply
+    PLY = 2,
+    // legacy vtk polydata (text)
+    VTK = 3,
+};
+
+/**
+ * @brief deduce the file format from the extension of the file name
+ */
+inline MeshFormat mesh_format(const std::string& filename)
+{
+    const size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos) {
+        return MeshFormat::Invalid;
+    }
+    std::string ext = filename.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == "obj") {
+        return MeshFormat::OBJ;
+    }
+    if (ext == "ply") {
+        return MeshFormat::PLY;
+    }
+    if (ext == "vtk") {
+        return MeshFormat::VTK;
+    }
+    return MeshFormat::Invalid;
+}
+
+namespace detail {
+
+/**
+ * @brief the w-th 32-bit word of the owned and active elements of a patch
+ * (with the bits beyond size cleared)
+ */
+__device__ __inline__ uint32_t writer_word(const uint32_t* owned,
+                                           const uint32_t* active,
+                                           const uint16_t  size,
+                                           const uint32_t  w)
+{
+    uint32_t word = owned[w] & active[w];
+    if (32 * (w + 1) > size) {
+        const uint32_t rem = size - 32 * w;
+        word &= (rem == 0) ? 0u : (0xFFFFFFFFu >> (32 - rem));
+    }
+    return word;
+}
+
+/**
+ * @brief the rank of the owned and active element i among the owned and
+ * active elements of a patch, i.e., its index within the patch in the
+ * linear order used by RXMeshStatic::linear_id()
+ */
+__device__ __inline__ uint32_t writer_rank(const uint32_t* owned,
+                                           const uint32_t* active,
+                                           const uint16_t  size,
+                                           const uint16_t  i)
+{
+    const uint32_t w   = i / 32;
+    uint32_t       ret = 0;
+    for (uint32_t j = 0; j < w; ++j) {
+        ret += __popc(writer_word(owned, active, size, j));
+    }
+    const uint32_t bit = i % 32;
+    if (bit > 0) {
+        ret += __popc(writer_word(owned, active, size, w) &
+                      (0xFFFFFFFFu >> (32 - bit)));
+    }
+    return ret;
+}
+
+template <uint32_t blockThreads>
+__global__ static void writer_count(const Context context,
+                                    uint32_t*     d_num_v,
+                                    uint32_t*     d_num_f)
+{
+    const uint32_t  p  = blockIdx.x;
+    const PatchInfo pi = context.m_patches_info[p];
+
+    __shared__ uint32_t s_num[2];
+    if (threadIdx.x == 0) {
+        s_num[0] = 0;
+        s_num[1] = 0;
+    }
+    __syncthreads();
+
+    if (pi.patch_id != INVALID32) {
+        const uint16_t nv = pi.num_vertices[0];
+        for (uint32_t w = threadIdx.x; w < DIVIDE_UP(nv, 32);
+             w += blockThreads) {
+            ::atomicAdd(
+                s_num,
+                __popc(writer_word(pi.owned_mask_v, pi.active_mask_v, nv, w)));
+        }
+        const uint16_t nf = pi.num_faces[0];
+        for (uint32_t w = threadIdx.x; w < DIVIDE_UP(nf, 32);
+             w += blockThreads) {
+            ::atomicAdd(
+                s_num + 1,
+                __popc(writer_word(pi.owned_mask_f, pi.active_mask_f, nf, w)));
+        }
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0) {
+        d_num_v[p] = s_num[0];
+        d_num_f[p] = s_num[1];
+    }
+}
+
+template <typename T, uint32_t blockThreads>
+__global__ static void writer_fill(const Context            context,
+                                   const VertexAttribute<T> coords,
+                                   const uint32_t*          d_prefix_v,
+                                   const uint32_t*          d_prefix_f,
+                                   T*                       d_vertices,
+                                   uint32_t*                d_faces)
+{
+    const uint32_t  p  = blockIdx.x;
+    const PatchInfo pi = context.m_patches_info[p];
+    if (pi.patch_id == INVALID32) {
+        return;
+    }
+
+    const uint16_t nv = pi.num_vertices[0];
+    for (uint16_t v = threadIdx.x; v < nv; v += blockThreads) {
+        if (writer_word(pi.owned_mask_v, pi.active_mask_v, nv, v / 32) &
+            (1u << (v % 32))) {
+            const uint32_t id =
+                d_prefix_v[p] +
+                writer_rank(pi.owned_mask_v, pi.active_mask_v, nv, v);
+            const VertexHandle vh(p, v);
+            for (uint32_t i = 0; i < 3; ++i) {
+                d_vertices[3 * id + i] = coords(vh, i);
+            }
+        }
+    }
+
+    const uint16_t nf = pi.num_faces[0];
+    for (uint16_t f = threadIdx.x; f < nf; f += blockThreads) {
+        if (writer_word(pi.owned_mask_f, pi.active_mask_f, nf, f / 32) &
+            (1u << (f % 32))) {
+            const uint32_t id =
+                d_prefix_f[p] +
+                writer_rank(pi.owned_mask_f, pi.active_mask_f, nf, f);
+            for (uint32_t e = 0; e < 3; ++e) {
+                uint16_t edge = pi.fe[3 * f + e].id;
+                flag_t   dir(0);
+                Context::unpack_edge_dir(edge, edge, dir);
+                const uint16_t v = pi.ev[2 * edge + dir].id;
+
+                const VertexHandle owner =
+                    context.get_owner_handle(VertexHandle(p, v));
+                const PatchInfo& opi = context.m_patches_info[owner.patch_id()];
+
+                d_faces[3 * id + e] =
+                    d_prefix_v[owner.patch_id()] +
+                    writer_rank(opi.owned_mask_v,
+                                opi.active_mask_v,
+                                opi.num_vertices[0],
+                                owner.local_id());
+            }
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief write the mesh (vertex coordinates and faces) to OBJ, binary PLY, or
+ * VTK files without going through the host side of the mesh. The owned
+ * vertices and faces are compacted on the device in the same order as
+ * RXMeshStatic::linear_id(), moved to the host in one transfer into a pinned
+ * buffer, and written by a background thread. Thus, the files list the
+ * vertices and faces in the same order as export_obj()/export_vtk() but a
+ * dynamic mesh only needs RXMeshDynamic::cleanup() (and not update_host())
+ * before writing, and the next frame can be computed while the previous one
+ * is written. The text formats are formatted in large chunks rather than value
+ * by value.
+ *
+ * The writer cycles through a fixed number of pinned buffers (two by default)
+ * so at most that many frames are in flight. write() only waits for the frame
+ * that used the same buffer and wait() waits for all of them. Attributes other
+ * than the coordinates are not written (export_vtk() should be used for them)
+ *
+ * Example
+ * \code{.cpp}
+ * MeshWriter<float> writer;
+ * for (int frame = 0; frame < num_frames; ++frame) {
+ *     // ... update the mesh on the device and call rx.cleanup()
+ *     writer.write(rx, *coords, "frame_" + std::to_string(frame) + ".ply");
+ * }
+ * writer.wait();
+ * \endcode
+ */
+template <typename T>
+class MeshWriter
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                  "MeshWriter only supports float and double coordinates");
+
+   public:
+    static constexpr uint32_t blockThreads = 256;
+
+    // the size of one chunk of formatted text
+    static constexpr size_t chunk_bytes = size_t(1) << 22;
+
+    /**
+     * @param num_slots the number of frames that could be in flight, i.e.,
+     * written by the background threads while the next ones are computed
+     */
+    explicit MeshWriter(const uint32_t num_slots = 2)
+        : m_slots(std::max(num_slots, 1u)),
+          m_d_count(nullptr),
+          m_d_prefix(nullptr),
+          m_count_capacity(0),
+          m_d_scan_temp(nullptr),
+          m_scan_temp_bytes(0),
+          m_next(0),
+          m_num_vertices(0),
+          m_num_faces(0)
+    {
+    }
+
+    MeshWriter(const MeshWriter&)            = delete;
+    MeshWriter& operator=(const MeshWriter&) = delete;
+
+    ~MeshWriter()
+    {
+        release();
+    }
+
+    /**
+     * @brief write the mesh to a file whose format is deduced from its
+     * extension (.obj, .ply, or .vtk). The function returns once the
+     * compacted mesh is enqueued to be moved to the host and the file is
+     * written by a background thread
+     * @param rx the mesh. For RXMeshDynamic, cleanup() should be called after
+     * the last topology change
+     * @param coords the vertex coordinates (on the device)
+     * @param filename the output file
+     * @param stream the stream used for the compaction and the transfer
+     * @param compacted if not null, this event is recorded on the stream
+     * once the mesh is compacted, i.e., once the mesh and the coordinates
+     * could be modified again even though the transfer is still in flight
+     * @return false if the format is unknown or if writing the frame that
+     * used the same buffer (get_num_slots() calls earlier) failed
+     */
+    bool write(RXMeshStatic&             rx,
+               const VertexAttribute<T>& coords,
+               const std::string&        filename,
+               cudaStream_t              stream    = NULL,
+               cudaEvent_t               compacted = nullptr)
+    {
+        const MeshFormat format = mesh_format(filename);
+        if (format == MeshFormat::Invalid) {
+            RXMESH_ERROR(
+                "MeshWriter::write() unknown extension of {}. Only .obj, .ply, "
+                "and .vtk are supported",
+                filename);
+            return false;
+        }
+
+        Slot& slot = m_slots[m_next];
+        m_next     = (m_next + 1) % get_num_slots();
+
+        // the buffers of this slot are reused
+        bool ret = finish(slot);
+
+        const uint32_t num_patches = rx.get_num_patches(true);
+        const Context  context     = rx.get_context();
+
+        count(context, num_patches, stream);
+
+        const uint32_t num_v = m_num_vertices;
+        const uint32_t num_f = m_num_faces;
+
+        const size_t v_bytes = 3 * size_t(num_v) * sizeof(T);
+        const size_t f_bytes = 3 * size_t(num_f) * sizeof(uint32_t);
+        slot.reserve(v_bytes + f_bytes);
+
+        T*        d_vertices = reinterpret_cast<T*>(slot.d_data);
+        uint32_t* d_faces =
+            reinterpret_cast<uint32_t*>(slot.d_data + v_bytes);
+
+        if (num_patches > 0) {
+            detail::writer_fill<T, blockThreads>
+                <<<num_patches, blockThreads, 0, stream>>>(
+                    context,
+                    coords,
+                    m_d_prefix,
+                    m_d_prefix + m_count_capacity,
+                    d_vertices,
+                    d_faces);
+            CUDA_ERROR(cudaGetLastError());
+        }
+
+        if (compacted != nullptr) {
+            CUDA_ERROR(cudaEventRecord(compacted, stream));
+        }
+
+        if (v_bytes + f_bytes > 0) {
+            CUDA_ERROR(cudaMemcpyAsync(slot.h_data,
+                                       slot.d_data,
+                                       v_bytes + f_bytes,
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+        }
+        CUDA_ERROR(cudaEventRecord(slot.event, stream));
+
+        const char*     h_data = slot.h_data;
+        cudaEvent_t     event  = slot.event;
+        const T*        h_v    = reinterpret_cast<const T*>(h_data);
+        const uint32_t* h_f =
+            reinterpret_cast<const uint32_t*>(h_data + v_bytes);
+
+        slot.done = std::async(std::launch::async, [=]() {
+            CUDA_ERROR(cudaEventSynchronize(event));
+            return write_file(filename, format, h_v, num_v, h_f, num_f);
+        });
+
+        return ret;
+    }
+
+    /**
+     * @brief wait for all the frames to be written
+     * @return false if writing any of them failed
+     */
+    bool wait()
+    {
+        bool ret = true;
+        for (auto& slot : m_slots) {
+            ret = finish(slot) && ret;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief the number of frames that could be in flight
+     */
+    uint32_t get_num_slots() const
+    {
+        return static_cast<uint32_t>(m_slots.size());
+    }
+
+    /**
+     * @brief the number of vertices of the last frame passed to write()
+     */
+    uint32_t get_num_vertices() const
+    {
+        return m_num_vertices;
+    }
+
+    /**
+     * @brief the number of faces of the last frame passed to write()
+     */
+    uint32_t get_num_faces() const
+    {
+        return m_num_faces;
+    }
+
+    /**
+     * @brief wait for the pending frames and free all the memories
+     */
+    void release()
+    {
+        wait();
+        for (auto& slot : m_slots) {
+            slot.release();
+        }
+        GPU_FREE(m_d_count);
+        GPU_FREE(m_d_prefix);
+        GPU_FREE(m_d_scan_temp);
+        m_count_capacity  = 0;
+        m_scan_temp_bytes = 0;
+    }
+
+   private:
+    /**
+     * @brief the device and pinned host buffers of one frame in flight
+     */
+    struct Slot
+    {
+        char*             d_data   = nullptr;
+        char*             h_data   = nullptr;
+        size_t            capacity = 0;
+        cudaEvent_t       event    = nullptr;
+        std::future<bool> done;
+
+        void reserve(const size_t num_bytes)
+        {
+            if (event == nullptr) {
+                CUDA_ERROR(cudaEventCreateWithFlags(
+                    &event, cudaEventDisableTiming | cudaEventBlockingSync));
+            }
+            if (num_bytes <= capacity) {
+                return;
+            }
+            GPU_FREE(d_data);
+            if (h_data != nullptr) {
+                CUDA_ERROR(cudaFreeHost(h_data));
+            }
+            // leave room to grow (e.g., for a mesh that is refined over the
+            // frames)
+            capacity = num_bytes + num_bytes / 4;
+            CUDA_ERROR(cudaMalloc((void**)&d_data, capacity));
+            CUDA_ERROR(cudaMallocHost((void**)&h_data, capacity));
+        }
+
+        void release()
+        {
+            GPU_FREE(d_data);
+            if (h_data != nullptr) {
+                CUDA_ERROR(cudaFreeHost(h_data));
+                h_data = nullptr;
+            }
+            if (event != nullptr) {
+                CUDA_ERROR(cudaEventDestroy(event));
+                event = nullptr;
+            }
+            capacity = 0;
+        }
+    };
+
+    static bool finish(Slot& slot)
+    {
+        if (slot.done.valid()) {
+            return slot.done.get();
+        }
+        return true;
+    }
+
+    /**
+     * @brief count the owned vertices and faces of every patch and compute
+     * their exclusive prefix sum (in m_d_prefix) and the totals
+     */
+    void count(const Context& context,
+               const uint32_t num_patches,
+               cudaStream_t   stream)
+    {
+        if (num_patches + 1 > m_count_capacity) {
+            GPU_FREE(m_d_count);
+            GPU_FREE(m_d_prefix);
+            m_count_capacity = num_patches + 1;
+            CUDA_ERROR(cudaMalloc((void**)&m_d_count,
+                                  2 * m_count_capacity * sizeof(uint32_t)));
+            CUDA_ERROR(cudaMalloc((void**)&m_d_prefix,
+                                  2 * m_count_capacity * sizeof(uint32_t)));
+        }
+        uint32_t* d_num_v    = m_d_count;
+        uint32_t* d_num_f    = m_d_count + m_count_capacity;
+        uint32_t* d_prefix_v = m_d_prefix;
+        uint32_t* d_prefix_f = m_d_prefix + m_count_capacity;
+
+        // the extra zero at the end makes the last prefix the total
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_count, 0, 2 * m_count_capacity * sizeof(uint32_t), stream));
+
+        if (num_patches > 0) {
+            detail::writer_count<blockThreads>
+                <<<num_patches, blockThreads, 0, stream>>>(
+                    context, d_num_v, d_num_f);
+            CUDA_ERROR(cudaGetLastError());
+        }
+
+        size_t temp_bytes = 0;
+        CUDA_ERROR(cub::DeviceScan::ExclusiveSum(
+            nullptr, temp_bytes, d_num_v, d_prefix_v, num_patches + 1, stream));
+        if (temp_bytes > m_scan_temp_bytes) {
+            GPU_FREE(m_d_scan_temp);
+            m_scan_temp_bytes = temp_bytes;
+            CUDA_ERROR(cudaMalloc((void**)&m_d_scan_temp, m_scan_temp_bytes));
+        }
+        CUDA_ERROR(cub::DeviceScan::ExclusiveSum(m_d_scan_temp,
+                                                 temp_bytes,
+                                                 d_num_v,
+                                                 d_prefix_v,
+                                                 num_patches + 1,
+                                                 stream));
+        CUDA_ERROR(cub::DeviceScan::ExclusiveSum(m_d_scan_temp,
+                                                 temp_bytes,
+                                                 d_num_f,
+                                                 d_prefix_f,
+                                                 num_patches + 1,
+                                                 stream));
+
+        CUDA_ERROR(cudaMemcpyAsync(&m_num_vertices,
+                                   d_prefix_v + num_patches,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(&m_num_faces,
+                                   d_prefix_f + num_patches,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    /**
+     * @brief accumulate formatted text and write it to the file one chunk at
+     * a time
+     */
+    struct ChunkWriter
+    {
+        explicit ChunkWriter(std::ofstream& f) : file(f), size(0)
+        {
+            buffer.resize(chunk_bytes);
+        }
+
+        template <typename... ArgsT>
+        void print(const char* fmt, ArgsT... args)
+        {
+            // a line is much shorter than this
+            if (chunk_bytes - size < 256) {
+                flush();
+            }
+            size += std::snprintf(
+                buffer.data() + size, chunk_bytes - size, fmt, args...);
+        }
+
+        void flush()
+        {
+            file.write(buffer.data(), size);
+            size = 0;
+        }
+
+        std::ofstream&    file;
+        std::vector<char> buffer;
+        size_t            size;
+    };
+
+    static bool write_file(const std::string& filename,
+                           const MeshFormat   format,
+                           const T*           h_v,
+                           const uint32_t     num_v,
+                           const uint32_t*    h_f,
+                           const uint32_t     num_f)
+    {
+        std::ofstream file(filename, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            RXMESH_ERROR("MeshWriter::write() can not open {}", filename);
+            return false;
+        }
+
+        // enough digits to read the same value back
+        const char* v_fmt = std::is_same_v<T, float> ?
+                                "v %.9g %.9g %.9g\n" :
+                                "v %.17g %.17g %.17g\n";
+        const char* p_fmt = std::is_same_v<T, float> ? "%.9g %.9g %.9g\n" :
+                                                       "%.17g %.17g %.17g\n";
+
+        if (format == MeshFormat::OBJ) {
+            ChunkWriter out(file);
+            for (uint32_t v = 0; v < num_v; ++v) {
+                out.print(v_fmt,
+                          double(h_v[3 * v]),
+                          double(h_v[3 * v + 1]),
+                          double(h_v[3 * v + 2]));
+            }
+            for (uint32_t f = 0; f < num_f; ++f) {
+                out.print("f %u %u %u\n",
+                          h_f[3 * f] + 1,
+                          h_f[3 * f + 1] + 1,
+                          h_f[3 * f + 2] + 1);
+            }
+            out.flush();
+        } else if (format == MeshFormat::VTK) {
+            ChunkWriter out(file);
+            out.print("# vtk DataFile Version 3.0\n%s\nASCII\n",
+                      extract_file_name(filename).c_str());
+            out.print("DATASET POLYDATA\nPOINTS %u %s\n",
+                      num_v,
+                      std::is_same_v<T, float> ? "float" : "double");
+            for (uint32_t v = 0; v < num_v; ++v) {
+                out.print(p_fmt,
+                          double(h_v[3 * v]),
+                          double(h_v[3 * v + 1]),
+                          double(h_v[3 * v + 2]));
+            }
+            out.print("POLYGONS %u %u\n", num_f, 4 * num_f);
+            for (uint32_t f = 0; f < num_f; ++f) {
+                out.print(
+                    "3 %u %u %u\n", h_f[3 * f], h_f[3 * f + 1], h_f[3 * f + 2]);
+            }
+            out.flush();
+        } else {
+            const char* type = std::is_same_v<T, float> ? "float" : "double";
+            file << "ply\nformat binary_little_endian 1.0\n"
+                 << "element vertex " << num_v << "\n"
+                 << "property " << type << " x\n"
+                 << "property " << type << " y\n"
+                 << "property " << type << " z\n"
+                 << "element face " << num_f << "\n"
+                 << "property list uchar int vertex_indices\nend_header\n";
+            file.write(reinterpret_cast<const char*>(h_v),
+                       3 * size_t(num_v) * sizeof(T));
+
+            // interleave the count of every face with its indices
+            constexpr size_t  face_bytes = 1 + 3 * sizeof(uint32_t);
+            std::vector<char> buffer(chunk_bytes);
+            const uint32_t    faces_per_chunk = chunk_bytes / face_bytes;
+            for (uint32_t first = 0; first < num_f; first += faces_per_chunk) {
+                const uint32_t last =
+                    std::min(num_f, first + faces_per_chunk);
+                char* ptr = buffer.data();
+                for (uint32_t f = first; f < last; ++f) {
+                    *ptr++ = 3;
+                    std::memcpy(ptr, h_f + 3 * f, 3 * sizeof(uint32_t));
+                    ptr += 3 * sizeof(uint32_t);
+                }
+                file.write(buffer.data(), ptr - buffer.data());
+            }
+        }
+
+        const bool ok = file.good();
+        file.close();
+        if (!ok) {
+            RXMESH_ERROR("MeshWriter::write() failed to write {}", filename);
+        }
+        return ok;
+    }
+
+    std::vector<Slot> m_slots;
+
+    // per-patch number of owned vertices (then faces) and their prefix sum
+    uint32_t *m_d_count, *m_d_prefix;
+    uint32_t  m_count_capacity;
+    void*     m_d_scan_temp;
+    size_t    m_scan_temp_bytes;
+
+    uint32_t m_next;
+    uint32_t m_num_vertices, m_num_faces;
+};
+}  // namespace rxmesh
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "rxmesh/patch_stash.cuh"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Distance-2 coloring of the patch graph where two patches are
+ * neighbors if one of them is in the PatchStash of the other. A block that
+ * processes a patch with CavityManager locks the patch and the patches in its
+ * stash. So, two patches of the same color never lock the same patch and
+ * running the dynamic kernels one color at a time (see
+ * RXMeshDynamic::reset_scheduler_to_color) makes the lock conflicts between
+ * concurrent blocks disappear at the cost of one launch per color.
+ *
+ * After the patch graph changes (e.g., after slicing patches), the coloring
+ * is updated incrementally by recoloring only the patches whose neighbors
+ * changed. This is enough since any two patches that become within distance
+ * two share a new edge with at least one of them
+ */
+class PatchColoring
+{
+   public:
+    PatchColoring() : m_num_colors(0)
+    {
+    }
+
+    /**
+     * @brief color the patch graph. If the graph was colored before, only
+     * patches whose neighbors changed (or new patches) are recolored
+     * @param stash the patch stash of every patch stored contiguously i.e.,
+     * the stash of patch p starts at p * PatchStash::stash_size
+     * @param num_patches number of patches
+     * @return the number of recolored patches
+     */
+    uint32_t update(const std::vector<uint32_t>& stash,
+                    const uint32_t               num_patches)
+    {
+        assert(stash.size() >= num_patches * PatchStash::stash_size);
+
+        // symmetric adjacency
+        std::vector<std::vector<uint32_t>> adj(num_patches);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            for (uint32_t i = 0; i < PatchStash::stash_size; ++i) {
+                const uint32_t q = stash[p * PatchStash::stash_size + i];
+                if (q != INVALID32 && q != p && q < num_patches) {
+                    adj[p].push_back(q);
+                    adj[q].push_back(p);
+                }
+            }
+        }
+        for (auto& a : adj) {
+            std::sort(a.begin(), a.end());
+            a.erase(std::unique(a.begin(), a.end()), a.end());
+        }
+
+        // patches that are new or whose neighbors changed
+        std::vector<uint32_t> touched;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (p >= m_adj.size() || adj[p] != m_adj[p]) {
+                touched.push_back(p);
+            }
+        }
+
+        m_adj = std::move(adj);
+        m_color.resize(num_patches, INVALID32);
+        for (uint32_t p : touched) {
+            m_color[p] = INVALID32;
+        }
+
+        // greedy coloring: every patch takes the smallest color not used by
+        // any patch within distance two
+        std::vector<uint32_t> used;
+        for (uint32_t p : touched) {
+            used.clear();
+            for (uint32_t q : m_adj[p]) {
+                used.push_back(m_color[q]);
+                for (uint32_t r : m_adj[q]) {
+                    if (r != p) {
+                        used.push_back(m_color[r]);
+                    }
+                }
+            }
+            std::sort(used.begin(), used.end());
+            uint32_t c = 0;
+            for (uint32_t u : used) {
+                if (u == c) {
+                    ++c;
+                } else if (u > c) {
+                    break;
+                }
+            }
+            m_color[p] = c;
+        }
+
+        m_num_colors = 0;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            m_num_colors = std::max(m_num_colors, m_color[p] + 1);
+        }
+        m_color_patches.assign(m_num_colors, std::vector<uint32_t>());
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            m_color_patches[m_color[p]].push_back(p);
+        }
+
+        RXMESH_TRACE(
+            "PatchColoring::update() recolored {} patches. #colors = {}",
+            touched.size(),
+            m_num_colors);
+
+        return static_cast<uint32_t>(touched.size());
+    }
+
+    /**
+     * @brief check if the patch graph has been colored
+     */
+    bool is_colored() const
+    {
+        return m_num_colors > 0;
+    }
+
+    /**
+     * @brief number of colors
+     */
+    uint32_t get_num_colors() const
+    {
+        return m_num_colors;
+    }
+
+    /**
+     * @brief color of a patch
+     */
+    uint32_t get_color(const uint32_t p) const
+    {
+        assert(p < m_color.size());
+        return m_color[p];
+    }
+
+    /**
+     * @brief the patches that have a given color
+     */
+    const std::vector<uint32_t>& get_patches(const uint32_t color) const
+    {
+        assert(color < m_num_colors);
+        return m_color_patches[color];
+    }
+
+    /**
+     * @brief the neighbor patches of a patch in the patch graph
+     */
+    const std::vector<uint32_t>& get_neighbors(const uint32_t p) const
+    {
+        assert(p < m_adj.size());
+        return m_adj[p];
+    }
+
+   private:
+    uint32_t                           m_num_colors;
+    std::vector<uint32_t>              m_color;
+    std::vector<std::vector<uint32_t>> m_color_patches;
+    std::vector<std::vector<uint32_t>> m_adj;
+};
+}  // namespace rxmesh
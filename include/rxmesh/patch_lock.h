@@ -6,11 +6,17 @@
 namespace rxmesh {
 /**
  * @brief PatchLock implements a locking mechanism for the patch. This is meant
- * to be used only on the device
+ * to be used only on the device. Next to the lock, the patch carries a version
+ * counter that is used by the optimistic mode (see
+ * RXMeshDynamic::set_optimistic) where the patch is read without the lock and
+ * changes are committed only if the version did not change since it was read.
+ * The version is even when the patch is not being written and odd while a
+ * block is committing its changes to the patch
  */
 struct PatchLock
 {
-    __device__ __host__ PatchLock() : lock(nullptr), spin(nullptr){};
+    __device__ __host__ PatchLock()
+        : lock(nullptr), spin(nullptr), version(nullptr){};
     __device__ __host__ PatchLock(const PatchLock& other) = default;
     __device__ __host__ PatchLock(PatchLock&&)            = default;
     __device__ __host__ PatchLock& operator=(const PatchLock&) = default;
@@ -56,17 +62,75 @@ struct PatchLock
     }
 
     /**
-     * @brief check if the patch is locked
+     * @brief check if the patch is locked or if a block is committing its
+     * changes to the patch (in the optimistic mode)
      */
     __device__ bool is_locked()
     {
 #ifdef __CUDA_ARCH__
-        return atomic_read(lock) == LOCKED;
+        return atomic_read(lock) == LOCKED || (atomic_read(version) & 1u) != 0;
 #else
         return false;
 #endif
     }
 
+    /**
+     * @brief read the current version of the patch in v. Return false if a
+     * block is committing its changes to the patch and so the patch can not be
+     * read now
+     */
+    __device__ bool read_version(uint32_t& v)
+    {
+#ifdef __CUDA_ARCH__
+        v = atomic_read(version);
+        return (v & 1u) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief start committing changes to the patch if its version is still v
+     * (as returned by read_version()). This does not wait and returns false if
+     * another block has committed to the patch since v was read. On success,
+     * other blocks can not read or commit to the patch until end_commit() or
+     * abort_commit() is called
+     */
+    __device__ bool try_commit(const uint32_t v)
+    {
+#ifdef __CUDA_ARCH__
+        const bool ret = (::atomicCAS(version, v, v + 1) == v);
+        __threadfence();
+        return ret;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief finish a successful try_commit() and publish the new version of
+     * the patch. Should be called after all writes to the patch are done
+     */
+    __device__ void end_commit()
+    {
+#ifdef __CUDA_ARCH__
+        __threadfence();
+        ::atomicAdd(version, 1u);
+#endif
+    }
+
+    /**
+     * @brief undo a successful try_commit() when nothing was written to the
+     * patch. The version goes back to what it was before try_commit()
+     */
+    __device__ void abort_commit()
+    {
+#ifdef __CUDA_ARCH__
+        __threadfence();
+        ::atomicSub(version, 1u);
+#endif
+    }
+
     /**
      * @brief initialize the lock by allocating memory and initialized the
      * values. Should only be called from the host
@@ -75,6 +139,8 @@ struct PatchLock
     {
         CUDA_ERROR(cudaMalloc((void**)&lock, sizeof(uint32_t)));
         CUDA_ERROR(cudaMalloc((void**)&spin, sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&version, sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemset(version, 0, sizeof(uint32_t)));
         uint32_t h_lock = FREE, h_spin = INVALID32;
         CUDA_ERROR(cudaMemcpy(
             lock, &h_lock, sizeof(uint32_t), cudaMemcpyHostToDevice));
@@ -90,6 +156,7 @@ struct PatchLock
     {
         GPU_FREE(lock);
         GPU_FREE(spin);
+        GPU_FREE(version);
     }
 
 
@@ -98,7 +165,7 @@ struct PatchLock
     static constexpr uint32_t LOCKED      = INVALID32;
     static constexpr int      MAX_ATTEMPT = 10;
 
-    uint32_t *lock, *spin;
+    uint32_t *lock, *spin, *version;
 };
 
 }  // namespace rxmesh
\ No newline at end of file
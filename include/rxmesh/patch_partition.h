@@ -0,0 +1,424 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "rxmesh/patch_info.h"
+#include "rxmesh/patch_residency.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Partition of the patches over multiple GPUs. Every GPU owns a
+ * contiguous range of patches (balanced by the number of faces) and runs the
+ * kernels only on its patches. The patches in the PatchStash of a GPU's
+ * patches that are owned by other GPUs form the halo of this GPU.
+ *
+ * The per-patch device memory is allocated as CUDA managed memory and the
+ * partition places it using memory advice:
+ * - the topology is read-only (static mesh) and so it is marked as read-mostly
+ * and is replicated on the owner GPU and every GPU that has the patch in its
+ * halo
+ * - attributes prefer the owner GPU and are mapped to the halo GPUs so that the
+ * halo GPUs read/write the owner copy directly over peer-to-peer. With this,
+ * the ribbon (not-owned) elements always see the owner's values and so the
+ * halo exchange is done by the hardware. The only requirement is that all GPUs
+ * are synchronized between two kernels which is what run() does
+ */
+class PatchPartition
+{
+   public:
+    PatchPartition()
+        : m_num_gpus(1), m_num_patches(0), m_primary(0), m_start(NULL)
+    {
+    }
+
+    PatchPartition(const PatchPartition&)            = delete;
+    PatchPartition& operator=(const PatchPartition&) = delete;
+
+    ~PatchPartition()
+    {
+        if (m_streams.empty()) {
+            return;
+        }
+        int current = 0;
+        CUDA_ERROR(cudaGetDevice(&current));
+        for (int g = 0; g < m_num_gpus; ++g) {
+            CUDA_ERROR(cudaSetDevice(m_devices[g]));
+            CUDA_ERROR(cudaStreamDestroy(m_streams[g]));
+            CUDA_ERROR(cudaEventDestroy(m_done[g]));
+        }
+        CUDA_ERROR(cudaSetDevice(m_primary));
+        CUDA_ERROR(cudaEventDestroy(m_start));
+        CUDA_ERROR(cudaSetDevice(current));
+    }
+
+    /**
+     * @brief split the patches over the GPUs, enable peer access between the
+     * GPUs, and place the patches topology on the GPUs. The current device is
+     * the primary GPU (GPU 0) and the rest of the GPUs are the next devices
+     * in order
+     * @param num_gpus the requested number of GPUs
+     * @param num_patches number of patches in the mesh
+     * @param h_patches_info host patches (used for the capacities and the
+     * patch stash)
+     * @param d_patches_info device patches (allocated as managed memory)
+     * @return false if the GPUs can not be used together i.e., they do not
+     * support peer access or concurrent managed access. In this case, the
+     * partition falls back to a single GPU
+     */
+    bool init(const int        num_gpus,
+              const uint32_t   num_patches,
+              const PatchInfo* h_patches_info,
+              const PatchInfo* d_patches_info)
+    {
+        m_num_patches = num_patches;
+        m_num_gpus    = 1;
+
+        CUDA_ERROR(cudaGetDevice(&m_primary));
+
+        int num_devices = 0;
+        CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+
+        int n = std::min(num_gpus, num_devices);
+        n     = std::min(n, static_cast<int>(num_patches));
+        if (n < num_gpus) {
+            RXMESH_WARN(
+                "PatchPartition::init() requested {} GPUs but only {} can be "
+                "used (#devices = {}, #patches = {})",
+                num_gpus,
+                n,
+                num_devices,
+                num_patches);
+        }
+
+        m_devices.resize(std::max(n, 1));
+        for (int g = 0; g < n; ++g) {
+            m_devices[g] = (m_primary + g) % num_devices;
+        }
+        if (n <= 1) {
+            m_devices[0] = m_primary;
+            partition(1, h_patches_info);
+            return n == 1;
+        }
+
+        if (!enable_peer_access(n)) {
+            partition(1, h_patches_info);
+            return false;
+        }
+
+        m_num_gpus = n;
+        partition(m_num_gpus, h_patches_info);
+
+        m_streams.resize(m_num_gpus);
+        m_done.resize(m_num_gpus);
+        for (int g = 0; g < m_num_gpus; ++g) {
+            CUDA_ERROR(cudaSetDevice(m_devices[g]));
+            CUDA_ERROR(cudaStreamCreateWithFlags(&m_streams[g],
+                                                 cudaStreamNonBlocking));
+            CUDA_ERROR(
+                cudaEventCreateWithFlags(&m_done[g], cudaEventDisableTiming));
+        }
+        CUDA_ERROR(cudaSetDevice(m_primary));
+        CUDA_ERROR(cudaEventCreateWithFlags(&m_start, cudaEventDisableTiming));
+
+        // the topology is replicated on the owner and halo GPUs
+        const std::vector<std::vector<detail::PatchMemoryRange>> ranges =
+            detail::collect_patch_memory(
+                num_patches, h_patches_info, d_patches_info);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            for (const detail::PatchMemoryRange& r : ranges[p]) {
+                place_patch_memory(p, r.ptr, r.num_bytes, true);
+            }
+        }
+        place_shared_memory(d_patches_info, num_patches * sizeof(PatchInfo));
+
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        for (int g = 0; g < m_num_gpus; ++g) {
+            RXMESH_TRACE(
+                "PatchPartition::init() GPU {} (device {}) owns patches [{}, "
+                "{}) with {} halo patches",
+                g,
+                m_devices[g],
+                m_begin[g],
+                m_begin[g] + m_count[g],
+                m_halo[g].size());
+        }
+        return true;
+    }
+
+    /**
+     * @brief number of GPUs the patches are split over
+     */
+    int get_num_gpus() const
+    {
+        return m_num_gpus;
+    }
+
+    /**
+     * @brief the CUDA device ordinal of a GPU in the partition
+     */
+    int get_device(const int gpu) const
+    {
+        return m_devices[gpu];
+    }
+
+    /**
+     * @brief the first patch owned by a GPU
+     */
+    uint32_t get_patch_begin(const int gpu) const
+    {
+        return m_begin[gpu];
+    }
+
+    /**
+     * @brief number of (consecutive) patches owned by a GPU
+     */
+    uint32_t get_patch_count(const int gpu) const
+    {
+        return m_count[gpu];
+    }
+
+    /**
+     * @brief the GPU that owns a patch
+     */
+    int get_patch_gpu(const uint32_t patch_id) const
+    {
+        return m_patch_gpu[patch_id];
+    }
+
+    /**
+     * @brief patches owned by other GPUs that are neighbors (in PatchStash) to
+     * the patches of a GPU (sorted)
+     */
+    const std::vector<uint32_t>& get_halo_patches(const int gpu) const
+    {
+        return m_halo[gpu];
+    }
+
+    /**
+     * @brief place a managed device allocation of a patch on its owner GPU.
+     * Read-mostly memory is replicated on the owner and halo GPUs. Otherwise,
+     * the memory lives on the owner and is mapped to the halo GPUs.
+     * @param patch_id the patch that the memory belongs to
+     * @param ptr the managed memory
+     * @param num_bytes size of the memory
+     * @param read_mostly if the memory is not written by kernels
+     */
+    void place_patch_memory(const uint32_t patch_id,
+                            const void*    ptr,
+                            const size_t   num_bytes,
+                            const bool     read_mostly) const
+    {
+        if (m_num_gpus <= 1 || patch_id >= m_num_patches || ptr == nullptr ||
+            num_bytes == 0) {
+            return;
+        }
+
+        const int owner = m_devices[m_patch_gpu[patch_id]];
+
+        if (read_mostly) {
+            CUDA_ERROR(cudaMemAdvise(
+                ptr, num_bytes, cudaMemAdviseSetReadMostly, owner));
+            CUDA_ERROR(cudaMemPrefetchAsync(ptr, num_bytes, owner, NULL));
+            for (const int g : m_patch_halo_gpus[patch_id]) {
+                CUDA_ERROR(
+                    cudaMemPrefetchAsync(ptr, num_bytes, m_devices[g], NULL));
+            }
+        } else {
+            CUDA_ERROR(cudaMemAdvise(
+                ptr, num_bytes, cudaMemAdviseSetPreferredLocation, owner));
+            for (const int g : m_patch_halo_gpus[patch_id]) {
+                CUDA_ERROR(cudaMemAdvise(
+                    ptr, num_bytes, cudaMemAdviseSetAccessedBy, m_devices[g]));
+            }
+            CUDA_ERROR(cudaMemPrefetchAsync(ptr, num_bytes, owner, NULL));
+        }
+    }
+
+    /**
+     * @brief replicate a (read-only) managed allocation that is used by all
+     * patches (e.g., the patches table) on all GPUs
+     */
+    void place_shared_memory(const void* ptr, const size_t num_bytes) const
+    {
+        if (m_num_gpus <= 1 || ptr == nullptr || num_bytes == 0) {
+            return;
+        }
+        CUDA_ERROR(cudaMemAdvise(
+            ptr, num_bytes, cudaMemAdviseSetReadMostly, m_primary));
+        for (int g = 0; g < m_num_gpus; ++g) {
+            CUDA_ERROR(
+                cudaMemPrefetchAsync(ptr, num_bytes, m_devices[g], NULL));
+        }
+    }
+
+    /**
+     * @brief run a kernel on all GPUs where every GPU processes its own
+     * patches. The GPUs start after all the work already on stream and stream
+     * waits for all GPUs to finish so subsequent work on stream (e.g.,
+     * another kernel) sees the results of all GPUs
+     * @param stream stream on the primary GPU
+     * @param launch launch(gpu, begin, count, gpu_stream) launches a kernel
+     * over the patches [begin, begin + count) on gpu_stream. It is called
+     * while the current device is the GPU's device
+     */
+    template <typename LaunchT>
+    void run(cudaStream_t stream, LaunchT launch) const
+    {
+        if (m_num_gpus <= 1) {
+            launch(0, uint32_t(0), m_num_patches, stream);
+            return;
+        }
+
+        int current = 0;
+        CUDA_ERROR(cudaGetDevice(&current));
+
+        CUDA_ERROR(cudaSetDevice(m_primary));
+        CUDA_ERROR(cudaEventRecord(m_start, stream));
+
+        for (int g = 0; g < m_num_gpus; ++g) {
+            CUDA_ERROR(cudaSetDevice(m_devices[g]));
+            CUDA_ERROR(cudaStreamWaitEvent(m_streams[g], m_start, 0));
+            if (m_count[g] > 0) {
+                launch(g, m_begin[g], m_count[g], m_streams[g]);
+            }
+            CUDA_ERROR(cudaEventRecord(m_done[g], m_streams[g]));
+        }
+
+        CUDA_ERROR(cudaSetDevice(m_primary));
+        for (int g = 0; g < m_num_gpus; ++g) {
+            CUDA_ERROR(cudaStreamWaitEvent(stream, m_done[g], 0));
+        }
+        CUDA_ERROR(cudaSetDevice(current));
+    }
+
+   private:
+    /**
+     * @brief enable peer access between every pair of GPUs and check that
+     * they support concurrent managed access
+     */
+    bool enable_peer_access(const int n)
+    {
+        for (int i = 0; i < n; ++i) {
+            int concurrent_managed_access = 0;
+            CUDA_ERROR(
+                cudaDeviceGetAttribute(&concurrent_managed_access,
+                                       cudaDevAttrConcurrentManagedAccess,
+                                       m_devices[i]));
+            if (concurrent_managed_access == 0) {
+                RXMESH_WARN(
+                    "PatchPartition::init() device {} does not support "
+                    "concurrent managed access. Falling back to a single GPU",
+                    m_devices[i]);
+                return false;
+            }
+            for (int j = 0; j < n; ++j) {
+                if (i == j) {
+                    continue;
+                }
+                int can_access = 0;
+                CUDA_ERROR(cudaDeviceCanAccessPeer(
+                    &can_access, m_devices[i], m_devices[j]));
+                if (can_access == 0) {
+                    RXMESH_WARN(
+                        "PatchPartition::init() device {} can not access "
+                        "device {}. Falling back to a single GPU",
+                        m_devices[i],
+                        m_devices[j]);
+                    return false;
+                }
+            }
+        }
+
+        for (int i = 0; i < n; ++i) {
+            CUDA_ERROR(cudaSetDevice(m_devices[i]));
+            for (int j = 0; j < n; ++j) {
+                if (i == j) {
+                    continue;
+                }
+                cudaError_t err = cudaDeviceEnablePeerAccess(m_devices[j], 0);
+                if (err == cudaErrorPeerAccessAlreadyEnabled) {
+                    // clear the error
+                    cudaGetLastError();
+                } else {
+                    CUDA_ERROR(err);
+                }
+            }
+        }
+        CUDA_ERROR(cudaSetDevice(m_primary));
+        return true;
+    }
+
+    /**
+     * @brief split the patches into n contiguous ranges with (almost) the
+     * same number of faces and compute the halo of every GPU
+     */
+    void partition(const int n, const PatchInfo* h_patches_info)
+    {
+        m_begin.assign(n, 0);
+        m_count.assign(n, 0);
+        m_halo.assign(n, std::vector<uint32_t>());
+        m_patch_gpu.assign(m_num_patches, 0);
+        m_patch_halo_gpus.assign(m_num_patches, std::vector<int>());
+
+        uint64_t total = 0;
+        for (uint32_t p = 0; p < m_num_patches; ++p) {
+            total += h_patches_info[p].num_faces[0];
+        }
+
+        uint64_t acc = 0;
+        int      g   = 0;
+        for (uint32_t p = 0; p < m_num_patches; ++p) {
+            // move to the next GPU once this GPU has its share of faces while
+            // leaving at least one patch for every remaining GPU
+            const uint32_t remaining_patches = m_num_patches - p;
+            const int      remaining_gpus    = n - g - 1;
+            if (g + 1 < n && m_count[g] > 0 &&
+                (acc * n >= total * (g + 1) ||
+                 remaining_patches <= uint32_t(remaining_gpus))) {
+                ++g;
+                m_begin[g] = p;
+            }
+            m_patch_gpu[p] = g;
+            m_count[g]++;
+            acc += h_patches_info[p].num_faces[0];
+        }
+
+        for (uint32_t p = 0; p < m_num_patches; ++p) {
+            const int gp = m_patch_gpu[p];
+            for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                const uint32_t q = h_patches_info[p].patch_stash.get_patch(i);
+                if (q < m_num_patches && m_patch_gpu[q] != gp) {
+                    m_halo[gp].push_back(q);
+                }
+            }
+        }
+
+        for (int i = 0; i < n; ++i) {
+            std::sort(m_halo[i].begin(), m_halo[i].end());
+            m_halo[i].erase(std::unique(m_halo[i].begin(), m_halo[i].end()),
+                            m_halo[i].end());
+            for (const uint32_t q : m_halo[i]) {
+                m_patch_halo_gpus[q].push_back(i);
+            }
+        }
+    }
+
+    int                                m_num_gpus;
+    uint32_t                           m_num_patches;
+    int                                m_primary;
+    std::vector<int>                   m_devices;
+    std::vector<uint32_t>              m_begin, m_count;
+    std::vector<int>                   m_patch_gpu;
+    std::vector<std::vector<uint32_t>> m_halo;
+    std::vector<std::vector<int>>      m_patch_halo_gpus;
+    std::vector<cudaStream_t>          m_streams;
+    std::vector<cudaEvent_t>           m_done;
+    cudaEvent_t                        m_start;
+};
+}  // namespace rxmesh
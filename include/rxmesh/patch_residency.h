@@ -0,0 +1,367 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "rxmesh/patch_info.h"
+#include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+namespace detail {
+/**
+ * @brief a contiguous piece of the device memory of a patch
+ */
+struct PatchMemoryRange
+{
+    const void* ptr;
+    size_t      num_bytes;
+};
+
+/**
+ * @brief collect the device memory of the topology of every patch i.e.,
+ * counts, ev, fe, dirty, masks, patch stash, and hash tables. The device
+ * pointers are read from the device copy of PatchInfo
+ * @param num_patches number of patches
+ * @param h_patches_info host patches (used for the capacities)
+ * @param d_patches_info device patches
+ */
+inline std::vector<std::vector<PatchMemoryRange>> collect_patch_memory(
+    const uint32_t   num_patches,
+    const PatchInfo* h_patches_info,
+    const PatchInfo* d_patches_info)
+{
+    std::vector<PatchInfo> d_patches(num_patches);
+    CUDA_ERROR(cudaMemcpy(d_patches.data(),
+                          d_patches_info,
+                          num_patches * sizeof(PatchInfo),
+                          cudaMemcpyDeviceToHost));
+
+    std::vector<std::vector<PatchMemoryRange>> ranges(num_patches);
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        const PatchInfo& h = h_patches_info[p];
+        const PatchInfo& d = d_patches[p];
+
+        const uint16_t cap_v = h.vertices_capacity[0];
+        const uint16_t cap_e = h.edges_capacity[0];
+        const uint16_t cap_f = h.faces_capacity[0];
+
+        auto add = [&](const void* ptr, const size_t num_bytes) {
+            if (ptr != nullptr && num_bytes > 0) {
+                ranges[p].push_back({ptr, num_bytes});
+            }
+        };
+
+        // counts and capacities are contiguous and start with num_faces
+        add(d.num_faces, 6 * sizeof(uint16_t));
+        add(d.ev, 2 * size_t(cap_e) * sizeof(LocalVertexT));
+        add(d.fe, 3 * size_t(cap_f) * sizeof(LocalEdgeT));
+        add(d.dirty, sizeof(int));
+        add(d.active_mask_v, detail::mask_num_bytes(cap_v));
+        add(d.active_mask_e, detail::mask_num_bytes(cap_e));
+        add(d.active_mask_f, detail::mask_num_bytes(cap_f));
+        add(d.owned_mask_v, detail::mask_num_bytes(cap_v));
+        add(d.owned_mask_e, detail::mask_num_bytes(cap_e));
+        add(d.owned_mask_f, detail::mask_num_bytes(cap_f));
+        add(d.patch_stash.m_stash, PatchStash::stash_size * sizeof(uint32_t));
+        for (const LPHashTable* lp : {&d.lp_v, &d.lp_e, &d.lp_f}) {
+            add(lp->m_table, lp->num_bytes());
+            add(lp->m_stash, LPHashTable::stash_size * sizeof(LPPair));
+        }
+    }
+    return ranges;
+}
+}  // namespace detail
+
+/**
+ * @brief Streaming of patches for meshes that are larger than the device
+ * memory. In streaming mode, the per-patch device arrays (topology, masks,
+ * hash tables, and attributes) are allocated as CUDA managed memory so that
+ * they can exceed the device memory. Kernels are then run in waves of
+ * consecutive patches where only the patches of the current wave (plus their
+ * ribbon neighbors in PatchStash) are kept on the device. The next wave is
+ * prefetched on a separate stream while the current wave runs and the patches
+ * that are not needed by the next wave are evicted to the host once the
+ * current wave finishes. The working set of a single wave is at most half of
+ * the maximum number of resident patches so that two waves fit on the device
+ * at the same time
+ */
+class PatchResidency
+{
+   public:
+    PatchResidency()
+        : m_max_resident_patches(0),
+          m_num_patches(0),
+          m_device(0),
+          m_can_prefetch(false),
+          m_copy_stream(NULL),
+          m_prefetch_done(NULL),
+          m_compute_done(NULL)
+    {
+    }
+
+    PatchResidency(const PatchResidency&)            = delete;
+    PatchResidency& operator=(const PatchResidency&) = delete;
+
+    ~PatchResidency()
+    {
+        if (m_copy_stream != NULL) {
+            CUDA_ERROR(cudaStreamDestroy(m_copy_stream));
+            CUDA_ERROR(cudaEventDestroy(m_prefetch_done));
+            CUDA_ERROR(cudaEventDestroy(m_compute_done));
+        }
+    }
+
+    /**
+     * @brief collect the device memory of every patch and split the patches
+     * into waves
+     * @param max_resident_patches maximum number of patches to keep on the
+     * device
+     * @param num_patches number of patches in the mesh
+     * @param h_patches_info host patches (used for the capacities and the
+     * patch stash)
+     * @param d_patches_info device patches (allocated as managed memory)
+     */
+    void init(const uint32_t   max_resident_patches,
+              const uint32_t   num_patches,
+              const PatchInfo* h_patches_info,
+              const PatchInfo* d_patches_info)
+    {
+        m_max_resident_patches = max_resident_patches;
+        m_num_patches          = num_patches;
+
+        CUDA_ERROR(cudaGetDevice(&m_device));
+        int concurrent_managed_access = 0;
+        CUDA_ERROR(
+            cudaDeviceGetAttribute(&concurrent_managed_access,
+                                   cudaDevAttrConcurrentManagedAccess,
+                                   m_device));
+        m_can_prefetch = (concurrent_managed_access != 0);
+        if (!m_can_prefetch) {
+            RXMESH_WARN(
+                "PatchResidency::init() the device does not support "
+                "concurrent managed access. Patches will be migrated on "
+                "demand and kernels will not run in waves");
+        }
+
+        if (m_copy_stream == NULL) {
+            CUDA_ERROR(cudaStreamCreateWithFlags(&m_copy_stream,
+                                                 cudaStreamNonBlocking));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_prefetch_done,
+                                                cudaEventDisableTiming));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_compute_done,
+                                                cudaEventDisableTiming));
+        }
+
+        // the device copy of PatchInfo holds the (managed) device pointers
+        m_ranges = detail::collect_patch_memory(
+            num_patches, h_patches_info, d_patches_info);
+
+        build_waves(h_patches_info);
+
+        m_is_resident.assign(num_patches, 0);
+        m_resident.clear();
+
+        RXMESH_TRACE(
+            "PatchResidency::init() max resident patches = {}, #waves = {}",
+            m_max_resident_patches,
+            m_waves.size());
+    }
+
+    /**
+     * @brief number of waves needed to go over all patches
+     */
+    uint32_t get_num_waves() const
+    {
+        return static_cast<uint32_t>(m_waves.size());
+    }
+
+    /**
+     * @brief the patches of a wave i.e., the consecutive patches processed by
+     * the wave and their ribbon neighbors
+     */
+    const std::vector<uint32_t>& get_wave_patches(const uint32_t wave) const
+    {
+        return m_waves[wave].patches;
+    }
+
+    /**
+     * @brief run a kernel over all patches in waves
+     * @param stream the stream on which the kernel is launched
+     * @param launch launch(begin, count) launches the kernel on stream over
+     * the patches [begin, begin + count)
+     * @param prefetch_extra prefetch_extra(patch_id, device, stream)
+     * prefetches additional per-patch data (e.g., attributes) of a patch to
+     * device (or cudaCpuDeviceId) on stream
+     */
+    template <typename LaunchT, typename PrefetchT>
+    void run(cudaStream_t stream, LaunchT launch, PrefetchT prefetch_extra)
+    {
+        if (!m_can_prefetch || m_waves.empty()) {
+            launch(0, m_num_patches);
+            return;
+        }
+
+        // the first wave is prefetched after everything before it on stream
+        CUDA_ERROR(cudaEventRecord(m_compute_done, stream));
+        CUDA_ERROR(cudaStreamWaitEvent(m_copy_stream, m_compute_done, 0));
+        prefetch_wave(0, prefetch_extra);
+        CUDA_ERROR(cudaEventRecord(m_prefetch_done, m_copy_stream));
+        evict(0, prefetch_extra);
+
+        for (uint32_t w = 0; w < m_waves.size(); ++w) {
+            CUDA_ERROR(cudaStreamWaitEvent(stream, m_prefetch_done, 0));
+
+            launch(m_waves[w].begin, m_waves[w].count);
+
+            CUDA_ERROR(cudaEventRecord(m_compute_done, stream));
+
+            if (w + 1 < m_waves.size()) {
+                // overlaps with the current wave
+                prefetch_wave(w + 1, prefetch_extra);
+                CUDA_ERROR(cudaEventRecord(m_prefetch_done, m_copy_stream));
+
+                CUDA_ERROR(
+                    cudaStreamWaitEvent(m_copy_stream, m_compute_done, 0));
+                evict(w + 1, prefetch_extra);
+            }
+        }
+    }
+
+   private:
+    struct Wave
+    {
+        uint32_t              begin, count;
+        std::vector<uint32_t> patches;
+    };
+
+    /**
+     * @brief greedily grow waves of consecutive patches as long as the wave
+     * along with the ribbon neighbors fits in half of the resident patches
+     */
+    void build_waves(const PatchInfo* h_patches_info)
+    {
+        m_waves.clear();
+
+        const uint32_t wave_budget = std::max(1u, m_max_resident_patches / 2);
+
+        // the wave that a patch was last added to
+        std::vector<uint32_t> in_wave(m_num_patches, INVALID32);
+
+        // the patches that p adds to the current wave i.e., p and its ribbon
+        // neighbors that are not already in the wave
+        std::vector<uint32_t> added;
+        auto                  collect = [&](const uint32_t p) {
+            added.clear();
+            auto try_add = [&](const uint32_t q) {
+                if (q < m_num_patches && in_wave[q] != m_waves.size() &&
+                    std::find(added.begin(), added.end(), q) == added.end()) {
+                    added.push_back(q);
+                }
+            };
+            try_add(p);
+            for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                try_add(h_patches_info[p].patch_stash.get_patch(i));
+            }
+        };
+
+        Wave wave;
+        wave.begin = 0;
+        wave.count = 0;
+
+        for (uint32_t p = 0; p < m_num_patches; ++p) {
+            collect(p);
+
+            if (wave.count > 0 &&
+                wave.patches.size() + added.size() > wave_budget) {
+                m_waves.push_back(std::move(wave));
+                wave       = Wave();
+                wave.begin = p;
+                wave.count = 0;
+                collect(p);
+            }
+
+            for (uint32_t q : added) {
+                in_wave[q] = static_cast<uint32_t>(m_waves.size());
+                wave.patches.push_back(q);
+            }
+            wave.count++;
+        }
+
+        if (wave.count > 0) {
+            m_waves.push_back(std::move(wave));
+        }
+
+        for (Wave& w : m_waves) {
+            std::sort(w.patches.begin(), w.patches.end());
+            if (w.patches.size() > wave_budget) {
+                RXMESH_WARN(
+                    "PatchResidency::build_waves() patch {} along with its "
+                    "ribbon neighbors needs {} resident patches which is more "
+                    "than half of the maximum resident patches ({})",
+                    w.begin,
+                    w.patches.size(),
+                    m_max_resident_patches);
+            }
+        }
+    }
+
+    template <typename PrefetchT>
+    void prefetch_patch(const uint32_t p,
+                        const int      device,
+                        PrefetchT      prefetch_extra)
+    {
+        for (const detail::PatchMemoryRange& r : m_ranges[p]) {
+            CUDA_ERROR(cudaMemPrefetchAsync(
+                r.ptr, r.num_bytes, device, m_copy_stream));
+        }
+        prefetch_extra(p, device, m_copy_stream);
+    }
+
+    template <typename PrefetchT>
+    void prefetch_wave(const uint32_t wave, PrefetchT prefetch_extra)
+    {
+        for (uint32_t p : m_waves[wave].patches) {
+            if (!m_is_resident[p]) {
+                prefetch_patch(p, m_device, prefetch_extra);
+            }
+        }
+    }
+
+    /**
+     * @brief evict all resident patches that are not in a given wave and mark
+     * the patches of this wave as resident
+     */
+    template <typename PrefetchT>
+    void evict(const uint32_t wave, PrefetchT prefetch_extra)
+    {
+        const std::vector<uint32_t>& next = m_waves[wave].patches;
+
+        for (uint32_t p : m_resident) {
+            if (!std::binary_search(next.begin(), next.end(), p)) {
+                prefetch_patch(p, cudaCpuDeviceId, prefetch_extra);
+                m_is_resident[p] = 0;
+            }
+        }
+
+        m_resident = next;
+        for (uint32_t p : m_resident) {
+            m_is_resident[p] = 1;
+        }
+    }
+
+    uint32_t                                           m_max_resident_patches;
+    uint32_t                                           m_num_patches;
+    int                                                m_device;
+    bool                                               m_can_prefetch;
+    cudaStream_t                                       m_copy_stream;
+    cudaEvent_t m_prefetch_done, m_compute_done;
+    std::vector<std::vector<detail::PatchMemoryRange>> m_ranges;
+    std::vector<Wave>                                  m_waves;
+    std::vector<uint8_t>                               m_is_resident;
+    std::vector<uint32_t>                              m_resident;
+};
+}  // namespace rxmesh
@@ -7,13 +7,35 @@
 // inspired/taken from
 // https://github.com/GPUPeople/Ouroboros/blob/9153c55abffb3bceb5aea4028dfcc00439b046d5/include/device/queues/Queue.h
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "rxmesh/kernels/util.cuh"
 #include "rxmesh/util/util.h"
 
 namespace rxmesh {
+/**
+ * @brief a queue of patches to be processed by dynamic kernels (e.g., by
+ * CavityManager). The queue is split into num_queues ring buffers (one per SM
+ * by default) to reduce the contention on the atomics. A block pushes/pops to
+ * the ring buffer of the SM it is running on and steals from other ring
+ * buffers if its own is empty (or full on push)
+ */
 struct PatchScheduler
 {
     __device__ __host__ PatchScheduler()
-        : list(nullptr), count(nullptr), capacity(0){};
+        : list(nullptr),
+          count(nullptr),
+          front(nullptr),
+          back(nullptr),
+          total(nullptr),
+          deferred(nullptr),
+          num_deferred(nullptr),
+          capacity(0),
+          queue_capacity(0),
+          num_queues(0),
+          defer(false){};
     __device__ __host__ PatchScheduler(const PatchScheduler& other) = default;
     __device__ __host__ PatchScheduler(PatchScheduler&&)            = default;
     __device__ __host__ PatchScheduler& operator=(const PatchScheduler&) =
@@ -32,28 +54,27 @@ struct PatchScheduler
         return true;
 #else
         assert(pid != INVALID32);
-        if (::atomicAdd(count, 1) < static_cast<int>(capacity)) {
-            int pos = ::atomicAdd(back, 1) % capacity;
-
-            // the loop because another thread/block may have just decremented
-            // the count but has not yet finish reading from the list
-            while (::atomicCAS(list + pos, INVALID32, pid) != INVALID32) {
-                // TODO do we really need to sleep if it is only one thread
-                // in the block doing the job??
-                //__nanosleep(10);
+        if (defer) {
+            const int i = ::atomicAdd(num_deferred, 1);
+            assert(i < static_cast<int>(2 * capacity));
+            if (i < static_cast<int>(2 * capacity)) {
+                deferred[i] = pid;
             }
             return true;
-        } else {
-            // for our configuration, this should not happen since a block only
-            // pop a patch and, if not able to process it due to dependency
-            // conflict, the block push the same patch again. So at all times
-            // count is less than capacity if capacity is total number of
-            // patches
-            assert(0);
-            return false;
         }
-
-
+        const uint32_t local = local_queue();
+        for (uint32_t i = 0; i < num_queues; ++i) {
+            if (push(pid, (local + i) % num_queues)) {
+                return true;
+            }
+        }
+        // for our configuration, this should not happen since a block only
+        // pop a patch and, if not able to process it due to dependency
+        // conflict, the block push the same patch again. So at all times
+        // count is less than capacity if capacity is total number of
+        // patches
+        assert(0);
+        return false;
 #endif
 #endif
     }
@@ -67,26 +88,14 @@ struct PatchScheduler
 #ifdef PROCESS_SINGLE_PATCH
         return blockIdx.x;
 #else
-        int readable = ::atomicSub(count, 1);
-
-        uint32_t pid = INVALID32;
-
-        if (readable <= 0) {
-            ::atomicAdd(count, 1);
-        } else {
-
-            int pos = ::atomicAdd(front, 1) % capacity;
-
-            // the loop because another thread/block may have just incremented
-            // the count but has not yet wrote to the list
-            while (pid == INVALID32) {
-                pid = atomicExch(list + pos, INVALID32);
-                // TODO do we really need to sleep if it is only one thread
-                // in the block doing the job??
-                //__nanosleep(10);
+        const uint32_t local = local_queue();
+        for (uint32_t i = 0; i < num_queues; ++i) {
+            const uint32_t pid = pop((local + i) % num_queues);
+            if (pid != INVALID32) {
+                return pid;
             }
         }
-        return pid;
+        return INVALID32;
 #endif
 #endif
     }
@@ -94,49 +103,159 @@ struct PatchScheduler
     /**
      * @brief fill the list by sequential numbers
      */
-    __host__ void refill(const uint32_t size)
+    __host__ void refill(const uint32_t size, cudaStream_t stream = NULL)
+    {
+        std::vector<uint32_t> h_pids(size);
+        fill_with_sequential_numbers(h_pids.data(), size);
+        random_shuffle(h_pids.data(), size);
+        refill(h_pids, stream);
+    }
+
+    /**
+     * @brief fill the list with the patches that have pending work such that
+     * patches with more work are processed first. Patches are sorted by
+     * their priority (in descending order) and distributed over the ring
+     * buffers in round robin so every ring buffer starts with its heaviest
+     * patches. Patches with zero priority are not added
+     * @param size the number of patches
+     * @param priority the priority (e.g., number of elements to be processed)
+     * of every patch
+     * @param stream the stream used to copy the list to the device
+     */
+    __host__ void refill(const uint32_t               size,
+                         const std::vector<uint32_t>& priority,
+                         cudaStream_t                 stream = NULL)
     {
-        static std::vector<uint32_t> h_list(capacity);
-        if (h_list.size() < capacity) {
-            h_list.resize(capacity);
+        assert(priority.size() >= size);
+        std::vector<uint32_t> h_pids;
+        h_pids.reserve(size);
+        for (uint32_t p = 0; p < size; ++p) {
+            if (priority[p] > 0) {
+                h_pids.push_back(p);
+            }
         }
-        fill_with_sequential_numbers(h_list.data(), size);
-        random_shuffle(h_list.data(), size);
-        std::fill(h_list.begin() + size, h_list.end(), INVALID32);
-        CUDA_ERROR(cudaMemcpy(list,
-                              h_list.data(),
-                              capacity * sizeof(uint32_t),
-                              cudaMemcpyHostToDevice));
-        CUDA_ERROR(
-            cudaMemcpy(count, &size, sizeof(int), cudaMemcpyHostToDevice));
+        std::stable_sort(
+            h_pids.begin(), h_pids.end(), [&](uint32_t a, uint32_t b) {
+                return priority[a] > priority[b];
+            });
+        refill(h_pids, stream);
+    }
 
-        CUDA_ERROR(
-            cudaMemcpy(back, &size, sizeof(int), cudaMemcpyHostToDevice));
+    /**
+     * @brief fill the list with the input patches. The patches are
+     * distributed over the ring buffers in round robin. The copies are
+     * ordered on the stream such that schedulers used on different streams
+     * can be refilled without synchronizing the device
+     */
+    __host__ void refill(const std::vector<uint32_t>& pids,
+                         cudaStream_t                 stream = NULL)
+    {
+        assert(pids.size() <= capacity);
+
+        // not static so that different schedulers can be refilled from
+        // different host threads
+        std::vector<uint32_t> h_list(num_queues * queue_capacity, INVALID32);
+
+        std::vector<int> h_count(num_queues, 0);
+        for (uint32_t i = 0; i < pids.size(); ++i) {
+            const uint32_t q = i % num_queues;
+            h_list[q * queue_capacity + h_count[q]] = pids[i];
+            h_count[q]++;
+        }
+
+        // the host buffers are pageable and so they are staged before
+        // cudaMemcpyAsync returns i.e., they can go out of scope
+        CUDA_ERROR(cudaMemcpyAsync(list,
+                                   h_list.data(),
+                                   h_list.size() * sizeof(uint32_t),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(count,
+                                   h_count.data(),
+                                   num_queues * sizeof(int),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(back,
+                                   h_count.data(),
+                                   num_queues * sizeof(int),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
 
-        CUDA_ERROR(cudaMemset(front, 0, sizeof(int)));
+        CUDA_ERROR(cudaMemsetAsync(front, 0, num_queues * sizeof(int), stream));
+    }
+
+    /**
+     * @brief return the patches pushed since the last call while the pushes
+     * are deferred (see defer) and clear them. The patches are sorted and
+     * without duplicates so the result does not depend on the order in which
+     * the blocks pushed them
+     */
+    __host__ std::vector<uint32_t> take_deferred(cudaStream_t stream = NULL)
+    {
+        int num = 0;
+        CUDA_ERROR(cudaMemcpyAsync(&num,
+                                   num_deferred,
+                                   sizeof(int),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        num = std::min(num, static_cast<int>(2 * capacity));
+
+        std::vector<uint32_t> h_pids(num);
+        if (num > 0) {
+            CUDA_ERROR(cudaMemcpyAsync(h_pids.data(),
+                                       deferred,
+                                       num * sizeof(uint32_t),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+        }
+        CUDA_ERROR(cudaMemsetAsync(num_deferred, 0, sizeof(int), stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        std::sort(h_pids.begin(), h_pids.end());
+        h_pids.erase(std::unique(h_pids.begin(), h_pids.end()), h_pids.end());
+        return h_pids;
     }
 
     /**
      * @brief initialize all the memories
+     * @param cap the maximum number of patches in the queue
+     * @param num_q the number of ring buffers. Every ring buffer can hold
+     * twice its share of the patches so a block rarely needs to push to
+     * another ring buffer
      */
-    __host__ void init(uint32_t cap)
+    __host__ void init(uint32_t cap, uint32_t num_q = 1)
     {
-        capacity = cap;
-        CUDA_ERROR(cudaMalloc((void**)&count, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&front, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&back, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&list, sizeof(uint32_t) * capacity));
+        capacity       = cap;
+        num_queues     = std::max(num_q, 1u);
+        queue_capacity = (num_queues == 1) ?
+                             capacity :
+                             2 * DIVIDE_UP(capacity, num_queues);
+        CUDA_ERROR(cudaMalloc((void**)&count, sizeof(int) * num_queues));
+        CUDA_ERROR(cudaMalloc((void**)&front, sizeof(int) * num_queues));
+        CUDA_ERROR(cudaMalloc((void**)&back, sizeof(int) * num_queues));
+        CUDA_ERROR(cudaMalloc((void**)&total, sizeof(int)));
+        CUDA_ERROR(cudaMalloc((void**)&list,
+                              sizeof(uint32_t) * num_queues * queue_capacity));
+        // a block may push its patch back and a new patch it sliced
+        CUDA_ERROR(
+            cudaMalloc((void**)&deferred, sizeof(uint32_t) * 2 * capacity));
+        CUDA_ERROR(cudaMalloc((void**)&num_deferred, sizeof(int)));
+        CUDA_ERROR(cudaMemset(num_deferred, 0, sizeof(int)));
     }
 
     __host__ void print_list() const
     {
-        std::vector<uint32_t> h_list(capacity);
+        std::vector<uint32_t> h_list(num_queues * queue_capacity);
         CUDA_ERROR(cudaMemcpy(h_list.data(),
                               list,
                               h_list.size() * sizeof(uint32_t),
                               cudaMemcpyDeviceToHost));
         for (uint32_t i = 0; i < h_list.size(); ++i) {
-            printf("\n list[%u]= %u", i, h_list[i]);
+            printf("\n list[%u][%u]= %u",
+                   i / queue_capacity,
+                   i % queue_capacity,
+                   h_list[i]);
         }
     }
 
@@ -149,21 +268,40 @@ struct PatchScheduler
         GPU_FREE(count);
         GPU_FREE(front);
         GPU_FREE(back);
+        GPU_FREE(total);
         GPU_FREE(list);
+        GPU_FREE(deferred);
+        GPU_FREE(num_deferred);
     }
 
     /**
-     * @brief return the size of the queue (that is not the capacity)
+     * @brief return the size of the queue (that is not the capacity) i.e.,
+     * the sum of the sizes of all ring buffers. A pop() from an empty ring
+     * buffer (or a push() to a full one) decrements (increments) its count
+     * before restoring it and so the count of a ring buffer can be
+     * transiently negative. Such a count is taken as zero so it does not
+     * cancel out the patches still queued in other ring buffers
      */
     __host__ __device__ __inline__ int size(cudaStream_t stream = NULL) const
     {
 #ifdef __CUDA_ARCH__
-        return count[0];
+        int sum = 0;
+        for (uint32_t q = 0; q < num_queues; ++q) {
+            sum += max(atomic_read(count + q), 0);
+        }
+        return sum;
 #else
-        int h_count = 0;
-        CUDA_ERROR(cudaMemcpyAsync(
-            &h_count, count, sizeof(int), cudaMemcpyDeviceToHost, stream));
-        return h_count;
+        std::vector<int> h_count(num_queues, 0);
+        CUDA_ERROR(cudaMemcpyAsync(h_count.data(),
+                                   count,
+                                   num_queues * sizeof(int),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return std::accumulate(
+            h_count.begin(), h_count.end(), 0, [](int sum, int c) {
+                return sum + std::max(c, 0);
+            });
 #endif
     }
 
@@ -177,11 +315,110 @@ struct PatchScheduler
         return size(stream) == 0;
     }
 
+    uint32_t* list;
     int*      count;
     int*      front;
     int*      back;
+    // device scratch used to store the size of the queue on the device when
+    // there is more than one ring buffer
+    int*      total;
+    // patches pushed while defer is set, and their count
+    uint32_t* deferred;
+    int*      num_deferred;
     uint32_t  capacity;
-    uint32_t* list;
+    uint32_t  queue_capacity;
+    uint32_t  num_queues;
+    // if set, push() does not add the patch to the queue but to the deferred
+    // list that the host collects with take_deferred() so that pushed patches
+    // are not popped by blocks of the same launch (see
+    // RXMeshDynamic::set_deterministic)
+    bool defer;
+
+   private:
+    /**
+     * @brief the ring buffer of the SM this block runs on
+     */
+    __device__ __inline__ uint32_t local_queue() const
+    {
+#ifdef __CUDA_ARCH__
+        if (num_queues == 1) {
+            return 0;
+        }
+        uint32_t smid;
+        asm volatile("mov.u32 %0, %%smid;" : "=r"(smid));
+        return smid % num_queues;
+#endif
+    }
+
+    /**
+     * @brief sleep for an exponentially increasing duration to back off
+     * while waiting on a slot of the ring buffer
+     */
+    __device__ __inline__ void backoff(uint32_t& ns) const
+    {
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 700
+        __nanosleep(ns);
+        if (ns < 1024) {
+            ns *= 2;
+        }
+#endif
+    }
+
+    __device__ __inline__ bool push(const uint32_t pid, const uint32_t q)
+    {
+#ifdef __CUDA_ARCH__
+        if (::atomicAdd(count + q, 1) < static_cast<int>(queue_capacity)) {
+            int pos = ::atomicAdd(back + q, 1) % queue_capacity;
+
+            // the loop because another thread/block may have just decremented
+            // the count but has not yet finish reading from the list
+            uint32_t ns = 8;
+            while (::atomicCAS(list + q * queue_capacity + pos,
+                               INVALID32,
+                               pid) != INVALID32) {
+                backoff(ns);
+            }
+            return true;
+        } else {
+            // this ring buffer is full
+            ::atomicSub(count + q, 1);
+            return false;
+        }
+#endif
+    }
+
+    __device__ __inline__ uint32_t pop(const uint32_t q)
+    {
+#ifdef __CUDA_ARCH__
+        // cheap check before going atomic on the counter of another SM
+        if (num_queues > 1 && *((volatile int*)(count + q)) <= 0) {
+            return INVALID32;
+        }
+
+        int readable = ::atomicSub(count + q, 1);
+
+        uint32_t pid = INVALID32;
+
+        if (readable <= 0) {
+            ::atomicAdd(count + q, 1);
+        } else {
+
+            int pos = ::atomicAdd(front + q, 1) % queue_capacity;
+
+            // the loop because another thread/block may have just incremented
+            // the count but has not yet wrote to the list
+            uint32_t ns = 8;
+            while (true) {
+                pid = atomicExch(list + q * queue_capacity + pos, INVALID32);
+                if (pid != INVALID32) {
+                    break;
+                }
+                backoff(ns);
+            }
+        }
+        return pid;
+#endif
+    }
 };
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "rxmesh/kernels/shmem_mutex.cuh"
 #include "rxmesh/lp_pair.cuh"
+#include "rxmesh/util/macros.h"
 
 namespace rxmesh {
 
@@ -13,51 +14,62 @@ struct PatchStash
 {
     static constexpr uint8_t stash_size = (1 << LPPair::PatchStashNumBits);
 
-    __host__ PatchStash(bool on_device) : m_is_on_device(on_device)
+    /**
+     * @brief allocate the stash on the host or the device. If managed is true,
+     * the device stash is allocated as managed memory (see PatchResidency)
+     */
+    __host__ PatchStash(bool on_device, bool managed = false)
+        : m_is_on_device(on_device)
     {
         if (m_is_on_device) {
-            CUDA_ERROR(
-                cudaMalloc((void**)&m_stash, stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc(
+                (void**)&m_stash, stash_size * sizeof(uint32_t), managed));
             CUDA_ERROR(
                 cudaMemset(m_stash, INVALID8, stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_edge_weight,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_edge_weight,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(
                 m_edge_weight, INVALID32, stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_coarse_level_id_list,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_coarse_level_id_list,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(m_coarse_level_id_list,
                                   INVALID32,
                                   stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_coarse_level_pair_list,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_coarse_level_pair_list,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(m_coarse_level_pair_list,
                                   INVALID32,
                                   stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_coarse_level_num_v,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_coarse_level_num_v,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(m_coarse_level_num_v,
                                   INVALID32,
                                   stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_tmp_level_stash,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_tmp_level_stash,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(m_tmp_level_stash, 
                                   INVALID32, 
                                   stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_tmp_level_edge_weight,
-                                  stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_tmp_level_edge_weight,
+                                     stash_size * sizeof(uint32_t),
+                                     managed));
             CUDA_ERROR(cudaMemset(m_tmp_level_edge_weight,
                                   INVALID32,
                                   stash_size * sizeof(uint32_t)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_v_ordering_bound,
-                                  2 * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc(
+                (void**)&m_v_ordering_bound, 2 * sizeof(uint32_t), managed));
             CUDA_ERROR(cudaMemset(m_v_ordering_bound,
                                     INVALID32,
                                     2 * sizeof(uint32_t)));
@@ -1,11 +1,13 @@
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 #include <functional>
 #include <iomanip>
-#include <queue>
+#include <numeric>
 #include <unordered_map>
 #include "cub/device/device_radix_sort.cuh"
 #include "cub/device/device_scan.cuh"
+#include "cub/device/device_segmented_radix_sort.cuh"
 #include "cuda_profiler_api.h"
 #include "rxmesh/kernels/util.cuh"
 #include "rxmesh/patcher/patcher.h"
@@ -30,36 +32,43 @@ Patcher::Patcher(std::string filename)
     print_statistics();
 }
 
+Patcher::Patcher(std::istream& is)
+{
+    cereal::PortableBinaryInputArchive archive(is);
+    archive(*this);
+}
+
 Patcher::Patcher(uint32_t                                        patch_size,
                  const std::vector<uint32_t>&                    ff_offset,
                  const std::vector<uint32_t>&                    ff_values,
-                 const std::vector<std::vector<uint32_t>>&       fv,
+                 const std::vector<uint32_t>&                    fv,
                  const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                           uint32_t,
-                                          detail::edge_key_hash> edges_map,
+                                          detail::edge_key_hash>& edges_map,
                  const uint32_t                                  num_vertices,
-                 const uint32_t                                  num_edges)
+                 const uint32_t                                  num_edges,
+                 const uint32_t*                                 d_ff_offset_in,
+                 const uint32_t*                                 d_ff_values_in,
+                 const bool                                      deterministic,
+                 const bool                                      reorder,
+                 const bool                                      balance)
     : m_patch_size(patch_size),
       m_num_patches(0),
       m_num_vertices(num_vertices),
       m_num_edges(num_edges),
-      m_num_faces(fv.size()),
+      m_num_faces(fv.size() / 3),
       m_num_seeds(0),
       m_max_num_patches(0),
       m_num_components(0),
       m_num_lloyd_run(0),
-      m_patching_time_ms(0.0)
+      m_patching_time_ms(0.0),
+      m_deterministic(deterministic)
 
 {
 
     m_num_patches =
         m_num_faces / m_patch_size + ((m_num_faces % m_patch_size) ? 1 : 0);
 
-    m_max_num_patches = 5 * m_num_patches;
-
-    m_num_seeds = m_num_patches;
-    std::vector<uint32_t> seeds;
-
     uint32_t* d_face_patch            = nullptr;
     uint32_t* d_queue                 = nullptr;
     uint32_t* d_queue_ptr             = nullptr;
@@ -76,7 +85,32 @@ Patcher::Patcher(uint32_t                                        patch_size,
     uint32_t* d_patches_size          = nullptr;
     uint32_t* d_patches_val           = nullptr;
 
-    allocate_memory(seeds);
+    // ff is only allocated (and freed) here if it is not already on the device
+    const bool own_ff =
+        (d_ff_offset_in == nullptr || d_ff_values_in == nullptr);
+    if (!own_ff) {
+        d_ff_offset = const_cast<uint32_t*>(d_ff_offset_in);
+        d_ff_values = const_cast<uint32_t*>(d_ff_values_in);
+    }
+
+    // the components are identified first since every component needs at
+    // least one patch
+    uint32_t*             d_face_component = nullptr;
+    std::vector<uint32_t> h_component_size;
+    if (m_num_patches > 1) {
+        copy_ff_to_device(ff_offset, ff_values, d_ff_values, d_ff_offset);
+        CUDA_ERROR(cudaMalloc((void**)&d_face_component,
+                              m_num_faces * sizeof(uint32_t)));
+        get_multi_components(
+            d_ff_offset, d_ff_values, d_face_component, h_component_size);
+        m_num_patches = std::max(m_num_patches, m_num_components);
+    }
+
+    m_max_num_patches = 5 * m_num_patches;
+
+    m_num_seeds = m_num_patches;
+
+    allocate_memory();
 
     // degenerate cases
     if (m_num_patches <= 1) {
@@ -88,8 +122,7 @@ Patcher::Patcher(uint32_t                                        patch_size,
             m_face_patch[i]  = 0;
             m_patches_val[i] = i;
         }
-        allocate_device_memory(seeds,
-                               ff_offset,
+        allocate_device_memory(ff_offset,
                                ff_values,
                                d_face_patch,
                                d_queue,
@@ -108,10 +141,7 @@ Patcher::Patcher(uint32_t                                        patch_size,
                                d_patches_val);
         assign_patch(fv, edges_map);
     } else {
-
-        initialize_random_seeds(seeds, ff_offset, ff_values);
-        allocate_device_memory(seeds,
-                               ff_offset,
+        allocate_device_memory(ff_offset,
                                ff_values,
                                d_face_patch,
                                d_queue,
@@ -128,6 +158,9 @@ Patcher::Patcher(uint32_t                                        patch_size,
                                d_patches_offset,
                                d_patches_size,
                                d_patches_val);
+        initialize_random_seeds(d_face_component, h_component_size, d_seeds);
+        GPU_FREE(d_face_component);
+
         run_lloyd(d_face_patch,
                   d_queue,
                   d_queue_ptr,
@@ -144,8 +177,13 @@ Patcher::Patcher(uint32_t                                        patch_size,
                   d_patches_size,
                   d_patches_val);
 
+        if (balance) {
+            balance_patches(fv, ff_offset, ff_values);
+        }
+        if (reorder) {
+            reorder_patches(ff_offset, ff_values);
+        }
         postprocess(fv, ff_offset, ff_values);
-        //bfs(ff_offset, ff_values);
         assign_patch(fv, edges_map);
     }
 
@@ -155,8 +193,10 @@ Patcher::Patcher(uint32_t                                        patch_size,
     GPU_FREE(d_face_patch);
     GPU_FREE(d_queue);
     GPU_FREE(d_queue_ptr);
-    GPU_FREE(d_ff_values);
-    GPU_FREE(d_ff_offset);
+    if (own_ff) {
+        GPU_FREE(d_ff_values);
+        GPU_FREE(d_ff_offset);
+    }
     GPU_FREE(d_cub_temp_storage_scan);
     GPU_FREE(d_cub_temp_storage_max);
     GPU_FREE(d_seeds);
@@ -171,10 +211,8 @@ Patcher::~Patcher()
 {
 }
 
-void Patcher::allocate_memory(std::vector<uint32_t>& seeds)
+void Patcher::allocate_memory()
 {
-    seeds.reserve(m_num_seeds);
-
     // patches assigned to each face, vertex, and edge
     m_face_patch.resize(m_num_faces);
     std::fill(m_face_patch.begin(), m_face_patch.end(), INVALID32);
@@ -198,8 +236,30 @@ void Patcher::allocate_memory(std::vector<uint32_t>& seeds)
     m_ribbon_ext_val.resize(m_num_faces);
 }
 
-void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
-                                     const std::vector<uint32_t>& ff_offset,
+void Patcher::copy_ff_to_device(const std::vector<uint32_t>& ff_offset,
+                                const std::vector<uint32_t>& ff_values,
+                                uint32_t*&                   d_ff_values,
+                                uint32_t*&                   d_ff_offset)
+{
+    if (d_ff_values == nullptr || d_ff_offset == nullptr) {
+        CUDA_ERROR(cudaMalloc((void**)&d_ff_values,
+                              ff_values.size() * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&d_ff_offset,
+                              ff_offset.size() * sizeof(uint32_t)));
+
+        CUDA_ERROR(cudaMemcpy((void**)d_ff_values,
+                              ff_values.data(),
+                              ff_values.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        CUDA_ERROR(cudaMemcpy((void**)d_ff_offset,
+                              ff_offset.data(),
+                              ff_offset.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+    }
+}
+
+void Patcher::allocate_device_memory(const std::vector<uint32_t>& ff_offset,
                                      const std::vector<uint32_t>& ff_values,
                                      uint32_t*&                   d_face_patch,
                                      uint32_t*&                   d_queue,
@@ -217,34 +277,18 @@ void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
                                      uint32_t*& d_patches_size,
                                      uint32_t*& d_patches_val)
 {
-    // ff
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_ff_values, ff_values.size() * sizeof(uint32_t)));
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_ff_offset, ff_offset.size() * sizeof(uint32_t)));
+    // ff (unless it is already on the device or copied for the components
+    // labeling)
+    copy_ff_to_device(ff_offset, ff_values, d_ff_values, d_ff_offset);
 
-    CUDA_ERROR(cudaMemcpy((void**)d_ff_values,
-                          ff_values.data(),
-                          ff_values.size() * sizeof(uint32_t),
-                          cudaMemcpyHostToDevice));
-
-    CUDA_ERROR(cudaMemcpy((void**)d_ff_offset,
-                          ff_offset.data(),
-                          ff_offset.size() * sizeof(uint32_t),
-                          cudaMemcpyHostToDevice));
     // face/vertex/edge patch
     CUDA_ERROR(
         cudaMalloc((void**)&d_face_patch, m_num_faces * sizeof(uint32_t)));
 
-    // seeds
+    // seeds (generated by initialize_random_seeds())
     CUDA_ERROR(
         cudaMalloc((void**)&d_seeds, m_max_num_patches * sizeof(uint32_t)));
 
-    CUDA_ERROR(cudaMemcpy((void**)d_seeds,
-                          seeds.data(),
-                          m_num_patches * sizeof(uint32_t),
-                          cudaMemcpyHostToDevice));
-
     // utility
     // 0 -> queue start
     // 1-> queue end
@@ -322,218 +366,645 @@ void Patcher::print_statistics()
                  get_ribbon_overhead());
 }
 
-void Patcher::initialize_random_seeds(std::vector<uint32_t>&       seeds,
-                                      const std::vector<uint32_t>& ff_offset,
-                                      const std::vector<uint32_t>& ff_values)
+void Patcher::get_multi_components(const uint32_t*        d_ff_offset,
+                                   const uint32_t*        d_ff_values,
+                                   uint32_t*              d_face_component,
+                                   std::vector<uint32_t>& h_component_size)
 {
+    const uint32_t threads_f = 256;
+    const uint32_t blocks_f  = DIVIDE_UP(m_num_faces, threads_f);
+
+    uint32_t* d_is_root      = nullptr;
+    uint32_t* d_root_prefix  = nullptr;
+    uint32_t* d_changed      = nullptr;
+    uint32_t* d_component_sz = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_is_root, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_root_prefix, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_changed, sizeof(uint32_t)));
+
+    // 1) label propagation where every component ends up with the label of
+    // one of its faces (the root)
+    component_init<<<blocks_f, threads_f>>>(m_num_faces, d_face_component);
+    uint32_t h_changed = 1;
+    while (h_changed != 0) {
+        CUDA_ERROR(cudaMemset(d_changed, 0, sizeof(uint32_t)));
+        component_hook<<<blocks_f, threads_f>>>(
+            m_num_faces, d_face_component, d_ff_offset, d_ff_values, d_changed);
+        component_jump<<<blocks_f, threads_f>>>(m_num_faces, d_face_component);
+        CUDA_ERROR(cudaMemcpy(
+            &h_changed, d_changed, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    }
 
-    // 1) Identify the components i.e., for each component list the faces
-    // that belong to that it
-    // 2) Generate number of (random) seeds in each component
-    // proportional to the number of faces it contain
+    // 2) compact the labels to [0, num_components) and count the faces in
+    // every component
+    component_roots<<<blocks_f, threads_f>>>(
+        m_num_faces, d_face_component, d_is_root);
+
+    void*  d_cub_temp_storage = nullptr;
+    size_t cub_bytes          = 0;
+    ::cub::DeviceScan::ExclusiveSum(
+        d_cub_temp_storage, cub_bytes, d_is_root, d_root_prefix, m_num_faces);
+    CUDA_ERROR(cudaMalloc((void**)&d_cub_temp_storage, cub_bytes));
+    ::cub::DeviceScan::ExclusiveSum(
+        d_cub_temp_storage, cub_bytes, d_is_root, d_root_prefix, m_num_faces);
+
+    uint32_t h_last_prefix(0), h_last_is_root(0);
+    CUDA_ERROR(cudaMemcpy(&h_last_prefix,
+                          d_root_prefix + m_num_faces - 1,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(&h_last_is_root,
+                          d_is_root + m_num_faces - 1,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    m_num_components = h_last_prefix + h_last_is_root;
+
+    CUDA_ERROR(cudaMalloc((void**)&d_component_sz,
+                          m_num_components * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMemset(d_component_sz, 0, m_num_components * sizeof(uint32_t)));
+    component_compact<<<blocks_f, threads_f>>>(
+        m_num_faces, d_face_component, d_root_prefix, d_component_sz);
+
+    h_component_size.resize(m_num_components);
+    CUDA_ERROR(cudaMemcpy(h_component_size.data(),
+                          d_component_sz,
+                          m_num_components * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
 
-    std::vector<std::vector<uint32_t>> components;
-    get_multi_components(components, ff_offset, ff_values);
+    GPU_FREE(d_is_root);
+    GPU_FREE(d_root_prefix);
+    GPU_FREE(d_changed);
+    GPU_FREE(d_component_sz);
+    GPU_FREE(d_cub_temp_storage);
+}
 
-    m_num_components = components.size();
+void Patcher::initialize_random_seeds(
+    const uint32_t*              d_face_component,
+    const std::vector<uint32_t>& h_component_size,
+    uint32_t*                    d_seeds)
+{
+    // 1) Decide how many seeds every component takes. Every component takes
+    // at least one seed. If we have more seeds to give than the number of
+    // components, then we calculate the number of extra/remaining seeds that
+    // will need be added. Every component then will have a weight proportional
+    // to its size that tells how many of these remaining seeds it can take.
+    // This only depends on the components size so it is done on the host
+    std::vector<uint32_t> h_num_seeds(m_num_components, 1);
     if (m_num_components == 1) {
-        initialize_random_seeds_single_component(seeds);
-    } else {
-        if (m_num_seeds <= m_num_components) {
-            // we have too many components so we increase the number of
-            // seeds. this case should not be encountered frequently
-            // since we generate only one seed per component
-            m_num_seeds = m_num_components;
-            for (auto& comp : components) {
-                generate_random_seed_from_component(seeds, comp, 1);
-            }
-        } else {
-            // if we have more seeds to give than the number of components,
-            // then first secure that we have at least one seed per
-            // component then we calculate the number of extra/remaining
-            // seeds that will need be added. Every component then will have
-            // a weight proportional to its size that tells how many of
-            // these remaining seeds it can take
-
-            uint32_t num_remaining_seeds      = m_num_seeds - m_num_components;
-            uint32_t num_extra_seeds_inserted = 0;
-
-            // sort the order of the component to be processed by their size
-            std::vector<size_t> component_order(components.size());
-            fill_with_sequential_numbers(component_order.data(),
-                                         component_order.size());
-            std::sort(component_order.begin(),
-                      component_order.end(),
-                      [&components](const size_t& a, const size_t& b) {
-                          return components[a].size() > components[b].size();
-                      });
-
-            // process components in descending order with respect to their
-            // size
-            for (size_t c = 0; c < component_order.size(); ++c) {
-
-                std::vector<uint32_t>& comp = components[component_order[c]];
-
-                uint32_t size = comp.size();
-                // this weight tells how many extra faces this component
-                // have from num_remaining_seeds
-                float weight =
-                    static_cast<float>(size) / static_cast<float>(m_num_faces);
-                uint32_t component_num_seeds = static_cast<uint32_t>(std::ceil(
-                    weight * static_cast<float>(num_remaining_seeds)));
-
-
-                num_extra_seeds_inserted += component_num_seeds;
-                if (num_extra_seeds_inserted > num_remaining_seeds) {
-                    if (num_extra_seeds_inserted - num_remaining_seeds >
-                        component_num_seeds) {
-                        component_num_seeds = 0;
-                    } else {
-                        component_num_seeds -=
-                            (num_extra_seeds_inserted - num_remaining_seeds);
-                    }
+        h_num_seeds[0] = m_num_seeds;
+    } else if (m_num_seeds > m_num_components) {
+        uint32_t num_remaining_seeds      = m_num_seeds - m_num_components;
+        uint32_t num_extra_seeds_inserted = 0;
+
+        // sort the order of the component to be processed by their size
+        std::vector<size_t> component_order(m_num_components);
+        fill_with_sequential_numbers(component_order.data(),
+                                     component_order.size());
+        std::stable_sort(component_order.begin(),
+                         component_order.end(),
+                         [&h_component_size](const size_t& a, const size_t& b) {
+                             return h_component_size[a] > h_component_size[b];
+                         });
+
+        // process components in descending order with respect to their size
+        for (size_t c = 0; c < component_order.size(); ++c) {
+
+            uint32_t size = h_component_size[component_order[c]];
+            // this weight tells how many extra faces this component
+            // have from num_remaining_seeds
+            float weight =
+                static_cast<float>(size) / static_cast<float>(m_num_faces);
+            uint32_t component_num_seeds = static_cast<uint32_t>(
+                std::ceil(weight * static_cast<float>(num_remaining_seeds)));
+
+            num_extra_seeds_inserted += component_num_seeds;
+            if (num_extra_seeds_inserted > num_remaining_seeds) {
+                if (num_extra_seeds_inserted - num_remaining_seeds >
+                    component_num_seeds) {
+                    component_num_seeds = 0;
+                } else {
+                    component_num_seeds -=
+                        (num_extra_seeds_inserted - num_remaining_seeds);
                 }
+            }
+
+            h_num_seeds[component_order[c]] += component_num_seeds;
+        }
+    }
+
+    std::vector<uint32_t> h_seed_offset(m_num_components + 1, 0);
+    std::vector<uint32_t> h_component_offset(m_num_components, 0);
+    for (uint32_t c = 0; c < m_num_components; ++c) {
+        h_seed_offset[c + 1] = h_seed_offset[c] + h_num_seeds[c];
+        if (c > 0) {
+            h_component_offset[c] =
+                h_component_offset[c - 1] + h_component_size[c - 1];
+        }
+    }
+    assert(h_seed_offset.back() == m_num_seeds);
+
+    // 2) Shuffle the faces within their component by sorting the faces on
+    // (component, hash of the face id). Every component then takes the first
+    // faces in its segment as its seeds
+    const uint32_t rng_seed =
+        m_deterministic ? 0x9e3779b9u : uint32_t(std::random_device()());
+
+    const uint32_t threads_f = 256;
+    const uint32_t blocks_f  = DIVIDE_UP(m_num_faces, threads_f);
+
+    uint64_t* d_keys_in          = nullptr;
+    uint64_t* d_keys_out         = nullptr;
+    uint32_t* d_faces_in         = nullptr;
+    uint32_t* d_faces_out        = nullptr;
+    uint32_t* d_component_offset = nullptr;
+    uint32_t* d_seed_offset      = nullptr;
+    void*     d_cub_temp_storage = nullptr;
+    size_t    cub_bytes          = 0;
+    CUDA_ERROR(cudaMalloc((void**)&d_keys_in, m_num_faces * sizeof(uint64_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_keys_out, m_num_faces * sizeof(uint64_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_faces_in, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_faces_out, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_component_offset,
+                          m_num_components * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_seed_offset,
+                          (m_num_components + 1) * sizeof(uint32_t)));
+
+    seed_sort_keys<<<blocks_f, threads_f>>>(
+        m_num_faces, d_face_component, rng_seed, d_keys_in, d_faces_in);
+
+    ::cub::DeviceRadixSort::SortPairs(d_cub_temp_storage,
+                                      cub_bytes,
+                                      d_keys_in,
+                                      d_keys_out,
+                                      d_faces_in,
+                                      d_faces_out,
+                                      m_num_faces);
+    CUDA_ERROR(cudaMalloc((void**)&d_cub_temp_storage, cub_bytes));
+    ::cub::DeviceRadixSort::SortPairs(d_cub_temp_storage,
+                                      cub_bytes,
+                                      d_keys_in,
+                                      d_keys_out,
+                                      d_faces_in,
+                                      d_faces_out,
+                                      m_num_faces);
+
+    CUDA_ERROR(cudaMemcpy(d_component_offset,
+                          h_component_offset.data(),
+                          m_num_components * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_seed_offset,
+                          h_seed_offset.data(),
+                          (m_num_components + 1) * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    const uint32_t threads_c = 256;
+    const uint32_t blocks_c  = DIVIDE_UP(m_num_components, threads_c);
+    gather_seeds<<<blocks_c, threads_c>>>(m_num_components,
+                                          d_component_offset,
+                                          d_seed_offset,
+                                          d_faces_out,
+                                          d_seeds);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    GPU_FREE(d_keys_in);
+    GPU_FREE(d_keys_out);
+    GPU_FREE(d_faces_in);
+    GPU_FREE(d_faces_out);
+    GPU_FREE(d_component_offset);
+    GPU_FREE(d_seed_offset);
+    GPU_FREE(d_cub_temp_storage);
+}
 
-                component_num_seeds += 1;
-                generate_random_seed_from_component(
-                    seeds, comp, component_num_seeds);
+void Patcher::build_patch_graph(
+    const std::vector<uint32_t>&        ff_offset,
+    const std::vector<uint32_t>&        ff_values,
+    std::vector<std::vector<uint32_t>>& patch_graph) const
+{
+    patch_graph.clear();
+    patch_graph.resize(m_num_patches);
+    for (uint32_t face = 0; face < m_num_faces; ++face) {
+        const uint32_t p     = m_face_patch[face];
+        const uint32_t start = (face == 0) ? 0 : ff_offset[face - 1];
+        const uint32_t end   = ff_offset[face];
+        for (uint32_t n = start; n < end; ++n) {
+            const uint32_t q = m_face_patch[ff_values[n]];
+            if (q != p) {
+                patch_graph[p].push_back(q);
             }
         }
     }
+    for (auto& adj : patch_graph) {
+        std::sort(adj.begin(), adj.end());
+        inplace_remove_duplicates_sorted(adj);
+    }
+}
+
+void Patcher::relabel_patches(const std::vector<uint32_t>& order)
+{
+    // order[new patch id] = old patch id
+    std::vector<uint32_t> new_id(m_num_patches, INVALID32);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        new_id[order[i]] = i;
+    }
 
-    assert(m_num_patches == seeds.size());
+    std::vector<uint32_t> new_offset(order.size());
+    std::vector<uint32_t> new_val(m_num_faces);
+    uint32_t              pos = 0;
+    for (uint32_t p = 0; p < order.size(); ++p) {
+        const uint32_t old_p = order[p];
+        const uint32_t start = (old_p == 0) ? 0 : m_patches_offset[old_p - 1];
+        const uint32_t end   = m_patches_offset[old_p];
+        for (uint32_t f = start; f < end; ++f) {
+            new_val[pos++] = m_patches_val[f];
+        }
+        new_offset[p] = pos;
+    }
+    assert(pos == m_num_faces);
+
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        m_face_patch[f] = new_id[m_face_patch[f]];
+    }
+    m_patches_offset = std::move(new_offset);
+    std::copy(new_val.begin(), new_val.end(), m_patches_val.begin());
 }
 
-void Patcher::initialize_random_seeds_single_component(
-    std::vector<uint32_t>& seeds)
+void Patcher::build_vertex_faces(const std::vector<uint32_t>& fv,
+                                 std::vector<uint32_t>&       vf_offset,
+                                 std::vector<uint32_t>&       vf_values) const
 {
-    // if not multi-component, just generate random number
-    std::vector<uint32_t> rand_num(m_num_faces);
-    fill_with_sequential_numbers(rand_num.data(), rand_num.size());
-    random_shuffle(rand_num.data(), rand_num.size());
-    seeds.resize(m_num_seeds);
-    std::memcpy(seeds.data(), rand_num.data(), m_num_seeds * sizeof(uint32_t));
+    // vf_offset is an exclusive scan with m_num_vertices + 1 entries
+    vf_offset.clear();
+    vf_offset.resize(m_num_vertices + 1, 0);
+    for (uint32_t i = 0; i < fv.size(); ++i) {
+        vf_offset[fv[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < m_num_vertices; ++v) {
+        vf_offset[v + 1] += vf_offset[v];
+    }
+    vf_values.resize(fv.size());
+    std::vector<uint32_t> pos(vf_offset.begin(), vf_offset.end() - 1);
+    for (uint32_t i = 0; i < fv.size(); ++i) {
+        vf_values[pos[fv[i]]++] = i / 3;
+    }
 }
 
-void Patcher::generate_random_seed_from_component(
-    std::vector<uint32_t>& seeds,
-    std::vector<uint32_t>& component,
-    const uint32_t         num_seeds)
+uint32_t Patcher::estimate_patch_smem(const std::vector<uint32_t>& fv,
+                                      const std::vector<uint32_t>& vf_offset,
+                                      const std::vector<uint32_t>& vf_values,
+                                      const std::vector<uint32_t>& faces) const
 {
-    // generate seeds from faces in component.
-    // num_seeds is the number of seeds that will be generated
-    uint32_t num_seeds_before = seeds.size();
-    if (num_seeds < 1) {
-        RXMESH_ERROR(
-            "Patcher::generate_random_seed_in_component() num_seeds should be "
-            "larger than 1");
-    }
-
-    random_shuffle(component.data(), component.size());
-    seeds.resize(num_seeds_before + num_seeds);
-    std::memcpy(seeds.data() + num_seeds_before,
-                component.data(),
-                num_seeds * sizeof(uint32_t));
+    // the faces of the patch along with its ribbon, i.e., all faces incident
+    // to the vertices of the patch faces
+    std::vector<uint32_t> all_faces;
+    all_faces.reserve(4 * faces.size());
+    for (const uint32_t f : faces) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            const uint32_t v = fv[3 * f + i];
+            all_faces.insert(all_faces.end(),
+                             vf_values.begin() + vf_offset[v],
+                             vf_values.begin() + vf_offset[v + 1]);
+        }
+    }
+    std::sort(all_faces.begin(), all_faces.end());
+    inplace_remove_duplicates_sorted(all_faces);
+
+    std::vector<uint64_t> edges;
+    edges.reserve(3 * all_faces.size());
+    for (const uint32_t f : all_faces) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            const uint64_t v0 = fv[3 * f + i];
+            const uint64_t v1 = fv[3 * f + (i + 1) % 3];
+            edges.push_back(std::min(v0, v1) << 32 | std::max(v0, v1));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    inplace_remove_duplicates_sorted(edges);
+
+    // EV and FE are what the queries load into shared memory and they
+    // dominate RXMeshStatic::calc_shared_memory()
+    return static_cast<uint32_t>(
+        (2 * edges.size() + 3 * all_faces.size()) * sizeof(uint16_t));
 }
 
+uint32_t Patcher::get_max_patch_smem_estimate(
+    const std::vector<uint32_t>& fv) const
+{
+    std::vector<uint32_t> vf_offset, vf_values;
+    build_vertex_faces(fv, vf_offset, vf_values);
 
-void Patcher::get_multi_components(
-    std::vector<std::vector<uint32_t>>& components,
-    const std::vector<uint32_t>&        ff_offset,
-    const std::vector<uint32_t>&        ff_values)
+    uint32_t              ret = 0;
+    std::vector<uint32_t> faces;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        const uint32_t start = (p == 0) ? 0 : m_patches_offset[p - 1];
+        faces.assign(m_patches_val.begin() + start,
+                     m_patches_val.begin() + m_patches_offset[p]);
+        ret =
+            std::max(ret, estimate_patch_smem(fv, vf_offset, vf_values, faces));
+    }
+    return ret;
+}
+
+void Patcher::balance_patches(const std::vector<uint32_t>& fv,
+                              const std::vector<uint32_t>& ff_offset,
+                              const std::vector<uint32_t>& ff_values)
 {
-    std::vector<bool> visited(m_num_faces, false);
-    for (uint32_t f = 0; f < m_num_faces; ++f) {
-        if (!visited[f]) {
-            std::vector<uint32_t> current_component;
-            // just a guess
-            current_component.reserve(
-                static_cast<uint32_t>(static_cast<double>(m_num_faces) / 10.0));
-
-            std::queue<uint32_t> face_queue;
-            face_queue.push(f);
-            while (!face_queue.empty()) {
-                uint32_t face = face_queue.front();
-                face_queue.pop();
-                uint32_t start = (face == 0) ? 0 : ff_offset[face - 1];
-                uint32_t end   = ff_offset[face];
-                for (uint32_t f = start; f < end; ++f) {
-                    uint32_t n_face = ff_values[f];
-                    if (!visited[n_face]) {
-                        current_component.push_back(n_face);
-                        face_queue.push(n_face);
-                        visited[n_face] = true;
+    // The shared memory of every launch is sized for the largest patch
+    // including its ribbon. Lloyd bounds the number of owned faces per patch
+    // but not the ribbon so the patch cost is estimated with
+    // estimate_patch_smem(). The budget is balance_slack times the average
+    // cost (but never more than the current max). Patches above the budget
+    // are bisected and patches below half the budget are merged into the
+    // neighbor patch that gives the cheapest merged patch within the budget
+    std::vector<uint32_t> vf_offset, vf_values;
+    build_vertex_faces(fv, vf_offset, vf_values);
+
+    std::vector<std::vector<uint32_t>> members(m_num_patches);
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        const uint32_t start = (p == 0) ? 0 : m_patches_offset[p - 1];
+        members[p].assign(m_patches_val.begin() + start,
+                          m_patches_val.begin() + m_patches_offset[p]);
+    }
+
+    std::vector<uint32_t> cost(m_num_patches);
+    uint32_t              max_size = 0;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        cost[p]  = estimate_patch_smem(fv, vf_offset, vf_values, members[p]);
+        max_size = std::max(max_size, uint32_t(members[p].size()));
+    }
+
+    const uint32_t old_max_cost = *std::max_element(cost.begin(), cost.end());
+    const double   mean_cost =
+        std::accumulate(cost.begin(), cost.end(), 0.0) / double(m_num_patches);
+    const uint32_t budget       = std::min(
+        old_max_cost,
+        static_cast<uint32_t>(std::ceil(balance_slack * mean_cost)));
+
+    // faces visited in the bisection BFS are marked with the patch id
+    std::vector<uint32_t> mark(m_num_faces, INVALID32);
+    std::vector<uint32_t> queue;
+    queue.reserve(max_size);
+
+    // BFS over the faces of patch p (restricted to the patch) starting from
+    // seed. Faces not reached from the seed (if the patch is disconnected)
+    // are appended from where the previous BFS ended
+    auto bfs = [&](const uint32_t p, const uint32_t seed) {
+        for (const uint32_t f : members[p]) {
+            mark[f] = INVALID32;
+        }
+        queue.clear();
+        uint32_t next_seed = 0;
+        uint32_t s         = seed;
+        while (queue.size() < members[p].size()) {
+            mark[s] = p;
+            queue.push_back(s);
+            for (size_t head = queue.size() - 1; head < queue.size(); ++head) {
+                const uint32_t f     = queue[head];
+                const uint32_t start = (f == 0) ? 0 : ff_offset[f - 1];
+                for (uint32_t n = start; n < ff_offset[f]; ++n) {
+                    const uint32_t g = ff_values[n];
+                    if (m_face_patch[g] == p && mark[g] != p) {
+                        mark[g] = p;
+                        queue.push_back(g);
                     }
                 }
             }
+            while (next_seed < members[p].size() &&
+                   mark[members[p][next_seed]] == p) {
+                next_seed++;
+            }
+            if (next_seed < members[p].size()) {
+                s = members[p][next_seed];
+            }
+        }
+    };
 
-            components.push_back(current_component);
+    // split: the second BFS starts from the last face reached by the first
+    // one (a face far from the patch center) and its first half becomes a
+    // new patch
+    uint32_t              num_split = 0;
+    std::vector<uint32_t> to_split;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        if (cost[p] > budget) {
+            to_split.push_back(p);
         }
     }
-}
+    while (!to_split.empty()) {
+        const uint32_t p = to_split.back();
+        to_split.pop_back();
+        if (members[p].size() < 2) {
+            continue;
+        }
+        bfs(p, members[p][0]);
+        bfs(p, queue.back());
+
+        const uint32_t q    = members.size();
+        const size_t   half = queue.size() / 2;
+        members.emplace_back(queue.begin(), queue.begin() + half);
+        members[p].assign(queue.begin() + half, queue.end());
+        for (const uint32_t f : members[q]) {
+            m_face_patch[f] = q;
+        }
+        cost[p] = estimate_patch_smem(fv, vf_offset, vf_values, members[p]);
+        cost.push_back(
+            estimate_patch_smem(fv, vf_offset, vf_values, members[q]));
+        num_split++;
 
-void Patcher::bfs(const std::vector<uint32_t>& ff_offset,
-                  const std::vector<uint32_t>& ff_values)
-{
-    // BFS renumbering
-    std::vector<uint32_t> bfs_patch_id(m_num_patches);
+        if (cost[p] > budget) {
+            to_split.push_back(p);
+        }
+        if (cost[q] > budget) {
+            to_split.push_back(q);
+        }
+    }
 
-    std::vector<std::vector<uint32_t>> patch_neighbour;
-    for (uint32_t p = 0; p < m_num_patches; ++p) {
-        std::vector<uint32_t> np;
-        for (uint32_t f = (p == 0) ? 0 : m_patches_offset[p - 1];
-             f < m_patches_offset[p];
-             ++f) {
-            uint32_t face = m_patches_val[f];
-            for (uint32_t n = (face == 0) ? 0 : ff_offset[face - 1];
-                 n < ff_offset[face];
-                 ++n) {
-                uint32_t n_face  = ff_values[n];
-                uint32_t n_patch = m_face_patch[n_face];
-                if (n_patch != p) {
-                    if (find_index(n_patch, np) ==
-                        std::numeric_limits<uint32_t>::max()) {
-                        np.push_back(n_patch);
-                    }
+    // merge
+    const uint32_t        num_patches = members.size();
+    std::vector<uint32_t> by_cost(num_patches);
+    fill_with_sequential_numbers(by_cost.data(), by_cost.size());
+    std::stable_sort(by_cost.begin(),
+                     by_cost.end(),
+                     [&cost](const uint32_t a, const uint32_t b) {
+                         return cost[a] < cost[b];
+                     });
+
+    uint32_t              num_merged = 0;
+    std::vector<uint32_t> neighbors, merged;
+    for (const uint32_t p : by_cost) {
+        if (members[p].empty() || cost[p] >= budget / 2) {
+            continue;
+        }
+        neighbors.clear();
+        for (const uint32_t f : members[p]) {
+            const uint32_t start = (f == 0) ? 0 : ff_offset[f - 1];
+            for (uint32_t n = start; n < ff_offset[f]; ++n) {
+                const uint32_t q = m_face_patch[ff_values[n]];
+                if (q != p) {
+                    neighbors.push_back(q);
                 }
             }
         }
-        patch_neighbour.push_back(np);
-    }
-    std::vector<uint32_t> qu(1, 0);
-    qu.reserve(m_num_patches);
-    for (uint32_t p = 0; p < qu.size(); p++) {
-        uint32_t patch      = qu[p];
-        bfs_patch_id[patch] = p;
-        for (uint32_t i = 0; i < patch_neighbour[patch].size(); i++) {
-            uint32_t pn = patch_neighbour[patch][i];
-            if (find_index(pn, qu) == std::numeric_limits<uint32_t>::max()) {
-                qu.push_back(pn);
+        std::sort(neighbors.begin(), neighbors.end());
+        inplace_remove_duplicates_sorted(neighbors);
+
+        uint32_t best = INVALID32, best_cost = 0;
+        for (const uint32_t q : neighbors) {
+            if (members[p].size() + members[q].size() > max_size) {
+                continue;
             }
+            merged = members[q];
+            merged.insert(merged.end(), members[p].begin(), members[p].end());
+            const uint32_t c =
+                estimate_patch_smem(fv, vf_offset, vf_values, merged);
+            if (c <= budget && (best == INVALID32 || c < best_cost)) {
+                best      = q;
+                best_cost = c;
+            }
+        }
+        if (best != INVALID32) {
+            for (const uint32_t f : members[p]) {
+                m_face_patch[f] = best;
+            }
+            members[best].insert(
+                members[best].end(), members[p].begin(), members[p].end());
+            members[p].clear();
+            cost[best] = best_cost;
+            cost[p]    = 0;
+            num_merged++;
+        }
+    }
+
+    if (num_split == 0 && num_merged == 0) {
+        return;
+    }
+
+    // compact the patches (in their current order) and rebuild the
+    // compressed patches
+    std::vector<uint32_t> new_id(num_patches, INVALID32);
+    std::vector<uint32_t> new_offset;
+    uint32_t              pos     = 0;
+    uint32_t              new_max = 0;
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        if (members[p].empty()) {
+            continue;
         }
+        new_id[p] = new_offset.size();
+        std::copy(
+            members[p].begin(), members[p].end(), m_patches_val.begin() + pos);
+        pos += members[p].size();
+        new_offset.push_back(pos);
+        new_max = std::max(new_max, cost[p]);
     }
-    std::fill(m_patches_offset.begin(), m_patches_offset.end(), 0);
+    assert(pos == m_num_faces);
+
     for (uint32_t f = 0; f < m_num_faces; ++f) {
-        m_face_patch[f] = bfs_patch_id[m_face_patch[f]];
-        m_patches_offset[m_face_patch[f]]++;
+        m_face_patch[f] = new_id[m_face_patch[f]];
     }
-    uint32_t acc = 0;
+
+    RXMESH_TRACE(
+        "Patcher: balancing split {} and merged {} patches ({} -> {} "
+        "patches). Estimated max patch shared memory {} -> {} bytes (budget "
+        "= {} bytes)",
+        num_split,
+        num_merged,
+        m_num_patches,
+        new_offset.size(),
+        old_max_cost,
+        new_max,
+        budget);
+
+    m_num_patches    = new_offset.size();
+    m_num_seeds      = m_num_patches;
+    m_patches_offset = std::move(new_offset);
+    if (m_num_patches > m_max_num_patches) {
+        m_max_num_patches = m_num_patches;
+    }
+    if (m_ribbon_ext_offset.size() < m_num_patches) {
+        m_ribbon_ext_offset.resize(m_num_patches, 0);
+    }
+}
+
+void Patcher::reorder_patches(const std::vector<uint32_t>& ff_offset,
+                              const std::vector<uint32_t>& ff_values)
+{
+    std::vector<std::vector<uint32_t>> patch_graph;
+    build_patch_graph(ff_offset, ff_values, patch_graph);
+
+    auto by_degree = [&patch_graph](const uint32_t a, const uint32_t b) {
+        return patch_graph[a].size() < patch_graph[b].size();
+    };
+
+    // Cuthill-McKee: BFS where every component starts from its patch with
+    // the smallest degree and the neighbors are visited by increasing degree
+    std::vector<uint32_t> start_order(m_num_patches);
+    fill_with_sequential_numbers(start_order.data(), start_order.size());
+    std::stable_sort(start_order.begin(), start_order.end(), by_degree);
+
+    std::vector<uint32_t> order;
+    order.reserve(m_num_patches);
+    std::vector<bool>     visited(m_num_patches, false);
+    std::vector<uint32_t> next;
+    for (const uint32_t s : start_order) {
+        if (visited[s]) {
+            continue;
+        }
+        visited[s]  = true;
+        size_t head = order.size();
+        order.push_back(s);
+        while (head < order.size()) {
+            const uint32_t p = order[head++];
+            next.clear();
+            for (const uint32_t q : patch_graph[p]) {
+                if (!visited[q]) {
+                    visited[q] = true;
+                    next.push_back(q);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(), by_degree);
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    assert(order.size() == m_num_patches);
+    std::reverse(order.begin(), order.end());
+
+    std::vector<uint32_t> new_id(m_num_patches);
+    for (uint32_t i = 0; i < m_num_patches; ++i) {
+        new_id[order[i]] = i;
+    }
+
+    uint32_t old_bandwidth(0), new_bandwidth(0);
     for (uint32_t p = 0; p < m_num_patches; ++p) {
-        acc += m_patches_offset[p];
-        m_patches_offset[p] = acc;
+        for (const uint32_t q : patch_graph[p]) {
+            old_bandwidth = std::max(old_bandwidth, p > q ? p - q : q - p);
+            const uint32_t np = new_id[p], nq = new_id[q];
+            new_bandwidth =
+                std::max(new_bandwidth, np > nq ? np - nq : nq - np);
+        }
     }
-    std::vector<uint32_t> temp_offset(m_num_patches, 0);
-    for (uint32_t f = 0; f < m_num_faces; ++f) {
-        uint32_t p     = m_face_patch[f];
-        uint32_t start = (p == 0) ? p : m_patches_offset[p - 1];
-        m_patches_val[start + temp_offset[p]] = f;
-        temp_offset[p]++;
+    // Cuthill-McKee is a heuristic so the Lloyd order is kept if it is not
+    // improved on
+    if (new_bandwidth >= old_bandwidth) {
+        RXMESH_TRACE(
+            "Patcher: patch graph bandwidth {} is not reduced by reordering "
+            "({}). The patches are not reordered",
+            old_bandwidth,
+            new_bandwidth);
+        return;
     }
+
+    RXMESH_TRACE("Patcher: patch graph bandwidth {} -> {} after reordering",
+                 old_bandwidth,
+                 new_bandwidth);
+
+    relabel_patches(order);
 }
 
-void Patcher::postprocess(const std::vector<std::vector<uint32_t>>& fv,
-                          const std::vector<uint32_t>&              ff_offset,
-                          const std::vector<uint32_t>&              ff_values)
+void Patcher::postprocess(const std::vector<uint32_t>& fv,
+                          const std::vector<uint32_t>& ff_offset,
+                          const std::vector<uint32_t>& ff_values)
 {
     // Post process the patches by extracting the ribbons
     // For patch P, we start first by identifying boundary faces; faces that has
@@ -556,8 +1027,8 @@ void Patcher::postprocess(const std::vector<std::vector<uint32_t>>& fv,
         vertex_incident_faces[i].clear();
     }
     for (uint32_t face = 0; face < m_num_faces; ++face) {
-        for (uint32_t v = 0; v < fv[face].size(); ++v) {
-            vertex_incident_faces[fv[face][v]].push_back(face);
+        for (uint32_t v = 0; v < 3; ++v) {
+            vertex_incident_faces[fv[3 * face + v]].push_back(face);
         }
     }
 
@@ -596,11 +1067,11 @@ void Patcher::postprocess(const std::vector<std::vector<uint32_t>>& fv,
                     // that are shared between face and n
 
                     // add the common vertices in fv[face] and fv[n]
-                    for (uint32_t i = 0; i < fv[face].size(); ++i) {
-                        auto it_vf =
-                            std::find(fv[n].begin(), fv[n].end(), fv[face][i]);
-                        if (it_vf != fv[n].end()) {
-                            bd_vertices.push_back(fv[face][i]);
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        const uint32_t vi = fv[3 * face + i];
+                        if (fv[3 * n] == vi || fv[3 * n + 1] == vi ||
+                            fv[3 * n + 2] == vi) {
+                            bd_vertices.push_back(vi);
                         }
                     }
 
@@ -666,10 +1137,10 @@ void Patcher::postprocess(const std::vector<std::vector<uint32_t>>& fv,
 }
 
 void Patcher::assign_patch(
-    const std::vector<std::vector<uint32_t>>&                 fv,
+    const std::vector<uint32_t>&                              fv,
     const std::unordered_map<std::pair<uint32_t, uint32_t>,
                              uint32_t,
-                             ::rxmesh::detail::edge_key_hash> edges_map)
+                             ::rxmesh::detail::edge_key_hash>& edges_map)
 {
     // For every patch p, for every face in the patch, find the three edges
     // that bound that face, and assign them to the patch. For boundary vertices
@@ -685,9 +1156,9 @@ void Patcher::assign_patch(
 
             uint32_t face = m_patches_val[f];
 
-            uint32_t v1 = fv[face].back();
-            for (uint32_t v = 0; v < fv[face].size(); ++v) {
-                uint32_t v0 = fv[face][v];
+            uint32_t v1 = fv[3 * face + 2];
+            for (uint32_t v = 0; v < 3; ++v) {
+                uint32_t v0 = fv[3 * face + v];
 
                 std::pair<uint32_t, uint32_t> key =
                     ::rxmesh::detail::edge_key(v0, v1);
@@ -725,6 +1196,48 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
 {
     std::vector<uint32_t> h_queue_ptr{0, m_num_patches, m_num_patches};
 
+    // upper bound on the number of Lloyd iterations in case the patch size
+    // can not be met
+    constexpr uint32_t max_num_lloyd_run = 500;
+
+    // number of seeds moved by the last iteration. If the seeds did not move,
+    // the next iteration will produce the same patches so we add more seeds
+    // right away
+    uint32_t* d_num_moved_seeds = nullptr;
+    uint32_t  h_num_moved_seeds = 1;
+    CUDA_ERROR(cudaMalloc((void**)&d_num_moved_seeds, sizeof(uint32_t)));
+
+    // extra memory for the deterministic mode
+    uint32_t* d_next_patch            = nullptr;
+    uint32_t* d_scratch               = nullptr;
+    uint32_t* d_seg_offset            = nullptr;
+    void*     d_cub_temp_storage_sort = nullptr;
+    size_t    cub_sort_bytes          = 0;
+    if (m_deterministic) {
+        CUDA_ERROR(
+            cudaMalloc((void**)&d_next_patch, m_num_faces * sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&d_scratch, m_num_faces * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&d_seg_offset,
+                              (m_max_num_patches + 1) * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemset(d_seg_offset, 0, sizeof(uint32_t)));
+
+        size_t seg_bytes = 0, seed_bytes = 0;
+        ::cub::DeviceSegmentedRadixSort::SortKeys(nullptr,
+                                                  seg_bytes,
+                                                  d_patches_val,
+                                                  d_scratch,
+                                                  m_num_faces,
+                                                  m_max_num_patches,
+                                                  d_seg_offset,
+                                                  d_seg_offset + 1);
+        ::cub::DeviceRadixSort::SortKeys(
+            nullptr, seed_bytes, d_seeds, d_scratch, m_max_num_patches);
+        cub_sort_bytes = std::max(seg_bytes, seed_bytes);
+        CUDA_ERROR(
+            cudaMalloc((void**)&d_cub_temp_storage_sort, cub_sort_bytes));
+    }
+
     // CUDA_ERROR(cudaProfilerStart());
     GPUTimer timer;
     timer.start();
@@ -733,14 +1246,14 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
     while (true) {
         ++m_num_lloyd_run;
 
-        const uint32_t threads_s = 256;
-        const uint32_t blocks_s  = DIVIDE_UP(m_num_patches, threads_s);
         const uint32_t threads_f = 256;
         const uint32_t blocks_f  = DIVIDE_UP(m_num_faces, threads_f);
 
         // add more seeds if needed
-        if (m_num_lloyd_run % 5 == 0 && m_num_lloyd_run > 0) {
-            uint32_t threshold = m_patch_size;
+        if ((m_num_lloyd_run % 5 == 0 || h_num_moved_seeds == 0) &&
+            m_num_lloyd_run > 0) {
+            uint32_t threshold       = m_patch_size;
+            uint32_t old_num_patches = m_num_patches;
 
             CUDA_ERROR(cudaMemcpy(d_new_num_patches,
                                   &m_num_patches,
@@ -763,7 +1276,25 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
                     "Patcher::run_lloyd() m_num_patches exceeds "
                     "m_max_num_patches");
             }
+
+            // the order of the new seeds depends on the atomics
+            if (m_deterministic && m_num_patches > old_num_patches) {
+                ::cub::DeviceRadixSort::SortKeys(
+                    d_cub_temp_storage_sort,
+                    cub_sort_bytes,
+                    d_seeds + old_num_patches,
+                    d_scratch,
+                    m_num_patches - old_num_patches);
+                CUDA_ERROR(cudaMemcpy(
+                    d_seeds + old_num_patches,
+                    d_scratch,
+                    (m_num_patches - old_num_patches) * sizeof(uint32_t),
+                    cudaMemcpyDeviceToDevice));
+            }
         }
+
+        const uint32_t threads_s = 256;
+        const uint32_t blocks_s  = DIVIDE_UP(m_num_patches, threads_s);
         h_queue_ptr[0] = 0;
         h_queue_ptr[1] = m_num_patches;
         h_queue_ptr[2] = m_num_patches;
@@ -784,18 +1315,43 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
         write_initial_face_patch<<<blocks_s, threads_s>>>(
             m_num_patches, d_face_patch, d_seeds, d_patches_size);
 
+        if (m_deterministic) {
+            rxmesh::memset<<<blocks_f, threads_f>>>(
+                d_next_patch, INVALID32, m_num_faces);
+        }
+
         // Cluster seed propagation
         while (true) {
             // Launch enough threads to cover all the faces. However, only
             // subset will do actual work depending on the queue size
-            cluster_seed_propagation<<<blocks_f, threads_f>>>(m_num_faces,
-                                                              m_num_patches,
-                                                              d_queue_ptr,
+            if (m_deterministic) {
+                // a face reached by more than one patch in the same level
+                // takes the smallest patch id
+                cluster_seed_propose<<<blocks_f, threads_f>>>(d_queue_ptr,
                                                               d_queue,
                                                               d_face_patch,
-                                                              d_patches_size,
+                                                              d_next_patch,
                                                               d_ff_offset,
                                                               d_ff_values);
+                cluster_seed_commit<<<blocks_f, threads_f>>>(m_num_faces,
+                                                             d_queue_ptr,
+                                                             d_queue,
+                                                             d_face_patch,
+                                                             d_next_patch,
+                                                             d_patches_size,
+                                                             d_ff_offset,
+                                                             d_ff_values);
+            } else {
+                cluster_seed_propagation<<<blocks_f, threads_f>>>(
+                    m_num_faces,
+                    m_num_patches,
+                    d_queue_ptr,
+                    d_queue,
+                    d_face_patch,
+                    d_patches_size,
+                    d_ff_offset,
+                    d_ff_values);
+            }
 
             reset_queue_ptr<<<1, 1>>>(d_queue_ptr);
 
@@ -809,6 +1365,11 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
             }
         }
 
+        if (m_deterministic) {
+            mark_boundary_faces<<<blocks_f, threads_f>>>(
+                m_num_faces, d_face_patch, d_ff_offset, d_ff_values);
+        }
+
         uint32_t max_patch_size =
             construct_patches_compressed_format(d_face_patch,
                                                 d_cub_temp_storage_scan,
@@ -819,12 +1380,21 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
                                                 d_patches_offset,
                                                 d_patches_size,
                                                 d_patches_val);
+        if (m_deterministic) {
+            canonicalize_patches(d_patches_offset,
+                                 d_patches_val,
+                                 d_seg_offset,
+                                 d_scratch,
+                                 d_cub_temp_storage_sort,
+                                 cub_sort_bytes);
+        }
 
         // Interior
         uint32_t threads_i   = 512;
         uint32_t shmem_bytes = max_patch_size * (sizeof(uint32_t));
         rxmesh::memset<<<blocks_f, threads_f>>>(
             d_queue, INVALID32, m_num_faces);
+        CUDA_ERROR(cudaMemset(d_num_moved_seeds, 0, sizeof(uint32_t)));
         interior<<<m_num_patches, threads_i, shmem_bytes>>>(m_num_patches,
                                                             d_patches_offset,
                                                             d_patches_val,
@@ -832,14 +1402,30 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
                                                             d_seeds,
                                                             d_ff_offset,
                                                             d_ff_values,
-                                                            d_queue);
-
-        if (max_patch_size < m_patch_size) {
+                                                            d_queue,
+                                                            d_num_moved_seeds,
+                                                            m_deterministic);
+
+        const bool last_run = m_num_lloyd_run >= max_num_lloyd_run;
+        if (max_patch_size < m_patch_size || last_run) {
+            if (max_patch_size >= m_patch_size) {
+                RXMESH_WARN(
+                    "Patcher::run_lloyd() could not meet the patch size {} "
+                    "after {} Lloyd iterations (max patch size = {})",
+                    m_patch_size,
+                    m_num_lloyd_run,
+                    max_patch_size);
+            }
             shift<<<blocks_f, threads_f>>>(
                 m_num_faces, d_face_patch, d_patches_val);
 
             break;
         }
+
+        CUDA_ERROR(cudaMemcpy(&h_num_moved_seeds,
+                              d_num_moved_seeds,
+                              sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
     }
 
 
@@ -849,6 +1435,12 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
     m_patching_time_ms = timer.elapsed_millis();
     // CUDA_ERROR(cudaProfilerStop());
 
+    GPU_FREE(d_num_moved_seeds);
+    GPU_FREE(d_next_patch);
+    GPU_FREE(d_scratch);
+    GPU_FREE(d_seg_offset);
+    GPU_FREE(d_cub_temp_storage_sort);
+
 
     // move data to host
     m_num_seeds = m_num_patches;
@@ -915,5 +1507,35 @@ uint32_t Patcher::construct_patches_compressed_format(
     return max_patch_size;
 }
 
+void Patcher::canonicalize_patches(uint32_t* d_patches_offset,
+                                   uint32_t* d_patches_val,
+                                   uint32_t* d_seg_offset,
+                                   uint32_t* d_scratch,
+                                   void*     d_cub_temp_storage_sort,
+                                   size_t    cub_sort_bytes)
+{
+    // the faces of patch p are in [d_seg_offset[p], d_seg_offset[p + 1])
+    // where d_seg_offset[0] = 0. Sorting d_patches_val (face << 1 | boundary)
+    // sorts the faces by their id
+    CUDA_ERROR(cudaMemcpy(d_seg_offset + 1,
+                          d_patches_offset,
+                          m_num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToDevice));
+
+    ::cub::DeviceSegmentedRadixSort::SortKeys(d_cub_temp_storage_sort,
+                                              cub_sort_bytes,
+                                              d_patches_val,
+                                              d_scratch,
+                                              m_num_faces,
+                                              m_num_patches,
+                                              d_seg_offset,
+                                              d_seg_offset + 1);
+
+    CUDA_ERROR(cudaMemcpy(d_patches_val,
+                          d_scratch,
+                          m_num_faces * sizeof(uint32_t),
+                          cudaMemcpyDeviceToDevice));
+}
+
 }  // namespace patcher
 }  // namespace rxmesh
\ No newline at end of file
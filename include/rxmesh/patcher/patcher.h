@@ -22,7 +22,21 @@ namespace patcher {
 
 /**
  * @brief Takes an input mesh and partition it to patches using Lloyd algorithm
- * on the gpu
+ * on the gpu. If the face adjacent faces (ff) are already on the device, they
+ * can be passed to the constructor (d_ff_offset and d_ff_values) which avoids
+ * copying the host ff to the device. The input faces (fv) are triangles
+ * stored as three contiguous vertex ids per face. The connected components
+ * labeling, the seeding, and the Lloyd iterations all run on the device. With
+ * the deterministic mode, the same input always produces the same patches
+ * (independent of the scheduling of the GPU threads) at the cost of few extra
+ * passes per Lloyd iteration. With reorder (off by default), the patches are
+ * renumbered along a reverse Cuthill-McKee order of the patch graph so that
+ * neighbor patches have close ids (and thus their elements are close in
+ * memory) if this reduces the bandwidth of the patch graph. With balance (off
+ * by default), patches whose estimated shared memory (including the ribbon)
+ * is well above the average are split and small patches are merged into their
+ * neighbors so the shared memory needed by the largest patch is closer to the
+ * average
  */
 class Patcher
 {
@@ -32,18 +46,29 @@ class Patcher
    public:
     Patcher() = default;
 
-    Patcher(uint32_t                                  patch_size,
-            const std::vector<uint32_t>&              ff_offset,
-            const std::vector<uint32_t>&              ff_values,
-            const std::vector<std::vector<uint32_t>>& fv,
+    Patcher(uint32_t                     patch_size,
+            const std::vector<uint32_t>& ff_offset,
+            const std::vector<uint32_t>& ff_values,
+            const std::vector<uint32_t>& fv,
             const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                      uint32_t,
-                                     ::rxmesh::detail::edge_key_hash> edges_map,
-            const uint32_t num_vertices,
-            const uint32_t num_edges);
+                                     ::rxmesh::detail::edge_key_hash>& edges_map,
+            const uint32_t  num_vertices,
+            const uint32_t  num_edges,
+            const uint32_t* d_ff_offset   = nullptr,
+            const uint32_t* d_ff_values   = nullptr,
+            const bool      deterministic = false,
+            const bool      reorder       = false,
+            const bool      balance       = false);
 
     Patcher(std::string filename);
 
+    /**
+     * @brief read the patcher from an input stream that holds what is
+     * written by save(std::ostream&) e.g., a section in a mesh cache file
+     */
+    Patcher(std::istream& is);
+
     ~Patcher();
 
     void print_statistics();
@@ -150,10 +175,28 @@ class Patcher
         return m_num_lloyd_run;
     }
 
+    bool is_deterministic() const
+    {
+        return m_deterministic;
+    }
+
+    /**
+     * @brief the max over all patches of the estimated shared memory (in
+     * bytes) needed to load the patch EV and FE including the patch ribbon
+     * (see balance_patches)
+     * @param fv the input faces used to build the patcher
+     */
+    uint32_t get_max_patch_smem_estimate(const std::vector<uint32_t>& fv) const;
+
     void save(std::string filename)
     {
-        std::ofstream                       ss(filename, std::ios::binary);
-        cereal::PortableBinaryOutputArchive archive(ss);
+        std::ofstream ss(filename, std::ios::binary);
+        save(ss);
+    }
+
+    void save(std::ostream& os)
+    {
+        cereal::PortableBinaryOutputArchive archive(os);
         archive(*this);
     }
 
@@ -185,7 +228,15 @@ class Patcher
      * @brief Allocate various auxiliary memory needed to store patches info on
      * the host
      */
-    void allocate_memory(std::vector<uint32_t>& seeds);
+    void allocate_memory();
+
+    /**
+     * @brief copy ff to the device if it is not already there
+     */
+    void copy_ff_to_device(const std::vector<uint32_t>& ff_offset,
+                           const std::vector<uint32_t>& ff_values,
+                           uint32_t*&                   d_ff_values,
+                           uint32_t*&                   d_ff_offset);
 
     /**
      * @brief Allocate various temporarily memory on the device needed to
@@ -194,8 +245,7 @@ class Patcher
      * get face-incident-faces
      * @param ff_values stores face-incident-faces in compressed format
      */
-    void allocate_device_memory(const std::vector<uint32_t>& seeds,
-                                const std::vector<uint32_t>& ff_offset,
+    void allocate_device_memory(const std::vector<uint32_t>& ff_offset,
                                 const std::vector<uint32_t>& ff_values,
                                 uint32_t*&                   d_face_patch,
                                 uint32_t*&                   d_queue,
@@ -214,27 +264,34 @@ class Patcher
                                 uint32_t*& d_patches_val);
 
     void assign_patch(
-        const std::vector<std::vector<uint32_t>>&                 fv,
+        const std::vector<uint32_t>&                              fv,
         const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                  uint32_t,
-                                 ::rxmesh::detail::edge_key_hash> edges_map);
-
-    void initialize_random_seeds(std::vector<uint32_t>&       seeds,
-                                 const std::vector<uint32_t>& ff_offset,
-                                 const std::vector<uint32_t>& ff_values);
+                                 ::rxmesh::detail::edge_key_hash>& edges_map);
 
-    void get_multi_components(std::vector<std::vector<uint32_t>>& components,
-                              const std::vector<uint32_t>&        ff_offset,
-                              const std::vector<uint32_t>&        ff_values);
+    /**
+     * @brief label the connected components of the faces on the device. Sets
+     * m_num_components and returns the component id of every face
+     * (d_face_component) and the number of faces in every component
+     * (h_component_size)
+     */
+    void get_multi_components(const uint32_t*        d_ff_offset,
+                              const uint32_t*        d_ff_values,
+                              uint32_t*              d_face_component,
+                              std::vector<uint32_t>& h_component_size);
 
-    void initialize_random_seeds_single_component(std::vector<uint32_t>& seeds);
-    void generate_random_seed_from_component(std::vector<uint32_t>& seeds,
-                                             std::vector<uint32_t>& component,
-                                             uint32_t               num_seeds);
+    /**
+     * @brief generate m_num_seeds random seeds on the device such that every
+     * component takes at least one seed and the remaining seeds are
+     * distributed proportional to the size of the components
+     */
+    void initialize_random_seeds(const uint32_t*              d_face_component,
+                                 const std::vector<uint32_t>& h_component_size,
+                                 uint32_t*                    d_seeds);
 
-    void postprocess(const std::vector<std::vector<uint32_t>>& fv,
-                     const std::vector<uint32_t>&              ff_offset,
-                     const std::vector<uint32_t>&              ff_values);
+    void postprocess(const std::vector<uint32_t>& fv,
+                     const std::vector<uint32_t>& ff_offset,
+                     const std::vector<uint32_t>& ff_values);
 
     uint32_t construct_patches_compressed_format(uint32_t* d_face_patch,
                                                  void*  d_cub_temp_storage_scan,
@@ -262,8 +319,72 @@ class Patcher
                    uint32_t* d_patches_size,
                    uint32_t* d_patches_val);
 
-    void bfs(const std::vector<uint32_t>& ff_offset,
-             const std::vector<uint32_t>& ff_values);
+    /**
+     * @brief sort the faces of every patch so their order does not depend on
+     * the atomics used to construct the compressed format. Used only in the
+     * deterministic mode
+     */
+    void canonicalize_patches(uint32_t* d_patches_offset,
+                              uint32_t* d_patches_val,
+                              uint32_t* d_seg_offset,
+                              uint32_t* d_scratch,
+                              void*     d_cub_temp_storage_sort,
+                              size_t    cub_sort_bytes);
+
+    /**
+     * @brief the patch adjacency (sorted and unique) where two patches are
+     * adjacent if they have adjacent faces
+     */
+    void build_patch_graph(
+        const std::vector<uint32_t>&        ff_offset,
+        const std::vector<uint32_t>&        ff_values,
+        std::vector<std::vector<uint32_t>>& patch_graph) const;
+
+    /**
+     * @brief renumber the patches such that the new id of order[i] is i and
+     * rebuild m_face_patch, m_patches_offset, and m_patches_val
+     */
+    void relabel_patches(const std::vector<uint32_t>& order);
+
+    /**
+     * @brief vertex incident faces in compressed format where vf_offset is an
+     * exclusive scan with m_num_vertices + 1 entries
+     */
+    void build_vertex_faces(const std::vector<uint32_t>& fv,
+                            std::vector<uint32_t>&       vf_offset,
+                            std::vector<uint32_t>&       vf_values) const;
+
+    /**
+     * @brief estimate (in bytes) the shared memory needed to load the EV and
+     * FE of a patch given its faces. The estimate includes the patch ribbon,
+     * i.e., all faces incident to the vertices of the patch faces
+     */
+    uint32_t estimate_patch_smem(const std::vector<uint32_t>& fv,
+                                 const std::vector<uint32_t>& vf_offset,
+                                 const std::vector<uint32_t>& vf_values,
+                                 const std::vector<uint32_t>& faces) const;
+
+    /**
+     * @brief split the patches whose estimate_patch_smem() is above a budget
+     * and merge the patches below half the budget into a neighbor patch as
+     * long as the merged patch is within the budget. The budget is
+     * balance_slack times the average estimate capped by the max estimate so
+     * the max estimate never increases
+     */
+    void balance_patches(const std::vector<uint32_t>& fv,
+                         const std::vector<uint32_t>& ff_offset,
+                         const std::vector<uint32_t>& ff_values);
+
+    // the balancing budget relative to the average patch estimate
+    static constexpr float balance_slack = 1.25f;
+
+    /**
+     * @brief renumber the patches with reverse Cuthill-McKee over the patch
+     * graph (two patches are adjacent if they have adjacent faces). The faces
+     * keep their relative order within their patch
+     */
+    void reorder_patches(const std::vector<uint32_t>& ff_offset,
+                         const std::vector<uint32_t>& ff_values);
 
 
     uint32_t m_patch_size, m_num_patches, m_num_vertices, m_num_edges,
@@ -282,6 +403,9 @@ class Patcher
 
     // caching the time taken to construct the patches
     float m_patching_time_ms;
+
+    // if the patches should not depend on the scheduling of the GPU threads
+    bool m_deterministic = false;
 };
 
 }  // namespace patcher
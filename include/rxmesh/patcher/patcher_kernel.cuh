@@ -143,7 +143,9 @@ __global__ static void interior(const uint32_t  num_patches,
                                 uint32_t*       d_seeds,
                                 const uint32_t* d_ff_offset,
                                 const uint32_t* d_ff_values,
-                                uint32_t*       d_queue)
+                                uint32_t*       d_queue,
+                                uint32_t*       d_num_moved_seeds,
+                                const bool      deterministic)
 //,uint32_t*       d_second_queue
 
 {
@@ -237,6 +239,23 @@ __global__ static void interior(const uint32_t  num_patches,
             /////////////////////////////////////////////////
 
             assert(queue_end == p_size);
+
+            // with the deterministic mode, the new seed is the face with the
+            // smallest id in the last level (the order of the faces within a
+            // level depends on the atomics)
+            __shared__ uint32_t s_min_face;
+            if (deterministic) {
+                if (threadIdx.x == 0) {
+                    s_min_face = INVALID32;
+                }
+                __syncthreads();
+                for (tid = queue_start + threadIdx.x; tid < queue_end;
+                     tid += blockDim.x) {
+                    ::atomicMin(&s_min_face, s_queue[tid]);
+                }
+                __syncthreads();
+            }
+
             // pick random face
             if (threadIdx.x == 0) {
                 // TODO pick the face randomly between
@@ -245,7 +264,12 @@ __global__ static void interior(const uint32_t  num_patches,
 
                 // d_seeds[patch_id] = d_queue[p_start + queue_start - 1];
                 if (queue_start != 0) {
-                    d_seeds[patch_id] = s_queue[queue_start];
+                    const uint32_t new_seed =
+                        deterministic ? s_min_face : s_queue[queue_start];
+                    if (d_seeds[patch_id] != new_seed) {
+                        d_seeds[patch_id] = new_seed;
+                        ::atomicAdd(d_num_moved_seeds, 1u);
+                    }
                 }
             }
         }
@@ -253,6 +277,262 @@ __global__ static void interior(const uint32_t  num_patches,
 }
 
 
+/**
+ * @brief deterministic version of cluster_seed_propagation (first pass). Every
+ * face in the current queue proposes its patch to its unassigned neighbor
+ * faces and every unassigned face keeps the smallest proposed patch
+ */
+__global__ static void cluster_seed_propose(const uint32_t* d_queue_ptr,
+                                            const uint32_t* d_queue,
+                                            const uint32_t* d_face_patch,
+                                            uint32_t*       d_next_patch,
+                                            const uint32_t* d_ff_offset,
+                                            const uint32_t* d_ff_values)
+{
+    uint32_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+
+    const uint32_t current_queue_end   = d_queue_ptr[1];
+    const uint32_t current_queue_start = d_queue_ptr[0];
+    while (tid >= current_queue_start && tid < current_queue_end) {
+        const uint32_t  face_id    = d_queue[tid];
+        const uint32_t  face_patch = d_face_patch[face_id] >> 1;
+        uint32_t        ff_len     = 0;
+        const uint32_t* ff_ptr =
+            get_face_faces(d_ff_offset, d_ff_values, face_id, ff_len);
+
+        for (uint32_t i = 0; i < ff_len; i++) {
+            const uint32_t n_face = ff_ptr[i];
+            if (d_face_patch[n_face] == INVALID32) {
+                ::atomicMin(&d_next_patch[n_face], face_patch);
+            }
+        }
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief deterministic version of cluster_seed_propagation (second pass).
+ * Unassigned neighbor faces of the current queue take the patch chosen by
+ * cluster_seed_propose() and are added to the next queue. The boundary bit is
+ * computed later by mark_boundary_faces()
+ */
+__global__ static void cluster_seed_commit(const uint32_t  num_faces,
+                                           uint32_t*       d_queue_ptr,
+                                           uint32_t*       d_queue,
+                                           uint32_t*       d_face_patch,
+                                           const uint32_t* d_next_patch,
+                                           uint32_t*       d_patches_size,
+                                           const uint32_t* d_ff_offset,
+                                           const uint32_t* d_ff_values)
+{
+    uint32_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+
+    const uint32_t current_queue_end   = d_queue_ptr[1];
+    const uint32_t current_queue_start = d_queue_ptr[0];
+    while (tid >= current_queue_start && tid < current_queue_end) {
+        const uint32_t  face_id = d_queue[tid];
+        uint32_t        ff_len  = 0;
+        const uint32_t* ff_ptr =
+            get_face_faces(d_ff_offset, d_ff_values, face_id, ff_len);
+
+        for (uint32_t i = 0; i < ff_len; i++) {
+            const uint32_t n_face  = ff_ptr[i];
+            const uint32_t n_patch = d_next_patch[n_face];
+            if (n_patch == INVALID32) {
+                continue;
+            }
+            const uint32_t assumed =
+                ::atomicCAS(&d_face_patch[n_face], INVALID32, n_patch << 1);
+            if (assumed == INVALID32) {
+                uint32_t old = ::atomicAdd(&d_queue_ptr[2], uint32_t(1));
+                d_queue[old] = n_face;
+                assert(old < num_faces);
+
+                old = ::atomicAdd(&d_patches_size[n_patch], uint32_t(1));
+                assert(old < num_faces);
+            }
+        }
+        tid += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief set the first bit of d_face_patch for faces that have a neighbor
+ * face in a different patch
+ */
+__global__ static void mark_boundary_faces(const uint32_t  num_faces,
+                                           uint32_t*       d_face_patch,
+                                           const uint32_t* d_ff_offset,
+                                           const uint32_t* d_ff_values)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        const uint32_t  patch  = d_face_patch[face] >> 1;
+        uint32_t        ff_len = 0;
+        const uint32_t* ff_ptr =
+            get_face_faces(d_ff_offset, d_ff_values, face, ff_len);
+
+        uint32_t is_boundary = 0;
+        for (uint32_t i = 0; i < ff_len; i++) {
+            if ((d_face_patch[ff_ptr[i]] >> 1) != patch) {
+                is_boundary = 1;
+                break;
+            }
+        }
+        // only the first bit is changed and it is not read by the neighbors
+        d_face_patch[face] = (patch << 1) | is_boundary;
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief every face starts in its own component
+ */
+__global__ static void component_init(const uint32_t num_faces,
+                                      uint32_t*      d_label)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        d_label[face] = face;
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief one step of the connected component labeling of the faces. Every face
+ * takes the smallest label among its neighbors and hooks the root of its old
+ * label to it. d_changed is set if any label changed
+ */
+__global__ static void component_hook(const uint32_t  num_faces,
+                                      uint32_t*       d_label,
+                                      const uint32_t* d_ff_offset,
+                                      const uint32_t* d_ff_values,
+                                      uint32_t*       d_changed)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        const uint32_t  label  = d_label[face];
+        uint32_t        ff_len = 0;
+        const uint32_t* ff_ptr =
+            get_face_faces(d_ff_offset, d_ff_values, face, ff_len);
+
+        uint32_t min_label = label;
+        for (uint32_t i = 0; i < ff_len; i++) {
+            min_label = min(min_label, d_label[ff_ptr[i]]);
+        }
+        if (min_label < label) {
+            ::atomicMin(&d_label[label], min_label);
+            ::atomicMin(&d_label[face], min_label);
+            d_changed[0] = 1;
+        }
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief shortcut the labels so every face points to the root of its label
+ */
+__global__ static void component_jump(const uint32_t num_faces,
+                                      uint32_t*      d_label)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        uint32_t label = d_label[face];
+        while (d_label[label] != label) {
+            label = d_label[label];
+        }
+        d_label[face] = label;
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief flag the faces that are the root (smallest face id) of their
+ * component
+ */
+__global__ static void component_roots(const uint32_t  num_faces,
+                                       const uint32_t* d_label,
+                                       uint32_t*       d_is_root)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        d_is_root[face] = (d_label[face] == face);
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief turn the component label (root face) into a component id in
+ * [0, num_components) and count the number of faces in every component
+ */
+__global__ static void component_compact(const uint32_t  num_faces,
+                                         uint32_t*       d_label,
+                                         const uint32_t* d_root_prefix,
+                                         uint32_t*       d_component_size)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        const uint32_t c = d_root_prefix[d_label[face]];
+        d_label[face]    = c;
+        ::atomicAdd(&d_component_size[c], 1u);
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief integer hash used to shuffle the faces within their component
+ */
+__device__ __forceinline__ uint32_t face_hash(uint32_t face, uint32_t seed)
+{
+    uint32_t h = face ^ seed;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief sort key of every face such that sorting the faces by these keys
+ * groups them by their component and shuffles them within the component
+ */
+__global__ static void seed_sort_keys(const uint32_t  num_faces,
+                                      const uint32_t* d_component,
+                                      const uint32_t  rng_seed,
+                                      uint64_t*       d_keys,
+                                      uint32_t*       d_faces)
+{
+    uint32_t face = threadIdx.x + blockIdx.x * blockDim.x;
+    while (face < num_faces) {
+        d_keys[face] = (uint64_t(d_component[face]) << 32) |
+                       uint64_t(face_hash(face, rng_seed));
+        d_faces[face] = face;
+        face += blockDim.x * gridDim.x;
+    }
+}
+
+/**
+ * @brief every component takes its seeds from the first (shuffled) faces in
+ * its segment of the sorted faces
+ */
+__global__ static void gather_seeds(const uint32_t  num_components,
+                                    const uint32_t* d_component_offset,
+                                    const uint32_t* d_seed_offset,
+                                    const uint32_t* d_sorted_faces,
+                                    uint32_t*       d_seeds)
+{
+    uint32_t c = threadIdx.x + blockIdx.x * blockDim.x;
+    while (c < num_components) {
+        const uint32_t start = d_component_offset[c];
+        for (uint32_t s = d_seed_offset[c]; s < d_seed_offset[c + 1]; ++s) {
+            d_seeds[s] = d_sorted_faces[start + s - d_seed_offset[c]];
+        }
+        c += blockDim.x * gridDim.x;
+    }
+}
+
+
 __global__ static void add_more_seeds(const uint32_t  num_patches,
                                       uint32_t*       d_new_num_patches,
                                       uint32_t*       d_seeds,
@@ -0,0 +1,902 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief number of components of a (symmetric 4x4) quadric stored as
+ * a2, ab, ac, ad, b2, bc, bd, c2, cd, d2
+ */
+static constexpr uint32_t qem_quadric_size = 10;
+
+/**
+ * @brief number of bins of the (log-scale) collapse cost histogram. Two bins
+ * per power of two covering [2^-96, 2^32)
+ */
+static constexpr int qem_num_bins = 256;
+
+template <typename T>
+__device__ __host__ __inline__ int qem_bin(const T cost)
+{
+    if (!(cost > T(0))) {
+        return 0;
+    }
+    if (!(cost < std::numeric_limits<T>::max())) {
+        return qem_num_bins - 1;
+    }
+    const int b = int(std::floor(T(2) * std::log2(cost))) + 192;
+    return b < 0 ? 0 : (b >= qem_num_bins ? qem_num_bins - 1 : b);
+}
+
+/**
+ * @brief an edge is collapsed only if its cost is finite, within the max
+ * error, and in the selected histogram bins. Edges with negative cost are new
+ * edges whose cost is not computed yet
+ */
+template <typename T>
+__device__ __host__ __inline__ bool qem_is_candidate(const T   cost,
+                                                     const T   max_error,
+                                                     const int max_bin)
+{
+    return cost >= T(0) && cost <= max_error && qem_bin(cost) <= max_bin;
+}
+
+/**
+ * @brief (cost, key) lexicographic order used to break ties deterministically
+ */
+template <typename T>
+__device__ __host__ __inline__ bool qem_less(const T        cost_a,
+                                             const uint32_t key_a,
+                                             const T        cost_b,
+                                             const uint32_t key_b)
+{
+    return cost_a < cost_b || (cost_a == cost_b && key_a < key_b);
+}
+
+__device__ __host__ __inline__ uint32_t qem_mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief hash the bits of n values
+ */
+template <typename T>
+__device__ __host__ __inline__ uint32_t qem_hash(const T* v, const int n)
+{
+    constexpr int         w = sizeof(T) / sizeof(uint32_t);
+    const uint32_t* const d = reinterpret_cast<const uint32_t*>(v);
+    uint32_t              h = 0x9e3779b9;
+    for (int i = 0; i < n * w; ++i) {
+        h = qem_mix(h ^ d[i]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+/**
+ * @brief a key of an edge that only depends on its end vertices positions
+ * (and not on their order) so that it does not change with the patch layout
+ */
+template <typename T>
+__device__ __host__ __inline__ uint32_t qem_key(const vec3<T>& p0,
+                                                const vec3<T>& p1)
+{
+    const uint32_t h0 = qem_hash(&p0[0], 3);
+    const uint32_t h1 = qem_hash(&p1[0], 3);
+    return qem_mix((h0 < h1 ? h0 : h1) * 31u + (h0 < h1 ? h1 : h0));
+}
+
+/**
+ * @brief x^T Q x where x = (x, y, z, 1)
+ */
+template <typename T>
+__device__ __host__ __inline__ T qem_eval(const T* q, const vec3<T>& x)
+{
+    // clang-format off
+    return     q[0] * x[0] * x[0] +
+           2 * q[1] * x[0] * x[1] +
+           2 * q[2] * x[0] * x[2] +
+           2 * q[3] * x[0] +
+               q[4] * x[1] * x[1] +
+           2 * q[5] * x[1] * x[2] +
+           2 * q[6] * x[1] +
+               q[7] * x[2] * x[2] +
+           2 * q[8] * x[2] +
+               q[9];
+    // clang-format on
+}
+
+/**
+ * @brief the position x that minimizes the quadric q and its cost. If the
+ * quadric is singular, x is the best of p0, p1, and their mid point
+ */
+template <typename T>
+__device__ __host__ __inline__ T qem_optimal(const T*       q,
+                                             const vec3<T>& p0,
+                                             const vec3<T>& p1,
+                                             vec3<T>&       x)
+{
+    // A = [q0 q1 q2; q1 q4 q5; q2 q5 q7] and A x = -(q3, q6, q8)
+    const T c00 = q[4] * q[7] - q[5] * q[5];
+    const T c01 = q[2] * q[5] - q[1] * q[7];
+    const T c02 = q[1] * q[5] - q[2] * q[4];
+    const T det = q[0] * c00 + q[1] * c01 + q[2] * c02;
+
+    const T scale = std::abs(q[0]) + std::abs(q[4]) + std::abs(q[7]);
+
+    if (std::abs(det) > std::numeric_limits<T>::epsilon() * scale * scale *
+                            scale) {
+        const T c11 = q[0] * q[7] - q[2] * q[2];
+        const T c12 = q[1] * q[2] - q[0] * q[5];
+        const T c22 = q[0] * q[4] - q[1] * q[1];
+
+        const vec3<T> b(-q[3], -q[6], -q[8]);
+
+        x = vec3<T>(c00 * b[0] + c01 * b[1] + c02 * b[2],
+                    c01 * b[0] + c11 * b[1] + c12 * b[2],
+                    c02 * b[0] + c12 * b[1] + c22 * b[2]) /
+            det;
+        const T cost = qem_eval(q, x);
+        return cost > T(0) ? cost : T(0);
+    }
+
+    const vec3<T> pm = T(0.5) * (p0 + p1);
+
+    const T e0 = qem_eval(q, p0);
+    const T e1 = qem_eval(q, p1);
+    const T em = qem_eval(q, pm);
+
+    T cost = em;
+    x      = pm;
+    if (e0 < cost) {
+        cost = e0;
+        x    = p0;
+    }
+    if (e1 < cost) {
+        cost = e1;
+        x    = p1;
+    }
+    return cost > T(0) ? cost : T(0);
+}
+
+template <typename T, typename HandleT>
+__device__ __host__ __inline__ vec3<T> qem_position(
+    const VertexAttribute<T>& coords,
+    const HandleT&            vh)
+{
+    return vec3<T>(coords(vh, 0), coords(vh, 1), coords(vh, 2));
+}
+
+template <typename T>
+__device__ __inline__ void qem_sum(const VertexAttribute<T>& quadric,
+                                   const VertexHandle&       v0,
+                                   const VertexHandle&       v1,
+                                   T*                        q)
+{
+    for (uint32_t i = 0; i < qem_quadric_size; ++i) {
+        q[i] = quadric(v0, i) + quadric(v1, i);
+    }
+}
+
+/**
+ * @brief the plane (n, d) of every face
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void qem_face_plane(const Context            context,
+                                      const VertexAttribute<T> coords,
+                                      FaceAttribute<T>         plane)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            const vec3<T> p0 = qem_position(coords, iter[0]);
+            const vec3<T> p1 = qem_position(coords, iter[1]);
+            const vec3<T> p2 = qem_position(coords, iter[2]);
+
+            // degenerate faces do not contribute to the quadrics
+            vec3<T> n   = glm::cross(p1 - p0, p2 - p0);
+            const T len = glm::length(n);
+            if (len > std::numeric_limits<T>::min()) {
+                n /= len;
+            } else {
+                n = vec3<T>(T(0), T(0), T(0));
+            }
+            plane(fh, 0) = n[0];
+            plane(fh, 1) = n[1];
+            plane(fh, 2) = n[2];
+            plane(fh, 3) = -glm::dot(n, p0);
+        });
+}
+
+/**
+ * @brief every vertex quadric is the sum of its faces plane quadric. This is
+ * a gather (rather than a scatter with atomics) and the faces are summed in
+ * the order of the hash of their plane so the result does not depend on the
+ * timing nor on the patch layout
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void qem_vertex_quadric(const Context          context,
+                                          const FaceAttribute<T> plane,
+                                          VertexAttribute<T>     quadric)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VF>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const FaceIterator& iter) {
+            auto face_plane = [&](const uint16_t f, T* abcd) {
+                for (int i = 0; i < 4; ++i) {
+                    abcd[i] = plane(iter[f], i);
+                }
+            };
+
+            T q[qem_quadric_size] = {0};
+
+            // visit the faces in ascending hash order (the valence is small
+            // so a selection is enough)
+            bool     first = true;
+            uint32_t last  = 0;
+            while (true) {
+                bool     found = false;
+                uint32_t next  = 0;
+                for (uint16_t f = 0; f < iter.size(); ++f) {
+                    T abcd[4];
+                    face_plane(f, abcd);
+                    const uint32_t h = qem_hash(abcd, 4);
+                    if ((first || h > last) && (!found || h < next)) {
+                        next  = h;
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    break;
+                }
+                for (uint16_t f = 0; f < iter.size(); ++f) {
+                    T abcd[4];
+                    face_plane(f, abcd);
+                    if (qem_hash(abcd, 4) != next) {
+                        continue;
+                    }
+                    const T a = abcd[0], b = abcd[1], c = abcd[2], d = abcd[3];
+                    q[0] += a * a;
+                    q[1] += a * b;
+                    q[2] += a * c;
+                    q[3] += a * d;
+                    q[4] += b * b;
+                    q[5] += b * c;
+                    q[6] += b * d;
+                    q[7] += c * c;
+                    q[8] += c * d;
+                    q[9] += d * d;
+                }
+                first = false;
+                last  = next;
+            }
+
+            for (uint32_t i = 0; i < qem_quadric_size; ++i) {
+                quadric(vh, i) = q[i];
+            }
+        });
+}
+
+/**
+ * @brief compute the cost (and the key) of the new edges, i.e., the ones with
+ * negative cost, and add every edge within max_error to the cost histogram.
+ * Edges touching the boundary get infinite cost
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void qem_edge_cost(const Context                  context,
+                                     const VertexAttribute<T>       coords,
+                                     const VertexAttribute<T>       quadric,
+                                     const VertexAttribute<uint8_t> boundary,
+                                     EdgeAttribute<T>               cost,
+                                     EdgeAttribute<uint32_t>        key,
+                                     const T                        max_error,
+                                     uint32_t*                      d_bins)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(
+        block,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            T c = cost(eh);
+            if (c < T(0)) {
+                if (boundary(iter[0]) || boundary(iter[1])) {
+                    c = std::numeric_limits<T>::infinity();
+                } else {
+                    const vec3<T> p0 = qem_position(coords, iter[0]);
+                    const vec3<T> p1 = qem_position(coords, iter[1]);
+
+                    T q[qem_quadric_size];
+                    qem_sum(quadric, iter[0], iter[1], q);
+
+                    vec3<T> x;
+                    c       = qem_optimal(q, p0, p1, x);
+                    key(eh) = qem_key(p0, p1);
+                }
+                cost(eh) = c;
+            }
+            if (c <= max_error) {
+                ::atomicAdd(d_bins + qem_bin(c), 1u);
+            }
+        });
+}
+
+/**
+ * @brief the smallest (cost, key) of the candidate edges incident to every
+ * vertex
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void qem_vertex_min(const Context                 context,
+                                      const EdgeAttribute<T>        cost,
+                                      const EdgeAttribute<uint32_t> key,
+                                      const T                       max_error,
+                                      const int                     max_bin,
+                                      VertexAttribute<T>            min_cost,
+                                      VertexAttribute<uint32_t>     min_key)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VE>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const EdgeIterator& iter) {
+            T        mc = std::numeric_limits<T>::infinity();
+            uint32_t mk = INVALID32;
+            for (uint16_t e = 0; e < iter.size(); ++e) {
+                const T c = cost(iter[e]);
+                if (!qem_is_candidate(c, max_error, max_bin)) {
+                    continue;
+                }
+                const uint32_t k = key(iter[e]);
+                if (qem_less(c, k, mc, mk)) {
+                    mc = c;
+                    mk = k;
+                }
+            }
+            min_cost(vh) = mc;
+            min_key(vh)  = mk;
+        });
+}
+
+/**
+ * @brief the smallest (cost, key) over every vertex one-ring (including the
+ * vertex itself). An edge that is the minimum of both its end vertices ring
+ * is the cheapest edge among all edges touching their one-ring and so the
+ * cavities of the selected edges never overlap
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void qem_ring_min(const Context                   context,
+                                    const VertexAttribute<T>        min_cost,
+                                    const VertexAttribute<uint32_t> min_key,
+                                    VertexAttribute<T>              ring_cost,
+                                    VertexAttribute<uint32_t>       ring_key)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            T        mc = min_cost(vh);
+            uint32_t mk = min_key(vh);
+            for (uint16_t v = 0; v < iter.size(); ++v) {
+                const T        c = min_cost(iter[v]);
+                const uint32_t k = min_key(iter[v]);
+                if (qem_less(c, k, mc, mk)) {
+                    mc = c;
+                    mk = k;
+                }
+            }
+            ring_cost(vh) = mc;
+            ring_key(vh)  = mk;
+        });
+}
+
+/**
+ * @brief collapse the selected edges through apply_edge_ops(). The new vertex
+ * is placed at the quadric optimal position and its quadric is the sum of the
+ * two end vertices quadrics. If withUV, uv is linearly interpolated along the
+ * edge at the projection of the new position
+ */
+template <typename T, uint32_t blockThreads, bool withUV>
+__global__ static void qem_collapse(Context                   context,
+                                    VertexAttribute<T>        coords,
+                                    VertexAttribute<T>        quadric,
+                                    VertexAttribute<uint8_t>  boundary,
+                                    EdgeAttribute<T>          cost,
+                                    EdgeAttribute<uint32_t>   key,
+                                    VertexAttribute<T>        ring_cost,
+                                    VertexAttribute<uint32_t> ring_key,
+                                    VertexAttribute<T>        uv)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    auto edge_op = [&](const EdgeHandle& eh, const VertexIterator& iter) {
+        const T        c  = cost(eh);
+        const uint32_t k  = key(eh);
+        const auto     v0 = iter[0];
+        const auto     v1 = iter[2];
+        if (c >= T(0) && c < std::numeric_limits<T>::infinity() &&
+            ring_cost(v0) == c && ring_key(v0) == k && ring_cost(v1) == c &&
+            ring_key(v1) == k) {
+            return EdgeOp::Collapse;
+        }
+        return EdgeOp::None;
+    };
+
+    auto interpolate = [&](const VertexHandle& vh,
+                           const VertexHandle& v0,
+                           const VertexHandle& v1,
+                           const float) {
+        const vec3<T> p0 = qem_position(coords, v0);
+        const vec3<T> p1 = qem_position(coords, v1);
+
+        T q[qem_quadric_size];
+        qem_sum(quadric, v0, v1, q);
+
+        vec3<T> x;
+        qem_optimal(q, p0, p1, x);
+
+        for (int i = 0; i < 3; ++i) {
+            coords(vh, i) = x[i];
+        }
+        for (uint32_t i = 0; i < qem_quadric_size; ++i) {
+            quadric(vh, i) = q[i];
+        }
+        boundary(vh)  = 0;
+        ring_cost(vh) = std::numeric_limits<T>::infinity();
+        ring_key(vh)  = INVALID32;
+
+        if constexpr (withUV) {
+            const vec3<T> d  = p1 - p0;
+            const T       l2 = glm::dot(d, d);
+            T t = (l2 > std::numeric_limits<T>::min()) ?
+                      glm::dot(x - p0, d) / l2 :
+                      T(0.5);
+            t   = t < T(0) ? T(0) : (t > T(1) ? T(1) : t);
+            for (int i = 0; i < 2; ++i) {
+                uv(vh, i) = (T(1) - t) * uv(v0, i) + t * uv(v1, i);
+            }
+        }
+    };
+
+    auto on_new_edge = [&](const EdgeHandle& eh) { cost(eh) = T(-1); };
+
+    if constexpr (withUV) {
+        apply_edge_ops<blockThreads>(block,
+                                     context,
+                                     shrd_alloc,
+                                     edge_op,
+                                     interpolate,
+                                     on_new_edge,
+                                     coords,
+                                     quadric,
+                                     boundary,
+                                     cost,
+                                     key,
+                                     ring_cost,
+                                     ring_key,
+                                     uv);
+    } else {
+        apply_edge_ops<blockThreads>(block,
+                                     context,
+                                     shrd_alloc,
+                                     edge_op,
+                                     interpolate,
+                                     on_new_edge,
+                                     coords,
+                                     quadric,
+                                     boundary,
+                                     cost,
+                                     key,
+                                     ring_cost,
+                                     ring_key);
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief quadric error metric (Garland and Heckbert, 1997) simplification on
+ * a dynamic mesh. Every vertex stores its quadric (as an attribute) which is
+ * computed once in the constructor and then the new vertex of every collapse
+ * gets the sum of the two end vertices quadrics. Every round
+ * 1) computes the cost and the optimal position of the new edges (one fused
+ * kernel that also builds a log-scale cost histogram)
+ * 2) picks a cost threshold from the histogram such that the candidate edges
+ * are enough to reach the target number of faces
+ * 3) selects every candidate edge that is the cheapest among the edges
+ * touching its end vertices one-ring and collapses them with apply_edge_ops()
+ * so that the cavities of the selected edges do not overlap.
+ *
+ * The selection only depends on (cost, key) where the key is a hash of the
+ * edge end vertices positions and ties are broken on the key. Since the
+ * selected edges are independent, they are collapsed regardless of which
+ * patch gets processed first and so the output does not depend on the timing
+ * of the patch locks nor on the patch layout. The quadrics are gathered from
+ * the faces in a fixed order (no atomics) for the same reason.
+ *
+ * Boundary vertices are never removed (the cavity of an edge collapse has to
+ * be closed) and so the mesh boundaries are preserved. Optionally, a per
+ * vertex uv (two components) is interpolated to the new vertices
+ *
+ * Example
+ * \code{.cpp}
+ * QEMSimplifier<float> qem(rx, *rx.get_input_vertex_coordinates());
+ * qem.simplify(rx.get_num_faces() / 10);
+ * rx.update_host();
+ * \endcode
+ */
+template <typename T>
+class QEMSimplifier
+{
+    static_assert(std::is_floating_point_v<T>,
+                  "QEMSimplifier only works with float or double");
+
+   public:
+    static constexpr uint32_t blockThreads = 256;
+
+    /**
+     * @brief constructor. Computes the vertex quadrics
+     * @param rx the mesh
+     * @param coords the vertex coordinates that will be updated by simplify()
+     * @param uv optional per-vertex uv (two components) interpolated to the
+     * new vertices
+     */
+    QEMSimplifier(RXMeshDynamic&            rx,
+                  const VertexAttribute<T>& coords,
+                  const VertexAttribute<T>* uv = nullptr)
+        : m_rx(rx),
+          m_coords(coords),
+          m_has_uv(uv != nullptr),
+          m_d_bins(nullptr),
+          m_num_rounds(0)
+    {
+        if (m_has_uv) {
+            m_uv = *uv;
+            if (m_uv.get_num_attributes() < 2) {
+                RXMESH_ERROR(
+                    "QEMSimplifier::QEMSimplifier() uv should have two "
+                    "components. uv will be ignored!");
+                m_has_uv = false;
+            }
+        }
+
+        m_h_bins.resize(detail::qem_num_bins, 0);
+        CUDA_ERROR(cudaMalloc((void**)&m_d_bins,
+                              detail::qem_num_bins * sizeof(uint32_t)));
+
+        m_quadric = *rx.add_vertex_attribute<T>(
+            "rx:qem_quadric", detail::qem_quadric_size, DEVICE);
+        m_boundary = *rx.add_vertex_attribute<uint8_t>("rx:qem_boundary", 1);
+        m_min_cost = *rx.add_vertex_attribute<T>("rx:qem_min_cost", 1, DEVICE);
+        m_min_key =
+            *rx.add_vertex_attribute<uint32_t>("rx:qem_min_key", 1, DEVICE);
+        m_ring_cost =
+            *rx.add_vertex_attribute<T>("rx:qem_ring_cost", 1, DEVICE);
+        m_ring_key =
+            *rx.add_vertex_attribute<uint32_t>("rx:qem_ring_key", 1, DEVICE);
+        m_cost = *rx.add_edge_attribute<T>("rx:qem_cost", 1, DEVICE);
+        m_key  = *rx.add_edge_attribute<uint32_t>("rx:qem_key", 1, DEVICE);
+
+        rx.get_boundary_vertices(m_boundary, false);
+
+        compute_quadrics();
+
+        // compute every edge cost in the first round
+        m_cost.reset(T(-1), DEVICE);
+    }
+
+    QEMSimplifier(const QEMSimplifier&)            = delete;
+    QEMSimplifier& operator=(const QEMSimplifier&) = delete;
+
+    ~QEMSimplifier()
+    {
+        release();
+    }
+
+    /**
+     * @brief collapse edges until the number of faces is at most
+     * target_num_faces or no edge has a cost below max_error. The last round
+     * may remove a few faces more than needed to reach the target since all
+     * the edges in a histogram bin are candidates. The caller should call
+     * update_host() to read the result on the host
+     * @param target_num_faces the target number of faces
+     * @param max_error the maximum quadric error of a collapse
+     * @return the number of faces after the simplification
+     */
+    uint32_t simplify(const uint32_t target_num_faces,
+                      const T        max_error = std::numeric_limits<T>::max())
+    {
+        uint32_t num_faces = m_rx.get_num_faces(true);
+
+        // if a round makes no progress (e.g., all the cheap edges violate the
+        // link condition), the next round considers every edge within
+        // max_error before giving up
+        bool widen = false;
+
+        while (num_faces > target_num_faces) {
+
+            const uint32_t num_candidates = compute_costs(max_error);
+            if (num_candidates == 0) {
+                break;
+            }
+
+            // every collapse removes two faces
+            const uint32_t needed = DIVIDE_UP(num_faces - target_num_faces, 2);
+
+            int max_bin = detail::qem_num_bins - 1;
+            if (!widen) {
+                uint32_t sum = 0;
+                for (int b = 0; b < detail::qem_num_bins; ++b) {
+                    sum += m_h_bins[b];
+                    if (sum >= needed) {
+                        max_bin = b;
+                        break;
+                    }
+                }
+            }
+
+            select(max_error, max_bin);
+
+            collapse();
+
+            m_num_rounds++;
+
+            const uint32_t new_num_faces = m_rx.get_num_faces(true);
+
+            if (new_num_faces == num_faces) {
+                if (widen || max_bin == detail::qem_num_bins - 1) {
+                    break;
+                }
+                widen = true;
+            } else {
+                widen = false;
+            }
+            num_faces = new_num_faces;
+        }
+
+        return num_faces;
+    }
+
+    /**
+     * @brief the number of rounds done by all calls to simplify()
+     */
+    uint32_t get_num_rounds() const
+    {
+        return m_num_rounds;
+    }
+
+    /**
+     * @brief the per-vertex quadrics (10 components: a2, ab, ac, ad, b2, bc,
+     * bd, c2, cd, d2)
+     */
+    const VertexAttribute<T>& get_quadrics() const
+    {
+        return m_quadric;
+    }
+
+    /**
+     * @brief free the memory and remove the attributes of the simplifier
+     */
+    void release()
+    {
+        if (m_d_bins == nullptr) {
+            return;
+        }
+        GPU_FREE(m_d_bins);
+        m_rx.remove_attribute(m_quadric.get_name());
+        m_rx.remove_attribute(m_boundary.get_name());
+        m_rx.remove_attribute(m_min_cost.get_name());
+        m_rx.remove_attribute(m_min_key.get_name());
+        m_rx.remove_attribute(m_ring_cost.get_name());
+        m_rx.remove_attribute(m_ring_key.get_name());
+        m_rx.remove_attribute(m_cost.get_name());
+        m_rx.remove_attribute(m_key.get_name());
+    }
+
+   private:
+    void compute_quadrics()
+    {
+        auto plane = m_rx.add_face_attribute<T>("rx:qem_plane", 4, DEVICE);
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box(
+            {Op::FV},
+            lb,
+            (void*)detail::qem_face_plane<T, blockThreads>,
+            false);
+        m_rx.run_query_kernel(lb,
+                              detail::qem_face_plane<T, blockThreads>,
+                              NULL,
+                              m_coords,
+                              *plane);
+
+        m_rx.prepare_launch_box(
+            {Op::VF},
+            lb,
+            (void*)detail::qem_vertex_quadric<T, blockThreads>,
+            false);
+        m_rx.run_query_kernel(lb,
+                              detail::qem_vertex_quadric<T, blockThreads>,
+                              NULL,
+                              *plane,
+                              m_quadric);
+
+        m_rx.remove_attribute(plane->get_name());
+    }
+
+    uint32_t compute_costs(const T max_error)
+    {
+        CUDA_ERROR(
+            cudaMemset(m_d_bins, 0, detail::qem_num_bins * sizeof(uint32_t)));
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box({Op::EV},
+                                lb,
+                                (void*)detail::qem_edge_cost<T, blockThreads>,
+                                false);
+        m_rx.run_query_kernel(lb,
+                              detail::qem_edge_cost<T, blockThreads>,
+                              NULL,
+                              m_coords,
+                              m_quadric,
+                              m_boundary,
+                              m_cost,
+                              m_key,
+                              max_error,
+                              m_d_bins);
+
+        CUDA_ERROR(cudaMemcpy(m_h_bins.data(),
+                              m_d_bins,
+                              detail::qem_num_bins * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+
+        uint32_t total = 0;
+        for (const uint32_t b : m_h_bins) {
+            total += b;
+        }
+        return total;
+    }
+
+    void select(const T max_error, const int max_bin)
+    {
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box({Op::VE},
+                                lb,
+                                (void*)detail::qem_vertex_min<T, blockThreads>,
+                                false);
+        m_rx.run_query_kernel(lb,
+                              detail::qem_vertex_min<T, blockThreads>,
+                              NULL,
+                              m_cost,
+                              m_key,
+                              max_error,
+                              max_bin,
+                              m_min_cost,
+                              m_min_key);
+
+        m_rx.prepare_launch_box({Op::VV},
+                                lb,
+                                (void*)detail::qem_ring_min<T, blockThreads>,
+                                false);
+        m_rx.run_query_kernel(lb,
+                              detail::qem_ring_min<T, blockThreads>,
+                              NULL,
+                              m_min_cost,
+                              m_min_key,
+                              m_ring_cost,
+                              m_ring_key);
+    }
+
+    void collapse()
+    {
+        if (m_has_uv) {
+            collapse<true>();
+        } else {
+            collapse<false>();
+        }
+    }
+
+    template <bool withUV>
+    void collapse()
+    {
+        auto kernel = detail::qem_collapse<T, blockThreads, withUV>;
+
+        m_rx.reset_scheduler();
+        while (!m_rx.is_queue_empty()) {
+            LaunchBox<blockThreads> lb;
+            m_rx.update_launch_box({Op::EVDiamond},
+                                   lb,
+                                   (void*)kernel,
+                                   true,
+                                   false,
+                                   false,
+                                   false,
+                                   edge_ops_shmem_bytes);
+
+            kernel<<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                m_rx.get_context(),
+                m_coords,
+                m_quadric,
+                m_boundary,
+                m_cost,
+                m_key,
+                m_ring_cost,
+                m_ring_key,
+                m_uv);
+
+            m_rx.cleanup();
+            if constexpr (withUV) {
+                m_rx.slice_patches(m_coords,
+                                   m_quadric,
+                                   m_boundary,
+                                   m_cost,
+                                   m_key,
+                                   m_ring_cost,
+                                   m_ring_key,
+                                   m_uv);
+            } else {
+                m_rx.slice_patches(m_coords,
+                                   m_quadric,
+                                   m_boundary,
+                                   m_cost,
+                                   m_key,
+                                   m_ring_cost,
+                                   m_ring_key);
+            }
+            m_rx.cleanup();
+        }
+        CUDA_ERROR(cudaGetLastError());
+    }
+
+    RXMeshDynamic&            m_rx;
+    VertexAttribute<T>        m_coords;
+    VertexAttribute<T>        m_uv;
+    bool                      m_has_uv;
+    VertexAttribute<T>        m_quadric;
+    VertexAttribute<uint8_t>  m_boundary;
+    VertexAttribute<T>        m_min_cost;
+    VertexAttribute<uint32_t> m_min_key;
+    VertexAttribute<T>        m_ring_cost;
+    VertexAttribute<uint32_t> m_ring_key;
+    EdgeAttribute<T>          m_cost;
+    EdgeAttribute<uint32_t>   m_key;
+    uint32_t*                 m_d_bins;
+    std::vector<uint32_t>     m_h_bins;
+    uint32_t                  m_num_rounds;
+};
+}  // namespace rxmesh
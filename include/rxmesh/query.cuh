@@ -5,6 +5,8 @@
 
 #include "rxmesh/context.h"
 #include "rxmesh/handle.h"
+#include "rxmesh/kernels/bounded_queries.cuh"
+#include "rxmesh/kernels/k_ring.cuh"
 #include "rxmesh/kernels/query_dispatcher.cuh"
 #include "rxmesh/kernels/shmem_allocator.cuh"
 #include "rxmesh/types.h"
@@ -12,23 +14,137 @@
 
 namespace rxmesh {
 
-template <uint32_t blockThreads>
+namespace detail {
+/**
+ * @brief number of output elements per source element of queries with fixed
+ * size output (e.g., 3 for FV) or zero if the output size varies and offsets
+ * are used
+ */
+__device__ __host__ constexpr uint32_t query_fixed_offset(const Op op)
+{
+    return ((op == Op::EV) ? 2 :
+                             ((op == Op::FV || op == Op::FE) ?
+                                  3 :
+                                  ((op == Op::EVDiamond) ? 4 : 0)));
+}
+
+/**
+ * @brief index of the mesh element type of a handle i.e., 0 for vertices, 1
+ * for edges, and 2 for faces
+ */
+template <typename HandleT>
+__device__ __host__ constexpr int handle_id()
+{
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        return 0;
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        return 1;
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        return 2;
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief a query stage in a query chain (see Query::dispatch_chain). Should be
+ * created using query_stage()
+ */
+template <Op op, typename computeT, typename activeSetT>
+struct QueryStage
+{
+    static constexpr Op query_op = op;
+    computeT            compute_op;
+    activeSetT          compute_active_set;
+    bool                oriented;
+};
+
+/**
+ * @brief a stage in a query chain (see Query::dispatch_chain) that runs a
+ * lambda function on every active and owned mesh element of type HandleT in
+ * the patch (similar to RXMeshStatic::for_each). Should be created using
+ * element_stage()
+ */
+template <typename HandleT, typename applyT>
+struct ElementStage
+{
+    applyT apply;
+};
+
+/**
+ * @brief create a query stage that runs compute_op on the output of query op
+ * (same as Query::dispatch)
+ */
+template <Op op, typename computeT>
+__device__ __inline__ auto query_stage(computeT   compute_op,
+                                       const bool oriented = false)
+{
+    using ComputeTraits  = detail::FunctionTraits<computeT>;
+    using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+
+    auto all = [](ComputeHandleT) { return true; };
+    return QueryStage<op, computeT, decltype(all)>{compute_op, all, oriented};
+}
+
+/**
+ * @brief create a query stage that runs compute_op on the output of query op
+ * for the active set defined by compute_active_set (same as Query::dispatch)
+ */
+template <Op op, typename computeT, typename activeSetT>
+__device__ __inline__ auto query_stage(computeT   compute_op,
+                                       activeSetT compute_active_set,
+                                       const bool oriented = false)
+{
+    return QueryStage<op, computeT, activeSetT>{
+        compute_op, compute_active_set, oriented};
+}
+
+/**
+ * @brief create a stage that runs apply(HandleT) on every active and owned
+ * element of type HandleT in the patch
+ */
+template <typename HandleT, typename applyT>
+__device__ __inline__ auto element_stage(applyT apply)
+{
+    return ElementStage<HandleT, applyT>{apply};
+}
+
+/**
+ * @brief queries of the patch assigned to this block. queryEngine is the
+ * engine of the transpose queries (see QueryEngine) and the kernel should be
+ * launched with a LaunchBox with the same engine such that the shared memory
+ * matches
+ */
+template <uint32_t blockThreads, QueryEngine queryEngine = QueryEngine::Block>
 struct Query
 {
     Query(const Query&)            = delete;
     Query& operator=(const Query&) = delete;
 
+    /**
+     * @brief constructor for the patch pid. If pid is INVALID32, the patch
+     * assigned to this block is used (see Context::get_block_patch_id)
+     */
     __device__ __inline__ Query(const Context& context,
-                                const uint32_t pid = blockIdx.x)
+                                const uint32_t pid = INVALID32)
         : m_context(context),
-          m_patch_info(context.m_patches_info[pid]),
+          m_patch_info(
+              context.m_patches_info[pid == INVALID32 ?
+                                         context.get_block_patch_id() :
+                                         pid]),
           m_num_src_in_patch(0),
           m_s_participant_bitmask(nullptr),
           m_s_output_owned_bitmask(nullptr),
           m_s_output_offset(nullptr),
           m_s_output_value(nullptr),
           m_s_valence(nullptr),
-          m_s_table(nullptr)
+          m_s_table(nullptr),
+          m_s_cached_owned_bitmask{nullptr, nullptr, nullptr},
+          m_s_cached_table{nullptr, nullptr, nullptr},
+          m_s_cached_ev(nullptr),
+          m_s_cached_fe(nullptr),
+          m_shmem_before_cache(INVALID32)
     {
     }
 
@@ -235,6 +351,28 @@ struct Query
         m_op           = op;
         m_shmem_before = shrd_alloc.get_allocated_size_bytes();
 
+        const detail::QueryCacheEntry* cache =
+            m_context.get_query_cache(op, oriented);
+        if (cache != nullptr) {
+            detail::query_block_cached_dispatcher<op, blockThreads>(
+                block,
+                shrd_alloc,
+                m_patch_info,
+                *cache,
+                compute_active_set,
+                m_num_src_in_patch,
+                m_s_output_offset,
+                m_s_output_value,
+                m_s_participant_bitmask,
+                m_s_output_owned_bitmask,
+                m_output_lp_hashtable,
+                m_s_table,
+                allow_not_owned,
+                m_s_cached_owned_bitmask[detail::query_output_id(op)],
+                m_s_cached_table[detail::query_output_id(op)]);
+            return;
+        }
+
         detail::query_block_dispatcher<op, blockThreads>(
             block,
             shrd_alloc,
@@ -248,7 +386,12 @@ struct Query
             m_s_output_owned_bitmask,
             m_output_lp_hashtable,
             m_s_table,
-            allow_not_owned);
+            allow_not_owned,
+            m_s_cached_owned_bitmask[detail::query_output_id(op)],
+            m_s_cached_table[detail::query_output_id(op)],
+            queryEngine,
+            m_s_cached_ev,
+            m_s_cached_fe);
     }
 
 
@@ -289,11 +432,7 @@ struct Query
     template <typename IteratorT>
     __device__ __inline__ IteratorT get_iterator(uint16_t local_id) const
     {
-        const uint32_t fixed_offset =
-            ((m_op == Op::EV) ? 2 :
-                                ((m_op == Op::FV || m_op == Op::FE) ?
-                                     3 :
-                                     ((m_op == Op::EVDiamond) ? 4 : 0)));
+        const uint32_t fixed_offset = detail::query_fixed_offset(m_op);
 
         using LocalT = typename IteratorT::LocalT;
 
@@ -315,6 +454,34 @@ struct Query
     }
 
 
+    /**
+     * @brief number of source elements of the last query operation done by
+     * prologue() in this patch or zero if no element participates in it
+     */
+    __device__ __inline__ uint32_t get_num_src_in_patch() const
+    {
+        return m_num_src_in_patch;
+    }
+
+    /**
+     * @brief the offsets of the output of the last query operation done by
+     * prologue() or nullptr for queries with fixed size output (see
+     * detail::query_fixed_offset)
+     */
+    __device__ __inline__ const uint16_t* get_output_offset() const
+    {
+        return m_s_output_offset;
+    }
+
+    /**
+     * @brief the local index of the output of the last query operation done
+     * by prologue() in the compact format produced by the query
+     */
+    __device__ __inline__ const uint16_t* get_output_value() const
+    {
+        return m_s_output_value;
+    }
+
     /**
      * @brief free up shared memory allocated to store the query operations.
      */
@@ -332,7 +499,366 @@ struct Query
         m_s_table                = nullptr;
     }
 
+    /**
+     * @brief load the owned bitmask and LP hashtable of the mesh element of
+     * type HandleT in shared memory once such that all subsequent queries
+     * whose output is of this type (e.g., VV and FV for VertexHandle) reuse
+     * them instead of loading them again. Should be called by the whole block
+     * and the cache lives until release_cache() is called
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     * @param with_wait if we should wait for the loading to finish
+     */
+    template <typename HandleT>
+    __device__ __inline__ void cache_output(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const bool                        with_wait = true)
+    {
+        constexpr int id = detail::handle_id<HandleT>();
+        if (m_s_cached_table[id] != nullptr) {
+            return;
+        }
+
+        if (m_shmem_before_cache == INVALID32) {
+            m_shmem_before_cache = shrd_alloc.get_allocated_size_bytes();
+        }
+
+        const uint32_t mask_size = detail::mask_num_bytes(
+            m_patch_info.template get_num_elements<HandleT>()[0]);
+        m_s_cached_owned_bitmask[id] =
+            reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+        detail::load_async(
+            reinterpret_cast<const char*>(
+                m_patch_info.template get_owned_mask<HandleT>()),
+            mask_size,
+            reinterpret_cast<char*>(m_s_cached_owned_bitmask[id]),
+            false);
+
+        const LPHashTable& table = m_patch_info.template get_lp<HandleT>();
+        m_s_cached_table[id] = shrd_alloc.alloc<LPPair>(table.get_capacity());
+        table.load_in_shared_memory(m_s_cached_table[id], with_wait);
+        if (with_wait) {
+            block.sync();
+        }
+    }
+
+    /**
+     * @brief load EV and FE of the patch in shared memory once such that all
+     * subsequent queries copy them from there instead of loading them again
+     * from global memory. The cached copy is never modified i.e., every query
+     * still transposes its own copy. Should be called by the whole block and
+     * the cache lives until release_cache() is called
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     * @param with_wait if we should wait for the loading to finish
+     */
+    __device__ __inline__ void cache_topology(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const bool                        with_wait = true)
+    {
+        if (m_s_cached_ev != nullptr) {
+            return;
+        }
+
+        if (m_shmem_before_cache == INVALID32) {
+            m_shmem_before_cache = shrd_alloc.get_allocated_size_bytes();
+        }
+
+        const uint16_t num_edges = m_patch_info.num_edges[0];
+        const uint16_t num_faces = m_patch_info.num_faces[0];
+
+        m_s_cached_ev = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+        m_s_cached_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+        detail::load_async(block,
+                           reinterpret_cast<const uint16_t*>(m_patch_info.ev),
+                           2 * num_edges,
+                           m_s_cached_ev,
+                           false);
+        detail::load_async(block,
+                           reinterpret_cast<const uint16_t*>(m_patch_info.fe),
+                           3 * num_faces,
+                           m_s_cached_fe,
+                           with_wait);
+        if (with_wait) {
+            block.sync();
+        }
+    }
+
+    /**
+     * @brief free up the shared memory used by cache_output() and
+     * cache_topology(). Should be called by the whole block with the cache
+     * being the last allocation on shrd_alloc
+     */
+    __device__ __inline__ void release_cache(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc)
+    {
+        if (m_shmem_before_cache == INVALID32) {
+            return;
+        }
+        block.sync();
+        shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() -
+                           m_shmem_before_cache);
+        for (int id = 0; id < 3; ++id) {
+            m_s_cached_owned_bitmask[id] = nullptr;
+            m_s_cached_table[id]         = nullptr;
+        }
+        m_s_cached_ev        = nullptr;
+        m_s_cached_fe        = nullptr;
+        m_shmem_before_cache = INVALID32;
+    }
+
+    /**
+     * @brief run a chain of stages on the patch of this block within the same
+     * kernel e.g., FV then VV then a per-vertex lambda function. The stages
+     * are created by query_stage() and element_stage(). The owned bitmask and
+     * LP hashtable of the output of every query stage are loaded in shared
+     * memory once (see cache_output()) and shared by all stages instead of
+     * being re-loaded by every query. Similarly, EV and FE of the patch are
+     * loaded once (see cache_topology()) and every query stage runs its
+     * transpose from this copy. The block is synchronized between
+     * stages so a stage can consume what the previous stages have written to
+     * shared memory or to attributes for this patch. Note that only the
+     * elements of this patch are visible to later stages i.e., a stage should
+     * not read a value written by a previous stage for an element owned by
+     * another patch. The shared memory needed by the chain is computed by
+     * RXMeshStatic::prepare_launch_box_chain()
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     * @param stages the stages to run in order
+     */
+    template <typename... StageT>
+    __device__ __inline__ void dispatch_chain(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        StageT... stages)
+    {
+        (cache_stage(block, shrd_alloc, stages), ...);
+        cooperative_groups::wait(block);
+        block.sync();
+
+        (run_stage(block, shrd_alloc, stages), ...);
+
+        release_cache(block, shrd_alloc);
+    }
+
+    /**
+     * @brief k-ring neighborhood query where compute_op(VertexHandle,
+     * KRingIterator) is called on every owned and active vertex of the patch
+     * with the (de-duplicated) vertices within k edges from it. The rings are
+     * expanded through the ribbon within this kernel by reading the VV query
+     * cache in global memory (see RXMeshStatic::cache_query) and mapping the
+     * not-owned vertices to their owner patch. So there is no kernel launch
+     * per ring and no global scratch memory. Every thread stores the k-ring
+     * of its vertex in shared memory with at most capacity vertices (see
+     * KRingIterator::is_truncated). The launch box should be prepared by
+     * RXMeshStatic::prepare_launch_box_k_ring() with the same k and capacity
+     * and the kernel should be launched by RXMeshStatic::run_k_ring_kernel()
+     * which makes sure VV is still cached
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     * @param k the number of rings
+     * @param capacity the maximum number of vertices in the k-ring of a vertex
+     * @param compute_op the computation lambda function
+     * @param compute_active_set a predicate used to specify the active set
+     */
+    template <typename computeT, typename activeSetT>
+    __device__ __inline__ void dispatch_k_ring(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const uint16_t                    k,
+        const uint16_t                    capacity,
+        computeT                          compute_op,
+        activeSetT                        compute_active_set)
+    {
+        // VV is cached on the host by RXMeshStatic::run_k_ring_kernel()
+        const detail::QueryCacheEntry* vv =
+            m_context.get_query_cache(Op::VV, false);
+        assert(vv != nullptr);
+
+        const uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+        VertexHandle* s_ring =
+            shrd_alloc.alloc<VertexHandle>(blockThreads * capacity);
+        uint16_t* s_ring_end = shrd_alloc.alloc<uint16_t>(blockThreads * k);
+
+        const uint16_t num_vertices = m_patch_info.num_vertices[0];
+
+        for (uint16_t v = threadIdx.x; v < num_vertices; v += blockThreads) {
+            const VertexHandle vh(m_patch_info.patch_id, v);
+            if (detail::is_deleted(v, m_patch_info.active_mask_v) ||
+                !detail::is_owned(v, m_patch_info.owned_mask_v) ||
+                !compute_active_set(vh)) {
+                continue;
+            }
+            KRingIterator iter = detail::k_ring(m_context,
+                                                *vv,
+                                                vh,
+                                                k,
+                                                capacity,
+                                                blockThreads,
+                                                s_ring + threadIdx.x,
+                                                s_ring_end + threadIdx.x);
+            compute_op(vh, iter);
+        }
+
+        block.sync();
+        shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() -
+                           shmem_before);
+    }
+
+    /**
+     * @brief k-ring neighborhood query on all owned and active vertices of
+     * the patch (see the other overload)
+     */
+    template <typename computeT>
+    __device__ __inline__ void dispatch_k_ring(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const uint16_t                    k,
+        const uint16_t                    capacity,
+        computeT                          compute_op)
+    {
+        dispatch_k_ring(block,
+                        shrd_alloc,
+                        k,
+                        capacity,
+                        compute_op,
+                        [](VertexHandle) { return true; });
+    }
+
+    /**
+     * @brief same as dispatch() but specialized at compile time for meshes
+     * whose vertex valence is at most maxValence. Only Op::VV and Op::VE are
+     * supported. The incident edges of every vertex are computed in
+     * fixed-size rows without a transpose or an offset array and every
+     * thread gets its output in a FixedIterator (FixedVertexIterator for VV
+     * and FixedEdgeIterator for VE) that holds the local indices in
+     * registers. compute_op takes (VertexHandle, FixedIterator) and could be
+     * a generic lambda. The launch box should be prepared by
+     * RXMeshStatic::prepare_launch_box_bounded() and the mesh should be
+     * checked first by RXMeshStatic::is_valence_bounded() e.g., to launch a
+     * kernel that uses dispatch() otherwise
+     * @tparam op the type of query operation (Op::VV or Op::VE)
+     * @tparam maxValence the maximum vertex valence
+     * @tparam oriented if the output is oriented
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     * @param compute_op the computation lambda function
+     * @param compute_active_set a predicate used to specify the active set
+     */
+    template <Op       op,
+              uint32_t maxValence,
+              bool     oriented = false,
+              typename computeT,
+              typename activeSetT>
+    __device__ __inline__ void dispatch_bounded(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        computeT                          compute_op,
+        activeSetT                        compute_active_set)
+    {
+        constexpr int id = detail::query_output_id(op);
+
+        detail::query_block_bounded_dispatcher<op,
+                                               blockThreads,
+                                               maxValence,
+                                               oriented>(
+            block,
+            shrd_alloc,
+            m_context,
+            m_patch_info,
+            compute_op,
+            compute_active_set,
+            m_s_cached_owned_bitmask[id],
+            m_s_cached_table[id]);
+    }
+
+    /**
+     * @brief specialized query for meshes with bounded valence on all
+     * active and owned vertices of the patch (see the other overload)
+     */
+    template <Op       op,
+              uint32_t maxValence,
+              bool     oriented = false,
+              typename computeT>
+    __device__ __inline__ void dispatch_bounded(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        computeT                          compute_op)
+    {
+        dispatch_bounded<op, maxValence, oriented>(
+            block, shrd_alloc, compute_op, [](VertexHandle) { return true; });
+    }
+
    private:
+    template <Op op, typename computeT, typename activeSetT>
+    __device__ __inline__ void cache_stage(
+        cooperative_groups::thread_block&           block,
+        ShmemAllocator&                             shrd_alloc,
+        const QueryStage<op, computeT, activeSetT>& stage)
+    {
+        cache_topology(block, shrd_alloc, false);
+
+        constexpr int id = detail::query_output_id(op);
+        if constexpr (id == 0) {
+            cache_output<VertexHandle>(block, shrd_alloc, false);
+        }
+        if constexpr (id == 1) {
+            cache_output<EdgeHandle>(block, shrd_alloc, false);
+        }
+        if constexpr (id == 2) {
+            cache_output<FaceHandle>(block, shrd_alloc, false);
+        }
+    }
+
+    template <typename HandleT, typename applyT>
+    __device__ __inline__ void cache_stage(
+        cooperative_groups::thread_block&    block,
+        ShmemAllocator&                      shrd_alloc,
+        const ElementStage<HandleT, applyT>& stage)
+    {
+    }
+
+    template <Op op, typename computeT, typename activeSetT>
+    __device__ __inline__ void run_stage(
+        cooperative_groups::thread_block&           block,
+        ShmemAllocator&                             shrd_alloc,
+        const QueryStage<op, computeT, activeSetT>& stage)
+    {
+        dispatch<op>(block,
+                     shrd_alloc,
+                     stage.compute_op,
+                     stage.compute_active_set,
+                     stage.oriented);
+        block.sync();
+    }
+
+    template <typename HandleT, typename applyT>
+    __device__ __inline__ void run_stage(
+        cooperative_groups::thread_block&    block,
+        ShmemAllocator&                      shrd_alloc,
+        const ElementStage<HandleT, applyT>& stage)
+    {
+        const uint16_t  num_elements =
+            m_patch_info.template get_num_elements<HandleT>()[0];
+        const uint32_t* active_mask =
+            m_patch_info.template get_active_mask<HandleT>();
+        const uint32_t* owned_mask =
+            m_patch_info.template get_owned_mask<HandleT>();
+
+        for (uint16_t i = threadIdx.x; i < num_elements; i += blockThreads) {
+            if (!detail::is_deleted(i, active_mask) &&
+                detail::is_owned(i, owned_mask)) {
+                stage.apply(HandleT(m_patch_info.patch_id, i));
+            }
+        }
+        block.sync();
+    }
+
+
     const Context&   m_context;
     const PatchInfo& m_patch_info;
     uint32_t         m_shmem_before;
@@ -345,5 +871,10 @@ struct Query
     LPHashTable      m_output_lp_hashtable;
     LPPair*          m_s_table;
     Op               m_op;
+    uint32_t*        m_s_cached_owned_bitmask[3];
+    LPPair*          m_s_cached_table[3];
+    uint16_t*        m_s_cached_ev;
+    uint16_t*        m_s_cached_fe;
+    uint32_t         m_shmem_before_cache;
 };
 }  // namespace rxmesh
\ No newline at end of file
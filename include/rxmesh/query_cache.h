@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/types.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief number of slots in the query cache i.e., one for every query
+ * operation and orientation
+ */
+static constexpr int num_query_cache_slots = 2 * (int(Op::EVDiamond) + 1);
+
+/**
+ * @brief the slot of a query operation in the query cache
+ */
+__device__ __host__ constexpr int query_cache_slot(const Op   op,
+                                                   const bool oriented)
+{
+    return 2 * int(op) + int(oriented);
+}
+
+/**
+ * @brief index of the mesh element type of the output of a query i.e., 0 for
+ * vertices, 1 for edges, and 2 for faces
+ */
+__device__ __host__ constexpr int query_output_id(const Op op)
+{
+    switch (op) {
+        case Op::VV:
+        case Op::EV:
+        case Op::FV:
+        case Op::EVDiamond:
+            return 0;
+        case Op::VE:
+        case Op::EE:
+        case Op::FE:
+            return 1;
+        case Op::VF:
+        case Op::EF:
+        case Op::FF:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief the output of one query operation over all patches stored in global
+ * memory in the same compact format the query produces in shared memory (see
+ * RXMeshStatic::cache_query). The offset and value of patch p start at
+ * d_offset_start[p] and d_value_start[p] resp. Queries with a fixed number of
+ * output per source element (e.g., FV) do not store offsets
+ */
+struct QueryCacheEntry
+{
+    __device__ __host__ QueryCacheEntry()
+        : d_offset_start(nullptr),
+          d_value_start(nullptr),
+          d_offset(nullptr),
+          d_value(nullptr),
+          num_bytes(0)
+    {
+    }
+
+    __device__ __host__ __inline__ bool is_valid() const
+    {
+        return d_value != nullptr;
+    }
+
+    uint32_t* d_offset_start;
+    uint32_t* d_value_start;
+    uint16_t* d_offset;
+    uint16_t* d_value;
+    size_t    num_bytes;
+};
+}  // namespace detail
+}  // namespace rxmesh
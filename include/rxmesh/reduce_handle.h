@@ -1,5 +1,12 @@
 #pragma once
 
+#include <utility>
+#include <vector>
+
+#include <cub/device/device_segmented_reduce.cuh>
+
+#include <thrust/iterator/permutation_iterator.h>
+
 #include "rxmesh/attribute.h"
 #include "rxmesh/kernels/attribute.cuh"
 
@@ -18,6 +25,13 @@ class ReduceHandle
    public:
     using HandleType = HandleT;
     using Type       = T;
+    using DotPair =
+        std::pair<const Attribute<T, HandleT>*, const Attribute<T, HandleT>*>;
+
+    /**
+     * @brief maximum number of dot products computed by one multi_dot() call
+     */
+    static constexpr uint32_t max_multi_ops = 4;
 
     ReduceHandle()                    = default;
     ReduceHandle(const ReduceHandle&) = default;
@@ -45,6 +59,30 @@ class ReduceHandle
 
         CUDA_ERROR(
             cudaMalloc(&m_d_reduce_temp_storage, m_reduce_temp_storage_bytes));
+
+        // multi_dot() reduces every operand as one segment of the 1st stage
+        CUDA_ERROR(cudaMalloc(&m_d_multi_1st_stage,
+                              max_multi_ops * m_max_num_patches * sizeof(T)));
+        CUDA_ERROR(cudaMalloc(&m_d_multi_2nd_stage, max_multi_ops * sizeof(T)));
+        CUDA_ERROR(
+            cudaMalloc(&m_d_multi_offsets, (max_multi_ops + 1) * sizeof(int)));
+        int h_offsets[max_multi_ops + 1];
+        for (uint32_t o = 0; o <= max_multi_ops; ++o) {
+            h_offsets[o] = o * m_max_num_patches;
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_multi_offsets,
+                              h_offsets,
+                              (max_multi_ops + 1) * sizeof(int),
+                              cudaMemcpyHostToDevice));
+        cub::DeviceSegmentedReduce::Sum(m_d_multi_temp_storage,
+                                        m_multi_temp_storage_bytes,
+                                        m_d_multi_1st_stage,
+                                        m_d_multi_2nd_stage,
+                                        max_multi_ops,
+                                        m_d_multi_offsets,
+                                        m_d_multi_offsets + 1);
+        CUDA_ERROR(
+            cudaMalloc(&m_d_multi_temp_storage, m_multi_temp_storage_bytes));
     }
 
     ~ReduceHandle()
@@ -52,7 +90,16 @@ class ReduceHandle
         GPU_FREE(m_d_reduce_1st_stage);
         GPU_FREE(m_d_reduce_2nd_stage);
         GPU_FREE(m_d_reduce_temp_storage);
-        m_reduce_temp_storage_bytes = 0;
+        GPU_FREE(m_d_multi_1st_stage);
+        GPU_FREE(m_d_multi_2nd_stage);
+        GPU_FREE(m_d_multi_offsets);
+        GPU_FREE(m_d_multi_temp_storage);
+        GPU_FREE(m_d_segment_output);
+        GPU_FREE(m_d_segment_temp_storage);
+        m_reduce_temp_storage_bytes  = 0;
+        m_multi_temp_storage_bytes   = 0;
+        m_segment_temp_storage_bytes = 0;
+        m_segment_output_size        = 0;
     }
 
     /**
@@ -70,21 +117,7 @@ class ReduceHandle
           uint32_t                     attribute_id = INVALID32,
           cudaStream_t                 stream       = NULL)
     {
-        if ((attr1.get_allocated() & DEVICE) != DEVICE ||
-            (attr2.get_allocated() & DEVICE) != DEVICE) {
-            RXMESH_ERROR(
-                "ReduceHandle::dot() input attributes to should be "
-                "allocated on the device");
-        }
-
-        detail::dot_kernel<T, attr1.m_block_size>
-            <<<m_max_num_patches, attr1.m_block_size, 0, stream>>>(
-                attr1,
-                attr2,                
-                m_max_num_patches,
-                attr1.get_num_attributes(),
-                m_d_reduce_1st_stage,
-                attribute_id);
+        dot_1st_stage(attr1, attr2, attribute_id, stream);
 
         return reduce_2nd_stage(stream, cub::Sum(), 0);
     }
@@ -102,19 +135,7 @@ class ReduceHandle
             uint32_t                     attribute_id = INVALID32,
             cudaStream_t                 stream       = NULL)
     {
-        if ((attr.get_allocated() & DEVICE) != DEVICE) {
-            RXMESH_ERROR(
-                "ReduceHandle::norm2() input attribute to should be "
-                "allocated on the device");
-        }
-
-        detail::norm2_kernel<T, attr.m_block_size>
-            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
-                attr,                
-                m_max_num_patches,
-                attr.get_num_attributes(),
-                m_d_reduce_1st_stage,
-                attribute_id);
+        norm2_1st_stage(attr, attribute_id, stream);
 
         return std::sqrt(reduce_2nd_stage(stream, cub::Sum(), 0));
     }
@@ -153,6 +174,310 @@ class ReduceHandle
              T                            init,
              uint32_t                     attribute_id = INVALID32,
              cudaStream_t                 stream       = NULL)
+    {
+        reduce_1st_stage(attr, reduction_op, init, attribute_id, stream);
+
+        return reduce_2nd_stage(stream, reduction_op, init);
+    }
+
+    /**
+     * @brief same as dot() but the output is written to device memory and
+     * there is no synchronization with the host so it can be used inside a
+     * captured CUDAGraph
+     * @param d_output device pointer where the output is written
+     */
+    void dot_on_device(const Attribute<T, HandleT>& attr1,
+                       const Attribute<T, HandleT>& attr2,
+                       T*                           d_output,
+                       uint32_t                     attribute_id = INVALID32,
+                       cudaStream_t                 stream       = NULL)
+    {
+        dot_1st_stage(attr1, attr2, attribute_id, stream);
+        reduce_2nd_stage_on_device(stream, cub::Sum(), 0, d_output);
+    }
+
+    /**
+     * @brief same as norm2() but the output is written to device memory (see
+     * dot_on_device)
+     * @param d_output device pointer where the output is written
+     */
+    void norm2_on_device(const Attribute<T, HandleT>& attr,
+                         T*                           d_output,
+                         uint32_t                     attribute_id = INVALID32,
+                         cudaStream_t                 stream       = NULL)
+    {
+        norm2_1st_stage(attr, attribute_id, stream);
+        reduce_2nd_stage_on_device(stream, cub::Sum(), 0, d_output);
+        detail::sqrt_in_place<<<1, 1, 0, stream>>>(d_output);
+    }
+
+    /**
+     * @brief same as reduce() but the output is written to device memory (see
+     * dot_on_device)
+     * @param d_output device pointer where the output is written
+     */
+    template <typename ReductionOp>
+    void reduce_on_device(const Attribute<T, HandleT>& attr,
+                          ReductionOp                  reduction_op,
+                          T                            init,
+                          T*                           d_output,
+                          uint32_t                     attribute_id = INVALID32,
+                          cudaStream_t                 stream       = NULL)
+    {
+        reduce_1st_stage(attr, reduction_op, init, attribute_id, stream);
+        reduce_2nd_stage_on_device(stream, reduction_op, init, d_output);
+    }
+
+    /**
+     * @brief compute several dot products in a single pass over the patches
+     * followed by a single segmented reduction and a single copy to the host,
+     * instead of one pass, one reduction and one synchronization per dot
+     * product. A squared norm is the dot product of an attribute with itself
+     * e.g.,
+     *
+     *   T out[2];
+     *   reduce_handle.multi_dot({{&r, &r}, {&p, &s}}, out);
+     *   // out[0] = |r|^2, out[1] = <p, s>
+     *
+     * All attributes should be defined on the same mesh elements. The
+     * attributes of a pair should have the same number of attributes
+     * @param ops up to max_multi_ops pairs of attributes
+     * @param h_output host array of ops.size() values
+     * @param stream stream to run the computation on
+     */
+    void multi_dot(const std::vector<DotPair>& ops,
+                   T*                          h_output,
+                   cudaStream_t                stream = NULL)
+    {
+        multi_dot_on_device(ops, m_d_multi_2nd_stage, stream);
+        CUDA_ERROR(cudaMemcpyAsync(h_output,
+                                   m_d_multi_2nd_stage,
+                                   ops.size() * sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    /**
+     * @brief same as multi_dot() but the outputs are written to device memory
+     * and there is no synchronization with the host
+     * @param d_output device array of ops.size() values
+     */
+    void multi_dot_on_device(const std::vector<DotPair>& ops,
+                             T*                          d_output,
+                             cudaStream_t                stream = NULL)
+    {
+        if (ops.empty() || ops.size() > max_multi_ops) {
+            RXMESH_ERROR(
+                "ReduceHandle::multi_dot() the number of dot products ({}) "
+                "should be in [1, {}]",
+                ops.size(),
+                max_multi_ops);
+            return;
+        }
+
+        detail::MultiDotOperands<T, HandleT, max_multi_ops> operands;
+        operands.num_ops = ops.size();
+        for (uint32_t o = 0; o < ops.size(); ++o) {
+            if ((ops[o].first->get_allocated() & DEVICE) != DEVICE ||
+                (ops[o].second->get_allocated() & DEVICE) != DEVICE) {
+                RXMESH_ERROR(
+                    "ReduceHandle::multi_dot() input attributes to should be "
+                    "allocated on the device");
+                return;
+            }
+            if (ops[o].first->get_num_attributes() !=
+                ops[o].second->get_num_attributes()) {
+                RXMESH_ERROR(
+                    "ReduceHandle::multi_dot() the attributes of pair {} have "
+                    "different number of attributes",
+                    o);
+                return;
+            }
+            operands.x[o] = *ops[o].first;
+            operands.y[o] = *ops[o].second;
+        }
+
+        run_1st_stage(
+            *ops[0].first,
+            stream,
+            [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                detail::multi_dot_kernel<T, m_block_size, HandleT>
+                    <<<count, m_block_size, 0, s>>>(operands,
+                                                    m_max_num_patches,
+                                                    m_d_multi_1st_stage,
+                                                    begin);
+            });
+
+        cub::DeviceSegmentedReduce::Sum(m_d_multi_temp_storage,
+                                        m_multi_temp_storage_bytes,
+                                        m_d_multi_1st_stage,
+                                        d_output,
+                                        int(ops.size()),
+                                        m_d_multi_offsets,
+                                        m_d_multi_offsets + 1,
+                                        stream);
+    }
+
+    /**
+     * @brief generic reduction (see reduce()) over groups (segments) of
+     * patches i.e., one output per segment in a single pass over all patches
+     * e.g., the per-mesh reduction of RXMeshBatch. The patches of segment s
+     * are d_segment_patches[d_segment_offsets[s]] to
+     * d_segment_patches[d_segment_offsets[s + 1] - 1]
+     * @param num_segments number of segments
+     * @param d_segment_offsets device array of num_segments + 1 offsets into
+     * d_segment_patches
+     * @param d_segment_patches device array of patch IDs
+     * @param h_output host array of num_segments values
+     */
+    template <typename ReductionOp>
+    void segmented_reduce(const Attribute<T, HandleT>& attr,
+                          ReductionOp                  reduction_op,
+                          T                            init,
+                          const uint32_t               num_segments,
+                          const uint32_t*              d_segment_offsets,
+                          const uint32_t*              d_segment_patches,
+                          T*                           h_output,
+                          uint32_t                     attribute_id = INVALID32,
+                          cudaStream_t                 stream       = NULL)
+    {
+        if (num_segments > m_segment_output_size) {
+            GPU_FREE(m_d_segment_output);
+            CUDA_ERROR(
+                cudaMalloc(&m_d_segment_output, num_segments * sizeof(T)));
+            m_segment_output_size = num_segments;
+        }
+
+        segmented_reduce_on_device(attr,
+                                   reduction_op,
+                                   init,
+                                   num_segments,
+                                   d_segment_offsets,
+                                   d_segment_patches,
+                                   m_d_segment_output,
+                                   attribute_id,
+                                   stream);
+
+        CUDA_ERROR(cudaMemcpyAsync(h_output,
+                                   m_d_segment_output,
+                                   num_segments * sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    /**
+     * @brief same as segmented_reduce() but the outputs are written to device
+     * memory and there is no synchronization with the host
+     * @param d_output device array of num_segments values
+     */
+    template <typename ReductionOp>
+    void segmented_reduce_on_device(
+        const Attribute<T, HandleT>& attr,
+        ReductionOp                  reduction_op,
+        T                            init,
+        const uint32_t               num_segments,
+        const uint32_t*              d_segment_offsets,
+        const uint32_t*              d_segment_patches,
+        T*                           d_output,
+        uint32_t                     attribute_id = INVALID32,
+        cudaStream_t                 stream       = NULL)
+    {
+        reduce_1st_stage(attr, reduction_op, init, attribute_id, stream);
+
+        // the 2nd stage gathers the per-patch values of every segment
+        auto d_input = thrust::make_permutation_iterator(m_d_reduce_1st_stage,
+                                                         d_segment_patches);
+
+        size_t temp_bytes = 0;
+        cub::DeviceSegmentedReduce::Reduce(nullptr,
+                                           temp_bytes,
+                                           d_input,
+                                           d_output,
+                                           int(num_segments),
+                                           d_segment_offsets,
+                                           d_segment_offsets + 1,
+                                           reduction_op,
+                                           init,
+                                           stream);
+        if (temp_bytes > m_segment_temp_storage_bytes) {
+            GPU_FREE(m_d_segment_temp_storage);
+            CUDA_ERROR(cudaMalloc(&m_d_segment_temp_storage, temp_bytes));
+            m_segment_temp_storage_bytes = temp_bytes;
+        }
+        cub::DeviceSegmentedReduce::Reduce(m_d_segment_temp_storage,
+                                           temp_bytes,
+                                           d_input,
+                                           d_output,
+                                           int(num_segments),
+                                           d_segment_offsets,
+                                           d_segment_offsets + 1,
+                                           reduction_op,
+                                           init,
+                                           stream);
+    }
+
+   private:
+    void dot_1st_stage(const Attribute<T, HandleT>& attr1,
+                       const Attribute<T, HandleT>& attr2,
+                       uint32_t                     attribute_id,
+                       cudaStream_t                 stream)
+    {
+        if ((attr1.get_allocated() & DEVICE) != DEVICE ||
+            (attr2.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::dot() input attributes to should be "
+                "allocated on the device");
+        }
+
+        run_1st_stage(
+            attr1,
+            stream,
+            [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                detail::dot_kernel<T, m_block_size>
+                    <<<count, m_block_size, 0, s>>>(
+                        attr1,
+                        attr2,
+                        m_max_num_patches,
+                        attr1.get_num_attributes(),
+                        m_d_reduce_1st_stage,
+                        attribute_id,
+                        begin);
+            });
+    }
+
+    void norm2_1st_stage(const Attribute<T, HandleT>& attr,
+                         uint32_t                     attribute_id,
+                         cudaStream_t                 stream)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::norm2() input attribute to should be "
+                "allocated on the device");
+        }
+
+        run_1st_stage(
+            attr,
+            stream,
+            [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                detail::norm2_kernel<T, m_block_size>
+                    <<<count, m_block_size, 0, s>>>(
+                        attr,
+                        m_max_num_patches,
+                        attr.get_num_attributes(),
+                        m_d_reduce_1st_stage,
+                        attribute_id,
+                        begin);
+            });
+    }
+
+    template <typename ReductionOp>
+    void reduce_1st_stage(const Attribute<T, HandleT>& attr,
+                          ReductionOp                  reduction_op,
+                          T                            init,
+                          uint32_t                     attribute_id,
+                          cudaStream_t                 stream)
     {
         if ((attr.get_allocated() & DEVICE) != DEVICE) {
             RXMESH_ERROR(
@@ -160,33 +485,77 @@ class ReduceHandle
                 "allocated on the device");
         }
 
-        detail::generic_reduce<T, attr.m_block_size>
-            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
-                attr,                
-                m_max_num_patches,
-                attr.get_num_attributes(),
-                m_d_reduce_1st_stage,
-                reduction_op,
-                init,
-                attribute_id);
+        run_1st_stage(
+            attr,
+            stream,
+            [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                detail::generic_reduce<T, m_block_size>
+                    <<<count, m_block_size, 0, s>>>(
+                        attr,
+                        m_max_num_patches,
+                        attr.get_num_attributes(),
+                        m_d_reduce_1st_stage,
+                        reduction_op,
+                        init,
+                        attribute_id,
+                        begin);
+            });
+    }
 
-        return reduce_2nd_stage(stream, reduction_op, init);
+    /**
+     * @brief launch(begin, count, stream) launches the 1st stage kernel over
+     * the patches [begin, begin + count) which writes one value per patch. In
+     * multi-GPU mode, every GPU reduces its own patches (and the last GPU also
+     * covers the extra patches) into the 1st stage buffer on the primary GPU
+     * over peer-to-peer and the 2nd stage runs on the primary GPU after all
+     * GPUs are done
+     */
+    template <typename LaunchT>
+    void run_1st_stage(const Attribute<T, HandleT>& attr,
+                       cudaStream_t                 stream,
+                       LaunchT                      launch)
+    {
+        if (!attr.m_rxmesh->is_multi_gpu()) {
+            launch(0, m_max_num_patches, stream);
+            return;
+        }
+
+        const PatchPartition& partition = attr.m_rxmesh->get_partition();
+        partition.run(stream,
+                      [&](const int      gpu,
+                          const uint32_t begin,
+                          uint32_t       count,
+                          cudaStream_t   gpu_stream) {
+                          if (gpu == partition.get_num_gpus() - 1) {
+                              count = m_max_num_patches - begin;
+                          }
+                          launch(begin, count, gpu_stream);
+                      });
     }
 
-   private:
     template <typename ReductionOp>
-    T reduce_2nd_stage(cudaStream_t stream, ReductionOp reduction_op, T init)
+    void reduce_2nd_stage_on_device(cudaStream_t stream,
+                                    ReductionOp  reduction_op,
+                                    T            init,
+                                    T*           d_output)
     {
-        T h_output = 0;
-
         cub::DeviceReduce::Reduce(m_d_reduce_temp_storage,
                                   m_reduce_temp_storage_bytes,
                                   m_d_reduce_1st_stage,
-                                  m_d_reduce_2nd_stage,
+                                  d_output,
                                   m_max_num_patches,
                                   reduction_op,
                                   init,
                                   stream);
+    }
+
+    template <typename ReductionOp>
+    T reduce_2nd_stage(cudaStream_t stream, ReductionOp reduction_op, T init)
+    {
+        T h_output = 0;
+
+        reduce_2nd_stage_on_device(
+            stream, reduction_op, init, m_d_reduce_2nd_stage);
 
         CUDA_ERROR(cudaMemcpyAsync(&h_output,
                                    m_d_reduce_2nd_stage,
@@ -203,6 +572,20 @@ class ReduceHandle
     T*       m_d_reduce_2nd_stage;
     void*    m_d_reduce_temp_storage;
     uint32_t m_max_num_patches;
+
+    size_t m_multi_temp_storage_bytes = 0;
+    T*     m_d_multi_1st_stage        = nullptr;
+    T*     m_d_multi_2nd_stage        = nullptr;
+    int*   m_d_multi_offsets          = nullptr;
+    void*  m_d_multi_temp_storage     = nullptr;
+
+    size_t   m_segment_temp_storage_bytes = 0;
+    void*    m_d_segment_temp_storage     = nullptr;
+    T*       m_d_segment_output           = nullptr;
+    uint32_t m_segment_output_size        = 0;
+
+    static constexpr uint32_t m_block_size =
+        Attribute<T, HandleT>::m_block_size;
 };
 
 template <class T>
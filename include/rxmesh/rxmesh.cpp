@@ -14,7 +14,9 @@
 #include "rxmesh/util/util.h"
 
 namespace rxmesh {
-RXMesh::RXMesh(uint32_t patch_size)
+RXMesh::RXMesh(uint32_t patch_size,
+               uint32_t max_resident_patches,
+               int      num_gpus)
     : m_num_edges(0),
       m_num_faces(0),
       m_num_vertices(0),
@@ -22,7 +24,10 @@ RXMesh::RXMesh(uint32_t patch_size)
       m_input_max_edge_incident_faces(0),
       m_input_max_face_adjacent_faces(0),
       m_num_patches(0),
+      m_max_num_patches(0),
       m_patch_size(patch_size),
+      m_patch_slots_factor(1),
+      m_num_patch_slots(0),
       m_is_input_edge_manifold(true),
       m_is_input_closed(true),
       m_h_vertex_prefix(nullptr),
@@ -39,29 +44,130 @@ RXMesh::RXMesh(uint32_t patch_size)
       m_max_capacity_lp_e(0),
       m_max_capacity_lp_f(0),
       m_patch_alloc_factor(0),
+      m_compact(false),
       m_max_edge_capacity(0),
       m_max_face_capacity(0),
       m_max_vertex_capacity(0),
-      m_topo_memory_mega_bytes(0)
+      m_topo_memory_mega_bytes(0),
+      m_num_threads(1),
+      m_max_resident_patches(max_resident_patches),
+      m_num_gpus(std::max(num_gpus, 1))
 {
+    if (is_streaming() && m_num_gpus > 1) {
+        RXMESH_ERROR(
+            "RXMesh::RXMesh() streaming and multi-GPU can not be used "
+            "together");
+        exit(EXIT_FAILURE);
+    }
 }
 
 void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
                   const std::string                         patcher_file,
                   const float                               capacity_factor,
                   const float                               patch_alloc_factor,
-                  const float lp_hashtable_load_factor)
+                  const float lp_hashtable_load_factor,
+                  const int   num_threads)
 {
-    m_topo_memory_mega_bytes   = 0;
-    m_capacity_factor          = capacity_factor;
-    m_lp_hashtable_load_factor = lp_hashtable_load_factor;
-    m_patch_alloc_factor       = patch_alloc_factor;
-
     // Build everything from scratch including patches
     if (fv.empty()) {
         RXMESH_ERROR(
             "RXMesh::init input fv is empty. Can not build RXMesh properly");
     }
+
+    init_parameters(capacity_factor,
+                    patch_alloc_factor,
+                    lp_hashtable_load_factor,
+                    num_threads);
+
+    // the mesh is built from the faces stored contiguously (three vertices per
+    // face)
+    std::vector<uint32_t> flat_fv(3 * fv.size());
+
+    uint32_t bad_face = INVALID32;
+#pragma omp parallel for num_threads(get_num_threads()) \
+    reduction(min : bad_face)
+    for (int f = 0; f < static_cast<int>(fv.size()); ++f) {
+        if (fv[f].size() != 3) {
+            bad_face = std::min(bad_face, static_cast<uint32_t>(f));
+            continue;
+        }
+        for (uint32_t v = 0; v < 3; ++v) {
+            flat_fv[3 * f + v] = fv[f][v];
+        }
+    }
+
+    if (bad_face != INVALID32) {
+        RXMESH_ERROR(
+            "RXMesh::init Face {} is not triangle. Non-triangular faces are "
+            "not supported",
+            bad_face);
+        exit(EXIT_FAILURE);
+    }
+
+    build(flat_fv, patcher_file);
+
+    init_device();
+}
+
+void RXMesh::init(const std::vector<uint32_t>& fv,
+                  const std::string            patcher_file,
+                  const float                  capacity_factor,
+                  const float                  patch_alloc_factor,
+                  const float                  lp_hashtable_load_factor,
+                  const int                    num_threads)
+{
+    if (fv.empty() || fv.size() % 3 != 0) {
+        RXMESH_ERROR(
+            "RXMesh::init input fv is empty or its size ({}) is not a multiple "
+            "of 3. Can not build RXMesh properly",
+            fv.size());
+        exit(EXIT_FAILURE);
+    }
+
+    init_parameters(capacity_factor,
+                    patch_alloc_factor,
+                    lp_hashtable_load_factor,
+                    num_threads);
+
+    build(fv, patcher_file);
+
+    init_device();
+}
+
+void RXMesh::init(const uint32_t*   d_fv,
+                  const uint32_t    num_faces,
+                  const std::string patcher_file,
+                  const float       capacity_factor,
+                  const float       patch_alloc_factor,
+                  const float       lp_hashtable_load_factor,
+                  const int         num_threads)
+{
+    if (d_fv == nullptr || num_faces == 0) {
+        RXMESH_ERROR(
+            "RXMesh::init input d_fv is empty. Can not build RXMesh properly");
+    }
+
+    init_parameters(capacity_factor,
+                    patch_alloc_factor,
+                    lp_hashtable_load_factor,
+                    num_threads);
+
+    build_with_device_adjacency(d_fv, num_faces, patcher_file);
+
+    init_device();
+}
+
+void RXMesh::init_parameters(const float capacity_factor,
+                             const float patch_alloc_factor,
+                             const float lp_hashtable_load_factor,
+                             const int   num_threads)
+{
+    m_topo_memory_mega_bytes   = 0;
+    m_capacity_factor          = capacity_factor;
+    m_lp_hashtable_load_factor = lp_hashtable_load_factor;
+    m_patch_alloc_factor       = patch_alloc_factor;
+    m_num_threads = (num_threads < 1) ? omp_get_max_threads() : num_threads;
+
     if (m_capacity_factor < 1.0) {
         RXMESH_ERROR("RXMesh::init capacity factor should be at least one");
     }
@@ -74,21 +180,66 @@ void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
             "RXMesh::init hashtable load factor should be less than 1");
     }
 
-    build(fv, patcher_file);
+    // a compact mesh has no headroom for new elements or patches
+    if (m_compact) {
+        if (m_capacity_factor != 1.0 || m_patch_alloc_factor != 1.0) {
+            RXMESH_WARN(
+                "RXMesh::init capacity factor and patch allocation factor are "
+                "ignored (set to one) for compact meshes");
+        }
+        m_capacity_factor    = 1.0;
+        m_patch_alloc_factor = 1.0;
+    }
+}
 
+void RXMesh::init_device()
+{
     build_device();
 
+    init_context();
+}
+
+void RXMesh::init_context()
+{
+
+    // one ring buffer per SM so blocks running on different SMs do not
+    // contend on the same counters
+    int device = 0, num_sms = 1;
+    CUDA_ERROR(cudaGetDevice(&device));
+    CUDA_ERROR(cudaDeviceGetAttribute(
+        &num_sms, cudaDevAttrMultiProcessorCount, device));
 
     PatchScheduler sch;
-    sch.init(get_max_num_patches());
-    m_topo_memory_mega_bytes +=
-        BYTES_TO_MEGABYTES(sizeof(uint32_t) * get_max_num_patches());
+    sch.init(get_num_patch_slots(),
+             std::min(uint32_t(num_sms), get_num_patches()));
+    m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(
+        sizeof(uint32_t) * sch.num_queues * sch.queue_capacity);
 
     sch.refill(get_num_patches());
 
 
     // Allocate  extra patches
-    allocate_extra_patches();
+    allocate_extra_patches(get_num_patches());
+
+    if (is_streaming()) {
+        m_residency.init(m_max_resident_patches,
+                         get_num_patches(),
+                         m_h_patches_info,
+                         m_d_patches_info);
+    }
+
+    if (m_num_gpus > 1) {
+        if (!m_partition.init(m_num_gpus,
+                              get_num_patches(),
+                              m_h_patches_info,
+                              m_d_patches_info)) {
+            RXMESH_WARN(
+                "RXMesh::init_context() could not split the patches over {} "
+                "GPUs. Running on {} GPU(s)",
+                m_num_gpus,
+                m_partition.get_num_gpus());
+        }
+    }
 
     // Allocate and copy the context to the gpu
     m_rxmesh_context.init(m_num_vertices,
@@ -190,19 +341,71 @@ RXMesh::~RXMesh()
     free(m_h_face_prefix);
 }
 
-void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
-                   const std::string                         patcher_file)
+void RXMesh::build(const std::vector<uint32_t>& fv,
+                   const std::string            patcher_file)
 {
-    std::vector<uint32_t>              ff_values;
-    std::vector<uint32_t>              ff_offset;
-    std::vector<std::vector<uint32_t>> ef;
+    std::vector<uint32_t>                      ff_values;
+    std::vector<uint32_t>                      ff_offset;
+    std::vector<uint32_t>                      ef_values;
+    std::vector<uint32_t>                      ef_offset;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
 
+    build_supporting_structures(
+        fv, edges, ef_offset, ef_values, ff_offset, ff_values);
+
+    build_from_supporting_structures(
+        fv, edges, ef_offset, ff_offset, ff_values, patcher_file);
+}
+
+void RXMesh::build_with_device_adjacency(const uint32_t*   d_fv,
+                                         const uint32_t    num_faces,
+                                         const std::string patcher_file)
+{
+    std::vector<uint32_t>                      fv;
+    std::vector<uint32_t>                      ff_values;
+    std::vector<uint32_t>                      ff_offset;
+    std::vector<uint32_t>                      ef_offset;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    uint32_t*                                  d_ff_offset = nullptr;
+    uint32_t*                                  d_ff_values = nullptr;
+
+    build_supporting_structures_on_device(d_fv,
+                                          num_faces,
+                                          fv,
+                                          edges,
+                                          ef_offset,
+                                          ff_offset,
+                                          ff_values,
+                                          d_ff_offset,
+                                          d_ff_values);
+
+    build_from_supporting_structures(fv,
+                                     edges,
+                                     ef_offset,
+                                     ff_offset,
+                                     ff_values,
+                                     patcher_file,
+                                     d_ff_offset,
+                                     d_ff_values);
+
+    GPU_FREE(d_ff_offset);
+    GPU_FREE(d_ff_values);
+}
+
+void RXMesh::build_from_supporting_structures(
+    const std::vector<uint32_t>&                      fv,
+    const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+    const std::vector<uint32_t>&                      ef_offset,
+    const std::vector<uint32_t>&                      ff_offset,
+    const std::vector<uint32_t>&                      ff_values,
+    const std::string                                 patcher_file,
+    const uint32_t*                                   d_ff_offset,
+    const uint32_t*                                   d_ff_values)
+{
     m_max_capacity_lp_v = 0;
     m_max_capacity_lp_e = 0;
     m_max_capacity_lp_f = 0;
 
-    build_supporting_structures(fv, ef, ff_offset, ff_values);
-
     if (!patcher_file.empty()) {
         if (!std::filesystem::exists(patcher_file)) {
             RXMESH_ERROR(
@@ -215,7 +418,9 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                                                            fv,
                                                            m_edges_map,
                                                            m_num_vertices,
-                                                           m_num_edges);
+                                                           m_num_edges,
+                                                           d_ff_offset,
+                                                           d_ff_values);
         } else {
             m_patcher = std::make_unique<patcher::Patcher>(patcher_file);
         }
@@ -226,16 +431,20 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                                                        fv,
                                                        m_edges_map,
                                                        m_num_vertices,
-                                                       m_num_edges);
+                                                       m_num_edges,
+                                                       d_ff_offset,
+                                                       d_ff_values);
     }
 
 
     m_num_patches     = m_patcher->get_num_patches();
     m_max_num_patches = static_cast<uint32_t>(
         std::ceil(m_patch_alloc_factor * static_cast<float>(m_num_patches)));
+    m_num_patch_slots =
+        (m_compact ? 1 : m_patch_slots_factor) * m_max_num_patches;
 
     m_h_patches_info =
-        (PatchInfo*)malloc(get_max_num_patches() * sizeof(PatchInfo));
+        (PatchInfo*)malloc(get_num_patch_slots() * sizeof(PatchInfo));
     m_h_patches_ltog_f.resize(get_num_patches());
     m_h_patches_ltog_e.resize(get_num_patches());
     m_h_patches_ltog_v.resize(get_num_patches());
@@ -243,7 +452,7 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
     m_h_num_owned_v.resize(get_max_num_patches(), 0);
     m_h_num_owned_e.resize(get_max_num_patches(), 0);
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
     for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
         build_single_patch_ltog(fv, p);
     }
@@ -274,13 +483,13 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
     m_max_face_capacity = static_cast<uint16_t>(std::ceil(
         m_capacity_factor * static_cast<float>(m_max_faces_per_patch)));
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
     for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
         build_single_patch_topology(fv, p);
     }
 
     const uint32_t patches_1_bytes =
-        (get_max_num_patches() + 1) * sizeof(uint32_t);
+        (get_num_patch_slots() + 1) * sizeof(uint32_t);
 
     m_h_vertex_prefix = (uint32_t*)malloc(patches_1_bytes);
     m_h_edge_prefix   = (uint32_t*)malloc(patches_1_bytes);
@@ -316,150 +525,237 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                           patches_1_bytes,
                           cudaMemcpyHostToDevice));
 
-    calc_input_statistics(fv, ef);
+    calc_input_statistics(fv, edges, ef_offset, ff_offset);
 }
 
 void RXMesh::build_supporting_structures(
-    const std::vector<std::vector<uint32_t>>& fv,
-    std::vector<std::vector<uint32_t>>&       ef,
-    std::vector<uint32_t>&                    ff_offset,
-    std::vector<uint32_t>&                    ff_values)
+    const std::vector<uint32_t>&                fv,
+    std::vector<std::pair<uint32_t, uint32_t>>& edges,
+    std::vector<uint32_t>&                      ef_offset,
+    std::vector<uint32_t>&                      ef_values,
+    std::vector<uint32_t>&                      ff_offset,
+    std::vector<uint32_t>&                      ff_values)
 {
-    m_num_faces    = static_cast<uint32_t>(fv.size());
+    // Edges are discovered by sorting all face's half-edges by their edge key
+    // and then collapsing runs of equal keys into a single edge. Edge ids are
+    // assigned in the order in which an edge is first seen when iterating over
+    // fv (i.e., same order as inserting the edges one face at a time) so that
+    // saved patcher files remain valid
+
+    m_num_faces    = static_cast<uint32_t>(fv.size() / 3);
     m_num_vertices = 0;
     m_num_edges    = 0;
     m_edges_map.clear();
 
-    // assuming manifold mesh i.e., #E = 1.5#F
-    ef.clear();
-    uint32_t reserve_size =
-        static_cast<size_t>(1.5f * static_cast<float>(m_num_faces));
-    ef.reserve(reserve_size);
-    m_edges_map.reserve(reserve_size);
+    const int num_threads = get_num_threads();
 
-    std::vector<uint32_t> ff_size(m_num_faces, 0);
+    const uint32_t num_half_edges = 3 * m_num_faces;
 
-    for (uint32_t f = 0; f < fv.size(); ++f) {
-        if (fv[f].size() != 3) {
-            RXMESH_ERROR(
-                "rxmesh::build_supporting_structures() Face {} is not "
-                "triangle. Non-triangular faces are not supported",
-                f);
-            exit(EXIT_FAILURE);
+    uint32_t max_vertex = 0;
+
+    // (edge key, half-edge id) where half-edge id = 3 * face_id + local index
+    std::vector<std::pair<uint64_t, uint32_t>> he(num_half_edges);
+
+#pragma omp parallel for num_threads(num_threads) reduction(max : max_vertex)
+    for (int f = 0; f < static_cast<int>(m_num_faces); ++f) {
+        for (uint32_t v = 0; v < 3; ++v) {
+            const uint32_t v0 = fv[3 * f + v];
+            const uint32_t v1 = fv[3 * f + (v + 1) % 3];
+
+            max_vertex = std::max(max_vertex, v0);
+
+            const std::pair<uint32_t, uint32_t> key = detail::edge_key(v0, v1);
+
+            he[3 * f + v] = std::make_pair(
+                (uint64_t(key.first) << 32) | uint64_t(key.second),
+                3 * uint32_t(f) + v);
         }
+    }
 
-        for (uint32_t v = 0; v < fv[f].size(); ++v) {
-            uint32_t v0 = fv[f][v];
-            uint32_t v1 = fv[f][(v + 1) % 3];
+    m_num_vertices = max_vertex + 1;
 
-            m_num_vertices = std::max(m_num_vertices, v0);
+    // sort by the edge key and then by the half-edge id
+    parallel_sort(he, num_threads);
 
-            std::pair<uint32_t, uint32_t> edge   = detail::edge_key(v0, v1);
-            auto                          e_iter = m_edges_map.find(edge);
-            if (e_iter == m_edges_map.end()) {
-                uint32_t edge_id = m_num_edges++;
-                m_edges_map.insert(std::make_pair(edge, edge_id));
-                std::vector<uint32_t> tmp(1, f);
-                ef.push_back(tmp);
-            } else {
-                uint32_t edge_id = (*e_iter).second;
+    auto is_run_head = [&](const uint32_t i) {
+        return i == 0 || he[i].first != he[i - 1].first;
+    };
 
-                for (uint32_t f0 = 0; f0 < ef[edge_id].size(); ++f0) {
-                    uint32_t other_face = ef[edge_id][f0];
-                    ++ff_size[other_face];
-                }
-                ff_size[f] += ef[edge_id].size();
+    // mark the first (in fv order) half-edge of every edge then scan to get
+    // the edge ids
+    std::vector<uint32_t> he_edge(num_half_edges, 0);
+
+#pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < static_cast<int>(num_half_edges); ++i) {
+        if (is_run_head(i)) {
+            he_edge[he[i].second] = 1;
+        }
+    }
+
+    for (uint32_t h = 0; h < num_half_edges; ++h) {
+        const uint32_t is_first = he_edge[h];
+        he_edge[h]              = m_num_edges;
+        m_num_edges += is_first;
+    }
 
-                ef[edge_id].push_back(f);
+    // edge incident faces in compressed format. Since the half-edges of an
+    // edge are sorted by their id, the incident faces are also sorted
+    edges.resize(m_num_edges);
+    std::vector<uint32_t> ef_size(m_num_edges, 0);
+
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 4096)
+    for (int i = 0; i < static_cast<int>(num_half_edges); ++i) {
+        if (is_run_head(i)) {
+            const uint32_t edge_id = he_edge[he[i].second];
+            uint32_t       j       = i;
+            while (j < num_half_edges && he[j].first == he[i].first) {
+                he_edge[he[j].second] = edge_id;
+                ++j;
             }
+            ef_size[edge_id] = j - i;
+            edges[edge_id]   = std::make_pair(uint32_t(he[i].first >> 32),
+                                            uint32_t(he[i].first));
         }
     }
-    ++m_num_vertices;
 
-    if (m_num_edges != static_cast<uint32_t>(m_edges_map.size())) {
-        RXMESH_ERROR(
-            "rxmesh::build_supporting_structures() m_num_edges ({}) should "
-            "match the size of edge_map ({})",
-            m_num_edges,
-            m_edges_map.size());
-        exit(EXIT_FAILURE);
+    ef_offset.resize(m_num_edges);
+    std::inclusive_scan(ef_size.begin(), ef_size.end(), ef_offset.begin());
+    ef_values.resize(num_half_edges);
+
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 4096)
+    for (int i = 0; i < static_cast<int>(num_half_edges); ++i) {
+        if (is_run_head(i)) {
+            const uint32_t edge_id = he_edge[he[i].second];
+            const uint32_t start = (edge_id == 0) ? 0 : ef_offset[edge_id - 1];
+            for (uint32_t k = 0; k < ef_size[edge_id]; ++k) {
+                ef_values[start + k] = he[i + k].second / 3;
+            }
+        }
+    }
+
+    // we don't need the sorted half-edges anymore
+    he.clear();
+    he.shrink_to_fit();
+
+    // face adjacent faces: every face sharing an edge with f is adjacent to f
+    std::vector<uint32_t> ff_size(m_num_faces, 0);
+#pragma omp parallel for num_threads(num_threads)
+    for (int f = 0; f < static_cast<int>(m_num_faces); ++f) {
+        for (uint32_t v = 0; v < 3; ++v) {
+            ff_size[f] += ef_size[he_edge[3 * f + v]] - 1;
+        }
     }
 
     ff_offset.resize(m_num_faces);
     std::inclusive_scan(ff_size.begin(), ff_size.end(), ff_offset.begin());
     ff_values.clear();
     ff_values.resize(ff_offset.back());
-    std::fill(ff_size.begin(), ff_size.end(), 0);
 
-    for (uint32_t e = 0; e < m_num_edges; ++e) {
-        for (uint32_t i = 0; i < ef[e].size(); ++i) {
-            uint32_t f0 = ef[e][i];
-            for (uint32_t j = i + 1; j < ef[e].size(); ++j) {
-                uint32_t f1 = ef[e][j];
-
-                uint32_t f0_offset = ff_size[f0]++;
-                uint32_t f1_offset = ff_size[f1]++;
-                f0_offset += (f0 == 0) ? 0 : ff_offset[f0 - 1];
-                f1_offset += (f1 == 0) ? 0 : ff_offset[f1 - 1];
+    // populating m_edges_map is inherently serial so we overlap it with
+    // populating ff_values; the thread that picks the single block joins
+    // the (dynamically scheduled) for loop once it is done
+    m_edges_map.reserve(m_num_edges);
+#pragma omp parallel num_threads(num_threads)
+    {
+#pragma omp single nowait
+        {
+            for (uint32_t e = 0; e < m_num_edges; ++e) {
+                m_edges_map.emplace(edges[e], e);
+            }
+        }
 
-                ff_values[f0_offset] = f1;
-                ff_values[f1_offset] = f0;
+#pragma omp for schedule(dynamic, 4096)
+        for (int f = 0; f < static_cast<int>(m_num_faces); ++f) {
+            // process the face's edges in increasing id order
+            uint32_t f_edges[3] = {
+                he_edge[3 * f], he_edge[3 * f + 1], he_edge[3 * f + 2]};
+            std::sort(f_edges, f_edges + 3);
+
+            uint32_t offset = (f == 0) ? 0 : ff_offset[f - 1];
+            for (uint32_t i = 0; i < 3; ++i) {
+                const uint32_t e_start =
+                    (f_edges[i] == 0) ? 0 : ef_offset[f_edges[i] - 1];
+                const uint32_t e_end = ef_offset[f_edges[i]];
+
+                bool skipped = false;
+                for (uint32_t k = e_start; k < e_end; ++k) {
+                    const uint32_t n = ef_values[k];
+                    if (n == uint32_t(f) && !skipped) {
+                        skipped = true;
+                        continue;
+                    }
+                    ff_values[offset++] = n;
+                }
             }
         }
     }
+
+    if (m_num_edges != static_cast<uint32_t>(m_edges_map.size())) {
+        RXMESH_ERROR(
+            "rxmesh::build_supporting_structures() m_num_edges ({}) should "
+            "match the size of edge_map ({})",
+            m_num_edges,
+            m_edges_map.size());
+        exit(EXIT_FAILURE);
+    }
 }
 
-void RXMesh::calc_input_statistics(const std::vector<std::vector<uint32_t>>& fv,
-                                   const std::vector<std::vector<uint32_t>>& ef)
+void RXMesh::calc_input_statistics(
+    const std::vector<uint32_t>&                      fv,
+    const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+    const std::vector<uint32_t>&                    ef_offset,
+    const std::vector<uint32_t>&                    ff_offset)
 {
     if (m_num_vertices == 0 || m_num_faces == 0 || m_num_edges == 0 ||
-        fv.size() == 0 || ef.size() == 0) {
+        fv.size() == 0 || edges.size() == 0) {
         RXMESH_ERROR(
             "RXMesh::calc_statistics() input mesh has not been initialized");
         exit(EXIT_FAILURE);
     }
 
+    const int num_threads = get_num_threads();
+
     // calc max valence, max ef, is input closed, and is input manifold
-    m_input_max_edge_incident_faces = 0;
-    m_input_max_valence             = 0;
+    uint32_t max_ef        = 0;
+    bool     is_closed     = true;
+    bool     is_manifold   = true;
     std::vector<uint32_t> vv_count(m_num_vertices, 0);
-    m_is_input_closed        = true;
-    m_is_input_edge_manifold = true;
-    for (const auto& e_iter : m_edges_map) {
-        uint32_t v0 = e_iter.first.first;
-        uint32_t v1 = e_iter.first.second;
 
-        vv_count[v0]++;
-        vv_count[v1]++;
+#pragma omp parallel for num_threads(num_threads) reduction(max : max_ef) \
+    reduction(&& : is_closed, is_manifold)
+    for (int e = 0; e < static_cast<int>(m_num_edges); ++e) {
+#pragma omp atomic
+        vv_count[edges[e].first]++;
+#pragma omp atomic
+        vv_count[edges[e].second]++;
 
-        m_input_max_valence = std::max(m_input_max_valence, vv_count[v0]);
-        m_input_max_valence = std::max(m_input_max_valence, vv_count[v1]);
+        const uint32_t ef_count =
+            ef_offset[e] - ((e == 0) ? 0 : ef_offset[e - 1]);
 
-        uint32_t edge_id                = e_iter.second;
-        m_input_max_edge_incident_faces = std::max(
-            m_input_max_edge_incident_faces, uint32_t(ef[edge_id].size()));
+        max_ef      = std::max(max_ef, ef_count);
+        is_closed   = is_closed && ef_count >= 2;
+        is_manifold = is_manifold && ef_count <= 2;
+    }
 
-        if (ef[edge_id].size() < 2) {
-            m_is_input_closed = false;
-        }
-        if (ef[edge_id].size() > 2) {
-            m_is_input_edge_manifold = false;
-        }
+    uint32_t max_valence = 0;
+#pragma omp parallel for num_threads(num_threads) reduction(max : max_valence)
+    for (int v = 0; v < static_cast<int>(m_num_vertices); ++v) {
+        max_valence = std::max(max_valence, vv_count[v]);
     }
 
     // calc max ff
-    m_input_max_face_adjacent_faces = 0;
-    for (uint32_t f = 0; f < fv.size(); ++f) {
-        uint32_t ff_count = 0;
-        for (uint32_t v = 0; v < fv[f].size(); ++v) {
-            uint32_t v0       = fv[f][v];
-            uint32_t v1       = fv[f][(v + 1) % 3];
-            uint32_t edge_num = get_edge_id(v0, v1);
-            ff_count += ef[edge_num].size() - 1;
-        }
-        m_input_max_face_adjacent_faces =
-            std::max(ff_count, m_input_max_face_adjacent_faces);
+    uint32_t max_ff = 0;
+#pragma omp parallel for num_threads(num_threads) reduction(max : max_ff)
+    for (int f = 0; f < static_cast<int>(m_num_faces); ++f) {
+        max_ff = std::max(max_ff,
+                          ff_offset[f] - ((f == 0) ? 0 : ff_offset[f - 1]));
     }
+
+    m_input_max_valence             = max_valence;
+    m_input_max_edge_incident_faces = max_ef;
+    m_is_input_closed               = is_closed;
+    m_is_input_edge_manifold        = is_manifold;
+    m_input_max_face_adjacent_faces = max_ff;
 }
 
 void RXMesh::calc_max_elements()
@@ -481,7 +777,7 @@ void RXMesh::calc_max_elements()
 }
 
 void RXMesh::build_single_patch_ltog(
-    const std::vector<std::vector<uint32_t>>& fv,
+    const std::vector<uint32_t>& fv,
     const uint32_t                            patch_id)
 {
     // patch start and end
@@ -506,8 +802,8 @@ void RXMesh::build_single_patch_ltog(
         m_h_patches_ltog_f[patch_id][local_face_id] = global_face_id;
 
         for (uint32_t v = 0; v < 3; ++v) {
-            uint32_t v0 = fv[global_face_id][v];
-            uint32_t v1 = fv[global_face_id][(v + 1) % 3];
+            uint32_t v0 = fv[3 * global_face_id + v];
+            uint32_t v1 = fv[3 * global_face_id + (v + 1) % 3];
 
             uint32_t edge_id = get_edge_id(v0, v1);
 
@@ -555,7 +851,7 @@ void RXMesh::build_single_patch_ltog(
 }
 
 void RXMesh::build_single_patch_topology(
-    const std::vector<std::vector<uint32_t>>& fv,
+    const std::vector<uint32_t>& fv,
     const uint32_t                            patch_id)
 {
     // patch start and end
@@ -614,8 +910,8 @@ void RXMesh::build_single_patch_topology(
         for (uint32_t v = 0; v < 3; ++v) {
 
 
-            const uint32_t global_v0 = fv[global_face_id][v];
-            const uint32_t global_v1 = fv[global_face_id][(v + 1) % 3];
+            const uint32_t global_v0 = fv[3 * global_face_id + v];
+            const uint32_t global_v1 = fv[3 * global_face_id + (v + 1) % 3];
 
             std::pair<uint32_t, uint32_t> edge_key =
                 detail::edge_key(global_v0, global_v1);
@@ -783,13 +1079,16 @@ uint16_t RXMesh::get_per_patch_max_face_capacity() const
 
 void RXMesh::build_device()
 {
-    CUDA_ERROR(cudaMalloc((void**)&m_d_patches_info,
-                          get_max_num_patches() * sizeof(PatchInfo)));
+    // in multi-GPU mode, the patches table is replicated on all GPUs (see
+    // PatchPartition)
+    CUDA_ERROR(device_malloc((void**)&m_d_patches_info,
+                             get_num_patch_slots() * sizeof(PatchInfo),
+                             m_num_gpus > 1));
     m_topo_memory_mega_bytes +=
-        BYTES_TO_MEGABYTES(get_max_num_patches() * sizeof(PatchInfo));
+        BYTES_TO_MEGABYTES(get_num_patch_slots() * sizeof(PatchInfo));
 
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
     for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
 
         const uint16_t p_num_vertices =
@@ -799,13 +1098,22 @@ void RXMesh::build_device()
         const uint16_t p_num_faces =
             static_cast<uint16_t>(m_h_patches_ltog_f[p].size());
 
+        // compact patches are sized exactly. Otherwise, all patches have the
+        // same capacity so that they could grow in place
+        const uint16_t p_vertices_capacity =
+            m_compact ? p_num_vertices : get_per_patch_max_vertex_capacity();
+        const uint16_t p_edges_capacity =
+            m_compact ? p_num_edges : get_per_patch_max_edge_capacity();
+        const uint16_t p_faces_capacity =
+            m_compact ? p_num_faces : get_per_patch_max_face_capacity();
+
         build_device_single_patch(p,
                                   p_num_vertices,
                                   p_num_edges,
                                   p_num_faces,
-                                  get_per_patch_max_vertex_capacity(),
-                                  get_per_patch_max_edge_capacity(),
-                                  get_per_patch_max_face_capacity(),
+                                  p_vertices_capacity,
+                                  p_edges_capacity,
+                                  p_faces_capacity,
                                   m_h_num_owned_v[p],
                                   m_h_num_owned_e[p],
                                   m_h_num_owned_f[p],
@@ -865,6 +1173,11 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
                                        PatchInfo& h_patch_info,
                                        PatchInfo& d_patch_info)
 {
+    // this function is called concurrently for different patches so we
+    // accumulate the memory used by this patch locally and add it to
+    // m_topo_memory_mega_bytes once at the end
+    double topo_mega_bytes = 0;
+
     uint16_t* h_counts = (uint16_t*)malloc(6 * sizeof(uint16_t));
 
     h_patch_info.num_faces            = h_counts;
@@ -887,9 +1200,15 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     h_patch_info.should_slice         = false;
 
 
+    // in streaming and multi-GPU modes, the patch device memory is managed so
+    // that it can be evicted to the host (see PatchResidency) or placed on
+    // its owner GPU (see PatchPartition)
+    const bool managed = is_device_memory_managed();
+
     uint16_t* d_counts;
-    CUDA_ERROR(cudaMalloc((void**)&d_counts, 6 * sizeof(uint16_t)));
-    m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(6 * sizeof(uint16_t));
+    CUDA_ERROR(
+        device_malloc((void**)&d_counts, 6 * sizeof(uint16_t), managed));
+    topo_mega_bytes += BYTES_TO_MEGABYTES(6 * sizeof(uint16_t));
 
     PatchInfo d_patch;
     d_patch.num_faces         = d_counts;
@@ -899,46 +1218,26 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     d_patch.edges_capacity    = d_counts + 4;
     d_patch.vertices_capacity = d_counts + 5;
     d_patch.patch_id          = patch_id;
-    d_patch.patch_stash       = PatchStash(true);
+    d_patch.patch_stash       = PatchStash(true, managed);
     d_patch.lock.init();
     d_patch.child_id     = INVALID32;
     d_patch.should_slice = false;
 
-    m_topo_memory_mega_bytes +=
+    topo_mega_bytes +=
         BYTES_TO_MEGABYTES(PatchStash::stash_size * sizeof(uint32_t));
 
-    // copy count and capacities
-    CUDA_ERROR(cudaMemcpy(d_patch.num_faces,
-                          h_patch_info.num_faces,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
-    CUDA_ERROR(cudaMemcpy(d_patch.num_edges,
-                          h_patch_info.num_edges,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
-    CUDA_ERROR(cudaMemcpy(d_patch.num_vertices,
-                          h_patch_info.num_vertices,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
-    CUDA_ERROR(cudaMemcpy(d_patch.faces_capacity,
-                          h_patch_info.faces_capacity,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
-    CUDA_ERROR(cudaMemcpy(d_patch.edges_capacity,
-                          h_patch_info.edges_capacity,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
-    CUDA_ERROR(cudaMemcpy(d_patch.vertices_capacity,
-                          h_patch_info.vertices_capacity,
-                          sizeof(uint16_t),
-                          cudaMemcpyHostToDevice));
+    // copy count and capacities. They are contiguous in memory (with the
+    // same layout on host and device) so we copy them all at once
+    CUDA_ERROR(cudaMemcpy(
+        d_counts, h_counts, 6 * sizeof(uint16_t), cudaMemcpyHostToDevice));
 
     // allocate and copy patch topology to the device
     // we realloc the host h_patch_info EV and FE to ensure that both host and
     // device has the same capacity
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.ev,
-                          p_edges_capacity * 2 * sizeof(LocalVertexT)));
-    m_topo_memory_mega_bytes +=
+    CUDA_ERROR(device_malloc((void**)&d_patch.ev,
+                             p_edges_capacity * 2 * sizeof(LocalVertexT),
+                             managed));
+    topo_mega_bytes +=
         BYTES_TO_MEGABYTES(p_edges_capacity * 2 * sizeof(LocalVertexT));
     h_patch_info.ev = (LocalVertexT*)realloc(
         h_patch_info.ev, p_edges_capacity * 2 * sizeof(LocalVertexT));
@@ -950,9 +1249,10 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
                               cudaMemcpyHostToDevice));
     }
 
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.fe,
-                          p_faces_capacity * 3 * sizeof(LocalEdgeT)));
-    m_topo_memory_mega_bytes +=
+    CUDA_ERROR(device_malloc((void**)&d_patch.fe,
+                             p_faces_capacity * 3 * sizeof(LocalEdgeT),
+                             managed));
+    topo_mega_bytes +=
         BYTES_TO_MEGABYTES(p_faces_capacity * 3 * sizeof(LocalEdgeT));
     h_patch_info.fe = (LocalEdgeT*)realloc(
         h_patch_info.fe, p_faces_capacity * 3 * sizeof(LocalEdgeT));
@@ -964,8 +1264,8 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
                               cudaMemcpyHostToDevice));
     }
 
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.dirty, sizeof(int)));
-    m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(sizeof(int));
+    CUDA_ERROR(device_malloc((void**)&d_patch.dirty, sizeof(int), managed));
+    topo_mega_bytes += BYTES_TO_MEGABYTES(sizeof(int));
     CUDA_ERROR(cudaMemset(d_patch.dirty, 0, sizeof(int)));
 
 
@@ -976,8 +1276,8 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
                        auto       predicate) {
         size_t num_bytes = detail::mask_num_bytes(capacity);
         h_mask           = (uint32_t*)malloc(num_bytes);
-        CUDA_ERROR(cudaMalloc((void**)&d_mask, num_bytes));
-        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(num_bytes);
+        CUDA_ERROR(device_malloc((void**)&d_mask, num_bytes, managed));
+        topo_mega_bytes += BYTES_TO_MEGABYTES(num_bytes);
 
         for (uint16_t i = 0; i < capacity; ++i) {
             if (predicate(i)) {
@@ -1084,9 +1384,9 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
         }
 
         h_hashtable = LPHashTable(capacity, false);
-        d_hashtable = LPHashTable(capacity, true);
-        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(d_hashtable.num_bytes());
-        m_topo_memory_mega_bytes +=
+        d_hashtable = LPHashTable(capacity, true, managed);
+        topo_mega_bytes += BYTES_TO_MEGABYTES(d_hashtable.num_bytes());
+        topo_mega_bytes +=
             BYTES_TO_MEGABYTES(LPHashTable::stash_size * sizeof(LPPair));
 
         for (uint16_t i = 0; i < num_not_owned; ++i) {
@@ -1165,18 +1465,20 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
 
     CUDA_ERROR(cudaMemcpy(
         &d_patch_info, &d_patch, sizeof(PatchInfo), cudaMemcpyHostToDevice));
+
+#pragma omp atomic
+    m_topo_memory_mega_bytes += topo_mega_bytes;
 }
 
-void RXMesh::allocate_extra_patches()
+void RXMesh::allocate_extra_patches(const uint32_t begin)
 {
 
     const uint16_t p_vertices_capacity = get_per_patch_max_vertex_capacity();
     const uint16_t p_edges_capacity    = get_per_patch_max_edge_capacity();
     const uint16_t p_faces_capacity    = get_per_patch_max_face_capacity();
 
-#pragma omp parallel for
-    for (int p = get_num_patches(); p < static_cast<int>(get_max_num_patches());
-         ++p) {
+#pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
+    for (int p = begin; p < static_cast<int>(get_max_num_patches()); ++p) {
 
         const uint16_t p_num_vertices = 0;
         const uint16_t p_num_edges    = 0;
@@ -1205,7 +1507,7 @@ void RXMesh::allocate_extra_patches()
     }
 
 
-    for (uint32_t p = get_num_patches(); p < get_max_num_patches(); ++p) {
+    for (uint32_t p = begin; p < get_max_num_patches(); ++p) {
         m_max_capacity_lp_v = std::max(m_max_capacity_lp_v,
                                        m_h_patches_info[p].lp_v.get_capacity());
 
@@ -2,9 +2,12 @@
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include "rxmesh/attribute_pool.h"
 #include "rxmesh/context.h"
 #include "rxmesh/handle.h"
 #include "rxmesh/patch_info.h"
+#include "rxmesh/patch_partition.h"
+#include "rxmesh/patch_residency.h"
 #include "rxmesh/patcher/patcher.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/log.h"
@@ -163,6 +166,19 @@ class RXMesh
         return m_max_num_patches;
     }
 
+    /**
+     * @brief the number of patch slots i.e., the number of entries allocated
+     * for the per-patch tables (PatchInfo, prefix sums, attributes pointers,
+     * and the patch scheduler). The maximum number of patches can grow (see
+     * RXMeshDynamic::grow_spare_patches) up to this number without
+     * reallocating these tables and so copies of the context or attributes
+     * remain valid
+     */
+    uint32_t get_num_patch_slots() const
+    {
+        return m_num_patch_slots;
+    }
+
     /**
      * @brief Returns the number of disconnected component the input mesh is
      * composed of
@@ -381,6 +397,87 @@ class RXMesh
         return m_topo_memory_mega_bytes;
     }
 
+    /**
+     * @brief return the number of host (OpenMP) threads used to build the
+     * mesh data structures
+     */
+    int get_num_threads() const
+    {
+        return m_num_threads;
+    }
+
+    /**
+     * @brief returns true if the mesh is streamed i.e., its patches are
+     * allocated as managed memory and only a subset of them is kept on the
+     * device at a time (see PatchResidency)
+     */
+    bool is_streaming() const
+    {
+        return m_max_resident_patches > 0;
+    }
+
+    /**
+     * @brief maximum number of patches kept on the device in streaming mode.
+     * Zero means that streaming is disabled and all patches are on the device
+     */
+    uint32_t get_max_resident_patches() const
+    {
+        return m_max_resident_patches;
+    }
+
+    /**
+     * @brief returns true if the patches are split over multiple GPUs (see
+     * PatchPartition)
+     */
+    bool is_multi_gpu() const
+    {
+        return m_partition.get_num_gpus() > 1;
+    }
+
+    /**
+     * @brief number of GPUs the patches are split over
+     */
+    int get_num_gpus() const
+    {
+        return m_partition.get_num_gpus();
+    }
+
+    /**
+     * @brief the partition of the patches over the GPUs
+     */
+    const PatchPartition& get_partition() const
+    {
+        return m_partition;
+    }
+
+    /**
+     * @brief returns true if the per-patch device memory is allocated as
+     * managed memory which is the case in streaming and multi-GPU modes
+     */
+    bool is_device_memory_managed() const
+    {
+        return is_streaming() || m_num_gpus > 1;
+    }
+
+    /**
+     * @brief returns true if every patch is allocated with exactly its number
+     * of vertices, edges, and faces (see RXMeshStatic constructors) rather
+     * than the maximum capacity over all patches
+     */
+    bool is_compact() const
+    {
+        return m_compact;
+    }
+
+    /**
+     * @brief the pool of device allocations shared by the attributes of this
+     * mesh (see AttributePool)
+     */
+    AttributePool& get_attribute_pool() const
+    {
+        return m_attr_pool;
+    }
+
    protected:
     // Edge hash map that takes two vertices and return their edge id
     using EdgeMapT = std::unordered_map<std::pair<uint32_t, uint32_t>,
@@ -391,7 +488,9 @@ class RXMesh
 
     RXMesh(const RXMesh&) = delete;
 
-    RXMesh(uint32_t patch_size);
+    RXMesh(uint32_t patch_size,
+           uint32_t max_resident_patches = 0,
+           int      num_gpus             = 1);
 
     /**
      * @brief init all the data structures
@@ -405,30 +504,143 @@ class RXMesh
      * patch_alloc_factor*x patches
      * @param lp_hashtable_load_factor loading factor for the hashtable use for
      * the not-owned vertices/edges/faces
+     * @param num_threads number of host threads used to build the mesh. If it
+     * is less than one, OpenMP default number of threads is used
      */
     void init(const std::vector<std::vector<uint32_t>>& fv,
               const std::string                         patcher_file    = "",
               const float                               capacity_factor = 1.8,
               const float patch_alloc_factor                            = 5.0,
-              const float lp_hashtable_load_factor                      = 0.5);
+              const float lp_hashtable_load_factor                      = 0.5,
+              const int   num_threads                                   = -1);
+
+    /**
+     * @brief init all the data structures from triangles stored contiguously
+     * i.e., the vertices of face f are fv[3 * f], fv[3 * f + 1], and
+     * fv[3 * f + 2]. Parameters are the same as the other init
+     */
+    void init(const std::vector<uint32_t>& fv,
+              const std::string            patcher_file             = "",
+              const float                  capacity_factor          = 1.8,
+              const float                  patch_alloc_factor       = 5.0,
+              const float                  lp_hashtable_load_factor = 0.5,
+              const int                    num_threads              = -1);
+
+    /**
+     * @brief init all the data structures from a mesh connectivity that lives
+     * on the device. This is not a device-resident build: only the edges,
+     * edge incident faces, and face adjacent faces are built on the device
+     * (and the face adjacency is handed to the patcher without a round trip
+     * to the host). The patches ltog mapping, ribbons, LP hashtables, and
+     * PatchInfo are built on the host, since the host mirrors of them are used
+     * throughout RXMesh, and then copied to the device as in the other init.
+     * Parameters are the same as the other init
+     * @param d_fv device pointer to the face indices stored as 3 * num_faces
+     * contiguous vertex ids
+     * @param num_faces number of faces (triangles) in d_fv
+     */
+    void init(const uint32_t*   d_fv,
+              const uint32_t    num_faces,
+              const std::string patcher_file             = "",
+              const float       capacity_factor          = 1.8,
+              const float       patch_alloc_factor       = 5.0,
+              const float       lp_hashtable_load_factor = 0.5,
+              const int         num_threads              = -1);
+
+    /**
+     * @brief check and store the construction parameters used by init
+     */
+    void init_parameters(const float capacity_factor,
+                         const float patch_alloc_factor,
+                         const float lp_hashtable_load_factor,
+                         const int   num_threads);
+
+    /**
+     * @brief init all the data structures from a mesh cache written by
+     * write_cache. Construction parameters (patch size, capacity factor, etc)
+     * are those stored in the cache
+     * @param cache_file path to the cache file
+     * @param vertices output flat vertex coordinates (3 * #vertices) if they
+     * are stored in the cache. Otherwise, it is left empty
+     * @param num_threads number of host threads used to load the mesh. If it
+     * is less than one, OpenMP default number of threads is used
+     * @return false if the file is not a valid cache (or written by a
+     * different version) in which case nothing is initialized
+     */
+    bool init_from_cache(const std::string   cache_file,
+                         std::vector<float>& vertices,
+                         const int           num_threads = -1);
+
+    /**
+     * @brief write a binary snapshot of the mesh to a file that can be loaded
+     * with init_from_cache. The snapshot holds the patcher, the per-patch
+     * ltog, topology, masks, patch stash, and hash tables along with the
+     * prefixes used in Context. The snapshot is taken from the host copy of the
+     * patches
+     * @param filename output file
+     * @param vertices optional flat vertex coordinates (3 * #vertices in the
+     * input order) to store in the cache
+     */
+    void write_cache(const std::string         filename,
+                     const std::vector<float>& vertices) const;
+
+    /**
+     * @brief move the patches to the device, allocate the extra patches, and
+     * initialize the scheduler and context. Called by init after building the
+     * patches on the host
+     */
+    void init_device();
+
+    /**
+     * @brief initialize the scheduler, allocate the extra patches, and
+     * initialize the context given that the patches are already on the device
+     */
+    void init_context();
 
     /**
      * @brief build different supporting data structure used to build RXMesh
      *
      * Set the number of vertices, edges, and faces, populate edge_map (which
      * takes two connected vertices and returns their edge id), build
-     * face-incident-faces data structure (used to in creating patches). This is
-     * done using a single pass over FV
+     * face-incident-faces data structure (used to in creating patches). Edges
+     * are discovered by sorting the faces' half-edges (in parallel) instead of
+     * inserting them one at a time in edge_map
      *
-     * @param fv input face incident vertices
-     * @param ef output edge incident faces
-     * @param ef output face adjacent faces
+     * @param fv input face incident vertices (three per face)
+     * @param edges output edge key (see detail::edge_key) of every edge
+     * indexed by the edge id
+     * @param ef_offset output edge incident faces offset (inclusive scan)
+     * @param ef_values output edge incident faces in compressed format
+     * @param ff_offset output face adjacent faces offset (inclusive scan)
+     * @param ff_values output face adjacent faces in compressed format
      */
     void build_supporting_structures(
-        const std::vector<std::vector<uint32_t>>& fv,
-        std::vector<std::vector<uint32_t>>&       ef,
-        std::vector<uint32_t>&                    ff_offset,
-        std::vector<uint32_t>&                    ff_values);
+        const std::vector<uint32_t>&                fv,
+        std::vector<std::pair<uint32_t, uint32_t>>& edges,
+        std::vector<uint32_t>&                      ef_offset,
+        std::vector<uint32_t>&                      ef_values,
+        std::vector<uint32_t>&                      ff_offset,
+        std::vector<uint32_t>&                      ff_values);
+
+    /**
+     * @brief device version of build_supporting_structures that takes the
+     * face indices on the device (3 * num_faces contiguous ids). On return,
+     * the output host vectors are populated as in
+     * build_supporting_structures except for the edge incident faces values
+     * which are only needed on the device and are not downloaded. In
+     * addition, d_ff_offset and d_ff_values are allocated on the device and
+     * hold the face adjacent faces (caller should free them)
+     */
+    void build_supporting_structures_on_device(
+        const uint32_t*                             d_fv,
+        const uint32_t                              num_faces,
+        std::vector<uint32_t>&                      fv,
+        std::vector<std::pair<uint32_t, uint32_t>>& edges,
+        std::vector<uint32_t>&                      ef_offset,
+        std::vector<uint32_t>&                      ff_offset,
+        std::vector<uint32_t>&                      ff_values,
+        uint32_t*&                                  d_ff_offset,
+        uint32_t*&                                  d_ff_values);
 
     /**
      * @brief Calculate various statistics for the input mesh
@@ -438,10 +650,15 @@ class RXMesh
      * vertices/edges/faces per patch
      *
      * @param fv input face incident vertices
-     * @param ef input edge incident faces
+     * @param edges input edge key of every edge
+     * @param ef_offset input edge incident faces offset
+     * @param ff_offset input face adjacent faces offset
      */
-    void calc_input_statistics(const std::vector<std::vector<uint32_t>>& fv,
-                               const std::vector<std::vector<uint32_t>>& ef);
+    void calc_input_statistics(
+        const std::vector<uint32_t>&                      fv,
+        const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+        const std::vector<uint32_t>&                      ef_offset,
+        const std::vector<uint32_t>&                      ff_offset);
 
     /**
      * @brief count the max number of vertices/edges/faces per patch and
@@ -454,8 +671,10 @@ class RXMesh
      * @brief allocate extra patches needed in cases the number of patches
      * increases. We allocate these patches space such that they can occupy the
      * same size as the largest patch in the input mesh
+     * @param begin the first patch to allocate. Patches from begin to
+     * get_max_num_patches() are allocated
      */
-    void allocate_extra_patches();
+    void allocate_extra_patches(const uint32_t begin);
 
     template <typename HandleT>
     const std::pair<uint32_t, uint16_t> map_to_local(
@@ -488,15 +707,39 @@ class RXMesh
         }
     }
 
-    void build(const std::vector<std::vector<uint32_t>>& fv,
-               const std::string                         patcher_file);
+    void build(const std::vector<uint32_t>& fv, const std::string patcher_file);
+
+    /**
+     * @brief build the edges, edge incident faces, and face adjacent faces on
+     * the device (see build_supporting_structures_on_device) and the rest,
+     * i.e., the patches ltog mapping, LP hashtables, ribbons, and PatchInfo,
+     * on the host from a single download of the device results
+     */
+    void build_with_device_adjacency(const uint32_t*   d_fv,
+                                     const uint32_t    num_faces,
+                                     const std::string patcher_file);
+
+    /**
+     * @brief build the patches, ltog mapping, and patches topology on the
+     * host given the supporting structures. If the face adjacent faces are
+     * already on the device (d_ff_offset and d_ff_values), they are used by the
+     * patcher instead of copying ff_offset and ff_values
+     */
+    void build_from_supporting_structures(
+        const std::vector<uint32_t>&                      fv,
+        const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+        const std::vector<uint32_t>&                      ef_offset,
+        const std::vector<uint32_t>&                      ff_offset,
+        const std::vector<uint32_t>&                      ff_values,
+        const std::string                                 patcher_file,
+        const uint32_t*                                   d_ff_offset = nullptr,
+        const uint32_t*                                   d_ff_values = nullptr);
 
-    void build_single_patch_ltog(const std::vector<std::vector<uint32_t>>& fv,
-                                 const uint32_t patch_id);
+    void build_single_patch_ltog(const std::vector<uint32_t>& fv,
+                                 const uint32_t               patch_id);
 
-    void build_single_patch_topology(
-        const std::vector<std::vector<uint32_t>>& fv,
-        const uint32_t                            patch_id);
+    void build_single_patch_topology(const std::vector<uint32_t>& fv,
+                                     const uint32_t               patch_id);
 
     // get the max vertex/edge/face capacity i.e., the max number of
     // vertices/edges/faces allowed in a patch (for allocation purposes)
@@ -521,6 +764,20 @@ class RXMesh
                                    PatchInfo&                   h_patch_info,
                                    PatchInfo&                   d_patch_info);
 
+    /**
+     * @brief restore a single patch (on the host and device) from its record
+     * in a mesh cache. This is the cache counterpart of
+     * build_device_single_patch
+     * @param patch_id the patch id
+     * @param record pointer to the start of the patch record in the mapped
+     * cache
+     * @param record_num_bytes number of bytes that can be read from record
+     * @return false if the record is truncated
+     */
+    bool load_single_patch_from_cache(const uint32_t patch_id,
+                                      const char*    record,
+                                      const size_t   record_num_bytes);
+
     uint32_t get_edge_id(const std::pair<uint32_t, uint32_t>& edge) const;
 
     friend class ::RXMeshTest;
@@ -543,8 +800,14 @@ class RXMesh
     bool m_is_input_closed;
 
 
-    uint32_t       m_num_patches, m_max_num_patches;
-    const uint32_t m_patch_size;
+    uint32_t m_num_patches, m_max_num_patches;
+    uint32_t m_patch_size;
+
+    // the number of per-patch table entries (see get_num_patch_slots()) as a
+    // multiple of the initial maximum number of patches. It is one unless the
+    // mesh can grow its spare patches (see RXMeshDynamic)
+    uint32_t m_patch_slots_factor;
+    uint32_t m_num_patch_slots;
 
     // pointer to the patcher class responsible for everything related to
     // patching the mesh into small pieces
@@ -579,6 +842,27 @@ class RXMesh
 
     float m_capacity_factor, m_lp_hashtable_load_factor, m_patch_alloc_factor;
 
+    // exact per-patch allocation for read-only (static) meshes. Requested by
+    // RXMeshStatic before calling init
+    bool m_compact;
+
     double m_topo_memory_mega_bytes;
+
+    int m_num_threads;
+
+    // streaming of patches. The residency is updated by (const) kernel
+    // launches and so it is mutable
+    uint32_t               m_max_resident_patches;
+    mutable PatchResidency m_residency;
+
+    // split of the patches over multiple GPUs. m_num_gpus is the requested
+    // number of GPUs and m_partition holds the ones actually used
+    int            m_num_gpus;
+    PatchPartition m_partition;
+
+    // device memory of released attributes kept for reuse. Being a member of
+    // the base class, it outlives the attribute container of RXMeshStatic
+    // (see AttributePool)
+    mutable AttributePool m_attr_pool;
 };
 }  // namespace rxmesh
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a device-side view of RXMeshBatch that maps a handle to the mesh it
+ * belongs to. It can be passed by value to kernels along with the Context
+ */
+struct BatchInfo
+{
+    const uint32_t* m_patch_mesh = nullptr;
+    uint32_t        m_num_meshes = 0;
+
+    /**
+     * @brief the index of the (input) mesh the handle belongs to
+     */
+    template <typename HandleT>
+    __device__ __inline__ uint32_t mesh_id(const HandleT& h) const
+    {
+        return m_patch_mesh[h.patch_id()];
+    }
+
+    __device__ __host__ __inline__ uint32_t get_num_meshes() const
+    {
+        return m_num_meshes;
+    }
+};
+
+/**
+ * @brief many (small) meshes packed into a single RXMeshStatic i.e., a single
+ * Context and patch array such that for_each, queries, and reductions run on
+ * all meshes in one launch instead of one launch (and one allocation) per
+ * mesh. The meshes are concatenated as disjoint connected components and since
+ * the patcher grows patches over the face adjacency (with at least one patch
+ * per component), every patch belongs to exactly one mesh. The patches of
+ * every mesh are stored as a CSR (per-mesh prefix offsets into a list of
+ * patches) which is used for per-mesh reductions
+ */
+class RXMeshBatch : public RXMeshStatic
+{
+   public:
+    using FVBatch       = std::vector<std::vector<std::vector<uint32_t>>>;
+    using VerticesBatch = std::vector<std::vector<std::vector<float>>>;
+
+    RXMeshBatch(const RXMeshBatch&) = delete;
+
+    /**
+     * @brief Constructor using the triangles (and optionally vertices) of
+     * every mesh as read from an obj file. The vertex ids of every mesh are
+     * local to it
+     * @param fv_batch the face incident vertices of every mesh
+     * @param vertices_batch the vertex coordinates of every mesh. If empty,
+     * the number of vertices of a mesh is its max vertex id plus one and the
+     * coordinates can be added later with add_vertex_coordinates
+     * @param num_threads number of host threads used to build the mesh (less
+     * than one means OpenMP default)
+     */
+    explicit RXMeshBatch(const FVBatch&       fv_batch,
+                         const VerticesBatch& vertices_batch           = {},
+                         const uint32_t       patch_size               = 512,
+                         const float          capacity_factor          = 1.0,
+                         const float          patch_alloc_factor       = 1.0,
+                         const float          lp_hashtable_load_factor = 0.8,
+                         const int            num_threads              = -1)
+        : RXMeshStatic(flatten_fv(fv_batch, vertices_batch),
+                       flatten_vertices(vertices_batch),
+                       "",
+                       batch_patch_size(fv_batch, patch_size),
+                       capacity_factor,
+                       patch_alloc_factor,
+                       lp_hashtable_load_factor,
+                       num_threads)
+    {
+        init_batch(fv_batch, vertices_batch);
+    }
+
+    virtual ~RXMeshBatch()
+    {
+        GPU_FREE(m_d_patch_mesh);
+        GPU_FREE(m_d_mesh_patch_offset);
+        GPU_FREE(m_d_mesh_patches);
+    }
+
+    /**
+     * @brief the number of meshes in the batch
+     */
+    uint32_t get_num_meshes() const
+    {
+        return m_num_meshes;
+    }
+
+    /**
+     * @brief the number of vertices of mesh m
+     */
+    uint32_t get_mesh_num_vertices(const uint32_t m) const
+    {
+        return m_h_vertex_offset[m + 1] - m_h_vertex_offset[m];
+    }
+
+    /**
+     * @brief the number of edges of mesh m
+     */
+    uint32_t get_mesh_num_edges(const uint32_t m) const
+    {
+        return m_h_mesh_num_edges[m];
+    }
+
+    /**
+     * @brief the number of faces of mesh m
+     */
+    uint32_t get_mesh_num_faces(const uint32_t m) const
+    {
+        return m_h_face_offset[m + 1] - m_h_face_offset[m];
+    }
+
+    /**
+     * @brief the patches of mesh m
+     */
+    std::vector<uint32_t> get_mesh_patches(const uint32_t m) const
+    {
+        return std::vector<uint32_t>(
+            m_h_mesh_patches.begin() + m_h_mesh_patch_offset[m],
+            m_h_mesh_patches.begin() + m_h_mesh_patch_offset[m + 1]);
+    }
+
+    /**
+     * @brief the mesh that patch p belongs to
+     */
+    uint32_t get_patch_mesh(const uint32_t p) const
+    {
+        return m_h_patch_mesh[p];
+    }
+
+    /**
+     * @brief the index of the mesh the handle belongs to (on the host). Use
+     * get_batch_info() on the device
+     */
+    template <typename HandleT>
+    uint32_t get_mesh_id(const HandleT& h) const
+    {
+        return m_h_patch_mesh[h.patch_id()];
+    }
+
+    /**
+     * @brief the device-side view of the batch which maps handles to meshes
+     */
+    BatchInfo get_batch_info() const
+    {
+        BatchInfo info;
+        info.m_patch_mesh = m_d_patch_mesh;
+        info.m_num_meshes = m_num_meshes;
+        return info;
+    }
+
+    /**
+     * @brief map a vertex handle to its mesh and its index in the input of
+     * this mesh (i.e., fv_batch[mesh])
+     */
+    std::pair<uint32_t, uint32_t> map_to_mesh(const VertexHandle vh) const
+    {
+        const uint32_t m = get_mesh_id(get_owner_handle(vh));
+        return {m, map_to_global(vh) - m_h_vertex_offset[m]};
+    }
+
+    /**
+     * @brief map a face handle to its mesh and its index in the input of this
+     * mesh (i.e., fv_batch[mesh])
+     */
+    std::pair<uint32_t, uint32_t> map_to_mesh(const FaceHandle fh) const
+    {
+        const uint32_t m = get_mesh_id(get_owner_handle(fh));
+        return {m, map_to_global(fh) - m_h_face_offset[m]};
+    }
+
+    /**
+     * @brief reduce an attribute over every mesh of the batch in a single
+     * pass (see ReduceHandle::reduce)
+     * @param reduce_handle a reduce handle created from attr
+     * @param h_output host array of get_num_meshes() values
+     */
+    template <typename T, typename HandleT, typename ReductionOp>
+    void reduce_per_mesh(ReduceHandle<T, HandleT>&    reduce_handle,
+                         const Attribute<T, HandleT>& attr,
+                         ReductionOp                  reduction_op,
+                         T                            init,
+                         T*                           h_output,
+                         uint32_t                     attribute_id = INVALID32,
+                         cudaStream_t stream = NULL) const
+    {
+        reduce_handle.segmented_reduce(attr,
+                                       reduction_op,
+                                       init,
+                                       m_num_meshes,
+                                       m_d_mesh_patch_offset,
+                                       m_d_mesh_patches,
+                                       h_output,
+                                       attribute_id,
+                                       stream);
+    }
+
+    /**
+     * @brief sum an attribute over every mesh of the batch in a single pass
+     * @param reduce_handle a reduce handle created from attr
+     * @param attribute_id specific attribute ID to sum. Default is INVALID32
+     * which sums all attributes
+     * @return the sum of every mesh
+     */
+    template <typename T, typename HandleT>
+    std::vector<T> sum_per_mesh(ReduceHandle<T, HandleT>&    reduce_handle,
+                                const Attribute<T, HandleT>& attr,
+                                uint32_t     attribute_id = INVALID32,
+                                cudaStream_t stream       = NULL) const
+    {
+        std::vector<T> ret(m_num_meshes);
+        reduce_per_mesh(reduce_handle,
+                        attr,
+                        cub::Sum(),
+                        T(0),
+                        ret.data(),
+                        attribute_id,
+                        stream);
+        return ret;
+    }
+
+   private:
+    static std::vector<uint32_t> mesh_num_vertices(
+        const FVBatch&       fv_batch,
+        const VerticesBatch& vertices_batch)
+    {
+        if (!vertices_batch.empty() &&
+            vertices_batch.size() != fv_batch.size()) {
+            RXMESH_ERROR(
+                "RXMeshBatch::RXMeshBatch() the number of vertex buffers ({}) "
+                "is different than the number of meshes ({})",
+                vertices_batch.size(),
+                fv_batch.size());
+            exit(EXIT_FAILURE);
+        }
+
+        std::vector<uint32_t> num_v(fv_batch.size(), 0);
+        for (size_t m = 0; m < fv_batch.size(); ++m) {
+            if (!vertices_batch.empty()) {
+                num_v[m] = static_cast<uint32_t>(vertices_batch[m].size());
+            } else {
+                for (const auto& f : fv_batch[m]) {
+                    for (const uint32_t v : f) {
+                        num_v[m] = std::max(num_v[m], v + 1);
+                    }
+                }
+            }
+        }
+        return num_v;
+    }
+
+    static std::vector<uint32_t> flatten_fv(
+        const FVBatch&       fv_batch,
+        const VerticesBatch& vertices_batch)
+    {
+        const std::vector<uint32_t> num_v =
+            mesh_num_vertices(fv_batch, vertices_batch);
+
+        std::vector<uint32_t> fv;
+        uint32_t              v_offset = 0;
+        for (size_t m = 0; m < fv_batch.size(); ++m) {
+            for (const auto& f : fv_batch[m]) {
+                if (f.size() != 3) {
+                    RXMESH_ERROR(
+                        "RXMeshBatch::RXMeshBatch() mesh {} has a non-triangle "
+                        "face",
+                        m);
+                    exit(EXIT_FAILURE);
+                }
+                for (const uint32_t v : f) {
+                    fv.push_back(v + v_offset);
+                }
+            }
+            v_offset += num_v[m];
+        }
+        return fv;
+    }
+
+    static std::vector<float> flatten_vertices(
+        const VerticesBatch& vertices_batch)
+    {
+        std::vector<float> vertices;
+        for (const auto& verts : vertices_batch) {
+            for (const auto& v : verts) {
+                vertices.insert(vertices.end(), v.begin(), v.begin() + 3);
+            }
+        }
+        return vertices;
+    }
+
+    static uint32_t batch_patch_size(const FVBatch& fv_batch,
+                                     const uint32_t patch_size)
+    {
+        // a mesh with fewer faces than the patch size is a single patch
+        // (regardless of its connected components) and so the patch size is
+        // capped to guarantee that the patcher runs and assign at least one
+        // patch to every mesh
+        size_t num_faces = 0;
+        for (const auto& fv : fv_batch) {
+            num_faces += fv.size();
+        }
+        if (fv_batch.size() > 1 && num_faces > 1 && num_faces <= patch_size) {
+            return static_cast<uint32_t>(num_faces - 1);
+        }
+        return patch_size;
+    }
+
+    /**
+     * @brief the mesh of a face given its global index
+     */
+    uint32_t face_mesh(const uint32_t global_f) const
+    {
+        auto it = std::upper_bound(
+            m_h_face_offset.begin(), m_h_face_offset.end(), global_f);
+        return static_cast<uint32_t>(it - m_h_face_offset.begin()) - 1;
+    }
+
+    void init_batch(
+        const FVBatch&       fv_batch,
+        const VerticesBatch& vertices_batch)
+    {
+        m_num_meshes = static_cast<uint32_t>(fv_batch.size());
+
+        const std::vector<uint32_t> num_v =
+            mesh_num_vertices(fv_batch, vertices_batch);
+
+        m_h_vertex_offset.resize(m_num_meshes + 1, 0);
+        m_h_face_offset.resize(m_num_meshes + 1, 0);
+        for (uint32_t m = 0; m < m_num_meshes; ++m) {
+            m_h_vertex_offset[m + 1] = m_h_vertex_offset[m] + num_v[m];
+            m_h_face_offset[m + 1] =
+                m_h_face_offset[m] + static_cast<uint32_t>(fv_batch[m].size());
+        }
+
+        if (m_h_vertex_offset.back() != get_num_vertices()) {
+            RXMESH_ERROR(
+                "RXMeshBatch::init_batch() the total number of vertices ({}) "
+                "is different than the number of vertices in the patches ({}). "
+                "Every mesh should not have unreferenced vertices",
+                m_h_vertex_offset.back(),
+                get_num_vertices());
+        }
+
+        // the mesh of every patch is the mesh of its owned faces
+        const uint32_t num_patches = get_num_patches();
+        m_h_patch_mesh.resize(get_max_num_patches(), INVALID32);
+        m_h_mesh_num_edges.resize(m_num_meshes, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            for (uint16_t f = 0; f < m_h_num_owned_f[p]; ++f) {
+                const uint32_t global_f = m_h_patches_ltog_f[p][f];
+
+                const uint32_t m = face_mesh(global_f);
+                if (m_h_patch_mesh[p] == INVALID32) {
+                    m_h_patch_mesh[p] = m;
+                } else if (m_h_patch_mesh[p] != m) {
+                    RXMESH_ERROR(
+                        "RXMeshBatch::init_batch() patch {} has faces from "
+                        "mesh {} and mesh {}",
+                        p,
+                        m_h_patch_mesh[p],
+                        m);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if (m_h_patch_mesh[p] != INVALID32) {
+                m_h_mesh_num_edges[m_h_patch_mesh[p]] += m_h_num_owned_e[p];
+            }
+        }
+
+        // CSR of the patches of every mesh
+        m_h_mesh_patch_offset.resize(m_num_meshes + 1, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (m_h_patch_mesh[p] != INVALID32) {
+                m_h_mesh_patch_offset[m_h_patch_mesh[p] + 1]++;
+            }
+        }
+        std::partial_sum(m_h_mesh_patch_offset.begin(),
+                         m_h_mesh_patch_offset.end(),
+                         m_h_mesh_patch_offset.begin());
+
+        m_h_mesh_patches.resize(m_h_mesh_patch_offset.back());
+        std::vector<uint32_t> pos(m_h_mesh_patch_offset.begin(),
+                                  m_h_mesh_patch_offset.end() - 1);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (m_h_patch_mesh[p] != INVALID32) {
+                m_h_mesh_patches[pos[m_h_patch_mesh[p]]++] = p;
+            }
+        }
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_patch_mesh,
+                              m_h_patch_mesh.size() * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemcpy(m_d_patch_mesh,
+                              m_h_patch_mesh.data(),
+                              m_h_patch_mesh.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        CUDA_ERROR(cudaMalloc((void**)&m_d_mesh_patch_offset,
+                              m_h_mesh_patch_offset.size() * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemcpy(m_d_mesh_patch_offset,
+                              m_h_mesh_patch_offset.data(),
+                              m_h_mesh_patch_offset.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        CUDA_ERROR(cudaMalloc(
+            (void**)&m_d_mesh_patches,
+            std::max<size_t>(m_h_mesh_patches.size(), 1) * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemcpy(m_d_mesh_patches,
+                              m_h_mesh_patches.data(),
+                              m_h_mesh_patches.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        RXMESH_TRACE(
+            "RXMeshBatch::init_batch() {} meshes with {} vertices and {} faces "
+            "in {} patches",
+            m_num_meshes,
+            get_num_vertices(),
+            get_num_faces(),
+            num_patches);
+    }
+
+    uint32_t m_num_meshes = 0;
+
+    // per-mesh prefix offsets of the input vertices and faces
+    std::vector<uint32_t> m_h_vertex_offset, m_h_face_offset;
+    std::vector<uint32_t> m_h_mesh_num_edges;
+
+    // the mesh of every patch and the (CSR) patches of every mesh
+    std::vector<uint32_t> m_h_patch_mesh;
+    std::vector<uint32_t> m_h_mesh_patch_offset, m_h_mesh_patches;
+
+    uint32_t* m_d_patch_mesh        = nullptr;
+    uint32_t* m_d_mesh_patch_offset = nullptr;
+    uint32_t* m_d_mesh_patches      = nullptr;
+};
+}  // namespace rxmesh
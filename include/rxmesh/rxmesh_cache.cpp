@@ -0,0 +1,663 @@
+#include <omp.h>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "rxmesh/patcher/patcher.h"
+#include "rxmesh/rxmesh.h"
+#include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/mesh_cache.h"
+
+namespace rxmesh {
+
+namespace {
+// Per hash table record in the cache. Capacity is stored as is (i.e., it is
+// already a prime number) since re-creating the table using its capacity
+// would round it up to the next prime number
+struct LPHashTableRecord
+{
+    uint16_t           capacity;
+    uint16_t           max_cuckoo_chains;
+    uint32_t           padding;
+    LPHashTable::HashT hashers[4];
+};
+}  // namespace
+
+void RXMesh::write_cache(const std::string         filename,
+                         const std::vector<float>& vertices) const
+{
+    // Layout of the cache (every section is aligned to MESH_CACHE_ALIGNMENT)
+    // header | patcher | edges | num owned v/e/f | prefix v/e/f |
+    // vertex coordinates (optional) | patch offsets | patch records
+    // where every patch record is
+    // counts | ltog v/e/f | ev | fe | active mask v/e/f | owned mask v/e/f |
+    // patch stash | lp_v | lp_e | lp_f
+
+    detail::MeshCacheWriter writer(filename);
+    if (!writer.is_open()) {
+        RXMESH_ERROR("RXMesh::write_cache can not open {}", filename);
+        return;
+    }
+
+    const bool has_coordinates = vertices.size() == 3 * size_t(m_num_vertices);
+    if (!vertices.empty() && !has_coordinates) {
+        RXMESH_WARN(
+            "RXMesh::write_cache the number of vertex coordinates ({}) is not "
+            "the same as the number of vertices ({}). Vertex coordinates will "
+            "not be written to the cache",
+            vertices.size() / 3,
+            m_num_vertices);
+    }
+
+    MeshCacheHeader header;
+    std::memset(&header, 0, sizeof(MeshCacheHeader));
+    std::memcpy(header.magic, MeshCacheHeader::MAGIC, 4);
+    header.version                       = MeshCacheHeader::MESH_CACHE_VERSION;
+    header.num_vertices                  = m_num_vertices;
+    header.num_edges                     = m_num_edges;
+    header.num_faces                     = m_num_faces;
+    header.num_patches                   = m_num_patches;
+    header.max_num_patches               = m_max_num_patches;
+    header.patch_size                    = m_patch_size;
+    header.max_vertices_per_patch        = m_max_vertices_per_patch;
+    header.max_edges_per_patch           = m_max_edges_per_patch;
+    header.max_faces_per_patch           = m_max_faces_per_patch;
+    header.max_vertex_capacity           = m_max_vertex_capacity;
+    header.max_edge_capacity             = m_max_edge_capacity;
+    header.max_face_capacity             = m_max_face_capacity;
+    header.input_max_valence             = m_input_max_valence;
+    header.input_max_edge_incident_faces = m_input_max_edge_incident_faces;
+    header.input_max_face_adjacent_faces = m_input_max_face_adjacent_faces;
+    header.is_input_edge_manifold        = m_is_input_edge_manifold;
+    header.is_input_closed               = m_is_input_closed;
+    header.has_vertex_coordinates        = has_coordinates;
+    header.capacity_factor               = m_capacity_factor;
+    header.patch_alloc_factor            = m_patch_alloc_factor;
+    header.lp_hashtable_load_factor      = m_lp_hashtable_load_factor;
+    header.local_index_bytes             = sizeof(LocalVertexT);
+    header.lp_pair_bytes                 = sizeof(LPPair);
+    header.patch_stash_size              = PatchStash::stash_size;
+    header.lp_stash_size                 = LPHashTable::stash_size;
+
+    // header is re-written at the end once we know the sizes
+    const size_t header_offset = writer.offset();
+    writer.write(&header, 1);
+
+    // patcher
+    const size_t patcher_offset = writer.offset();
+    m_patcher->save(writer.stream());
+    header.patcher_num_bytes = writer.offset() - patcher_offset;
+    writer.write<char>(nullptr, 0);
+
+    // edges (used to re-create the edge map)
+    std::vector<std::pair<uint32_t, uint32_t>> edges(m_num_edges);
+    for (const auto& it : m_edges_map) {
+        edges[it.second] = it.first;
+    }
+    writer.write(edges.data(), edges.size());
+
+    writer.write(m_h_num_owned_v.data(), m_num_patches);
+    writer.write(m_h_num_owned_e.data(), m_num_patches);
+    writer.write(m_h_num_owned_f.data(), m_num_patches);
+
+    writer.write(m_h_vertex_prefix, m_max_num_patches + 1);
+    writer.write(m_h_edge_prefix, m_max_num_patches + 1);
+    writer.write(m_h_face_prefix, m_max_num_patches + 1);
+
+    if (has_coordinates) {
+        writer.write(vertices.data(), vertices.size());
+    }
+
+    // patch offsets are re-written once all patches are written
+    std::vector<uint64_t> patch_offset(m_num_patches, 0);
+    const size_t          patch_offset_offset = writer.offset();
+    writer.write(patch_offset.data(), patch_offset.size());
+
+    auto write_ht = [&](const LPHashTable& ht) {
+        LPHashTableRecord rec;
+        std::memset(&rec, 0, sizeof(LPHashTableRecord));
+        rec.capacity          = ht.m_capacity;
+        rec.max_cuckoo_chains = ht.m_max_cuckoo_chains;
+        rec.hashers[0]        = ht.m_hasher0;
+        rec.hashers[1]        = ht.m_hasher1;
+        rec.hashers[2]        = ht.m_hasher2;
+        rec.hashers[3]        = ht.m_hasher3;
+        writer.write(&rec, 1);
+        writer.write(ht.m_table, ht.m_capacity);
+        writer.write(ht.m_stash, LPHashTable::stash_size);
+    };
+
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        patch_offset[p] = writer.offset();
+
+        const PatchInfo& pi = m_h_patches_info[p];
+
+        // counts and capacities are contiguous (see build_device_single_patch)
+        writer.write(pi.num_faces, 6);
+
+        const auto& ltog_v = m_h_patches_ltog_v[p];
+        const auto& ltog_e = m_h_patches_ltog_e[p];
+        const auto& ltog_f = m_h_patches_ltog_f[p];
+        writer.write(ltog_v.data(), ltog_v.size());
+        writer.write(ltog_e.data(), ltog_e.size());
+        writer.write(ltog_f.data(), ltog_f.size());
+
+        writer.write(pi.ev, 2 * size_t(pi.num_edges[0]));
+        writer.write(pi.fe, 3 * size_t(pi.num_faces[0]));
+
+        const size_t v_mask = detail::mask_num_bytes(pi.vertices_capacity[0]);
+        const size_t e_mask = detail::mask_num_bytes(pi.edges_capacity[0]);
+        const size_t f_mask = detail::mask_num_bytes(pi.faces_capacity[0]);
+
+        writer.write(reinterpret_cast<const char*>(pi.active_mask_v), v_mask);
+        writer.write(reinterpret_cast<const char*>(pi.active_mask_e), e_mask);
+        writer.write(reinterpret_cast<const char*>(pi.active_mask_f), f_mask);
+        writer.write(reinterpret_cast<const char*>(pi.owned_mask_v), v_mask);
+        writer.write(reinterpret_cast<const char*>(pi.owned_mask_e), e_mask);
+        writer.write(reinterpret_cast<const char*>(pi.owned_mask_f), f_mask);
+
+        writer.write(pi.patch_stash.m_stash, PatchStash::stash_size);
+
+        write_ht(pi.lp_v);
+        write_ht(pi.lp_e);
+        write_ht(pi.lp_f);
+    }
+
+    header.file_num_bytes = writer.offset();
+    writer.write_at(patch_offset_offset, patch_offset.data(), m_num_patches);
+    writer.write_at(header_offset, &header, 1);
+
+    if (!writer.good()) {
+        RXMESH_ERROR("RXMesh::write_cache failed while writing {}", filename);
+        return;
+    }
+
+    RXMESH_TRACE("RXMesh::write_cache wrote {} ({:.2f} MB)",
+                 filename,
+                 BYTES_TO_MEGABYTES(header.file_num_bytes));
+}
+
+bool RXMesh::init_from_cache(const std::string   cache_file,
+                             std::vector<float>& vertices,
+                             const int           num_threads)
+{
+    detail::MappedFile file(cache_file);
+    if (!file.is_open()) {
+        RXMESH_ERROR("RXMesh::init_from_cache can not open {}", cache_file);
+        return false;
+    }
+
+    detail::MeshCacheReader reader(file.data(), file.size());
+
+    const MeshCacheHeader* header = reader.read<MeshCacheHeader>(1);
+    if (header == nullptr ||
+        std::memcmp(header->magic, MeshCacheHeader::MAGIC, 4) != 0) {
+        RXMESH_ERROR("RXMesh::init_from_cache {} is not a mesh cache",
+                     cache_file);
+        return false;
+    }
+
+    if (header->version != MeshCacheHeader::MESH_CACHE_VERSION ||
+        header->local_index_bytes != sizeof(LocalVertexT) ||
+        header->lp_pair_bytes != sizeof(LPPair) ||
+        header->patch_stash_size != PatchStash::stash_size ||
+        header->lp_stash_size != LPHashTable::stash_size) {
+        RXMESH_ERROR(
+            "RXMesh::init_from_cache {} is written with a different (version "
+            "{}) or incompatible cache format. Expected version {}. The cache "
+            "should be re-generated",
+            cache_file,
+            header->version,
+            MeshCacheHeader::MESH_CACHE_VERSION);
+        return false;
+    }
+
+    if (header->file_num_bytes != file.size()) {
+        RXMESH_ERROR(
+            "RXMesh::init_from_cache {} is truncated. Expected {} bytes but "
+            "found {} bytes",
+            cache_file,
+            header->file_num_bytes,
+            file.size());
+        return false;
+    }
+
+    init_parameters(header->capacity_factor,
+                    header->patch_alloc_factor,
+                    header->lp_hashtable_load_factor,
+                    num_threads);
+
+    m_num_vertices                  = header->num_vertices;
+    m_num_edges                     = header->num_edges;
+    m_num_faces                     = header->num_faces;
+    m_num_patches                   = header->num_patches;
+    m_max_num_patches               = header->max_num_patches;
+    m_num_patch_slots               = m_patch_slots_factor * m_max_num_patches;
+    m_patch_size                    = header->patch_size;
+    m_max_vertices_per_patch        = header->max_vertices_per_patch;
+    m_max_edges_per_patch           = header->max_edges_per_patch;
+    m_max_faces_per_patch           = header->max_faces_per_patch;
+    m_max_vertex_capacity           = header->max_vertex_capacity;
+    m_max_edge_capacity             = header->max_edge_capacity;
+    m_max_face_capacity             = header->max_face_capacity;
+    m_input_max_valence             = header->input_max_valence;
+    m_input_max_edge_incident_faces = header->input_max_edge_incident_faces;
+    m_input_max_face_adjacent_faces = header->input_max_face_adjacent_faces;
+    m_is_input_edge_manifold        = header->is_input_edge_manifold;
+    m_is_input_closed               = header->is_input_closed;
+
+    // a compact mesh is allocated exactly (see build_device) regardless of
+    // the allocation of the mesh that wrote the cache
+    if (m_compact) {
+        m_max_num_patches     = m_num_patches;
+        m_num_patch_slots     = m_max_num_patches;
+        m_max_vertex_capacity = m_max_vertices_per_patch;
+        m_max_edge_capacity   = m_max_edges_per_patch;
+        m_max_face_capacity   = m_max_faces_per_patch;
+    }
+
+    // patcher
+    const char* patcher_data = reader.read<char>(header->patcher_num_bytes);
+    if (patcher_data == nullptr) {
+        RXMESH_ERROR("RXMesh::init_from_cache {} is corrupted", cache_file);
+        return false;
+    }
+    {
+        detail::MemoryStreamBuf buf(patcher_data, header->patcher_num_bytes);
+        std::istream            is(&buf);
+        m_patcher = std::make_unique<patcher::Patcher>(is);
+    }
+
+    // edge map
+    const auto* edges =
+        reader.read<std::pair<uint32_t, uint32_t>>(m_num_edges);
+
+    const uint16_t* num_owned_v = reader.read<uint16_t>(m_num_patches);
+    const uint16_t* num_owned_e = reader.read<uint16_t>(m_num_patches);
+    const uint16_t* num_owned_f = reader.read<uint16_t>(m_num_patches);
+
+    const uint32_t  num_prefix    = header->max_num_patches + 1;
+    const uint32_t* vertex_prefix = reader.read<uint32_t>(num_prefix);
+    const uint32_t* edge_prefix   = reader.read<uint32_t>(num_prefix);
+    const uint32_t* face_prefix   = reader.read<uint32_t>(num_prefix);
+
+    const float* coords = nullptr;
+    if (header->has_vertex_coordinates) {
+        coords = reader.read<float>(3 * size_t(m_num_vertices));
+    }
+
+    const uint64_t* patch_offset = reader.read<uint64_t>(m_num_patches);
+
+    if (reader.failed()) {
+        RXMESH_ERROR("RXMesh::init_from_cache {} is corrupted", cache_file);
+        return false;
+    }
+
+    m_edges_map.clear();
+    m_edges_map.reserve(m_num_edges);
+    for (uint32_t e = 0; e < m_num_edges; ++e) {
+        m_edges_map.emplace(edges[e], e);
+    }
+
+    m_h_num_owned_v.assign(num_owned_v, num_owned_v + m_num_patches);
+    m_h_num_owned_e.assign(num_owned_e, num_owned_e + m_num_patches);
+    m_h_num_owned_f.assign(num_owned_f, num_owned_f + m_num_patches);
+    m_h_num_owned_v.resize(get_max_num_patches(), 0);
+    m_h_num_owned_e.resize(get_max_num_patches(), 0);
+    m_h_num_owned_f.resize(get_max_num_patches(), 0);
+
+    // the cache stores the prefix sum of the max number of patches while we
+    // allocate them for all patch slots
+    const uint32_t cached_1_bytes = num_prefix * sizeof(uint32_t);
+    const uint32_t patches_1_bytes =
+        (get_num_patch_slots() + 1) * sizeof(uint32_t);
+
+    m_h_vertex_prefix = (uint32_t*)calloc(1, patches_1_bytes);
+    m_h_edge_prefix   = (uint32_t*)calloc(1, patches_1_bytes);
+    m_h_face_prefix   = (uint32_t*)calloc(1, patches_1_bytes);
+
+    const uint32_t copy_1_bytes = std::min(cached_1_bytes, patches_1_bytes);
+    std::memcpy(m_h_vertex_prefix, vertex_prefix, copy_1_bytes);
+    std::memcpy(m_h_edge_prefix, edge_prefix, copy_1_bytes);
+    std::memcpy(m_h_face_prefix, face_prefix, copy_1_bytes);
+
+    CUDA_ERROR(cudaMalloc((void**)&m_d_vertex_prefix, patches_1_bytes));
+    CUDA_ERROR(cudaMalloc((void**)&m_d_edge_prefix, patches_1_bytes));
+    CUDA_ERROR(cudaMalloc((void**)&m_d_face_prefix, patches_1_bytes));
+
+    CUDA_ERROR(cudaMemcpyAsync(m_d_vertex_prefix,
+                               m_h_vertex_prefix,
+                               patches_1_bytes,
+                               cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpyAsync(m_d_edge_prefix,
+                               m_h_edge_prefix,
+                               patches_1_bytes,
+                               cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpyAsync(m_d_face_prefix,
+                               m_h_face_prefix,
+                               patches_1_bytes,
+                               cudaMemcpyHostToDevice));
+
+    vertices.clear();
+    if (coords != nullptr) {
+        vertices.assign(coords, coords + 3 * size_t(m_num_vertices));
+    }
+
+    // patches
+    m_h_patches_info =
+        (PatchInfo*)malloc(get_num_patch_slots() * sizeof(PatchInfo));
+    m_h_patches_ltog_f.resize(get_num_patches());
+    m_h_patches_ltog_e.resize(get_num_patches());
+    m_h_patches_ltog_v.resize(get_num_patches());
+
+    CUDA_ERROR(device_malloc((void**)&m_d_patches_info,
+                             get_num_patch_slots() * sizeof(PatchInfo),
+                             m_num_gpus > 1));
+    m_topo_memory_mega_bytes +=
+        BYTES_TO_MEGABYTES(get_num_patch_slots() * sizeof(PatchInfo));
+
+    bool ok = true;
+#pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
+    for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
+        const size_t begin = patch_offset[p];
+        const size_t end   = (p + 1 < static_cast<int>(get_num_patches())) ?
+                                 patch_offset[p + 1] :
+                                 file.size();
+        if (begin > end || end > file.size() ||
+            !load_single_patch_from_cache(
+                p, file.data() + begin, end - begin)) {
+#pragma omp atomic write
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        RXMESH_ERROR("RXMesh::init_from_cache {} has a corrupted patch",
+                     cache_file);
+        return false;
+    }
+
+    m_max_capacity_lp_v = 0;
+    m_max_capacity_lp_e = 0;
+    m_max_capacity_lp_f = 0;
+    for (uint32_t p = 0; p < get_num_patches(); ++p) {
+        m_max_capacity_lp_v = std::max(m_max_capacity_lp_v,
+                                       m_h_patches_info[p].lp_v.get_capacity());
+
+        m_max_capacity_lp_e = std::max(m_max_capacity_lp_e,
+                                       m_h_patches_info[p].lp_e.get_capacity());
+
+        m_max_capacity_lp_f = std::max(m_max_capacity_lp_f,
+                                       m_h_patches_info[p].lp_f.get_capacity());
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    init_context();
+
+    return true;
+}
+
+bool RXMesh::load_single_patch_from_cache(const uint32_t patch_id,
+                                          const char*    record,
+                                          const size_t   record_num_bytes)
+{
+    // the patch arrays are read directly from the mapped cache and copied to
+    // the host and device without re-constructing the topology, masks, and
+    // hash tables. Allocations are the same as in build_device_single_patch
+    // so that everything is freed the same way
+    double topo_mega_bytes = 0;
+
+    detail::MeshCacheReader reader(record, record_num_bytes);
+
+    const uint16_t* counts = reader.read<uint16_t>(6);
+    if (counts == nullptr) {
+        return false;
+    }
+
+    const uint16_t p_num_faces         = counts[0];
+    const uint16_t p_num_edges         = counts[1];
+    const uint16_t p_num_vertices      = counts[2];
+    // the capacities the cache is written with (which give the size of the
+    // masks in the record) and the ones the patch is allocated with
+    const uint16_t c_faces_capacity    = counts[3];
+    const uint16_t c_edges_capacity    = counts[4];
+    const uint16_t c_vertices_capacity = counts[5];
+    const uint16_t p_faces_capacity =
+        m_compact ? p_num_faces : c_faces_capacity;
+    const uint16_t p_edges_capacity =
+        m_compact ? p_num_edges : c_edges_capacity;
+    const uint16_t p_vertices_capacity =
+        m_compact ? p_num_vertices : c_vertices_capacity;
+
+    const uint32_t* ltog_v = reader.read<uint32_t>(p_num_vertices);
+    const uint32_t* ltog_e = reader.read<uint32_t>(p_num_edges);
+    const uint32_t* ltog_f = reader.read<uint32_t>(p_num_faces);
+
+    const LocalVertexT* ev = reader.read<LocalVertexT>(2 * size_t(p_num_edges));
+    const LocalEdgeT*   fe = reader.read<LocalEdgeT>(3 * size_t(p_num_faces));
+
+    const size_t c_v_mask = detail::mask_num_bytes(c_vertices_capacity);
+    const size_t c_e_mask = detail::mask_num_bytes(c_edges_capacity);
+    const size_t c_f_mask = detail::mask_num_bytes(c_faces_capacity);
+
+    const char* active_mask_v = reader.read<char>(c_v_mask);
+    const char* active_mask_e = reader.read<char>(c_e_mask);
+    const char* active_mask_f = reader.read<char>(c_f_mask);
+    const char* owned_mask_v  = reader.read<char>(c_v_mask);
+    const char* owned_mask_e  = reader.read<char>(c_e_mask);
+    const char* owned_mask_f  = reader.read<char>(c_f_mask);
+
+    // the allocated capacities are never larger than the cached ones and the
+    // bits past the number of elements are not set, so the masks are
+    // truncated
+    const size_t v_mask = detail::mask_num_bytes(p_vertices_capacity);
+    const size_t e_mask = detail::mask_num_bytes(p_edges_capacity);
+    const size_t f_mask = detail::mask_num_bytes(p_faces_capacity);
+
+    const uint32_t* stash = reader.read<uint32_t>(PatchStash::stash_size);
+
+    struct HTRecord
+    {
+        const LPHashTableRecord* rec;
+        const LPPair*            table;
+        const LPPair*            stash;
+    };
+    auto read_ht = [&]() {
+        HTRecord ht;
+        ht.rec   = reader.read<LPHashTableRecord>(1);
+        ht.table = (ht.rec == nullptr) ?
+                       nullptr :
+                       reader.read<LPPair>(ht.rec->capacity);
+        ht.stash = reader.read<LPPair>(LPHashTable::stash_size);
+        return ht;
+    };
+    const HTRecord ht_v = read_ht();
+    const HTRecord ht_e = read_ht();
+    const HTRecord ht_f = read_ht();
+
+    if (reader.failed()) {
+        return false;
+    }
+
+    m_h_patches_ltog_v[patch_id].assign(ltog_v, ltog_v + p_num_vertices);
+    m_h_patches_ltog_e[patch_id].assign(ltog_e, ltog_e + p_num_edges);
+    m_h_patches_ltog_f[patch_id].assign(ltog_f, ltog_f + p_num_faces);
+
+    PatchInfo& h_patch_info = m_h_patches_info[patch_id];
+
+    uint16_t* h_counts = (uint16_t*)malloc(6 * sizeof(uint16_t));
+    std::memcpy(h_counts, counts, 3 * sizeof(uint16_t));
+    h_counts[3] = p_faces_capacity;
+    h_counts[4] = p_edges_capacity;
+    h_counts[5] = p_vertices_capacity;
+
+    h_patch_info.num_faces         = h_counts;
+    h_patch_info.num_edges         = h_counts + 1;
+    h_patch_info.num_vertices      = h_counts + 2;
+    h_patch_info.faces_capacity    = h_counts + 3;
+    h_patch_info.edges_capacity    = h_counts + 4;
+    h_patch_info.vertices_capacity = h_counts + 5;
+    h_patch_info.patch_id          = patch_id;
+    h_patch_info.patch_stash       = PatchStash(false);
+    h_patch_info.dirty             = (int*)malloc(sizeof(int));
+    h_patch_info.dirty[0]          = 0;
+    h_patch_info.child_id          = INVALID32;
+    h_patch_info.should_slice      = false;
+
+    const bool managed = is_device_memory_managed();
+
+    uint16_t* d_counts;
+    CUDA_ERROR(
+        device_malloc((void**)&d_counts, 6 * sizeof(uint16_t), managed));
+    topo_mega_bytes += BYTES_TO_MEGABYTES(6 * sizeof(uint16_t));
+    CUDA_ERROR(cudaMemcpyAsync(
+        d_counts, h_counts, 6 * sizeof(uint16_t), cudaMemcpyHostToDevice));
+
+    PatchInfo d_patch;
+    d_patch.num_faces         = d_counts;
+    d_patch.num_edges         = d_counts + 1;
+    d_patch.num_vertices      = d_counts + 2;
+    d_patch.faces_capacity    = d_counts + 3;
+    d_patch.edges_capacity    = d_counts + 4;
+    d_patch.vertices_capacity = d_counts + 5;
+    d_patch.patch_id          = patch_id;
+    d_patch.patch_stash       = PatchStash(true, managed);
+    d_patch.lock.init();
+    d_patch.child_id     = INVALID32;
+    d_patch.should_slice = false;
+
+    topo_mega_bytes +=
+        BYTES_TO_MEGABYTES(PatchStash::stash_size * sizeof(uint32_t));
+
+    // patch stash
+    std::memcpy(h_patch_info.patch_stash.m_stash,
+                stash,
+                PatchStash::stash_size * sizeof(uint32_t));
+    CUDA_ERROR(cudaMemcpyAsync(d_patch.patch_stash.m_stash,
+                               stash,
+                               PatchStash::stash_size * sizeof(uint32_t),
+                               cudaMemcpyHostToDevice));
+
+    // topology
+    auto copy_array = [&](auto*& d_ptr,
+                          auto*& h_ptr,
+                          const void* src,
+                          size_t      num_bytes,
+                          size_t      capacity_num_bytes) {
+        using T = std::remove_reference_t<decltype(*h_ptr)>;
+        h_ptr   = (T*)malloc(capacity_num_bytes);
+        CUDA_ERROR(
+            device_malloc((void**)&d_ptr, capacity_num_bytes, managed));
+        topo_mega_bytes += BYTES_TO_MEGABYTES(capacity_num_bytes);
+        if (num_bytes > 0) {
+            std::memcpy(h_ptr, src, num_bytes);
+            CUDA_ERROR(cudaMemcpyAsync(
+                d_ptr, src, num_bytes, cudaMemcpyHostToDevice));
+        }
+    };
+
+    copy_array(d_patch.ev,
+               h_patch_info.ev,
+               ev,
+               p_num_edges * 2 * sizeof(LocalVertexT),
+               p_edges_capacity * 2 * sizeof(LocalVertexT));
+
+    copy_array(d_patch.fe,
+               h_patch_info.fe,
+               fe,
+               p_num_faces * 3 * sizeof(LocalEdgeT),
+               p_faces_capacity * 3 * sizeof(LocalEdgeT));
+
+    CUDA_ERROR(device_malloc((void**)&d_patch.dirty, sizeof(int), managed));
+    topo_mega_bytes += BYTES_TO_MEGABYTES(sizeof(int));
+    CUDA_ERROR(cudaMemsetAsync(d_patch.dirty, 0, sizeof(int)));
+
+    // bitmasks
+    copy_array(d_patch.active_mask_v,
+               h_patch_info.active_mask_v,
+               active_mask_v,
+               v_mask,
+               v_mask);
+    copy_array(d_patch.active_mask_e,
+               h_patch_info.active_mask_e,
+               active_mask_e,
+               e_mask,
+               e_mask);
+    copy_array(d_patch.active_mask_f,
+               h_patch_info.active_mask_f,
+               active_mask_f,
+               f_mask,
+               f_mask);
+    copy_array(d_patch.owned_mask_v,
+               h_patch_info.owned_mask_v,
+               owned_mask_v,
+               v_mask,
+               v_mask);
+    copy_array(d_patch.owned_mask_e,
+               h_patch_info.owned_mask_e,
+               owned_mask_e,
+               e_mask,
+               e_mask);
+    copy_array(d_patch.owned_mask_f,
+               h_patch_info.owned_mask_f,
+               owned_mask_f,
+               f_mask,
+               f_mask);
+
+    // hash tables
+    auto load_ht = [&](const HTRecord& ht,
+                       LPHashTable&    h_hashtable,
+                       LPHashTable&    d_hashtable) {
+        const size_t table_num_bytes = ht.rec->capacity * sizeof(LPPair);
+        const size_t stash_num_bytes = LPHashTable::stash_size * sizeof(LPPair);
+
+        for (LPHashTable* t : {&h_hashtable, &d_hashtable}) {
+            *t                     = LPHashTable();
+            t->m_capacity          = ht.rec->capacity;
+            t->m_max_cuckoo_chains = ht.rec->max_cuckoo_chains;
+            t->m_hasher0           = ht.rec->hashers[0];
+            t->m_hasher1           = ht.rec->hashers[1];
+            t->m_hasher2           = ht.rec->hashers[2];
+            t->m_hasher3           = ht.rec->hashers[3];
+        }
+
+        h_hashtable.m_is_on_device = false;
+        h_hashtable.m_table        = (LPPair*)malloc(table_num_bytes);
+        h_hashtable.m_stash        = (LPPair*)malloc(stash_num_bytes);
+        std::memcpy(h_hashtable.m_table, ht.table, table_num_bytes);
+        std::memcpy(h_hashtable.m_stash, ht.stash, stash_num_bytes);
+
+        d_hashtable.m_is_on_device = true;
+        CUDA_ERROR(device_malloc(
+            (void**)&d_hashtable.m_table, table_num_bytes, managed));
+        CUDA_ERROR(device_malloc(
+            (void**)&d_hashtable.m_stash, stash_num_bytes, managed));
+        CUDA_ERROR(cudaMemcpyAsync(d_hashtable.m_table,
+                                   ht.table,
+                                   table_num_bytes,
+                                   cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpyAsync(d_hashtable.m_stash,
+                                   ht.stash,
+                                   stash_num_bytes,
+                                   cudaMemcpyHostToDevice));
+
+        topo_mega_bytes += BYTES_TO_MEGABYTES(table_num_bytes);
+        topo_mega_bytes += BYTES_TO_MEGABYTES(stash_num_bytes);
+    };
+
+    load_ht(ht_v, h_patch_info.lp_v, d_patch.lp_v);
+    load_ht(ht_e, h_patch_info.lp_e, d_patch.lp_e);
+    load_ht(ht_f, h_patch_info.lp_f, d_patch.lp_f);
+
+    CUDA_ERROR(cudaMemcpy(m_d_patches_info + patch_id,
+                          &d_patch,
+                          sizeof(PatchInfo),
+                          cudaMemcpyHostToDevice));
+
+#pragma omp atomic
+    m_topo_memory_mega_bytes += topo_mega_bytes;
+
+    return true;
+}
+}  // namespace rxmesh
@@ -0,0 +1,246 @@
+#include <vector>
+
+#include "cub/device/device_radix_sort.cuh"
+#include "cub/device/device_reduce.cuh"
+#include "cub/device/device_scan.cuh"
+
+#include "rxmesh/kernels/supporting_structures.cuh"
+#include "rxmesh/rxmesh.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+#include "rxmesh/util/util.h"
+
+namespace rxmesh {
+
+void RXMesh::build_supporting_structures_on_device(
+    const uint32_t*                             d_fv,
+    const uint32_t                              num_faces,
+    std::vector<uint32_t>&                      fv,
+    std::vector<std::pair<uint32_t, uint32_t>>& edges,
+    std::vector<uint32_t>&                      ef_offset,
+    std::vector<uint32_t>&                      ff_offset,
+    std::vector<uint32_t>&                      ff_values,
+    uint32_t*&                                  d_ff_offset,
+    uint32_t*&                                  d_ff_values)
+{
+    // This is the device version of build_supporting_structures. Edges are
+    // found by (stable) radix sorting the half-edges by their edge key. Edge
+    // ids are assigned in the order an edge is first seen in fv which gives
+    // the same ids as the host version
+
+    m_num_faces    = num_faces;
+    m_num_vertices = 0;
+    m_num_edges    = 0;
+    m_edges_map.clear();
+
+    const uint32_t num_he    = 3 * m_num_faces;
+    const uint32_t threads   = 256;
+    const uint32_t he_blocks = DIVIDE_UP(num_he, threads);
+    const uint32_t f_blocks  = DIVIDE_UP(m_num_faces, threads);
+
+    // cub temp storage that we grow as needed
+    void*  d_cub_temp     = nullptr;
+    size_t cub_temp_bytes = 0;
+
+    auto ensure_cub_bytes = [&](size_t bytes) {
+        if (bytes > cub_temp_bytes) {
+            GPU_FREE(d_cub_temp);
+            CUDA_ERROR(cudaMalloc((void**)&d_cub_temp, bytes));
+            cub_temp_bytes = bytes;
+        }
+    };
+    size_t bytes = 0;
+
+    uint64_t *d_key_in(nullptr), *d_key_out(nullptr);
+    uint32_t *d_id_in(nullptr), *d_id_out(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_key_in, num_he * sizeof(uint64_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_key_out, num_he * sizeof(uint64_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_id_in, num_he * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_id_out, num_he * sizeof(uint32_t)));
+
+    detail::init_half_edges<<<he_blocks, threads>>>(
+        m_num_faces, d_fv, d_key_in, d_id_in);
+
+    // number of vertices
+    uint32_t* d_max_vertex = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_max_vertex, sizeof(uint32_t)));
+    cub::DeviceReduce::Max(nullptr, bytes, d_fv, d_max_vertex, num_he);
+    ensure_cub_bytes(bytes);
+    cub::DeviceReduce::Max(
+        d_cub_temp, cub_temp_bytes, d_fv, d_max_vertex, num_he);
+    CUDA_ERROR(cudaMemcpy(&m_num_vertices,
+                          d_max_vertex,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    ++m_num_vertices;
+    GPU_FREE(d_max_vertex);
+
+    // sort half-edges by their key. Radix sort is stable so half-edges with
+    // the same key remain sorted by their id
+    cub::DeviceRadixSort::SortPairs(
+        nullptr, bytes, d_key_in, d_key_out, d_id_in, d_id_out, num_he);
+    ensure_cub_bytes(bytes);
+    cub::DeviceRadixSort::SortPairs(d_cub_temp,
+                                    cub_temp_bytes,
+                                    d_key_in,
+                                    d_key_out,
+                                    d_id_in,
+                                    d_id_out,
+                                    num_he);
+    GPU_FREE(d_key_in);
+
+    // mark the first half-edge of every edge and the head of every run. We
+    // re-use d_id_in to store the run heads
+    uint32_t* d_run_head = d_id_in;
+    uint32_t *d_is_first(nullptr), *d_first_id(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_is_first, num_he * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_first_id, num_he * sizeof(uint32_t)));
+
+    detail::mark_edge_heads<<<he_blocks, threads>>>(
+        num_he, d_key_out, d_id_out, d_is_first, d_run_head);
+
+    cub::DeviceScan::ExclusiveSum(
+        nullptr, bytes, d_is_first, d_first_id, num_he);
+    ensure_cub_bytes(bytes);
+    cub::DeviceScan::ExclusiveSum(
+        d_cub_temp, cub_temp_bytes, d_is_first, d_first_id, num_he);
+
+    // every sorted position gets the position of its run head
+    cub::DeviceScan::InclusiveScan(
+        nullptr, bytes, d_run_head, d_run_head, cub::Max(), num_he);
+    ensure_cub_bytes(bytes);
+    cub::DeviceScan::InclusiveScan(
+        d_cub_temp, cub_temp_bytes, d_run_head, d_run_head, cub::Max(), num_he);
+
+    {
+        uint32_t last_first_id(0), last_is_first(0);
+        CUDA_ERROR(cudaMemcpy(&last_first_id,
+                              d_first_id + num_he - 1,
+                              sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(&last_is_first,
+                              d_is_first + num_he - 1,
+                              sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        m_num_edges = last_first_id + last_is_first;
+    }
+
+    // edge id of every half-edge. We re-use d_is_first to store it
+    uint32_t* d_he_edge = d_is_first;
+    uint32_t *d_ef_size(nullptr), *d_edges(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_ef_size, m_num_edges * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_edges, 2 * m_num_edges * sizeof(uint32_t)));
+
+    detail::assign_edge_ids<<<he_blocks, threads>>>(num_he,
+                                                    d_key_out,
+                                                    d_id_out,
+                                                    d_run_head,
+                                                    d_first_id,
+                                                    d_he_edge,
+                                                    d_ef_size,
+                                                    d_edges);
+    GPU_FREE(d_key_out);
+    GPU_FREE(d_first_id);
+
+    // edge incident faces
+    uint32_t *d_ef_offset(nullptr), *d_ef_values(nullptr);
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_ef_offset, m_num_edges * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_ef_values, num_he * sizeof(uint32_t)));
+
+    cub::DeviceScan::InclusiveSum(
+        nullptr, bytes, d_ef_size, d_ef_offset, m_num_edges);
+    ensure_cub_bytes(bytes);
+    cub::DeviceScan::InclusiveSum(
+        d_cub_temp, cub_temp_bytes, d_ef_size, d_ef_offset, m_num_edges);
+
+    detail::populate_ef<<<he_blocks, threads>>>(
+        num_he, d_id_out, d_run_head, d_he_edge, d_ef_offset, d_ef_values);
+    GPU_FREE(d_id_out);
+    GPU_FREE(d_id_in);
+
+    // face adjacent faces
+    uint32_t* d_ff_size = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_ff_size, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_ff_offset, m_num_faces * sizeof(uint32_t)));
+
+    detail::count_ff<<<f_blocks, threads>>>(
+        m_num_faces, d_he_edge, d_ef_size, d_ff_size);
+
+    cub::DeviceScan::InclusiveSum(
+        nullptr, bytes, d_ff_size, d_ff_offset, m_num_faces);
+    ensure_cub_bytes(bytes);
+    cub::DeviceScan::InclusiveSum(
+        d_cub_temp, cub_temp_bytes, d_ff_size, d_ff_offset, m_num_faces);
+    GPU_FREE(d_ff_size);
+
+    uint32_t num_ff = 0;
+    CUDA_ERROR(cudaMemcpy(&num_ff,
+                          d_ff_offset + m_num_faces - 1,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    CUDA_ERROR(cudaMalloc((void**)&d_ff_values,
+                          std::max(num_ff, 1u) * sizeof(uint32_t)));
+
+    detail::populate_ff<<<f_blocks, threads>>>(m_num_faces,
+                                               d_he_edge,
+                                               d_ef_offset,
+                                               d_ef_values,
+                                               d_ff_offset,
+                                               d_ff_values);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    // the rest of the construction (patcher post-processing, ltog, ribbons,
+    // LP hashtables, and topology) is done on the host and so we move the
+    // results it needs there. ff remains on the device for the patcher and
+    // the edge incident faces values are only used by populate_ff
+    fv.resize(num_he);
+    CUDA_ERROR(cudaMemcpy(fv.data(),
+                          d_fv,
+                          num_he * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    edges.resize(m_num_edges);
+    static_assert(sizeof(std::pair<uint32_t, uint32_t>) ==
+                  2 * sizeof(uint32_t));
+    CUDA_ERROR(cudaMemcpy(edges.data(),
+                          d_edges,
+                          2 * m_num_edges * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    ef_offset.resize(m_num_edges);
+    CUDA_ERROR(cudaMemcpy(ef_offset.data(),
+                          d_ef_offset,
+                          m_num_edges * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    ff_offset.resize(m_num_faces);
+    CUDA_ERROR(cudaMemcpy(ff_offset.data(),
+                          d_ff_offset,
+                          m_num_faces * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    ff_values.resize(num_ff);
+    CUDA_ERROR(cudaMemcpy(ff_values.data(),
+                          d_ff_values,
+                          num_ff * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    GPU_FREE(d_he_edge);
+    GPU_FREE(d_ef_size);
+    GPU_FREE(d_edges);
+    GPU_FREE(d_ef_offset);
+    GPU_FREE(d_ef_values);
+    GPU_FREE(d_cub_temp);
+
+    m_edges_map.reserve(m_num_edges);
+    for (uint32_t e = 0; e < m_num_edges; ++e) {
+        m_edges_map.emplace(edges[e], e);
+    }
+}
+}  // namespace rxmesh
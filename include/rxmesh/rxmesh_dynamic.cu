@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iterator>
 #include <numeric>
 
 #include <cooperative_groups.h>
@@ -139,9 +141,168 @@ __device__ __inline__ void hashtable_calibration(const Context context,
 }
 
 template <uint32_t blockThreads>
-__global__ static void hashtable_calibration(const Context context)
+__global__ static void gather_cleanup_patches(const Context  context,
+                                              const uint32_t first_new_patch,
+                                              uint32_t*      d_list,
+                                              uint32_t*      d_count,
+                                              uint32_t*      d_host_stale)
 {
-    const uint32_t pid = blockIdx.x;
+    // a patch needs cleanup if it is new, dirty, sliced, or one of its
+    // neighbors is dirty or sliced since the neighbor may now own (or have
+    // given away) elements that this patch's hashtable points to
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo pi = context.m_patches_info[p];
+
+    bool touched =
+        p >= first_new_patch || pi.is_dirty() || pi.child_id != INVALID32;
+
+    for (uint8_t i = 0; i < PatchStash::stash_size && !touched; ++i) {
+        const uint32_t q = pi.patch_stash.get_patch(i);
+        if (q != INVALID32) {
+            touched = context.m_patches_info[q].is_dirty() ||
+                      context.m_patches_info[q].child_id != INVALID32;
+        }
+    }
+
+    if (touched) {
+        d_list[::atomicAdd(d_count, uint32_t(1))] = p;
+        d_host_stale[p]                            = 1;
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void reduce_patch_counts(const Context   context,
+                                           const uint32_t* d_num_owned_v,
+                                           const uint32_t* d_num_owned_e,
+                                           const uint32_t* d_num_owned_f)
+{
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo pi = context.m_patches_info[p];
+
+    ::atomicAdd(context.m_num_vertices, d_num_owned_v[p]);
+    ::atomicAdd(context.m_num_edges, d_num_owned_e[p]);
+    ::atomicAdd(context.m_num_faces, d_num_owned_f[p]);
+
+    ::atomicMax(context.m_max_num_vertices, uint32_t(pi.num_vertices[0]));
+    ::atomicMax(context.m_max_num_edges, uint32_t(pi.num_edges[0]));
+    ::atomicMax(context.m_max_num_faces, uint32_t(pi.num_faces[0]));
+}
+
+/**
+ * @brief what to grow in a patch (see RXMeshDynamic::grow_patches)
+ */
+enum GrowFlag : uint32_t
+{
+    GrowVertices   = 0x01,
+    GrowEdges      = 0x02,
+    GrowFaces      = 0x04,
+    GrowLPVertices = 0x08,
+    GrowLPEdges    = 0x10,
+    GrowLPFaces    = 0x20,
+};
+
+template <uint32_t blockThreads>
+__global__ static void find_full_patches(const Context context,
+                                         const float   threshold,
+                                         uint32_t*     d_list,
+                                         uint32_t*     d_count)
+{
+    // d_list stores a pair (patch id, GrowFlag) for every full patch
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo pi = context.m_patches_info[p];
+    if (pi.patch_id == INVALID32) {
+        return;
+    }
+
+    auto is_full = [&](const uint32_t* mask, const uint16_t capacity) {
+        const uint32_t num_words  = DIVIDE_UP(capacity, 32);
+        uint32_t       num_active = 0;
+        for (uint32_t i = 0; i < num_words; ++i) {
+            uint32_t word = mask[i];
+            // ignore the bits past the capacity
+            if (i == num_words - 1 && capacity % 32 != 0) {
+                word &= (1u << (capacity % 32)) - 1;
+            }
+            num_active += __popc(word);
+        }
+        return num_active > threshold * capacity;
+    };
+
+    auto is_lp_full = [&](const LPHashTable& lp) {
+        return lp.compute_load_factor() > threshold ||
+               lp.compute_stash_load_factor() > 0.5f;
+    };
+
+    uint32_t grow = 0;
+    if (is_full(pi.active_mask_v, pi.vertices_capacity[0])) {
+        grow |= GrowVertices;
+    }
+    if (is_full(pi.active_mask_e, pi.edges_capacity[0])) {
+        grow |= GrowEdges;
+    }
+    if (is_full(pi.active_mask_f, pi.faces_capacity[0])) {
+        grow |= GrowFaces;
+    }
+    if (is_lp_full(pi.lp_v)) {
+        grow |= GrowLPVertices;
+    }
+    if (is_lp_full(pi.lp_e)) {
+        grow |= GrowLPEdges;
+    }
+    if (is_lp_full(pi.lp_f)) {
+        grow |= GrowLPFaces;
+    }
+
+    if (grow != 0) {
+        const uint32_t id  = ::atomicAdd(d_count, uint32_t(1));
+        d_list[2 * id]     = p;
+        d_list[2 * id + 1] = grow;
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void count_patches_to_slice(const Context context,
+                                              uint32_t*     d_count)
+{
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p >= context.m_num_patches[0]) {
+        return;
+    }
+    if (context.m_patches_info[p].should_slice) {
+        ::atomicAdd(d_count, uint32_t(1));
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void flag_patches_to_slice(const Context  context,
+                                             const uint32_t num_patches,
+                                             uint32_t*      d_flag)
+{
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+    const PatchInfo& pi = context.m_patches_info[p];
+    d_flag[p]           = (pi.should_slice && can_slice(context, pi));
+}
+
+template <uint32_t blockThreads>
+__global__ static void hashtable_calibration(const Context   context,
+                                             const uint32_t* d_list)
+{
+    const uint32_t pid = d_list[blockIdx.x];
     if (pid >= context.m_num_patches[0]) {
         return;
     }
@@ -418,11 +579,15 @@ __inline__ __device__ void remove_idle_elements(
 #endif
 }
 template <uint32_t blockThreads>
-__global__ static void remove_surplus_elements(Context context)
+__global__ static void remove_surplus_elements(Context         context,
+                                               const uint32_t* d_list,
+                                               uint32_t*       d_num_owned_v,
+                                               uint32_t*       d_num_owned_e,
+                                               uint32_t*       d_num_owned_f)
 {
     auto block = cooperative_groups::this_thread_block();
 
-    const uint32_t pid = blockIdx.x;
+    const uint32_t pid = d_list[blockIdx.x];
     if (pid >= context.m_num_patches[0]) {
         return;
     }
@@ -593,17 +758,15 @@ __global__ static void remove_surplus_elements(Context context)
     block.sync();
 
     if (threadIdx.x == 0) {
-        ::atomicAdd(context.m_num_vertices, s_num_owned_vertices);
-        ::atomicAdd(context.m_num_edges, s_num_owned_edges);
-        ::atomicAdd(context.m_num_faces, s_num_owned_faces);
+        // the mesh totals and max patch sizes are reduced over all patches
+        // (cleaned or not) by reduce_patch_counts
+        d_num_owned_v[pid] = s_num_owned_vertices;
+        d_num_owned_e[pid] = s_num_owned_edges;
+        d_num_owned_f[pid] = s_num_owned_faces;
 
         pi.num_vertices[0] = s_num_vertices;
         pi.num_edges[0]    = s_num_edges;
         pi.num_faces[0]    = s_num_faces;
-
-        ::atomicMax(context.m_max_num_vertices, s_num_vertices);
-        ::atomicMax(context.m_max_num_edges, s_num_edges);
-        ::atomicMax(context.m_max_num_faces, s_num_faces);
     }
 
     pi.clear_dirty();
@@ -2542,42 +2705,90 @@ bool RXMeshDynamic::validate()
     return success;
 }
 
-void RXMeshDynamic::cleanup()
+uint32_t RXMeshDynamic::gather_cleanup_patches(const uint32_t first_new_patch,
+                                               cudaStream_t   stream)
 {
-    CUDA_ERROR(cudaMemcpy(&m_num_patches,
-                          m_rxmesh_context.m_num_patches,
-                          sizeof(uint32_t),
-                          cudaMemcpyDeviceToHost));
+    constexpr uint32_t block_size = 256;
+
+    CUDA_ERROR(cudaMemsetAsync(m_d_cleanup_count, 0, sizeof(uint32_t), stream));
+
+    detail::gather_cleanup_patches<block_size>
+        <<<DIVIDE_UP(get_num_patches(), block_size), block_size, 0, stream>>>(
+            this->m_rxmesh_context,
+            first_new_patch,
+            m_d_cleanup_list,
+            m_d_cleanup_count,
+            m_d_host_stale);
+
+    uint32_t num_touched = 0;
+    CUDA_ERROR(cudaMemcpyAsync(&num_touched,
+                               m_d_cleanup_count,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+    return num_touched;
+}
+
+void RXMeshDynamic::read_max_elements_per_patch(cudaStream_t stream)
+{
+    CUDA_ERROR(cudaMemcpyAsync(&this->m_max_vertices_per_patch,
+                               this->m_rxmesh_context.m_max_num_vertices,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+
+    CUDA_ERROR(cudaMemcpyAsync(&this->m_max_edges_per_patch,
+                               this->m_rxmesh_context.m_max_num_edges,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+
+    CUDA_ERROR(cudaMemcpyAsync(&this->m_max_faces_per_patch,
+                               this->m_rxmesh_context.m_max_num_faces,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+}
+
+uint32_t RXMeshDynamic::cleanup(cudaStream_t stream)
+{
+    CUDA_ERROR(cudaMemcpyAsync(&m_num_patches,
+                               m_rxmesh_context.m_num_patches,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+    CUDA_ERROR(cudaStreamSynchronize(stream));
 
     constexpr uint32_t block_size = 256;
-    const uint32_t     grid_size  = get_num_patches();
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_vertices_per_patch,
-                          this->m_rxmesh_context.m_max_num_vertices,
-                          sizeof(uint32_t),
-                          cudaMemcpyDeviceToHost));
+    // only patches touched since the last cleanup are cleaned
+    const uint32_t grid_size =
+        gather_cleanup_patches(m_num_cleaned_patches, stream);
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_edges_per_patch,
-                          this->m_rxmesh_context.m_max_num_edges,
-                          sizeof(uint32_t),
-                          cudaMemcpyDeviceToHost));
+    // the topology of the touched patches has changed and so the cached
+    // queries (see cache_query) are stale
+    if (grid_size > 0) {
+        release_query_cache();
+    }
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_faces_per_patch,
-                          this->m_rxmesh_context.m_max_num_faces,
-                          sizeof(uint32_t),
-                          cudaMemcpyDeviceToHost));
+    read_max_elements_per_patch(stream);
 
-    CUDA_ERROR(
-        cudaMemset(m_rxmesh_context.m_num_vertices, 0, sizeof(uint32_t)));
-    CUDA_ERROR(cudaMemset(m_rxmesh_context.m_num_edges, 0, sizeof(uint32_t)));
-    CUDA_ERROR(cudaMemset(m_rxmesh_context.m_num_faces, 0, sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_num_vertices, 0, sizeof(uint32_t), stream));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_num_edges, 0, sizeof(uint32_t), stream));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_num_faces, 0, sizeof(uint32_t), stream));
 
-    CUDA_ERROR(
-        cudaMemset(m_rxmesh_context.m_max_num_vertices, 0, sizeof(uint32_t)));
-    CUDA_ERROR(
-        cudaMemset(m_rxmesh_context.m_max_num_edges, 0, sizeof(uint32_t)));
-    CUDA_ERROR(
-        cudaMemset(m_rxmesh_context.m_max_num_faces, 0, sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_max_num_vertices, 0, sizeof(uint32_t), stream));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_max_num_edges, 0, sizeof(uint32_t), stream));
+    CUDA_ERROR(cudaMemsetAsync(
+        m_rxmesh_context.m_max_num_faces, 0, sizeof(uint32_t), stream));
 
 
     uint32_t dyn_shmem = 0;
@@ -2606,26 +2817,504 @@ void RXMeshDynamic::cleanup()
 
     dyn_shmem += std::max(hash_table_shmem, connect_shmem);
 
-    detail::hashtable_calibration<block_size>
-        <<<grid_size, block_size>>>(this->m_rxmesh_context);
+    if (grid_size > 0) {
+        detail::hashtable_calibration<block_size>
+            <<<grid_size, block_size, 0, stream>>>(this->m_rxmesh_context,
+                                                   m_d_cleanup_list);
+
+        detail::remove_surplus_elements<block_size>
+            <<<grid_size, block_size, dyn_shmem, stream>>>(
+                this->m_rxmesh_context,
+                m_d_cleanup_list,
+                m_d_num_owned_v,
+                m_d_num_owned_e,
+                m_d_num_owned_f);
+    }
+
+    detail::reduce_patch_counts<block_size>
+        <<<DIVIDE_UP(get_num_patches(), block_size), block_size, 0, stream>>>(
+            this->m_rxmesh_context,
+            m_d_num_owned_v,
+            m_d_num_owned_e,
+            m_d_num_owned_f);
 
-    detail::remove_surplus_elements<block_size>
-        <<<grid_size, block_size, dyn_shmem>>>(this->m_rxmesh_context);
+    m_num_cleaned_patches = get_num_patches();
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_vertices_per_patch,
-                          this->m_rxmesh_context.m_max_num_vertices,
+    read_max_elements_per_patch(stream);
+
+    RXMESH_TRACE("RXMeshDynamic::cleanup() cleaned {} out of {} patches",
+                 grid_size,
+                 get_num_patches());
+
+    if (m_growth_threshold > 0) {
+        // grow_patches() reallocates patches and so it synchronizes the
+        // device on its own
+        grow_patches(m_growth_threshold, m_growth_factor);
+    }
+
+    return grid_size;
+}
+
+uint32_t RXMeshDynamic::grow_patches(const float threshold,
+                                     const float growth_factor)
+{
+    if (is_device_memory_managed()) {
+        RXMESH_WARN(
+            "RXMeshDynamic::grow_patches() growing patches is not supported "
+            "with streaming or multi-GPU");
+        return 0;
+    }
+
+    constexpr uint32_t block_size = 256;
+
+    CUDA_ERROR(cudaMemset(m_d_cleanup_count, 0, sizeof(uint32_t)));
+
+    detail::find_full_patches<block_size>
+        <<<DIVIDE_UP(get_num_patches(), block_size), block_size>>>(
+            this->m_rxmesh_context,
+            threshold,
+            m_d_cleanup_list,
+            m_d_cleanup_count);
+
+    uint32_t num_full = 0;
+    CUDA_ERROR(cudaMemcpy(&num_full,
+                          m_d_cleanup_count,
                           sizeof(uint32_t),
                           cudaMemcpyDeviceToHost));
+    if (num_full == 0) {
+        return 0;
+    }
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_edges_per_patch,
-                          this->m_rxmesh_context.m_max_num_edges,
-                          sizeof(uint32_t),
+    std::vector<uint32_t> h_list(2 * num_full);
+    CUDA_ERROR(cudaMemcpy(h_list.data(),
+                          m_d_cleanup_list,
+                          h_list.size() * sizeof(uint32_t),
                           cudaMemcpyDeviceToHost));
 
-    CUDA_ERROR(cudaMemcpy(&this->m_max_faces_per_patch,
-                          this->m_rxmesh_context.m_max_num_faces,
-                          sizeof(uint32_t),
+    for (uint32_t i = 0; i < num_full; ++i) {
+        grow_patch(h_list[2 * i], h_list[2 * i + 1], growth_factor);
+    }
+
+    this->m_rxmesh_context.m_max_lp_capacity_v =
+        max_lp_hashtable_capacity<LocalVertexT>();
+    this->m_rxmesh_context.m_max_lp_capacity_e =
+        max_lp_hashtable_capacity<LocalEdgeT>();
+    this->m_rxmesh_context.m_max_lp_capacity_f =
+        max_lp_hashtable_capacity<LocalFaceT>();
+
+    RXMESH_TRACE(
+        "RXMeshDynamic::grow_patches() grew {} patches. Max capacity "
+        "(V, E, F) = ({}, {}, {})",
+        num_full,
+        get_per_patch_max_vertex_capacity(),
+        get_per_patch_max_edge_capacity(),
+        get_per_patch_max_face_capacity());
+
+    return num_full;
+}
+
+void RXMeshDynamic::grow_patch(const uint32_t p,
+                               const uint32_t grow,
+                               const float    growth_factor)
+{
+    PatchInfo d_patch;
+    CUDA_ERROR(cudaMemcpy(&d_patch,
+                          m_d_patches_info + p,
+                          sizeof(PatchInfo),
                           cudaMemcpyDeviceToHost));
+    PatchInfo& h_patch = m_h_patches_info[p];
+
+    uint16_t old_v_cap, old_e_cap, old_f_cap;
+    CUDA_ERROR(cudaMemcpy(&old_v_cap,
+                          d_patch.vertices_capacity,
+                          sizeof(uint16_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(&old_e_cap,
+                          d_patch.edges_capacity,
+                          sizeof(uint16_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(&old_f_cap,
+                          d_patch.faces_capacity,
+                          sizeof(uint16_t),
+                          cudaMemcpyDeviceToHost));
+
+    // local indices are 16-bit (with INVALID16 reserved) and edges use one
+    // bit for the direction in FE. Hashtables are limited by the largest
+    // prime number we have
+    auto grown = [&](const uint16_t cap, const uint32_t limit) {
+        const uint32_t c = static_cast<uint32_t>(
+            std::ceil(growth_factor * static_cast<float>(cap)));
+        return static_cast<uint16_t>(
+            std::max(static_cast<uint32_t>(cap), std::min(c, limit)));
+    };
+
+    const uint16_t v_cap =
+        (grow & detail::GrowVertices) ? grown(old_v_cap, INVALID16 - 1) :
+                                        old_v_cap;
+    const uint16_t e_cap =
+        (grow & detail::GrowEdges) ? grown(old_e_cap, (INVALID16 >> 1) - 1) :
+                                     old_e_cap;
+    const uint16_t f_cap =
+        (grow & detail::GrowFaces) ? grown(old_f_cap, INVALID16 - 1) :
+                                     old_f_cap;
+
+    // reallocate a device buffer and keep its content. The new part is
+    // zero i.e., inactive/not-owned for masks
+    auto grow_device = [&](auto*& d_ptr, size_t old_bytes, size_t new_bytes) {
+        using PtrT = std::remove_reference_t<decltype(d_ptr)>;
+        void* ptr  = nullptr;
+        CUDA_ERROR(cudaMalloc(&ptr, new_bytes));
+        CUDA_ERROR(cudaMemset(ptr, 0, new_bytes));
+        CUDA_ERROR(
+            cudaMemcpy(ptr, d_ptr, old_bytes, cudaMemcpyDeviceToDevice));
+        GPU_FREE(d_ptr);
+        d_ptr = static_cast<PtrT>(ptr);
+        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(new_bytes - old_bytes);
+    };
+
+    // the host content is updated by update_host() since the patch is
+    // marked stale
+    auto grow_host = [&](auto*& h_ptr, size_t new_bytes) {
+        using PtrT = std::remove_reference_t<decltype(h_ptr)>;
+        h_ptr      = static_cast<PtrT>(realloc(h_ptr, new_bytes));
+    };
+
+    auto grow_masks = [&](uint32_t*&     d_active,
+                          uint32_t*&     d_owned,
+                          uint32_t*&     h_active,
+                          uint32_t*&     h_owned,
+                          const uint16_t old_cap,
+                          const uint16_t new_cap) {
+        const size_t old_bytes = detail::mask_num_bytes(old_cap);
+        const size_t new_bytes = detail::mask_num_bytes(new_cap);
+        grow_device(d_active, old_bytes, new_bytes);
+        grow_device(d_owned, old_bytes, new_bytes);
+        grow_host(h_active, new_bytes);
+        grow_host(h_owned, new_bytes);
+    };
+
+    if (v_cap > old_v_cap) {
+        grow_masks(d_patch.active_mask_v,
+                   d_patch.owned_mask_v,
+                   h_patch.active_mask_v,
+                   h_patch.owned_mask_v,
+                   old_v_cap,
+                   v_cap);
+    }
+
+    if (e_cap > old_e_cap) {
+        grow_device(d_patch.ev,
+                    2 * old_e_cap * sizeof(LocalVertexT),
+                    2 * e_cap * sizeof(LocalVertexT));
+        grow_host(h_patch.ev, 2 * e_cap * sizeof(LocalVertexT));
+        grow_masks(d_patch.active_mask_e,
+                   d_patch.owned_mask_e,
+                   h_patch.active_mask_e,
+                   h_patch.owned_mask_e,
+                   old_e_cap,
+                   e_cap);
+    }
+
+    if (f_cap > old_f_cap) {
+        grow_device(d_patch.fe,
+                    3 * old_f_cap * sizeof(LocalEdgeT),
+                    3 * f_cap * sizeof(LocalEdgeT));
+        grow_host(h_patch.fe, 3 * f_cap * sizeof(LocalEdgeT));
+        grow_masks(d_patch.active_mask_f,
+                   d_patch.owned_mask_f,
+                   h_patch.active_mask_f,
+                   h_patch.owned_mask_f,
+                   old_f_cap,
+                   f_cap);
+    }
+
+    // rehash into a larger hashtable. The host and device tables are created
+    // with the same requested capacity so they end up with the same (prime)
+    // capacity and hash functions
+    auto grow_lp = [&](LPHashTable& d_lp, LPHashTable& h_lp) {
+        constexpr uint32_t num_primes =
+            sizeof(prime_numbers) / sizeof(prime_numbers[0]);
+        const uint16_t lp_limit = prime_numbers[num_primes - 1] - 1;
+        const uint16_t old_cap  = d_lp.get_capacity();
+        const uint16_t cap      = grown(old_cap, lp_limit);
+        if (cap <= old_cap) {
+            return;
+        }
+
+        std::vector<LPPair> pairs(old_cap + LPHashTable::stash_size);
+        CUDA_ERROR(cudaMemcpy(pairs.data(),
+                              d_lp.m_table,
+                              old_cap * sizeof(LPPair),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(pairs.data() + old_cap,
+                              d_lp.m_stash,
+                              LPHashTable::stash_size * sizeof(LPPair),
+                              cudaMemcpyDeviceToHost));
+
+        LPHashTable h_new(cap, false);
+        for (const LPPair& pair : pairs) {
+            if (!pair.is_sentinel() && !h_new.insert(pair, nullptr, nullptr)) {
+                RXMESH_ERROR(
+                    "RXMeshDynamic::grow_patch() failed to insert in the "
+                    "hashtable of patch {} while growing it",
+                    p);
+            }
+        }
+
+        LPHashTable d_new(cap, true);
+        d_new.move(h_new);
+        m_topo_memory_mega_bytes +=
+            BYTES_TO_MEGABYTES(d_new.num_bytes() - d_lp.num_bytes());
+
+        d_lp.free();
+        h_lp.free();
+        d_lp = d_new;
+        h_lp = h_new;
+    };
+
+    if (grow & detail::GrowLPVertices) {
+        grow_lp(d_patch.lp_v, h_patch.lp_v);
+    }
+    if (grow & detail::GrowLPEdges) {
+        grow_lp(d_patch.lp_e, h_patch.lp_e);
+    }
+    if (grow & detail::GrowLPFaces) {
+        grow_lp(d_patch.lp_f, h_patch.lp_f);
+    }
+
+    // capacities
+    CUDA_ERROR(cudaMemcpy(d_patch.vertices_capacity,
+                          &v_cap,
+                          sizeof(uint16_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_patch.edges_capacity,
+                          &e_cap,
+                          sizeof(uint16_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_patch.faces_capacity,
+                          &f_cap,
+                          sizeof(uint16_t),
+                          cudaMemcpyHostToDevice));
+    h_patch.vertices_capacity[0] = v_cap;
+    h_patch.edges_capacity[0]    = e_cap;
+    h_patch.faces_capacity[0]    = f_cap;
+
+    // the grown patch is divided by the next slice_patches()
+    d_patch.should_slice = true;
+    h_patch.should_slice = true;
+
+    CUDA_ERROR(cudaMemcpy(m_d_patches_info + p,
+                          &d_patch,
+                          sizeof(PatchInfo),
+                          cudaMemcpyHostToDevice));
+
+    const uint32_t stale = 1;
+    CUDA_ERROR(cudaMemcpy(
+        m_d_host_stale + p, &stale, sizeof(uint32_t), cudaMemcpyHostToDevice));
+
+    // attributes read the new capacity from the patch info
+    m_attr_container->grow_patch(p, old_v_cap, old_e_cap, old_f_cap);
+
+    m_max_vertex_capacity = std::max(m_max_vertex_capacity, uint32_t(v_cap));
+    m_max_edge_capacity   = std::max(m_max_edge_capacity, uint32_t(e_cap));
+    m_max_face_capacity   = std::max(m_max_face_capacity, uint32_t(f_cap));
+
+    m_max_capacity_lp_v =
+        std::max(m_max_capacity_lp_v, d_patch.lp_v.get_capacity());
+    m_max_capacity_lp_e =
+        std::max(m_max_capacity_lp_e, d_patch.lp_e.get_capacity());
+    m_max_capacity_lp_f =
+        std::max(m_max_capacity_lp_f, d_patch.lp_f.get_capacity());
+}
+
+bool RXMeshDynamic::grow_spare_patches(uint32_t max_num_patches)
+{
+    if (max_num_patches <= get_max_num_patches()) {
+        return true;
+    }
+
+    if (is_device_memory_managed()) {
+        RXMESH_WARN(
+            "RXMeshDynamic::grow_spare_patches() growing the spare patches is "
+            "not supported with streaming or multi-GPU");
+        return false;
+    }
+
+    bool ret = true;
+    if (max_num_patches > get_num_patch_slots()) {
+        RXMESH_WARN(
+            "RXMeshDynamic::grow_spare_patches() requested {} patches but "
+            "there are only {} patch slots",
+            max_num_patches,
+            get_num_patch_slots());
+        max_num_patches = get_num_patch_slots();
+        ret             = false;
+        if (max_num_patches <= get_max_num_patches()) {
+            return false;
+        }
+    }
+
+    const uint32_t begin = get_max_num_patches();
+    m_max_num_patches    = max_num_patches;
+
+    m_h_num_owned_v.resize(m_max_num_patches, 0);
+    m_h_num_owned_e.resize(m_max_num_patches, 0);
+    m_h_num_owned_f.resize(m_max_num_patches, 0);
+
+    allocate_extra_patches(begin);
+
+    this->m_rxmesh_context.m_max_num_patches = m_max_num_patches;
+    this->m_rxmesh_context.m_max_lp_capacity_v =
+        max_lp_hashtable_capacity<LocalVertexT>();
+    this->m_rxmesh_context.m_max_lp_capacity_e =
+        max_lp_hashtable_capacity<LocalEdgeT>();
+    this->m_rxmesh_context.m_max_lp_capacity_f =
+        max_lp_hashtable_capacity<LocalFaceT>();
+
+    m_attr_container->grow_num_patches(m_max_num_patches);
+
+    RXMESH_TRACE(
+        "RXMeshDynamic::grow_spare_patches() max number of patches grew "
+        "from {} to {}",
+        begin,
+        m_max_num_patches);
+
+    return ret;
+}
+
+void RXMeshDynamic::ensure_spare_patches(cudaStream_t stream)
+{
+    constexpr uint32_t block_size = 256;
+
+    CUDA_ERROR(cudaMemsetAsync(m_d_cleanup_count, 0, sizeof(uint32_t), stream));
+
+    detail::count_patches_to_slice<block_size>
+        <<<DIVIDE_UP(get_num_patches(), block_size), block_size, 0, stream>>>(
+            this->m_rxmesh_context, m_d_cleanup_count);
+
+    uint32_t num_to_slice = 0;
+    CUDA_ERROR(cudaMemcpyAsync(&num_to_slice,
+                               m_d_cleanup_count,
+                               sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+
+    const uint32_t needed = get_num_patches() + num_to_slice;
+    if (needed > get_max_num_patches()) {
+        // grow geometrically so we do not grow by a few patches every time
+        grow_spare_patches(std::max(
+            needed,
+            static_cast<uint32_t>(std::ceil(
+                1.5f * static_cast<float>(get_max_num_patches())))));
+    }
+}
+
+const uint32_t* RXMeshDynamic::assign_slice_ids(cudaStream_t stream)
+{
+    if (!is_deterministic()) {
+        return nullptr;
+    }
+
+    constexpr uint32_t block_size = 256;
+
+    const uint32_t num_patches = get_num_patches(true);
+
+    // m_d_cleanup_list is not used until the next cleanup
+    detail::flag_patches_to_slice<block_size>
+        <<<DIVIDE_UP(num_patches, block_size), block_size, 0, stream>>>(
+            this->m_rxmesh_context, num_patches, m_d_cleanup_list);
+
+    std::vector<uint32_t> h_id(num_patches);
+    CUDA_ERROR(cudaMemcpyAsync(h_id.data(),
+                               m_d_cleanup_list,
+                               num_patches * sizeof(uint32_t),
+                               cudaMemcpyDeviceToHost,
+                               stream));
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+
+    uint32_t next = num_patches;
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        h_id[p] = (h_id[p] != 0) ? next++ : INVALID32;
+    }
+
+    CUDA_ERROR(cudaMemcpyAsync(m_d_cleanup_list,
+                               h_id.data(),
+                               num_patches * sizeof(uint32_t),
+                               cudaMemcpyHostToDevice,
+                               stream));
+    return m_d_cleanup_list;
+}
+
+void RXMeshDynamic::reset_deterministic_phases(
+    const std::vector<uint32_t>& pids,
+    cudaStream_t                 stream)
+{
+    PatchScheduler& sch = get_scheduler(stream);
+
+    // drop what the last kernel left
+    sch.take_deferred(stream);
+    sch.refill(std::vector<uint32_t>(), stream);
+
+    DeterministicPhases& phases = m_deterministic_phases[stream];
+    phases.pending              = pids;
+    phases.color                = 0;
+    std::sort(phases.pending.begin(), phases.pending.end());
+    phases.pending.erase(
+        std::unique(phases.pending.begin(), phases.pending.end()),
+        phases.pending.end());
+}
+
+bool RXMeshDynamic::next_deterministic_phase(cudaStream_t stream)
+{
+    PatchScheduler&      sch    = get_scheduler(stream);
+    DeterministicPhases& phases = m_deterministic_phases[stream];
+
+    const std::vector<uint32_t> pushed = sch.take_deferred(stream);
+
+    std::vector<uint32_t> pending;
+    pending.reserve(phases.pending.size() + pushed.size());
+    std::set_union(phases.pending.begin(),
+                   phases.pending.end(),
+                   pushed.begin(),
+                   pushed.end(),
+                   std::back_inserter(pending));
+    phases.pending.swap(pending);
+
+    if (phases.pending.empty()) {
+        return false;
+    }
+
+    // the cavities of the last phase changed the patch stashes
+    const uint32_t num_colors = color_patches();
+
+    for (uint32_t i = 0; i < num_colors; ++i) {
+        const uint32_t color = (phases.color + i) % num_colors;
+
+        std::vector<uint32_t> pids, rest;
+        for (const uint32_t p : phases.pending) {
+            if (m_patch_coloring.get_color(p) == color) {
+                pids.push_back(p);
+            } else {
+                rest.push_back(p);
+            }
+        }
+        if (!pids.empty()) {
+            phases.pending.swap(rest);
+            phases.color = color + 1;
+            sch.refill(pids, stream);
+            return true;
+        }
+    }
+
+    // every patch has a color and so this should not happen
+    RXMESH_ERROR(
+        "RXMeshDynamic::next_deterministic_phase() can not find the color of "
+        "the {} pending patches",
+        phases.pending.size());
+    sch.refill(phases.pending, stream);
+    phases.pending.clear();
+    return true;
 }
 
 void RXMeshDynamic::update_host()
@@ -2655,9 +3344,29 @@ void RXMeshDynamic::update_host()
             "RXMeshDynamic::update_host() number of patches is bigger than the "
             "maximum expect number of patches");
     }
-    m_num_patches = num_patches;
+    const uint32_t num_host_patches = m_num_patches;
+    m_num_patches                   = num_patches;
+
+    // patches that are dirty (and not cleaned yet) are also stale on the host
+    gather_cleanup_patches(m_num_cleaned_patches);
+
+    std::vector<uint32_t> h_stale(m_num_patches);
+    CUDA_ERROR(cudaMemcpy(h_stale.data(),
+                          m_d_host_stale,
+                          m_num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(
+        cudaMemset(m_d_host_stale, 0, m_num_patches * sizeof(uint32_t)));
+
+    uint32_t num_stale = 0;
 
     for (uint32_t p = 0; p < m_num_patches; ++p) {
+        // only copy patches that changed since the last update
+        if (h_stale[p] == 0 && p < num_host_patches) {
+            continue;
+        }
+        ++num_stale;
+
         PatchInfo d_patch;
         CUDA_ERROR(cudaMemcpy(&d_patch,
                               m_d_patches_info + p,
@@ -2865,7 +3574,14 @@ void RXMeshDynamic::update_host()
 
     this->calc_max_elements();
 
-    RXMESH_TRACE("RXMeshDynamic updating host finished");
+    // the stale patches have changed topology since the last update which
+    // also invalidates the cached queries (see cache_query)
+    if (num_stale > 0) {
+        release_query_cache();
+    }
+
+    RXMESH_TRACE("RXMeshDynamic updating host finished ({} stale patches)",
+                 num_stale);
 }
 
 void RXMeshDynamic::update_polyscope(std::string new_name)
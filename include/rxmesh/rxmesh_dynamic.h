@@ -2,13 +2,19 @@
 #include "rxmesh/rxmesh_static.h"
 
 #include <cooperative_groups.h>
+#include <map>
 
 #include "rxmesh/bitmask.cuh"
 #include "rxmesh/kernels/rxmesh_queries.cuh"
+#include "rxmesh/patch_coloring.h"
 
 #define SLICE_GGP
 
 namespace rxmesh {
+
+template <typename T>
+struct DerivedAttributes;
+
 namespace detail {
 
 template <uint32_t blockThreads>
@@ -109,12 +115,70 @@ __inline__ __device__ void post_slicing_update_attributes(
     }
 }
 
+template <uint32_t blockThreads, typename T>
+__inline__ __device__ void post_slicing_update_attributes(
+    const PatchInfo&      pi,
+    const uint32_t        new_patch_id,
+    const Bitmask&        ownership_change_v,
+    const Bitmask&        ownership_change_e,
+    const Bitmask&        ownership_change_f,
+    DerivedAttributes<T>& derived)
+{
+    auto update = [&](auto& attribute) {
+        post_slicing_update_attributes<blockThreads>(pi,
+                                                     new_patch_id,
+                                                     ownership_change_v,
+                                                     ownership_change_e,
+                                                     ownership_change_f,
+                                                     attribute);
+    };
+    update(derived.coords);
+    if (derived.has(DERIVED_EDGE_LENGTH)) {
+        update(derived.edge_length);
+    }
+    if (derived.has(DERIVED_FACE_NORMAL)) {
+        update(derived.face_normal);
+    }
+    if (derived.has(DERIVED_FACE_AREA)) {
+        update(derived.face_area);
+    }
+    if (derived.has(DERIVED_VERTEX_VALENCE)) {
+        update(derived.valence);
+    }
+    if (derived.has(DERIVED_VERTEX_BOUNDARY)) {
+        update(derived.boundary);
+    }
+}
+
+
+/**
+ * @brief check if a patch that should be sliced can be sliced now. If any of
+ * the neighbor patches is dirty, we don't slice because it messes the
+ * connectivity of other neighbor patches
+ */
+__device__ __inline__ bool can_slice(const Context&   context,
+                                     const PatchInfo& pi)
+{
+    for (uint32_t i = 0; i < PatchStash::stash_size; ++i) {
+        uint32_t q = pi.patch_stash.get_patch(i);
+        if (q != INVALID32) {
+            if (context.m_patches_info[q].is_dirty()) {
+                // printf("\n slicing: patch %u finds %u dirty",
+                //        pi.patch_id,
+                //        q);
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
 template <uint32_t blockThreads,
           uint32_t itemPerThread,
           typename... AttributesT>
-__global__ static void slice_patches(Context        context,
-                                     const uint32_t current_num_patches,
+__global__ static void slice_patches(Context         context,
+                                     const uint32_t  current_num_patches,
+                                     const uint32_t* d_slice_id,
                                      AttributesT... attributes)
 {
     // ev, fe, active_v/e/f, owned_v/e/f, patch_v/e/f
@@ -167,27 +231,32 @@ __global__ static void slice_patches(Context        context,
 
         __shared__ uint32_t s_new_patch_id;
         if (threadIdx.x == 0) {
-            // check if any of the neighbor patches are dirty. If so, we don't
-            // slice because it messes the connectivity of other neighbor
-            // patches
-            bool ok = true;
-            for (uint32_t i = 0; i < PatchStash::stash_size; ++i) {
-                uint32_t q = pi.patch_stash.get_patch(i);
-                if (q != INVALID32) {
-                    if (context.m_patches_info[q].is_dirty()) {
-                        // printf("\n slicing: patch %u finds %u dirty",
-                        //        pi.patch_id,
-                        //        q);
-                        ok = false;
-                        break;
+            // in the deterministic mode, the check was done (before any patch
+            // got sliced) when the new ids were assigned
+            const bool ok = (d_slice_id == nullptr) ?
+                                can_slice(context, pi) :
+                                d_slice_id[pid] != INVALID32;
+            if (ok) {
+                if (d_slice_id == nullptr) {
+                    s_new_patch_id =
+                        ::atomicAdd(context.m_num_patches, uint32_t(1));
+                } else {
+                    s_new_patch_id = d_slice_id[pid];
+                    if (s_new_patch_id < context.m_max_num_patches) {
+                        ::atomicAdd(context.m_num_patches, uint32_t(1));
                     }
                 }
-            }
-            if (ok) {
-                s_new_patch_id =
-                    ::atomicAdd(context.m_num_patches, uint32_t(1));
-                assert(s_new_patch_id < context.m_max_num_patches);
-                context.m_patch_scheduler.push(s_new_patch_id);
+                if (s_new_patch_id < context.m_max_num_patches) {
+                    context.m_patch_scheduler.push(s_new_patch_id);
+                } else {
+                    // out of spare patches. We keep should_slice so the patch
+                    // is sliced once the spare pool grows (see
+                    // RXMeshDynamic::grow_spare_patches)
+                    if (d_slice_id == nullptr) {
+                        ::atomicSub(context.m_num_patches, uint32_t(1));
+                    }
+                    s_new_patch_id = INVALID32;
+                }
                 // printf("\n slicing %u into %u", pi.patch_id, s_new_patch_id);
             } else {
                 s_new_patch_id                           = INVALID32;
@@ -627,6 +696,22 @@ __global__ static void slice_patches(Context        context,
 #endif
     }
 }
+
+template <uint32_t blockThreads>
+__global__ static void gather_patch_stash(const Context  context,
+                                          const uint32_t num_patches,
+                                          uint32_t*      d_stash)
+{
+    const uint32_t p = blockIdx.x * blockThreads + threadIdx.x;
+    if (p < num_patches) {
+        const PatchInfo& pi = context.m_patches_info[p];
+        for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+            d_stash[p * PatchStash::stash_size + i] =
+                (pi.patch_id == INVALID32) ? INVALID32 :
+                                             pi.patch_stash.get_patch(i);
+        }
+    }
+}
 }  // namespace detail
 
 
@@ -635,6 +720,11 @@ class RXMeshDynamic : public RXMeshStatic
    public:
     RXMeshDynamic(const RXMeshDynamic&) = delete;
 
+    // the per-patch tables are allocated for this many times the initial
+    // maximum number of patches so the spare patches can grow (see
+    // grow_spare_patches)
+    static constexpr uint32_t patch_slots_factor = 4;
+
     /**
      * @brief Constructor using path to obj file
      * @param file_path path to an obj file
@@ -644,14 +734,21 @@ class RXMeshDynamic : public RXMeshStatic
                            const uint32_t    patch_size               = 256,
                            const float       capacity_factor          = 1.8,
                            const float       patch_alloc_factor       = 5.0,
-                           const float       lp_hashtable_load_factor = 0.5)
+                           const float       lp_hashtable_load_factor = 0.5,
+                           const int         num_threads              = -1)
         : RXMeshStatic(file_path,
                        patcher_file,
                        patch_size,
                        capacity_factor,
                        patch_alloc_factor,
-                       lp_hashtable_load_factor)
+                       lp_hashtable_load_factor,
+                       num_threads,
+                       0,
+                       1,
+                       false,
+                       patch_slots_factor)
     {
+        init_cleanup();
     }
 
     /**
@@ -663,14 +760,19 @@ class RXMeshDynamic : public RXMeshStatic
                            const uint32_t    patch_size               = 256,
                            const float       capacity_factor          = 1.8,
                            const float       patch_alloc_factor       = 5.0,
-                           const float       lp_hashtable_load_factor = 0.5)
+                           const float       lp_hashtable_load_factor = 0.5,
+                           const int         num_threads              = -1)
         : RXMeshStatic(fv,
                        patcher_file,
                        patch_size,
                        capacity_factor,
                        patch_alloc_factor,
-                       lp_hashtable_load_factor)
+                       lp_hashtable_load_factor,
+                       num_threads,
+                       false,
+                       patch_slots_factor)
     {
+        init_cleanup();
     }
 
     /**
@@ -723,11 +825,14 @@ class RXMeshDynamic : public RXMeshStatic
             blockThreads);
 
 
-        check_shared_memory(launch_box.smem_bytes_dyn,
-                            launch_box.smem_bytes_static,
-                            launch_box.num_registers_per_thread,
-                            blockThreads,
-                            kernel);
+        launch_box.num_blocks_per_sm =
+            check_shared_memory(launch_box.smem_bytes_dyn,
+                                launch_box.smem_bytes_static,
+                                launch_box.num_registers_per_thread,
+                                blockThreads,
+                                kernel,
+                                true,
+                                launch_box.exit_on_failure);
     }
 
 
@@ -819,6 +924,10 @@ class RXMeshDynamic : public RXMeshStatic
             size_t cavity_creator_shmem = half_face_cap * sizeof(uint16_t) +
                                           ShmemAllocator::default_alignment;
 
+            // cavity priority key
+            cavity_creator_shmem += half_face_cap * sizeof(float) +
+                                    ShmemAllocator::default_alignment;
+
             // size_t q_lp_shmem =
             //     std::max(max_lp_hashtable_capacity<LocalVertexT>(),
             //              max_lp_hashtable_capacity<LocalEdgeT>());
@@ -880,34 +989,359 @@ class RXMeshDynamic : public RXMeshStatic
                 ShmemAllocator::default_alignment;
         }
 
-        check_shared_memory(launch_box.smem_bytes_dyn,
-                            launch_box.smem_bytes_static,
-                            launch_box.num_registers_per_thread,
-                            blockThreads,
-                            kernel,
-                            false);
+        launch_box.num_blocks_per_sm =
+            check_shared_memory(launch_box.smem_bytes_dyn,
+                                launch_box.smem_bytes_static,
+                                launch_box.num_registers_per_thread,
+                                blockThreads,
+                                kernel,
+                                false,
+                                launch_box.exit_on_failure);
+    }
+
+    virtual ~RXMeshDynamic()
+    {
+        GPU_FREE(m_d_cleanup_list);
+        GPU_FREE(m_d_cleanup_count);
+        GPU_FREE(m_d_host_stale);
+        GPU_FREE(m_d_num_owned_v);
+        GPU_FREE(m_d_num_owned_e);
+        GPU_FREE(m_d_num_owned_f);
+        for (auto& it : m_stream_schedulers) {
+            it.second.free();
+        }
+    }
+
+    using RXMeshStatic::get_context;
+
+    /**
+     * @brief return the patch scheduler used by dynamic kernels launched on a
+     * stream. The default stream (NULL) uses the scheduler stored in the
+     * context (i.e., get_context()). Every other stream gets its own scheduler
+     * the first time it is used so that independent jobs (e.g., a remeshing
+     * loop and an analysis pass) running on different streams do not pop
+     * each other's patches. Two jobs that run dynamic kernels on the same mesh
+     * at the same time should still work on disjoint set of patches (e.g.,
+     * using reset_scheduler(priority, stream)) since patches are locked by a
+     * single block at a time
+     * @param stream the stream
+     */
+    PatchScheduler& get_scheduler(cudaStream_t stream = NULL)
+    {
+        if (stream == NULL) {
+            return this->m_rxmesh_context.m_patch_scheduler;
+        }
+        auto it = m_stream_schedulers.find(stream);
+        if (it == m_stream_schedulers.end()) {
+            const PatchScheduler& sch =
+                this->m_rxmesh_context.m_patch_scheduler;
+
+            PatchScheduler stream_sch;
+            stream_sch.init(sch.capacity, sch.num_queues);
+            stream_sch.defer = sch.defer;
+            // starts empty i.e., reset_scheduler(stream) should be called
+            stream_sch.refill(std::vector<uint32_t>(), stream);
+            it = m_stream_schedulers.emplace(stream, stream_sch).first;
+
+            RXMESH_TRACE(
+                "RXMeshDynamic::get_scheduler() created a scheduler with {} "
+                "queues for a new stream",
+                sch.num_queues);
+        }
+        return it->second;
     }
 
-    virtual ~RXMeshDynamic() = default;
+    /**
+     * @brief the context to be passed to dynamic kernels launched on a
+     * stream. It is the same as get_context() except that the kernel pops
+     * patches from get_scheduler(stream)
+     * @param stream the stream
+     */
+    Context get_context(cudaStream_t stream)
+    {
+        Context context           = this->m_rxmesh_context;
+        context.m_patch_scheduler = get_scheduler(stream);
+        return context;
+    }
 
     /**
-     * @brief check if there is remaining patches not processed yet
+     * @brief check if there is remaining patches not processed yet by
+     * kernels launched on this stream. In the deterministic mode (see
+     * set_deterministic), this is also where the next color phase is loaded
+     * once the current one is done
      */
     bool is_queue_empty(cudaStream_t stream = NULL)
     {
-        return this->m_rxmesh_context.m_patch_scheduler.is_empty(stream);
+        if (!is_deterministic()) {
+            return get_scheduler(stream).is_empty(stream);
+        }
+        if (!get_scheduler(stream).is_empty(stream)) {
+            return false;
+        }
+        return !next_deterministic_phase(stream);
     }
 
+    /**
+     * @brief turn the deterministic mode on/off. In the deterministic mode,
+     * a sequence of dynamic kernels (launched with the usual
+     * reset_scheduler()/is_queue_empty() loop), cleanup(), and slice_patches()
+     * produces the same mesh on every run given the same input (and the same
+     * patches e.g., read from a patcher file). This is done by removing every
+     * decision that depends on the timing of the blocks or threads:
+     *  - patches are processed one color at a time (see color_patches) so
+     * concurrent blocks do not lock the same patch. Patches pushed back to the
+     * queue, and patches created by slicing, wait for a later color phase.
+     * The colors are visited in round robin and the patches of a color are
+     * processed in ascending order of their id
+     *  - the lock priority is the patch id instead of the block id
+     *  - conflicting cavities are resolved by their priority and then by the
+     * local id of their creator instead of the cavity id
+     *  - the fill-ins run one at a time in ascending order of their creator and
+     * the elements copied from neighbor patches are added by one thread at a
+     * time so the local ids of the new elements are stable
+     *  - sliced patches get their new id in ascending order of the patch that
+     * is sliced
+     *
+     * This mode is meant for debugging and regression tests and it is
+     * expected to be several times slower since there is (at least) one launch
+     * per color, the patches are recolored between phases, and the fill-in
+     * and migration are serialized within the block. It is not supported with
+     * persistent kernels or launch_until_queue_empty() since the next color
+     * phase is loaded by is_queue_empty() on the host
+     * @param deterministic turn the deterministic mode on or off
+     */
+    void set_deterministic(bool deterministic)
+    {
+        this->m_rxmesh_context.m_deterministic = deterministic;
+        this->m_rxmesh_context.m_patch_scheduler.defer = deterministic;
+        for (auto& it : m_stream_schedulers) {
+            it.second.defer = deterministic;
+        }
+        m_deterministic_phases.clear();
+    }
+
+    /**
+     * @brief check if the deterministic mode is on (see set_deterministic)
+     */
+    bool is_deterministic() const
+    {
+        return this->m_rxmesh_context.m_deterministic;
+    }
+
+    /**
+     * @brief turn the optimistic mode of the dynamic kernels on/off. By
+     * default, a block locks its patch and every neighbor patch it reads
+     * during the migration where acquiring a lock spins until the lock is
+     * free or a block with a higher priority takes it. In the optimistic mode,
+     * the patches are not locked while they are read. Instead, the block reads
+     * the version of every patch (see PatchLock) before reading it, migrates
+     * in shared memory, and then commits by atomically bumping the version of
+     * every patch it read only if none of them has changed in the meantime.
+     * The commit does not wait: if one of the patches has changed, the commit
+     * is undone and the patch is pushed back to the queue, as happens when a
+     * neighbor lock fails. Reading a patch only fails while another block is
+     * committing to it. The patches are committed in ascending order of their
+     * id so that of two conflicting blocks, the one that reaches the patch
+     * with the lowest id first wins. A failed commit is counted as
+     * Counter::CommitFail. The mode should not be changed while a dynamic
+     * kernel is running
+     * @param optimistic turn the optimistic mode on or off
+     */
+    void set_optimistic(bool optimistic)
+    {
+        this->m_rxmesh_context.m_optimistic = optimistic;
+    }
+
+    /**
+     * @brief check if the optimistic mode is on (see set_optimistic)
+     */
+    bool is_optimistic() const
+    {
+        return this->m_rxmesh_context.m_optimistic;
+    }
+
+
+    /**
+     * @brief replay a captured graph (e.g., one that launches a dynamic kernel
+     * and its cleanup kernels) until all patches are processed without
+     * checking the queue on the host after every replay (see
+     * CUDAGraph::launch_while). The graph should not refill the scheduler
+     * @param graph the captured graph
+     * @param max_replays maximum number of replays
+     * @param check_interval number of replays between two checks of the queue
+     * @param stream the stream used to launch the graph
+     * @return the number of replays
+     */
+    uint32_t launch_until_queue_empty(CUDAGraph&     graph,
+                                      const uint32_t max_replays,
+                                      const uint32_t check_interval = 1,
+                                      cudaStream_t   stream         = NULL)
+    {
+        const PatchScheduler sch = get_scheduler(stream);
+        if (sch.num_queues == 1) {
+            return graph.launch_while(
+                sch.count, max_replays, check_interval, stream);
+        }
+
+        // sum the sizes of all ring buffers on the device before every check
+        auto sum_size = [sch] __device__() { sch.total[0] = sch.size(); };
+        return graph.launch_while(
+            [sch, sum_size](cudaStream_t s) -> const int* {
+                launch_scalar(s, sum_size);
+                return sch.total;
+            },
+            max_replays,
+            check_interval,
+            stream);
+    }
+
+    /**
+     * @brief turn a launch box populated by prepare_launch_box into a
+     * persistent launch i.e., only as many blocks as can be resident on the
+     * device at the same time are launched. The kernel should process patches
+     * using persistent_patch_loop() so the blocks stay resident and keep
+     * processing patches until the queue is empty instead of relaunching the
+     * kernel until is_queue_empty()
+     * @param launch_box launch box populated by prepare_launch_box
+     * @param kernel the kernel to be launched
+     */
+    template <uint32_t blockThreads>
+    void make_persistent(LaunchBox<blockThreads>& launch_box,
+                         const void*              kernel) const
+    {
+        int device = 0, num_sms = 0, blocks_per_sm = 0;
+        CUDA_ERROR(cudaGetDevice(&device));
+        CUDA_ERROR(cudaDeviceGetAttribute(
+            &num_sms, cudaDevAttrMultiProcessorCount, device));
+        CUDA_ERROR(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+            &blocks_per_sm, kernel, blockThreads, launch_box.smem_bytes_dyn));
+
+        const uint32_t resident =
+            std::max(uint32_t(num_sms * blocks_per_sm), uint32_t(1));
+
+        launch_box.blocks = std::min(launch_box.blocks, resident);
+
+        RXMESH_TRACE(
+            "RXMeshDynamic::make_persistent() launching {} persistent blocks "
+            "({} per SM)",
+            launch_box.blocks,
+            blocks_per_sm);
+    }
 
     /**
      * @brief reset the patches for a another kernel. This needs only to be
      * called where more than one kernel is called. For a single kernel, the
      * queue is initialized during the construction so the user does not to call
      * this
+     * @param stream the stream of the scheduler (see get_scheduler)
+     */
+    void reset_scheduler(cudaStream_t stream = NULL)
+    {
+        if (is_deterministic()) {
+            std::vector<uint32_t> pids(get_num_patches());
+            fill_with_sequential_numbers(pids.data(), pids.size());
+            reset_deterministic_phases(pids, stream);
+            return;
+        }
+        get_scheduler(stream).refill(get_num_patches(), stream);
+    }
+
+    /**
+     * @brief reset the patches for a another kernel such that patches with
+     * more pending work are processed first and patches without pending work
+     * are not processed at all
+     * @param priority the pending work (e.g., number of edges to be flipped)
+     * in every patch. Should have at least get_num_patches() entries
+     * @param stream the stream of the scheduler (see get_scheduler)
      */
-    void reset_scheduler()
+    void reset_scheduler(const std::vector<uint32_t>& priority,
+                         cudaStream_t                 stream = NULL)
     {
-        this->m_rxmesh_context.m_patch_scheduler.refill(get_num_patches());
+        if (is_deterministic()) {
+            // the order is dictated by the colors
+            std::vector<uint32_t> pids;
+            for (uint32_t p = 0; p < get_num_patches(); ++p) {
+                if (priority[p] > 0) {
+                    pids.push_back(p);
+                }
+            }
+            reset_deterministic_phases(pids, stream);
+            return;
+        }
+        get_scheduler(stream).refill(get_num_patches(), priority, stream);
+    }
+
+    /**
+     * @brief color the patch graph such that no two patches of the same color
+     * lock the same patch (see PatchColoring). If the patches have been
+     * colored before, only patches whose neighbor patches changed are
+     * recolored. After the first call, slice_patches() updates the coloring
+     * automatically
+     * @return the number of colors
+     */
+    uint32_t color_patches()
+    {
+        const uint32_t num_patches = this->get_num_patches(true);
+        const size_t   num_bytes =
+            num_patches * PatchStash::stash_size * sizeof(uint32_t);
+
+        uint32_t* d_stash = nullptr;
+        CUDA_ERROR(cudaMalloc((void**)&d_stash, num_bytes));
+
+        constexpr uint32_t block_size = 256;
+        detail::gather_patch_stash<block_size>
+            <<<DIVIDE_UP(num_patches, block_size), block_size>>>(
+                this->m_rxmesh_context, num_patches, d_stash);
+
+        std::vector<uint32_t> h_stash(num_patches * PatchStash::stash_size);
+        CUDA_ERROR(cudaMemcpy(
+            h_stash.data(), d_stash, num_bytes, cudaMemcpyDeviceToHost));
+        GPU_FREE(d_stash);
+
+        m_patch_coloring.update(h_stash, num_patches);
+        return m_patch_coloring.get_num_colors();
+    }
+
+    /**
+     * @brief return the patch coloring computed by color_patches()
+     */
+    const PatchColoring& get_patch_coloring() const
+    {
+        return m_patch_coloring;
+    }
+
+    /**
+     * @brief reset the patches for another kernel such that only the patches
+     * of one color are processed. Running a dynamic kernel one color at a
+     * time means that concurrent blocks never compete on the same patch
+     * lock. color_patches() should be called first
+     * @param color the color to be processed
+     * @param stream the stream of the scheduler (see get_scheduler)
+     */
+    void reset_scheduler_to_color(const uint32_t color,
+                                  cudaStream_t   stream = NULL)
+    {
+        if (!m_patch_coloring.is_colored()) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::reset_scheduler_to_color() color_patches() "
+                "should be called first");
+            return;
+        }
+        if (color >= m_patch_coloring.get_num_colors()) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::reset_scheduler_to_color() invalid color {}. "
+                "The number of colors is {}",
+                color,
+                m_patch_coloring.get_num_colors());
+            return;
+        }
+        if (is_deterministic()) {
+            reset_deterministic_phases(m_patch_coloring.get_patches(color),
+                                       stream);
+            return;
+        }
+        get_scheduler(stream).refill(m_patch_coloring.get_patches(color),
+                                     stream);
     }
 
     /**
@@ -921,9 +1355,60 @@ class RXMeshDynamic : public RXMeshStatic
     /**
      * @brief cleanup after topology changes by removing surplus elements
      * and make sure that hashtable store owner patches. Also, reset the number
-     * of vertices/edges/faces
+     * of vertices/edges/faces. Only patches touched since the last cleanup
+     * are cleaned i.e., new, dirty, or sliced patches and their neighbors.
+     * The cleanup kernels run on the stream and the host only waits for this
+     * stream (to read back the number of touched patches) which allows
+     * kernels on other streams (e.g., queries on another mesh) to overlap
+     * with the cleanup. The cleanup modifies the whole mesh and so it should
+     * not overlap with other kernels that read or write this mesh
+     * @param stream the stream to run the cleanup kernels on
+     * @return the number of cleaned patches
+     */
+    uint32_t cleanup(cudaStream_t stream = NULL);
+
+    /**
+     * @brief grow the capacity of patches that are nearly full i.e., the
+     * number of active vertices, edges, or faces in the patch (or the load
+     * factor of its hashtables) is more than threshold of its capacity. The
+     * patch buffers, hashtables, and the memory of all attributes of the
+     * patch are reallocated on the device (and the host) with growth_factor
+     * times the capacity and the patch is marked to be sliced by the next
+     * slice_patches(). Since the per-patch capacity may grow, launch boxes
+     * should be prepared again after calling this function (which is what
+     * the apps do already after every cleanup)
+     * @param threshold fraction of the capacity above which the patch grows
+     * @param growth_factor the new capacity relative to the old one
+     * @return the number of grown patches
+     */
+    uint32_t grow_patches(const float threshold     = 0.9f,
+                          const float growth_factor = 1.5f);
+
+    /**
+     * @brief call grow_patches() automatically at the end of every cleanup().
+     * This is disabled by default
+     * @param threshold see grow_patches(). Zero (or negative) value disables
+     * the automatic growth
+     * @param growth_factor see grow_patches()
+     */
+    void set_patch_growth(const float threshold,
+                          const float growth_factor = 1.5f)
+    {
+        m_growth_threshold = threshold;
+        m_growth_factor    = growth_factor;
+    }
+
+    /**
+     * @brief extend the pool of spare patches (used by slice_patches) such
+     * that the maximum number of patches is max_num_patches. The new spare
+     * patches have the same capacity as the largest patch. slice_patches()
+     * calls this function on its own when there are not enough spare patches
+     * @param max_num_patches the new maximum number of patches. It is clamped
+     * to get_num_patch_slots()
+     * @return true if the maximum number of patches has grown to
+     * max_num_patches
      */
-    void cleanup();
+    bool grow_spare_patches(uint32_t max_num_patches);
 
     /**
      * @brief slice a patch if the number of faces in the patch is greater
@@ -932,21 +1417,30 @@ class RXMeshDynamic : public RXMeshStatic
     template <typename... AttributesT>
     void slice_patches(AttributesT... attributes)
     {
+        slice_patches(cudaStream_t(NULL), attributes...);
+    }
+
+    /**
+     * @brief slice_patches() on a stream. The new patches are pushed to the
+     * scheduler of this stream (see get_scheduler) so that they are
+     * processed by the next dynamic kernel launched on the same stream
+     * @param stream the stream to run the slicing kernel on
+     */
+    template <typename... AttributesT>
+    void slice_patches(cudaStream_t stream, AttributesT... attributes)
+    {
+        // slicing changes the patches and so the cached queries are stale
+        this->release_query_cache();
+
+        ensure_spare_patches(stream);
 
         const uint32_t grid_size = get_num_patches();
 
-        CUDA_ERROR(cudaMemcpy(&this->m_max_vertices_per_patch,
-                              this->m_rxmesh_context.m_max_num_vertices,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemcpy(&this->m_max_edges_per_patch,
-                              this->m_rxmesh_context.m_max_num_edges,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemcpy(&this->m_max_faces_per_patch,
-                              this->m_rxmesh_context.m_max_num_faces,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
+        read_max_elements_per_patch(stream);
+
+        const Context context = get_context(stream);
+
+        const uint32_t* d_slice_id = assign_slice_ids(stream);
 
         // ev, fe
         uint32_t dyn_shmem =
@@ -973,40 +1467,28 @@ class RXMeshDynamic : public RXMeshStatic
         auto launch = [&](int add_item) {
             if (add_item == 0) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else if (add_item == 1) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD + 1>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else if (add_item == 2) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD + 2>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else if (add_item == 3) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD + 3>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else if (add_item == 4) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD + 4>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else if (add_item == 5) {
                 detail::slice_patches<block_size, TRANSPOSE_ITEM_PER_THREAD + 5>
-                    <<<grid_size, block_size, dyn_shmem>>>(
-                        this->m_rxmesh_context,
-                        get_num_patches(),
-                        attributes...);
+                    <<<grid_size, block_size, dyn_shmem, stream>>>(
+                        context, get_num_patches(), d_slice_id, attributes...);
             } else {
                 RXMESH_ERROR(
                     "RXMeshDynamic::slice_patches() can not find good "
@@ -1089,6 +1571,11 @@ class RXMeshDynamic : public RXMeshStatic
             }
         }
         CUDA_ERROR(cudaGetLastError());
+
+        // new patches (and their neighbors) need colors
+        if (m_patch_coloring.is_colored()) {
+            color_patches();
+        }
     }
 
 
@@ -1096,7 +1583,9 @@ class RXMeshDynamic : public RXMeshStatic
      * @brief update the host side. Use this function to update the host side
      * after performing (dynamic) updates on the GPU. This function may
      * re-allocates the host side memory buffers in case it is not enough (e.g.,
-     * after performing mesh refinement on the GPU)
+     * after performing mesh refinement on the GPU). Only patches that changed
+     * since the last call are copied and so it is cheap to call it right
+     * before reading the host side (even if nothing has changed)
      */
     void update_host();
 
@@ -1109,5 +1598,119 @@ class RXMeshDynamic : public RXMeshStatic
      * to RXMesh-stored vertex coordinates before calling this function.
      */
     void update_polyscope(std::string new_name = "");
+
+   private:
+    /**
+     * @brief allocate the buffers used to track the patches that need cleanup
+     */
+    void init_cleanup()
+    {
+        // sized by the patch slots so they stay valid as the spare pool grows.
+        // The list holds two entries per patch when used by grow_patches()
+        const uint32_t max_p = get_num_patch_slots();
+        CUDA_ERROR(cudaMalloc((void**)&m_d_cleanup_list,
+                              2 * max_p * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_cleanup_count, sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_host_stale, max_p * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMemset(m_d_host_stale, 0, max_p * sizeof(uint32_t)));
+
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_num_owned_v, max_p * sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_num_owned_e, max_p * sizeof(uint32_t)));
+        CUDA_ERROR(
+            cudaMalloc((void**)&m_d_num_owned_f, max_p * sizeof(uint32_t)));
+
+        // the first cleanup processes all patches to initialize the per-patch
+        // owned counts
+        m_num_cleaned_patches = 0;
+
+        m_growth_threshold = 0;
+        m_growth_factor    = 1.5f;
+    }
+
+    /**
+     * @brief collect the patches touched since the last cleanup in
+     * m_d_cleanup_list and mark them as stale on the host
+     * @param first_new_patch patches with id >= first_new_patch are new
+     * @return the number of touched patches
+     */
+    uint32_t gather_cleanup_patches(const uint32_t first_new_patch,
+                                    cudaStream_t   stream = NULL);
+
+    /**
+     * @brief read the maximum number of vertices/edges/faces per patch from
+     * the device and wait for the stream
+     */
+    void read_max_elements_per_patch(cudaStream_t stream = NULL);
+
+    /**
+     * @brief reallocate the buffers and hashtables of a single patch (and
+     * the attributes memory of the patch) with larger capacity
+     * @param p the patch id
+     * @param grow bitmask of what to grow (see detail::GrowFlag)
+     * @param growth_factor the new capacity relative to the old one
+     */
+    void grow_patch(const uint32_t p,
+                    const uint32_t grow,
+                    const float    growth_factor);
+
+    /**
+     * @brief make sure that there are enough spare patches for all patches
+     * that should be sliced and grow the spare pool otherwise
+     */
+    void ensure_spare_patches(cudaStream_t stream = NULL);
+
+    /**
+     * @brief in the deterministic mode, assign the id of the new patch of
+     * every patch that will be sliced in ascending order of the sliced patch
+     * (INVALID32 if the patch will not be sliced)
+     * @return the device array of the new ids or nullptr if not in the
+     * deterministic mode
+     */
+    const uint32_t* assign_slice_ids(cudaStream_t stream = NULL);
+
+    /**
+     * @brief make the patches pending for the deterministic color phases of
+     * this stream and clear the queue (see set_deterministic). The first
+     * phase is loaded by is_queue_empty()
+     */
+    void reset_deterministic_phases(const std::vector<uint32_t>& pids,
+                                    cudaStream_t                 stream);
+
+    /**
+     * @brief collect the patches pushed during the last color phase and load
+     * the patches of the next color that has pending patches
+     * @return false if there are no more pending patches
+     */
+    bool next_deterministic_phase(cudaStream_t stream);
+
+    // patches that wait for a later color phase in the deterministic mode
+    // (sorted) and the color to start looking from
+    struct DeterministicPhases
+    {
+        std::vector<uint32_t> pending;
+        uint32_t              color = 0;
+    };
+
+    PatchColoring m_patch_coloring;
+
+    // schedulers of the non-default streams (see get_scheduler)
+    std::map<cudaStream_t, PatchScheduler> m_stream_schedulers;
+
+    // color phases of every stream in the deterministic mode
+    std::map<cudaStream_t, DeterministicPhases> m_deterministic_phases;
+
+    // patches to be cleaned, and their count
+    uint32_t *m_d_cleanup_list, *m_d_cleanup_count;
+    // per-patch flag for patches that changed since the last update_host()
+    uint32_t* m_d_host_stale;
+    // per-patch number of owned elements as computed by the last cleanup
+    uint32_t *m_d_num_owned_v, *m_d_num_owned_e, *m_d_num_owned_f;
+    // number of patches at the end of the last cleanup
+    uint32_t m_num_cleaned_patches;
+    // automatic patch growth in cleanup (see set_patch_growth)
+    float m_growth_threshold, m_growth_factor;
 };
 }  // namespace rxmesh
\ No newline at end of file
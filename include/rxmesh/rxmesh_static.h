@@ -1,21 +1,31 @@
 ﻿#pragma once
 #include <assert.h>
+#include <array>
 #include <fstream>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <vector>
 
 #include <cuda_profiler_api.h>
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/cuda_graph.h"
+#include "rxmesh/frontier.cuh"
 #include "rxmesh/handle.h"
 #include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/kernels/query_cache.cuh"
 #include "rxmesh/kernels/shmem_allocator.cuh"
 #include "rxmesh/launch_box.h"
+#include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/import_mesh.h"
 #include "rxmesh/util/import_obj.h"
+#include "rxmesh/util/instrumentation.h"
 #include "rxmesh/util/log.h"
+#include "rxmesh/util/mesh_cache.h"
 #include "rxmesh/util/timer.h"
 
 #include "rxmesh/kernels/boundary.cuh"
@@ -39,58 +49,195 @@ class RXMeshStatic : public RXMesh
     RXMeshStatic(const RXMeshStatic&) = delete;
 
     /**
-     * @brief Constructor using path to obj file
-     * @param file_path path to an obj file
+     * @brief Constructor using path to obj, ply, or stl file or to a mesh cache
+     * written by save_cache. When loading a mesh cache, the patcher file and
+     * the construction parameters (patch size, capacity factor, etc) are
+     * ignored and the ones stored in the cache are used instead
+     * @param file_path path to an obj, ply, or stl file or a mesh cache
+     * @param num_threads number of host threads used to build the mesh (less
+     * than one means OpenMP default)
+     * @param max_resident_patches if not zero, the mesh is streamed i.e., the
+     * device memory is managed and for_each and run_query_kernel launches are
+     * split into waves such that at most this many patches are resident on
+     * the device at any time (see PatchResidency)
+     * @param num_gpus if more than one, the patches are split over this many
+     * GPUs starting from the current device and for_each and run_query_kernel
+     * launches run on all of them (see PatchPartition). Can not be used along
+     * with max_resident_patches
+     * @param compact if true, every patch is allocated with exactly its number
+     * of vertices, edges, and faces (and there are no spare patches) rather
+     * than with the maximum capacity over all patches. This reduces the
+     * topology and attributes memory for read-only workloads. The capacity
+     * factor and patch allocation factor are ignored in this case
+     * @param patch_slots_factor the per-patch tables (see
+     * get_num_patch_slots()) are allocated for this many times the maximum
+     * number of patches. Only meshes whose spare patches can grow (i.e.,
+     * RXMeshDynamic) need more than one. Ignored with compact
      */
     explicit RXMeshStatic(const std::string file_path,
                           const std::string patcher_file             = "",
                           const uint32_t    patch_size               = 512,
                           const float       capacity_factor          = 1.0,
                           const float       patch_alloc_factor       = 1.0,
-                          const float       lp_hashtable_load_factor = 0.8)
-        : RXMesh(patch_size)
+                          const float       lp_hashtable_load_factor = 0.8,
+                          const int         num_threads              = -1,
+                          const uint32_t    max_resident_patches     = 0,
+                          const int         num_gpus                 = 1,
+                          const bool        compact                  = false,
+                          const uint32_t    patch_slots_factor       = 1)
+        : RXMesh(patch_size, max_resident_patches, num_gpus)
     {
-        std::vector<std::vector<uint32_t>> fv;
-        std::vector<std::vector<float>>    vertices;
-        if (!import_obj(file_path, vertices, fv)) {
-            RXMESH_ERROR(
-                "RXMeshStatic::RXMeshStatic could not read the input file {}",
-                file_path);
-            exit(EXIT_FAILURE);
-        }
+        m_compact            = compact;
+        m_patch_slots_factor = patch_slots_factor;
 
-        this->init(fv,
-                   patcher_file,
-                   capacity_factor,
-                   patch_alloc_factor,
-                   lp_hashtable_load_factor);
+        std::vector<float> vertices;
+
+        if (is_mesh_cache(file_path)) {
+            if (!this->init_from_cache(file_path, vertices, num_threads)) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::RXMeshStatic could not read the input mesh "
+                    "cache {}",
+                    file_path);
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            std::vector<uint32_t> fv;
+            if (!import_mesh(file_path, vertices, fv, num_threads)) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::RXMeshStatic could not read the input file "
+                    "{}",
+                    file_path);
+                exit(EXIT_FAILURE);
+            }
+
+            this->init(fv,
+                       patcher_file,
+                       capacity_factor,
+                       patch_alloc_factor,
+                       lp_hashtable_load_factor,
+                       num_threads);
+        }
 
         m_attr_container = std::make_shared<AttributeContainer>();
 
-        std::string name = extract_file_name(file_path);
+        if (!vertices.empty()) {
+            std::string name = extract_file_name(file_path);
 #if USE_POLYSCOPE
-        name = polyscope::guessNiceNameFromPath(file_path);
+            name = polyscope::guessNiceNameFromPath(file_path);
 #endif
-        add_vertex_coordinates(vertices, name);
+            add_vertex_coordinates(vertices, name);
+        }
     };
 
     /**
      * @brief Constructor using triangles and vertices
      * @param fv Face incident vertices as read from an obj file
+     * @param num_threads number of host threads used to build the mesh (less
+     * than one means OpenMP default)
+     * @param compact exact per-patch allocation (see the constructor that
+     * takes a file path)
+     * @param patch_slots_factor per-patch tables allocation (see the
+     * constructor that takes a file path)
      */
     explicit RXMeshStatic(std::vector<std::vector<uint32_t>>& fv,
                           const std::string                   patcher_file = "",
                           const uint32_t                      patch_size = 512,
                           const float capacity_factor                    = 1.0,
                           const float patch_alloc_factor                 = 1.0,
-                          const float lp_hashtable_load_factor           = 0.8)
+                          const float lp_hashtable_load_factor           = 0.8,
+                          const int   num_threads                        = -1,
+                          const bool  compact                            = false,
+                          const uint32_t patch_slots_factor              = 1)
         : RXMesh(patch_size), m_input_vertex_coordinates(nullptr)
     {
+        m_compact            = compact;
+        m_patch_slots_factor = patch_slots_factor;
         this->init(fv,
                    patcher_file,
                    capacity_factor,
                    patch_alloc_factor,
-                   lp_hashtable_load_factor);
+                   lp_hashtable_load_factor,
+                   num_threads);
+        m_attr_container = std::make_shared<AttributeContainer>();
+    };
+
+    /**
+     * @brief Constructor using flat triangles and vertices as read by
+     * import_mesh i.e., the vertices of face f are fv[3 * f], fv[3 * f + 1],
+     * and fv[3 * f + 2] and the coordinates of vertex v are vertices[3 * v],
+     * vertices[3 * v + 1], and vertices[3 * v + 2]
+     * @param fv flat face incident vertices
+     * @param vertices flat vertex coordinates. If empty, the coordinates can be
+     * added later with add_vertex_coordinates
+     * @param num_threads number of host threads used to build the mesh (less
+     * than one means OpenMP default)
+     * @param max_resident_patches if not zero, the mesh is streamed (see the
+     * constructor that takes a file path)
+     * @param num_gpus number of GPUs to split the patches over (see the
+     * constructor that takes a file path)
+     * @param compact exact per-patch allocation (see the constructor that
+     * takes a file path)
+     */
+    explicit RXMeshStatic(const std::vector<uint32_t>& fv,
+                          const std::vector<float>&    vertices,
+                          const std::string            patcher_file = "",
+                          const uint32_t               patch_size   = 512,
+                          const float                  capacity_factor = 1.0,
+                          const float patch_alloc_factor                = 1.0,
+                          const float lp_hashtable_load_factor          = 0.8,
+                          const int   num_threads                       = -1,
+                          const uint32_t max_resident_patches           = 0,
+                          const int      num_gpus                       = 1,
+                          const bool     compact                        = false)
+        : RXMesh(patch_size, max_resident_patches, num_gpus),
+          m_input_vertex_coordinates(nullptr)
+    {
+        m_compact = compact;
+        this->init(fv,
+                   patcher_file,
+                   capacity_factor,
+                   patch_alloc_factor,
+                   lp_hashtable_load_factor,
+                   num_threads);
+        m_attr_container = std::make_shared<AttributeContainer>();
+
+        if (!vertices.empty()) {
+            add_vertex_coordinates(vertices);
+        }
+    };
+
+    /**
+     * @brief Constructor using triangles that live on the device. The
+     * mesh edges and face adjacency are built on the device while the patches
+     * (ltog, ribbons, LP hashtables, and PatchInfo) are built on the host,
+     * i.e., this is not a device-resident build (see
+     * RXMesh::build_with_device_adjacency). Vertex
+     * coordinates can be added later with add_vertex_coordinates
+     * @param d_fv device pointer to the face indices stored as 3 * num_faces
+     * contiguous vertex ids
+     * @param num_faces number of faces in d_fv
+     * @param compact exact per-patch allocation (see the constructor that
+     * takes a file path)
+     */
+    explicit RXMeshStatic(const uint32_t*   d_fv,
+                          const uint32_t    num_faces,
+                          const std::string patcher_file             = "",
+                          const uint32_t    patch_size               = 512,
+                          const float       capacity_factor          = 1.0,
+                          const float       patch_alloc_factor       = 1.0,
+                          const float       lp_hashtable_load_factor = 0.8,
+                          const int         num_threads              = -1,
+                          const bool        compact                  = false)
+        : RXMesh(patch_size), m_input_vertex_coordinates(nullptr)
+    {
+        m_compact = compact;
+        this->init(d_fv,
+                   num_faces,
+                   patcher_file,
+                   capacity_factor,
+                   patch_alloc_factor,
+                   lp_hashtable_load_factor,
+                   num_threads);
         m_attr_container = std::make_shared<AttributeContainer>();
     };
 
@@ -110,23 +257,99 @@ class RXMeshStatic : public RXMesh
             m_input_vertex_coordinates =
                 this->add_vertex_attribute<float>(vertices, "rx:vertices");
 
-#if USE_POLYSCOPE
-            // polyscope::options::autocenterStructures = true;
-            // polyscope::options::autoscaleStructures  = true;
-            // polyscope::options::automaticallyComputeSceneExtents = true;
-            polyscope::init();
-            m_polyscope_mesh_name = mesh_name.empty() ? "RXMesh" : mesh_name;
-            m_polyscope_mesh_name += std::to_string(rand());
-            this->register_polyscope();
-            render_vertex_patch();
-            render_edge_patch();
-            render_face_patch();
-#endif
+            init_polyscope(mesh_name);
+        }
+    }
+
+    /**
+     * @brief Add vertex coordinates to the input mesh from a flat buffer where
+     * the coordinates of vertex v are vertices[3 * v], vertices[3 * v + 1],
+     * and vertices[3 * v + 2] (as read by import_mesh)
+     */
+    void add_vertex_coordinates(const std::vector<float>& vertices,
+                                std::string               mesh_name = "")
+    {
+        if (m_input_vertex_coordinates == nullptr) {
+
+            if (vertices.size() != 3 * size_t(get_num_vertices())) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::add_vertex_coordinates() input size ({}) is "
+                    "not three times the number of vertices in the input mesh "
+                    "({})",
+                    vertices.size(),
+                    get_num_vertices());
+                return;
+            }
+
+            m_input_vertex_coordinates =
+                this->add_vertex_attribute<float>("rx:vertices", 3);
+
+            const int num_patches = this->get_num_patches();
+#pragma omp parallel for
+            for (int p = 0; p < num_patches; ++p) {
+                for (uint16_t v = 0; v < this->m_h_num_owned_v[p]; ++v) {
+                    const VertexHandle v_handle(static_cast<uint32_t>(p), v);
+
+                    const uint32_t global_v = m_h_patches_ltog_v[p][v];
+
+                    for (uint32_t a = 0; a < 3; ++a) {
+                        (*m_input_vertex_coordinates)(v_handle, a) =
+                            vertices[3 * size_t(global_v) + a];
+                    }
+                }
+            }
+            m_input_vertex_coordinates->move(rxmesh::HOST, rxmesh::DEVICE);
+
+            init_polyscope(mesh_name);
         }
     }
 
     virtual ~RXMeshStatic()
     {
+        release_query_cache();
+        GPU_FREE(m_d_query_cache);
+    }
+
+    /**
+     * @brief save a binary snapshot of the mesh (patches, topology, hash
+     * tables, and the input vertex coordinates if they exist) that can be
+     * loaded by passing the file path to the constructor. Loading the cache
+     * skips reading the input mesh, patching, and building the patches
+     * topology and hash tables. The cache depends on the library's PatchInfo
+     * layout and should be re-generated if the library is updated
+     * @param filename output file
+     */
+    void save_cache(const std::string filename)
+    {
+        std::vector<float> vertices;
+
+        if (m_input_vertex_coordinates) {
+            if (!m_input_vertex_coordinates->is_host_allocated()) {
+                RXMESH_WARN(
+                    "RXMeshStatic::save_cache() input vertex coordinates are "
+                    "not allocated on the host and so they will not be stored "
+                    "in the cache");
+            } else {
+                vertices.resize(3 * size_t(get_num_vertices()));
+                const int num_patches = this->get_num_patches();
+#pragma omp parallel for
+                for (int p = 0; p < num_patches; ++p) {
+                    for (uint16_t v = 0; v < this->m_h_num_owned_v[p]; ++v) {
+                        const VertexHandle v_handle(static_cast<uint32_t>(p),
+                                                    v);
+
+                        uint32_t global_v = m_h_patches_ltog_v[p][v];
+
+                        for (uint32_t a = 0; a < 3; ++a) {
+                            vertices[3 * size_t(global_v) + a] =
+                                (*m_input_vertex_coordinates)(v_handle, a);
+                        }
+                    }
+                }
+            }
+        }
+
+        this->write_cache(filename, vertices);
     }
 
 #if USE_POLYSCOPE
@@ -478,10 +701,15 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_vertex<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int       threads = 256;
+                InstrumentScope scope(
+                    "RXMeshStatic::for_each_vertex", stream, get_num_patches());
+                run_over_patches(
+                    stream,
+                    [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                        detail::for_each_vertex<<<count, threads, 0, s>>>(
+                            count, this->m_d_patches_info + begin, apply);
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_vertex() Input lambda function "
@@ -540,10 +768,15 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_edge<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int       threads = 256;
+                InstrumentScope scope(
+                    "RXMeshStatic::for_each_edge", stream, get_num_patches());
+                run_over_patches(
+                    stream,
+                    [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                        detail::for_each_edge<<<count, threads, 0, s>>>(
+                            count, this->m_d_patches_info + begin, apply);
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_edge() Input lambda function "
@@ -601,10 +834,15 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_face<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int       threads = 256;
+                InstrumentScope scope(
+                    "RXMeshStatic::for_each_face", stream, get_num_patches());
+                run_over_patches(
+                    stream,
+                    [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                        detail::for_each_face<<<count, threads, 0, s>>>(
+                            count, this->m_d_patches_info + begin, apply);
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_face() Input lambda function "
@@ -615,6 +853,300 @@ class RXMeshStatic : public RXMesh
     }
 
 
+    /**
+     * @brief launch a query kernel that takes the Context as its first
+     * parameter over all patches. In streaming mode, the kernel is launched in
+     * waves (see PatchResidency) and in multi-GPU mode, every GPU launches the
+     * kernel over its own patches (see PatchPartition). So the kernel should
+     * use Context::get_block_patch_id() (as Query does) instead of blockIdx.x
+     * to get the patch id
+     * @param launch_box launch box populated by prepare_launch_box
+     * @param kernel the kernel to be launched
+     * @param stream the stream used to launch the kernel
+     * @param args the kernel parameters after the Context
+     */
+    template <uint32_t    blockThreads,
+              QueryEngine queryEngine,
+              typename KernelT,
+              typename... ArgsT>
+    void run_query_kernel(
+        const LaunchBox<blockThreads, queryEngine>& launch_box,
+        KernelT                                     kernel,
+        cudaStream_t                                stream,
+        ArgsT... args) const
+    {
+        InstrumentScope scope((const void*)kernel, stream, launch_box.blocks);
+        run_over_patches(
+            stream, [&](uint32_t begin, uint32_t count, cudaStream_t s) {
+                Context context        = get_context();
+                context.m_patch_offset = begin;
+                context.m_counters     = Instrumentation::get().get_counters();
+                kernel<<<count,
+                         launch_box.num_threads,
+                         launch_box.smem_bytes_dyn,
+                         s>>>(context, args...);
+            });
+    }
+
+    /**
+     * @brief allocate an empty frontier of vertices, edges, or faces (see
+     * Frontier) that can hold any element of this mesh. The caller owns the
+     * frontier and should call Frontier::free() when it is no longer needed
+     */
+    template <typename HandleT>
+    Frontier<HandleT> create_frontier() const
+    {
+        if (this->is_streaming() || this->is_multi_gpu()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::create_frontier() frontiers are not supported "
+                "in streaming or multi-GPU modes");
+        }
+
+        uint32_t max_elements = 0;
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            max_elements = this->get_per_patch_max_vertex_capacity();
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            max_elements = this->get_per_patch_max_edge_capacity();
+        }
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            max_elements = this->get_per_patch_max_face_capacity();
+        }
+
+        Frontier<HandleT> frontier;
+        frontier.init(this->get_max_num_patches(), max_elements);
+        return frontier;
+    }
+
+    /**
+     * @brief apply a lambda function on the owned elements in the current
+     * frontier. The kernel is launched with one block per patch in the
+     * frontier. The lambda function may add elements to the next frontier
+     * (see Frontier::add)
+     * @param frontier the frontier
+     * @param apply lambda function to be applied on the elements of the
+     * frontier. The lambda function signature takes a handle of the frontier
+     * element type
+     * @param stream the stream used to run the kernel
+     */
+    template <typename HandleT, typename LambdaT>
+    void for_each_frontier(const Frontier<HandleT>& frontier,
+                           LambdaT                  apply,
+                           cudaStream_t             stream = NULL) const
+    {
+        if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+            if (frontier.is_empty()) {
+                return;
+            }
+            const int       threads = 256;
+            InstrumentScope scope(
+                "RXMeshStatic::for_each_frontier", stream, frontier.size());
+            detail::for_each_frontier<<<frontier.size(), threads, 0, stream>>>(
+                this->m_d_patches_info, frontier, apply);
+        } else {
+            RXMESH_ERROR(
+                "RXMeshStatic::for_each_frontier() Input lambda function "
+                "should be annotated with  __device__ for execution on "
+                "device");
+        }
+    }
+
+    /**
+     * @brief launch a query kernel (see run_query_kernel) only over the
+     * patches of the current frontier i.e., with one block per patch in the
+     * frontier where Context::get_block_patch_id() returns the frontier
+     * patch. The kernel should test the elements against the frontier (e.g.,
+     * by passing Frontier::is_active as the active set of the query) and may
+     * add elements to the next frontier
+     * @param launch_box launch box populated by prepare_launch_box
+     * @param frontier the frontier
+     * @param kernel the kernel to be launched
+     * @param stream the stream used to launch the kernel
+     * @param args the kernel parameters after the Context
+     */
+    template <uint32_t    blockThreads,
+              QueryEngine queryEngine,
+              typename HandleT,
+              typename KernelT,
+              typename... ArgsT>
+    void run_query_kernel_frontier(
+        const LaunchBox<blockThreads, queryEngine>& launch_box,
+        const Frontier<HandleT>&                    frontier,
+        KernelT                                     kernel,
+        cudaStream_t                                stream,
+        ArgsT... args) const
+    {
+        if (frontier.is_empty()) {
+            return;
+        }
+        InstrumentScope scope((const void*)kernel, stream, frontier.size());
+
+        Context context        = get_context();
+        context.m_patch_list = frontier.get_patch_list();
+        context.m_counters   = Instrumentation::get().get_counters();
+        kernel<<<frontier.size(),
+                 launch_box.num_threads,
+                 launch_box.smem_bytes_dyn,
+                 stream>>>(context, args...);
+    }
+
+    /**
+     * @brief record the kernels launched by fn(stream) (e.g., for_each with
+     * DEVICE, run_query_kernel, and ReduceHandle::*_on_device) into a CUDA
+     * graph that can be replayed with CUDAGraph::launch. All the kernels
+     * should be launched on the stream passed to fn. Kernels of a streamed
+     * mesh can not be captured since the patches to be moved in/out of the
+     * device are decided on the host (see PatchResidency)
+     * @param graph the graph to capture into (see CUDAGraph::capture)
+     * @param fn fn(stream) launches the kernels to be captured on stream
+     * @param stream the stream to capture on
+     */
+    template <typename FuncT>
+    void capture_graph(CUDAGraph&   graph,
+                       FuncT        fn,
+                       cudaStream_t stream = NULL) const
+    {
+        if (this->is_streaming()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::capture_graph() kernels can not be captured "
+                "when the mesh is streamed");
+            return;
+        }
+        graph.capture(fn, stream);
+    }
+
+    /**
+     * @brief materialize the output of the query op over all patches in
+     * global memory (in the same compact format the query produces in shared
+     * memory) such that every subsequent Query::dispatch/prologue of this op
+     * and orientation reads the cache instead of running the query. This
+     * trades memory for skipping the query (e.g., the transpose done by VV
+     * and VF) in iterative applications that run the same query many times.
+     * The cache is only valid as long as the topology does not change. With
+     * RXMeshDynamic, the cache is released by cleanup() and update_host()
+     * once patches have changed and by slice_patches(). Thus, the query
+     * should be cached again after these calls (and should not be read by
+     * the kernels that change the topology). If the cached queries exceed
+     * the budget (see set_query_cache_budget()), the least recently used ones
+     * are evicted where calling this function on a cached query only marks it
+     * as used. So an application could call it before every kernel launch
+     * @param op the query operation
+     * @param oriented if the query is oriented
+     * @param stream the stream used to build the cache
+     * @return true if the query is cached
+     */
+    template <uint32_t blockThreads = 256>
+    bool cache_query(const Op     op,
+                     const bool   oriented = false,
+                     cudaStream_t stream   = NULL)
+    {
+        if (this->is_streaming() || this->is_multi_gpu()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::cache_query() the query cache is not supported "
+                "in streaming or multi-GPU modes");
+            return false;
+        }
+
+        const int slot = detail::query_cache_slot(op, oriented);
+        if (m_query_cache[slot].is_valid()) {
+            m_query_cache_last_use[slot] = ++m_query_cache_clock;
+            return true;
+        }
+
+        switch (op) {
+            case Op::VV:
+                return build_query_cache<blockThreads, Op::VV>(oriented,
+                                                               stream);
+            case Op::VE:
+                return build_query_cache<blockThreads, Op::VE>(oriented,
+                                                               stream);
+            case Op::VF:
+                return build_query_cache<blockThreads, Op::VF>(oriented,
+                                                               stream);
+            case Op::FV:
+                return build_query_cache<blockThreads, Op::FV>(oriented,
+                                                               stream);
+            case Op::FE:
+                return build_query_cache<blockThreads, Op::FE>(oriented,
+                                                               stream);
+            case Op::FF:
+                return build_query_cache<blockThreads, Op::FF>(oriented,
+                                                               stream);
+            case Op::EV:
+                return build_query_cache<blockThreads, Op::EV>(oriented,
+                                                               stream);
+            case Op::EE:
+                return build_query_cache<blockThreads, Op::EE>(oriented,
+                                                               stream);
+            case Op::EF:
+                return build_query_cache<blockThreads, Op::EF>(oriented,
+                                                               stream);
+            case Op::EVDiamond:
+                return build_query_cache<blockThreads, Op::EVDiamond>(
+                    oriented, stream);
+            default:
+                RXMESH_ERROR(
+                    "RXMeshStatic::cache_query() can not cache query {}",
+                    op_to_string(op));
+                return false;
+        }
+    }
+
+    /**
+     * @brief free the cached output of the query op (see cache_query()) such
+     * that later queries are computed in shared memory again
+     */
+    void release_query_cache(const Op op, const bool oriented = false)
+    {
+        release_query_cache_slot(detail::query_cache_slot(op, oriented));
+    }
+
+    /**
+     * @brief free the cached output of all queries (see cache_query())
+     */
+    void release_query_cache()
+    {
+        for (int slot = 0; slot < detail::num_query_cache_slots; ++slot) {
+            release_query_cache_slot(slot);
+        }
+    }
+
+    /**
+     * @brief check if the output of the query op is cached
+     */
+    bool is_query_cached(const Op op, const bool oriented = false) const
+    {
+        return m_query_cache[detail::query_cache_slot(op, oriented)]
+            .is_valid();
+    }
+
+    /**
+     * @brief set the maximum device memory (in bytes) used by the query cache.
+     * Cached queries are evicted (least recently used first) until the cache
+     * fits in the new budget
+     */
+    void set_query_cache_budget(const size_t num_bytes)
+    {
+        m_query_cache_budget = num_bytes;
+        evict_query_cache(m_query_cache_budget);
+    }
+
+    /**
+     * @brief the maximum device memory (in bytes) used by the query cache
+     */
+    size_t get_query_cache_budget() const
+    {
+        return m_query_cache_budget;
+    }
+
+    /**
+     * @brief the device memory (in bytes) currently used by the query cache
+     */
+    size_t get_query_cache_bytes() const
+    {
+        return m_query_cache_bytes;
+    }
+
     /**
      * @brief same as for_each_vertex/edge/face where the type is defined via
      * template parameter
@@ -623,7 +1155,7 @@ class RXMeshStatic : public RXMesh
     void for_each(locationT    location,
                   LambdaT      apply,
                   cudaStream_t stream   = NULL,
-                  bool         with_omp = true)
+                  bool         with_omp = true) const
     {
         if constexpr (std::is_same_v<HandleT, VertexHandle>) {
             for_each_vertex(location, apply, stream, with_omp);
@@ -640,7 +1172,9 @@ class RXMeshStatic : public RXMesh
 
     /**
      * @brief populate the launch_box with grid size and dynamic shared memory
-     * needed for kernel launch
+     * needed for kernel launch. The shared memory of the transpose queries
+     * depends on the engine of the launch box (see QueryEngine) which should
+     * be the same as the engine of the Query used by the kernel
      * @param op List of query operations done inside this the kernel
      * @param launch_box input launch box to be populated
      * @param kernel The kernel to be launched
@@ -654,14 +1188,14 @@ class RXMeshStatic : public RXMesh
      * edges, and faces and returns additional user-desired shared memory in
      * bytes
      */
-    template <uint32_t blockThreads>
+    template <uint32_t blockThreads, QueryEngine queryEngine>
     void prepare_launch_box(
-        const std::vector<Op>    op,
-        LaunchBox<blockThreads>& launch_box,
-        const void*              kernel,
-        const bool               oriented            = false,
-        const bool               with_vertex_valence = false,
-        const bool               is_concurrent       = false,
+        const std::vector<Op>                 op,
+        LaunchBox<blockThreads, queryEngine>& launch_box,
+        const void*                           kernel,
+        const bool                            oriented            = false,
+        const bool                            with_vertex_valence = false,
+        const bool                            is_concurrent       = false,
         std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
             [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
     {
@@ -670,8 +1204,8 @@ class RXMeshStatic : public RXMesh
         launch_box.smem_bytes_dyn = 0;
 
         for (auto o : op) {
-            size_t sh =
-                this->template calc_shared_memory<blockThreads>(o, oriented);
+            size_t sh = this->template calc_shared_memory<blockThreads>(
+                o, oriented, queryEngine);
             if (is_concurrent) {
                 launch_box.smem_bytes_dyn += sh;
             } else {
@@ -704,11 +1238,285 @@ class RXMeshStatic : public RXMesh
             blockThreads);
 
 
-        check_shared_memory(launch_box.smem_bytes_dyn,
-                            launch_box.smem_bytes_static,
-                            launch_box.num_registers_per_thread,
-                            blockThreads,
-                            kernel);
+        launch_box.num_blocks_per_sm =
+            check_shared_memory(launch_box.smem_bytes_dyn,
+                                launch_box.smem_bytes_static,
+                                launch_box.num_registers_per_thread,
+                                blockThreads,
+                                kernel,
+                                true,
+                                launch_box.exit_on_failure);
+    }
+
+    /**
+     * @brief populate the launch_box with grid size and dynamic shared memory
+     * needed for a kernel that runs a chain of queries (see
+     * Query::dispatch_chain). Since stages run one after the other, the
+     * shared memory of the queries is the max over all stages. The owned
+     * bitmask and LP hashtable of the output of every query, along with EV
+     * and FE of the patch, are loaded once and live for the whole chain and so
+     * they are added on top
+     * @param op List of query operations in the chain (in any order)
+     * @param launch_box input launch box to be populated
+     * @param kernel The kernel to be launched
+     * @param oriented if the query is oriented. Valid only for Op::VV and
+     * Op::VE queries
+     * @param with_vertex_valence if vertex valence is requested to be
+     * pre-computed and stored in shared memory
+     * @param user_shmem a (lambda) function that takes the number of vertices,
+     * edges, and faces and returns additional user-desired shared memory in
+     * bytes e.g., to pass per-element values between stages
+     */
+    template <uint32_t blockThreads>
+    void prepare_launch_box_chain(
+        const std::vector<Op>    op,
+        LaunchBox<blockThreads>& launch_box,
+        const void*              kernel,
+        const bool               oriented            = false,
+        const bool               with_vertex_valence = false,
+        std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
+            [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
+    {
+        bool is_cached[3] = {false, false, false};
+        for (auto o : op) {
+            const int id = detail::query_output_id(o);
+            if (id >= 0) {
+                is_cached[id] = true;
+            }
+        }
+
+        size_t cache_smem = 0;
+        if (is_cached[0]) {
+            cache_smem +=
+                max_bitmask_size<LocalVertexT>() +
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalVertexT>();
+        }
+        if (is_cached[1]) {
+            cache_smem +=
+                max_bitmask_size<LocalEdgeT>() +
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalEdgeT>();
+        }
+        if (is_cached[2]) {
+            cache_smem +=
+                max_bitmask_size<LocalFaceT>() +
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalFaceT>();
+        }
+        // for possible padding for alignment
+        // 2 calls for ShmemAllocator.alloc per cached element type
+        cache_smem += 2 * 3 * ShmemAllocator::default_alignment;
+
+        // EV and FE are cached if there is any query in the chain
+        if (!op.empty()) {
+            const size_t edge_cap = this->get_per_patch_max_edge_capacity();
+            const size_t face_cap = this->get_per_patch_max_face_capacity();
+            cache_smem += (2 * edge_cap + 3 * face_cap) * sizeof(uint16_t) +
+                          2 * ShmemAllocator::default_alignment;
+        }
+
+        prepare_launch_box(op,
+                           launch_box,
+                           kernel,
+                           oriented,
+                           with_vertex_valence,
+                           false,
+                           [&](uint32_t v, uint32_t e, uint32_t f) {
+                               return cache_smem + user_shmem(v, e, f);
+                           });
+    }
+
+    /**
+     * @brief populate the launch_box with grid size and dynamic shared memory
+     * needed for a kernel that runs a k-ring query (see
+     * Query::dispatch_k_ring). The rings are expanded using the VV query
+     * cache which is built here if it is not cached already. Since the cache
+     * may be evicted (see set_query_cache_budget) or released (e.g., by
+     * RXMeshDynamic::cleanup) before the kernel is launched, the kernel
+     * should be launched with run_k_ring_kernel() which caches VV again if
+     * needed. Every thread stores the k-ring of one vertex with at most
+     * capacity vertices in shared memory
+     * @param k the number of rings
+     * @param capacity the maximum number of vertices in the k-ring of a vertex
+     * @param launch_box input launch box to be populated
+     * @param kernel The kernel to be launched
+     * @param stream the stream used to build the VV query cache
+     * @param user_shmem a (lambda) function that takes the number of vertices,
+     * edges, and faces and returns additional user-desired shared memory in
+     * bytes
+     */
+    template <uint32_t blockThreads>
+    void prepare_launch_box_k_ring(
+        const uint16_t           k,
+        const uint16_t           capacity,
+        LaunchBox<blockThreads>& launch_box,
+        const void*              kernel,
+        cudaStream_t             stream = NULL,
+        std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
+            [](uint32_t v, uint32_t e, uint32_t f) { return 0; })
+    {
+        if (k == 0 || capacity == 0) {
+            RXMESH_ERROR(
+                "RXMeshStatic::prepare_launch_box_k_ring() k and capacity "
+                "should be greater than zero");
+        }
+
+        if (!cache_query<blockThreads>(Op::VV, false, stream)) {
+            RXMESH_ERROR(
+                "RXMeshStatic::prepare_launch_box_k_ring() can not cache the "
+                "VV query which is needed for k-ring queries");
+        }
+
+        launch_box.blocks = this->m_num_patches;
+
+        // 2 calls for ShmemAllocator.alloc (the rings and their ends)
+        launch_box.smem_bytes_dyn =
+            blockThreads *
+                (capacity * sizeof(VertexHandle) + k * sizeof(uint16_t)) +
+            2 * ShmemAllocator::default_alignment;
+
+        launch_box.smem_bytes_dyn += user_shmem(m_max_vertices_per_patch,
+                                                m_max_edges_per_patch,
+                                                m_max_faces_per_patch);
+
+        RXMESH_TRACE(
+            "RXMeshStatic::prepare_launch_box_k_ring() launching {} blocks "
+            "with {} threads on the device for {}-ring queries with capacity "
+            "{}",
+            launch_box.blocks,
+            blockThreads,
+            k,
+            capacity);
+
+        launch_box.num_blocks_per_sm =
+            check_shared_memory(launch_box.smem_bytes_dyn,
+                                launch_box.smem_bytes_static,
+                                launch_box.num_registers_per_thread,
+                                blockThreads,
+                                kernel,
+                                true,
+                                launch_box.exit_on_failure);
+    }
+
+    /**
+     * @brief launch a k-ring query kernel (see Query::dispatch_k_ring) with
+     * run_query_kernel() after making sure that the VV query is cached since
+     * the rings are expanded by reading the cache. If the cache has been
+     * evicted or released since prepare_launch_box_k_ring(), it is built
+     * again on the stream. If VV can not be cached, the kernel is not
+     * launched
+     * @param launch_box launch box populated by prepare_launch_box_k_ring
+     * @param kernel the kernel to be launched
+     * @param stream the stream used to cache VV and launch the kernel
+     * @param args the kernel parameters after the Context
+     * @return true if the kernel is launched
+     */
+    template <uint32_t    blockThreads,
+              QueryEngine queryEngine,
+              typename KernelT,
+              typename... ArgsT>
+    bool run_k_ring_kernel(
+        const LaunchBox<blockThreads, queryEngine>& launch_box,
+        KernelT                                     kernel,
+        cudaStream_t                                stream,
+        ArgsT... args)
+    {
+        if (!cache_query<blockThreads>(Op::VV, false, stream)) {
+            RXMESH_ERROR(
+                "RXMeshStatic::run_k_ring_kernel() can not cache the VV query "
+                "which is needed for k-ring queries. The kernel is not "
+                "launched");
+            return false;
+        }
+        run_query_kernel(launch_box, kernel, stream, args...);
+        return true;
+    }
+
+    /**
+     * @brief check if the queries specialized for a compile-time maximum
+     * valence (see Query::dispatch_bounded) can be used on this mesh i.e., if
+     * no vertex has more than max_valence incident edges and, for oriented
+     * queries, if the mesh is edge manifold. This is based on the input
+     * mesh and so, for a dynamic mesh, it should only be used if the
+     * updates do not increase the valence beyond max_valence
+     * @param max_valence the maximum valence of the specialized query
+     * @param oriented if the specialized query is oriented
+     */
+    bool is_valence_bounded(const uint32_t max_valence,
+                            const bool     oriented = false) const
+    {
+        return get_input_max_valence() <= max_valence &&
+               (!oriented || m_is_input_edge_manifold);
+    }
+
+    /**
+     * @brief populate the launch_box with grid size and dynamic shared memory
+     * needed for a kernel that runs queries specialized for a maximum valence
+     * (see Query::dispatch_bounded). Instead of the transpose and offsets of
+     * the general queries, every vertex gets a row of max_valence entries
+     * @param op List of query operations (Op::VV or Op::VE) done inside this
+     * the kernel. They are assumed to not be accessed at the same time
+     * @param max_valence the maximum valence of the specialized query (should
+     * match what the kernel is compiled with)
+     * @param launch_box input launch box to be populated
+     * @param kernel The kernel to be launched
+     * @param oriented if the query is oriented
+     * @param user_shmem a (lambda) function that takes the number of vertices,
+     * edges, and faces and returns additional user-desired shared memory in
+     * bytes
+     */
+    template <uint32_t blockThreads>
+    void prepare_launch_box_bounded(
+        const std::vector<Op>    op,
+        const uint32_t           max_valence,
+        LaunchBox<blockThreads>& launch_box,
+        const void*              kernel,
+        const bool               oriented = false,
+        std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
+            [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
+    {
+        if (!is_valence_bounded(max_valence, oriented)) {
+            RXMESH_ERROR(
+                "RXMeshStatic::prepare_launch_box_bounded() the input max "
+                "valence ({}) is greater than {} or the mesh is not edge "
+                "manifold for oriented queries. The general queries should be "
+                "used instead",
+                get_input_max_valence(),
+                max_valence);
+        }
+
+        launch_box.blocks         = this->m_num_patches;
+        launch_box.smem_bytes_dyn = 0;
+
+        for (auto o : op) {
+            if (o != Op::VV && o != Op::VE) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::prepare_launch_box_bounded() only Op::VV "
+                    "and Op::VE are supported. The input op is {}",
+                    op_to_string(o));
+            }
+            launch_box.smem_bytes_dyn =
+                std::max(launch_box.smem_bytes_dyn,
+                         calc_bounded_shared_memory(o, max_valence, oriented));
+        }
+
+        launch_box.smem_bytes_dyn += user_shmem(m_max_vertices_per_patch,
+                                                m_max_edges_per_patch,
+                                                m_max_faces_per_patch);
+
+        RXMESH_TRACE(
+            "RXMeshStatic::prepare_launch_box_bounded() launching {} blocks "
+            "with {} threads on the device for max valence {}",
+            launch_box.blocks,
+            blockThreads,
+            max_valence);
+
+        launch_box.num_blocks_per_sm =
+            check_shared_memory(launch_box.smem_bytes_dyn,
+                                launch_box.smem_bytes_static,
+                                launch_box.num_registers_per_thread,
+                                blockThreads,
+                                kernel,
+                                true,
+                                launch_box.exit_on_failure);
     }
 
 
@@ -719,7 +1527,7 @@ class RXMeshStatic : public RXMesh
      * names
      * @param num_attributes number of the attributes
      * @param location where to allocate the attributes
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -742,7 +1550,7 @@ class RXMeshStatic : public RXMesh
      * @tparam T type of the attribute
      * @param name of the attribute. Should not collide with other attributes
      * names
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -799,7 +1607,7 @@ class RXMeshStatic : public RXMesh
      * @tparam T type of the attribute
      * @param name of the attribute. Should not collide with other attributes
      * names
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -853,7 +1661,7 @@ class RXMeshStatic : public RXMesh
      * names
      * @param num_attributes number of the attributes
      * @param location where to allocate the attributes
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -875,7 +1683,7 @@ class RXMeshStatic : public RXMesh
      * names
      * @param num_attributes number of the attributes
      * @param location where to allocate the attributes
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -899,7 +1707,7 @@ class RXMeshStatic : public RXMesh
      * @param v_attributes attributes to read
      * @param name of the attribute. Should not collide with other attributes
      * names
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -959,7 +1767,7 @@ class RXMeshStatic : public RXMesh
      * @param v_attributes attributes to read
      * @param name of the attribute. Should not collide with other attributes
      * names
-     * @param layout as SoA or AoS
+     * @param layout as SoA, AoS, or AoSPadded
      * operations
      * @return shared pointer to the created attribute
      */
@@ -1103,9 +1911,10 @@ class RXMeshStatic : public RXMesh
                        ShmemAllocator::default_alignment;
             });
 
-        detail::identify_boundary_vertices<blockThreads>
-            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
-                get_context(), boundary_v);
+        run_query_kernel(lb,
+                         detail::identify_boundary_vertices<blockThreads, T>,
+                         stream,
+                         boundary_v);
 
         if (move_to_host && boundary_v.is_host_allocated()) {
             boundary_v.move(DEVICE, HOST, stream);
@@ -1294,7 +2103,8 @@ class RXMeshStatic : public RXMesh
     }
 
     /**
-     * @brief Export the mesh to obj file
+     * @brief Export the mesh to obj file. This goes through the host side of
+     * the mesh (see MeshWriter to write large meshes from the device)
      * @tparam T type of vertices coordinates
      * @param filename the output file
      * @param coords vertices coordinates
@@ -1445,6 +2255,188 @@ class RXMeshStatic : public RXMesh
     }
 
    protected:
+    /**
+     * @brief count, allocate, and fill the output of the query op in the
+     * query cache (see cache_query())
+     */
+    template <uint32_t blockThreads, Op op>
+    bool build_query_cache(const bool oriented, cudaStream_t stream)
+    {
+        const int      slot        = detail::query_cache_slot(op, oriented);
+        const uint32_t num_patches = this->m_num_patches;
+
+        uint32_t* d_count = nullptr;
+        CUDA_ERROR(cudaMalloc((void**)&d_count,
+                              2 * num_patches * sizeof(uint32_t)));
+
+        LaunchBox<blockThreads> lb_count;
+        prepare_launch_box({op},
+                           lb_count,
+                           (void*)detail::query_cache_count<blockThreads, op>,
+                           oriented);
+        run_query_kernel(lb_count,
+                         detail::query_cache_count<blockThreads, op>,
+                         stream,
+                         oriented,
+                         d_count,
+                         d_count + num_patches);
+
+        std::vector<uint32_t> h_count(2 * num_patches);
+        CUDA_ERROR(cudaMemcpyAsync(h_count.data(),
+                                   d_count,
+                                   h_count.size() * sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        GPU_FREE(d_count);
+
+        // per-patch start of the offsets followed by per-patch start of the
+        // values
+        std::vector<uint32_t> h_start(2 * (num_patches + 1), 0);
+        uint32_t*             h_offset_start = h_start.data();
+        uint32_t*             h_value_start  = h_start.data() + num_patches + 1;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            h_offset_start[p + 1] = h_offset_start[p] + h_count[p];
+            h_value_start[p + 1] =
+                h_value_start[p] + h_count[num_patches + p];
+        }
+        const size_t num_offset = h_offset_start[num_patches];
+        const size_t num_value  = h_value_start[num_patches];
+
+        detail::QueryCacheEntry entry;
+        entry.num_bytes = h_start.size() * sizeof(uint32_t) +
+                          (num_offset + num_value) * sizeof(uint16_t);
+
+        if (entry.num_bytes > m_query_cache_budget) {
+            RXMESH_WARN(
+                "RXMeshStatic::cache_query() query {} needs {} bytes which "
+                "exceeds the query cache budget ({} bytes). The query will "
+                "not be cached",
+                op_to_string(op),
+                entry.num_bytes,
+                m_query_cache_budget);
+            return false;
+        }
+        evict_query_cache(m_query_cache_budget - entry.num_bytes);
+
+        CUDA_ERROR(cudaMalloc((void**)&entry.d_offset_start,
+                              h_start.size() * sizeof(uint32_t)));
+        entry.d_value_start = entry.d_offset_start + num_patches + 1;
+        CUDA_ERROR(cudaMemcpy(entry.d_offset_start,
+                              h_start.data(),
+                              h_start.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        if (num_offset > 0) {
+            CUDA_ERROR(cudaMalloc((void**)&entry.d_offset,
+                                  num_offset * sizeof(uint16_t)));
+        }
+        // the value is allocated even if empty since it marks the entry as
+        // valid
+        CUDA_ERROR(cudaMalloc((void**)&entry.d_value,
+                              std::max(num_value, size_t(1)) *
+                                  sizeof(uint16_t)));
+
+        LaunchBox<blockThreads> lb_fill;
+        prepare_launch_box({op},
+                           lb_fill,
+                           (void*)detail::query_cache_fill<blockThreads, op>,
+                           oriented);
+        run_query_kernel(lb_fill,
+                         detail::query_cache_fill<blockThreads, op>,
+                         stream,
+                         oriented,
+                         entry);
+
+        set_query_cache_entry(slot, entry, stream);
+        m_query_cache_bytes += entry.num_bytes;
+        m_query_cache_last_use[slot] = ++m_query_cache_clock;
+
+        RXMESH_TRACE(
+            "RXMeshStatic::cache_query() cached query {} in {} bytes ({} "
+            "bytes in total)",
+            op_to_string(op),
+            entry.num_bytes,
+            m_query_cache_bytes);
+        return true;
+    }
+
+    /**
+     * @brief set the query cache entry in the given slot on the host and
+     * device. The device array of the entries is allocated on the first call
+     * and ordered after the work already enqueued on stream
+     */
+    void set_query_cache_entry(const int                      slot,
+                               const detail::QueryCacheEntry& entry,
+                               cudaStream_t                   stream)
+    {
+        if (m_d_query_cache == nullptr) {
+            const size_t num_bytes =
+                detail::num_query_cache_slots * sizeof(detail::QueryCacheEntry);
+            CUDA_ERROR(cudaMalloc((void**)&m_d_query_cache, num_bytes));
+            CUDA_ERROR(cudaMemcpy(m_d_query_cache,
+                                  m_query_cache.data(),
+                                  num_bytes,
+                                  cudaMemcpyHostToDevice));
+            this->m_rxmesh_context.m_query_cache = m_d_query_cache;
+        }
+        m_query_cache[slot] = entry;
+        CUDA_ERROR(cudaMemcpyAsync(m_d_query_cache + slot,
+                                   &m_query_cache[slot],
+                                   sizeof(detail::QueryCacheEntry),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+    }
+
+    /**
+     * @brief invalidate the query cache entry in the given slot on the device
+     * before freeing its memory
+     */
+    void release_query_cache_slot(const int slot)
+    {
+        detail::QueryCacheEntry& entry = m_query_cache[slot];
+        if (!entry.is_valid()) {
+            return;
+        }
+        m_query_cache_bytes -= entry.num_bytes;
+
+        const detail::QueryCacheEntry invalid;
+        CUDA_ERROR(cudaMemcpy(m_d_query_cache + slot,
+                              &invalid,
+                              sizeof(detail::QueryCacheEntry),
+                              cudaMemcpyHostToDevice));
+        GPU_FREE(entry.d_offset_start);
+        GPU_FREE(entry.d_offset);
+        GPU_FREE(entry.d_value);
+        entry = invalid;
+    }
+
+    /**
+     * @brief evict the least recently used cached queries until the query
+     * cache uses at most num_bytes
+     */
+    void evict_query_cache(const size_t num_bytes)
+    {
+        while (m_query_cache_bytes > num_bytes) {
+            int lru = -1;
+            for (int slot = 0; slot < detail::num_query_cache_slots; ++slot) {
+                if (m_query_cache[slot].is_valid() &&
+                    (lru < 0 || m_query_cache_last_use[slot] <
+                                    m_query_cache_last_use[lru])) {
+                    lru = slot;
+                }
+            }
+            if (lru < 0) {
+                break;
+            }
+            RXMESH_TRACE(
+                "RXMeshStatic::evict_query_cache() evicting query {} ({} "
+                "bytes)",
+                op_to_string(Op(lru / 2)),
+                m_query_cache[lru].num_bytes);
+            release_query_cache_slot(lru);
+        }
+    }
+
     template <typename AttributeT>
     void export_vtk(std::fstream&     file,
                     bool&             first_v_attr,
@@ -1521,9 +2513,118 @@ class RXMeshStatic : public RXMesh
         }
     }
 
+    /**
+     * @brief shared memory of Op::VV, Op::VE, and Op::VF with
+     * QueryEngine::Warp. The input (EV and FE) is read from global memory and
+     * only the output is stored i.e., the offsets (#V + 2 since the last entry
+     * is used by the prefix sum) and the values (2*#E for VV and VE and 3*#F
+     * for VF). There is no limit on the number of items per thread
+     */
+    size_t calc_warp_shared_memory(const Op op) const
+    {
+        size_t dynamic_smem =
+            (this->m_max_vertices_per_patch + 2) * sizeof(uint16_t);
+
+        // store participant bitmask
+        dynamic_smem += max_bitmask_size<LocalVertexT>();
+
+        if (op == Op::VV) {
+            dynamic_smem +=
+                (2 * this->m_max_edges_per_patch) * sizeof(uint16_t);
+
+            // store not-owned bitmask
+            dynamic_smem += max_bitmask_size<LocalVertexT>();
+
+            // stores the vertex LP hashtable
+            dynamic_smem +=
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalVertexT>();
+        } else if (op == Op::VE) {
+            dynamic_smem +=
+                (2 * this->m_max_edges_per_patch) * sizeof(uint16_t);
+
+            // store not-owned bitmask
+            dynamic_smem += max_bitmask_size<LocalEdgeT>();
+
+            // stores edge LP hashtable
+            dynamic_smem +=
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalEdgeT>();
+        } else if (op == Op::VF) {
+            dynamic_smem +=
+                (3 * this->m_max_faces_per_patch) * sizeof(uint16_t);
+
+            // store not-owned bitmask
+            dynamic_smem += max_bitmask_size<LocalFaceT>();
+
+            // stores the face LP hashtable
+            dynamic_smem +=
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalFaceT>();
+        }
+
+        // for possible padding for alignment
+        // 5 since there are 5 calls for ShmemAllocator.alloc
+        dynamic_smem += ShmemAllocator::default_alignment * 5;
+
+        return dynamic_smem;
+    }
+
+    /**
+     * @brief shared memory of Op::VV and Op::VE specialized for a maximum
+     * valence (see Query::dispatch_bounded). Every vertex has a row of
+     * max_valence incident edges (or vertices) and their count. Oriented
+     * queries also store FE and EF (3*#F + 2*#E)
+     */
+    size_t calc_bounded_shared_memory(const Op       op,
+                                      const uint32_t max_valence,
+                                      const bool     oriented) const
+    {
+        // the rows and their count
+        size_t dynamic_smem = (max_valence + 1) *
+                              this->m_max_vertices_per_patch *
+                              sizeof(uint16_t);
+
+        // store participant bitmask
+        dynamic_smem += max_bitmask_size<LocalVertexT>();
+
+        if (op == Op::VV) {
+            // store not-owned bitmask
+            dynamic_smem += max_bitmask_size<LocalVertexT>();
+
+            // stores the vertex LP hashtable
+            dynamic_smem +=
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalVertexT>();
+        } else {
+            // store not-owned bitmask
+            dynamic_smem += max_bitmask_size<LocalEdgeT>();
+
+            // stores edge LP hashtable
+            dynamic_smem +=
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalEdgeT>();
+        }
+
+        if (oriented) {
+            dynamic_smem += (3 * this->m_max_faces_per_patch +
+                             2 * this->m_max_edges_per_patch) *
+                            sizeof(uint16_t);
+        }
+
+        // for possible padding for alignment
+        // 7 since there are 7 calls for ShmemAllocator.alloc
+        dynamic_smem += ShmemAllocator::default_alignment * 7;
+
+        return dynamic_smem;
+    }
+
     template <uint32_t blockThreads>
-    size_t calc_shared_memory(const Op op, const bool oriented) const
+    size_t calc_shared_memory(
+        const Op          op,
+        const bool        oriented,
+        const QueryEngine engine = QueryEngine::Block) const
     {
+        if (engine == QueryEngine::Warp && !oriented &&
+            (op == Op::VV || op == Op::VE || op == Op::VF)) {
+            return calc_warp_shared_memory(op);
+        }
+
         // Operations that uses matrix transpose needs a template parameter
         // that is by default TRANSPOSE_ITEM_PER_THREAD. Here we check if
         // this default parameter is valid otherwise, it needs to be increased.
@@ -1861,12 +2962,20 @@ class RXMeshStatic : public RXMesh
         return dynamic_smem;
     }
 
-    void check_shared_memory(const uint32_t smem_bytes_dyn,
-                             size_t&        smem_bytes_static,
-                             uint32_t&      num_reg_per_thread,
-                             const uint32_t num_threads_per_block,
-                             const void*    kernel,
-                             bool           print = true) const
+    /**
+     * @brief check if the kernel can be launched with the given block size and
+     * dynamic shared memory and return its occupancy (number of blocks per
+     * SM). If the kernel can not be launched, the function exits unless
+     * exit_on_failure is false in which case zero is returned (used by
+     * LaunchPlanner to skip such candidates)
+     */
+    uint32_t check_shared_memory(const uint32_t smem_bytes_dyn,
+                                 size_t&        smem_bytes_static,
+                                 uint32_t&      num_reg_per_thread,
+                                 const uint32_t num_threads_per_block,
+                                 const void*    kernel,
+                                 bool           print           = true,
+                                 bool           exit_on_failure = true) const
     {
         // check if total shared memory (static + dynamic) consumed by
         // k_base_query are less than the max shared per block
@@ -1903,7 +3012,21 @@ class RXMeshStatic : public RXMesh
                 float(devProp.sharedMemPerBlock) / 1024.0f);
         }
 
+        if (Instrumentation::get().is_enabled()) {
+            Instrumentation::get().launch_config(
+                Instrumentation::kernel_name(kernel),
+                num_threads_per_block,
+                smem_bytes_dyn,
+                static_cast<uint32_t>(smem_bytes_static),
+                num_reg_per_thread,
+                float(num_blocks_per_sm * num_threads_per_block) /
+                    float(devProp.maxThreadsPerMultiProcessor));
+        }
+
         if (smem_bytes_static + smem_bytes_dyn > devProp.sharedMemPerBlock) {
+            if (!exit_on_failure) {
+                return 0;
+            }
             RXMESH_ERROR(
                 " RXMeshStatic::check_shared_memory() shared memory needed for"
                 " input function ({} bytes) exceeds the max shared memory "
@@ -1914,6 +3037,9 @@ class RXMeshStatic : public RXMesh
         }
 
         if (num_blocks_per_sm == 0) {
+            if (!exit_on_failure) {
+                return 0;
+            }
             RXMESH_ERROR(
                 "RXMeshStatic::check_shared_memory() This kernel will not run "
                 "since it asks for too many resources i.e., shared memory "
@@ -1924,6 +3050,8 @@ class RXMeshStatic : public RXMesh
                 "additional shared memory you requested");
             exit(EXIT_FAILURE);
         }
+
+        return static_cast<uint32_t>(num_blocks_per_sm);
     }
 
 #if USE_POLYSCOPE
@@ -2016,7 +3144,76 @@ class RXMeshStatic : public RXMesh
     EdgeMapT                m_polyscope_edges_map;
 #endif
 
+    /**
+     * @brief launch(begin, count, stream) launches a kernel over the patches
+     * [begin, begin + count) on stream. Usually, this is a single launch over
+     * all patches. If the mesh is streamed, the launch is split into waves and
+     * the patches (and their attributes) are moved in/out of the device
+     * between the waves. If the patches are split over multiple GPUs, every
+     * GPU launches the kernel over its own patches
+     */
+    template <typename LaunchT>
+    void run_over_patches(cudaStream_t stream, LaunchT launch) const
+    {
+        if (this->is_multi_gpu()) {
+            m_partition.run(stream,
+                            [&](const int      gpu,
+                                const uint32_t begin,
+                                const uint32_t count,
+                                cudaStream_t   gpu_stream) {
+                                launch(begin, count, gpu_stream);
+                            });
+            return;
+        }
+
+        if (!this->is_streaming()) {
+            launch(0, this->get_num_patches(), stream);
+            return;
+        }
+
+        m_residency.run(
+            stream,
+            [&](const uint32_t begin, const uint32_t count) {
+                launch(begin, count, stream);
+            },
+            [this](const uint32_t p, const int device, cudaStream_t s) {
+                m_attr_container->prefetch(p, device, s);
+            });
+    }
+
+    /**
+     * @brief register the mesh with polyscope (if it is active) once the input
+     * vertex coordinates are added
+     */
+    void init_polyscope(const std::string& mesh_name)
+    {
+#if USE_POLYSCOPE
+        // polyscope::options::autocenterStructures = true;
+        // polyscope::options::autoscaleStructures  = true;
+        // polyscope::options::automaticallyComputeSceneExtents = true;
+        polyscope::init();
+        m_polyscope_mesh_name = mesh_name.empty() ? "RXMesh" : mesh_name;
+        m_polyscope_mesh_name += std::to_string(rand());
+        this->register_polyscope();
+        render_vertex_patch();
+        render_edge_patch();
+        render_face_patch();
+#endif
+    }
+
     std::shared_ptr<AttributeContainer>     m_attr_container;
     std::shared_ptr<VertexAttribute<float>> m_input_vertex_coordinates;
+
+    // host copy of the query cache entries (see cache_query) and their device
+    // copy that is used by Context
+    std::array<detail::QueryCacheEntry, detail::num_query_cache_slots>
+        m_query_cache;
+    std::array<uint64_t, detail::num_query_cache_slots>
+        m_query_cache_last_use{};
+    uint64_t                 m_query_cache_clock = 0;
+    size_t                   m_query_cache_bytes = 0;
+    size_t                   m_query_cache_budget =
+        std::numeric_limits<size_t>::max();
+    detail::QueryCacheEntry* m_d_query_cache = nullptr;
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -66,13 +66,31 @@ static std::string location_to_string(const locationT location)
 }
 
 /**
- * @brief Memory layout
+ * @brief Flags for the quantities maintained by DerivedAttributes
+ */
+using derivedT = uint32_t;
+enum : derivedT
+{
+    DERIVED_NONE            = 0x00,
+    DERIVED_EDGE_LENGTH     = 0x01,
+    DERIVED_FACE_NORMAL     = 0x02,
+    DERIVED_FACE_AREA       = 0x04,
+    DERIVED_VERTEX_VALENCE  = 0x08,
+    DERIVED_VERTEX_BOUNDARY = 0x10,
+    DERIVED_ALL             = 0x1F,
+};
+
+/**
+ * @brief Memory layout. AoSPadded is AoS where the attributes of every element
+ * are padded to 2, 4, or a multiple of 4 values so that an element could be
+ * read/written with a single vector (e.g., float4) instruction
  */
 using layoutT = uint32_t;
 enum : layoutT
 {
-    AoS = 0x00,
-    SoA = 0x01,
+    AoS       = 0x00,
+    SoA       = 0x01,
+    AoSPadded = 0x02,
 };
 /**
  * @brief convert locationT to string
@@ -84,6 +102,8 @@ static std::string layout_to_string(const layoutT layout)
             return "AoS";
         case SoA:
             return "SoA";
+        case AoSPadded:
+            return "AoSPadded";
         default: {
             RXMESH_ERROR("to_string() unknown layout");
             return "";
@@ -91,6 +111,23 @@ static std::string layout_to_string(const layoutT layout)
     }
 }
 
+/**
+ * @brief the engine used to compute the transpose queries (Op::VV, Op::VE, and
+ * Op::VF) in shared memory. Block loads the input (e.g., EV) in shared memory
+ * and transposes it with block-wide atomics and a fixed number of items per
+ * thread. Warp reads the input from global memory in tiles of 32 non-zeros per
+ * warp and groups the updates of the same output with warp-level primitives
+ * such that only the output lives in shared memory which needs less shared
+ * memory per block and so allows higher occupancy. The engine is selected at
+ * compile time by the Query used in the kernel (along with the matching
+ * LaunchBox) and only used for non-oriented queries
+ */
+enum class QueryEngine
+{
+    Block = 0,
+    Warp  = 1,
+};
+
 /**
  * @brief Various query operations supported in RXMeshStatic
  */
@@ -0,0 +1,1078 @@
+#pragma once
+
+#include <omp.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/mapped_file.h"
+#include "rxmesh/util/util.h"
+
+namespace rxmesh {
+namespace detail {
+
+inline bool is_blank(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skip_blanks(const char* p, const char* end)
+{
+    while (p < end && is_blank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skip_white_spaces(const char* p, const char* end)
+{
+    while (p < end && (is_blank(*p) || *p == '\n')) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skip_token(const char* p, const char* end)
+{
+    while (p < end && !is_blank(*p) && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* next_line(const char* p, const char* end)
+{
+    const char* nl =
+        static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+    return (nl == nullptr) ? end : nl + 1;
+}
+
+/**
+ * @brief parse a signed integer starting at p. Return the pointer after the
+ * last digit or nullptr if there is no integer at p
+ */
+inline const char* parse_integer(const char* p, const char* end, int64_t& out)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return nullptr;
+    }
+    int64_t val = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        val = val * 10 + (*p - '0');
+        ++p;
+    }
+    out = neg ? -val : val;
+    return p;
+}
+
+template <typename T>
+inline T power_of_ten(int e)
+{
+    static constexpr double table[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                       1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                       1e18, 1e19, 1e20, 1e21, 1e22};
+    return static_cast<T>(table[e]);
+}
+
+/**
+ * @brief parse a floating point number starting at p. Numbers whose
+ * mantissa and power of ten are exactly representable in T (which covers most
+ * numbers written by mesh exporters) are computed directly with a single
+ * multiplication/division and are thus correctly rounded. Other numbers (long
+ * mantissa, large exponent, inf, nan) fall back to strtof/strtod. Return the
+ * pointer after the number or nullptr if there is no number at p
+ */
+template <typename T>
+inline const char* parse_real(const char* p, const char* end, T& out)
+{
+    static_assert(std::is_floating_point_v<T>,
+                  "parse_real() only works with floating point types");
+
+    constexpr uint64_t max_mantissa =
+        std::is_same_v<T, float> ? (uint64_t(1) << 24) : (uint64_t(1) << 53);
+    constexpr int max_exp = std::is_same_v<T, float> ? 10 : 22;
+
+    const char* start = p;
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa  = 0;
+    int      digits    = 0;
+    int      exp10     = 0;
+    bool     any       = false;
+    bool     truncated = false;
+
+    auto add_digit = [&](int d, bool is_fraction) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + d;
+            if (mantissa != 0) {
+                ++digits;
+            }
+            if (is_fraction) {
+                --exp10;
+            }
+        } else {
+            truncated = truncated || d != 0;
+            if (!is_fraction) {
+                ++exp10;
+            }
+        }
+    };
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        add_digit(*p - '0', false);
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            add_digit(*p - '0', true);
+            ++p;
+        }
+    }
+
+    bool fast = any && !truncated;
+
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        int64_t     e;
+        const char* q = parse_integer(p + 1, end, e);
+        if (q == nullptr) {
+            fast = false;
+        } else {
+            p = q;
+            if (e > 10000 || e < -10000) {
+                fast = false;
+            } else {
+                exp10 += static_cast<int>(e);
+            }
+        }
+    }
+
+    if (fast && mantissa <= max_mantissa && exp10 >= -max_exp &&
+        exp10 <= max_exp) {
+        T val = static_cast<T>(mantissa);
+        if (exp10 < 0) {
+            val /= power_of_ten<T>(-exp10);
+        } else {
+            val *= power_of_ten<T>(exp10);
+        }
+        out = neg ? -val : val;
+        return p;
+    }
+
+    // fall back to the standard library
+    const char* token_end = skip_token(start, end);
+    std::string token(start, token_end);
+    char*       str_end = nullptr;
+    if constexpr (std::is_same_v<T, float>) {
+        out = std::strtof(token.c_str(), &str_end);
+    } else {
+        out = static_cast<T>(std::strtod(token.c_str(), &str_end));
+    }
+    if (str_end == token.c_str()) {
+        return nullptr;
+    }
+    return start + (str_end - token.c_str());
+}
+
+/**
+ * @brief split [begin, end) into num_chunks chunks where every chunk starts
+ * at the beginning of a line. Return num_chunks + 1 boundaries
+ */
+inline std::vector<const char*> split_lines(const char* begin,
+                                            const char* end,
+                                            int         num_chunks)
+{
+    std::vector<const char*> bound(num_chunks + 1, end);
+    bound[0]                = begin;
+    const size_t chunk_size = size_t(end - begin) / num_chunks;
+    for (int c = 1; c < num_chunks; ++c) {
+        const char* p = std::max(bound[c - 1], begin + c * chunk_size);
+        bound[c]      = (p == begin || p[-1] == '\n') ? p : next_line(p, end);
+    }
+    return bound;
+}
+
+inline int get_import_num_threads(const int num_threads, const size_t size)
+{
+    // small files are not worth the threads
+    constexpr size_t min_chunk = 1 << 20;
+    const int n = (num_threads < 1) ? omp_get_max_threads() : num_threads;
+    return std::max(1, std::min(n, static_cast<int>(size / min_chunk) + 1));
+}
+
+/**
+ * @brief report the line of the first error among the chunks
+ */
+inline void report_import_error(const char*                     func,
+                                const std::string&              file_name,
+                                const char*                     begin,
+                                const std::vector<const char*>& errors)
+{
+    const char* first = nullptr;
+    for (const char* e : errors) {
+        if (e != nullptr && (first == nullptr || e < first)) {
+            first = e;
+        }
+    }
+    if (first != nullptr) {
+        const size_t line = std::count(begin, first, '\n') + 1;
+        RXMESH_ERROR("{} invalid line {} in {}", func, line, file_name);
+    }
+}
+
+/**
+ * @brief check that all face indices are valid vertex ids
+ */
+template <typename IndexT>
+inline bool check_face_indices(const char*                func,
+                               const std::vector<IndexT>& faces,
+                               const size_t               num_vertices,
+                               const int                  num_threads)
+{
+    int64_t bad = -1;
+#pragma omp parallel for num_threads(num_threads) reduction(max : bad)
+    for (int64_t i = 0; i < static_cast<int64_t>(faces.size()); ++i) {
+        if (static_cast<size_t>(faces[i]) >= num_vertices) {
+            bad = std::max(bad, i / 3);
+        }
+    }
+    if (bad >= 0) {
+        RXMESH_ERROR("{} face {} references a vertex out of range "
+                     "(#vertices= {})",
+                     func,
+                     bad,
+                     num_vertices);
+        return false;
+    }
+    return true;
+}
+
+// PLY property types
+enum class PlyType : uint8_t
+{
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64,
+    INVALID
+};
+
+inline PlyType ply_type(const std::string& s)
+{
+    if (s == "char" || s == "int8") {
+        return PlyType::INT8;
+    }
+    if (s == "uchar" || s == "uint8") {
+        return PlyType::UINT8;
+    }
+    if (s == "short" || s == "int16") {
+        return PlyType::INT16;
+    }
+    if (s == "ushort" || s == "uint16") {
+        return PlyType::UINT16;
+    }
+    if (s == "int" || s == "int32") {
+        return PlyType::INT32;
+    }
+    if (s == "uint" || s == "uint32") {
+        return PlyType::UINT32;
+    }
+    if (s == "float" || s == "float32") {
+        return PlyType::FLOAT32;
+    }
+    if (s == "double" || s == "float64") {
+        return PlyType::FLOAT64;
+    }
+    return PlyType::INVALID;
+}
+
+inline uint32_t ply_type_size(const PlyType t)
+{
+    switch (t) {
+        case PlyType::INT8:
+        case PlyType::UINT8:
+            return 1;
+        case PlyType::INT16:
+        case PlyType::UINT16:
+            return 2;
+        case PlyType::INT32:
+        case PlyType::UINT32:
+        case PlyType::FLOAT32:
+            return 4;
+        case PlyType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+template <typename T>
+inline T read_binary(const char* p, const bool swap)
+{
+    T val;
+    if (swap) {
+        char buf[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buf[i] = p[sizeof(T) - 1 - i];
+        }
+        std::memcpy(&val, buf, sizeof(T));
+    } else {
+        std::memcpy(&val, p, sizeof(T));
+    }
+    return val;
+}
+
+inline double read_ply_binary(const char* p, const PlyType t, const bool swap)
+{
+    switch (t) {
+        case PlyType::INT8:
+            return read_binary<int8_t>(p, swap);
+        case PlyType::UINT8:
+            return read_binary<uint8_t>(p, swap);
+        case PlyType::INT16:
+            return read_binary<int16_t>(p, swap);
+        case PlyType::UINT16:
+            return read_binary<uint16_t>(p, swap);
+        case PlyType::INT32:
+            return read_binary<int32_t>(p, swap);
+        case PlyType::UINT32:
+            return read_binary<uint32_t>(p, swap);
+        case PlyType::FLOAT32:
+            return read_binary<float>(p, swap);
+        case PlyType::FLOAT64:
+            return read_binary<double>(p, swap);
+        default:
+            return 0;
+    }
+}
+
+struct PlyProperty
+{
+    std::string name;
+    PlyType     type       = PlyType::INVALID;
+    bool        is_list    = false;
+    PlyType     count_type = PlyType::INVALID;
+};
+
+struct PlyElement
+{
+    std::string              name;
+    uint64_t                 count = 0;
+    std::vector<PlyProperty> props;
+};
+}  // namespace detail
+}  // namespace rxmesh
+
+/**
+ * @brief Read a triangle mesh from an obj file into flat buffers. The file is
+ * memory-mapped and parsed in parallel chunks (of lines). Polygons are
+ * triangulated as a fan. Only vertex positions and faces are read; other
+ * statements (texture, normals, groups, materials, etc) are skipped
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the obj file
+ * @param vertices output vertex coordinates (3 * #vertices)
+ * @param faces output face indices (3 * #faces)
+ * @param num_threads number of threads. Less than one means OpenMP default
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh_obj(const std::string    file_name,
+                     std::vector<DataT>&  vertices,
+                     std::vector<IndexT>& faces,
+                     const int            num_threads = -1)
+{
+    using namespace rxmesh::detail;
+
+    vertices.clear();
+    faces.clear();
+
+    MappedFile file(file_name);
+    if (!file.is_open()) {
+        RXMESH_ERROR("import_mesh_obj() can not open {}", file_name);
+        return false;
+    } else {
+        RXMESH_TRACE("Reading {}", file_name);
+    }
+
+    const char* begin = file.data();
+    const char* end   = begin + file.size();
+
+    const int n = get_import_num_threads(num_threads, file.size());
+
+    const std::vector<const char*> bound = split_lines(begin, end, n);
+
+    // 'v' for vertex, 'f' for face, 0 for anything else
+    auto line_type = [&](const char* p) -> char {
+        if (p + 1 < end && (*p == 'v' || *p == 'f') && is_blank(p[1])) {
+            return *p;
+        }
+        return 0;
+    };
+
+    // first pass: count vertices and triangles in every chunk
+    std::vector<uint64_t>    chunk_v(n + 1, 0), chunk_f(n + 1, 0);
+    std::vector<const char*> errors(n, nullptr);
+
+#pragma omp parallel for num_threads(n) schedule(static, 1)
+    for (int c = 0; c < n; ++c) {
+        uint64_t    nv = 0, nf = 0;
+        const char* p  = bound[c];
+        while (p < bound[c + 1]) {
+            const char* l = skip_blanks(p, end);
+            const char  t = line_type(l);
+            if (t == 'v') {
+                ++nv;
+            } else if (t == 'f') {
+                uint32_t    k = 0;
+                const char* q = l + 1;
+                while (true) {
+                    q = skip_blanks(q, end);
+                    if (q >= end || *q == '\n') {
+                        break;
+                    }
+                    ++k;
+                    q = skip_token(q, end);
+                }
+                if (k < 3) {
+                    if (errors[c] == nullptr) {
+                        errors[c] = l;
+                    }
+                } else {
+                    nf += k - 2;
+                }
+            }
+            p = next_line(l, end);
+        }
+        chunk_v[c + 1] = nv;
+        chunk_f[c + 1] = nf;
+    }
+
+    for (int c = 0; c < n; ++c) {
+        chunk_v[c + 1] += chunk_v[c];
+        chunk_f[c + 1] += chunk_f[c];
+    }
+
+    vertices.resize(3 * chunk_v[n]);
+    faces.resize(3 * chunk_f[n]);
+
+    // second pass: parse
+#pragma omp parallel for num_threads(n) schedule(static, 1)
+    for (int c = 0; c < n; ++c) {
+        uint64_t    v_id = chunk_v[c];
+        uint64_t    f_id = chunk_f[c];
+        const char* p    = bound[c];
+        while (p < bound[c + 1] && errors[c] == nullptr) {
+            const char* l = skip_blanks(p, end);
+            const char  t = line_type(l);
+            if (t == 'v') {
+                const char* q = l + 1;
+                for (uint32_t i = 0; i < 3 && q != nullptr; ++i) {
+                    q = parse_real(
+                        skip_blanks(q, end), end, vertices[3 * v_id + i]);
+                }
+                if (q == nullptr) {
+                    errors[c] = l;
+                }
+                ++v_id;
+            } else if (t == 'f') {
+                int64_t     first = -1, prev = -1;
+                const char* q     = l + 1;
+                while (true) {
+                    q = skip_blanks(q, end);
+                    if (q >= end || *q == '\n') {
+                        break;
+                    }
+                    int64_t     id;
+                    const char* r = parse_integer(q, end, id);
+                    if (r == nullptr || id == 0) {
+                        errors[c] = l;
+                        break;
+                    }
+                    // relative (negative) indices refer to the vertices read
+                    // so far
+                    id = (id < 0) ? id + static_cast<int64_t>(v_id) : id - 1;
+                    if (id < 0) {
+                        errors[c] = l;
+                        break;
+                    }
+                    if (first < 0) {
+                        first = id;
+                    } else if (prev < 0) {
+                        prev = id;
+                    } else {
+                        faces[3 * f_id + 0] = static_cast<IndexT>(first);
+                        faces[3 * f_id + 1] = static_cast<IndexT>(prev);
+                        faces[3 * f_id + 2] = static_cast<IndexT>(id);
+                        ++f_id;
+                        prev = id;
+                    }
+                    // skip texture/normal indices
+                    q = skip_token(r, end);
+                }
+            }
+            p = next_line(l, end);
+        }
+    }
+
+    for (const char* e : errors) {
+        if (e != nullptr) {
+            report_import_error("import_mesh_obj()", file_name, begin, errors);
+            vertices.clear();
+            faces.clear();
+            return false;
+        }
+    }
+
+    if (!check_face_indices(
+            "import_mesh_obj()", faces, vertices.size() / 3, n)) {
+        return false;
+    }
+
+    RXMESH_TRACE("import_mesh_obj() #vertices= {} ", vertices.size() / 3);
+    RXMESH_TRACE("import_mesh_obj() #faces= {} ", faces.size() / 3);
+
+    return true;
+}
+
+/**
+ * @brief Read a triangle mesh from a ply file (ascii, binary little endian, or
+ * binary big endian) into flat buffers. Only the vertex positions (x, y, z)
+ * and the face indices (vertex_indices or vertex_index) are read and polygons
+ * are triangulated as a fan. Vertices of binary files are read in parallel
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the ply file
+ * @param vertices output vertex coordinates (3 * #vertices)
+ * @param faces output face indices (3 * #faces)
+ * @param num_threads number of threads. Less than one means OpenMP default
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh_ply(const std::string    file_name,
+                     std::vector<DataT>&  vertices,
+                     std::vector<IndexT>& faces,
+                     const int            num_threads = -1)
+{
+    using namespace rxmesh::detail;
+
+    vertices.clear();
+    faces.clear();
+
+    MappedFile file(file_name);
+    if (!file.is_open()) {
+        RXMESH_ERROR("import_mesh_ply() can not open {}", file_name);
+        return false;
+    } else {
+        RXMESH_TRACE("Reading {}", file_name);
+    }
+
+    const char* begin = file.data();
+    const char* end   = begin + file.size();
+
+    // header
+    enum class Format
+    {
+        ASCII,
+        BINARY_LE,
+        BINARY_BE,
+        INVALID
+    };
+    Format                  format = Format::INVALID;
+    std::vector<PlyElement> elements;
+
+    const char* p = begin;
+    {
+        const char* l = next_line(p, end);
+        if (std::string(p, skip_token(p, l)) != "ply") {
+            RXMESH_ERROR("import_mesh_ply() {} is not a ply file", file_name);
+            return false;
+        }
+        p = l;
+    }
+
+    bool header_end = false;
+    while (p < end && !header_end) {
+        const char*        l = next_line(p, end);
+        std::istringstream ls(std::string(p, l));
+        std::string        keyword;
+        ls >> keyword;
+        if (keyword == "format") {
+            std::string f;
+            ls >> f;
+            if (f == "ascii") {
+                format = Format::ASCII;
+            } else if (f == "binary_little_endian") {
+                format = Format::BINARY_LE;
+            } else if (f == "binary_big_endian") {
+                format = Format::BINARY_BE;
+            }
+        } else if (keyword == "element") {
+            PlyElement e;
+            ls >> e.name >> e.count;
+            elements.push_back(e);
+        } else if (keyword == "property") {
+            if (elements.empty()) {
+                RXMESH_ERROR(
+                    "import_mesh_ply() property is defined before any element "
+                    "in {}",
+                    file_name);
+                return false;
+            }
+            PlyProperty prop;
+            std::string t;
+            ls >> t;
+            if (t == "list") {
+                std::string ct, it;
+                ls >> ct >> it >> prop.name;
+                prop.is_list    = true;
+                prop.count_type = ply_type(ct);
+                prop.type       = ply_type(it);
+            } else {
+                ls >> prop.name;
+                prop.type = ply_type(t);
+            }
+            if (prop.type == PlyType::INVALID ||
+                (prop.is_list && prop.count_type == PlyType::INVALID)) {
+                RXMESH_ERROR("import_mesh_ply() invalid property type in {}",
+                             file_name);
+                return false;
+            }
+            elements.back().props.push_back(prop);
+        } else if (keyword == "end_header") {
+            header_end = true;
+        }
+        p = l;
+    }
+
+    if (!header_end || format == Format::INVALID) {
+        RXMESH_ERROR("import_mesh_ply() invalid header in {}", file_name);
+        return false;
+    }
+
+    const bool swap = (format == Format::BINARY_BE);
+
+    int n = (num_threads < 1) ? omp_get_max_threads() : num_threads;
+
+    // read the position of a single vertex/the indices of a single face (from
+    // the element e) starting at p and return the pointer after it. Return
+    // nullptr if the file is truncated or has invalid values
+    auto read_item = [&](const PlyElement& e, const char* q, auto&& on_scalar,
+                         auto&& on_list) -> const char* {
+        for (uint32_t i = 0; i < e.props.size(); ++i) {
+            const PlyProperty& prop = e.props[i];
+            if (format == Format::ASCII) {
+                if (prop.is_list) {
+                    int64_t count;
+                    q = parse_integer(skip_white_spaces(q, end), end, count);
+                    if (q == nullptr || count < 0) {
+                        return nullptr;
+                    }
+                    on_list(i, count, [&](int64_t j, int64_t& val) {
+                        q = parse_integer(skip_white_spaces(q, end), end, val);
+                        return q != nullptr;
+                    });
+                    if (q == nullptr) {
+                        return nullptr;
+                    }
+                } else {
+                    double val;
+                    q = parse_real(skip_white_spaces(q, end), end, val);
+                    if (q == nullptr) {
+                        return nullptr;
+                    }
+                    on_scalar(i, val);
+                }
+            } else {
+                if (prop.is_list) {
+                    const uint32_t cs = ply_type_size(prop.count_type);
+                    const uint32_t is = ply_type_size(prop.type);
+                    if (q + cs > end) {
+                        return nullptr;
+                    }
+                    const int64_t count = static_cast<int64_t>(
+                        read_ply_binary(q, prop.count_type, swap));
+                    q += cs;
+                    if (count < 0 || q + count * is > end) {
+                        return nullptr;
+                    }
+                    const char* items = q;
+                    on_list(i, count, [&](int64_t j, int64_t& val) {
+                        val = static_cast<int64_t>(
+                            read_ply_binary(items + j * is, prop.type, swap));
+                        return true;
+                    });
+                    q += count * is;
+                } else {
+                    const uint32_t s = ply_type_size(prop.type);
+                    if (q + s > end) {
+                        return nullptr;
+                    }
+                    on_scalar(i, read_ply_binary(q, prop.type, swap));
+                    q += s;
+                }
+            }
+        }
+        return q;
+    };
+
+    auto ignore_scalar = [](uint32_t, double) {};
+    auto ignore_list   = [](uint32_t, int64_t count, auto&& get) {
+        int64_t val;
+        for (int64_t j = 0; j < count; ++j) {
+            if (!get(j, val)) {
+                return;
+            }
+        }
+    };
+
+    for (const PlyElement& e : elements) {
+        if (e.name == "vertex") {
+            int32_t  xyz[3]   = {-1, -1, -1};
+            uint32_t offset   = 0;
+            uint32_t off[3]   = {0, 0, 0};
+            bool     has_list = false;
+            for (uint32_t i = 0; i < e.props.size(); ++i) {
+                const std::string& name = e.props[i].name;
+                for (uint32_t d = 0; d < 3; ++d) {
+                    if (name == std::string(1, char('x' + d))) {
+                        xyz[d] = i;
+                        off[d] = offset;
+                    }
+                }
+                has_list = has_list || e.props[i].is_list;
+                offset += ply_type_size(e.props[i].type);
+            }
+            if (xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0) {
+                RXMESH_ERROR(
+                    "import_mesh_ply() vertex element does not have x, y, and "
+                    "z in {}",
+                    file_name);
+                return false;
+            }
+
+            vertices.resize(3 * e.count);
+
+            if (format != Format::ASCII && !has_list) {
+                // fixed size vertices and thus they can be read in parallel
+                const uint32_t stride = offset;
+                if (p + e.count * stride > end) {
+                    RXMESH_ERROR("import_mesh_ply() {} is truncated",
+                                 file_name);
+                    return false;
+                }
+#pragma omp parallel for num_threads(n)
+                for (int64_t v = 0; v < static_cast<int64_t>(e.count); ++v) {
+                    for (uint32_t d = 0; d < 3; ++d) {
+                        vertices[3 * v + d] = static_cast<DataT>(
+                            read_ply_binary(p + v * stride + off[d],
+                                            e.props[xyz[d]].type,
+                                            swap));
+                    }
+                }
+                p += e.count * stride;
+            } else {
+                for (uint64_t v = 0; v < e.count && p != nullptr; ++v) {
+                    p = read_item(
+                        e,
+                        p,
+                        [&](uint32_t i, double val) {
+                            for (uint32_t d = 0; d < 3; ++d) {
+                                if (int32_t(i) == xyz[d]) {
+                                    vertices[3 * v + d] =
+                                        static_cast<DataT>(val);
+                                }
+                            }
+                        },
+                        ignore_list);
+                }
+            }
+        } else if (e.name == "face") {
+            int32_t f_prop = -1;
+            for (uint32_t i = 0; i < e.props.size(); ++i) {
+                const std::string& name = e.props[i].name;
+                if (e.props[i].is_list &&
+                    (name == "vertex_indices" || name == "vertex_index")) {
+                    f_prop = i;
+                }
+            }
+            if (f_prop < 0) {
+                RXMESH_ERROR(
+                    "import_mesh_ply() face element does not have "
+                    "vertex_indices in {}",
+                    file_name);
+                return false;
+            }
+
+            faces.reserve(3 * e.count);
+            bool bad_face = false;
+            for (uint64_t f = 0; f < e.count && p != nullptr; ++f) {
+                p = read_item(
+                    e,
+                    p,
+                    ignore_scalar,
+                    [&](uint32_t i, int64_t count, auto&& get) {
+                        if (int32_t(i) != f_prop) {
+                            ignore_list(i, count, get);
+                            return;
+                        }
+                        if (count < 3) {
+                            bad_face = true;
+                        }
+                        int64_t first = 0, prev = 0, val = 0;
+                        for (int64_t j = 0; j < count; ++j) {
+                            if (!get(j, val)) {
+                                return;
+                            }
+                            if (j == 0) {
+                                first = val;
+                            } else if (j >= 2) {
+                                faces.push_back(static_cast<IndexT>(first));
+                                faces.push_back(static_cast<IndexT>(prev));
+                                faces.push_back(static_cast<IndexT>(val));
+                            }
+                            prev = val;
+                        }
+                    });
+            }
+            if (bad_face) {
+                RXMESH_ERROR(
+                    "import_mesh_ply() face with less than 3 vertices in {}",
+                    file_name);
+                return false;
+            }
+        } else {
+            for (uint64_t i = 0; i < e.count && p != nullptr; ++i) {
+                p = read_item(e, p, ignore_scalar, ignore_list);
+            }
+        }
+
+        if (p == nullptr) {
+            RXMESH_ERROR(
+                "import_mesh_ply() {} is truncated or has invalid values in "
+                "element {}",
+                file_name,
+                e.name);
+            vertices.clear();
+            faces.clear();
+            return false;
+        }
+    }
+
+    if (!check_face_indices(
+            "import_mesh_ply()", faces, vertices.size() / 3, n)) {
+        return false;
+    }
+
+    RXMESH_TRACE("import_mesh_ply() #vertices= {} ", vertices.size() / 3);
+    RXMESH_TRACE("import_mesh_ply() #faces= {} ", faces.size() / 3);
+
+    return true;
+}
+
+/**
+ * @brief Read a triangle mesh from an stl file (binary or ascii) into flat
+ * buffers. Since stl stores every triangle with its own three corners,
+ * vertices with the same (bit-wise) coordinates are merged. Vertex ids follow
+ * the order in which the vertices are first seen in the file
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the stl file
+ * @param vertices output vertex coordinates (3 * #vertices)
+ * @param faces output face indices (3 * #faces)
+ * @param num_threads number of threads. Less than one means OpenMP default
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh_stl(const std::string    file_name,
+                     std::vector<DataT>&  vertices,
+                     std::vector<IndexT>& faces,
+                     const int            num_threads = -1)
+{
+    using namespace rxmesh::detail;
+
+    vertices.clear();
+    faces.clear();
+
+    MappedFile file(file_name);
+    if (!file.is_open()) {
+        RXMESH_ERROR("import_mesh_stl() can not open {}", file_name);
+        return false;
+    } else {
+        RXMESH_TRACE("Reading {}", file_name);
+    }
+
+    const char* begin = file.data();
+    const char* end   = begin + file.size();
+
+    const int n = (num_threads < 1) ? omp_get_max_threads() : num_threads;
+
+    // the corners of all triangles
+    std::vector<float> corners;
+
+    // binary stl has 80 bytes header, number of triangles, and then 50 bytes
+    // per triangle. Some binary files start with "solid" as ascii files do so
+    // we rely on the size to tell them apart
+    bool is_binary = false;
+    if (file.size() >= 84) {
+        uint32_t num_tri;
+        std::memcpy(&num_tri, begin + 80, sizeof(uint32_t));
+        is_binary = (84 + 50 * uint64_t(num_tri) == file.size());
+        if (is_binary) {
+            corners.resize(9 * uint64_t(num_tri));
+#pragma omp parallel for num_threads(n)
+            for (int64_t t = 0; t < static_cast<int64_t>(num_tri); ++t) {
+                // skip the normal
+                std::memcpy(corners.data() + 9 * t,
+                            begin + 84 + 50 * t + 12,
+                            9 * sizeof(float));
+            }
+        }
+    }
+
+    if (!is_binary) {
+        const char* p = begin;
+        while (p < end) {
+            const char* l = skip_blanks(p, end);
+            const char* t = skip_token(l, end);
+            if (std::string(l, t) == "vertex") {
+                const char* q = t;
+                for (uint32_t i = 0; i < 3 && q != nullptr; ++i) {
+                    float val;
+                    q = parse_real(skip_blanks(q, end), end, val);
+                    corners.push_back(val);
+                }
+                if (q == nullptr) {
+                    report_import_error(
+                        "import_mesh_stl()", file_name, begin, {l});
+                    return false;
+                }
+            }
+            p = next_line(l, end);
+        }
+        if (corners.size() % 9 != 0) {
+            RXMESH_ERROR(
+                "import_mesh_stl() number of vertices is not a multiple of 3 "
+                "in {}",
+                file_name);
+            return false;
+        }
+    }
+
+    // merge corners with the same coordinates by sorting them by their bits
+    const uint64_t num_corners = corners.size() / 3;
+
+    using KeyT = std::pair<std::array<uint32_t, 3>, uint32_t>;
+    std::vector<KeyT> keys(num_corners);
+#pragma omp parallel for num_threads(n)
+    for (int64_t c = 0; c < static_cast<int64_t>(num_corners); ++c) {
+        for (uint32_t d = 0; d < 3; ++d) {
+            // treat -0 and 0 as the same
+            float x = corners[3 * c + d] + 0.0f;
+            std::memcpy(&keys[c].first[d], &x, sizeof(float));
+        }
+        keys[c].second = static_cast<uint32_t>(c);
+    }
+    rxmesh::parallel_sort(keys, n);
+
+    // every corner points to the first corner (in file order) with the same
+    // coordinates
+    std::vector<uint32_t> rep(num_corners);
+#pragma omp parallel for num_threads(n)
+    for (int64_t i = 0; i < static_cast<int64_t>(num_corners); ++i) {
+        if (i == 0 || keys[i].first != keys[i - 1].first) {
+            const uint32_t head = keys[i].second;
+            for (int64_t h = i; h < static_cast<int64_t>(num_corners) &&
+                        keys[h].first == keys[i].first;
+                 ++h) {
+                rep[keys[h].second] = head;
+            }
+        }
+    }
+
+    std::vector<uint32_t> new_id(num_corners);
+    faces.resize(num_corners);
+    uint64_t num_vertices = 0;
+    for (uint64_t c = 0; c < num_corners; ++c) {
+        if (rep[c] == c) {
+            new_id[c] = static_cast<uint32_t>(num_vertices++);
+        }
+        faces[c] = static_cast<IndexT>(new_id[rep[c]]);
+    }
+
+    vertices.resize(3 * num_vertices);
+#pragma omp parallel for num_threads(n)
+    for (int64_t c = 0; c < static_cast<int64_t>(num_corners); ++c) {
+        if (rep[c] == c) {
+            for (uint32_t d = 0; d < 3; ++d) {
+                vertices[3 * new_id[c] + d] =
+                    static_cast<DataT>(corners[3 * c + d]);
+            }
+        }
+    }
+
+    RXMESH_TRACE("import_mesh_stl() #vertices= {} ", vertices.size() / 3);
+    RXMESH_TRACE("import_mesh_stl() #faces= {} ", faces.size() / 3);
+
+    return true;
+}
+
+/**
+ * @brief Read a triangle mesh from an obj, ply, or stl file (based on the file
+ * extension) into flat buffers i.e., the coordinates of vertex v are
+ * vertices[3 * v], vertices[3 * v + 1], and vertices[3 * v + 2] and the
+ * vertices of face f are faces[3 * f], faces[3 * f + 1], and faces[3 * f + 2].
+ * Unlike import_obj, this reads the file in parallel and does not allocate per
+ * vertex or per face
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the mesh file
+ * @param vertices output vertex coordinates (3 * #vertices)
+ * @param faces output face indices (3 * #faces)
+ * @param num_threads number of threads. Less than one means OpenMP default
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh(const std::string    file_name,
+                 std::vector<DataT>&  vertices,
+                 std::vector<IndexT>& faces,
+                 const int            num_threads = -1)
+{
+    std::string ext = file_name.substr(file_name.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == "obj") {
+        return import_mesh_obj(file_name, vertices, faces, num_threads);
+    } else if (ext == "ply") {
+        return import_mesh_ply(file_name, vertices, faces, num_threads);
+    } else if (ext == "stl") {
+        return import_mesh_stl(file_name, vertices, faces, num_threads);
+    }
+    RXMESH_ERROR("import_mesh() unsupported file extension {} ({})",
+                 ext,
+                 file_name);
+    return false;
+}
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cuda_runtime.h>
+
+#ifdef USE_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief device-side counters of the dynamic (CavityManager) kernels. The
+ * counters live in one device array (see Instrumentation::get_counters) and
+ * are incremented by one thread per block
+ */
+enum class Counter : uint32_t
+{
+    SchedulerPop     = 0,  // patches popped from the PatchScheduler
+    PatchLockFail    = 1,  // patches popped but could not be locked
+    NeighborLockFail = 2,  // patches that could not lock their neighbors
+    MigrateFail      = 3,  // patches that failed to migrate
+    CavitySuccess    = 4,  // cavities of patches written to global memory
+    CavityFail       = 5,  // cavities of patches that could not be written
+    CommitFail       = 6,  // patches whose optimistic commit failed
+    NumCounters      = 7,
+};
+
+inline std::string counter_to_string(const Counter c)
+{
+    switch (c) {
+        case Counter::SchedulerPop:
+            return "scheduler_pop";
+        case Counter::PatchLockFail:
+            return "patch_lock_fail";
+        case Counter::NeighborLockFail:
+            return "neighbor_lock_fail";
+        case Counter::MigrateFail:
+            return "migrate_fail";
+        case Counter::CavitySuccess:
+            return "cavity_success";
+        case Counter::CavityFail:
+            return "cavity_fail";
+        case Counter::CommitFail:
+            return "commit_fail";
+        default: {
+            RXMESH_ERROR("counter_to_string() unknown counter");
+            return "";
+        }
+    }
+}
+
+/**
+ * @brief the stages of CavityManager that are timed (in clock cycles summed
+ * over all blocks) when the instrumentation is enabled. Every stage ends with
+ * a block-wide sync so the time of a stage is the time the whole block spends
+ * in it
+ */
+enum class Stage : uint32_t
+{
+    Construct        = 0,   // pop and lock a patch and allocate shared memory
+    Create           = 1,   // user code that creates the cavities
+    CavityGraph      = 2,   // construct_cavity_graph
+    MIS              = 3,   // maximal independent set and conflicts removal
+    EdgeLoop         = 4,   // cavity boundary edge loops
+    Hashtable        = 5,   // load and store the LP hashtables
+    Migrate          = 6,   // lock_patches_to_lock, migrate, ensure_ownership
+    Ownership        = 7,   // change_ownership
+    UpdateAttributes = 8,   // update_attributes
+    FillIn           = 9,   // user code that fills in the cavities
+    Epilogue         = 10,  // write back to global memory and unlock
+    NumStages        = 11,
+};
+
+inline std::string stage_to_string(const Stage s)
+{
+    switch (s) {
+        case Stage::Construct:
+            return "construct";
+        case Stage::Create:
+            return "create";
+        case Stage::CavityGraph:
+            return "cavity_graph";
+        case Stage::MIS:
+            return "maximal_independent_set";
+        case Stage::EdgeLoop:
+            return "edge_loop";
+        case Stage::Hashtable:
+            return "hashtable";
+        case Stage::Migrate:
+            return "migrate";
+        case Stage::Ownership:
+            return "ownership";
+        case Stage::UpdateAttributes:
+            return "update_attributes";
+        case Stage::FillIn:
+            return "fill_in";
+        case Stage::Epilogue:
+            return "epilogue";
+        default: {
+            RXMESH_ERROR("stage_to_string() unknown stage");
+            return "";
+        }
+    }
+}
+
+namespace detail {
+/**
+ * @brief increment a device counter if the instrumentation is enabled i.e.,
+ * counters is not nullptr
+ */
+__device__ __forceinline__ void count(uint32_t*      counters,
+                                      const Counter  c,
+                                      const uint32_t val = 1)
+{
+#ifdef __CUDA_ARCH__
+    if (counters != nullptr && val > 0) {
+        ::atomicAdd(counters + uint32_t(c), val);
+    }
+#endif
+}
+
+/**
+ * @brief add the clock cycles spent in a stage if the instrumentation is
+ * enabled i.e., stage_cycles is not nullptr
+ */
+__device__ __forceinline__ void add_cycles(unsigned long long* stage_cycles,
+                                           const Stage         s,
+                                           const long long     cycles)
+{
+#ifdef __CUDA_ARCH__
+    if (stage_cycles != nullptr && cycles > 0) {
+        ::atomicAdd(stage_cycles + uint32_t(s),
+                    static_cast<unsigned long long>(cycles));
+    }
+#endif
+}
+}  // namespace detail
+
+/**
+ * @brief what is recorded by the instrumentation for one kernel (or a group
+ * of kernels launched under the same name, e.g., for_each_vertex)
+ */
+struct KernelRecord
+{
+    uint32_t num_launches = 0;
+    // total time in milliseconds of the resolved launches
+    double   time_ms      = 0;
+    uint32_t num_blocks   = 0;
+    uint32_t num_threads  = 0;
+    uint32_t dyn_smem     = 0;
+    uint32_t static_smem  = 0;
+    uint32_t num_reg      = 0;
+    // theoretical occupancy i.e., resident warps / max warps per SM as
+    // computed by cudaOccupancyMaxActiveBlocksPerMultiprocessor
+    float    occupancy    = 0;
+};
+
+/**
+ * @brief per-kernel instrumentation that is collected by RXMeshStatic
+ * (prepare_launch_box, run_query_kernel, and for_each) and CavityManager and
+ * is written to the Report (see Report::instrumentation). When disabled (the
+ * default), the cost is a single branch. When enabled, a launch records two
+ * CUDA events on its stream that are resolved lazily (without synchronizing
+ * the stream) so it can be left on in production runs. NVTX ranges are
+ * emitted for every instrumented launch if RXMesh is built with USE_NVTX
+ * regardless of whether the instrumentation is enabled.
+ *
+ * The device counters (see Counter) and the stage cycles (see Stage) are read
+ * by CavityManager from the Context which picks them at construction time
+ * and so the instrumentation should be enabled before creating the mesh to
+ * collect them
+ */
+class Instrumentation
+{
+   public:
+    Instrumentation(const Instrumentation&)            = delete;
+    Instrumentation& operator=(const Instrumentation&) = delete;
+
+    static Instrumentation& get()
+    {
+        static Instrumentation instance;
+        return instance;
+    }
+
+    /**
+     * @brief enable/disable the instrumentation
+     */
+    void enable(const bool enabled = true)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_enabled = enabled;
+        if (m_enabled && m_d_counters == nullptr) {
+            CUDA_ERROR(cudaMalloc((void**)&m_d_counters,
+                                  uint32_t(Counter::NumCounters) *
+                                      sizeof(uint32_t)));
+            CUDA_ERROR(cudaMemset(
+                m_d_counters,
+                0,
+                uint32_t(Counter::NumCounters) * sizeof(uint32_t)));
+        }
+        if (m_enabled && m_d_stage_cycles == nullptr) {
+            CUDA_ERROR(cudaMalloc((void**)&m_d_stage_cycles,
+                                  uint32_t(Stage::NumStages) *
+                                      sizeof(unsigned long long)));
+            CUDA_ERROR(cudaMemset(
+                m_d_stage_cycles,
+                0,
+                uint32_t(Stage::NumStages) * sizeof(unsigned long long)));
+        }
+    }
+
+    bool is_enabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * @brief the device counters or nullptr if the instrumentation is
+     * disabled
+     */
+    uint32_t* get_counters() const
+    {
+        return m_enabled ? m_d_counters : nullptr;
+    }
+
+    /**
+     * @brief read the device counters
+     */
+    std::vector<uint32_t> read_counters() const
+    {
+        std::vector<uint32_t> h_counters(uint32_t(Counter::NumCounters), 0);
+        if (m_d_counters != nullptr) {
+            CUDA_ERROR(cudaMemcpy(h_counters.data(),
+                                  m_d_counters,
+                                  h_counters.size() * sizeof(uint32_t),
+                                  cudaMemcpyDeviceToHost));
+        }
+        return h_counters;
+    }
+
+    /**
+     * @brief the device clock cycles of the CavityManager stages or nullptr
+     * if the instrumentation is disabled
+     */
+    unsigned long long* get_stage_cycles() const
+    {
+        return m_enabled ? m_d_stage_cycles : nullptr;
+    }
+
+    /**
+     * @brief read the clock cycles of the CavityManager stages (summed over
+     * all blocks)
+     */
+    std::vector<unsigned long long> read_stage_cycles() const
+    {
+        std::vector<unsigned long long> h_cycles(uint32_t(Stage::NumStages),
+                                                 0);
+        if (m_d_stage_cycles != nullptr) {
+            CUDA_ERROR(cudaMemcpy(h_cycles.data(),
+                                  m_d_stage_cycles,
+                                  h_cycles.size() * sizeof(unsigned long long),
+                                  cudaMemcpyDeviceToHost));
+        }
+        return h_cycles;
+    }
+
+    /**
+     * @brief the name of a kernel from its pointer
+     */
+    static std::string kernel_name(const void* kernel)
+    {
+#if CUDART_VERSION >= 12030
+        const char* name = nullptr;
+        if (cudaFuncGetName(&name, kernel) == cudaSuccess && name != nullptr) {
+            return std::string(name);
+        }
+#endif
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "kernel_%p", kernel);
+        return std::string(buf);
+    }
+
+    /**
+     * @brief record the launch configuration of a kernel as computed by
+     * RXMeshStatic::prepare_launch_box. The number of blocks is recorded at
+     * launch time (see begin())
+     */
+    void launch_config(const std::string& name,
+                       const uint32_t     num_threads,
+                       const uint32_t     dyn_smem,
+                       const uint32_t     static_smem,
+                       const uint32_t     num_reg,
+                       const float        occupancy)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        KernelRecord&               rec = m_kernels[name];
+        rec.num_threads                 = num_threads;
+        rec.dyn_smem                    = dyn_smem;
+        rec.static_smem                 = static_smem;
+        rec.num_reg                     = num_reg;
+        rec.occupancy                   = occupancy;
+    }
+
+    /**
+     * @brief account for bytes moved between host and device under a name
+     */
+    void add_bytes(const std::string& name, const size_t num_bytes)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytes[name] += num_bytes;
+    }
+
+    /**
+     * @brief true if launches should be wrapped by begin()/end() i.e., if the
+     * instrumentation is enabled or NVTX ranges are emitted
+     */
+    bool is_active() const
+    {
+#ifdef USE_NVTX
+        return true;
+#else
+        return m_enabled;
+#endif
+    }
+
+    /**
+     * @brief start timing a launch on the stream where num_blocks is the grid
+     * size (if known). Returns an id that should be passed to end()
+     */
+    int begin(const std::string& name,
+              cudaStream_t       stream,
+              const uint32_t     num_blocks = 0)
+    {
+#ifdef USE_NVTX
+        nvtxRangePushA(name.c_str());
+#endif
+        if (!m_enabled) {
+            return -1;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // resolve launches that are done to bound the number of events
+        poll(false);
+
+        Pending pending;
+        pending.name  = name;
+        pending.start = acquire_event();
+        pending.stop  = acquire_event();
+        CUDA_ERROR(cudaEventRecord(pending.start, stream));
+
+        KernelRecord& rec = m_kernels[name];
+        rec.num_launches++;
+        if (num_blocks > 0) {
+            rec.num_blocks = num_blocks;
+        }
+
+        m_pending.push_back(pending);
+        return int(m_pending_base + m_pending.size() - 1);
+    }
+
+    /**
+     * @brief stop timing a launch started by begin()
+     */
+    void end(const int id, cudaStream_t stream)
+    {
+#ifdef USE_NVTX
+        nvtxRangePop();
+#endif
+        if (id < 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t i = size_t(id) - m_pending_base;
+        if (i < m_pending.size()) {
+            CUDA_ERROR(cudaEventRecord(m_pending[i].stop, stream));
+            m_pending[i].recorded = true;
+        }
+    }
+
+    /**
+     * @brief wait for all timed launches and return the records
+     */
+    std::map<std::string, KernelRecord> get_kernels()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        poll(true);
+        return m_kernels;
+    }
+
+    std::map<std::string, size_t> get_bytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytes;
+    }
+
+    /**
+     * @brief clear all records and counters
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        poll(true);
+        m_kernels.clear();
+        m_bytes.clear();
+        if (m_d_counters != nullptr) {
+            CUDA_ERROR(cudaMemset(
+                m_d_counters,
+                0,
+                uint32_t(Counter::NumCounters) * sizeof(uint32_t)));
+        }
+        if (m_d_stage_cycles != nullptr) {
+            CUDA_ERROR(cudaMemset(
+                m_d_stage_cycles,
+                0,
+                uint32_t(Stage::NumStages) * sizeof(unsigned long long)));
+        }
+    }
+
+    /**
+     * @brief disable the instrumentation, clear all records, and release the
+     * device memory and events. Should be called before resetting the device
+     */
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        poll(true);
+        m_enabled = false;
+        m_kernels.clear();
+        m_bytes.clear();
+        for (auto& p : m_pending) {
+            CUDA_ERROR(cudaEventDestroy(p.start));
+            CUDA_ERROR(cudaEventDestroy(p.stop));
+        }
+        m_pending_base += m_pending.size();
+        m_pending.clear();
+        for (auto& e : m_free_events) {
+            CUDA_ERROR(cudaEventDestroy(e));
+        }
+        m_free_events.clear();
+        GPU_FREE(m_d_counters);
+        GPU_FREE(m_d_stage_cycles);
+    }
+
+   private:
+    Instrumentation()
+        : m_enabled(false),
+          m_d_counters(nullptr),
+          m_d_stage_cycles(nullptr),
+          m_pending_base(0)
+    {
+    }
+
+    // the process is exiting and the CUDA context may be gone so the device
+    // memory and events are not released here
+    ~Instrumentation() = default;
+
+    struct Pending
+    {
+        std::string name;
+        cudaEvent_t start;
+        cudaEvent_t stop;
+        bool        recorded = false;
+    };
+
+    cudaEvent_t acquire_event()
+    {
+        if (m_free_events.empty()) {
+            cudaEvent_t e;
+            CUDA_ERROR(cudaEventCreate(&e));
+            return e;
+        }
+        cudaEvent_t e = m_free_events.back();
+        m_free_events.pop_back();
+        return e;
+    }
+
+    /**
+     * @brief resolve the timing of pending launches in order. If wait is
+     * false, stop at the first launch that is not done
+     */
+    void poll(const bool wait)
+    {
+        while (!m_pending.empty()) {
+            Pending& p = m_pending.front();
+            if (!p.recorded) {
+                break;
+            }
+            if (wait) {
+                CUDA_ERROR(cudaEventSynchronize(p.stop));
+            } else if (cudaEventQuery(p.stop) != cudaSuccess) {
+                break;
+            }
+            float ms = 0;
+            CUDA_ERROR(cudaEventElapsedTime(&ms, p.start, p.stop));
+            m_kernels[p.name].time_ms += ms;
+            m_free_events.push_back(p.start);
+            m_free_events.push_back(p.stop);
+            m_pending.pop_front();
+            m_pending_base++;
+        }
+    }
+
+    bool                                m_enabled;
+    uint32_t*                           m_d_counters;
+    unsigned long long*                 m_d_stage_cycles;
+    std::map<std::string, KernelRecord> m_kernels;
+    std::map<std::string, size_t>       m_bytes;
+    std::deque<Pending>                 m_pending;
+    size_t                              m_pending_base;
+    std::vector<cudaEvent_t>            m_free_events;
+    std::mutex                          m_mutex;
+};
+
+/**
+ * @brief times (and marks with an NVTX range) the launches issued on the
+ * stream during the lifetime of the scope. The name is only built if the
+ * instrumentation is active (see Instrumentation::is_active)
+ */
+class InstrumentScope
+{
+   public:
+    InstrumentScope(const char*    name,
+                    cudaStream_t   stream     = NULL,
+                    const uint32_t num_blocks = 0)
+        : m_stream(stream),
+          m_active(Instrumentation::get().is_active()),
+          m_id(-1)
+    {
+        if (m_active) {
+            m_id = Instrumentation::get().begin(name, stream, num_blocks);
+        }
+    }
+
+    InstrumentScope(const void*    kernel,
+                    cudaStream_t   stream     = NULL,
+                    const uint32_t num_blocks = 0)
+        : m_stream(stream),
+          m_active(Instrumentation::get().is_active()),
+          m_id(-1)
+    {
+        if (m_active) {
+            m_id = Instrumentation::get().begin(
+                Instrumentation::kernel_name(kernel), stream, num_blocks);
+        }
+    }
+
+    InstrumentScope(const InstrumentScope&)            = delete;
+    InstrumentScope& operator=(const InstrumentScope&) = delete;
+
+    ~InstrumentScope()
+    {
+        if (m_active) {
+            Instrumentation::get().end(m_id, m_stream);
+        }
+    }
+
+   private:
+    cudaStream_t m_stream;
+    bool         m_active;
+    int          m_id;
+};
+}  // namespace rxmesh
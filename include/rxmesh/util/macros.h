@@ -177,6 +177,22 @@ inline void cublasHandleError(cublasStatus_t status,
         ptr = nullptr;             \
     }
 
+/**
+ * @brief allocate num_bytes on the device. If managed is true, the memory is
+ * allocated as CUDA managed memory which can exceed the device memory and be
+ * migrated between the host and the device (see PatchResidency). Both are
+ * released with cudaFree/GPU_FREE
+ */
+inline cudaError_t device_malloc(void**       ptr,
+                                 const size_t num_bytes,
+                                 const bool   managed)
+{
+    if (managed) {
+        return cudaMallocManaged(ptr, num_bytes, cudaMemAttachGlobal);
+    }
+    return cudaMalloc(ptr, num_bytes);
+}
+
 // Taken from https://stackoverflow.com/a/12779757/1608232
 #if defined(__CUDACC__)  // NVCC
 #define ALIGN(n) __align__(n)
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief read-only memory map of a file. On Windows, the file is read into a
+ * host buffer instead
+ */
+class MappedFile
+{
+   public:
+    MappedFile(const std::string& filename) : m_data(nullptr), m_size(0)
+    {
+#ifdef _WIN32
+        std::ifstream is(filename, std::ios::binary | std::ios::ate);
+        if (!is.is_open()) {
+            return;
+        }
+        m_size = static_cast<size_t>(is.tellg());
+        m_buffer.resize(m_size);
+        is.seekg(0);
+        is.read(m_buffer.data(), m_size);
+        m_data = m_buffer.data();
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* ptr =
+                mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                m_data = static_cast<const char*>(ptr);
+                m_size = static_cast<size_t>(st.st_size);
+                // the whole file is going to be read
+                madvise(ptr, m_size, MADV_WILLNEED);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (m_data != nullptr) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+    }
+
+    bool is_open() const
+    {
+        return m_data != nullptr;
+    }
+
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+   private:
+    const char* m_data;
+    size_t      m_size;
+#ifdef _WIN32
+    std::vector<char> m_buffer;
+#endif
+};
+}  // namespace detail
+}  // namespace rxmesh
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/mapped_file.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Header of the binary mesh cache written by RXMeshStatic::save_cache.
+ * The cache is a snapshot of the fully built mesh (patches, ltog, topology,
+ * hash tables, prefixes, and optionally vertex coordinates) so that reloading
+ * it skips parsing the input file, building the supporting structures,
+ * patching, and building the hash tables. The cache is tied to the layout of
+ * PatchInfo and so MESH_CACHE_VERSION should be bumped whenever the layout of
+ * any of the cached arrays changes
+ */
+struct MeshCacheHeader
+{
+    static constexpr char     MAGIC[4]           = {'R', 'X', 'M', 'C'};
+    static constexpr uint32_t MESH_CACHE_VERSION = 1;
+
+    char     magic[4];
+    uint32_t version;
+    uint32_t num_vertices, num_edges, num_faces;
+    uint32_t num_patches, max_num_patches, patch_size;
+    uint32_t max_vertices_per_patch, max_edges_per_patch, max_faces_per_patch;
+    uint32_t max_vertex_capacity, max_edge_capacity, max_face_capacity;
+    uint32_t input_max_valence, input_max_edge_incident_faces,
+        input_max_face_adjacent_faces;
+    uint32_t is_input_edge_manifold, is_input_closed;
+    uint32_t has_vertex_coordinates;
+    float    capacity_factor, patch_alloc_factor, lp_hashtable_load_factor;
+    uint32_t local_index_bytes, lp_pair_bytes, patch_stash_size, lp_stash_size;
+    uint64_t patcher_num_bytes;
+    uint64_t file_num_bytes;
+};
+
+/**
+ * @brief check if a file is a mesh cache by reading its magic number
+ */
+inline bool is_mesh_cache(const std::string& filename)
+{
+    std::ifstream is(filename, std::ios::binary);
+    if (!is.is_open()) {
+        return false;
+    }
+    char magic[4] = {0, 0, 0, 0};
+    is.read(magic, 4);
+    return is.gcount() == 4 &&
+           std::memcmp(magic, MeshCacheHeader::MAGIC, 4) == 0;
+}
+
+namespace detail {
+
+/**
+ * @brief stream buffer over a read-only memory region which lets us feed a
+ * section of a mapped file to a std::istream without copying it
+ */
+struct MemoryStreamBuf : std::streambuf
+{
+    MemoryStreamBuf(const char* data, size_t size)
+    {
+        char* ptr = const_cast<char*>(data);
+        setg(ptr, ptr, ptr + size);
+    }
+};
+
+/**
+ * @brief All sections in the cache are aligned to this many bytes
+ */
+constexpr size_t MESH_CACHE_ALIGNMENT = 16;
+
+/**
+ * @brief sequential reader of a mapped cache. Arrays are returned as pointers
+ * into the mapped memory. On reading past the end of the cache, nullptr is
+ * returned and the reader is marked as failed
+ */
+class MeshCacheReader
+{
+   public:
+    MeshCacheReader(const char* data, size_t size, size_t offset = 0)
+        : m_data(data), m_size(size), m_offset(offset), m_failed(false)
+    {
+    }
+
+    template <typename T>
+    const T* read(size_t count)
+    {
+        const size_t num_bytes = count * sizeof(T);
+        if (m_failed || m_offset + num_bytes > m_size) {
+            m_failed = true;
+            return nullptr;
+        }
+        const T* ret = reinterpret_cast<const T*>(m_data + m_offset);
+        m_offset += num_bytes;
+        align();
+        return ret;
+    }
+
+    size_t offset() const
+    {
+        return m_offset;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+   private:
+    void align()
+    {
+        m_offset = ((m_offset + MESH_CACHE_ALIGNMENT - 1) /
+                    MESH_CACHE_ALIGNMENT) *
+                   MESH_CACHE_ALIGNMENT;
+    }
+
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_offset;
+    bool        m_failed;
+};
+
+/**
+ * @brief sequential writer of the cache that pads every section to
+ * MESH_CACHE_ALIGNMENT
+ */
+class MeshCacheWriter
+{
+   public:
+    MeshCacheWriter(const std::string& filename)
+        : m_os(filename, std::ios::binary)
+    {
+    }
+
+    bool is_open() const
+    {
+        return m_os.is_open();
+    }
+
+    template <typename T>
+    void write(const T* data, size_t count)
+    {
+        if (count > 0) {
+            m_os.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        }
+        align();
+    }
+
+    size_t offset()
+    {
+        return static_cast<size_t>(m_os.tellp());
+    }
+
+    /**
+     * @brief overwrite a previously written section at a given offset
+     */
+    template <typename T>
+    void write_at(size_t offset, const T* data, size_t count)
+    {
+        const size_t current = this->offset();
+        m_os.seekp(offset);
+        m_os.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        m_os.seekp(current);
+    }
+
+    bool good() const
+    {
+        return m_os.good();
+    }
+
+    std::ostream& stream()
+    {
+        return m_os;
+    }
+
+   private:
+    void align()
+    {
+        static const char zeros[MESH_CACHE_ALIGNMENT] = {0};
+
+        const size_t rem = offset() % MESH_CACHE_ALIGNMENT;
+        if (rem != 0) {
+            m_os.write(zeros, MESH_CACHE_ALIGNMENT - rem);
+        }
+    }
+
+    std::ofstream m_os;
+};
+}  // namespace detail
+}  // namespace rxmesh
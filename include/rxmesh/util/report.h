@@ -11,6 +11,7 @@
 #include <map>
 #include <sstream>
 #include "rxmesh/rxmesh.h"
+#include "rxmesh/util/instrumentation.h"
 #include "rxmesh/util/util.h"
 #ifdef __NVCC__
 #include "cuda.h"
@@ -273,6 +274,12 @@ struct Report
             std::filesystem::create_directories(output_folder);
         }
 
+        // dump the instrumentation if it was not added explicitly
+        if (Instrumentation::get().is_enabled() &&
+            !m_doc.HasMember("Instrumentation")) {
+            instrumentation();
+        }
+
         std::ofstream ofs(full_name);
         if (!ofs.is_open()) {
             RXMESH_ERROR("Report::write() can not open {}", full_name);
@@ -320,6 +327,79 @@ struct Report
         m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
     }
 
+    // add the per-kernel records, bytes moved, and device counters collected
+    // by Instrumentation. This waits for the timed kernels to finish
+    void instrumentation(
+        const std::string json_member_name = "Instrumentation")
+    {
+        rapidjson::Document subdoc(&m_doc.GetAllocator());
+        subdoc.SetObject();
+
+        rapidjson::Document kernels(&m_doc.GetAllocator());
+        kernels.SetObject();
+        for (const auto& it : Instrumentation::get().get_kernels()) {
+            const KernelRecord& rec = it.second;
+
+            rapidjson::Document kdoc(&m_doc.GetAllocator());
+            kdoc.SetObject();
+            add_member("num_launches", rec.num_launches, kdoc);
+            add_member("time (ms)", rec.time_ms, kdoc);
+            add_member("num_blocks", rec.num_blocks, kdoc);
+            add_member("num_threads", rec.num_threads, kdoc);
+            add_member("dynamic_shared_memory (b)", rec.dyn_smem, kdoc);
+            add_member("static_shared_memory (b)", rec.static_smem, kdoc);
+            add_member("num_register_per_thread", rec.num_reg, kdoc);
+            add_member("theoretical_occupancy", double(rec.occupancy), kdoc);
+
+            rapidjson::Value key(it.first.c_str(), m_doc.GetAllocator());
+            kernels.AddMember(key, kdoc, m_doc.GetAllocator());
+        }
+        subdoc.AddMember("Kernels", kernels, m_doc.GetAllocator());
+
+        rapidjson::Document bytes(&m_doc.GetAllocator());
+        bytes.SetObject();
+        for (const auto& it : Instrumentation::get().get_bytes()) {
+            add_member(it.first, it.second, bytes);
+        }
+        subdoc.AddMember("Bytes Moved", bytes, m_doc.GetAllocator());
+
+        rapidjson::Document counters(&m_doc.GetAllocator());
+        counters.SetObject();
+        const std::vector<uint32_t> h_counters =
+            Instrumentation::get().read_counters();
+        for (uint32_t c = 0; c < h_counters.size(); ++c) {
+            add_member(counter_to_string(Counter(c)), h_counters[c], counters);
+        }
+        subdoc.AddMember("Counters", counters, m_doc.GetAllocator());
+
+        // the stage cycles are summed over all blocks and so the time is the
+        // total block-time (not the wall-clock time) spent in every stage
+        int device = 0, clock_khz = 0;
+        CUDA_ERROR(cudaGetDevice(&device));
+        CUDA_ERROR(
+            cudaDeviceGetAttribute(&clock_khz, cudaDevAttrClockRate, device));
+
+        rapidjson::Document stages(&m_doc.GetAllocator());
+        stages.SetObject();
+        const std::vector<unsigned long long> h_cycles =
+            Instrumentation::get().read_stage_cycles();
+        for (uint32_t s = 0; s < h_cycles.size(); ++s) {
+            rapidjson::Document sdoc(&m_doc.GetAllocator());
+            sdoc.SetObject();
+            add_member("cycles", size_t(h_cycles[s]), sdoc);
+            add_member("block_time (ms)",
+                       clock_khz > 0 ? double(h_cycles[s]) / clock_khz : 0.0,
+                       sdoc);
+            rapidjson::Value key(stage_to_string(Stage(s)).c_str(),
+                                 m_doc.GetAllocator());
+            stages.AddMember(key, sdoc, m_doc.GetAllocator());
+        }
+        subdoc.AddMember("Stages", stages, m_doc.GetAllocator());
+
+        rapidjson::Value key(json_member_name.c_str(), m_doc.GetAllocator());
+        m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
+    }
+
     // add test using TestData
     void add_test(const TestData& test_data)
     {
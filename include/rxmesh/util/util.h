@@ -1,6 +1,7 @@
 #pragma once
 #include <cuda_runtime.h>
 #include <algorithm>
+#include <functional>
 #include <numeric>
 #include <random>
 #include "rxmesh/util/macros.h"
@@ -270,6 +271,51 @@ inline void inplace_remove_duplicates_sorted(std::vector<T>& sort_vec)
     sort_vec.resize(next_unique_id);
 }
 
+/**
+ * @brief sort a vector using OpenMP threads. The vector is split into
+ * num_threads chunks that are sorted concurrently and then merged pairwise
+ * in log(num_threads) rounds
+ * @param vec vector to be sorted in-place
+ * @param num_threads number of threads to use. If it is less than 2 or the
+ * vector is small, std::sort is used
+ * @param comp comparison function
+ */
+template <typename T, typename CompT = std::less<T>>
+inline void parallel_sort(std::vector<T>& vec,
+                          const int       num_threads,
+                          CompT           comp = CompT())
+{
+    const size_t n = vec.size();
+    if (num_threads < 2 || n < 16384) {
+        std::sort(vec.begin(), vec.end(), comp);
+        return;
+    }
+
+    const int           num_chunks = num_threads;
+    std::vector<size_t> bounds(num_chunks + 1);
+    for (int c = 0; c <= num_chunks; ++c) {
+        bounds[c] = (n * size_t(c)) / size_t(num_chunks);
+    }
+
+#pragma omp parallel for num_threads(num_threads)
+    for (int c = 0; c < num_chunks; ++c) {
+        std::sort(vec.begin() + bounds[c], vec.begin() + bounds[c + 1], comp);
+    }
+
+    for (int w = 1; w < num_chunks; w *= 2) {
+#pragma omp parallel for num_threads(num_threads)
+        for (int c = 0; c < num_chunks; c += 2 * w) {
+            if (c + w < num_chunks) {
+                std::inplace_merge(vec.begin() + bounds[c],
+                                   vec.begin() + bounds[c + w],
+                                   vec.begin() +
+                                       bounds[std::min(c + 2 * w, num_chunks)],
+                                   comp);
+            }
+        }
+    }
+}
+
 /**
  * @brief Given the vertex coordinates and face indices, shuffle the input mesh
  * randomly --- both vertices and face indices
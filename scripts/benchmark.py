@@ -0,0 +1,337 @@
+#!/usr/bin/env python3
+"""Run the RXMesh apps and microbenchmarks over a set of datasets and patch
+sizes, collect their JSON reports into a single results file, and compare
+against a stored baseline.
+
+Every benchmark in the config (see benchmark.json) is an executable along with
+an argument template where {input}, {output}, {num_run}, {patch_size}, and
+{device_id} are substituted. The patch sizes are only swept for benchmarks
+whose arguments use {patch_size}. A benchmark may also sweep its own
+parameters with "sweep": {"name": [values]} where {name} is substituted in
+its arguments.
+
+Samples are collected in one of two ways:
+  * in_process_repetitions: the executable is run once with -num_run and every
+    report test (i.e., a JSON object with "time (ms)") provides the samples
+  * otherwise, the executable is run `repetitions` times and every report
+    test provides its samples of every run
+Additionally, every member listed in "metrics" (where nested members are
+separated by '/') provides one sample per run. In all cases, the first sample
+is the cold run and the `warmup` first samples are excluded from the warm
+statistics.
+
+Usage:
+  python3 benchmark.py --bin build/bin --output results.json
+  python3 benchmark.py --bin build/bin --save-baseline baseline.json
+  python3 benchmark.py --bin build/bin --baseline baseline.json
+
+When a baseline is given, the exit code is 1 if the warm median of any result
+is slower than the baseline by more than the threshold (5% by default) so it
+could be used directly as a CI (regression) check.
+"""
+
+import argparse
+import glob
+import itertools
+import json
+import math
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+
+SCHEMA_VERSION = 1
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="RXMesh benchmark harness with baseline comparison")
+    parser.add_argument("--bin", default=os.path.join(ROOT, "build", "bin"),
+                        help="directory that contains the executables")
+    parser.add_argument("--config",
+                        default=os.path.join(ROOT, "scripts",
+                                             "benchmark.json"),
+                        help="benchmark configuration file")
+    parser.add_argument("--output", default="benchmark_results.json",
+                        help="results file")
+    parser.add_argument("--baseline", default=None,
+                        help="baseline results to compare against")
+    parser.add_argument("--save-baseline", default=None,
+                        help="also write the results as a baseline")
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="relative slowdown that is reported as a "
+                             "regression (overrides the config)")
+    parser.add_argument("--filter", default=None,
+                        help="comma-separated list of benchmark names to run")
+    parser.add_argument("--datasets", default=None,
+                        help="comma-separated list of datasets (overrides "
+                             "the config)")
+    parser.add_argument("--patch-sizes", default=None,
+                        help="comma-separated list of patch sizes (overrides "
+                             "the config)")
+    parser.add_argument("--repetitions", type=int, default=None,
+                        help="number of repetitions (overrides the config)")
+    parser.add_argument("--device-id", type=int, default=0,
+                        help="GPU device ID")
+    return parser.parse_args()
+
+
+def split_list(s):
+    return [x.strip() for x in s.split(",") if x.strip()]
+
+
+def find_executable(bin_dir, name):
+    for candidate in (name, name + ".exe"):
+        path = os.path.join(bin_dir, candidate)
+        if os.path.isfile(path):
+            return path
+    return None
+
+
+def dataset_path(dataset):
+    if os.path.isabs(dataset):
+        return dataset
+    return os.path.join(ROOT, dataset)
+
+
+def dataset_name(dataset):
+    return os.path.splitext(os.path.basename(dataset))[0]
+
+
+def uses(bench, key):
+    return any("{" + key + "}" in a for a in bench["args"])
+
+
+def sweep_params(bench):
+    """All the combinations of the benchmark's own parameters"""
+    sweep = bench.get("sweep", {})
+    names = sorted(sweep)
+    return [dict(zip(names, values))
+            for values in itertools.product(*[sweep[n] for n in names])]
+
+
+def run_once(exe, bench, dataset, patch_size, params, num_run, device_id):
+    """Run the executable once in a fresh output folder and return the list
+    of JSON reports it wrote"""
+    out_dir = tempfile.mkdtemp(prefix="rxmesh_bench_")
+    try:
+        args = [a.format(input=dataset_path(dataset),
+                         output=out_dir,
+                         num_run=num_run,
+                         patch_size=patch_size,
+                         device_id=device_id,
+                         **params) for a in bench["args"]]
+        cmd = [exe] + args
+        print("  " + " ".join(cmd), flush=True)
+        proc = subprocess.run(cmd, cwd=os.path.dirname(exe),
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT,
+                              universal_newlines=True)
+        if proc.returncode != 0:
+            print(proc.stdout)
+            raise RuntimeError("{} exited with {}".format(
+                bench["name"], proc.returncode))
+
+        reports = []
+        for f in sorted(glob.glob(os.path.join(out_dir, "**", "*.json"),
+                                  recursive=True)):
+            with open(f) as fp:
+                reports.append(json.load(fp))
+        if not reports:
+            raise RuntimeError("{} did not write any report".format(
+                bench["name"]))
+        return reports
+    finally:
+        shutil.rmtree(out_dir, ignore_errors=True)
+
+
+def report_tests(report):
+    """{test name: [time (ms) samples]} of the report"""
+    tests = {}
+    for key, value in report.items():
+        if isinstance(value, dict) and isinstance(value.get("time (ms)"),
+                                                  list):
+            tests[key] = [float(t) for t in value["time (ms)"]]
+    return tests
+
+
+def report_metrics(report, metrics):
+    """{metric name: value} of the scalar metrics found in the report"""
+    found = {}
+    for m in metrics:
+        v = report
+        for key in m.split("/"):
+            v = v.get(key) if isinstance(v, dict) else None
+        if isinstance(v, (int, float)) and not isinstance(v, bool):
+            found[m] = float(v)
+    return found
+
+
+def record_name(report):
+    return report.get("Record Name", "report")
+
+
+def summarize(samples, warmup):
+    warm = samples[warmup:] if len(samples) > warmup else samples
+    return {
+        "cold_ms": samples[0],
+        "warm_samples_ms": warm,
+        "median_ms": statistics.median(warm),
+        "mean_ms": statistics.mean(warm),
+        "stddev_ms": statistics.stdev(warm) if len(warm) > 1 else 0.0,
+        "min_ms": min(warm),
+        "num_samples": len(samples),
+    }
+
+
+def run_benchmark(exe, bench, dataset, patch_size, params, config,
+                  device_id):
+    """Return {(record, test): [samples]} for one configuration"""
+    reps = config["repetitions"]
+    metrics = bench.get("metrics", [])
+    in_process = bench.get("in_process_repetitions", False)
+    samples = {}
+    for _ in range(1 if in_process else reps):
+        for report in run_once(exe, bench, dataset, patch_size, params,
+                               reps if in_process else 1, device_id):
+            rec = record_name(report)
+            for test, times in report_tests(report).items():
+                samples.setdefault((rec, test), []).extend(times)
+            for m, v in report_metrics(report, metrics).items():
+                samples.setdefault((rec, m), []).append(v)
+    return samples
+
+
+def result_key(r):
+    params = ["{}={}".format(k, v)
+              for k, v in sorted(r.get("params", {}).items())]
+    return "/".join([r["benchmark"], r["record"], r["test"], r["dataset"],
+                     str(r["patch_size"])] + params)
+
+
+def compare(results, baseline, threshold):
+    """Print the comparison and return the number of regressions"""
+    base = {result_key(r): r for r in baseline.get("results", [])}
+    num_regressions = 0
+    print("\n{:<70} {:>10} {:>10} {:>8}".format(
+        "result", "base (ms)", "new (ms)", "change"))
+    for r in results:
+        key = result_key(r)
+        if key not in base:
+            print("{:<70} {:>10} {:>10.3f} {:>8}".format(
+                key, "-", r["median_ms"], "new"))
+            continue
+        b = base[key]["median_ms"]
+        n = r["median_ms"]
+        change = (n - b) / b if b > 0 else 0.0
+        flag = ""
+        if change > threshold:
+            flag = " REGRESSION"
+            num_regressions += 1
+        print("{:<70} {:>10.3f} {:>10.3f} {:>+7.1f}%{}".format(
+            key, b, n, 100.0 * change, flag))
+    missing = set(base) - set(result_key(r) for r in results)
+    for key in sorted(missing):
+        print("{:<70} missing from the new results".format(key))
+    return num_regressions
+
+
+def main():
+    args = parse_args()
+
+    with open(args.config) as fp:
+        config = json.load(fp)
+
+    if args.datasets is not None:
+        config["datasets"] = split_list(args.datasets)
+    if args.patch_sizes is not None:
+        config["patch_sizes"] = [int(p) for p in split_list(args.patch_sizes)]
+    if args.repetitions is not None:
+        config["repetitions"] = args.repetitions
+    config.setdefault("repetitions", 10)
+    config.setdefault("warmup", 1)
+    threshold = args.threshold if args.threshold is not None else \
+        config.get("threshold", 0.05)
+
+    names = split_list(args.filter) if args.filter else None
+
+    results = []
+    failures = []
+    for bench in config["benchmarks"]:
+        if names is not None and bench["name"] not in names:
+            continue
+        exe = find_executable(args.bin, bench["exe"])
+        if exe is None:
+            print("Skipping {}: {} not found in {}".format(
+                bench["name"], bench["exe"], args.bin))
+            continue
+
+        datasets = bench.get("datasets", config["datasets"])
+        patch_sizes = config["patch_sizes"] if uses(bench, "patch_size") \
+            else ["default"]
+
+        for dataset, patch_size, params in itertools.product(
+                datasets, patch_sizes, sweep_params(bench)):
+            print("{} dataset= {} patch_size= {} {}".format(
+                bench["name"], dataset_name(dataset), patch_size,
+                params), flush=True)
+            try:
+                samples = run_benchmark(exe, bench, dataset, patch_size,
+                                        params, config, args.device_id)
+            except RuntimeError as e:
+                print("  FAILED: {}".format(e))
+                failures.append(bench["name"])
+                continue
+            for (rec, test), s in sorted(samples.items()):
+                if not s or any(math.isnan(x) for x in s):
+                    continue
+                r = {
+                    "benchmark": bench["name"],
+                    "record": rec,
+                    "test": test,
+                    "dataset": dataset_name(dataset),
+                    "patch_size": patch_size,
+                    "params": params,
+                }
+                r.update(summarize(s, config["warmup"]))
+                results.append(r)
+
+    doc = {
+        "schema_version": SCHEMA_VERSION,
+        "repetitions": config["repetitions"],
+        "warmup": config["warmup"],
+        "results": results,
+    }
+    with open(args.output, "w") as fp:
+        json.dump(doc, fp, indent=4)
+    print("\nWrote {} results to {}".format(len(results), args.output))
+
+    if args.save_baseline:
+        with open(args.save_baseline, "w") as fp:
+            json.dump(doc, fp, indent=4)
+        print("Wrote baseline to {}".format(args.save_baseline))
+
+    ret = 0
+    if failures:
+        print("Failed benchmarks: {}".format(", ".join(sorted(
+            set(failures)))))
+        ret = 1
+
+    if args.baseline:
+        with open(args.baseline) as fp:
+            baseline = json.load(fp)
+        num_regressions = compare(results, baseline, threshold)
+        if num_regressions > 0:
+            print("\n{} result(s) are more than {:.0f}% slower than the "
+                  "baseline".format(num_regressions, 100.0 * threshold))
+            ret = 1
+
+    return ret
+
+
+if __name__ == "__main__":
+    sys.exit(main())
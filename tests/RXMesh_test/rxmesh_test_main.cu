@@ -10,6 +10,7 @@ struct RXMeshTestArg
 {
     uint32_t    num_run       = 1;
     uint32_t    device_id     = 0;
+    uint32_t    patch_size    = 512;
     std::string obj_file_name = STRINGIFY(INPUT_DIR) "sphere3.obj";
     std::string output_folder = STRINGIFY(OUTPUT_DIR);
     int         argc          = argc;
@@ -37,6 +38,33 @@ struct RXMeshTestArg
 #include "test_dense_matrix.cuh"
 #include "test_export.cuh"
 #include "test_svd.cuh"
+#include "test_device_build.cuh"
+#include "test_mesh_cache.cuh"
+#include "test_import_mesh.cuh"
+#include "test_streaming.cuh"
+#include "test_multi_gpu.cuh"
+#include "test_cuda_graph.cuh"
+#include "test_query_chain.cuh"
+#include "test_patch_coloring.cuh"
+#include "test_cavity_ops.cuh"
+#include "test_query_cache.cuh"
+#include "test_warp_queries.cuh"
+#include "test_k_ring.cuh"
+#include "test_frontier.cuh"
+#include "test_instrumentation.cuh"
+#include "test_benchmark.cuh"
+#include "test_launch_planner.cuh"
+#include "test_batch.cuh"
+#include "test_multi_stream.cuh"
+#include "test_geodesic.cuh"
+#include "test_bvh.cuh"
+#include "test_derived_attributes.cuh"
+#include "test_qem.cuh"
+#include "test_deterministic.cuh"
+#include "test_mesh_writer.cuh"
+#include "test_bounded_queries.cuh"
+#include "test_patcher.cuh"
+#include "test_compact.cuh"
 // clang-format on
 
 int main(int argc, char** argv)
@@ -57,8 +85,9 @@ int main(int argc, char** argv)
                         "              Hint: Only accept OBJ files\n"
                         " -o:          JSON file output folder. Default is {} \n"
                         " -num_run:    Number of iterations for performance testing. Default is {} \n"
-                        " -device_id:  GPU device ID. Default is {}",
-            rxmesh_args.obj_file_name, rxmesh_args.output_folder ,rxmesh_args.num_run,rxmesh_args.device_id);
+                        " -device_id:  GPU device ID. Default is {}\n"
+                        " -patch_size: Patch size used by the queries tests and the benchmarks. Default is {}",
+            rxmesh_args.obj_file_name, rxmesh_args.output_folder ,rxmesh_args.num_run,rxmesh_args.device_id, rxmesh_args.patch_size);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -81,6 +110,10 @@ int main(int argc, char** argv)
             rxmesh_args.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-patch_size")) {
+            rxmesh_args.patch_size =
+                atoi(get_cmd_option(argv, argv + argc, "-patch_size"));
+        }
     }
 
 
@@ -88,6 +121,7 @@ int main(int argc, char** argv)
     RXMESH_TRACE("output_folder= {}", rxmesh_args.output_folder);
     RXMESH_TRACE("num_run= {}", rxmesh_args.num_run);
     RXMESH_TRACE("device_id= {}", rxmesh_args.device_id);
+    RXMESH_TRACE("patch_size= {}", rxmesh_args.patch_size);
 
     cuda_query(rxmesh_args.device_id);
 
@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include "rxmesh/attribute.h"
+#include "rxmesh/attribute_double_buffer.h"
+#include "rxmesh/attribute_storage.h"
 #include "rxmesh/reduce_handle.h"
 #include "rxmesh/util/macros.h"
 
@@ -101,6 +103,41 @@ TEST(Attribute, Dot)
     EXPECT_FLOAT_EQ(output, v1_val * v2_val * rx.get_num_vertices());
 }
 
+TEST(Attribute, MultiDot)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto v1_attr = rx.add_vertex_attribute<float>("v1", 3, rxmesh::DEVICE);
+    auto v2_attr = rx.add_vertex_attribute<float>("v2", 3, rxmesh::DEVICE);
+
+    const float v1_val(2.0);
+    const float v2_val(3.0);
+
+    populate<float>(rx, *v1_attr, *v2_attr, v1_val, v2_val);
+
+    ReduceHandle reduce_handle(*v1_attr);
+
+    float output[3];
+    reduce_handle.multi_dot(
+        {{v1_attr.get(), v1_attr.get()},
+         {v1_attr.get(), v2_attr.get()},
+         {v2_attr.get(), v2_attr.get()}},
+        output);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    const float n = rx.get_num_vertices();
+
+    EXPECT_FLOAT_EQ(output[0], v1_val * v1_val * n);
+    EXPECT_FLOAT_EQ(output[1], v1_val * v2_val * n);
+    EXPECT_FLOAT_EQ(output[2], v2_val * v2_val * n);
+
+    // should match the single-operand reduction
+    EXPECT_FLOAT_EQ(output[1], reduce_handle.dot(*v1_attr, *v2_attr));
+}
+
 TEST(Attribute, Reduce)
 {
     using namespace rxmesh;
@@ -178,4 +215,221 @@ TEST(Attribute, AddingAndRemoving)
     // this is not neccessary in general but we are just testing the
     // functionality here
     rx.remove_attribute(attr_name);
-}
\ No newline at end of file
+}
+TEST(Attribute, Pool)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    AttributePool& pool = rx.get_attribute_pool();
+
+    // a device-only attribute gets its host mirror on the first move to the
+    // host and the values survive the round trip
+    auto attr = rx.add_vertex_attribute<float>("tmp", 3, DEVICE);
+    EXPECT_FALSE(attr->is_host_allocated());
+    attr->reset(7.f, DEVICE);
+    attr->move(DEVICE, HOST);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_TRUE(attr->is_host_allocated());
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ((*attr)(vh, i), 7.f);
+        }
+    });
+    rx.remove_attribute("tmp");
+
+    // attributes of the same shape re-use the released device memory
+    const uint32_t num_allocations = pool.get_num_allocations();
+    EXPECT_GT(pool.get_num_cached(), 0u);
+    for (int i = 0; i < 10; ++i) {
+        auto t = rx.add_vertex_attribute<float>("tmp", 3, DEVICE);
+        t->reset(float(i), DEVICE);
+        rx.remove_attribute("tmp");
+    }
+    EXPECT_EQ(pool.get_num_allocations(), num_allocations);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    pool.clear();
+    EXPECT_EQ(pool.get_num_cached(), 0u);
+    EXPECT_EQ(pool.get_cached_bytes(), size_t(0));
+}
+
+TEST(Attribute, ReducedPrecision)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    glm::vec3 lower, upper;
+    rx.bounding_box(lower, upper);
+    const float extent = glm::length(upper - lower);
+
+    // fp16 and bf16 copies converted on the device
+    auto h_coords = *rx.add_vertex_attribute<__half>("h", 3, LOCATION_ALL, AoS);
+    auto b_coords =
+        *rx.add_vertex_attribute<__nv_bfloat16>("b", 3, LOCATION_ALL, AoS);
+    convert_attribute(rx, coords, h_coords, DEVICE);
+    convert_attribute(rx, coords, b_coords, DEVICE);
+    h_coords.move(DEVICE, HOST);
+    b_coords.move(DEVICE, HOST);
+
+    // quantized coordinates
+    QuantizedCoordinates q_coords(rx, coords, "q");
+
+    // decode on the device into float
+    auto decoded = *rx.add_vertex_attribute<float>("decoded", 3);
+    rx.for_each_vertex(
+        DEVICE, [q_coords, decoded] __device__(const VertexHandle vh) {
+            store_vec3(decoded, vh, q_coords(vh));
+        });
+    decoded.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const vec3<float> v = load_vec3(coords, vh);
+        const vec3<float> h = load_vec3(h_coords, vh);
+        const vec3<float> b = load_vec3(b_coords, vh);
+        const vec3<float> q = load_vec3(decoded, vh);
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_NEAR(h[i], v[i], 1e-3f * extent);
+            EXPECT_NEAR(b[i], v[i], 1e-2f * extent);
+            EXPECT_NEAR(q[i], v[i], q_coords.max_error(i) + 1e-6f);
+        }
+    });
+
+    // round trip through a dense matrix
+    auto mat = to_dense_matrix(rx, h_coords);
+    EXPECT_EQ(mat->rows(), rx.get_num_vertices());
+    EXPECT_EQ(mat->cols(), 3);
+    auto h_back = *rx.add_vertex_attribute<__half>("h_back", 3, HOST, AoS);
+    from_dense_matrix(rx, *mat, h_back);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(__half2float(h_back(vh, i)),
+                      __half2float(h_coords(vh, i)));
+        }
+    });
+}
+
+TEST(Attribute, VectorizedAccess)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    EXPECT_EQ(VertexAttribute<float>::element_stride(3, AoSPadded), 4u);
+    EXPECT_EQ(VertexAttribute<float>::element_stride(2, AoSPadded), 2u);
+    EXPECT_EQ(VertexAttribute<float>::element_stride(5, AoSPadded), 8u);
+    EXPECT_EQ(VertexAttribute<float>::element_stride(3, AoS), 3u);
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    auto f_padded =
+        *rx.add_vertex_attribute<float>("f_padded", 3, LOCATION_ALL, AoSPadded);
+    auto d_padded = *rx.add_vertex_attribute<double>(
+        "d_padded", 3, LOCATION_ALL, AoSPadded);
+    auto f_soa = *rx.add_vertex_attribute<float>("f_soa", 2, LOCATION_ALL);
+
+    rx.for_each_vertex(
+        DEVICE,
+        [coords, f_padded, d_padded, f_soa] __device__(const VertexHandle vh) {
+            const vec3<float> v = coords.load_vec<3>(vh);
+            f_padded.store_vec<3>(vh, 2.f * v);
+            d_padded.store_vec<3>(vh, vec3<double>(v));
+            f_soa.store_vec<2>(vh, vec2<float>(v[0], v[1]));
+
+            // read back with vector loads
+            const vec3<float> f = f_padded.load_vec<3>(vh);
+            const vec2<float> s = f_soa.load_vec<2>(vh);
+            f_soa.store_vec<2>(vh, s + vec2<float>(f[0], f[1]));
+        });
+
+    f_padded.move(DEVICE, HOST);
+    d_padded.move(DEVICE, HOST);
+    f_soa.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const vec3<float>  v = coords.load_vec<3>(vh);
+        const vec3<float>  f = f_padded.load_vec<3>(vh);
+        const vec3<double> d = d_padded.load_vec<3>(vh);
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_FLOAT_EQ(f[i], 2.f * v[i]);
+            EXPECT_FLOAT_EQ(float(d[i]), v[i]);
+        }
+        for (int i = 0; i < 2; ++i) {
+            EXPECT_FLOAT_EQ(f_soa(vh, i), 3.f * v[i]);
+        }
+    });
+}
+
+TEST(Attribute, AsyncTransfer)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
+
+    // pin through the attribute owned by the mesh. The copy used by the
+    // kernels shares the host memory and so it sees it pinned as well
+    auto attr_ptr = rx.add_vertex_attribute<float>("attr", 3);
+    auto attr     = *attr_ptr;
+    attr_ptr->pin_host_memory();
+    EXPECT_TRUE(attr_ptr->is_host_pinned());
+    EXPECT_TRUE(attr.is_host_pinned());
+
+    attr.reset(5.f, DEVICE, stream);
+    attr.move_async(DEVICE, HOST, stream);
+    attr.wait_transfer();
+    EXPECT_TRUE(attr.is_transfer_done());
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(attr(vh, i), 5.f);
+        }
+    });
+
+    // export every frame while the next one is computed
+    AttributeDoubleBuffer<float, VertexHandle> out(rx, attr, "out");
+    for (int frame = 0; frame < 4; ++frame) {
+        rx.for_each_vertex(
+            DEVICE,
+            [attr, frame] __device__(const VertexHandle vh) {
+                for (uint32_t i = 0; i < 3; ++i) {
+                    attr(vh, i) = float(frame);
+                }
+            },
+            stream);
+        out.snapshot(attr, stream);
+
+        if (frame > 0) {
+            const auto& prev = out.back();
+            rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+                for (uint32_t i = 0; i < 3; ++i) {
+                    EXPECT_EQ(prev(vh, i), float(frame - 1));
+                }
+            });
+        }
+    }
+
+    const auto& last = out.front();
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(last(vh, i), 3.f);
+        }
+    });
+    EXPECT_EQ(out.get_num_snapshots(), 4u);
+
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+    CUDA_ERROR(cudaStreamDestroy(stream));
+
+    // releasing the attribute resets the state it shares with its copies
+    // but does not leave them with a dangling state
+    attr_ptr->release();
+    EXPECT_FALSE(attr.is_host_pinned());
+    EXPECT_TRUE(attr.is_transfer_done());
+}
@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/geometry_factory.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_batch.h"
+#include "rxmesh/util/import_obj.h"
+
+template <uint32_t blockThreads>
+__global__ static void batch_valence(const rxmesh::Context             context,
+                                     const rxmesh::BatchInfo           batch,
+                                     rxmesh::VertexAttribute<uint32_t> valence,
+                                     rxmesh::VertexAttribute<uint32_t> mesh)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+            mesh(vh)    = batch.mesh_id(vh);
+        });
+}
+
+TEST(RXMeshBatch, Batch)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshBatch::FVBatch       fv_batch;
+    RXMeshBatch::VerticesBatch verts_batch;
+
+    // two copies of sphere3 and two planes of different sizes
+    for (int i = 0; i < 2; ++i) {
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+        ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+        fv_batch.push_back(fv);
+        verts_batch.push_back(verts);
+    }
+    for (uint32_t n : {10, 40}) {
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+        create_plane(verts, fv, n, n);
+        fv_batch.push_back(fv);
+        verts_batch.push_back(verts);
+    }
+
+    RXMeshBatch rx(fv_batch, verts_batch);
+
+    const uint32_t num_meshes = rx.get_num_meshes();
+    ASSERT_EQ(num_meshes, fv_batch.size());
+
+    uint32_t num_vertices = 0, num_faces = 0;
+    for (uint32_t m = 0; m < num_meshes; ++m) {
+        EXPECT_EQ(rx.get_mesh_num_vertices(m), verts_batch[m].size());
+        EXPECT_EQ(rx.get_mesh_num_faces(m), fv_batch[m].size());
+        EXPECT_FALSE(rx.get_mesh_patches(m).empty());
+        num_vertices += verts_batch[m].size();
+        num_faces += fv_batch[m].size();
+
+        for (uint32_t p : rx.get_mesh_patches(m)) {
+            EXPECT_EQ(rx.get_patch_mesh(p), m);
+        }
+    }
+    EXPECT_EQ(rx.get_num_vertices(), num_vertices);
+    EXPECT_EQ(rx.get_num_faces(), num_faces);
+
+    // every face maps back to its input mesh
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+        auto [m, f] = rx.map_to_mesh(fh);
+        ASSERT_LT(m, num_meshes);
+        ASSERT_LT(f, fv_batch[m].size());
+    });
+
+    // the coordinates are the ones of the input mesh
+    auto coords = rx.get_input_vertex_coordinates();
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        auto [m, v] = rx.map_to_mesh(vh);
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ((*coords)(vh, i), verts_batch[m][v][i]);
+        }
+    });
+
+    // a single query over all meshes
+    auto valence = *rx.add_vertex_attribute<uint32_t>("valence", 1);
+    auto mesh    = *rx.add_vertex_attribute<uint32_t>("mesh", 1);
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box({Op::VV}, lb, (void*)batch_valence<blockThreads>);
+    batch_valence<blockThreads>
+        <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+            rx.get_context(), rx.get_batch_info(), valence, mesh);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    mesh.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_EQ(mesh(vh), rx.map_to_mesh(vh).first);
+    });
+
+    // per-mesh reductions: the sum of the valence is twice the number of
+    // edges and the sum of ones is the number of vertices
+    VertexReduceHandle<uint32_t> valence_rh(valence);
+    std::vector<uint32_t> valence_sum = rx.sum_per_mesh(valence_rh, valence);
+
+    auto ones = *rx.add_vertex_attribute<uint32_t>("ones", 1);
+    ones.reset(1, DEVICE);
+    std::vector<uint32_t> count = rx.sum_per_mesh(valence_rh, ones);
+
+    std::vector<uint32_t> max_valence(num_meshes);
+    rx.reduce_per_mesh(
+        valence_rh, valence, cub::Max(), uint32_t(0), max_valence.data());
+
+    for (uint32_t m = 0; m < num_meshes; ++m) {
+        EXPECT_EQ(valence_sum[m], 2 * rx.get_mesh_num_edges(m));
+        EXPECT_EQ(count[m], rx.get_mesh_num_vertices(m));
+        EXPECT_GT(max_valence[m], 0u);
+    }
+    EXPECT_EQ(valence_sum[0], valence_sum[1]);
+
+    // per-mesh sum of the coordinates
+    VertexReduceHandle<float> coords_rh(*coords);
+    for (uint32_t i = 0; i < 3; ++i) {
+        std::vector<float> sum = rx.sum_per_mesh(coords_rh, *coords, i);
+        for (uint32_t m = 0; m < num_meshes; ++m) {
+            double gold = 0;
+            for (const auto& v : verts_batch[m]) {
+                gold += v[i];
+            }
+            EXPECT_NEAR(sum[m], gold, 1e-3 * (1.0 + std::abs(gold)));
+        }
+    }
+}
+
+TEST(RXMeshBatch, TinyMeshes)
+{
+    using namespace rxmesh;
+
+    // all meshes together have fewer faces than the patch size but every
+    // mesh still gets its own patches
+    RXMeshBatch::FVBatch       fv_batch;
+    RXMeshBatch::VerticesBatch verts_batch;
+    for (uint32_t i = 0; i < 8; ++i) {
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+        create_plane(verts, fv, 3, 3);
+        fv_batch.push_back(fv);
+        verts_batch.push_back(verts);
+    }
+
+    RXMeshBatch rx(fv_batch, verts_batch);
+
+    ASSERT_EQ(rx.get_num_meshes(), 8u);
+    EXPECT_GE(rx.get_num_patches(), 8u);
+
+    auto ones = *rx.add_face_attribute<float>("ones", 1);
+    ones.reset(1.f, DEVICE);
+
+    FaceReduceHandle<float> rh(ones);
+    std::vector<float>      count = rx.sum_per_mesh(rh, ones);
+    for (uint32_t m = 0; m < rx.get_num_meshes(); ++m) {
+        EXPECT_FALSE(rx.get_mesh_patches(m).empty());
+        EXPECT_EQ(count[m], float(fv_batch[m].size()));
+    }
+}
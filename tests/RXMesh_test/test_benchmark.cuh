@@ -0,0 +1,294 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/sparse_matrix.cuh"
+#include "rxmesh/patch_scheduler.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+// Microbenchmarks of the core building blocks. They are disabled by default
+// and are run by scripts/benchmark.py with
+// --gtest_also_run_disabled_tests --gtest_filter=Benchmark.*
+// Every benchmark repeats its kernel rxmesh_args.num_run times and writes all
+// the timings (the first one being the cold run) in a Report
+
+static rxmesh::Report benchmark_report(const std::string&          name,
+                                       const rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    Report report("Benchmark_" + name);
+    report.command_line(rxmesh_args.argc, rxmesh_args.argv);
+    report.device();
+    report.system();
+    report.model_data(rxmesh_args.obj_file_name, rx);
+    report.add_member("method", std::string("RXMesh"));
+    report.add_member("patch_size", rxmesh_args.patch_size);
+    return report;
+}
+
+static void benchmark_write(rxmesh::Report& report, const std::string& name)
+{
+    using namespace rxmesh;
+    report.write(rxmesh_args.output_folder + "/rxmesh",
+                 "Benchmark_" + name + "_" +
+                     extract_file_name(rxmesh_args.obj_file_name));
+}
+
+template <uint32_t blockThreads>
+__global__ static void benchmark_for_each(
+    const rxmesh::Context          context,
+    rxmesh::VertexAttribute<float> attr)
+{
+    using namespace rxmesh;
+    for_each<Op::V, blockThreads>(
+        context, [&](VertexHandle& vh) { attr(vh) += 1.f; });
+}
+
+template <uint32_t blockThreads>
+__global__ static void benchmark_lp_hashtable(const rxmesh::Context context,
+                                              uint32_t*             d_sum)
+{
+    // map every not-owned vertex of the patch to its owner patch i.e., one
+    // LP hashtable (and maybe stash) lookup per ribbon vertex
+    using namespace rxmesh;
+    const uint32_t   p  = blockIdx.x;
+    const PatchInfo& pi = context.m_patches_info[p];
+
+    uint32_t sum = 0;
+    for (uint16_t v = threadIdx.x; v < pi.num_vertices[0]; v += blockThreads) {
+        if (!detail::is_deleted(v, pi.active_mask_v) &&
+            !detail::is_owned(v, pi.owned_mask_v)) {
+            sum += context.get_owner_handle(VertexHandle(p, v)).local_id();
+        }
+    }
+    ::atomicAdd(d_sum, sum);
+}
+
+__global__ static void benchmark_scheduler(rxmesh::PatchScheduler sch)
+{
+    // pop a patch and push it back as a block that failed to lock its
+    // neighbors would do
+    using namespace rxmesh;
+    if (threadIdx.x == 0) {
+        const uint32_t pid = sch.pop();
+        if (pid != INVALID32) {
+            sch.push(pid);
+        }
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void benchmark_laplacian(const rxmesh::Context       context,
+                                           rxmesh::SparseMatrix<float> A_mat,
+                                           rxmesh::DenseMatrix<float>  B_mat)
+{
+    // diagonally dominant (shifted) graph Laplacian so that it could be
+    // factorized with Cholesky
+    using namespace rxmesh;
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                A_mat(vh, iter[i]) = -1.f;
+            }
+            A_mat(vh, vh) = float(iter.size()) + 1.f;
+            B_mat(vh, 0)  = 1.f;
+            B_mat(vh, 1)  = float(iter.size());
+            B_mat(vh, 2)  = float(vh.local_id());
+        });
+}
+
+TEST(Benchmark, DISABLED_ForEach)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name, "", rxmesh_args.patch_size);
+
+    auto attr = *rx.add_vertex_attribute<float>("attr", 1);
+    attr.reset(0, DEVICE);
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::V}, lb, (void*)benchmark_for_each<blockThreads>);
+
+    TestData td;
+    td.test_name   = "ForEach";
+    td.num_threads = lb.num_threads;
+    td.num_blocks  = lb.blocks;
+    for (uint32_t i = 0; i < rxmesh_args.num_run; ++i) {
+        GPUTimer timer;
+        timer.start();
+        benchmark_for_each<blockThreads>
+            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                rx.get_context(), attr);
+        timer.stop();
+        td.time_ms.push_back(timer.elapsed_millis());
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    Report report = benchmark_report("ForEach", rx);
+    report.add_test(td);
+    benchmark_write(report, "ForEach");
+}
+
+TEST(Benchmark, DISABLED_LPHashTable)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name, "", rxmesh_args.patch_size);
+
+    uint32_t* d_sum;
+    CUDA_ERROR(cudaMalloc((void**)&d_sum, sizeof(uint32_t)));
+
+    TestData td;
+    td.test_name   = "LPHashTable";
+    td.num_threads = blockThreads;
+    td.num_blocks  = rx.get_num_patches();
+    for (uint32_t i = 0; i < rxmesh_args.num_run; ++i) {
+        CUDA_ERROR(cudaMemset(d_sum, 0, sizeof(uint32_t)));
+        GPUTimer timer;
+        timer.start();
+        benchmark_lp_hashtable<blockThreads>
+            <<<rx.get_num_patches(), blockThreads>>>(rx.get_context(), d_sum);
+        timer.stop();
+        td.time_ms.push_back(timer.elapsed_millis());
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    GPU_FREE(d_sum);
+
+    Report report = benchmark_report("LPHashTable", rx);
+    report.add_test(td);
+    benchmark_write(report, "LPHashTable");
+}
+
+TEST(Benchmark, DISABLED_PatchScheduler)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name, "", rxmesh_args.patch_size);
+
+    const uint32_t num_patches = rx.get_num_patches();
+
+    PatchScheduler sch;
+    sch.init(num_patches);
+    sch.refill(num_patches);
+
+    TestData td;
+    td.test_name   = "PatchScheduler";
+    td.num_threads = 32;
+    td.num_blocks  = num_patches;
+    for (uint32_t i = 0; i < rxmesh_args.num_run; ++i) {
+        GPUTimer timer;
+        timer.start();
+        benchmark_scheduler<<<num_patches, 32>>>(sch);
+        timer.stop();
+        td.time_ms.push_back(timer.elapsed_millis());
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    sch.free();
+
+    Report report = benchmark_report("PatchScheduler", rx);
+    report.add_test(td);
+    benchmark_write(report, "PatchScheduler");
+}
+
+TEST(Benchmark, DISABLED_SpMV)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name, "", rxmesh_args.patch_size);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+
+    SparseMatrix<float> A_mat(rx);
+    DenseMatrix<float>  B_mat(rx, num_vertices, 3);
+    DenseMatrix<float>  ret_mat(rx, num_vertices, 3);
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)benchmark_laplacian<blockThreads>);
+    benchmark_laplacian<blockThreads>
+        <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+            rx.get_context(), A_mat, B_mat);
+
+    TestData td;
+    td.test_name = "SpMM";
+    for (uint32_t i = 0; i < rxmesh_args.num_run; ++i) {
+        GPUTimer timer;
+        timer.start();
+        A_mat.multiply(B_mat, ret_mat);
+        timer.stop();
+        td.time_ms.push_back(timer.elapsed_millis());
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    A_mat.release();
+    B_mat.release();
+    ret_mat.release();
+
+    Report report = benchmark_report("SpMV", rx);
+    report.add_test(td);
+    benchmark_write(report, "SpMV");
+}
+
+TEST(Benchmark, DISABLED_Solve)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name, "", rxmesh_args.patch_size);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+
+    SparseMatrix<float> A_mat(rx);
+    DenseMatrix<float>  B_mat(rx, num_vertices, 3);
+    DenseMatrix<float>  X_mat(rx, num_vertices, 3);
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)benchmark_laplacian<blockThreads>);
+    benchmark_laplacian<blockThreads>
+        <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+            rx.get_context(), A_mat, B_mat);
+
+    // the factorization is done once and so it is timed separately from the
+    // (repeated) solve
+    TestData td_factor, td_solve;
+    td_factor.test_name = "Factorize";
+    td_solve.test_name  = "Solve";
+
+    GPUTimer factor_timer;
+    factor_timer.start();
+    A_mat.pre_solve(Solver::CHOL, PermuteMethod::NSTDIS);
+    factor_timer.stop();
+    td_factor.time_ms.push_back(factor_timer.elapsed_millis());
+
+    for (uint32_t i = 0; i < rxmesh_args.num_run; ++i) {
+        GPUTimer timer;
+        timer.start();
+        A_mat.solve(B_mat, X_mat);
+        timer.stop();
+        td_solve.time_ms.push_back(timer.elapsed_millis());
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    A_mat.release();
+    B_mat.release();
+    X_mat.release();
+
+    Report report = benchmark_report("Solve", rx);
+    report.add_test(td_factor);
+    report.add_test(td_solve);
+    benchmark_write(report, "Solve");
+}
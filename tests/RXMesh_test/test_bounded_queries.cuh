@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads,
+          rxmesh::Op op,
+          typename IteratorT,
+          uint32_t maxValence>
+__global__ static void general_query_ids(
+    const rxmesh::Context             context,
+    const bool                        oriented,
+    rxmesh::VertexAttribute<uint32_t> size,
+    rxmesh::VertexAttribute<uint64_t> ids)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<op>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const IteratorT& iter) {
+            size(vh) = iter.size();
+            for (uint16_t i = 0; i < iter.size() && i < maxValence; ++i) {
+                ids(vh, i) = iter[i].unique_id();
+            }
+        },
+        oriented);
+}
+
+template <uint32_t blockThreads,
+          rxmesh::Op op,
+          uint32_t   maxValence,
+          bool       oriented>
+__global__ static void bounded_query_ids(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint32_t> size,
+    rxmesh::VertexAttribute<uint64_t> ids)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch_bounded<op, maxValence, oriented>(
+        block, shrd_alloc, [&](const VertexHandle& vh, const auto& iter) {
+            size(vh) = iter.size();
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                ids(vh, i) = iter[i].unique_id();
+            }
+        });
+}
+
+template <rxmesh::Op op, typename IteratorT, uint32_t maxValence, bool oriented>
+void test_bounded_query(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    ASSERT_TRUE(rx.is_valence_bounded(maxValence, oriented));
+
+    auto size_gt = *rx.add_vertex_attribute<uint32_t>("size_gt", 1);
+    auto ids_gt  = *rx.add_vertex_attribute<uint64_t>("ids_gt", maxValence);
+    auto size    = *rx.add_vertex_attribute<uint32_t>("size", 1);
+    auto ids     = *rx.add_vertex_attribute<uint64_t>("ids", maxValence);
+    size.reset(0, LOCATION_ALL);
+    ids.reset(0, LOCATION_ALL);
+
+    auto general = general_query_ids<blockThreads, op, IteratorT, maxValence>;
+    auto bounded = bounded_query_ids<blockThreads, op, maxValence, oriented>;
+
+    LaunchBox<blockThreads> lb_general, lb_bounded;
+    rx.prepare_launch_box({op}, lb_general, (void*)general, oriented);
+    rx.prepare_launch_box_bounded(
+        {op}, maxValence, lb_bounded, (void*)bounded, oriented);
+
+    // the rows are smaller than the transpose of the general VV
+    if (op == Op::VV && !oriented) {
+        EXPECT_LT(lb_bounded.smem_bytes_dyn, lb_general.smem_bytes_dyn);
+    }
+
+    rx.run_query_kernel(lb_general, general, NULL, oriented, size_gt, ids_gt);
+    rx.run_query_kernel(lb_bounded, bounded, NULL, size, ids);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    size_gt.move(DEVICE, HOST);
+    ids_gt.move(DEVICE, HOST);
+    size.move(DEVICE, HOST);
+    ids.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_GT(size_gt(vh), 0u);
+        ASSERT_EQ(size(vh), size_gt(vh));
+
+        const uint32_t        n = size(vh);
+        std::vector<uint64_t> a(n), b(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            a[i] = ids(vh, i);
+            b[i] = ids_gt(vh, i);
+        }
+
+        if (!oriented) {
+            // the order of the output is not defined
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            EXPECT_EQ(a, b);
+            return;
+        }
+
+        // the same cycle around the vertex but it may start from a different
+        // element and go in the other direction
+        bool same = false;
+        for (int dir = 0; dir < 2 && !same; ++dir) {
+            for (uint32_t shift = 0; shift < n && !same; ++shift) {
+                bool match = true;
+                for (uint32_t i = 0; i < n && match; ++i) {
+                    const uint32_t j =
+                        (dir == 0) ? (i + shift) % n : (shift + n - i) % n;
+                    match = a[i] == b[j];
+                }
+                same = match;
+            }
+        }
+        EXPECT_TRUE(same);
+    });
+
+    rx.remove_attribute("size_gt");
+    rx.remove_attribute("ids_gt");
+    rx.remove_attribute("size");
+    rx.remove_attribute("ids");
+}
+
+TEST(RXMeshStatic, BoundedQueries)
+{
+    using namespace rxmesh;
+
+    {
+        // closed mesh with max valence 6
+        RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+        EXPECT_FALSE(rx.is_valence_bounded(rx.get_input_max_valence() - 1));
+
+        test_bounded_query<Op::VV, VertexIterator, 8, false>(rx);
+        test_bounded_query<Op::VE, EdgeIterator, 8, false>(rx);
+        test_bounded_query<Op::VV, VertexIterator, 8, true>(rx);
+        test_bounded_query<Op::VE, EdgeIterator, 8, true>(rx);
+    }
+
+    {
+        // mesh with boundary and max valence 11
+        RXMeshStatic rx(STRINGIFY(INPUT_DIR) "cloth.obj");
+
+        EXPECT_FALSE(rx.is_valence_bounded(8));
+
+        test_bounded_query<Op::VV, VertexIterator, 12, false>(rx);
+        test_bounded_query<Op::VV, VertexIterator, 12, true>(rx);
+    }
+
+    CUDA_ERROR(cudaDeviceReset());
+}
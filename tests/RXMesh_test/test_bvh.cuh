@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include <limits>
+
+#include "rxmesh/bvh.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
+
+TEST(RXMeshStatic, BVH)
+{
+    using namespace rxmesh;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+    auto         coords = *rx.get_input_vertex_coordinates();
+
+    BVH<float> bvh(rx, coords);
+    EXPECT_EQ(bvh.get_num_patches(), rx.get_num_patches());
+
+    glm::vec3 lower, upper;
+    rx.bounding_box(lower, upper);
+    AABB<float> root = bvh.get_bounding_box();
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FLOAT_EQ(root.lo[i], lower[i]);
+        EXPECT_FLOAT_EQ(root.hi[i], upper[i]);
+    }
+
+    // one query point, ray, and triangle per vertex
+    const vec3<float> offset(0.05f, 0.02f, -0.03f);
+    const vec3<float> dir = glm::normalize(vec3<float>(0.3f, 0.7f, -0.2f));
+    const vec3<float> e0(0.2f, 0.f, 0.f), e1(0.f, 0.2f, 0.1f);
+
+    auto closest = *rx.add_vertex_attribute<float>("closest", 1);
+    auto ray_t   = *rx.add_vertex_attribute<float>("ray_t", 1);
+    auto tri_hit = *rx.add_vertex_attribute<int>("tri_hit", 1);
+
+    rx.for_each_vertex(
+        DEVICE,
+        [=] __device__(const VertexHandle vh) mutable {
+            const vec3<float> q =
+                vec3<float>(coords(vh, 0), coords(vh, 1), coords(vh, 2)) +
+                offset;
+
+            BVHHit<float> c = bvh.closest_point(q);
+            closest(vh)     = c.is_valid() ? c.dist : -1.f;
+
+            BVHHit<float> r = bvh.ray_intersect(q, dir);
+            ray_t(vh)       = r.is_valid() ? r.dist : -1.f;
+
+            tri_hit(vh) = bvh.triangle_intersect(q, q + e0, q + e1).is_valid();
+        });
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    closest.move(DEVICE, HOST);
+    ray_t.move(DEVICE, HOST);
+    tri_hit.move(DEVICE, HOST);
+
+    // compare against testing every face
+    auto p = [&](uint32_t v) {
+        return vec3<float>(verts[v][0], verts[v][1], verts[v][2]);
+    };
+
+    uint32_t ray_mismatch = 0, tri_mismatch = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        const vec3<float> q = p(rx.map_to_global(vh)) + offset;
+
+        float gold_closest = std::numeric_limits<float>::max();
+        float gold_t       = std::numeric_limits<float>::max();
+        bool  gold_tri     = false;
+        for (const auto& f : fv) {
+            const vec3<float> a = p(f[0]), b = p(f[1]), c = p(f[2]);
+
+            gold_closest = std::min(
+                gold_closest,
+                glm::length(q - closest_point_on_triangle(q, a, b, c)));
+
+            float t;
+            if (ray_triangle_intersect(q, dir, a, b, c, 0.f, gold_t, t)) {
+                gold_t = t;
+            }
+            gold_tri = gold_tri ||
+                       triangle_triangle_intersect(q, q + e0, q + e1, a, b, c);
+        }
+
+        EXPECT_NEAR(closest(vh), gold_closest, 1e-5f);
+
+        if (gold_t == std::numeric_limits<float>::max()) {
+            ray_mismatch += (ray_t(vh) >= 0.f);
+        } else if (ray_t(vh) < 0.f) {
+            ray_mismatch++;
+        } else {
+            EXPECT_NEAR(ray_t(vh), gold_t, 1e-4f);
+        }
+        tri_mismatch += (bool(tri_hit(vh)) != gold_tri);
+    });
+
+    // hits that graze an edge may differ in the last bit between the host
+    // and the device
+    EXPECT_LE(ray_mismatch, rx.get_num_vertices() / 100);
+    EXPECT_LE(tri_mismatch, rx.get_num_vertices() / 100);
+
+    // move the mesh and refit
+    const vec3<float> shift(1.f, 2.f, 3.f);
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+        for (int i = 0; i < 3; ++i) {
+            coords(vh, i) += shift[i];
+        }
+    });
+    bvh.refit(rx, coords);
+
+    root = bvh.get_bounding_box();
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NEAR(root.lo[i], lower[i] + shift[i], 1e-5f);
+        EXPECT_NEAR(root.hi[i], upper[i] + shift[i], 1e-5f);
+    }
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+        const vec3<float> q(coords(vh, 0), coords(vh, 1), coords(vh, 2));
+        closest(vh) = bvh.closest_point(q).dist;
+    });
+    CUDA_ERROR(cudaDeviceSynchronize());
+    closest.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_NEAR(closest(vh), 0.f, 1e-5f);
+    });
+
+    bvh.release();
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+template <uint32_t blockThreads>
+__global__ static void mixed_edge_ops(rxmesh::Context                context,
+                                      rxmesh::VertexAttribute<float> coords,
+                                      rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
+TEST(RXMeshDynamic, MixedEdgeOps)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto e_op   = rx.add_edge_attribute<uint8_t>("e_op", 1);
+
+    // a mix of splits, flips, collapses, and vertex deletions applied by the
+    // same kernel
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        EdgeOp op = EdgeOp::None;
+        switch (eh.local_id() % 12) {
+            case 0:
+                op = EdgeOp::Split;
+                break;
+            case 3:
+                op = EdgeOp::Flip;
+                break;
+            case 6:
+                op = EdgeOp::Collapse;
+                break;
+            case 9:
+                op = EdgeOp::DeleteSrcVertex;
+                break;
+        }
+        (*e_op)(eh) = static_cast<uint8_t>(op);
+    });
+    e_op->move(HOST, DEVICE);
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)mixed_edge_ops<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        mixed_edge_ops<blockThreads><<<launch_box.blocks,
+                                       launch_box.num_threads,
+                                       launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *e_op);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op);
+        rx.cleanup();
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+
+    // all operations keep the mesh closed and of genus zero
+    EXPECT_EQ(int(rx.get_num_vertices()) - int(rx.get_num_edges()) +
+                  int(rx.get_num_faces()),
+              2);
+}
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void compact_fv(const rxmesh::Context           context,
+                                  rxmesh::FaceAttribute<uint64_t> fv)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                fv(fh, i) = iter[i].unique_id();
+            }
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void compact_vv(const rxmesh::Context             context,
+                                  rxmesh::VertexAttribute<uint32_t> valence)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+        });
+}
+
+/**
+ * @brief run FV and VV on the mesh and return their output indexed by the
+ * linear id of the faces and vertices
+ */
+inline void compact_run(rxmesh::RXMeshStatic&  r,
+                        std::vector<uint64_t>& fv_out,
+                        std::vector<uint32_t>& valence_out)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    auto fv      = *r.add_face_attribute<uint64_t>("fv", 3);
+    auto valence = *r.add_vertex_attribute<uint32_t>("valence", 1);
+
+    LaunchBox<blockThreads> lb_fv, lb_vv;
+    r.prepare_launch_box({Op::FV}, lb_fv, (void*)compact_fv<blockThreads>);
+    r.prepare_launch_box({Op::VV}, lb_vv, (void*)compact_vv<blockThreads>);
+    r.run_query_kernel(lb_fv, compact_fv<blockThreads>, NULL, fv);
+    r.run_query_kernel(lb_vv, compact_vv<blockThreads>, NULL, valence);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    fv.move(DEVICE, HOST);
+    valence.move(DEVICE, HOST);
+
+    fv_out.resize(3 * r.get_num_faces());
+    valence_out.resize(r.get_num_vertices());
+    r.for_each_face(HOST, [&](const FaceHandle fh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            fv_out[3 * r.linear_id(fh) + i] = fv(fh, i);
+        }
+    });
+    r.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        valence_out[r.linear_id(vh)] = valence(vh);
+    });
+
+    r.remove_attribute("fv");
+    r.remove_attribute("valence");
+}
+
+TEST(RXMeshStatic, CompactTopology)
+{
+    using namespace rxmesh;
+
+    // the same mesh with headroom and compact (exact per-patch allocation)
+    // gives the same query output with less topology memory
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", 512, 1.5, 2.0);
+    RXMeshStatic rx_c(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                      "",
+                      512,
+                      1.5,
+                      2.0,
+                      0.8,
+                      -1,
+                      0,
+                      1,
+                      true);
+
+    EXPECT_FALSE(rx.is_compact());
+    EXPECT_TRUE(rx_c.is_compact());
+    EXPECT_EQ(rx_c.get_num_patches(), rx.get_num_patches());
+    EXPECT_EQ(rx_c.get_max_num_patches(), rx_c.get_num_patches());
+    EXPECT_LT(rx_c.get_topology_memory_mg(), rx.get_topology_memory_mg());
+
+    std::vector<uint64_t> fv, fv_c;
+    std::vector<uint32_t> valence, valence_c;
+    compact_run(rx, fv, valence);
+    compact_run(rx_c, fv_c, valence_c);
+
+    EXPECT_EQ(fv, fv_c);
+    EXPECT_EQ(valence, valence_c);
+
+    CUDA_ERROR(cudaDeviceReset());
+}
+
+TEST(RXMeshStatic, CompactMeshCache)
+{
+    using namespace rxmesh;
+
+    const std::string cache_file = STRINGIFY(OUTPUT_DIR) "sphere3_compact.rxmc";
+
+    // the cache is written by a mesh with headroom and the compact
+    // allocation is applied when it is read
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", 512, 1.5, 2.0);
+    rx.save_cache(cache_file);
+
+    RXMeshStatic rx_c(cache_file, "", 512, 1.0, 1.0, 0.8, -1, 0, 1, true);
+
+    EXPECT_TRUE(rx_c.is_compact());
+    EXPECT_EQ(rx_c.get_num_patches(), rx.get_num_patches());
+    EXPECT_EQ(rx_c.get_max_num_patches(), rx_c.get_num_patches());
+    EXPECT_LT(rx_c.get_topology_memory_mg(), rx.get_topology_memory_mg());
+    for (uint32_t p = 0; p < rx_c.get_num_patches(); ++p) {
+        const PatchInfo& pc = rx_c.get_patch(p);
+        EXPECT_EQ(pc.vertices_capacity[0], pc.num_vertices[0]);
+        EXPECT_EQ(pc.edges_capacity[0], pc.num_edges[0]);
+        EXPECT_EQ(pc.faces_capacity[0], pc.num_faces[0]);
+    }
+
+    std::vector<uint64_t> fv, fv_c;
+    std::vector<uint32_t> valence, valence_c;
+    compact_run(rx, fv, valence);
+    compact_run(rx_c, fv_c, valence_c);
+
+    EXPECT_EQ(fv, fv_c);
+    EXPECT_EQ(valence, valence_c);
+
+    CUDA_ERROR(cudaDeviceReset());
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cuda_graph.h"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, CUDAGraph)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto x = *rx.add_vertex_attribute<float>("x", 1);
+    x.reset(1.f, DEVICE);
+
+    VertexReduceHandle<float> reduce(x);
+
+    float* d_sum = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_sum, sizeof(float)));
+
+    // one "iteration" that doubles x and computes <x, x> on the device
+    CUDAGraph graph;
+    auto      iteration = [&](cudaStream_t stream) {
+        rx.for_each_vertex(
+            DEVICE,
+            [=] __device__(const VertexHandle vh) mutable { x(vh) *= 2.f; },
+            stream);
+        reduce.dot_on_device(x, x, d_sum, INVALID32, stream);
+    };
+    rx.capture_graph(graph, iteration);
+    EXPECT_TRUE(graph.is_captured());
+    EXPECT_GT(graph.get_num_nodes(), 0u);
+
+    // capturing does not run the kernels and so x is only doubled by the
+    // replays
+    for (int i = 0; i < 3; ++i) {
+        graph.launch();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    float h_sum = 0;
+    CUDA_ERROR(
+        cudaMemcpy(&h_sum, d_sum, sizeof(float), cudaMemcpyDeviceToHost));
+    EXPECT_EQ(h_sum, 64.f * rx.get_num_vertices());
+
+    x.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST,
+                       [&](const VertexHandle vh) { EXPECT_EQ(x(vh), 8.f); });
+
+    // re-capturing the same sequence updates the executable graph in place
+    const size_t num_nodes = graph.get_num_nodes();
+    rx.capture_graph(graph, iteration);
+    EXPECT_TRUE(graph.is_captured());
+    EXPECT_EQ(graph.get_num_nodes(), num_nodes);
+
+    // replay until a device counter reaches zero while checking it every
+    // other replay
+    int* d_count = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_count, sizeof(int)));
+    const int h_count = 5;
+    CUDA_ERROR(
+        cudaMemcpy(d_count, &h_count, sizeof(int), cudaMemcpyHostToDevice));
+
+    CUDAGraph countdown;
+    countdown.capture([&](cudaStream_t stream) {
+        launch_scalar(stream, [=] __device__() {
+            if (d_count[0] > 0) {
+                d_count[0]--;
+            }
+        });
+    });
+    EXPECT_EQ(countdown.launch_while(d_count, 100, 2), 6u);
+
+    int count = -1;
+    CUDA_ERROR(
+        cudaMemcpy(&count, d_count, sizeof(int), cudaMemcpyDeviceToHost));
+    EXPECT_EQ(count, 0);
+
+    GPU_FREE(d_sum);
+    GPU_FREE(d_count);
+
+    CUDA_ERROR(cudaDeviceReset());
+}
@@ -173,6 +173,84 @@ TEST(RXMeshStatic, DenseMatrixNorm2)
 }
 
 
+TEST(RXMeshStatic, DenseMatrixFusedCG)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const int rows = 1000, cols = 3;
+
+    DenseMatrix<float> X(rx, rows, cols);
+    DenseMatrix<float> P(rx, rows, cols);
+    DenseMatrix<float> R(rx, rows, cols);
+    DenseMatrix<float> AP(rx, rows, cols);
+    X.fill_random();
+    P.fill_random();
+    R.fill_random();
+    AP.fill_random();
+
+    std::vector<float> h_x(X.data(HOST), X.data(HOST) + rows * cols);
+    std::vector<float> h_p(P.data(HOST), P.data(HOST) + rows * cols);
+    std::vector<float> h_r(R.data(HOST), R.data(HOST) + rows * cols);
+    std::vector<float> h_ap(AP.data(HOST), AP.data(HOST) + rows * cols);
+
+    // d_scalar = {<R, R>, <P, AP>, new <R, R>}
+    float* d_scalar;
+    CUDA_ERROR(cudaMalloc((void**)&d_scalar, 3 * sizeof(float)));
+
+    R.dot_on_device(R, d_scalar);
+    P.dot_on_device(AP, d_scalar + 1);
+    X.fused_cg_update(P, R, AP, d_scalar, d_scalar + 1, d_scalar + 2);
+    P.fused_cg_direction(R, d_scalar + 2, d_scalar);
+
+    float h_scalar[3];
+    CUDA_ERROR(cudaMemcpy(
+        h_scalar, d_scalar, 3 * sizeof(float), cudaMemcpyDeviceToHost));
+
+    X.move(DEVICE, HOST);
+    P.move(DEVICE, HOST);
+    R.move(DEVICE, HOST);
+
+    double rr = 0, pap = 0;
+    for (int i = 0; i < rows * cols; ++i) {
+        rr += h_r[i] * h_r[i];
+        pap += h_p[i] * h_ap[i];
+    }
+    EXPECT_NEAR(h_scalar[0], rr, 1e-3 * rr);
+    EXPECT_NEAR(h_scalar[1], pap, 1e-3 * std::abs(pap));
+
+    const float alpha = h_scalar[0] / h_scalar[1];
+
+    double new_rr = 0;
+    for (int i = 0; i < rows * cols; ++i) {
+        h_x[i] += alpha * h_p[i];
+        h_r[i] -= alpha * h_ap[i];
+        new_rr += h_r[i] * h_r[i];
+    }
+    EXPECT_NEAR(h_scalar[2], new_rr, 1e-3 * new_rr);
+
+    const float beta = h_scalar[2] / h_scalar[0];
+
+    for (int j = 0; j < cols; ++j) {
+        for (int i = 0; i < rows; ++i) {
+            const int id = j * rows + i;
+            EXPECT_NEAR(X(i, j), h_x[id], 1e-3);
+            EXPECT_NEAR(R(i, j), h_r[id], 1e-3);
+            EXPECT_NEAR(P(i, j), h_r[id] + beta * h_p[id], 1e-3);
+        }
+    }
+
+    GPU_FREE(d_scalar);
+    X.release();
+    P.release();
+    R.release();
+    AP.release();
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+
 TEST(RXMeshStatic, DenseMatrixMulitply)
 {
     using namespace rxmesh;
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/derived_attributes.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+template <uint32_t blockThreads>
+__global__ static void derived_splits(rxmesh::Context                  context,
+                                      rxmesh::VertexAttribute<float>   coords,
+                                      rxmesh::EdgeAttribute<uint8_t>   e_op,
+                                      rxmesh::DerivedAttributes<float> derived)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op,
+        derived);
+}
+
+TEST(RXMeshDynamic, DerivedAttributes)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    DerivedAttributes<float> derived(rx, *coords);
+    EXPECT_EQ(derived.get_flags(), DERIVED_ALL);
+
+    const uint32_t num_faces = rx.get_num_faces();
+
+    auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        (*e_op)(eh) = static_cast<uint8_t>(
+            eh.local_id() % 7 == 0 ? EdgeOp::Split : EdgeOp::None);
+    });
+    e_op->move(HOST, DEVICE);
+
+    rx.reset_scheduler();
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)derived_splits<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        derived_splits<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(
+                rx.get_context(), *coords, *e_op, derived);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op, derived);
+        rx.cleanup();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+    EXPECT_GT(rx.get_num_faces(), num_faces);
+
+    // the incrementally updated quantities match the ones computed from
+    // scratch on the final mesh
+    DerivedAttributes<float> gold(rx, *coords);
+
+    derived.edge_length.move(DEVICE, HOST);
+    derived.face_normal.move(DEVICE, HOST);
+    derived.face_area.move(DEVICE, HOST);
+    derived.valence.move(DEVICE, HOST);
+    derived.boundary.move(DEVICE, HOST);
+
+    gold.edge_length.move(DEVICE, HOST);
+    gold.face_normal.move(DEVICE, HOST);
+    gold.face_area.move(DEVICE, HOST);
+    gold.valence.move(DEVICE, HOST);
+    gold.boundary.move(DEVICE, HOST);
+
+    rx.for_each_edge(HOST, [&](const EdgeHandle& eh) {
+        EXPECT_NEAR(derived.edge_length(eh), gold.edge_length(eh), 1e-5f);
+    });
+
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+        EXPECT_NEAR(derived.face_area(fh), gold.face_area(fh), 1e-6f);
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_NEAR(
+                derived.face_normal(fh, i), gold.face_normal(fh, i), 1e-4f);
+        }
+    });
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_EQ(derived.valence(vh), gold.valence(vh));
+        EXPECT_EQ(derived.boundary(vh), 0);
+    });
+
+    gold.release(rx);
+    derived.release(rx);
+}
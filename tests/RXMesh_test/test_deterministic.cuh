@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+template <uint32_t blockThreads>
+__global__ static void deterministic_edge_ops(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
+template <uint32_t blockThreads>
+__global__ static void deterministic_face_signature(
+    const rxmesh::Context                context,
+    const rxmesh::VertexAttribute<float> coords,
+    rxmesh::FaceAttribute<float>         signature)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            // the vertices of the face sorted by their coordinates
+            vec3<float> p[3];
+            for (int i = 0; i < 3; ++i) {
+                p[i] = vec3<float>(coords(iter[i], 0),
+                                   coords(iter[i], 1),
+                                   coords(iter[i], 2));
+            }
+            auto less = [](const vec3<float>& a, const vec3<float>& b) {
+                return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]) ||
+                       (a[0] == b[0] && a[1] == b[1] && a[2] < b[2]);
+            };
+            for (int i = 0; i < 2; ++i) {
+                for (int j = 0; j < 2 - i; ++j) {
+                    if (less(p[j + 1], p[j])) {
+                        const vec3<float> tmp = p[j];
+                        p[j]                  = p[j + 1];
+                        p[j + 1]              = tmp;
+                    }
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    signature(fh, 3 * i + j) = p[i][j];
+                }
+            }
+        });
+}
+
+TEST(RXMeshDynamic, Deterministic)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    // both runs should start from the same patches
+    const std::string p_file =
+        STRINGIFY(OUTPUT_DIR) "sphere3_deterministic_patches";
+    {
+        RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+        rx.save(p_file);
+    }
+
+    auto run = [&](std::vector<std::array<float, 9>>& out) {
+        RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", p_file);
+
+        EXPECT_FALSE(rx.is_deterministic());
+        rx.set_deterministic(true);
+        EXPECT_TRUE(rx.is_deterministic());
+
+        auto coords = rx.get_input_vertex_coordinates();
+
+        const uint32_t num_faces = rx.get_num_faces();
+
+        // adjacent flips and splits conflict and so the result depends on
+        // which cavity wins
+        auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+        rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+            EdgeOp op = EdgeOp::None;
+            if (eh.local_id() % 3 == 0) {
+                op = EdgeOp::Flip;
+            } else if (eh.local_id() % 5 == 0) {
+                op = EdgeOp::Split;
+            }
+            (*e_op)(eh) = static_cast<uint8_t>(op);
+        });
+        e_op->move(HOST, DEVICE);
+
+        rx.reset_scheduler();
+        while (!rx.is_queue_empty()) {
+            LaunchBox<blockThreads> launch_box;
+            rx.update_launch_box({Op::EVDiamond},
+                                 launch_box,
+                                 (void*)deterministic_edge_ops<blockThreads>,
+                                 true,
+                                 false,
+                                 false,
+                                 false,
+                                 edge_ops_shmem_bytes);
+
+            deterministic_edge_ops<blockThreads>
+                <<<launch_box.blocks,
+                   launch_box.num_threads,
+                   launch_box.smem_bytes_dyn>>>(
+                    rx.get_context(), *coords, *e_op);
+
+            rx.cleanup();
+            rx.slice_patches(*coords, *e_op);
+            rx.cleanup();
+        }
+        CUDA_ERROR(cudaDeviceSynchronize());
+        CUDA_ERROR(cudaGetLastError());
+
+        rx.update_host();
+        EXPECT_TRUE(rx.validate());
+        EXPECT_GT(rx.get_num_faces(), num_faces);
+
+        auto signature = rx.add_face_attribute<float>("signature", 9);
+
+        LaunchBox<blockThreads> lb;
+        rx.prepare_launch_box({Op::FV},
+                              lb,
+                              (void*)deterministic_face_signature<blockThreads>,
+                              false);
+        rx.run_query_kernel(lb,
+                            deterministic_face_signature<blockThreads>,
+                            NULL,
+                            *coords,
+                            *signature);
+        signature->move(DEVICE, HOST);
+
+        out.clear();
+        rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+            std::array<float, 9> f;
+            for (int i = 0; i < 9; ++i) {
+                f[i] = (*signature)(fh, i);
+            }
+            out.push_back(f);
+        });
+        std::sort(out.begin(), out.end());
+    };
+
+    std::vector<std::array<float, 9>> first, second;
+    run(first);
+    run(second);
+
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        for (int j = 0; j < 9; ++j) {
+            EXPECT_EQ(first[i][j], second[i][j]);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
+
+TEST(RXMeshStatic, DeviceBuild)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+
+    RXMeshStatic rx_host(fv);
+
+    std::vector<uint32_t> h_fv(3 * fv.size());
+    for (uint32_t f = 0; f < fv.size(); ++f) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            h_fv[3 * f + i] = fv[f][i];
+        }
+    }
+
+    uint32_t* d_fv = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_fv, h_fv.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemcpy(d_fv,
+                          h_fv.data(),
+                          h_fv.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    RXMeshStatic rx_device(d_fv, fv.size());
+
+    GPU_FREE(d_fv);
+
+    EXPECT_EQ(rx_host.get_num_vertices(), rx_device.get_num_vertices());
+    EXPECT_EQ(rx_host.get_num_edges(), rx_device.get_num_edges());
+    EXPECT_EQ(rx_host.get_num_faces(), rx_device.get_num_faces());
+    EXPECT_EQ(rx_host.get_input_max_valence(),
+              rx_device.get_input_max_valence());
+    EXPECT_EQ(rx_host.get_input_max_edge_incident_faces(),
+              rx_device.get_input_max_edge_incident_faces());
+    EXPECT_EQ(rx_host.get_input_max_face_adjacent_faces(),
+              rx_device.get_input_max_face_adjacent_faces());
+    EXPECT_EQ(rx_host.is_closed(), rx_device.is_closed());
+    EXPECT_EQ(rx_host.is_edge_manifold(), rx_device.is_edge_manifold());
+
+    // both should give the same edge ids
+    for (const auto& f : fv) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(rx_host.get_edge_id(f[i], f[(i + 1) % 3]),
+                      rx_device.get_edge_id(f[i], f[(i + 1) % 3]));
+        }
+    }
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -170,6 +170,76 @@ __global__ static void random_collapses(rxmesh::Context                context,
     cavity.epilogue(block);
 }
 
+template <uint32_t blockThreads>
+__global__ static void priority_cavities(rxmesh::Context                context,
+                                         rxmesh::VertexAttribute<float> coords,
+                                         int*                           d_won)
+{
+    // two overlapping cavities where the one with the smaller id has the
+    // smaller key. Without the keys, the one with the larger id would win
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::EV> cavity(
+        block, context, shrd_alloc, true);
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    const PatchInfo& pi = cavity.patch_info();
+
+    __shared__ uint16_t s_e[2];
+    if (threadIdx.x == 0) {
+        s_e[0] = INVALID16;
+        s_e[1] = INVALID16;
+        if (cavity.patch_id() == 0) {
+            // two owned edges that share a vertex
+            for (uint16_t e = 0; e < pi.num_edges[0] && s_e[1] == INVALID16;
+                 ++e) {
+                if (pi.is_deleted(LocalEdgeT(e)) ||
+                    !pi.is_owned(LocalEdgeT(e))) {
+                    continue;
+                }
+                if (s_e[0] == INVALID16) {
+                    s_e[0] = e;
+                    continue;
+                }
+                const uint16_t a0 = pi.ev[2 * s_e[0] + 0].id;
+                const uint16_t a1 = pi.ev[2 * s_e[0] + 1].id;
+                const uint16_t b0 = pi.ev[2 * e + 0].id;
+                const uint16_t b1 = pi.ev[2 * e + 1].id;
+                if (a0 == b0 || a0 == b1 || a1 == b0 || a1 == b1) {
+                    s_e[1] = e;
+                }
+            }
+            if (s_e[1] != INVALID16) {
+                cavity.create(EdgeHandle(cavity.patch_id(), s_e[0]), 1.f);
+                cavity.create(EdgeHandle(cavity.patch_id(), s_e[1]), 2.f);
+            }
+        }
+    }
+    block.sync();
+
+    if (cavity.prologue(block, shrd_alloc, coords)) {
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            const EdgeHandle src = cavity.template get_creator<EdgeHandle>(c);
+            if (src.local_id() == s_e[0]) {
+                d_won[0] = 1;
+            }
+            if (src.local_id() == s_e[1]) {
+                d_won[1] = 1;
+            }
+            // keep the mesh as is
+            cavity.recover(src);
+        });
+    }
+    block.sync();
+
+    cavity.epilogue(block);
+}
+
 inline void set_edge_tag(rxmesh::RXMeshDynamic&      rx,
                          rxmesh::EdgeAttribute<int>& edge_tag,
                          const Config                config)
@@ -480,4 +550,173 @@ TEST(RXMeshDynamic, RandomCollapse)
 #endif
 
     // polyscope::removeAllStructures();
-}
\ No newline at end of file
+}
+TEST(RXMeshDynamic, IncrementalCleanup)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches");
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    // the first cleanup processes every patch but nothing is touched after it
+    EXPECT_EQ(rx.cleanup(), rx.get_num_patches());
+    EXPECT_EQ(rx.cleanup(), 0u);
+
+    // the query cache is kept as long as the cleanup touches no patch
+    EXPECT_TRUE(rx.cache_query(Op::VV));
+    EXPECT_EQ(rx.cleanup(), 0u);
+    EXPECT_TRUE(rx.is_query_cached(Op::VV));
+
+    auto coords  = rx.get_input_vertex_coordinates();
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+    set_edge_tag(rx, *to_flip, InteriorNotConflicting);
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box({},
+                              launch_box,
+                              (void*)random_flips<blockThreads>,
+                              true,
+                              false,
+                              true);
+        random_flips<blockThreads><<<launch_box.blocks,
+                                     launch_box.num_threads,
+                                     launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_flip);
+
+        EXPECT_LE(rx.cleanup(), rx.get_num_patches());
+    }
+    EXPECT_EQ(rx.cleanup(), 0u);
+    EXPECT_FALSE(rx.is_query_cached(Op::VV));
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, PatchGrowth)
+{
+    using namespace rxmesh;
+
+    // no spare patches so that slicing has to grow the pool
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8,
+                     1.0);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+    const uint32_t num_patches  = rx.get_num_patches();
+
+    // only the dynamic mesh reserves patch slots for the spare patches to grow
+    EXPECT_EQ(rx.get_num_patch_slots(),
+              RXMeshDynamic::patch_slots_factor * rx.get_max_num_patches());
+    {
+        RXMeshStatic rx_static(STRINGIFY(INPUT_DIR) "sphere3.obj");
+        EXPECT_EQ(rx_static.get_num_patch_slots(),
+                  rx_static.get_max_num_patches());
+    }
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto v_id   = *rx.add_vertex_attribute<uint32_t>("v_id", 2);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        v_id(vh, 0) = vh.patch_id();
+        v_id(vh, 1) = vh.local_id();
+    });
+    v_id.move(HOST, DEVICE);
+
+    std::vector<uint32_t> v_cap(num_patches);
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        v_cap[p] = v_id.capacity(p);
+    }
+
+    // every patch with at least one vertex is above a zero threshold
+    EXPECT_EQ(rx.grow_patches(0.0f, 2.0f), num_patches);
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        EXPECT_GT(v_id.capacity(p), v_cap[p]);
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+
+    // the attribute is moved to the grown buffers
+    v_id.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ(v_id(vh, 0), vh.patch_id());
+        EXPECT_EQ(v_id(vh, 1), vh.local_id());
+    });
+
+    const uint32_t max_num_patches = rx.get_max_num_patches();
+    EXPECT_TRUE(rx.grow_spare_patches(max_num_patches + 4));
+    EXPECT_EQ(rx.get_max_num_patches(), max_num_patches + 4);
+
+    // grown patches are marked for slicing and there are not enough spare
+    // patches to slice all of them
+    rx.slice_patches(*coords, v_id);
+    rx.cleanup();
+    CUDA_ERROR(cudaDeviceSynchronize());
+    rx.update_host();
+
+    EXPECT_GT(rx.get_num_patches(), num_patches);
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, CavityPriority)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    int* d_won;
+    CUDA_ERROR(cudaMalloc((void**)&d_won, 2 * sizeof(int)));
+    CUDA_ERROR(cudaMemset(d_won, 0, 2 * sizeof(int)));
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box({},
+                              launch_box,
+                              (void*)priority_cavities<blockThreads>,
+                              true);
+        priority_cavities<blockThreads><<<launch_box.blocks,
+                                          launch_box.num_threads,
+                                          launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, d_won);
+        rx.cleanup();
+    }
+
+    int h_won[2];
+    CUDA_ERROR(cudaMemcpy(
+        h_won, d_won, 2 * sizeof(int), cudaMemcpyDeviceToHost));
+    GPU_FREE(d_won);
+
+    // the two cavities overlap so at most one of them survives and it is
+    // never the one with the larger key
+    EXPECT_LE(h_won[0] + h_won[1], 1);
+    EXPECT_GE(h_won[0], h_won[1]);
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+}
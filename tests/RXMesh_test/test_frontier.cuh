@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/frontier.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void frontier_bfs(
+    const rxmesh::Context                        context,
+    const rxmesh::Frontier<rxmesh::VertexHandle> frontier,
+    rxmesh::VertexAttribute<uint32_t>            dist,
+    const uint32_t                               level)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            assert(dist(vh) == level);
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                const VertexHandle n = iter[i];
+                if (::atomicCAS(&dist(n), INVALID32, level + 1) ==
+                    INVALID32) {
+                    frontier.add(n);
+                }
+            }
+        },
+        [&](VertexHandle vh) { return frontier.is_active(vh); });
+}
+
+template <uint32_t blockThreads>
+__global__ static void frontier_bfs_verify(
+    const rxmesh::Context                   context,
+    const rxmesh::VertexAttribute<uint32_t> dist,
+    rxmesh::VertexAttribute<uint32_t>       is_valid)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            // every vertex is reached and it has a neighbor in the previous
+            // level (unless it is the seed) but no neighbor beyond the next
+            // level
+            const uint32_t d = dist(vh);
+
+            bool valid           = d != INVALID32;
+            bool has_predecessor = d == 0;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                const uint32_t dn = dist(iter[i]);
+                if (dn == INVALID32 || dn + 1 < d || dn > d + 1) {
+                    valid = false;
+                }
+                if (dn + 1 == d) {
+                    has_predecessor = true;
+                }
+            }
+            is_valid(vh) = valid && has_predecessor;
+        });
+}
+
+TEST(RXMeshStatic, Frontier)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto dist     = *rx.add_vertex_attribute<uint32_t>("dist", 1);
+    auto is_valid = *rx.add_vertex_attribute<uint32_t>("is_valid", 1);
+    dist.reset(INVALID32, DEVICE);
+    is_valid.reset(0, DEVICE);
+
+    LaunchBox<blockThreads> lb_bfs, lb_verify;
+    rx.prepare_launch_box(
+        {Op::VV}, lb_bfs, (void*)frontier_bfs<blockThreads>);
+    rx.prepare_launch_box(
+        {Op::VV}, lb_verify, (void*)frontier_bfs_verify<blockThreads>);
+
+    auto frontier = rx.create_frontier<VertexHandle>();
+    EXPECT_TRUE(frontier.is_empty());
+
+    // seed the frontier with the first vertex
+    const VertexHandle seed(0, 0);
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) {
+        if (vh == seed) {
+            dist(vh) = 0;
+            frontier.add(vh);
+        }
+    });
+    frontier.advance();
+    EXPECT_EQ(frontier.size(), 1u);
+
+    // only the seed is visited
+    uint32_t* d_count = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_count, sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_count, 0, sizeof(uint32_t)));
+    rx.for_each_frontier(frontier, [=] __device__(const VertexHandle vh) {
+        ::atomicAdd(d_count, 1u);
+    });
+    uint32_t h_count = 0;
+    CUDA_ERROR(cudaMemcpy(
+        &h_count, d_count, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    EXPECT_EQ(h_count, 1u);
+
+    uint32_t level = 0;
+    while (!frontier.is_empty()) {
+        EXPECT_LE(frontier.size(), rx.get_num_patches());
+        rx.run_query_kernel_frontier(lb_bfs,
+                                     frontier,
+                                     frontier_bfs<blockThreads>,
+                                     NULL,
+                                     frontier,
+                                     dist,
+                                     level);
+        frontier.advance();
+        level++;
+    }
+    EXPECT_GT(level, 1u);
+
+    rx.run_query_kernel(
+        lb_verify, frontier_bfs_verify<blockThreads>, NULL, dist, is_valid);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    is_valid.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ(is_valid(vh), 1u);
+    });
+
+    GPU_FREE(d_count);
+    frontier.free();
+
+    CUDA_ERROR(cudaDeviceReset());
+}
@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "rxmesh/geodesic.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
+
+namespace {
+
+// shortest path along the edges which bounds the geodesic distance from above
+std::vector<double> dijkstra(const std::vector<std::vector<float>>&    verts,
+                             const std::vector<std::vector<uint32_t>>& fv,
+                             const uint32_t                            source)
+{
+    std::vector<std::vector<uint32_t>> adj(verts.size());
+    for (const auto& f : fv) {
+        for (int i = 0; i < 3; ++i) {
+            adj[f[i]].push_back(f[(i + 1) % 3]);
+            adj[f[(i + 1) % 3]].push_back(f[i]);
+        }
+    }
+
+    auto len = [&](uint32_t a, uint32_t b) {
+        double sum = 0;
+        for (int i = 0; i < 3; ++i) {
+            const double d = verts[a][i] - verts[b][i];
+            sum += d * d;
+        }
+        return std::sqrt(sum);
+    };
+
+    std::vector<double> dist(verts.size(),
+                             std::numeric_limits<double>::infinity());
+    using PairT = std::pair<double, uint32_t>;
+    std::priority_queue<PairT, std::vector<PairT>, std::greater<PairT>> pq;
+    dist[source] = 0;
+    pq.push({0, source});
+    while (!pq.empty()) {
+        auto [d, v] = pq.top();
+        pq.pop();
+        if (d > dist[v]) {
+            continue;
+        }
+        for (uint32_t u : adj[v]) {
+            const double nd = d + len(v, u);
+            if (nd < dist[u]) {
+                dist[u] = nd;
+                pq.push({nd, u});
+            }
+        }
+    }
+    return dist;
+}
+}  // namespace
+
+TEST(RXMeshStatic, Geodesic)
+{
+    using namespace rxmesh;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+    auto         coords = rx.get_input_vertex_coordinates();
+
+    // three sources with their handles
+    const std::vector<uint32_t> src_ids = {0, uint32_t(verts.size() / 2), 7};
+    std::vector<VertexHandle>   sources(src_ids.size());
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        for (uint32_t s = 0; s < src_ids.size(); ++s) {
+            if (rx.map_to_global(vh) == src_ids[s]) {
+                sources[s] = vh;
+            }
+        }
+    });
+    for (const auto& s : sources) {
+        ASSERT_TRUE(s.is_valid());
+    }
+
+    const std::vector<double> gold = dijkstra(verts, fv, src_ids[0]);
+
+    auto euclidean = [&](uint32_t v) {
+        double sum = 0;
+        for (int i = 0; i < 3; ++i) {
+            const double d = verts[v][i] - verts[src_ids[0]][i];
+            sum += d * d;
+        }
+        return std::sqrt(sum);
+    };
+
+    // narrow band: the distance is between the straight line and the shortest
+    // path along the edges
+    GeodesicSolver<float> nb(rx, *coords, GeodesicMethod::NarrowBand);
+    auto nb_dist = *rx.add_vertex_attribute<float>("nb_dist", 1);
+    nb.compute({sources[0]}, nb_dist);
+    EXPECT_GT(nb.get_num_rounds(), 0u);
+    nb_dist.move(DEVICE, HOST);
+
+    double max_dist = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        const uint32_t v = rx.map_to_global(vh);
+        EXPECT_LE(nb_dist(vh), gold[v] * (1 + 1e-3) + 1e-4);
+        EXPECT_GE(nb_dist(vh), euclidean(v) * (1 - 1e-3) - 1e-4);
+        max_dist = std::max(max_dist, gold[v]);
+    });
+    EXPECT_EQ(nb_dist(sources[0]), 0.f);
+
+    // heat method: close to the narrow band solution
+    GeodesicSolver<float> heat(rx, *coords, GeodesicMethod::Heat);
+    EXPECT_GT(heat.get_time_step(), 0.f);
+
+    auto heat_dist = *rx.add_vertex_attribute<float>("heat_dist", 1);
+    heat.compute({sources[0]}, heat_dist);
+    heat_dist.move(DEVICE, HOST);
+
+    double sum_err = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_GE(heat_dist(vh), 0.f);
+        sum_err += std::abs(heat_dist(vh) - nb_dist(vh));
+    });
+    EXPECT_LT(sum_err / rx.get_num_vertices(), 0.05 * max_dist);
+    EXPECT_NEAR(heat_dist(sources[0]), 0.f, 1e-3 * max_dist);
+
+    // one column per source with the same factorization. The batch is
+    // smaller than the number of sources so it is solved in chunks
+    DenseMatrix<float> batch(rx, rx.get_num_vertices(), sources.size());
+    heat.compute_batch(sources, batch, NULL, 2);
+    batch.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_NEAR(batch(vh, 0), heat_dist(vh), 1e-3 * max_dist);
+    });
+    for (uint32_t s = 0; s < sources.size(); ++s) {
+        EXPECT_NEAR(batch(sources[s], s), 0.f, 1e-3 * max_dist);
+    }
+
+    // all sources at once is the minimum over the per-source distances
+    nb.compute(sources, nb_dist);
+    nb_dist.move(DEVICE, HOST);
+
+    DenseMatrix<float> nb_batch(rx, rx.get_num_vertices(), sources.size());
+    nb.compute_batch(sources, nb_batch);
+    nb_batch.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        float closest = std::numeric_limits<float>::max();
+        for (uint32_t s = 0; s < sources.size(); ++s) {
+            closest = std::min(closest, nb_batch(vh, s));
+        }
+        EXPECT_NEAR(nb_dist(vh), closest, 1e-4 * max_dist);
+    });
+
+    batch.release();
+    nb_batch.release();
+}
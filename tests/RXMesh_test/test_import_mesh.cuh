@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_mesh.h"
+#include "rxmesh/util/import_obj.h"
+
+TEST(Util, ImportMesh)
+{
+    using namespace rxmesh;
+
+    std::vector<std::vector<float>>    vertices;
+    std::vector<std::vector<uint32_t>> fv;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", vertices, fv));
+
+    std::vector<float>    flat_vertices;
+    std::vector<uint32_t> flat_fv;
+    ASSERT_TRUE(import_mesh(
+        STRINGIFY(INPUT_DIR) "sphere3.obj", flat_vertices, flat_fv));
+
+    ASSERT_EQ(flat_vertices.size(), 3 * vertices.size());
+    ASSERT_EQ(flat_fv.size(), 3 * fv.size());
+
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(flat_vertices[3 * v + i], vertices[v][i]);
+        }
+    }
+
+    for (size_t f = 0; f < fv.size(); ++f) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(flat_fv[3 * f + i], fv[f][i]);
+        }
+    }
+
+    // write the same mesh as binary ply and stl and read it back
+    const std::string ply_file = STRINGIFY(OUTPUT_DIR) "sphere3.ply";
+    const std::string stl_file = STRINGIFY(OUTPUT_DIR) "sphere3.stl";
+    {
+        std::ofstream ply(ply_file, std::ios::binary);
+        ply << "ply\nformat binary_little_endian 1.0\nelement vertex "
+            << vertices.size()
+            << "\nproperty float x\nproperty float y\nproperty float z\n"
+            << "element face " << fv.size()
+            << "\nproperty list uchar int vertex_indices\nend_header\n";
+        ply.write(reinterpret_cast<const char*>(flat_vertices.data()),
+                  flat_vertices.size() * sizeof(float));
+        for (size_t f = 0; f < fv.size(); ++f) {
+            const uint8_t n = 3;
+            ply.write(reinterpret_cast<const char*>(&n), 1);
+            ply.write(reinterpret_cast<const char*>(&flat_fv[3 * f]),
+                      3 * sizeof(uint32_t));
+        }
+
+        std::ofstream stl(stl_file, std::ios::binary);
+        const char     header[80] = {0};
+        const uint32_t num_faces  = fv.size();
+        stl.write(header, 80);
+        stl.write(reinterpret_cast<const char*>(&num_faces), sizeof(uint32_t));
+        for (size_t f = 0; f < fv.size(); ++f) {
+            const float    normal[3] = {0, 0, 0};
+            const uint16_t attr      = 0;
+            stl.write(reinterpret_cast<const char*>(normal), sizeof(normal));
+            for (uint32_t i = 0; i < 3; ++i) {
+                stl.write(reinterpret_cast<const char*>(
+                              &flat_vertices[3 * fv[f][i]]),
+                          3 * sizeof(float));
+            }
+            stl.write(reinterpret_cast<const char*>(&attr), sizeof(uint16_t));
+        }
+    }
+
+    std::vector<float>    ply_vertices;
+    std::vector<uint32_t> ply_fv;
+    ASSERT_TRUE(import_mesh(ply_file, ply_vertices, ply_fv));
+    EXPECT_EQ(ply_vertices, flat_vertices);
+    EXPECT_EQ(ply_fv, flat_fv);
+
+    // stl does not store the vertex ids and so we compare the coordinates of
+    // every face corner
+    std::vector<float>    stl_vertices;
+    std::vector<uint32_t> stl_fv;
+    ASSERT_TRUE(import_mesh(stl_file, stl_vertices, stl_fv));
+    ASSERT_EQ(stl_vertices.size(), flat_vertices.size());
+    ASSERT_EQ(stl_fv.size(), flat_fv.size());
+    for (size_t c = 0; c < flat_fv.size(); ++c) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(stl_vertices[3 * stl_fv[c] + i],
+                      flat_vertices[3 * flat_fv[c] + i]);
+        }
+    }
+}
+
+TEST(RXMeshStatic, FlatConstructor)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    std::vector<float>    vertices;
+    std::vector<uint32_t> fv;
+    ASSERT_TRUE(import_mesh(STRINGIFY(INPUT_DIR) "sphere3.obj", vertices, fv));
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+    RXMeshStatic rx_flat(fv, vertices);
+
+    EXPECT_EQ(rx.get_num_vertices(), rx_flat.get_num_vertices());
+    EXPECT_EQ(rx.get_num_edges(), rx_flat.get_num_edges());
+    EXPECT_EQ(rx.get_num_faces(), rx_flat.get_num_faces());
+    EXPECT_EQ(rx.get_num_patches(), rx_flat.get_num_patches());
+
+    // patching is randomized and so we compare the set of coordinates
+    auto gather = [](RXMeshStatic& mesh) {
+        auto coords = mesh.get_input_vertex_coordinates();
+        std::vector<std::array<float, 3>> ret(mesh.get_num_vertices());
+        mesh.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                ret[mesh.linear_id(vh)][i] = (*coords)(vh, i);
+            }
+        });
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+
+    EXPECT_EQ(gather(rx), gather(rx_flat));
+}
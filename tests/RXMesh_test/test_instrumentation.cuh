@@ -0,0 +1,184 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/instrumentation.h"
+#include "rxmesh/util/report.h"
+
+template <uint32_t blockThreads>
+__global__ static void instrumentation_vv(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint32_t> valence)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+        });
+}
+
+TEST(Util, Instrumentation)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    Instrumentation::get().enable();
+    Instrumentation::get().reset();
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto valence = *rx.add_vertex_attribute<uint32_t>("valence", 1);
+
+    rx.for_each_vertex(
+        DEVICE, [=] __device__(const VertexHandle vh) { valence(vh) = 0; });
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)instrumentation_vv<blockThreads>);
+
+    const int num_runs = 3;
+    for (int i = 0; i < num_runs; ++i) {
+        rx.run_query_kernel(
+            lb, instrumentation_vv<blockThreads>, NULL, valence);
+    }
+    valence.move(DEVICE, HOST);
+
+    auto kernels = Instrumentation::get().get_kernels();
+
+    ASSERT_TRUE(kernels.count("RXMeshStatic::for_each_vertex") == 1);
+    EXPECT_EQ(kernels["RXMeshStatic::for_each_vertex"].num_launches, 1u);
+
+    const std::string name = Instrumentation::kernel_name(
+        (const void*)instrumentation_vv<blockThreads>);
+    ASSERT_TRUE(kernels.count(name) == 1);
+    const KernelRecord& rec = kernels[name];
+    EXPECT_EQ(rec.num_launches, uint32_t(num_runs));
+    EXPECT_EQ(rec.num_blocks, rx.get_num_patches());
+    EXPECT_EQ(rec.num_threads, blockThreads);
+    EXPECT_EQ(rec.dyn_smem, lb.smem_bytes_dyn);
+    EXPECT_GT(rec.time_ms, 0.0);
+    EXPECT_GT(rec.occupancy, 0.f);
+
+    auto bytes = Instrumentation::get().get_bytes();
+    EXPECT_GT(bytes["Attribute::move D2H"], size_t(0));
+
+    Report report("Instrumentation");
+    report.instrumentation();
+    EXPECT_TRUE(report.m_doc.HasMember("Instrumentation"));
+    EXPECT_TRUE(report.m_doc["Instrumentation"]["Kernels"].HasMember(
+        name.c_str()));
+
+    // leave the instrumentation disabled for the other tests
+    Instrumentation::get().release();
+    EXPECT_FALSE(Instrumentation::get().is_enabled());
+    EXPECT_EQ(Instrumentation::get().get_counters(), nullptr);
+
+    CUDA_ERROR(cudaDeviceReset());
+}
+
+template <uint32_t blockThreads>
+__global__ static void instrumentation_splits(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
+TEST(Util, InstrumentationCavityStages)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    // the stage timers are picked by the context when the mesh is created
+    Instrumentation::get().enable();
+    Instrumentation::get().reset();
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto e_op   = rx.add_edge_attribute<uint8_t>("e_op", 1);
+
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        (*e_op)(eh) = static_cast<uint8_t>(
+            eh.local_id() % 10 == 0 ? EdgeOp::Split : EdgeOp::None);
+    });
+    e_op->move(HOST, DEVICE);
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)instrumentation_splits<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        instrumentation_splits<blockThreads><<<launch_box.blocks,
+                                               launch_box.num_threads,
+                                               launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *e_op);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op);
+        rx.cleanup();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    const std::vector<uint32_t> counters =
+        Instrumentation::get().read_counters();
+    EXPECT_GT(counters[uint32_t(Counter::SchedulerPop)], 0u);
+    EXPECT_GT(counters[uint32_t(Counter::CavitySuccess)], 0u);
+
+    const std::vector<unsigned long long> cycles =
+        Instrumentation::get().read_stage_cycles();
+    EXPECT_GT(cycles[uint32_t(Stage::Construct)], 0ull);
+    EXPECT_GT(cycles[uint32_t(Stage::CavityGraph)], 0ull);
+    EXPECT_GT(cycles[uint32_t(Stage::Migrate)], 0ull);
+    EXPECT_GT(cycles[uint32_t(Stage::FillIn)], 0ull);
+    EXPECT_GT(cycles[uint32_t(Stage::Epilogue)], 0ull);
+
+    Report report("Instrumentation");
+    report.instrumentation();
+    EXPECT_TRUE(report.m_doc["Instrumentation"]["Stages"].HasMember(
+        stage_to_string(Stage::Migrate).c_str()));
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+
+    Instrumentation::get().release();
+    EXPECT_EQ(Instrumentation::get().get_stage_cycles(), nullptr);
+}
@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
+#include "rxmesh_test.h"
+
+template <uint32_t blockThreads>
+__global__ static void k_ring_query(
+    const rxmesh::Context                         context,
+    const uint16_t                                k,
+    const uint16_t                                capacity,
+    rxmesh::VertexAttribute<rxmesh::VertexHandle> input,
+    rxmesh::VertexAttribute<rxmesh::VertexHandle> output,
+    rxmesh::VertexAttribute<uint32_t>             truncated)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch_k_ring(
+        block,
+        shrd_alloc,
+        k,
+        capacity,
+        [&](const VertexHandle& vh, const KRingIterator& iter) {
+            input(vh) = vh;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                output(vh, i) = iter[i];
+            }
+            truncated(vh) = iter.is_truncated();
+        });
+}
+
+TEST(RXMeshStatic, KRingQuery)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+    constexpr uint16_t capacity     = 64;
+
+    std::vector<std::vector<dataT>>    Verts;
+    std::vector<std::vector<uint32_t>> Faces;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", Verts, Faces));
+
+    RXMeshStatic rx(Faces);
+
+    auto input     = rx.add_vertex_attribute<VertexHandle>("input", 1);
+    auto output    = rx.add_vertex_attribute<VertexHandle>("output", capacity);
+    auto truncated = rx.add_vertex_attribute<uint32_t>("truncated", 1);
+    input->reset(VertexHandle(), DEVICE);
+    output->reset(VertexHandle(), DEVICE);
+    truncated->reset(0, DEVICE);
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box_k_ring(
+        2, capacity, launch_box, (void*)k_ring_query<blockThreads>);
+    EXPECT_TRUE(rx.is_query_cached(Op::VV));
+
+    // even if the cache is released before the launch, VV is cached again
+    rx.release_query_cache(Op::VV);
+
+    RXMeshTest tester(rx, Faces);
+
+    EXPECT_TRUE(rx.run_k_ring_kernel(launch_box,
+                                     k_ring_query<blockThreads>,
+                                     NULL,
+                                     uint16_t(2),
+                                     capacity,
+                                     *input,
+                                     *output,
+                                     *truncated));
+    EXPECT_TRUE(rx.is_query_cached(Op::VV));
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    input->move(DEVICE, HOST);
+    output->move(DEVICE, HOST);
+    truncated->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ((*truncated)(vh), 0u);
+    });
+
+    EXPECT_TRUE(tester.run_test(rx, Faces, *input, *output, true));
+
+    CUDA_ERROR(cudaDeviceReset());
+}
@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+
+#include "rxmesh/launch_planner.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void launch_planner_vv(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint32_t> valence)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+        });
+}
+
+TEST(RXMeshStatic, LaunchPlanner)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto valence = *rx.add_vertex_attribute<uint32_t>("valence", 1);
+    valence.reset(0, DEVICE);
+
+    const std::string cache_file =
+        (std::filesystem::temp_directory_path() / "rxmesh_launch_cache.txt")
+            .string();
+
+    auto factory = [&](auto& lb) {
+        constexpr uint32_t B = std::decay_t<decltype(lb)>::block_threads;
+        rx.prepare_launch_box({Op::VV}, lb, (void*)launch_planner_vv<B>);
+        return [&, lb]() {
+            launch_planner_vv<B>
+                <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                    rx.get_context(), valence);
+        };
+    };
+
+    LaunchPlanner planner(cache_file);
+    planner.clear();
+
+    LaunchPlan plan = planner.plan<64, 128, 256, 512>(rx, "vv", factory);
+    ASSERT_TRUE(plan.is_valid());
+    EXPECT_FALSE(plan.from_cache);
+    EXPECT_GT(plan.num_blocks_per_sm, 0u);
+    EXPECT_EQ(plan.blocks, rx.get_num_patches());
+
+    // the tuning launched the kernel already but launch it once more with the
+    // selected configuration
+    valence.reset(0, DEVICE);
+    plan();
+    CUDA_ERROR(cudaDeviceSynchronize());
+    valence.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_GT(valence(vh), 0u);
+    });
+
+    // a new planner picks the selection from the cache file without tuning
+    LaunchPlanner other(cache_file);
+    LaunchPlan    cached = other.plan<64, 128, 256, 512>(rx, "vv", factory);
+    EXPECT_TRUE(cached.from_cache);
+    EXPECT_EQ(cached.block_threads, plan.block_threads);
+
+    // a different candidate set that does not contain the cached block size
+    // is tuned again
+    const uint32_t other_bt = plan.block_threads == 64 ? 128 : 64;
+    LaunchPlan     retuned  = (other_bt == 64) ?
+                                  other.plan<64>(rx, "vv", factory) :
+                                  other.plan<128>(rx, "vv", factory);
+    EXPECT_FALSE(retuned.from_cache);
+    EXPECT_EQ(retuned.block_threads, other_bt);
+
+    planner.clear();
+    EXPECT_FALSE(std::filesystem::exists(cache_file));
+}
+
+TEST(RXMeshStatic, LaunchPlannerOccupancy)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto valence = *rx.add_vertex_attribute<uint32_t>("valence", 1);
+
+    int device_id;
+    CUDA_ERROR(cudaGetDevice(&device_id));
+    cudaDeviceProp dev_prop;
+    CUDA_ERROR(cudaGetDeviceProperties(&dev_prop, device_id));
+
+    // the user shared memory grows with the block size such that the largest
+    // candidate can not be launched and should be skipped
+    const size_t smem_per_thread = dev_prop.sharedMemPerBlock / 256;
+
+    uint32_t num_launches = 0;
+
+    auto factory = [&](auto& lb) {
+        constexpr uint32_t B = std::decay_t<decltype(lb)>::block_threads;
+        rx.prepare_launch_box({Op::VV},
+                              lb,
+                              (void*)launch_planner_vv<B>,
+                              false,
+                              false,
+                              false,
+                              [&](uint32_t v, uint32_t e, uint32_t f) {
+                                  return B * smem_per_thread;
+                              });
+        return [&, lb]() {
+            num_launches++;
+            launch_planner_vv<B>
+                <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                    rx.get_context(), valence);
+        };
+    };
+
+    // no trials i.e., the selection is only based on the occupancy
+    LaunchPlanner planner("", 0);
+
+    LaunchPlan plan = planner.plan<64, 128, 512>(rx, "vv_smem", factory);
+    ASSERT_TRUE(plan.is_valid());
+    EXPECT_NE(plan.block_threads, 512u);
+    EXPECT_EQ(num_launches, 0u);
+
+    // in-memory cache
+    LaunchPlan cached = planner.plan<64, 128, 512>(rx, "vv_smem", factory);
+    EXPECT_TRUE(cached.from_cache);
+    EXPECT_EQ(cached.block_threads, plan.block_threads);
+}
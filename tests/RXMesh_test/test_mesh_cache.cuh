@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, MeshCache)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    const std::string cache_file = STRINGIFY(OUTPUT_DIR) "sphere3.rxmc";
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    rx.save_cache(cache_file);
+
+    ASSERT_TRUE(is_mesh_cache(cache_file));
+
+    RXMeshStatic rx_cache(cache_file);
+
+    EXPECT_EQ(rx.get_num_vertices(), rx_cache.get_num_vertices());
+    EXPECT_EQ(rx.get_num_edges(), rx_cache.get_num_edges());
+    EXPECT_EQ(rx.get_num_faces(), rx_cache.get_num_faces());
+    EXPECT_EQ(rx.get_num_patches(), rx_cache.get_num_patches());
+    EXPECT_EQ(rx.get_max_num_patches(), rx_cache.get_max_num_patches());
+    EXPECT_EQ(rx.get_patch_size(), rx_cache.get_patch_size());
+    EXPECT_EQ(rx.get_input_max_valence(), rx_cache.get_input_max_valence());
+    EXPECT_EQ(rx.is_closed(), rx_cache.is_closed());
+    EXPECT_EQ(rx.is_edge_manifold(), rx_cache.is_edge_manifold());
+    EXPECT_EQ(rx.get_num_components(), rx_cache.get_num_components());
+
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        const PatchInfo& pi = rx.get_patch(p);
+        const PatchInfo& pc = rx_cache.get_patch(p);
+
+        ASSERT_EQ(pi.num_vertices[0], pc.num_vertices[0]);
+        ASSERT_EQ(pi.num_edges[0], pc.num_edges[0]);
+        ASSERT_EQ(pi.num_faces[0], pc.num_faces[0]);
+        EXPECT_EQ(rx.get_num_owned_vertices(p),
+                  rx_cache.get_num_owned_vertices(p));
+        EXPECT_EQ(rx.get_num_owned_edges(p), rx_cache.get_num_owned_edges(p));
+        EXPECT_EQ(rx.get_num_owned_faces(p), rx_cache.get_num_owned_faces(p));
+
+        EXPECT_EQ(std::memcmp(pi.ev,
+                              pc.ev,
+                              2 * pi.num_edges[0] * sizeof(LocalVertexT)),
+                  0);
+        EXPECT_EQ(std::memcmp(pi.fe,
+                              pc.fe,
+                              3 * pi.num_faces[0] * sizeof(LocalEdgeT)),
+                  0);
+        EXPECT_EQ(pi.lp_v.get_capacity(), pc.lp_v.get_capacity());
+        EXPECT_EQ(pi.lp_e.get_capacity(), pc.lp_e.get_capacity());
+        EXPECT_EQ(pi.lp_f.get_capacity(), pc.lp_f.get_capacity());
+    }
+
+    auto coords       = rx.get_input_vertex_coordinates();
+    auto coords_cache = rx_cache.get_input_vertex_coordinates();
+
+    for (uint32_t v = 0; v < rx.get_num_vertices(); ++v) {
+        const VertexHandle vh = rx.map_to_local_vertex(v);
+        EXPECT_EQ(vh, rx_cache.map_to_local_vertex(v));
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ((*coords)(vh, i), (*coords_cache)(vh, i));
+        }
+    }
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
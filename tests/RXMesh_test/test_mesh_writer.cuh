@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/mesh_writer.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+#include "rxmesh/util/import_mesh.h"
+
+template <uint32_t blockThreads>
+__global__ static void mesh_writer_splits(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
+TEST(RXMeshDynamic, MeshWriter)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    // compare a written file against the host side of the mesh
+    auto check = [&](const std::string& filename) {
+        std::vector<float>    vertices;
+        std::vector<uint32_t> fv;
+        ASSERT_TRUE(import_mesh(filename, vertices, fv));
+
+        std::vector<glm::vec3> v_list;
+        rx.create_vertex_list(v_list, *coords);
+        std::vector<glm::uvec3> f_list;
+        rx.create_face_list(f_list);
+
+        ASSERT_EQ(vertices.size(), 3 * v_list.size());
+        ASSERT_EQ(fv.size(), 3 * f_list.size());
+        for (size_t v = 0; v < v_list.size(); ++v) {
+            for (int i = 0; i < 3; ++i) {
+                EXPECT_EQ(vertices[3 * v + i], v_list[v][i]);
+            }
+        }
+        for (size_t f = 0; f < f_list.size(); ++f) {
+            for (int i = 0; i < 3; ++i) {
+                EXPECT_EQ(fv[3 * f + i], f_list[f][i]);
+            }
+        }
+    };
+
+    MeshWriter<float> writer;
+
+    const std::string ply_file = STRINGIFY(OUTPUT_DIR) "sphere3_writer.ply";
+    const std::string obj_file = STRINGIFY(OUTPUT_DIR) "sphere3_writer.obj";
+
+    EXPECT_FALSE(writer.write(rx, *coords, "sphere3_writer.txt"));
+
+    EXPECT_TRUE(writer.write(rx, *coords, ply_file));
+    EXPECT_TRUE(writer.write(rx, *coords, obj_file));
+    EXPECT_TRUE(writer.wait());
+    EXPECT_EQ(writer.get_num_vertices(), rx.get_num_vertices());
+    EXPECT_EQ(writer.get_num_faces(), rx.get_num_faces());
+
+    check(ply_file);
+    check(obj_file);
+
+    // split some edges and write the mesh without updating the host first
+    auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        (*e_op)(eh) = static_cast<uint8_t>(
+            eh.local_id() % 5 == 0 ? EdgeOp::Split : EdgeOp::None);
+    });
+    e_op->move(HOST, DEVICE);
+
+    rx.reset_scheduler();
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)mesh_writer_splits<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        mesh_writer_splits<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(rx.get_context(), *coords, *e_op);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op);
+        rx.cleanup();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    const uint32_t num_faces = rx.get_num_faces();
+
+    EXPECT_TRUE(writer.write(rx, *coords, ply_file));
+    EXPECT_TRUE(writer.wait());
+    EXPECT_GT(writer.get_num_faces(), num_faces);
+
+    rx.update_host();
+    coords->move(DEVICE, HOST);
+    EXPECT_EQ(writer.get_num_vertices(), rx.get_num_vertices());
+    EXPECT_EQ(writer.get_num_faces(), rx.get_num_faces());
+
+    check(ply_file);
+
+    writer.release();
+
+    // more frames in flight, each signaling once its mesh is compacted
+    MeshWriter<float> pipelined(3);
+    EXPECT_EQ(pipelined.get_num_slots(), 3);
+
+    cudaEvent_t compacted;
+    CUDA_ERROR(cudaEventCreateWithFlags(&compacted, cudaEventDisableTiming));
+    for (int frame = 0; frame < 5; ++frame) {
+        EXPECT_TRUE(pipelined.write(
+            rx,
+            *coords,
+            STRINGIFY(OUTPUT_DIR) "sphere3_writer_" + std::to_string(frame) +
+                ".ply",
+            NULL,
+            compacted));
+        CUDA_ERROR(cudaEventSynchronize(compacted));
+    }
+    EXPECT_TRUE(pipelined.wait());
+    CUDA_ERROR(cudaEventDestroy(compacted));
+
+    check(STRINGIFY(OUTPUT_DIR) "sphere3_writer_4.ply");
+
+    pipelined.release();
+}
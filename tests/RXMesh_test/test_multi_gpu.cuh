@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void multi_gpu_valence(
+    const rxmesh::Context          context,
+    rxmesh::VertexAttribute<float> valence)
+{
+    using namespace rxmesh;
+    auto compute_valence = [&](VertexHandle& vh, const VertexIterator& iter) {
+        valence(vh) = iter.size();
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, compute_valence);
+}
+
+TEST(RXMeshStatic, MultiGPU)
+{
+    using namespace rxmesh;
+
+    constexpr uint32_t blockThreads = 256;
+
+    int num_devices = 0;
+    CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+
+    // with a single device (or without peer access), the partition falls back
+    // to one GPU and the results should still be the same
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                    "",
+                    64,
+                    1.0,
+                    1.0,
+                    0.8,
+                    -1,
+                    0,
+                    2);
+
+    const PatchPartition& partition = rx.get_partition();
+    EXPECT_GE(partition.get_num_gpus(), 1);
+    EXPECT_LE(partition.get_num_gpus(), std::min(num_devices, 2));
+    EXPECT_EQ(rx.is_multi_gpu(), partition.get_num_gpus() > 1);
+
+    // the GPUs own consecutive and disjoint patches that cover all patches
+    uint32_t next = 0;
+    for (int g = 0; g < partition.get_num_gpus(); ++g) {
+        EXPECT_EQ(partition.get_patch_begin(g), next);
+        EXPECT_GT(partition.get_patch_count(g), 0);
+        next += partition.get_patch_count(g);
+        for (uint32_t p : partition.get_halo_patches(g)) {
+            EXPECT_NE(partition.get_patch_gpu(p), g);
+        }
+    }
+    EXPECT_EQ(next, rx.get_num_patches());
+
+    auto coords  = *rx.get_input_vertex_coordinates();
+    auto scaled  = *rx.add_vertex_attribute<float>("scaled", 3);
+    auto valence = *rx.add_vertex_attribute<float>("valence", 1);
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+        for (int i = 0; i < 3; ++i) {
+            scaled(vh, i) = 2.f * coords(vh, i);
+        }
+    });
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)multi_gpu_valence<blockThreads>);
+    rx.run_query_kernel(lb, multi_gpu_valence<blockThreads>, NULL, valence);
+
+    // the sum of the valence is twice the number of edges
+    VertexReduceHandle<float> reduce(valence);
+    EXPECT_EQ(reduce.reduce(valence, cub::Sum(), 0.f),
+              2.f * rx.get_num_edges());
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    scaled.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(scaled(vh, i), 2.f * coords(vh, i));
+        }
+    });
+
+    CUDA_ERROR(cudaDeviceReset());
+}
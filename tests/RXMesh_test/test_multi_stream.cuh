@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void multi_stream_splits(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
+template <uint32_t blockThreads>
+__global__ static void multi_stream_vv(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint32_t> valence)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+        });
+}
+
+TEST(RXMeshDynamic, StreamScheduler)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
+
+    // the default stream uses the context scheduler which is filled on
+    // construction while a new stream gets its own empty scheduler
+    EXPECT_EQ(rx.get_scheduler().list,
+              rx.get_context().m_patch_scheduler.list);
+    EXPECT_NE(rx.get_scheduler(stream).list, rx.get_scheduler().list);
+    EXPECT_EQ(rx.get_scheduler(stream).list,
+              rx.get_context(stream).m_patch_scheduler.list);
+
+    EXPECT_FALSE(rx.is_queue_empty());
+    EXPECT_TRUE(rx.is_queue_empty(stream));
+
+    rx.reset_scheduler(stream);
+    EXPECT_FALSE(rx.is_queue_empty(stream));
+    EXPECT_EQ(rx.get_scheduler(stream).size(stream),
+              int(rx.get_num_patches()));
+
+    // refilling one scheduler does not change the other
+    std::vector<uint32_t> priority(rx.get_num_patches(), 0);
+    priority[0] = 1;
+    rx.reset_scheduler(priority);
+    EXPECT_EQ(rx.get_scheduler().size(), 1);
+    EXPECT_EQ(rx.get_scheduler(stream).size(stream),
+              int(rx.get_num_patches()));
+
+    CUDA_ERROR(cudaStreamDestroy(stream));
+}
+
+TEST(RXMeshDynamic, MultiStream)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    // two independent remeshing jobs, each on its own stream, overlap with an
+    // analysis kernel on a third stream
+    constexpr int num_jobs = 2;
+
+    std::vector<std::unique_ptr<RXMeshDynamic>> meshes;
+    std::vector<cudaStream_t>                   streams(num_jobs + 1);
+    for (auto& s : streams) {
+        CUDA_ERROR(cudaStreamCreate(&s));
+    }
+
+    std::vector<std::shared_ptr<EdgeAttribute<uint8_t>>> e_ops;
+    std::vector<uint32_t>                                num_faces;
+    for (int j = 0; j < num_jobs; ++j) {
+        meshes.emplace_back(
+            new RXMeshDynamic(STRINGIFY(INPUT_DIR) "sphere3.obj"));
+        RXMeshDynamic& rx = *meshes.back();
+        num_faces.push_back(rx.get_num_faces());
+
+        auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+        rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+            (*e_op)(eh) = static_cast<uint8_t>(
+                eh.local_id() % 10 == j ? EdgeOp::Split : EdgeOp::None);
+        });
+        e_op->move(HOST, DEVICE);
+        e_ops.push_back(e_op);
+
+        rx.reset_scheduler(streams[j]);
+    }
+
+    RXMeshStatic analysis(STRINGIFY(INPUT_DIR) "sphere3.obj");
+    auto valence = *analysis.add_vertex_attribute<uint32_t>("valence", 1);
+    valence.reset(0, DEVICE);
+
+    LaunchBox<blockThreads> vv_lb;
+    analysis.prepare_launch_box(
+        {Op::VV}, vv_lb, (void*)multi_stream_vv<blockThreads>);
+
+    bool done = false;
+    while (!done) {
+        done = true;
+        for (int j = 0; j < num_jobs; ++j) {
+            RXMeshDynamic& rx     = *meshes[j];
+            cudaStream_t   stream = streams[j];
+            if (rx.is_queue_empty(stream)) {
+                continue;
+            }
+            done = false;
+
+            auto coords = rx.get_input_vertex_coordinates();
+
+            LaunchBox<blockThreads> launch_box;
+            rx.update_launch_box({Op::EVDiamond},
+                                 launch_box,
+                                 (void*)multi_stream_splits<blockThreads>,
+                                 true,
+                                 false,
+                                 false,
+                                 false,
+                                 edge_ops_shmem_bytes);
+
+            multi_stream_splits<blockThreads>
+                <<<launch_box.blocks,
+                   launch_box.num_threads,
+                   launch_box.smem_bytes_dyn,
+                   stream>>>(rx.get_context(stream), *coords, *e_ops[j]);
+
+            rx.cleanup(stream);
+            rx.slice_patches(stream, *coords, *e_ops[j]);
+            rx.cleanup(stream);
+        }
+
+        analysis.run_query_kernel(
+            vv_lb, multi_stream_vv<blockThreads>, streams[num_jobs], valence);
+    }
+
+    for (auto& s : streams) {
+        CUDA_ERROR(cudaStreamSynchronize(s));
+    }
+    CUDA_ERROR(cudaGetLastError());
+
+    for (int j = 0; j < num_jobs; ++j) {
+        RXMeshDynamic& rx = *meshes[j];
+        rx.update_host();
+        EXPECT_TRUE(rx.validate());
+        EXPECT_GT(rx.get_num_faces(), num_faces[j]);
+
+        // the default scheduler was not used by the job
+        EXPECT_FALSE(rx.is_queue_empty());
+    }
+
+    valence.move(DEVICE, HOST);
+    analysis.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_GT(valence(vh), 0u);
+    });
+
+    e_ops.clear();
+    meshes.clear();
+    for (auto& s : streams) {
+        CUDA_ERROR(cudaStreamDestroy(s));
+    }
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/patch_coloring.h"
+#include "rxmesh/rxmesh_dynamic.h"
+
+TEST(RXMeshDynamic, PatchColoringIncremental)
+{
+    using namespace rxmesh;
+
+    // a path of 4 patches 0-1-2-3
+    constexpr uint32_t    ss = PatchStash::stash_size;
+    std::vector<uint32_t> stash(5 * ss, INVALID32);
+    stash[0 * ss] = 1;
+    stash[1 * ss] = 2;
+    stash[2 * ss] = 3;
+
+    PatchColoring coloring;
+    EXPECT_EQ(coloring.update(stash, 4), 4u);
+    EXPECT_EQ(coloring.get_num_colors(), 3u);
+    EXPECT_EQ(coloring.get_color(0), 0u);
+    EXPECT_EQ(coloring.get_color(1), 1u);
+    EXPECT_EQ(coloring.get_color(2), 2u);
+    EXPECT_EQ(coloring.get_color(3), 0u);
+
+    // nothing changed
+    EXPECT_EQ(coloring.update(stash, 4), 0u);
+
+    // add patch 4 next to patch 3 (e.g., after slicing patch 3). Only patch 3
+    // and 4 are recolored
+    stash[4 * ss] = 3;
+    EXPECT_EQ(coloring.update(stash, 5), 2u);
+    EXPECT_EQ(coloring.get_color(0), 0u);
+    EXPECT_EQ(coloring.get_color(1), 1u);
+    EXPECT_EQ(coloring.get_color(2), 2u);
+    EXPECT_EQ(coloring.get_color(3), 0u);
+    EXPECT_EQ(coloring.get_color(4), 1u);
+}
+
+TEST(RXMeshDynamic, PatchColoring)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const uint32_t num_colors = rx.color_patches();
+    EXPECT_GE(num_colors, 1u);
+
+    const PatchColoring& coloring = rx.get_patch_coloring();
+
+    // every patch has exactly one color
+    uint32_t num_colored = 0;
+    for (uint32_t c = 0; c < num_colors; ++c) {
+        num_colored += coloring.get_patches(c).size();
+    }
+    EXPECT_EQ(num_colored, rx.get_num_patches());
+
+    // a patch and its neighbors (i.e., the patches that may lock it) all have
+    // different colors
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        std::vector<uint32_t> lockers = coloring.get_neighbors(p);
+        lockers.push_back(p);
+        for (uint32_t i = 0; i < lockers.size(); ++i) {
+            for (uint32_t j = i + 1; j < lockers.size(); ++j) {
+                EXPECT_NE(coloring.get_color(lockers[i]),
+                          coloring.get_color(lockers[j]));
+            }
+        }
+    }
+
+    for (uint32_t c = 0; c < num_colors; ++c) {
+        rx.reset_scheduler_to_color(c);
+        EXPECT_FALSE(rx.is_queue_empty());
+    }
+
+    // re-coloring the same patch graph does not change anything
+    EXPECT_EQ(rx.color_patches(), num_colors);
+}
@@ -2,6 +2,7 @@
 
 #include <numeric>
 
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/patch_lock.h"
 #include "rxmesh/rxmesh_dynamic.h"
 #include "rxmesh/util/util.h"
@@ -58,6 +59,88 @@ __global__ static void lock_kernel(rxmesh::Context context,
     }
 }
 
+__global__ static void version_kernel(rxmesh::Context context,
+                                      uint32_t*       d_versions,
+                                      uint32_t*       d_status)
+{
+    using namespace rxmesh;
+
+    const uint32_t num_patches = context.m_num_patches[0];
+    uint32_t*      versions    = d_versions + blockIdx.x * num_patches;
+
+    if (threadIdx.x == 0) {
+        // read the version of all patches
+        bool st = true;
+        for (uint32_t p = 0; p < num_patches && st; ++p) {
+            st = context.m_patches_info[p].lock.read_version(versions[p]);
+        }
+
+        // commit to all patches in order and undo on the first failure
+        if (st) {
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                st = context.m_patches_info[p].lock.try_commit(versions[p]);
+                if (!st) {
+                    for (uint32_t q = 0; q < p; ++q) {
+                        context.m_patches_info[q].lock.abort_commit();
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (st) {
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                context.m_patches_info[p].lock.end_commit();
+            }
+        }
+        d_status[blockIdx.x] = st;
+    }
+}
+
+__global__ static void read_version_kernel(rxmesh::Context context,
+                                           uint32_t*       d_versions)
+{
+    const uint32_t p = threadIdx.x + blockIdx.x * blockDim.x;
+    if (p < context.m_num_patches[0]) {
+        uint32_t v = 0;
+        if (!context.m_patches_info[p].lock.read_version(v)) {
+            v = rxmesh::INVALID32;
+        }
+        d_versions[p] = v;
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void optimistic_splits(rxmesh::Context                context,
+                                         rxmesh::VertexAttribute<float> coords,
+                                         rxmesh::EdgeAttribute<uint8_t> e_op)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    apply_edge_ops<blockThreads>(
+        block,
+        context,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            return static_cast<EdgeOp>(e_op(eh));
+        },
+        [&](const VertexHandle& vh,
+            const VertexHandle& v0,
+            const VertexHandle& v1,
+            const float         t) {
+            for (int i = 0; i < 3; ++i) {
+                coords(vh, i) = (1.f - t) * coords(v0, i) + t * coords(v1, i);
+            }
+        },
+        [&](const EdgeHandle& eh) {
+            e_op(eh) = static_cast<uint8_t>(EdgeOp::None);
+        },
+        coords,
+        e_op);
+}
+
 TEST(RXMeshDynamic, PatchLock)
 {
     using namespace rxmesh;
@@ -106,3 +189,150 @@ TEST(RXMeshDynamic, PatchLock)
     GPU_FREE(d_block_patch);
     GPU_FREE(d_status);
 }
+
+TEST(RXMeshDynamic, PatchVersion)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "cloth.obj");
+
+    const uint32_t num_patches = rx.get_num_patches();
+
+    uint32_t *d_status, *d_versions;
+    CUDA_ERROR(cudaMalloc((void**)&d_status, num_patches * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_versions,
+                          num_patches * num_patches * sizeof(uint32_t)));
+
+    std::vector<uint32_t> h_status(num_patches);
+
+    // every successful commit bumps the version of every patch by two while a
+    // failed one leaves all versions as they were
+    uint32_t num_success = 0;
+    for (int i = 0; i < 100; ++i) {
+        version_kernel<<<num_patches, 256>>>(
+            rx.get_context(), d_versions, d_status);
+
+        CUDA_ERROR(cudaMemcpy(h_status.data(),
+                              d_status,
+                              num_patches * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+
+        uint32_t sum = std::accumulate(h_status.begin(), h_status.end(), 0);
+        EXPECT_GE(sum, 1);
+        num_success += sum;
+    }
+
+    read_version_kernel<<<DIVIDE_UP(num_patches, 256), 256>>>(rx.get_context(),
+                                                              d_versions);
+    std::vector<uint32_t> h_versions(num_patches);
+    CUDA_ERROR(cudaMemcpy(h_versions.data(),
+                          d_versions,
+                          num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        EXPECT_EQ(h_versions[p], 2 * num_success);
+    }
+
+    GPU_FREE(d_versions);
+    GPU_FREE(d_status);
+}
+
+TEST(RXMeshDynamic, OptimisticCavity)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    EXPECT_FALSE(rx.is_optimistic());
+    rx.set_optimistic(true);
+    EXPECT_TRUE(rx.is_optimistic());
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    const uint32_t num_faces = rx.get_num_faces();
+
+    auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        (*e_op)(eh) = static_cast<uint8_t>(
+            eh.local_id() % 5 == 0 ? EdgeOp::Split : EdgeOp::None);
+    });
+    e_op->move(HOST, DEVICE);
+
+    rx.reset_scheduler();
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)optimistic_splits<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        optimistic_splits<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(rx.get_context(), *coords, *e_op);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op);
+        rx.cleanup();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+    EXPECT_GT(rx.get_num_faces(), num_faces);
+}
+
+TEST(RXMeshDynamic, OptimisticContention)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    // small patches and every edge is split so that neighbor blocks keep
+    // changing the patches that others are reading without a lock
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", 64);
+    ASSERT_GT(rx.get_num_patches(), 8);
+
+    rx.set_optimistic(true);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    const uint32_t num_faces = rx.get_num_faces();
+
+    auto e_op = rx.add_edge_attribute<uint8_t>("e_op", 1);
+    e_op->reset(static_cast<uint8_t>(EdgeOp::Split), HOST);
+    e_op->move(HOST, DEVICE);
+
+    rx.reset_scheduler();
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.update_launch_box({Op::EVDiamond},
+                             launch_box,
+                             (void*)optimistic_splits<blockThreads>,
+                             true,
+                             false,
+                             false,
+                             false,
+                             edge_ops_shmem_bytes);
+
+        optimistic_splits<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(rx.get_context(), *coords, *e_op);
+
+        rx.cleanup();
+        rx.slice_patches(*coords, *e_op);
+        rx.cleanup();
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+    EXPECT_GT(rx.get_num_faces(), num_faces);
+}
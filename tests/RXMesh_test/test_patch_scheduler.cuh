@@ -2,6 +2,7 @@
 
 #include <numeric>
 
+#include "rxmesh/cavity_manager.cuh"
 #include "rxmesh/patch_scheduler.cuh"
 
 __global__ void schedule_kernel(uint32_t* d_status, rxmesh::PatchScheduler sch)
@@ -66,3 +67,137 @@ TEST(RXMeshDynamic, PatchScheduler)
     GPU_FREE(d_status);
     sch.free();
 }
+
+__global__ void steal_kernel(uint32_t* d_seen, rxmesh::PatchScheduler sch)
+{
+    // the first thread in the block keeps popping patches until the whole
+    // queue (i.e., all ring buffers) is empty
+    using namespace rxmesh;
+    if (threadIdx.x == 0) {
+        while (true) {
+            const uint32_t pid = sch.pop();
+            if (pid == INVALID32) {
+                if (sch.is_empty()) {
+                    break;
+                }
+                continue;
+            }
+            ::atomicAdd(d_seen + pid, 1);
+        }
+    }
+}
+
+TEST(RXMeshDynamic, PatchSchedulerWorkStealing)
+{
+    using namespace rxmesh;
+
+    auto prop = cuda_query(rxmesh_args.device_id);
+
+    const uint32_t num_queues  = prop.multiProcessorCount;
+    const uint32_t num_patches = num_queues * 5;
+
+    PatchScheduler sch;
+    sch.init(num_patches, num_queues);
+
+    // only patches with pending work are added to the queue
+    std::vector<uint32_t> priority(num_patches);
+    uint32_t              num_pending = 0;
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        priority[p] = p % 3;
+        if (priority[p] > 0) {
+            num_pending++;
+        }
+    }
+    sch.refill(num_patches, priority);
+    EXPECT_EQ(sch.size(), static_cast<int>(num_pending));
+
+    uint32_t* d_seen;
+    CUDA_ERROR(cudaMalloc((void**)&d_seen, sizeof(uint32_t) * num_patches));
+    CUDA_ERROR(cudaMemset(d_seen, 0, sizeof(uint32_t) * num_patches));
+
+    // launch less blocks than ring buffers so blocks have to steal patches
+    // from the ring buffers of other SMs
+    steal_kernel<<<std::max(num_queues / 2, 1u), 32>>>(d_seen, sch);
+
+    std::vector<uint32_t> h_seen(num_patches);
+    CUDA_ERROR(cudaMemcpy(h_seen.data(),
+                          d_seen,
+                          sizeof(uint32_t) * num_patches,
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        EXPECT_EQ(h_seen[p], priority[p] > 0 ? 1u : 0u);
+    }
+    EXPECT_TRUE(sch.is_empty());
+
+    GPU_FREE(d_seen);
+    sch.free();
+}
+
+__global__ void persistent_kernel(uint32_t* d_visits, rxmesh::Context context)
+{
+    // every patch is pushed back the first time it is popped (as if it was
+    // not processed due to a conflict) so the blocks keep popping from ring
+    // buffers that other blocks are pushing to and popping from
+    using namespace rxmesh;
+    namespace cg = cooperative_groups;
+
+    cg::thread_block block = cg::this_thread_block();
+
+    __shared__ uint32_t s_pid;
+
+    persistent_patch_loop(block, context, [&](ShmemAllocator& shrd_alloc) {
+        if (threadIdx.x == 0) {
+            s_pid = context.m_patch_scheduler.pop();
+            if (s_pid != INVALID32) {
+                if (::atomicAdd(d_visits + s_pid, 1) == 0) {
+                    context.m_patch_scheduler.push(s_pid);
+                }
+            }
+        }
+        block.sync();
+        return s_pid != INVALID32;
+    });
+}
+
+TEST(RXMeshDynamic, PersistentPatchLoop)
+{
+    using namespace rxmesh;
+
+    auto prop = cuda_query(rxmesh_args.device_id);
+
+    const uint32_t num_queues  = prop.multiProcessorCount;
+    const uint32_t num_patches = num_queues * 5;
+
+    PatchScheduler sch;
+    sch.init(num_patches, num_queues);
+    sch.refill(num_patches);
+
+    Context context;
+    context.m_patch_scheduler = sch;
+
+    uint32_t* d_visits;
+    CUDA_ERROR(cudaMalloc((void**)&d_visits, sizeof(uint32_t) * num_patches));
+    CUDA_ERROR(cudaMemset(d_visits, 0, sizeof(uint32_t) * num_patches));
+
+    // less blocks than ring buffers so blocks also pop from (and find
+    // transiently empty) ring buffers of other SMs. A block should not leave
+    // the loop while any patch is still queued
+    persistent_kernel<<<std::max(num_queues / 2, 1u), 64>>>(d_visits,
+                                                            context);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    std::vector<uint32_t> h_visits(num_patches);
+    CUDA_ERROR(cudaMemcpy(h_visits.data(),
+                          d_visits,
+                          sizeof(uint32_t) * num_patches,
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        EXPECT_EQ(h_visits[p], 2u);
+    }
+    EXPECT_TRUE(sch.is_empty());
+
+    GPU_FREE(d_visits);
+    sch.free();
+}
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "rxmesh/patcher/patcher.h"
+#include "rxmesh/util/import_obj.h"
+#include "rxmesh/util/util.h"
+
+/**
+ * @brief the input of the patcher i.e., the faces, the edges map, and the
+ * face adjacent faces, built on the host from an obj file
+ */
+struct PatcherInput
+{
+    using EdgeMapT = std::unordered_map<std::pair<uint32_t, uint32_t>,
+                                        uint32_t,
+                                        rxmesh::detail::edge_key_hash>;
+
+    explicit PatcherInput(const std::string& file_name)
+    {
+        using namespace rxmesh;
+
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> faces;
+        import_obj(file_name, verts, faces);
+
+        num_vertices = verts.size();
+
+        std::vector<std::vector<uint32_t>> ef;
+        for (uint32_t f = 0; f < faces.size(); ++f) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                fv.push_back(faces[f][i]);
+                auto key = detail::edge_key(faces[f][i], faces[f][(i + 1) % 3]);
+                auto it  = edges_map.find(key);
+                if (it == edges_map.end()) {
+                    it = edges_map.emplace(key, ef.size()).first;
+                    ef.emplace_back();
+                }
+                ef[it->second].push_back(f);
+            }
+        }
+
+        for (uint32_t f = 0; f < faces.size(); ++f) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                auto key = detail::edge_key(faces[f][i], faces[f][(i + 1) % 3]);
+                for (const uint32_t n : ef[edges_map.at(key)]) {
+                    if (n != f) {
+                        ff_values.push_back(n);
+                    }
+                }
+            }
+            ff_offset.push_back(ff_values.size());
+        }
+    }
+
+    rxmesh::patcher::Patcher build(const uint32_t patch_size,
+                                   const bool     deterministic,
+                                   const bool     reorder,
+                                   const bool     balance) const
+    {
+        return rxmesh::patcher::Patcher(patch_size,
+                                        ff_offset,
+                                        ff_values,
+                                        fv,
+                                        edges_map,
+                                        num_vertices,
+                                        edges_map.size(),
+                                        nullptr,
+                                        nullptr,
+                                        deterministic,
+                                        reorder,
+                                        balance);
+    }
+
+    std::vector<uint32_t> fv;
+    std::vector<uint32_t> ff_offset;
+    std::vector<uint32_t> ff_values;
+    EdgeMapT              edges_map;
+    uint32_t              num_vertices;
+};
+
+inline uint32_t max_patch_size(rxmesh::patcher::Patcher& patcher)
+{
+    uint32_t ret = 0;
+    for (uint32_t p = 0; p < patcher.get_num_patches(); ++p) {
+        const uint32_t start =
+            (p == 0) ? 0 : patcher.get_patches_offset()[p - 1];
+        ret = std::max(ret, patcher.get_patches_offset()[p] - start);
+    }
+    return ret;
+}
+
+TEST(RXMesh, PatcherBalance)
+{
+    using namespace rxmesh;
+
+    PatcherInput input(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    // deterministic so that both run Lloyd to the same patches and only
+    // differ by balancing
+    auto lloyd    = input.build(128, true, false, false);
+    auto balanced = input.build(128, true, false, true);
+
+    EXPECT_LE(balanced.get_max_patch_smem_estimate(input.fv),
+              lloyd.get_max_patch_smem_estimate(input.fv));
+    EXPECT_LE(max_patch_size(balanced), max_patch_size(lloyd));
+
+    const uint32_t num_faces = input.fv.size() / 3;
+    EXPECT_EQ(balanced.get_patches_offset()[balanced.get_num_patches() - 1],
+              num_faces);
+    for (uint32_t p = 0; p < balanced.get_num_patches(); ++p) {
+        const uint32_t start =
+            (p == 0) ? 0 : balanced.get_patches_offset()[p - 1];
+        EXPECT_GT(balanced.get_patches_offset()[p], start);
+        for (uint32_t f = start; f < balanced.get_patches_offset()[p]; ++f) {
+            EXPECT_EQ(
+                balanced.get_face_patch_id(balanced.get_patches_val()[f]), p);
+        }
+    }
+}
+
+TEST(RXMesh, PatcherDeterministic)
+{
+    using namespace rxmesh;
+
+    PatcherInput input(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    auto p0 = input.build(128, true, true, true);
+    auto p1 = input.build(128, true, true, true);
+
+    ASSERT_EQ(p0.get_num_patches(), p1.get_num_patches());
+    ASSERT_EQ(p0.get_face_patch().size(), p1.get_face_patch().size());
+    EXPECT_EQ(std::memcmp(p0.get_face_patch().data(),
+                          p1.get_face_patch().data(),
+                          p0.get_face_patch().size() * sizeof(uint32_t)),
+              0);
+}
+
+/**
+ * @brief the bandwidth of the patch graph i.e., the max difference between
+ * the ids of two neighbor patches
+ */
+inline uint32_t patch_graph_bandwidth(const PatcherInput&       input,
+                                      rxmesh::patcher::Patcher& patcher)
+{
+    uint32_t ret = 0;
+    for (uint32_t f = 0; f < input.ff_offset.size(); ++f) {
+        const uint32_t start = (f == 0) ? 0 : input.ff_offset[f - 1];
+        const uint32_t p     = patcher.get_face_patch_id(f);
+        for (uint32_t i = start; i < input.ff_offset[f]; ++i) {
+            const uint32_t q = patcher.get_face_patch_id(input.ff_values[i]);
+            ret              = std::max(ret, p > q ? p - q : q - p);
+        }
+    }
+    return ret;
+}
+
+TEST(RXMesh, PatcherReorder)
+{
+    using namespace rxmesh;
+
+    PatcherInput input(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    auto lloyd     = input.build(128, true, false, false);
+    auto reordered = input.build(128, true, true, false);
+
+    EXPECT_EQ(reordered.get_num_patches(), lloyd.get_num_patches());
+    EXPECT_LE(patch_graph_bandwidth(input, reordered),
+              patch_graph_bandwidth(input, lloyd));
+}
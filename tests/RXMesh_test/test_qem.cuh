@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rxmesh/qem.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+TEST(RXMeshDynamic, QEM)
+{
+    using namespace rxmesh;
+
+    auto run = [](std::vector<std::array<float, 3>>& out) {
+        RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+        auto coords = rx.get_input_vertex_coordinates();
+
+        glm::vec3 lower, upper;
+        rx.bounding_box(lower, upper);
+        const glm::vec3 center = 0.5f * (lower + upper);
+        const float     radius = 0.5f * (upper[0] - lower[0]);
+
+        const uint32_t num_faces = rx.get_num_faces();
+        const uint32_t target    = num_faces / 4;
+
+        QEMSimplifier<float> qem(rx, *coords);
+
+        const uint32_t final_num_faces = qem.simplify(target);
+        EXPECT_GT(qem.get_num_rounds(), 0u);
+
+        rx.update_host();
+        coords->move(DEVICE, HOST);
+
+        EXPECT_TRUE(rx.validate());
+        EXPECT_EQ(rx.get_num_faces(), final_num_faces);
+        EXPECT_LE(rx.get_num_faces(), target);
+        EXPECT_GT(rx.get_num_faces(), target / 2);
+
+        // the simplified mesh should still approximate the sphere
+        out.clear();
+        rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            const glm::vec3 p(
+                (*coords)(vh, 0), (*coords)(vh, 1), (*coords)(vh, 2));
+            EXPECT_NEAR(glm::length(p - center), radius, 0.05f * radius);
+            out.push_back({p[0], p[1], p[2]});
+        });
+        std::sort(out.begin(), out.end());
+    };
+
+    // the output does not depend on the patches (which are seeded randomly)
+    // nor on the order in which they are processed
+    std::vector<std::array<float, 3>> first, second;
+    run(first);
+    run(second);
+
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_EQ(first[i][j], second[i][j]);
+        }
+    }
+}
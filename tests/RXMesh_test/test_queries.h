@@ -103,7 +103,7 @@ TEST(RXMeshStatic, Queries)
     ASSERT_TRUE(import_obj(rxmesh_args.obj_file_name, Verts, Faces));
 
     
-    RXMeshStatic rx(Faces);
+    RXMeshStatic rx(Faces, "", rxmesh_args.patch_size);
 
 
     // Report
@@ -114,6 +114,7 @@ TEST(RXMeshStatic, Queries)
     report.system();
     report.model_data(rxmesh_args.obj_file_name, rx);
     report.add_member("method", std::string("RXMesh"));
+    report.add_member("patch_size", rxmesh_args.patch_size);
 
 
     // Tester to verify all queries
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void query_cache_vv(const rxmesh::Context             context,
+                                      rxmesh::VertexAttribute<uint32_t> size,
+                                      rxmesh::VertexAttribute<uint64_t> sum)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            uint64_t s = 0;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                s += iter[i].unique_id();
+            }
+            size(vh) = iter.size();
+            sum(vh)  = s;
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_cache_fv(const rxmesh::Context           context,
+                                      rxmesh::FaceAttribute<uint64_t> fv)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                fv(fh, i) = iter[i].unique_id();
+            }
+        });
+}
+
+TEST(RXMeshStatic, QueryCache)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto size_gt = *rx.add_vertex_attribute<uint32_t>("size_gt", 1);
+    auto sum_gt  = *rx.add_vertex_attribute<uint64_t>("sum_gt", 1);
+    auto fv_gt   = *rx.add_face_attribute<uint64_t>("fv_gt", 3);
+    auto size    = *rx.add_vertex_attribute<uint32_t>("size", 1);
+    auto sum     = *rx.add_vertex_attribute<uint64_t>("sum", 1);
+    auto fv      = *rx.add_face_attribute<uint64_t>("fv", 3);
+    size.reset(0, LOCATION_ALL);
+    sum.reset(0, LOCATION_ALL);
+    fv.reset(0, LOCATION_ALL);
+
+    LaunchBox<blockThreads> lb_vv, lb_fv;
+    rx.prepare_launch_box(
+        {Op::VV}, lb_vv, (void*)query_cache_vv<blockThreads>);
+    rx.prepare_launch_box(
+        {Op::FV}, lb_fv, (void*)query_cache_fv<blockThreads>);
+
+    // ground truth without the cache
+    rx.run_query_kernel(
+        lb_vv, query_cache_vv<blockThreads>, NULL, size_gt, sum_gt);
+    rx.run_query_kernel(lb_fv, query_cache_fv<blockThreads>, NULL, fv_gt);
+
+    EXPECT_TRUE(rx.cache_query(Op::VV));
+    EXPECT_TRUE(rx.cache_query(Op::FV));
+    EXPECT_TRUE(rx.is_query_cached(Op::VV));
+    EXPECT_TRUE(rx.is_query_cached(Op::FV));
+    EXPECT_FALSE(rx.is_query_cached(Op::VV, true));
+
+    rx.run_query_kernel(lb_vv, query_cache_vv<blockThreads>, NULL, size, sum);
+    rx.run_query_kernel(lb_fv, query_cache_fv<blockThreads>, NULL, fv);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    size_gt.move(DEVICE, HOST);
+    sum_gt.move(DEVICE, HOST);
+    fv_gt.move(DEVICE, HOST);
+    size.move(DEVICE, HOST);
+    sum.move(DEVICE, HOST);
+    fv.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_GT(size_gt(vh), 0u);
+        EXPECT_EQ(size(vh), size_gt(vh));
+        EXPECT_EQ(sum(vh), sum_gt(vh));
+    });
+
+    rx.for_each_face(HOST, [&](const FaceHandle fh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(fv(fh, i), fv_gt(fh, i));
+        }
+    });
+
+    // shrinking the budget evicts the least recently used query first
+    const size_t total = rx.get_query_cache_bytes();
+    EXPECT_TRUE(rx.cache_query(Op::VV));
+    rx.set_query_cache_budget(total - 1);
+    EXPECT_TRUE(rx.is_query_cached(Op::VV));
+    EXPECT_FALSE(rx.is_query_cached(Op::FV));
+    EXPECT_LT(rx.get_query_cache_bytes(), total);
+
+    // the query is computed again once its cache is released
+    rx.release_query_cache();
+    EXPECT_EQ(rx.get_query_cache_bytes(), size_t(0));
+    size.reset(0, DEVICE);
+    rx.run_query_kernel(lb_vv, query_cache_vv<blockThreads>, NULL, size, sum);
+    size.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ(size(vh), size_gt(vh));
+    });
+
+    CUDA_ERROR(cudaDeviceReset());
+}
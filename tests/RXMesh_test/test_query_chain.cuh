@@ -0,0 +1,264 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void query_chain_fv(const rxmesh::Context           context,
+                                      rxmesh::FaceAttribute<uint64_t> fv)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::FV>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                fv(fh, i) = iter[i].unique_id();
+            }
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_chain_vv(const rxmesh::Context             context,
+                                      rxmesh::VertexAttribute<uint32_t> valence)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            valence(vh) = iter.size();
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_chain(const rxmesh::Context             context,
+                                   rxmesh::FaceAttribute<uint64_t>   fv,
+                                   rxmesh::VertexAttribute<uint32_t> valence,
+                                   rxmesh::VertexAttribute<uint32_t> twice)
+{
+    // FV then VV then a per-vertex lambda that consumes the output of VV all
+    // on the same patch in one kernel
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch_chain(
+        block,
+        shrd_alloc,
+        query_stage<Op::FV>(
+            [&](const FaceHandle& fh, const VertexIterator& iter) {
+                for (uint16_t i = 0; i < iter.size(); ++i) {
+                    fv(fh, i) = iter[i].unique_id();
+                }
+            }),
+        query_stage<Op::VV>(
+            [&](const VertexHandle& vh, const VertexIterator& iter) {
+                valence(vh) = iter.size();
+            }),
+        element_stage<VertexHandle>(
+            [&](const VertexHandle& vh) { twice(vh) = 2 * valence(vh); }));
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_chain_oriented_vv(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint64_t> vv)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size() && i < vv.get_num_attributes();
+                 ++i) {
+                vv(vh, i) = iter[i].unique_id();
+            }
+        },
+        true);
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_chain_ev_diamond(
+    const rxmesh::Context           context,
+    rxmesh::EdgeAttribute<uint64_t> ev)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EVDiamond>(
+        block,
+        shrd_alloc,
+        [&](const EdgeHandle& eh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                ev(eh, i) = iter[i].unique_id();
+            }
+        });
+}
+
+template <uint32_t blockThreads>
+__global__ static void query_chain_topology(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint64_t> vv,
+    rxmesh::EdgeAttribute<uint64_t>   ev)
+{
+    // oriented VV and EVDiamond both read EV and FE which are loaded once for
+    // the whole chain
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch_chain(
+        block,
+        shrd_alloc,
+        query_stage<Op::VV>(
+            [&](const VertexHandle& vh, const VertexIterator& iter) {
+                for (uint16_t i = 0;
+                     i < iter.size() && i < vv.get_num_attributes();
+                     ++i) {
+                    vv(vh, i) = iter[i].unique_id();
+                }
+            },
+            true),
+        query_stage<Op::EVDiamond>(
+            [&](const EdgeHandle& eh, const VertexIterator& iter) {
+                for (uint16_t i = 0; i < iter.size(); ++i) {
+                    ev(eh, i) = iter[i].unique_id();
+                }
+            }));
+}
+
+TEST(RXMeshStatic, QueryChain)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto fv_gt      = *rx.add_face_attribute<uint64_t>("fv_gt", 3);
+    auto fv         = *rx.add_face_attribute<uint64_t>("fv", 3);
+    auto valence_gt = *rx.add_vertex_attribute<uint32_t>("valence_gt", 1);
+    auto valence    = *rx.add_vertex_attribute<uint32_t>("valence", 1);
+    auto twice      = *rx.add_vertex_attribute<uint32_t>("twice", 1);
+    fv.reset(0, LOCATION_ALL);
+    valence.reset(0, LOCATION_ALL);
+    twice.reset(0, LOCATION_ALL);
+
+    // ground truth using one kernel per query
+    LaunchBox<blockThreads> lb_fv, lb_vv;
+    rx.prepare_launch_box(
+        {Op::FV}, lb_fv, (void*)query_chain_fv<blockThreads>);
+    rx.prepare_launch_box(
+        {Op::VV}, lb_vv, (void*)query_chain_vv<blockThreads>);
+    rx.run_query_kernel(lb_fv, query_chain_fv<blockThreads>, NULL, fv_gt);
+    rx.run_query_kernel(lb_vv, query_chain_vv<blockThreads>, NULL, valence_gt);
+
+    // the chain needs at least the shared memory of its largest query
+    LaunchBox<blockThreads> lb_chain;
+    rx.prepare_launch_box_chain(
+        {Op::FV, Op::VV}, lb_chain, (void*)query_chain<blockThreads>);
+    EXPECT_GE(lb_chain.smem_bytes_dyn,
+              std::max(lb_fv.smem_bytes_dyn, lb_vv.smem_bytes_dyn));
+    rx.run_query_kernel(
+        lb_chain, query_chain<blockThreads>, NULL, fv, valence, twice);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    fv_gt.move(DEVICE, HOST);
+    fv.move(DEVICE, HOST);
+    valence_gt.move(DEVICE, HOST);
+    valence.move(DEVICE, HOST);
+    twice.move(DEVICE, HOST);
+
+    rx.for_each_face(HOST, [&](const FaceHandle fh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(fv(fh, i), fv_gt(fh, i));
+        }
+    });
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_GT(valence_gt(vh), 0u);
+        EXPECT_EQ(valence(vh), valence_gt(vh));
+        EXPECT_EQ(twice(vh), 2 * valence_gt(vh));
+    });
+
+    CUDA_ERROR(cudaDeviceReset());
+}
+
+TEST(RXMeshStatic, QueryChainTopology)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const uint32_t max_valence = rx.get_input_max_valence();
+
+    auto vv_gt = *rx.add_vertex_attribute<uint64_t>("vv_gt", max_valence);
+    auto vv    = *rx.add_vertex_attribute<uint64_t>("vv", max_valence);
+    auto ev_gt = *rx.add_edge_attribute<uint64_t>("ev_gt", 4);
+    auto ev    = *rx.add_edge_attribute<uint64_t>("ev", 4);
+    vv_gt.reset(INVALID64, LOCATION_ALL);
+    vv.reset(INVALID64, LOCATION_ALL);
+    ev_gt.reset(INVALID64, LOCATION_ALL);
+    ev.reset(INVALID64, LOCATION_ALL);
+
+    // ground truth using one kernel per query
+    LaunchBox<blockThreads> lb_vv, lb_ev;
+    rx.prepare_launch_box(
+        {Op::VV}, lb_vv, (void*)query_chain_oriented_vv<blockThreads>, true);
+    rx.prepare_launch_box(
+        {Op::EVDiamond}, lb_ev, (void*)query_chain_ev_diamond<blockThreads>);
+    rx.run_query_kernel(
+        lb_vv, query_chain_oriented_vv<blockThreads>, NULL, vv_gt);
+    rx.run_query_kernel(
+        lb_ev, query_chain_ev_diamond<blockThreads>, NULL, ev_gt);
+
+    LaunchBox<blockThreads> lb_chain;
+    rx.prepare_launch_box_chain({Op::VV, Op::EVDiamond},
+                                lb_chain,
+                                (void*)query_chain_topology<blockThreads>,
+                                true);
+    rx.run_query_kernel(
+        lb_chain, query_chain_topology<blockThreads>, NULL, vv, ev);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    vv_gt.move(DEVICE, HOST);
+    vv.move(DEVICE, HOST);
+    ev_gt.move(DEVICE, HOST);
+    ev.move(DEVICE, HOST);
+
+    // the same input to the same query gives the same order
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_NE(vv_gt(vh, 0), INVALID64);
+        for (uint32_t i = 0; i < max_valence; ++i) {
+            EXPECT_EQ(vv(vh, i), vv_gt(vh, i));
+        }
+    });
+
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        EXPECT_NE(ev_gt(eh, 0), INVALID64);
+        for (uint32_t i = 0; i < 4; ++i) {
+            EXPECT_EQ(ev(eh, i), ev_gt(eh, i));
+        }
+    });
+
+    CUDA_ERROR(cudaDeviceReset());
+}
@@ -1,7 +1,11 @@
 #include "gtest/gtest.h"
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/matrix/block_sparse_matrix.cuh"
 #include "rxmesh/matrix/dense_matrix.cuh"
+#include "rxmesh/matrix/lobpcg.cuh"
+#include "rxmesh/matrix/matrix_free.cuh"
+#include "rxmesh/matrix/patch_multigrid.cuh"
 #include "rxmesh/matrix/sparse_matrix.cuh"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_static.h"
@@ -384,6 +388,135 @@ TEST(RXMeshStatic, SparseMatrixLowerLevelAPISolve)
     ret_mat.release();
 }
 
+TEST(RXMeshStatic, SparseMatrixRefactorize)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    const uint32_t threads = 256;
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    LaunchBox<threads> launch_box;
+    rx.prepare_launch_box(
+        {Op::VV}, launch_box, (void*)simple_A_X_B_setup<float, threads>);
+
+    for (Solver solver : {Solver::CHOL, Solver::QR}) {
+        SparseMatrix<float> A_mat(rx);
+        DenseMatrix<float>  X_mat(rx, num_vertices, 3);
+        DenseMatrix<float>  B_mat(rx, num_vertices, 3);
+        DenseMatrix<float>  ret_mat(rx, num_vertices, 3);
+
+        // factorize once then only refactorize as the values change
+        for (int frame = 0; frame < 3; ++frame) {
+            const float time_step = 1.f + frame;
+
+            simple_A_X_B_setup<float, threads>
+                <<<launch_box.blocks,
+                   launch_box.num_threads,
+                   launch_box.smem_bytes_dyn>>>(
+                    rx.get_context(), *coords, A_mat, X_mat, B_mat, time_step);
+
+            if (frame == 0) {
+                A_mat.pre_solve(solver, PermuteMethod::NSTDIS);
+            } else {
+                A_mat.refactorize();
+            }
+            A_mat.solve(B_mat, X_mat);
+
+            A_mat.multiply(X_mat, ret_mat);
+
+            std::vector<float> h_ret_mat(num_vertices * 3);
+            CUDA_ERROR(cudaMemcpy(h_ret_mat.data(),
+                                  ret_mat.data(),
+                                  num_vertices * 3 * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+            std::vector<float> h_B_mat(num_vertices * 3);
+            CUDA_ERROR(cudaMemcpy(h_B_mat.data(),
+                                  B_mat.data(),
+                                  num_vertices * 3 * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+
+            for (uint32_t i = 0; i < num_vertices * 3; ++i) {
+                EXPECT_NEAR(h_ret_mat[i], h_B_mat[i], 1e-3);
+            }
+        }
+
+        A_mat.release();
+        X_mat.release();
+        B_mat.release();
+        ret_mat.release();
+    }
+}
+
+TEST(RXMeshStatic, SparseMatrixGPUNDOrdering)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    // the ordering should be a permutation of the vertices
+    std::vector<uint32_t> h_ordering(num_vertices, INVALID32);
+    cuda_nd_reorder(rx, h_ordering.data(), nd_auto_level(rx));
+    std::vector<bool> visited(num_vertices, false);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        ASSERT_LT(h_ordering[i], num_vertices);
+        EXPECT_FALSE(visited[h_ordering[i]]);
+        visited[h_ordering[i]] = true;
+    }
+
+    const uint32_t threads = 256;
+
+    auto                coords = rx.get_input_vertex_coordinates();
+    SparseMatrix<float> A_mat(rx);
+    DenseMatrix<float>  X_mat(rx, num_vertices, 3);
+    DenseMatrix<float>  B_mat(rx, num_vertices, 3);
+    DenseMatrix<float>  ret_mat(rx, num_vertices, 3);
+
+    float time_step = 1.f;
+
+    LaunchBox<threads> launch_box;
+    rx.prepare_launch_box(
+        {Op::VV}, launch_box, (void*)simple_A_X_B_setup<float, threads>);
+
+    simple_A_X_B_setup<float, threads><<<launch_box.blocks,
+                                         launch_box.num_threads,
+                                         launch_box.smem_bytes_dyn>>>(
+        rx.get_context(), *coords, A_mat, X_mat, B_mat, time_step);
+
+    A_mat.pre_solve(rx, Solver::CHOL, PermuteMethod::GPUND);
+    A_mat.solve(B_mat, X_mat);
+
+    A_mat.multiply(X_mat, ret_mat);
+
+    std::vector<vec3<float>> h_ret_mat(num_vertices);
+    CUDA_ERROR(cudaMemcpy(h_ret_mat.data(),
+                          ret_mat.data(),
+                          num_vertices * 3 * sizeof(float),
+                          cudaMemcpyDeviceToHost));
+    std::vector<vec3<float>> h_B_mat(num_vertices);
+    CUDA_ERROR(cudaMemcpy(h_B_mat.data(),
+                          B_mat.data(),
+                          num_vertices * 3 * sizeof(float),
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(h_ret_mat[i][j], h_B_mat[i][j], 1e-3);
+        }
+    }
+
+    A_mat.release();
+    X_mat.release();
+    B_mat.release();
+    ret_mat.release();
+}
+
 TEST(RXMeshStatic, SparseMatrixToEigen)
 {
     using namespace rxmesh;
@@ -448,4 +581,474 @@ TEST(RXMeshStatic, SparseMatrixToEigen)
     X_mat.release();
     B_mat.release();
     X_copy.release();
-}
\ No newline at end of file
+}
+TEST(RXMeshStatic, MatrixFreeCG)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    // (I + L) * x = b where L is the uniform (graph) Laplacian
+    auto matvec = [] __device__(const VertexHandle&           vh,
+                                const VertexIterator&         iter,
+                                const VertexAttribute<float>& in,
+                                VertexAttribute<float>&       out) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            float sum = (1.f + float(iter.size())) * in(vh, i);
+            for (uint32_t v = 0; v < iter.size(); ++v) {
+                sum -= in(iter[v], i);
+            }
+            out(vh, i) = sum;
+        }
+    };
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto b = *rx.add_vertex_attribute<float>("b", 3);
+    b.copy_from(*coords, DEVICE, LOCATION_ALL);
+
+    auto x = *rx.add_vertex_attribute<float>("x", 3);
+    x.reset(0.f, DEVICE);
+
+    auto check = *rx.add_vertex_attribute<float>("check", 3);
+
+    constexpr uint32_t blockThreads = 256;
+
+    // plain CG
+    MatrixFreeCG<float, blockThreads> cg(rx, 3, 500, 1e-6f);
+    const uint32_t num_iter = cg.solve(matvec, x, b);
+    EXPECT_GT(num_iter, 0u);
+    EXPECT_LT(num_iter, 500u);
+
+    matrix_free_spmv<float, blockThreads>(rx, matvec, x, check);
+    check.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_NEAR(check(vh, i), b(vh, i), 1e-3f);
+        }
+    });
+
+    // PCG with Jacobi preconditioner (the diagonal is 1 + valence)
+    auto ones = *rx.add_vertex_attribute<float>("ones", 3);
+    ones.reset(1.f, DEVICE);
+    auto inv_diag = *rx.add_vertex_attribute<float>("inv_diag", 3);
+    auto diag_op  = [] __device__(const VertexHandle&           vh,
+                                 const VertexIterator&         iter,
+                                 const VertexAttribute<float>& in,
+                                 VertexAttribute<float>&       out) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            out(vh, i) = in(vh, i) / (1.f + float(iter.size()));
+        }
+    };
+    matrix_free_spmv<float, blockThreads>(rx, diag_op, ones, inv_diag);
+
+    x.reset(0.f, DEVICE);
+    const uint32_t num_iter_pcg = cg.solve(matvec, x, b, &inv_diag);
+    EXPECT_GT(num_iter_pcg, 0u);
+    EXPECT_LT(num_iter_pcg, 500u);
+
+    matrix_free_spmv<float, blockThreads>(rx, matvec, x, check);
+    check.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_NEAR(check(vh, i), b(vh, i), 1e-3f);
+        }
+    });
+}
+
+template <typename T, uint32_t blockThreads>
+__global__ static void screened_laplace_setup(const rxmesh::Context   context,
+                                              rxmesh::SparseMatrix<T> A_mat,
+                                              const T                 t)
+{
+    using namespace rxmesh;
+    auto mat_setup = [&](VertexHandle& v_id, const VertexIterator& iter) {
+        for (uint32_t v = 0; v < iter.size(); ++v) {
+            A_mat(v_id, iter[v]) = -t;
+        }
+        A_mat(v_id, v_id) = T(1) + t * T(iter.size());
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, mat_setup);
+}
+
+TEST(RXMeshStatic, PatchMultigrid)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    constexpr uint32_t threads = 256;
+
+    SparseMatrix<float> A_mat(rx);
+    DenseMatrix<float>  X_mat(rx, num_vertices, 1);
+    DenseMatrix<float>  B_mat(rx, num_vertices, 1);
+    DenseMatrix<float>  ret_mat(rx, num_vertices, 1);
+
+    LaunchBox<threads> launch_box;
+    rx.prepare_launch_box(
+        {Op::VV}, launch_box, (void*)screened_laplace_setup<float, threads>);
+
+    screened_laplace_setup<float, threads><<<launch_box.blocks,
+                                             launch_box.num_threads,
+                                             launch_box.smem_bytes_dyn>>>(
+        rx.get_context(), A_mat, 100.f);
+
+    B_mat.fill_random();
+    X_mat.set_value(0.f);
+
+    // small coarsest level to get a few levels on a small mesh
+    PatchMultigrid<float> mg(rx, A_mat, 2, 2.f / 3.f, 16);
+    EXPECT_GT(mg.get_num_levels(), 1u);
+    for (uint32_t l = 1; l < mg.get_num_levels(); ++l) {
+        EXPECT_LT(mg.get_level_size(l), mg.get_level_size(l - 1));
+    }
+    EXPECT_LE(mg.get_level_size(mg.get_num_levels() - 1), 16);
+
+    mg.solve(B_mat, X_mat, 200, 1e-5f);
+    EXPECT_GT(mg.get_num_iterations(), 0u);
+    EXPECT_LT(mg.get_num_iterations(), 200u);
+    EXPECT_LE(mg.get_residual(), 1e-5f);
+
+    A_mat.multiply(X_mat, ret_mat);
+    ret_mat.move(DEVICE, HOST);
+    B_mat.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        EXPECT_NEAR(ret_mat(i, 0), B_mat(i, 0), 1e-3f);
+    }
+
+    A_mat.release();
+    X_mat.release();
+    B_mat.release();
+    ret_mat.release();
+}
+
+TEST(RXMeshStatic, BlockSparseMatrix)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    BlockSparseMatrix<float, 3> A_mat(rx);
+    EXPECT_EQ(A_mat.num_block_rows(), int(num_vertices));
+    EXPECT_EQ(A_mat.rows(), int(3 * num_vertices));
+
+    // anisotropic blocks: the diagonal block is dominant and non-symmetric
+    A_mat.assemble(
+        rx, [=] __device__(const VertexHandle& v, const VertexHandle& u) {
+            mat3x3<float> m(0.f);
+            if (v == u) {
+                m       = mat3x3<float>(20.f);
+                m[1][0] = coords(v, 0);
+                m[0][2] = coords(v, 1);
+            } else {
+                m[0][0] = -1.f;
+                m[1][1] = -1.f + coords(u, 2);
+                m[2][1] = 0.5f;
+            }
+            return m;
+        });
+
+    // two vectors of three components each
+    DenseMatrix<float> X_mat(rx, num_vertices, 6);
+    DenseMatrix<float> Y_mat(rx, num_vertices, 6);
+    DenseMatrix<float> Z_mat(rx, num_vertices, 6);
+    X_mat.fill_random();
+
+    A_mat.multiply(X_mat, Y_mat);
+
+    A_mat.move(DEVICE, HOST);
+    Y_mat.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    // every off-diagonal block should be the one of its column i.e., the
+    // block of u stores coords(u, 2) and the block columns are sorted
+    std::vector<float> z(num_vertices);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        z[A_mat.get_row_id(vh)] = coords(vh, 2);
+    });
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        EXPECT_EQ(A_mat.col_idx()[A_mat.row_ptr()[i]], int(i));
+        for (int k = A_mat.row_ptr()[i] + 1; k < A_mat.row_ptr()[i + 1]; ++k) {
+            const int j = A_mat.col_idx()[k];
+            EXPECT_FLOAT_EQ(A_mat.block_at(k)[4], -1.f + z[j]);
+            if (k > A_mat.row_ptr()[i] + 1) {
+                EXPECT_LT(A_mat.col_idx()[k - 1], j);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (int vec = 0; vec < 2; ++vec) {
+            for (int r = 0; r < 3; ++r) {
+                float sum = 0;
+                for (int k = A_mat.row_ptr()[i]; k < A_mat.row_ptr()[i + 1];
+                     ++k) {
+                    const int    j   = A_mat.col_idx()[k];
+                    const float* blk = A_mat.block_at(k);
+                    for (int c = 0; c < 3; ++c) {
+                        sum += blk[r * 3 + c] * X_mat(j, vec * 3 + c);
+                    }
+                }
+                EXPECT_NEAR(Y_mat(i, vec * 3 + r), sum, 1e-4f);
+            }
+        }
+    }
+
+    // block-Jacobi: D^{-1} applied to A*X restricted to the diagonal blocks
+    A_mat.compute_block_jacobi();
+    A_mat.apply_block_jacobi(X_mat, Z_mat);
+    Z_mat.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        const float* diag = A_mat.block_at(A_mat.row_ptr()[i]);
+        for (int vec = 0; vec < 2; ++vec) {
+            for (int r = 0; r < 3; ++r) {
+                float sum = 0;
+                for (int c = 0; c < 3; ++c) {
+                    sum += diag[r * 3 + c] * Z_mat(i, vec * 3 + c);
+                }
+                EXPECT_NEAR(sum, X_mat(i, vec * 3 + r), 1e-4f);
+            }
+        }
+    }
+
+    A_mat.release();
+    X_mat.release();
+    Y_mat.release();
+    Z_mat.release();
+}
+
+template <uint32_t blockThreads, rxmesh::QueryEngine queryEngine>
+__global__ static void slot_assembly_ve(const rxmesh::Context       context,
+                                        rxmesh::SparseMatrix<float> A_mat,
+                                        const bool                  oriented)
+{
+    using namespace rxmesh;
+    auto assemble = [&](VertexHandle& v_id, const EdgeIterator& iter) {
+        const float val = float(A_mat.get_row_id(v_id) + 1);
+        for (uint32_t e = 0; e < iter.size(); ++e) {
+            A_mat.vv_entry(v_id, iter[e]) = val;
+        }
+        A_mat.diagonal(v_id) = -1.f;
+    };
+
+    auto block = cooperative_groups::this_thread_block();
+    Query<blockThreads, queryEngine> query(context);
+    ShmemAllocator                   shrd_alloc;
+    query.template dispatch<Op::VE>(block, shrd_alloc, assemble, oriented);
+}
+
+template <uint32_t blockThreads>
+__global__ static void slot_assembly_ev(const rxmesh::Context       context,
+                                        rxmesh::SparseMatrix<float> A_mat)
+{
+    using namespace rxmesh;
+    auto assemble = [&](EdgeHandle& e_id, const VertexIterator& iter) {
+        A_mat.ev_entry(e_id, 0) = float(A_mat.get_row_id(iter[1]) + 1);
+        A_mat.ev_entry(e_id, 1) = float(A_mat.get_row_id(iter[0]) + 1);
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(block, shrd_alloc, assemble);
+}
+
+template <uint32_t blockThreads>
+__global__ static void slot_assembly_vv_by_edge(
+    const rxmesh::Context       context,
+    rxmesh::SparseMatrix<float> A_mat)
+{
+    using namespace rxmesh;
+    auto assemble = [&](EdgeHandle& e_id, const VertexIterator& iter) {
+        A_mat.vv_entry(iter[0], e_id) = float(A_mat.get_row_id(iter[1]) + 1);
+        A_mat.vv_entry(iter[1], e_id) = float(A_mat.get_row_id(iter[0]) + 1);
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EV>(block, shrd_alloc, assemble);
+}
+
+TEST(RXMeshStatic, SparseMatrixSlotAssembly)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    constexpr uint32_t threads = 256;
+
+    // the diagonal should be the first entry of every row and every
+    // off-diagonal entry (i, j) should be j + 1 (or i + 1 if by_row)
+    auto check = [&](SparseMatrix<float>& A_mat, float diag, bool by_row) {
+        A_mat.move(DEVICE, HOST);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        for (int i = 0; i < A_mat.rows(); ++i) {
+            EXPECT_EQ(A_mat.col_idx()[A_mat.row_ptr()[i]], i);
+            for (int k = A_mat.row_ptr()[i]; k < A_mat.row_ptr()[i + 1]; ++k) {
+                const int   j   = A_mat.col_idx()[k];
+                const float val = by_row ? float(i + 1) : float(j + 1);
+                EXPECT_EQ(A_mat.get_val_at(k), (i == j) ? diag : val);
+            }
+        }
+    };
+
+    // the VE query visits the edges in a different order in every case but
+    // the cached slots should still place the entries in the right columns
+    auto assemble_ve = [&](auto launch_box, const bool oriented) {
+        constexpr QueryEngine engine = decltype(launch_box)::query_engine;
+
+        SparseMatrix<float> A_mat(rx);
+        A_mat.build_ev_slots(rx);
+
+        rx.prepare_launch_box({Op::VE},
+                              launch_box,
+                              (void*)slot_assembly_ve<threads, engine>,
+                              oriented);
+        rx.run_query_kernel(launch_box,
+                            slot_assembly_ve<threads, engine>,
+                            NULL,
+                            A_mat,
+                            oriented);
+
+        check(A_mat, -1.f, true);
+        A_mat.release();
+    };
+
+    assemble_ve(LaunchBox<threads, QueryEngine::Block>(), false);
+    assemble_ve(LaunchBox<threads, QueryEngine::Block>(), true);
+    assemble_ve(LaunchBox<threads, QueryEngine::Warp>(), false);
+
+    SparseMatrix<float> A_mat(rx);
+    A_mat.build_ev_slots(rx);
+
+    LaunchBox<threads> launch_box;
+    rx.prepare_launch_box(
+        {Op::EV}, launch_box, (void*)slot_assembly_ev<threads>);
+    slot_assembly_ev<threads><<<launch_box.blocks,
+                                launch_box.num_threads,
+                                launch_box.smem_bytes_dyn>>>(rx.get_context(),
+                                                             A_mat);
+    check(A_mat, 0.f, false);
+
+    // the same slots keyed by the edge from the side of either vertex
+    A_mat.set_value(0.f);
+    rx.prepare_launch_box(
+        {Op::EV}, launch_box, (void*)slot_assembly_vv_by_edge<threads>);
+    slot_assembly_vv_by_edge<threads>
+        <<<launch_box.blocks,
+           launch_box.num_threads,
+           launch_box.smem_bytes_dyn>>>(rx.get_context(), A_mat);
+    check(A_mat, 0.f, false);
+    A_mat.release();
+}
+
+template <typename T, uint32_t blockThreads>
+__global__ static void uniform_laplacian(const rxmesh::Context   context,
+                                         rxmesh::SparseMatrix<T> L)
+{
+    using namespace rxmesh;
+    auto laplace = [&](VertexHandle& vh, const VertexIterator& iter) {
+        L(vh, vh) = T(iter.size());
+        for (uint32_t v = 0; v < iter.size(); ++v) {
+            L(vh, iter[v]) = T(-1);
+        }
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, laplace);
+}
+
+TEST(RXMeshStatic, LOBPCG)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    constexpr uint32_t threads = 256;
+
+    // the constant vector and the three (almost) linear functions on the
+    // sphere are separated from the rest of the spectrum by a large gap
+    const uint32_t num_eigen = 4;
+    const int      n         = rx.get_num_vertices();
+
+    SparseMatrix<double> L(rx);
+    L.set_value(0.0);
+
+    LaunchBox<threads> launch_box;
+    rx.prepare_launch_box(
+        {Op::VV}, launch_box, (void*)uniform_laplacian<double, threads>);
+    uniform_laplacian<double, threads><<<launch_box.blocks,
+                                         launch_box.num_threads,
+                                         launch_box.smem_bytes_dyn>>>(
+        rx.get_context(), L);
+
+    // reference eigenvalues
+    L.move(DEVICE, HOST);
+    CUDA_ERROR(cudaDeviceSynchronize());
+    const Eigen::MatrixXd L_dense = L.to_eigen().toDense();
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> ref(L_dense);
+
+    LOBPCG<double>               lobpcg(rx, num_eigen, 1000, 1e-8);
+    JacobiPreconditioner<double> jacobi(L);
+
+    for (bool precond : {false, true}) {
+        DenseMatrix<double> X(rx, n, num_eigen);
+        X.fill_random();
+
+        const uint32_t num_iter =
+            precond ? lobpcg.solve(L, X, jacobi) : lobpcg.solve(L, X);
+        EXPECT_GT(num_iter, 0u);
+        EXPECT_LT(num_iter, 1000u);
+
+        const std::vector<double>& lambda = lobpcg.get_eigenvalues();
+        ASSERT_EQ(lambda.size(), num_eigen);
+        EXPECT_NEAR(lambda[0], 0.0, 1e-8);
+        for (uint32_t i = 0; i < num_eigen; ++i) {
+            EXPECT_NEAR(lambda[i], ref.eigenvalues()[i], 1e-8);
+            EXPECT_LT(lobpcg.get_residuals()[i], 1e-8);
+            if (i > 0) {
+                EXPECT_LE(lambda[i - 1], lambda[i]);
+            }
+        }
+
+        // the eigenvectors are orthonormal and satisfy L * x = lambda * x
+        X.move(DEVICE, HOST);
+        const Eigen::MatrixXd X_eigen = X.to_eigen();
+        const Eigen::MatrixXd XtX     = X_eigen.transpose() * X_eigen;
+        EXPECT_TRUE(XtX.isApprox(
+            Eigen::MatrixXd::Identity(num_eigen, num_eigen), 1e-6));
+        for (uint32_t i = 0; i < num_eigen; ++i) {
+            const Eigen::VectorXd r =
+                L_dense * X_eigen.col(i) - lambda[i] * X_eigen.col(i);
+            EXPECT_LT(r.norm(), 1e-7);
+        }
+
+        X.release();
+    }
+
+    jacobi.release();
+    lobpcg.release();
+    L.release();
+}
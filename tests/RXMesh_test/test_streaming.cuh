@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t blockThreads>
+__global__ static void streaming_valence(
+    const rxmesh::Context          context,
+    rxmesh::VertexAttribute<float> valence)
+{
+    using namespace rxmesh;
+    auto compute_valence = [&](VertexHandle& vh, const VertexIterator& iter) {
+        valence(vh) = iter.size();
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, compute_valence);
+}
+
+/**
+ * @brief for every vertex, return its (for_each-scaled) coordinates and
+ * valence sorted so that meshes with different patching can be compared
+ */
+static std::vector<std::array<float, 4>> streaming_run(
+    const uint32_t max_resident_patches)
+{
+    using namespace rxmesh;
+
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                    "",
+                    64,
+                    1.0,
+                    1.0,
+                    0.8,
+                    -1,
+                    max_resident_patches);
+
+    EXPECT_EQ(rx.is_streaming(), max_resident_patches > 0);
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    auto scaled  = *rx.add_vertex_attribute<float>("scaled", 3);
+    auto valence = *rx.add_vertex_attribute<float>("valence", 1);
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+        for (int i = 0; i < 3; ++i) {
+            scaled(vh, i) = 2.f * coords(vh, i);
+        }
+    });
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)streaming_valence<blockThreads>);
+    rx.run_query_kernel(lb, streaming_valence<blockThreads>, NULL, valence);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    scaled.move(DEVICE, HOST);
+    valence.move(DEVICE, HOST);
+
+    std::vector<std::array<float, 4>> ret(rx.get_num_vertices());
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        ret[rx.linear_id(vh)] = {
+            scaled(vh, 0), scaled(vh, 1), scaled(vh, 2), valence(vh)};
+    });
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+TEST(RXMeshStatic, Streaming)
+{
+    using namespace rxmesh;
+
+    auto expected = streaming_run(0);
+    auto streamed = streaming_run(4);
+
+    ASSERT_EQ(expected.size(), streamed.size());
+    for (size_t v = 0; v < expected.size(); ++v) {
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_EQ(expected[v][i], streamed[v][i]);
+        }
+    }
+
+    CUDA_ERROR(cudaDeviceReset());
+}
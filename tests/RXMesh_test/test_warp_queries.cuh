@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+template <uint32_t            blockThreads,
+          rxmesh::QueryEngine queryEngine,
+          rxmesh::Op          op,
+          typename IteratorT>
+__global__ static void warp_query_sum(const rxmesh::Context             context,
+                                      rxmesh::VertexAttribute<uint32_t> size,
+                                      rxmesh::VertexAttribute<uint64_t> sum)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads, queryEngine> query(context);
+    ShmemAllocator                   shrd_alloc;
+    query.template dispatch<op>(
+        block, shrd_alloc, [&](const VertexHandle& vh, const IteratorT& iter) {
+            // the order of the output is not defined so we compare the sum
+            uint64_t s = 0;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                s += iter[i].unique_id();
+            }
+            size(vh) = iter.size();
+            sum(vh)  = s;
+        });
+}
+
+template <rxmesh::Op op, typename IteratorT>
+void test_warp_query(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    auto size_gt = *rx.add_vertex_attribute<uint32_t>("size_gt", 1);
+    auto sum_gt  = *rx.add_vertex_attribute<uint64_t>("sum_gt", 1);
+    auto size    = *rx.add_vertex_attribute<uint32_t>("size", 1);
+    auto sum     = *rx.add_vertex_attribute<uint64_t>("sum", 1);
+    size.reset(0, LOCATION_ALL);
+    sum.reset(0, LOCATION_ALL);
+
+    constexpr QueryEngine block_engine = QueryEngine::Block;
+    constexpr QueryEngine warp_engine  = QueryEngine::Warp;
+
+    auto block_kernel =
+        warp_query_sum<blockThreads, block_engine, op, IteratorT>;
+    auto warp_kernel = warp_query_sum<blockThreads, warp_engine, op, IteratorT>;
+
+    LaunchBox<blockThreads, block_engine> lb_block;
+    LaunchBox<blockThreads, warp_engine>  lb_warp;
+    rx.prepare_launch_box({op}, lb_block, (void*)block_kernel);
+    rx.prepare_launch_box({op}, lb_warp, (void*)warp_kernel);
+
+    // the warp engine only keeps the output in shared memory
+    EXPECT_LT(lb_warp.smem_bytes_dyn, lb_block.smem_bytes_dyn);
+
+    rx.run_query_kernel(lb_block, block_kernel, NULL, size_gt, sum_gt);
+
+    // the engine is part of the kernel and so a direct launch with the
+    // context of the mesh uses the same engine the shared memory is sized for
+    warp_kernel<<<lb_warp.blocks,
+                  lb_warp.num_threads,
+                  lb_warp.smem_bytes_dyn>>>(rx.get_context(), size, sum);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    size_gt.move(DEVICE, HOST);
+    sum_gt.move(DEVICE, HOST);
+    size.move(DEVICE, HOST);
+    sum.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_GT(size_gt(vh), 0u);
+        EXPECT_EQ(size(vh), size_gt(vh));
+        EXPECT_EQ(sum(vh), sum_gt(vh));
+    });
+
+    rx.remove_attribute("size_gt");
+    rx.remove_attribute("sum_gt");
+    rx.remove_attribute("size");
+    rx.remove_attribute("sum");
+}
+
+TEST(RXMeshStatic, WarpQueryEngine)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    test_warp_query<Op::VV, VertexIterator>(rx);
+    test_warp_query<Op::VE, EdgeIterator>(rx);
+    test_warp_query<Op::VF, FaceIterator>(rx);
+
+    CUDA_ERROR(cudaDeviceReset());
+}